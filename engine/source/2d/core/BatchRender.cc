@@ -48,6 +48,18 @@ BatchRender::BatchRender() :
     mWireframeMode( false ),
     mBatchEnabled( true )
 {
+    // Generate the quad indices used when rendering vertex blocks.
+    U32 indexCount = 0;
+    for ( U32 quadIndex = 0; quadIndex < BATCHRENDER_MAXQUADS; ++quadIndex )
+    {
+        const U16 vertexIndex = (U16)(quadIndex * 4);
+        mQuadIndexBuffer[indexCount++] = vertexIndex;
+        mQuadIndexBuffer[indexCount++] = vertexIndex+1;
+        mQuadIndexBuffer[indexCount++] = vertexIndex+2;
+        mQuadIndexBuffer[indexCount++] = vertexIndex+3;
+        mQuadIndexBuffer[indexCount++] = vertexIndex+2;
+        mQuadIndexBuffer[indexCount++] = vertexIndex+1;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -286,64 +298,8 @@ void BatchRender::flushInternal( void )
     // Stats.
     mpDebugStats->batchFlushes++;
 
-    if ( mWireframeMode )
-    {
-        // Disable texturing.    
-        glDisable( GL_TEXTURE_2D );
-
-        // Set the polygon mode to line.
-        glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-    }
-    else
-    {
-        // Enable texturing.    
-        glEnable( GL_TEXTURE_2D );
-        glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
-
-        // Set the polygon mode to fill.
-        glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
-    }
-
-    // Set blend mode.
-    if ( mBlendMode )
-    {
-        glEnable( GL_BLEND );
-        glBlendFunc( mSrcBlendFactor, mDstBlendFactor );
-        glColor4f(mBlendColor.red, mBlendColor.green, mBlendColor.blue, mBlendColor.alpha );
-    }
-    else
-    {
-        glDisable( GL_BLEND );
-        glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
-    }
-
-    // Set alpha-blend mode.
-    if ( mAlphaTestMode >= 0.0f )
-    {
-        glEnable( GL_ALPHA_TEST );
-        glAlphaFunc( GL_GREATER, mAlphaTestMode );
-    }
-    else
-    {
-        glDisable( GL_ALPHA_TEST );
-    }
-
-    // Enable vertex and texture arrays.
-    glEnableClientState( GL_VERTEX_ARRAY );
-    glVertexPointer( 2, GL_FLOAT, 0, mVertexBuffer );
-    glTexCoordPointer( 2, GL_FLOAT, 0, mTextureBuffer );
-
-    // Use the texture coordinates if not in wireframe mode.
-    if ( !mWireframeMode )
-        glEnableClientState( GL_TEXTURE_COORD_ARRAY );
-
-    // Do we have any colors?
-    if ( mColorCount > 0 )
-    {
-        // Yes, so enable color array.
-        glEnableClientState( GL_COLOR_ARRAY );
-        glColorPointer( 4, GL_FLOAT, 0, mColorBuffer );
-    }
+    // Set render state.
+    setRenderState( mVertexBuffer, mTextureBuffer, mColorCount > 0 ? mColorBuffer : NULL );
 
     // Strict order mode?
     if ( mStrictOrderMode )
@@ -443,14 +399,8 @@ void BatchRender::flushInternal( void )
         mTextureBatchMap.clear();
     }
 
-    // Reset common render state.
-    glDisableClientState( GL_VERTEX_ARRAY );
-    glDisableClientState( GL_TEXTURE_COORD_ARRAY );
-    glDisableClientState( GL_COLOR_ARRAY );
-    glDisable( GL_ALPHA_TEST );
-    glDisable( GL_BLEND );
-    glDisable( GL_TEXTURE_2D );
-    glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+    // Reset render state.
+    resetRenderState();
 
     // Reset batch state.
     mQuadCount = 0;
@@ -486,4 +436,142 @@ void BatchRender::RenderQuad(
     glEnd();
 }
 
+//-----------------------------------------------------------------------------
+
+void BatchRender::RenderVertexBlock(
+        const b2Transform& transform,
+        const Vector2* pVertices,
+        const Vector2* pTextureCoords,
+        const U32 quadCount,
+        TextureHandle& texture )
+{
+    // Sanity!
+    AssertFatal( mpDebugStats != NULL, "Debug stats have not been configured." );
+    AssertFatal( quadCount <= BATCHRENDER_MAXQUADS, "BatchRender::RenderVertexBlock() - Too many quads in vertex block." );
+
+    // Finish if no quads to render.
+    if ( quadCount == 0 )
+        return;
+
+    PROFILE_START(BatchRender_RenderVertexBlock);
+
+    // Flush any pending batch.
+    flush();
+
+    // Stats.
+    mpDebugStats->batchTrianglesSubmitted += quadCount * 2;
+
+    // Set render state.
+    setRenderState( pVertices, pTextureCoords, NULL );
+
+    // Bind the texture if not in wireframe mode.
+    if ( !mWireframeMode )
+        glBindTexture( GL_TEXTURE_2D, texture.getGLName() );
+
+    // Apply the block transform.
+    glPushMatrix();
+    glTranslatef( transform.p.x, transform.p.y, 0.0f );
+    glRotatef( mRadToDeg( transform.q.GetAngle() ), 0.0f, 0.0f, 1.0f );
+
+    // Draw the quads using triangles with indexes.
+    const U32 indexCount = quadCount * 6;
+    glDrawElements( GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, mQuadIndexBuffer );
+
+    // Restore the transform.
+    glPopMatrix();
 
+    // Stats.
+    mpDebugStats->batchDrawCallsSorted++;
+
+    // Stats.
+    const U32 vertexCount = quadCount * 4;
+    if ( vertexCount > mpDebugStats->batchMaxVertexBuffer )
+        mpDebugStats->batchMaxVertexBuffer = vertexCount;
+
+    // Stats.
+    const U32 trianglesDrawn = indexCount / 3;
+    if ( trianglesDrawn > mpDebugStats->batchMaxTriangleDrawn )
+        mpDebugStats->batchMaxTriangleDrawn = trianglesDrawn;
+
+    // Reset render state.
+    resetRenderState();
+
+    PROFILE_END();   // BatchRender_RenderVertexBlock
+}
+
+//-----------------------------------------------------------------------------
+
+void BatchRender::setRenderState( const Vector2* pVertices, const Vector2* pTextureCoords, const ColorF* pColors )
+{
+    if ( mWireframeMode )
+    {
+        // Disable texturing.    
+        glDisable( GL_TEXTURE_2D );
+
+        // Set the polygon mode to line.
+        glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
+    }
+    else
+    {
+        // Enable texturing.    
+        glEnable( GL_TEXTURE_2D );
+        glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+
+        // Set the polygon mode to fill.
+        glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+    }
+
+    // Set blend mode.
+    if ( mBlendMode )
+    {
+        glEnable( GL_BLEND );
+        glBlendFunc( mSrcBlendFactor, mDstBlendFactor );
+        glColor4f(mBlendColor.red, mBlendColor.green, mBlendColor.blue, mBlendColor.alpha );
+    }
+    else
+    {
+        glDisable( GL_BLEND );
+        glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
+    }
+
+    // Set alpha-blend mode.
+    if ( mAlphaTestMode >= 0.0f )
+    {
+        glEnable( GL_ALPHA_TEST );
+        glAlphaFunc( GL_GREATER, mAlphaTestMode );
+    }
+    else
+    {
+        glDisable( GL_ALPHA_TEST );
+    }
+
+    // Enable vertex and texture arrays.
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glVertexPointer( 2, GL_FLOAT, 0, pVertices );
+    glTexCoordPointer( 2, GL_FLOAT, 0, pTextureCoords );
+
+    // Use the texture coordinates if not in wireframe mode.
+    if ( !mWireframeMode )
+        glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+
+    // Do we have any colors?
+    if ( pColors != NULL )
+    {
+        // Yes, so enable color array.
+        glEnableClientState( GL_COLOR_ARRAY );
+        glColorPointer( 4, GL_FLOAT, 0, pColors );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void BatchRender::resetRenderState( void )
+{
+    glDisableClientState( GL_VERTEX_ARRAY );
+    glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+    glDisableClientState( GL_COLOR_ARRAY );
+    glDisable( GL_ALPHA_TEST );
+    glDisable( GL_BLEND );
+    glDisable( GL_TEXTURE_2D );
+    glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+}
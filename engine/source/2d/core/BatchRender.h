@@ -202,6 +202,16 @@ public:
             const Vector2& texturePos2,
             const Vector2& texturePos3 );
 
+    /// Render a prebuilt block of quads immediately using the current blend and alpha-test state.
+    /// Any pending batch is flushed first.  The vertices are transformed by the specified transform
+    /// and each quad is stored in the same order that the batch uses internally i.e. 0, 1, 3, 2.
+    void RenderVertexBlock(
+            const b2Transform& transform,
+            const Vector2* pVertices,
+            const Vector2* pTextureCoords,
+            const U32 quadCount,
+            TextureHandle& texture );
+
     /// Flush (render) any pending batches with a reason metric.
     void flush( U32& reasonMetric );
 
@@ -212,6 +222,10 @@ private:
     /// Flush (render) any pending batches.
     void flushInternal( void );
 
+    /// Set/reset the render state used when drawing the specified arrays.
+    void setRenderState( const Vector2* pVertices, const Vector2* pTextureCoords, const ColorF* pColors );
+    void resetRenderState( void );
+
 private:
     typedef Vector<U32> indexVectorType;
     typedef HashMap<U32, indexVectorType*> textureBatchType;
@@ -224,6 +238,7 @@ private:
     Vector2             mVertexBuffer[ BATCHRENDER_BUFFERSIZE ];
     Vector2             mTextureBuffer[ BATCHRENDER_BUFFERSIZE ];
     U16                 mIndexBuffer[ BATCHRENDER_BUFFERSIZE ];
+    U16                 mQuadIndexBuffer[ BATCHRENDER_BUFFERSIZE ];
     ColorF              mColorBuffer[ BATCHRENDER_BUFFERSIZE ];
    
     U32                 mQuadCount;
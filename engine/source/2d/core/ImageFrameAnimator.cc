@@ -0,0 +1,399 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _IMAGE_FRAME_ANIMATOR_H_
+#include "2d/core/ImageFrameAnimator.h"
+#endif
+
+#ifndef _IMAGE_FRAME_PROVIDER_CORE_H
+#include "2d/core/ImageFrameProviderCore.h"
+#endif
+
+#ifndef _TICKABLE_H_
+#include "platform/Tickable.h"
+#endif
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+//------------------------------------------------------------------------------
+
+/// Integrates self-ticking providers using the tick period.
+class SelfTickImageFrameAnimator : public ImageFrameAnimator, public virtual Tickable
+{
+public:
+    SelfTickImageFrameAnimator() : ImageFrameAnimator( false )
+    {
+        // Turn-on tick processing.
+        setProcessTicks( true );
+    }
+
+    virtual void interpolateTick( F32 delta ) {}
+    virtual void processTick( void ) { update( Tickable::smTickSec ); }
+    virtual void advanceTime( F32 timeDelta ) {}
+};
+
+static SelfTickImageFrameAnimator* spSelfTickAnimator = NULL;
+
+//------------------------------------------------------------------------------
+
+ImageFrameAnimator::ImageFrameAnimator( const bool requestTicks ) :
+    mRequestTicks( requestTicks )
+{
+    // Set Vector Associations.
+    VECTOR_SET_ASSOCIATION( mAnimationGroups );
+    VECTOR_SET_ASSOCIATION( mFinishedProviders );
+}
+
+//------------------------------------------------------------------------------
+
+ImageFrameAnimator::~ImageFrameAnimator()
+{
+    // Clear the providers.
+    clearProviders();
+
+    // Delete the groups.
+    for( typeAnimationGroupVector::iterator groupItr = mAnimationGroups.begin(); groupItr != mAnimationGroups.end(); ++groupItr )
+    {
+        delete *groupItr;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+ImageFrameAnimator* ImageFrameAnimator::getSelfTickAnimator( void )
+{
+    // Create the animator on first use.
+    if ( spSelfTickAnimator == NULL )
+        spSelfTickAnimator = new SelfTickImageFrameAnimator();
+
+    return spSelfTickAnimator;
+}
+
+//------------------------------------------------------------------------------
+
+void ImageFrameAnimator::destroySelfTickAnimator( void )
+{
+    // Delete the animator.
+    delete spSelfTickAnimator;
+    spSelfTickAnimator = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+void ImageFrameAnimator::addProvider( ImageFrameProviderCore* pProvider )
+{
+    // Sanity!
+    AssertFatal( pProvider != NULL, "ImageFrameAnimator::addProvider() - Cannot add a NULL provider." );
+
+    // Fetch the animation asset.
+    const AnimationAsset* pAnimationAsset = pProvider->getCurrentAnimation();
+
+    // Sanity!
+    AssertFatal( pAnimationAsset != NULL, "ImageFrameAnimator::addProvider() - Cannot add a provider without an animation." );
+
+    // Fetch the current group.
+    AnimationGroup* pCurrentGroup = pProvider->mpAnimatorGroup;
+
+    // Is the provider already in a group?
+    if ( pCurrentGroup != NULL )
+    {
+        // Yes, so finish if it's already in the correct group.
+        if ( pCurrentGroup->mpOwner == this && pCurrentGroup->mpAnimationAsset == pAnimationAsset )
+            return;
+
+        // Remove from the current group.
+        pCurrentGroup->mpOwner->removeProvider( pProvider );
+    }
+
+    // Find the animation group.
+    AnimationGroup* pAnimationGroup;
+    typeAnimationGroupHash::iterator groupItr = mAnimationGroupHash.find( pAnimationAsset );
+
+    // Did we find the group?
+    if ( groupItr != mAnimationGroupHash.end() )
+    {
+        // Yes, so use it.
+        pAnimationGroup = groupItr->value;
+    }
+    else
+    {
+        // No, so create a group.
+        pAnimationGroup = new AnimationGroup();
+        pAnimationGroup->mpOwner = this;
+        pAnimationGroup->mpAnimationAsset = pAnimationAsset;
+        mAnimationGroupHash.insert( pAnimationAsset, pAnimationGroup );
+        mAnimationGroups.push_back( pAnimationGroup );
+    }
+
+    // Add to the group.
+    pProvider->mpAnimatorGroup = pAnimationGroup;
+    pProvider->mAnimatorIndex = (U32)pAnimationGroup->mProviders.size();
+    pProvider->mAnimationTickPending = false;
+    pAnimationGroup->mProviders.push_back( pProvider );
+}
+
+//------------------------------------------------------------------------------
+
+void ImageFrameAnimator::removeProvider( ImageFrameProviderCore* pProvider )
+{
+    // Sanity!
+    AssertFatal( pProvider != NULL, "ImageFrameAnimator::removeProvider() - Cannot remove a NULL provider." );
+
+    // Is the provider waiting for its end-of-animation callback?
+    if ( pProvider->mpAnimationEndAnimator == this )
+    {
+        // Yes, so cancel it.
+        for( typeProviderVector::iterator providerItr = mFinishedProviders.begin(); providerItr != mFinishedProviders.end(); ++providerItr )
+        {
+            if ( *providerItr == pProvider )
+                *providerItr = NULL;
+        }
+
+        pProvider->mpAnimationEndAnimator = NULL;
+    }
+
+    // Fetch the group.
+    AnimationGroup* pAnimationGroup = pProvider->mpAnimatorGroup;
+
+    // Finish if the provider is not in a group.
+    if ( pAnimationGroup == NULL )
+        return;
+
+    // Sanity!
+    AssertFatal( pAnimationGroup->mpOwner == this, "ImageFrameAnimator::removeProvider() - Provider is not owned by this animator." );
+
+    // Fetch the provider index.
+    const U32 providerIndex = pProvider->mAnimatorIndex;
+
+    // Sanity!
+    AssertFatal( pAnimationGroup->mProviders[providerIndex] == pProvider, "ImageFrameAnimator::removeProvider() - Provider index is invalid." );
+
+    // Remove the provider by moving the last provider into its slot.
+    pAnimationGroup->mProviders.erase_fast( providerIndex );
+
+    // Update the index of the moved provider.
+    if ( providerIndex < (U32)pAnimationGroup->mProviders.size() )
+        pAnimationGroup->mProviders[providerIndex]->mAnimatorIndex = providerIndex;
+
+    // Reset the provider.
+    pProvider->mpAnimatorGroup = NULL;
+    pProvider->mAnimatorIndex = 0;
+    pProvider->mAnimationTickPending = false;
+}
+
+//------------------------------------------------------------------------------
+
+void ImageFrameAnimator::clearProviders( void )
+{
+    // Iterate the groups.
+    for( typeAnimationGroupVector::iterator groupItr = mAnimationGroups.begin(); groupItr != mAnimationGroups.end(); ++groupItr )
+    {
+        typeProviderVector& providers = (*groupItr)->mProviders;
+
+        // Reset the providers.
+        for( typeProviderVector::iterator providerItr = providers.begin(); providerItr != providers.end(); ++providerItr )
+        {
+            (*providerItr)->mpAnimatorGroup = NULL;
+            (*providerItr)->mAnimatorIndex = 0;
+            (*providerItr)->mAnimationTickPending = false;
+        }
+
+        providers.clear();
+    }
+
+    // Cancel any end-of-animation callbacks.
+    for( typeProviderVector::iterator providerItr = mFinishedProviders.begin(); providerItr != mFinishedProviders.end(); ++providerItr )
+    {
+        if ( *providerItr != NULL )
+            (*providerItr)->mpAnimationEndAnimator = NULL;
+    }
+
+    mFinishedProviders.clear();
+}
+
+//------------------------------------------------------------------------------
+
+U32 ImageFrameAnimator::getProviderCount( void ) const
+{
+    U32 providerCount = 0;
+
+    // Sum the group providers.
+    for( typeAnimationGroupVector::const_iterator groupItr = mAnimationGroups.begin(); groupItr != mAnimationGroups.end(); ++groupItr )
+    {
+        providerCount += (U32)(*groupItr)->mProviders.size();
+    }
+
+    return providerCount;
+}
+
+//------------------------------------------------------------------------------
+
+void ImageFrameAnimator::update( const F32 elapsedTime )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(ImageFrameAnimator_Update);
+
+    // Iterate the groups.
+    for( S32 groupIndex = mAnimationGroups.size()-1; groupIndex >= 0; --groupIndex )
+    {
+        AnimationGroup* pAnimationGroup = mAnimationGroups[groupIndex];
+
+        // Is the group empty?
+        if ( pAnimationGroup->mProviders.size() == 0 )
+        {
+            // Yes, so remove it.
+            // NOTE:-   Its animation asset may have been released so it must not be referenced again.
+            mAnimationGroupHash.erase( pAnimationGroup->mpAnimationAsset );
+            mAnimationGroups.erase_fast( groupIndex );
+            delete pAnimationGroup;
+            continue;
+        }
+
+        // Update the group.
+        updateGroup( pAnimationGroup, elapsedTime );
+    }
+
+    // Finish if no animations finished.
+    if ( mFinishedProviders.size() == 0 )
+        return;
+
+    // Remove the finished providers first so that the callbacks are free to play another animation.
+    for( typeProviderVector::iterator providerItr = mFinishedProviders.begin(); providerItr != mFinishedProviders.end(); ++providerItr )
+    {
+        removeProvider( *providerItr );
+        (*providerItr)->mpAnimationEndAnimator = this;
+    }
+
+    // Perform the callbacks.
+    // NOTE:-   A callback may delete a provider that is still waiting for its callback which removes it here.
+    for( S32 providerIndex = 0; providerIndex < mFinishedProviders.size(); ++providerIndex )
+    {
+        ImageFrameProviderCore* pProvider = mFinishedProviders[providerIndex];
+
+        // Skip if the provider was removed.
+        if ( pProvider == NULL )
+            continue;
+
+        pProvider->mpAnimationEndAnimator = NULL;
+        pProvider->onAnimationEnd();
+    }
+
+    mFinishedProviders.clear();
+}
+
+//------------------------------------------------------------------------------
+
+void ImageFrameAnimator::updateGroup( AnimationGroup* pAnimationGroup, const F32 elapsedTime )
+{
+    // Fetch the animation asset.
+    const AnimationAsset* pAnimationAsset = pAnimationGroup->mpAnimationAsset;
+
+    // Finish if the animation has no image.
+    if ( pAnimationAsset->getImage().isNull() )
+        return;
+
+    // Fetch validated frames.
+    const Vector<S32>& validatedFrames = pAnimationAsset->getValidatedAnimationFrames();
+    const S32 validatedFrameCount = validatedFrames.size();
+
+    // Finish if there are no validated frames.
+    if ( validatedFrameCount == 0 )
+        return;
+
+    // Fetch the group timing.
+    const S32* pValidatedFrames = validatedFrames.address();
+    const S32 imageFrameCount = (S32)pAnimationAsset->getImage()->getFrameCount();
+    const bool animationCycle = pAnimationAsset->getAnimationCycle();
+    const F32 totalIntegrationTime = pAnimationAsset->getAnimationTime();
+    const F32 frameIntegrationTime = totalIntegrationTime / validatedFrameCount;
+    const F32 finishedTime = totalIntegrationTime - (frameIntegrationTime * 0.5f);
+
+    // Fetch the providers.
+    ImageFrameProviderCore** ppProviders = pAnimationGroup->mProviders.address();
+    const U32 providerCount = (U32)pAnimationGroup->mProviders.size();
+
+    // Iterate the providers.
+    for( U32 providerIndex = 0; providerIndex < providerCount; ++providerIndex )
+    {
+        ImageFrameProviderCore* pProvider = ppProviders[providerIndex];
+
+        // Are we requesting ticks?
+        if ( mRequestTicks )
+        {
+            // Yes, so skip if the provider has not requested a tick.
+            if ( !pProvider->mAnimationTickPending )
+                continue;
+
+            pProvider->mAnimationTickPending = false;
+        }
+
+        // Skip if the animation is paused or has finished.
+        if ( pProvider->mAnimationPaused || pProvider->mAnimationFinished )
+            continue;
+
+        // Update current time.
+        F32 currentTime = pProvider->mCurrentTime + elapsedTime * pProvider->mAnimationTimeScale;
+
+        // Check if the animation has finished.
+        if ( !animationCycle && mGreaterThanOrEqual(currentTime, totalIntegrationTime) )
+        {
+            // Animation has finished.
+            pProvider->mAnimationFinished = true;
+            mFinishedProviders.push_back( pProvider );
+
+            // Fix Animation at end of frames.
+            currentTime = finishedTime;
+        }
+
+        pProvider->mCurrentTime = currentTime;
+
+        // Update Current Mod Time.
+        const F32 currentModTime = mFmod( currentTime, totalIntegrationTime );
+        pProvider->mCurrentModTime = currentModTime;
+
+        // Calculate Current Frame.
+        S32 frameIndex = (S32)(currentModTime / frameIntegrationTime);
+        if ( frameIndex >= validatedFrameCount )
+            frameIndex = validatedFrameCount-1;
+
+        // Skip if the frame has not changed.
+        if ( frameIndex == pProvider->mLastFrameIndex )
+            continue;
+
+        pProvider->mCurrentFrameIndex = frameIndex;
+        pProvider->mLastFrameIndex = frameIndex;
+
+        // Fetch frame.
+        S32 frame = pValidatedFrames[frameIndex];
+
+        // Clamp frames.
+        if ( frame < 0 )
+            frame = 0;
+        else if ( frame >= imageFrameCount )
+            frame = imageFrameCount-1;
+
+        // Resolve the frame.
+        pProvider->mCurrentFrame = (U32)frame;
+    }
+}
@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _IMAGE_FRAME_ANIMATOR_H_
+#define _IMAGE_FRAME_ANIMATOR_H_
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#ifndef _HASHTABLE_H
+#include "collection/hashTable.h"
+#endif
+
+//------------------------------------------------------------------------------  
+
+class AnimationAsset;
+class ImageFrameProviderCore;
+
+//------------------------------------------------------------------------------  
+
+/// Integrates the animations of many image-frame providers in a single pass.
+/// Providers are grouped by their animation asset so that the asset timing and frames
+/// are only fetched once per group and the per-provider work is a tight array walk.
+class ImageFrameAnimator
+{
+public:
+    typedef Vector<ImageFrameProviderCore*> typeProviderVector;
+
+    /// All the providers playing the same animation asset.
+    struct AnimationGroup
+    {
+        ImageFrameAnimator*     mpOwner;
+        const AnimationAsset*   mpAnimationAsset;
+        typeProviderVector      mProviders;
+    };
+
+    typedef HashMap<const AnimationAsset*, AnimationGroup*> typeAnimationGroupHash;
+    typedef Vector<AnimationGroup*> typeAnimationGroupVector;
+
+private:
+    typeAnimationGroupHash      mAnimationGroupHash;
+    typeAnimationGroupVector    mAnimationGroups;
+    typeProviderVector          mFinishedProviders;
+    bool                        mRequestTicks;
+
+public:
+    ImageFrameAnimator( const bool requestTicks );
+    virtual ~ImageFrameAnimator();
+
+    /// Providers.
+    /// NOTE:-  Removing a provider also cancels its end-of-animation callback if it is still waiting for it.
+    void addProvider( ImageFrameProviderCore* pProvider );
+    void removeProvider( ImageFrameProviderCore* pProvider );
+    void clearProviders( void );
+    U32 getProviderCount( void ) const;
+    inline U32 getGroupCount( void ) const { return (U32)mAnimationGroups.size(); }
+
+    /// When requesting ticks, only providers that have requested an update since the last pass are advanced.
+    inline bool getRequestTicks( void ) const { return mRequestTicks; }
+
+    /// Integration.
+    void update( const F32 elapsedTime );
+
+    /// The animator that integrates self-ticking providers using the tick period.
+    static ImageFrameAnimator* getSelfTickAnimator( void );
+    static void destroySelfTickAnimator( void );
+
+private:
+    void updateGroup( AnimationGroup* pAnimationGroup, const F32 elapsedTime );
+};
+
+#endif // _IMAGE_FRAME_ANIMATOR_H_
@@ -47,7 +47,15 @@
 
 //-----------------------------------------------------------------------------
 
-ImageFrameProviderCore::ImageFrameProviderCore() : mpImageAsset(NULL), mpAnimationAsset(NULL)
+ImageFrameProviderCore::ImageFrameProviderCore() :
+    mpImageAsset(NULL),
+    mpAnimationAsset(NULL),
+    mCurrentFrame(0),
+    mpAnimator(NULL),
+    mpAnimatorGroup(NULL),
+    mAnimatorIndex(0),
+    mAnimationTickPending(false),
+    mpAnimationEndAnimator(NULL)
 {
 }
 
@@ -95,8 +103,11 @@ void ImageFrameProviderCore::resetState( void )
     mFrameIntegrationTime = 0.0f;
     mAnimationPaused = false;
     mAnimationFinished = true;
+    mCurrentFrame = 0;
 
     clearAssets();
+
+    mpAnimator = NULL;
 }
 
 //-----------------------------------------------------------------------------
@@ -145,6 +156,14 @@ bool ImageFrameProviderCore::update( const F32 elapsedTime )
     if ( isAnimationPaused() )
         return true;
 
+    // Is an animator integrating the animation?
+    if ( isAnimatorAttached() )
+    {
+        // Yes, so request that the animator advances it.
+        mAnimationTickPending = true;
+        return false;
+    }
+
     // Update the animation.
     updateAnimation( Tickable::smTickSec );
 
@@ -172,6 +191,43 @@ void ImageFrameProviderCore::processTick( void )
 
 //------------------------------------------------------------------------------
 
+void ImageFrameProviderCore::setProcessTicks( bool tick )
+{
+    // Fetch the animator that integrates this provider.
+    ImageFrameAnimator* pAnimator = mSelfTick ? ImageFrameAnimator::getSelfTickAnimator() : mpAnimator;
+
+    // Should the animator integrate the animation?
+    if ( tick && pAnimator != NULL && !isStaticFrameProvider() && !isAnimationFinished() && mpAnimationAsset != NULL && mpAnimationAsset->notNull() )
+    {
+        // Yes, so add to the animator.
+        pAnimator->addProvider( this );
+        return;
+    }
+
+    // No, so remove from the animator.
+    if ( isAnimatorAttached() )
+        mpAnimatorGroup->mpOwner->removeProvider( this );
+    else if ( mpAnimationEndAnimator != NULL )
+        mpAnimationEndAnimator->removeProvider( this );
+}
+
+//------------------------------------------------------------------------------
+
+void ImageFrameProviderCore::setAnimator( ImageFrameAnimator* pAnimator )
+{
+    // Finish if no change.
+    if ( pAnimator == mpAnimator )
+        return;
+
+    // Set the animator.
+    mpAnimator = pAnimator;
+
+    // Move to the animator if the animation is playing.
+    setProcessTicks( !isStaticFrameProvider() && !isAnimationFinished() );
+}
+
+//------------------------------------------------------------------------------
+
 bool ImageFrameProviderCore::validRender( void ) const
 {
     // Are we in static mode?
@@ -323,22 +379,6 @@ bool ImageFrameProviderCore::setImageFrame( const U32 frame )
 
 //-----------------------------------------------------------------------------
 
-const U32 ImageFrameProviderCore::getCurrentAnimationFrame( void ) const
-{
-    // Sanity!
-    AssertFatal( mpAnimationAsset->notNull(), "Animation controller requested current image frame but no animation asset assigned." );
-
-    // Fetch validated frames.
-    const Vector<S32>& validatedFrames = (*mpAnimationAsset)->getValidatedAnimationFrames();
-
-    // Sanity!
-    AssertFatal( mCurrentFrameIndex < validatedFrames.size(), "Animation controller requested the current frame but it is out of bounds of the validated frames." );
-
-    return validatedFrames[mCurrentFrameIndex];
-};
-
-//-----------------------------------------------------------------------------
-
 bool ImageFrameProviderCore::isAnimationValid( void ) const
 {
     // Not valid if no animation asset.
@@ -383,6 +423,9 @@ bool ImageFrameProviderCore::setAnimation( const char* pAnimationAssetId )
     // Reset static asset.
     mpImageAsset->clear();
 
+    // Remove from the animator as the animation asset may change.
+    setProcessTicks( false );
+
     // Fetch animation asset.
     mpAnimationAsset->setAssetId( pAnimationAssetId );
 
@@ -458,6 +501,10 @@ bool ImageFrameProviderCore::playAnimation( const AssetPtr<AnimationAsset>& anim
     // Do an initial animation update.
     updateAnimation(0.0f);
 
+    // Move to the group for this animation if an animator is integrating us.
+    if ( isAnimatorAttached() )
+        mpAnimatorGroup->mpOwner->addProvider( this );
+
     // Return Okay.
     return true;
 }
@@ -518,6 +565,9 @@ bool ImageFrameProviderCore::updateAnimation( const F32 elapsedTime )
     else if (frame >= imageFrameCount )
         frame = imageFrameCount-1;
 
+    // Resolve the frame.
+    mCurrentFrame = (U32)frame;
+
     // Calculate if frame has changed.
     bool frameChanged = (mCurrentFrameIndex != mLastFrameIndex);
 
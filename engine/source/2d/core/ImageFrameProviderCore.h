@@ -51,6 +51,10 @@
 #include "gui/guiControl.h"
 #endif
 
+#ifndef _IMAGE_FRAME_ANIMATOR_H_
+#include "2d/core/ImageFrameAnimator.h"
+#endif
+
 ///-----------------------------------------------------------------------------
 
 class ImageFrameProviderCore :
@@ -58,6 +62,8 @@ class ImageFrameProviderCore :
     public IFactoryObjectReset,
     protected AssetPtrCallback
 {
+    friend class ImageFrameAnimator;
+
 protected:
     bool                                    mSelfTick;
 
@@ -78,13 +84,20 @@ protected:
     F32                                     mFrameIntegrationTime;
     bool                                    mAnimationPaused;
     bool                                    mAnimationFinished;
+    U32                                     mCurrentFrame;
+
+    ImageFrameAnimator*                     mpAnimator;
+    ImageFrameAnimator::AnimationGroup*     mpAnimatorGroup;
+    U32                                     mAnimatorIndex;
+    bool                                    mAnimationTickPending;
+    ImageFrameAnimator*                     mpAnimationEndAnimator;
 
 public:
     ImageFrameProviderCore();
     virtual ~ImageFrameProviderCore();
 
     void allocateAssets( AssetPtr<ImageAsset>* pImageAssetPtr, AssetPtr<AnimationAsset>* pAnimationAssetPtr );
-    inline void deallocateAssets( void ) { mpImageAsset = NULL; mpAnimationAsset = NULL; }
+    inline void deallocateAssets( void ) { setProcessTicks( false ); mpImageAsset = NULL; mpAnimationAsset = NULL; }
 
     virtual void copyTo( ImageFrameProviderCore* pImageFrameProviderCore ) const;
 
@@ -93,9 +106,14 @@ public:
     virtual void processTick();
     virtual void interpolateTick( F32 delta ) {};
     virtual void advanceTime( F32 timeDelta ) {};
-    virtual void setProcessTicks( bool tick  ) { Tickable::setProcessTicks( mSelfTick ? tick : false ); }
+    virtual void setProcessTicks( bool tick  );
     bool updateAnimation( const F32 elapsedTime );
 
+    /// Batched integration.
+    void setAnimator( ImageFrameAnimator* pAnimator );
+    inline ImageFrameAnimator* getAnimator( void ) const { return mpAnimator; }
+    inline bool isAnimatorAttached( void ) const { return mpAnimatorGroup != NULL; }
+
     virtual bool validRender( void ) const;
 
     virtual void render(
@@ -137,7 +155,7 @@ public:
 
     inline const AnimationAsset* getCurrentAnimation( void ) const { return mpAnimationAsset->notNull() ? *mpAnimationAsset : NULL; };
     inline const StringTableEntry getCurrentAnimationAssetId( void ) const { return mpAnimationAsset->getAssetId(); };
-    const U32 getCurrentAnimationFrame( void ) const;
+    inline const U32 getCurrentAnimationFrame( void ) const { AssertFatal( mpAnimationAsset->notNull(), "Animation controller requested current image frame but no animation asset assigned." ); return mCurrentFrame; }
     inline const F32 getCurrentAnimationTime( void ) const { return mCurrentTime; };
 
     void clearAssets( void );
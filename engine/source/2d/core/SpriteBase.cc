@@ -24,6 +24,10 @@
 #include "2d/core/SpriteBase.h"
 #endif
 
+#ifndef _SCENE_H_
+#include "2d/scene/Scene.h"
+#endif
+
 #ifndef _DGL_H_
 #include "graphics/dgl.h"
 #endif
@@ -61,6 +65,28 @@ void SpriteBase::initPersistFields()
 
 //-----------------------------------------------------------------------------
 
+void SpriteBase::OnRegisterScene( Scene* pScene )
+{
+    // Call parent.
+    Parent::OnRegisterScene( pScene );
+
+    // Use the scene animator.
+    ImageFrameProvider::setAnimator( pScene->getImageFrameAnimator() );
+}
+
+//-----------------------------------------------------------------------------
+
+void SpriteBase::OnUnregisterScene( Scene* pScene )
+{
+    // Stop using the scene animator.
+    ImageFrameProvider::setAnimator( NULL );
+
+    // Call parent.
+    Parent::OnUnregisterScene( pScene );
+}
+
+//-----------------------------------------------------------------------------
+
 void SpriteBase::integrateObject( const F32 totalTime, const F32 elapsedTime, DebugStats* pDebugStats )
 {
     // Call Parent.
@@ -54,6 +54,9 @@ public:
     DECLARE_CONOBJECT( SpriteBase );
 
 protected:
+    virtual void OnRegisterScene( Scene* pScene );
+    virtual void OnUnregisterScene( Scene* pScene );
+
     virtual void onAnimationEnd( void );
 
 protected:
@@ -46,7 +46,9 @@ SpriteBatch::SpriteBatch() :
     mDefaultSpriteSize( 1.0f, 1.0f ),
     mDefaultSpriteAngle( 0.0f ),
     mpSpriteBatchQuery( NULL ),
-    mBatchCulling( true )
+    mBatchCulling( true ),
+    mBatchStatic( false ),
+    mBatchChunkSize( 16.0f )
 {
     // Reset batch transform.
     mBatchTransform.SetIdentity();
@@ -99,6 +101,14 @@ void SpriteBatch::prepareRender( SceneRenderObject* pSceneRenderObject, const Sc
     // Calculate local AABB.
     const b2AABB localAABB = calculateLocalAABB( pSceneRenderState->mRenderAABB );
 
+    // Are we using static chunks?
+    if ( mBatchStatic )
+    {
+        // Yes, so prepare the static chunks instead of the individual sprites.
+        prepareStaticRender( pSceneRenderObject, localAABB, pSceneRenderQueue );
+        return;
+    }
+
     // Do we have a sprite batch query?
     if ( mpSpriteBatchQuery != NULL )
     {
@@ -181,6 +191,29 @@ void SpriteBatch::prepareRender( SceneRenderObject* pSceneRenderObject, const Sc
 
 void SpriteBatch::render( const SceneRenderState* pSceneRenderState, const SceneRenderRequest* pSceneRenderRequest, BatchRender* pBatchRenderer )
 {
+    // Is this a static vertex block?
+    if ( pSceneRenderRequest->mpCustomData2 != NULL )
+    {
+        // Yes, so fetch vertex block.
+        SpriteBatchChunk::VertexBlock* pVertexBlock = (SpriteBatchChunk::VertexBlock*)pSceneRenderRequest->mpCustomData2;
+
+        // Set the blend mode.
+        pBatchRenderer->setBlendMode( pSceneRenderRequest );
+
+        // Set the alpha test mode.
+        pBatchRenderer->setAlphaTestMode( pSceneRenderRequest );
+
+        // Render the vertex block.
+        pBatchRenderer->RenderVertexBlock(
+            mBatchTransform,
+            pVertexBlock->mVertices.address(),
+            pVertexBlock->mTextureCoords.address(),
+            pVertexBlock->getQuadCount(),
+            pVertexBlock->mTexture );
+
+        return;
+    }
+
     // Fetch sprite batch Item.
     SpriteBatchItem* pSpriteBatchItem = (SpriteBatchItem*)pSceneRenderRequest->mpCustomData1;
 
@@ -275,6 +308,10 @@ void SpriteBatch::copyTo( SpriteBatch* pSpriteBatch ) const
     // Set batch culling.
     pSpriteBatch->setBatchCulling( getBatchCulling() );
 
+    // Set batch static chunks.
+    pSpriteBatch->setBatchChunkSize( getBatchChunkSize() );
+    pSpriteBatch->setBatchStatic( getBatchStatic() );
+
     // Set sprite default size and angle.
     pSpriteBatch->setDefaultSpriteStride( getDefaultSpriteStride() );
     pSpriteBatch->setDefaultSpriteSize( getDefaultSpriteSize() );
@@ -370,6 +407,9 @@ void SpriteBatch::clearSprites( void )
     // Clear sprite names.
     mSpriteNames.clear();
 
+    // Destroy any static chunks.
+    destroyStaticChunks();
+
     // Cache all sprites.
     for( typeSpriteBatchHash::iterator spriteItr = mSprites.begin(); spriteItr != mSprites.end(); ++spriteItr )
     {
@@ -402,6 +442,71 @@ void SpriteBatch::setBatchCulling( const bool batchCulling )
 
 //------------------------------------------------------------------------------
 
+void SpriteBatch::setBatchStatic( const bool batchStatic )
+{
+    // Finish if no change.
+    if ( mBatchStatic == batchStatic )
+        return;
+
+    // Set batch static.
+    mBatchStatic = batchStatic;
+
+    // Create/destroy static chunks appropriately.
+    if ( mBatchStatic )
+        createStaticChunks();
+    else
+        destroyStaticChunks();
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatch::setBatchChunkSize( const F32 chunkSize )
+{
+    // Is the chunk size valid?
+    if ( chunkSize <= 0.0f )
+    {
+        // No, so warn.
+        Con::warnf( "SpriteBatch::setBatchChunkSize() - Invalid chunk size of '%g'.", chunkSize );
+        return;
+    }
+
+    // Finish if no change.
+    if ( mIsEqual( mBatchChunkSize, chunkSize ) )
+        return;
+
+    // Set chunk size.
+    mBatchChunkSize = chunkSize;
+
+    // Finish if not using static chunks.
+    if ( !mBatchStatic )
+        return;
+
+    // Rebuild the static chunks.
+    destroyStaticChunks();
+    createStaticChunks();
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatch::updateStaticChunks( void )
+{
+    // Finish if there are no pending sprites.
+    if ( mPendingStaticSprites.size() == 0 )
+        return;
+
+    // Debug Profiling.
+    PROFILE_SCOPE(SpriteBatch_UpdateStaticChunks);
+
+    // Add the pending sprites to their chunks.
+    for ( Vector<SpriteBatchItem*>::iterator spriteItr = mPendingStaticSprites.begin(); spriteItr != mPendingStaticSprites.end(); ++spriteItr )
+    {
+        addStaticSprite( *spriteItr );
+    }
+    mPendingStaticSprites.clear();
+}
+
+//------------------------------------------------------------------------------
+
 bool SpriteBatch::selectSprite( const SpriteBatchItem::LogicalPosition& logicalPosition )
 {
     // Select sprite.
@@ -1018,6 +1123,11 @@ SpriteBatchItem* SpriteBatch::createSprite( void )
     // Create sprite batch item,
     mSprites.insert( batchId, pSpriteBatchItem );
 
+    // Queue the sprite for a static chunk if needed.
+    // NOTE: The chunk is chosen later so that the sprite has been positioned.
+    if ( mBatchStatic )
+        mPendingStaticSprites.push_back( pSpriteBatchItem );
+
     return pSpriteBatchItem;
 }
 
@@ -1237,6 +1347,47 @@ void SpriteBatch::destroySpriteBatchQuery( void )
 
 //------------------------------------------------------------------------------
 
+void SpriteBatch::createStaticChunks( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SpriteBatch_CreateStaticChunks);
+
+    // Finish if static chunks are off.
+    if ( !mBatchStatic )
+        return;
+
+    // Queue all the sprites for static chunks.
+    for( typeSpriteBatchHash::iterator spriteItr = mSprites.begin(); spriteItr != mSprites.end(); ++spriteItr )
+    {
+        // Skip if already in a chunk.
+        if ( spriteItr->value->getStaticChunk() != NULL )
+            continue;
+
+        mPendingStaticSprites.push_back( spriteItr->value );
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatch::destroyStaticChunks( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SpriteBatch_DestroyStaticChunks);
+
+    // Delete the chunks.
+    // NOTE: This also detaches the sprites from them.
+    for( typeStaticChunkHash::iterator chunkItr = mStaticChunks.begin(); chunkItr != mStaticChunks.end(); ++chunkItr )
+    {
+        delete chunkItr->value;
+    }
+    mStaticChunks.clear();
+
+    // Clear pending sprites.
+    mPendingStaticSprites.clear();
+}
+
+//------------------------------------------------------------------------------
+
 bool SpriteBatch::destroySprite( const U32 batchId )
 {
     // Debug Profiling.
@@ -1255,6 +1406,10 @@ bool SpriteBatch::destroySprite( const U32 batchId )
     // Sanity!
     AssertFatal( pSpriteBatchItem != NULL, "SpriteBatch::destroySprite() - Found sprite but it was NULL." );
 
+    // Remove from any static chunk.
+    if ( mBatchStatic )
+        removeStaticSprite( pSpriteBatchItem );
+
     // Cache sprite.
     SpriteBatchItemFactory.cacheObject( pSpriteBatchItem );
 
@@ -1280,6 +1435,162 @@ bool SpriteBatch::checkSpriteSelected( void ) const
 
 //------------------------------------------------------------------------------
 
+void SpriteBatch::prepareStaticRender( SceneRenderObject* pSceneRenderObject, const b2AABB& localAABB, SceneRenderQueue* pSceneRenderQueue )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SpriteBatch_PrepareStaticRender);
+
+    // Add any pending sprites to their chunks.
+    updateStaticChunks();
+
+    // Prepare the chunks.
+    for( typeStaticChunkHash::iterator chunkItr = mStaticChunks.begin(); chunkItr != mStaticChunks.end(); ++chunkItr )
+    {
+        // Fetch chunk.
+        SpriteBatchChunk* pChunk = chunkItr->value;
+
+        // Bake the chunk if it has changed.
+        if ( pChunk->getDirty() )
+            pChunk->bake();
+
+        // Skip if the chunk is not in view.
+        if ( !b2TestOverlap( pChunk->getLocalAABB(), localAABB ) )
+            continue;
+
+        // Fetch vertex blocks.
+        const SpriteBatchChunk::typeVertexBlockVector& vertexBlocks = pChunk->getVertexBlocks();
+
+        // Add a render request for each vertex block.
+        for ( SpriteBatchChunk::typeVertexBlockVector::const_iterator blockItr = vertexBlocks.begin(); blockItr != vertexBlocks.end(); ++blockItr )
+        {
+            // Fetch vertex block.
+            SpriteBatchChunk::VertexBlock* pVertexBlock = *blockItr;
+
+            // Create a render request.
+            SceneRenderRequest* pSceneRenderRequest = pSceneRenderQueue->createRenderRequest();
+
+            // Prepare vertex block.
+            pSceneRenderRequest->mWorldPosition = b2Mul( mBatchTransform, pVertexBlock->mLocalAABB.GetCenter() );
+            pSceneRenderRequest->mDepth = pVertexBlock->mDepth;
+            pSceneRenderRequest->mSerialId = (S32)pChunk->getCellKey();
+            pSceneRenderRequest->mRenderGroup = pVertexBlock->mRenderGroup;
+            pSceneRenderRequest->mBlendMode = pVertexBlock->mBlendMode;
+            pSceneRenderRequest->mSrcBlendFactor = pVertexBlock->mSrcBlendFactor;
+            pSceneRenderRequest->mDstBlendFactor = pVertexBlock->mDstBlendFactor;
+            pSceneRenderRequest->mBlendColor = pVertexBlock->mBlendColor;
+            pSceneRenderRequest->mAlphaTest = pVertexBlock->mAlphaTest;
+
+            // Set identity.
+            pSceneRenderRequest->mpSceneRenderObject = pSceneRenderObject;
+
+            // Set custom data.
+            pSceneRenderRequest->mpCustomData1 = pChunk;
+            pSceneRenderRequest->mpCustomData2 = pVertexBlock;
+        }
+
+        // Fetch dynamic sprites.
+        const SpriteBatchChunk::typeSpriteVector& dynamicSprites = pChunk->getDynamicSprites();
+
+        // Add a render request for each dynamic sprite.
+        for ( SpriteBatchChunk::typeSpriteVector::const_iterator spriteItr = dynamicSprites.begin(); spriteItr != dynamicSprites.end(); ++spriteItr )
+        {
+            // Fetch sprite batch Item.
+            SpriteBatchItem* pSpriteBatchItem = *spriteItr;
+
+            // Create a render request.
+            SceneRenderRequest* pSceneRenderRequest = pSceneRenderQueue->createRenderRequest();
+
+            // Prepare batch item.
+            pSpriteBatchItem->prepareRender( pSceneRenderRequest, mBatchTransformId );
+
+            // Set identity.
+            pSceneRenderRequest->mpSceneRenderObject = pSceneRenderObject;
+
+            // Set custom data.
+            pSceneRenderRequest->mpCustomData1 = pSpriteBatchItem;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatch::addStaticSprite( SpriteBatchItem* pSpriteBatchItem )
+{
+    // Fetch the cell key.
+    const U32 cellKey = getStaticCellKey( pSpriteBatchItem->getLocalPosition() );
+
+    // Find the chunk.
+    typeStaticChunkHash::iterator chunkItr = mStaticChunks.find( cellKey );
+
+    SpriteBatchChunk* pChunk;
+
+    // Did we find the chunk?
+    if ( chunkItr == mStaticChunks.end() )
+    {
+        // No, so create it.
+        pChunk = new SpriteBatchChunk( cellKey );
+        mStaticChunks.insert( cellKey, pChunk );
+    }
+    else
+    {
+        // Yes, so fetch it.
+        pChunk = chunkItr->value;
+    }
+
+    // Add sprite to chunk.
+    pChunk->addSprite( pSpriteBatchItem );
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatch::removeStaticSprite( SpriteBatchItem* pSpriteBatchItem )
+{
+    // Fetch chunk.
+    SpriteBatchChunk* pChunk = pSpriteBatchItem->getStaticChunk();
+
+    // Is the sprite in a chunk?
+    if ( pChunk == NULL )
+    {
+        // No, so remove it from the pending sprites.
+        for ( Vector<SpriteBatchItem*>::iterator spriteItr = mPendingStaticSprites.begin(); spriteItr != mPendingStaticSprites.end(); ++spriteItr )
+        {
+            if ( *spriteItr != pSpriteBatchItem )
+                continue;
+
+            mPendingStaticSprites.erase( spriteItr );
+            break;
+        }
+
+        return;
+    }
+
+    // Remove sprite from chunk.
+    pChunk->removeSprite( pSpriteBatchItem );
+
+    // Finish if the chunk still has sprites.
+    if ( pChunk->getSpriteCount() > 0 )
+        return;
+
+    // Destroy the empty chunk.
+    mStaticChunks.erase( pChunk->getCellKey() );
+    delete pChunk;
+}
+
+//------------------------------------------------------------------------------
+
+U32 SpriteBatch::getStaticCellKey( const Vector2& localPosition ) const
+{
+    // Calculate the cell.
+    const S32 cellX = (S32)mFloor( localPosition.x / mBatchChunkSize );
+    const S32 cellY = (S32)mFloor( localPosition.y / mBatchChunkSize );
+
+    // Pack the cell into a key.
+    // NOTE: Cells that are 65536 chunks apart share a key which only costs culling efficiency.
+    return (U32)(cellX & 0xFFFF) | ((U32)(cellY & 0xFFFF) << 16);
+}
+
+//------------------------------------------------------------------------------
+
 b2AABB SpriteBatch::calculateLocalAABB( const b2AABB& renderAABB )
 {
     // Debug Profiling.
@@ -46,6 +46,7 @@ protected:
     typedef HashMap< U32, SpriteBatchItem* > typeSpriteBatchHash;
     typedef HashMap< SpriteBatchItem::LogicalPosition, SpriteBatchItem* > typeSpritePositionHash;
     typedef HashMap< StringTableEntry, SpriteBatchItem* > typeSpriteNameHash;
+    typedef HashMap< U32, SpriteBatchChunk* > typeStaticChunkHash;
 
     typeSpriteBatchHash             mSprites;
     typeSpritePositionHash          mSpritePositions;
@@ -56,6 +57,8 @@ protected:
     Vector2                         mDefaultSpriteStride;
     Vector2                         mDefaultSpriteSize;
     F32                             mDefaultSpriteAngle;
+    bool                            mBatchStatic;
+    F32                             mBatchChunkSize;
 
 private:
     SpriteBatchQuery*               mpSpriteBatchQuery;
@@ -68,6 +71,9 @@ private:
     Vector2                         mLocalExtents;
     bool                            mLocalExtentsDirty;
 
+    typeStaticChunkHash             mStaticChunks;
+    Vector<SpriteBatchItem*>        mPendingStaticSprites;
+
 public:
     SpriteBatch();
     virtual ~SpriteBatch();
@@ -106,6 +112,15 @@ public:
     void setBatchCulling( const bool batchCulling );
     inline bool getBatchCulling( void ) const { return mBatchCulling; }
 
+    void setBatchStatic( const bool batchStatic );
+    inline bool getBatchStatic( void ) const { return mBatchStatic; }
+
+    void setBatchChunkSize( const F32 chunkSize );
+    inline F32 getBatchChunkSize( void ) const { return mBatchChunkSize; }
+
+    void updateStaticChunks( void );
+    inline U32 getStaticChunkCount( void ) const { return (U32)mStaticChunks.size(); }
+
     inline void setDefaultSpriteStride( const Vector2& defaultStride ) { mDefaultSpriteStride = defaultStride; }
     inline const Vector2& getDefaultSpriteStride( void ) const { return mDefaultSpriteStride; }
 
@@ -195,6 +210,9 @@ protected:
     void createSpriteBatchQuery( void );
     void destroySpriteBatchQuery( void );
 
+    void createStaticChunks( void );
+    void destroyStaticChunks( void );
+
     void onTamlCustomWrite( TamlCustomNodes& customNodes  );
     void onTamlCustomRead( const TamlCustomNodes& customNodes );
 
@@ -202,6 +220,11 @@ private:
     bool destroySprite( const U32 batchId );
     bool checkSpriteSelected( void ) const;
 
+    void prepareStaticRender( SceneRenderObject* pSceneRenderObject, const b2AABB& localAABB, SceneRenderQueue* pSceneRenderQueue );
+    void addStaticSprite( SpriteBatchItem* pSpriteBatchItem );
+    void removeStaticSprite( SpriteBatchItem* pSpriteBatchItem );
+    U32 getStaticCellKey( const Vector2& localPosition ) const;
+
     b2AABB calculateLocalAABB( const b2AABB& renderAABB );
 };
 
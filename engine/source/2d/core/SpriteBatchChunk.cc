@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _SPRITE_BATCH_CHUNK_H_
+#include "2d/core/SpriteBatchChunk.h"
+#endif
+
+#ifndef _SPRITE_BATCH_ITEM_H_
+#include "2d/core/SpriteBatchItem.h"
+#endif
+
+#ifndef _BATCH_RENDER_H_
+#include "2d/core/BatchRender.h"
+#endif
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+//------------------------------------------------------------------------------
+
+SpriteBatchChunk::SpriteBatchChunk( const U32 cellKey ) :
+    mCellKey( cellKey ),
+    mDirty( true )
+{
+    mLocalAABB.lowerBound.SetZero();
+    mLocalAABB.upperBound.SetZero();
+}
+
+//------------------------------------------------------------------------------
+
+SpriteBatchChunk::~SpriteBatchChunk()
+{
+    // Clear sprites.
+    clearSprites();
+
+    // Clear vertex blocks.
+    clearVertexBlocks();
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatchChunk::addSprite( SpriteBatchItem* pSpriteBatchItem )
+{
+    // Sanity!
+    AssertFatal( pSpriteBatchItem != NULL, "SpriteBatchChunk::addSprite() - Cannot add a NULL sprite." );
+    AssertFatal( pSpriteBatchItem->mpStaticChunk == NULL, "SpriteBatchChunk::addSprite() - Sprite is already in a chunk." );
+
+    // Add sprite.
+    mSprites.push_back( pSpriteBatchItem );
+    pSpriteBatchItem->mpStaticChunk = this;
+
+    // Flag as dirty.
+    setDirty();
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatchChunk::removeSprite( SpriteBatchItem* pSpriteBatchItem )
+{
+    // Sanity!
+    AssertFatal( pSpriteBatchItem != NULL, "SpriteBatchChunk::removeSprite() - Cannot remove a NULL sprite." );
+    AssertFatal( pSpriteBatchItem->mpStaticChunk == this, "SpriteBatchChunk::removeSprite() - Sprite is not in this chunk." );
+
+    // Find sprite.
+    for ( typeSpriteVector::iterator spriteItr = mSprites.begin(); spriteItr != mSprites.end(); ++spriteItr )
+    {
+        if ( *spriteItr != pSpriteBatchItem )
+            continue;
+
+        // Remove sprite.
+        mSprites.erase_fast( spriteItr );
+        pSpriteBatchItem->mpStaticChunk = NULL;
+
+        // Flag as dirty.
+        setDirty();
+        return;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatchChunk::clearSprites( void )
+{
+    // Detach all sprites.
+    for ( typeSpriteVector::iterator spriteItr = mSprites.begin(); spriteItr != mSprites.end(); ++spriteItr )
+    {
+        (*spriteItr)->mpStaticChunk = NULL;
+    }
+
+    mSprites.clear();
+    mDynamicSprites.clear();
+
+    // Flag as dirty.
+    setDirty();
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatchChunk::bake( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SpriteBatchChunk_Bake);
+
+    // Clear any previous bake.
+    clearVertexBlocks();
+    mDynamicSprites.clear();
+
+    // Flag as NOT dirty.
+    mDirty = false;
+
+    bool firstSprite = true;
+
+    // Bake the sprites.
+    for ( typeSpriteVector::iterator spriteItr = mSprites.begin(); spriteItr != mSprites.end(); ++spriteItr )
+    {
+        // Fetch sprite batch item.
+        SpriteBatchItem* pSpriteBatchItem = *spriteItr;
+
+        // Combine the sprite with the chunk bounds.
+        // NOTE: Sprites belong to the cell they were added in but the bounds always reflect where they currently are.
+        const b2AABB& spriteAABB = pSpriteBatchItem->getLocalAABB();
+        if ( firstSprite )
+        {
+            mLocalAABB = spriteAABB;
+            firstSprite = false;
+        }
+        else
+        {
+            mLocalAABB.Combine( spriteAABB );
+        }
+
+        // Skip if not visible.
+        if ( !pSpriteBatchItem->getVisible() )
+            continue;
+
+        // Is the sprite animated?
+        if ( !pSpriteBatchItem->isStaticFrameProvider() )
+        {
+            // Yes, so it cannot be baked so render it individually.
+            mDynamicSprites.push_back( pSpriteBatchItem );
+            continue;
+        }
+
+        // Skip if the sprite cannot render.
+        if ( !pSpriteBatchItem->validRender() )
+            continue;
+
+        // Fetch texture and vertex block.
+        TextureHandle& texture = pSpriteBatchItem->getProviderTexture();
+        VertexBlock* pVertexBlock = findVertexBlock( pSpriteBatchItem, texture );
+
+        // Fetch texel area.
+        ImageAsset::FrameArea::TexelArea texelArea = pSpriteBatchItem->getProviderImageFrameArea().mTexelArea;
+
+        // Flip texture coordinates appropriately.
+        texelArea.setFlip( pSpriteBatchItem->getFlipX(), pSpriteBatchItem->getFlipY() );
+
+        // Fetch lower/upper texture coordinates.
+        const Vector2& texLower = texelArea.mTexelLower;
+        const Vector2& texUpper = texelArea.mTexelUpper;
+
+        // Fetch local OOBB.
+        const Vector2* pLocalOOBB = pSpriteBatchItem->getLocalOOBB();
+
+        // Add the quad.
+        // NOTE: We swap #2/#3 here as the batch renderer does.
+        pVertexBlock->mVertices.push_back( pLocalOOBB[0] );
+        pVertexBlock->mVertices.push_back( pLocalOOBB[1] );
+        pVertexBlock->mVertices.push_back( pLocalOOBB[3] );
+        pVertexBlock->mVertices.push_back( pLocalOOBB[2] );
+        pVertexBlock->mTextureCoords.push_back( Vector2( texLower.x, texUpper.y ) );
+        pVertexBlock->mTextureCoords.push_back( Vector2( texUpper.x, texUpper.y ) );
+        pVertexBlock->mTextureCoords.push_back( Vector2( texLower.x, texLower.y ) );
+        pVertexBlock->mTextureCoords.push_back( Vector2( texUpper.x, texLower.y ) );
+
+        // Combine the sprite with the block bounds.
+        if ( pVertexBlock->getQuadCount() == 1 )
+            pVertexBlock->mLocalAABB = spriteAABB;
+        else
+            pVertexBlock->mLocalAABB.Combine( spriteAABB );
+    }
+}
+
+//------------------------------------------------------------------------------
+
+SpriteBatchChunk::VertexBlock* SpriteBatchChunk::findVertexBlock( const SpriteBatchItem* pSpriteBatchItem, TextureHandle& texture )
+{
+    // Search for a vertex block with a matching render state.
+    for ( typeVertexBlockVector::iterator blockItr = mVertexBlocks.begin(); blockItr != mVertexBlocks.end(); ++blockItr )
+    {
+        VertexBlock* pVertexBlock = *blockItr;
+
+        if (    pVertexBlock->mTexture == texture &&
+                pVertexBlock->mBlendMode == pSpriteBatchItem->getBlendMode() &&
+                pVertexBlock->mSrcBlendFactor == pSpriteBatchItem->getSrcBlendFactor() &&
+                pVertexBlock->mDstBlendFactor == pSpriteBatchItem->getDstBlendFactor() &&
+                pVertexBlock->mBlendColor == pSpriteBatchItem->getBlendColor() &&
+                mIsEqual( pVertexBlock->mAlphaTest, pSpriteBatchItem->getAlphaTest() ) &&
+                mIsEqual( pVertexBlock->mDepth, pSpriteBatchItem->getDepth() ) &&
+                pVertexBlock->mRenderGroup == pSpriteBatchItem->getRenderGroup() &&
+                pVertexBlock->getQuadCount() < BATCHRENDER_MAXQUADS )
+            return pVertexBlock;
+    }
+
+    // Not found so create a vertex block.
+    VertexBlock* pVertexBlock = new VertexBlock();
+    pVertexBlock->mTexture = texture;
+    pVertexBlock->mBlendMode = pSpriteBatchItem->getBlendMode();
+    pVertexBlock->mSrcBlendFactor = pSpriteBatchItem->getSrcBlendFactor();
+    pVertexBlock->mDstBlendFactor = pSpriteBatchItem->getDstBlendFactor();
+    pVertexBlock->mBlendColor = pSpriteBatchItem->getBlendColor();
+    pVertexBlock->mAlphaTest = pSpriteBatchItem->getAlphaTest();
+    pVertexBlock->mDepth = pSpriteBatchItem->getDepth();
+    pVertexBlock->mRenderGroup = pSpriteBatchItem->getRenderGroup();
+    mVertexBlocks.push_back( pVertexBlock );
+
+    return pVertexBlock;
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatchChunk::clearVertexBlocks( void )
+{
+    // Delete vertex blocks.
+    for ( typeVertexBlockVector::iterator blockItr = mVertexBlocks.begin(); blockItr != mVertexBlocks.end(); ++blockItr )
+    {
+        delete (*blockItr);
+    }
+    mVertexBlocks.clear();
+}
@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _SPRITE_BATCH_CHUNK_H_
+#define _SPRITE_BATCH_CHUNK_H_
+
+#ifndef _VECTOR2_H_
+#include "2d/core/Vector2.h"
+#endif
+
+#ifndef _TEXTURE_MANAGER_H_
+#include "graphics/TextureManager.h"
+#endif
+
+#ifndef _COLOR_H_
+#include "graphics/color.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//------------------------------------------------------------------------------  
+
+class SpriteBatchItem;
+
+//------------------------------------------------------------------------------  
+
+/// A spatial cell of sprites whose static geometry is baked into prebuilt vertex blocks.
+/// The chunk is only rebaked when one of its sprites flags it as dirty.
+class SpriteBatchChunk
+{
+public:
+    /// A block of quads in batch-local space that share the same texture and render state.
+    struct VertexBlock
+    {
+        TextureHandle       mTexture;
+        bool                mBlendMode;
+        GLenum              mSrcBlendFactor;
+        GLenum              mDstBlendFactor;
+        ColorF              mBlendColor;
+        F32                 mAlphaTest;
+        F32                 mDepth;
+        StringTableEntry    mRenderGroup;
+        Vector<Vector2>     mVertices;
+        Vector<Vector2>     mTextureCoords;
+        b2AABB              mLocalAABB;
+
+        inline U32 getQuadCount( void ) const { return (U32)mVertices.size() / 4; }
+    };
+
+    typedef Vector<SpriteBatchItem*> typeSpriteVector;
+    typedef Vector<VertexBlock*> typeVertexBlockVector;
+
+private:
+    U32                     mCellKey;
+    typeSpriteVector        mSprites;
+    typeSpriteVector        mDynamicSprites;
+    typeVertexBlockVector   mVertexBlocks;
+    b2AABB                  mLocalAABB;
+    bool                    mDirty;
+
+public:
+    SpriteBatchChunk( const U32 cellKey );
+    ~SpriteBatchChunk();
+
+    inline U32 getCellKey( void ) const { return mCellKey; }
+
+    inline void setDirty( void ) { mDirty = true; }
+    inline bool getDirty( void ) const { return mDirty; }
+
+    void addSprite( SpriteBatchItem* pSpriteBatchItem );
+    void removeSprite( SpriteBatchItem* pSpriteBatchItem );
+    void clearSprites( void );
+    inline U32 getSpriteCount( void ) const { return (U32)mSprites.size(); }
+
+    /// Rebuild the vertex blocks from the sprites.
+    void bake( void );
+
+    inline const typeVertexBlockVector& getVertexBlocks( void ) const { return mVertexBlocks; }
+    inline const typeSpriteVector& getDynamicSprites( void ) const { return mDynamicSprites; }
+    inline const b2AABB& getLocalAABB( void ) const { return mLocalAABB; }
+
+private:
+    VertexBlock* findVertexBlock( const SpriteBatchItem* pSpriteBatchItem, TextureHandle& texture );
+    void clearVertexBlocks( void );
+};
+
+#endif // _SPRITE_BATCH_CHUNK_H_
@@ -59,7 +59,9 @@ static StringTableEntry spriteDataObjectName        = StringTable->insert("DataO
 
 //------------------------------------------------------------------------------
 
-SpriteBatchItem::SpriteBatchItem() : mProxyId( SpriteBatch::INVALID_SPRITE_PROXY )
+SpriteBatchItem::SpriteBatchItem() :
+    mProxyId( SpriteBatch::INVALID_SPRITE_PROXY ),
+    mpStaticChunk( NULL )
 {
     resetState();
 }
@@ -88,6 +90,9 @@ void SpriteBatchItem::resetState( void )
         mSpriteBatch->destroyQueryProxy( this );
     }
 
+    // Sanity!
+    AssertFatal( mpStaticChunk == NULL, "Cannot reset a sprite that is still in a static chunk." );
+
     mSpriteBatch = NULL;
     mBatchId = 0;
     mName = StringTable->EmptyString;
@@ -176,6 +181,50 @@ void SpriteBatchItem::copyTo( SpriteBatchItem* pSpriteBatchItem ) const
 
 //------------------------------------------------------------------------------
 
+bool SpriteBatchItem::setImage( const char* pImageAssetId, const U32 frame )
+{
+    // Flag the static chunk as dirty.
+    setStaticDirty();
+
+    // Call parent.
+    return Parent::setImage( pImageAssetId, frame );
+}
+
+//------------------------------------------------------------------------------
+
+bool SpriteBatchItem::setImageFrame( const U32 frame )
+{
+    // Flag the static chunk as dirty.
+    setStaticDirty();
+
+    // Call parent.
+    return Parent::setImageFrame( frame );
+}
+
+//------------------------------------------------------------------------------
+
+bool SpriteBatchItem::setAnimation( const char* pAnimationAssetId )
+{
+    // Flag the static chunk as dirty.
+    setStaticDirty();
+
+    // Call parent.
+    return Parent::setAnimation( pAnimationAssetId );
+}
+
+//------------------------------------------------------------------------------
+
+void SpriteBatchItem::clearAssets( void )
+{
+    // Flag the static chunk as dirty.
+    setStaticDirty();
+
+    // Call parent.
+    Parent::clearAssets();
+}
+
+//------------------------------------------------------------------------------
+
 void SpriteBatchItem::prepareRender( SceneRenderRequest* pSceneRenderRequest, const U32 batchTransformId )
 {
     // Debug Profiling.
@@ -303,6 +352,17 @@ void SpriteBatchItem::updateWorldTransform( const U32 batchTransformId )
 
 //------------------------------------------------------------------------------
 
+void SpriteBatchItem::onAssetRefreshed( AssetPtrBase* pAssetPtrBase )
+{
+    // Flag the static chunk as dirty.
+    setStaticDirty();
+
+    // Call parent.
+    Parent::onAssetRefreshed( pAssetPtrBase );
+}
+
+//------------------------------------------------------------------------------
+
 void SpriteBatchItem::onTamlCustomWrite( TamlCustomNode* pParentNode )
 {
     // Add sprite node.
@@ -713,4 +773,4 @@ void SpriteBatchItem::WriteCustomTamlSchema( const AbstractClassRep* pClassRep,
     pBatchItemLogicalPosition->SetAttribute( "name", spriteLogicalPositionName );
     pBatchItemLogicalPosition->SetAttribute( "type", "xs:string" );
     pBatchItemComplexTypeElement->LinkEndChild( pBatchItemLogicalPosition );
-}
+}
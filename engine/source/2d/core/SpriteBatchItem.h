@@ -27,6 +27,10 @@
 #include "2d/core/imageFrameProvider.h"
 #endif
 
+#ifndef _SPRITE_BATCH_CHUNK_H_
+#include "2d/core/SpriteBatchChunk.h"
+#endif
+
 //------------------------------------------------------------------------------  
 
 class SpriteBatch;
@@ -41,6 +45,7 @@ extern StringTableEntry spritesItemTypeName;
 class SpriteBatchItem : public ImageFrameProvider
 {
     friend class SpriteBatch;
+    friend class SpriteBatchChunk;
 
     typedef ImageFrameProvider Parent;
 
@@ -221,6 +226,8 @@ protected:
 
     U32                 mSpriteBatchQueryKey;
 
+    SpriteBatchChunk*   mpStaticChunk;
+
     void*               mUserData;
 
 public:
@@ -237,46 +244,47 @@ public:
     inline void setLogicalPosition( const LogicalPosition& logicalPosition ) { mLogicalPosition = logicalPosition; }
     inline const LogicalPosition& getLogicalPosition( void ) const { return mLogicalPosition; }
 
-    inline void setVisible( const bool visible ) { mVisible = visible; }
+    inline void setVisible( const bool visible ) { mVisible = visible; setStaticDirty(); }
     inline bool getVisible( void ) const { return mVisible; }
 
-    inline void setLocalPosition( const Vector2& localPosition ) { mLocalPosition = localPosition; mLocalTransformDirty = true; }
+    inline void setLocalPosition( const Vector2& localPosition ) { mLocalPosition = localPosition; mLocalTransformDirty = true; setStaticDirty(); }
     inline Vector2 getLocalPosition( void ) const { return mLocalPosition; }
 
-    inline void setLocalAngle( const F32 localAngle ) { mLocalAngle = localAngle; mLocalTransformDirty = true; }
+    inline void setLocalAngle( const F32 localAngle ) { mLocalAngle = localAngle; mLocalTransformDirty = true; setStaticDirty(); }
     inline F32 getLocalAngle( void ) const { return mLocalAngle; }
 
-    inline void setSize( const Vector2& size ) { mSize = size; mLocalTransformDirty = true; }
+    inline void setSize( const Vector2& size ) { mSize = size; mLocalTransformDirty = true; setStaticDirty(); }
     inline Vector2 getSize( void ) const { return mSize; }
 
     inline const b2AABB& getLocalAABB( void ) { if ( mLocalTransformDirty ) updateLocalTransform(); return mLocalAABB; }
+    inline const Vector2* getLocalOOBB( void ) { if ( mLocalTransformDirty ) updateLocalTransform(); return mLocalOOBB; }
 
-    void setDepth( const F32 depth ) { mDepth = depth; }
+    void setDepth( const F32 depth ) { mDepth = depth; setStaticDirty(); }
     F32 getDepth( void ) const { return mDepth; }
 
-    inline void setFlipX( const bool flipX ) { mFlipX = flipX; }
+    inline void setFlipX( const bool flipX ) { mFlipX = flipX; setStaticDirty(); }
     inline bool getFlipX( void ) const { return mFlipX; }
 
-    inline void setFlipY( const bool flipY ) { mFlipY = flipY; }
+    inline void setFlipY( const bool flipY ) { mFlipY = flipY; setStaticDirty(); }
     inline bool getFlipY( void ) const { return mFlipY; }
 
     inline void setSortPoint( const Vector2& sortPoint ) { mSortPoint = sortPoint; }
     inline Vector2 getSortPoint( void ) const { return mSortPoint; }
-    inline void setRenderGroup( const char* pRenderGroup ) { mRenderGroup = StringTable->insert( pRenderGroup ); }
+    inline void setRenderGroup( const char* pRenderGroup ) { mRenderGroup = StringTable->insert( pRenderGroup ); setStaticDirty(); }
     inline StringTableEntry getRenderGroup( void ) const { return mRenderGroup; }
 
-    inline void setBlendMode( const bool blendMode ) { mBlendMode = blendMode; }
+    inline void setBlendMode( const bool blendMode ) { mBlendMode = blendMode; setStaticDirty(); }
     inline bool getBlendMode( void ) const { return mBlendMode; }
-    inline void setSrcBlendFactor( GLenum srcBlendFactor ) { mSrcBlendFactor = srcBlendFactor; }
+    inline void setSrcBlendFactor( GLenum srcBlendFactor ) { mSrcBlendFactor = srcBlendFactor; setStaticDirty(); }
     inline GLenum getSrcBlendFactor( void ) const { return mSrcBlendFactor; }
-    inline void setDstBlendFactor( GLenum dstBlendFactor ) { mDstBlendFactor = dstBlendFactor; }
+    inline void setDstBlendFactor( GLenum dstBlendFactor ) { mDstBlendFactor = dstBlendFactor; setStaticDirty(); }
     inline GLenum getDstBlendFactor( void ) const { return mDstBlendFactor; }
-    inline void setBlendColor( const ColorF& blendColor ) { mBlendColor = blendColor; }
+    inline void setBlendColor( const ColorF& blendColor ) { mBlendColor = blendColor; setStaticDirty(); }
     inline const ColorF& getBlendColor( void ) const { return mBlendColor; }
-    inline void setBlendAlpha( const F32 alpha ) { mBlendColor.alpha = alpha; }
+    inline void setBlendAlpha( const F32 alpha ) { mBlendColor.alpha = alpha; setStaticDirty(); }
     inline F32 getBlendAlpha( void ) const { return mBlendColor.alpha; }
 
-    inline void setAlphaTest( const F32 alphaTest ) { mAlphaTest = alphaTest; }
+    inline void setAlphaTest( const F32 alphaTest ) { mAlphaTest = alphaTest; setStaticDirty(); }
     inline F32 getAlphaTest( void ) const { return mAlphaTest; }
 
     inline void setDataObject( SimObject* pDataObject ) { mDataObject = pDataObject; }
@@ -289,6 +297,15 @@ public:
     inline void setSpriteBatchQueryKey( const U32 key ) { mSpriteBatchQueryKey = key; }
     inline U32  getSpriteBatchQueryKey( void ) const { return mSpriteBatchQueryKey; }
 
+    inline SpriteBatchChunk* getStaticChunk( void ) const { return mpStaticChunk; }
+    inline void setStaticDirty( void ) { if ( mpStaticChunk != NULL ) mpStaticChunk->setDirty(); }
+
+    using Parent::setImage;
+    virtual bool setImage( const char* pImageAssetId, const U32 frame );
+    virtual bool setImageFrame( const U32 frame );
+    virtual bool setAnimation( const char* pAnimationAssetId );
+    void clearAssets( void );
+
     virtual void copyTo( SpriteBatchItem* pSpriteBatchItem ) const;
 
     inline const Vector2* getRenderOOBB( void ) const { return mRenderOOBB; }
@@ -305,6 +322,8 @@ protected:
     void updateLocalTransform( void );
     void updateWorldTransform( const U32 batchTransformId );
 
+    virtual void onAssetRefreshed( AssetPtrBase* pAssetPtrBase );
+
     void onTamlCustomWrite( TamlCustomNode* pParentNode );
     void onTamlCustomRead( const TamlCustomNode* pSpriteNode );
 };
@@ -64,6 +64,16 @@ static StringTableEntry mouseEventLeaveName            = StringTable->insert("on
 
 //-----------------------------------------------------------------------------
 
+static S32 QSORT_CALLBACK sceneObjectIdSort(const void* a, const void* b)
+{
+    const SimObjectId idA = (*((SceneObject**)a))->getId();
+    const SimObjectId idB = (*((SceneObject**)b))->getId();
+
+    return idA < idB ? -1 : idA > idB ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+
 IMPLEMENT_CONOBJECT(SceneWindow);
 
 //-----------------------------------------------------------------------------
@@ -113,11 +123,13 @@ SceneWindow::SceneWindow() :    mpScene(NULL),
                                 mUseObjectInputEvents(false),
                                 mInputEventGroupMaskFilter(MASK_ALL),
                                 mInputEventLayerMaskFilter(MASK_ALL),
-                                mInputEventInvisibleFilter( true )
+                                mInputEventInvisibleFilter( true ),
+                                mInputEventPickValid( false )
 {
     // Set Vector Associations.
     VECTOR_SET_ASSOCIATION( mCameraQueue );
-    VECTOR_SET_ASSOCIATION( mInputEventQuery );
+    VECTOR_SET_ASSOCIATION( mInputEventPick );
+    VECTOR_SET_ASSOCIATION( mInputEventWatched );
     VECTOR_SET_ASSOCIATION( mInputEventEntering );
     VECTOR_SET_ASSOCIATION( mInputEventLeaving );    
 
@@ -225,6 +237,9 @@ void SceneWindow::resetScene( void )
     // Clear input event watched objects.
     mInputEventWatching.clear();
 
+    // Invalidate the input event pick.
+    invalidateInputEventPick();
+
     // Reset scene.
     mpScene = NULL;
 }
@@ -800,6 +815,9 @@ void SceneWindow::setObjectInputEventFilter( const U32 groupMask, const U32 laye
     mInputEventGroupMaskFilter = groupMask;
     mInputEventLayerMaskFilter = layerMask;
     mInputEventInvisibleFilter = useInvisible;
+
+    // Invalidate the input event pick.
+    invalidateInputEventPick();
 }
 
 //-----------------------------------------------------------------------------
@@ -810,6 +828,9 @@ void SceneWindow::setObjectInputEventGroupFilter( const U32 groupMask )
 
     // Clear existing watched input events.
     clearWatchedInputEvents();
+
+    // Invalidate the input event pick.
+    invalidateInputEventPick();
 }
 
 //-----------------------------------------------------------------------------
@@ -820,6 +841,9 @@ void SceneWindow::setObjectInputEventLayerFilter( const U32 layerMask )
 
     // Clear existing watched input events.
     clearWatchedInputEvents();
+
+    // Invalidate the input event pick.
+    invalidateInputEventPick();
 }
 
 //-----------------------------------------------------------------------------
@@ -830,6 +854,9 @@ void SceneWindow::setObjectInputEventInvisibleFilter( const bool useInvisible )
 
     // Clear existing watched input events.
     clearWatchedInputEvents();
+
+    // Invalidate the input event pick.
+    invalidateInputEventPick();
 }
 
 //-----------------------------------------------------------------------------
@@ -1029,93 +1056,80 @@ void SceneWindow::sendObjectInputEvent( StringTableEntry name, const GuiEvent& e
             name == inputEventDraggedName ) )
         return;
 
+    // Calculate Current Camera View.
+    calculateCameraView( &mCameraCurrent );
+
     // Convert Event-Position into scene coordinates.
     Vector2 worldMousePoint;
     windowToScenePoint(Vector2(globalToLocalCoord(event.mousePoint)), worldMousePoint);
 
-    // Fetch old pick count.
-    const U32 oldPickCount = (U32)mInputEventWatching.size();
-
-    // Fetch world query and clear results.
-    WorldQuery* pWorldQuery = getScene()->getWorldQuery( true );
-
-    // Set filter.
-    WorldQueryFilter queryFilter( mInputEventLayerMaskFilter, mInputEventGroupMaskFilter, true, mInputEventInvisibleFilter, true, true );
-    pWorldQuery->setQueryFilter( queryFilter );
+    // Fetch the picked objects.
+    const typeSceneObjectVector& pickedObjects = pickInputEventObjects( worldMousePoint );
 
-    // Perform world query.
-    const U32 newPickCount = pWorldQuery->anyQueryPoint( worldMousePoint );
+    // Fetch old and new pick counts.
+    const U32 oldPickCount = (U32)mInputEventWatching.size();
+    const U32 newPickCount = (U32)pickedObjects.size();
 
     // Early-out if nothing to do.
     if ( newPickCount == 0 && oldPickCount == 0 )
         return;
 
-    // Fetch results.
-    mInputEventQuery = pWorldQuery->getQueryResults();
-    pWorldQuery->clearQuery();
-
-    // Determine "enter" events.
-    for( U32 newIndex = 0; newIndex < newPickCount; ++newIndex )
+    // Fetch the watched objects sorted by Id.
+    mInputEventWatched.clear();
+    for ( SimSet::iterator watchedItr = mInputEventWatching.begin(); watchedItr != mInputEventWatching.end(); ++watchedItr )
     {
-        // Fetch new scene object.
-        SceneObject* pNewSceneObject = mInputEventQuery[newIndex].mpSceneObject;
-
-        // Ignore object if it's not using input events.
-        // NOTE:-   We only check this for "enter" events in-case the option is
-        //          changed whilst it's currently picked.  We want to guarantee
-        //          that any "enter" event is paired with a "leave" event.
-        if ( !pNewSceneObject->getUseInputEvents() )
-            continue;
-
-        bool alreadyPresent = false;
-
-        for ( U32 oldIndex = 0; oldIndex < oldPickCount; ++oldIndex )
-        {
-            // Skip if scene object is not present...
-            if ( mInputEventWatching[oldIndex] != pNewSceneObject )
-                continue;
+        // Fetch old scene object.
+        SceneObject* pOldSceneObject = dynamic_cast<SceneObject*>( *watchedItr );
 
-            // Flag as already present.
-            alreadyPresent = true;
-            break;
-        }
+        // Sanity!
+        AssertFatal( pOldSceneObject != NULL, "Invalid object found in mouse-event pick vector." );
 
-        // Add scene object as entering if not already present.
-        if ( !alreadyPresent )
-            mInputEventEntering.push_back( pNewSceneObject );
+        mInputEventWatched.push_back( pOldSceneObject );
     }
+    dQsort( mInputEventWatched.address(), mInputEventWatched.size(), sizeof(SceneObject*), sceneObjectIdSort );
 
-    // Determine "leave" events.
-    for ( U32 oldIndex = 0; oldIndex < oldPickCount; ++oldIndex )
+    // Determine "enter" and "leave" events by walking both sorted picks.
+    U32 newIndex = 0;
+    U32 oldIndex = 0;
+    while ( newIndex < newPickCount || oldIndex < oldPickCount )
     {
-        // Fetch old scene object.
-        SceneObject* pOldSceneObject = dynamic_cast<SceneObject*>( mInputEventWatching[oldIndex] );
+        // Fetch the next Ids.
+        const SimObjectId newId = newIndex < newPickCount ? pickedObjects[newIndex]->getId() : 0;
+        const SimObjectId oldId = oldIndex < oldPickCount ? mInputEventWatched[oldIndex]->getId() : 0;
 
-        // Sanity!
-        AssertFatal( pOldSceneObject != NULL, "Invalid object found in mouse-event pick vector." );
+        // Is the new scene object not present in the old pick?
+        if ( oldIndex == oldPickCount || ( newIndex < newPickCount && newId < oldId ) )
+        {
+            // Yes, so fetch new scene object.
+            SceneObject* pNewSceneObject = pickedObjects[newIndex++];
 
-        bool stillPresent = false;
+            // Add scene object as entering if it's using input events.
+            // NOTE:-   We only check this for "enter" events in-case the option is
+            //          changed whilst it's currently picked.  We want to guarantee
+            //          that any "enter" event is paired with a "leave" event.
+            if ( pNewSceneObject->getUseInputEvents() )
+                mInputEventEntering.push_back( pNewSceneObject );
 
-        for( U32 newIndex = 0; newIndex < newPickCount; ++newIndex )
-        {
-            // Skip if scene object is not present.
-            if ( mInputEventQuery[newIndex].mpSceneObject != pOldSceneObject )
-                continue;
+            continue;
+        }
 
-            // Flag as still present.
-            stillPresent = true;
-            break;
+        // Is the old scene object not present in the new pick?
+        if ( newIndex == newPickCount || oldId < newId )
+        {
+            // Yes, so add scene object as leaving.
+            mInputEventLeaving.push_back( mInputEventWatched[oldIndex++] );
+            continue;
         }
 
-        // Add scene object as leaving if not still present.
-        if ( !stillPresent )
-            mInputEventLeaving.push_back( pOldSceneObject );
+        // Scene object is still present.
+        newIndex++;
+        oldIndex++;
     }
 
-    for ( U32 index = 0; index < (U32)mInputEventQuery.size(); ++index )
+    for ( U32 index = 0; index < newPickCount; ++index )
     {
         // Fetch scene object.
-        SceneObject* pSceneObject = mInputEventQuery[index].mpSceneObject;
+        SceneObject* pSceneObject = pickedObjects[index];
 
         // Ignore object if it's not using input events.
         if ( !pSceneObject->getUseInputEvents() )
@@ -1156,13 +1170,56 @@ void SceneWindow::sendObjectInputEvent( StringTableEntry name, const GuiEvent& e
     }
 
     // Clear input event vectors.
-    mInputEventQuery.clear();
+    mInputEventWatched.clear();
     mInputEventEntering.clear();
     mInputEventLeaving.clear();
 }
 
 //-----------------------------------------------------------------------------
 
+const typeSceneObjectVector& SceneWindow::pickInputEventObjects( const Vector2& worldPoint )
+{
+    // Reuse the pick if nothing has changed since it was made.
+    // NOTE:-   The pick is invalidated when the window renders, when the scene ticks and when objects are
+    //          added or removed so all input events between those changes share it.  Camera changes alter
+    //          the world point so they never reuse a stale pick.
+    if ( mInputEventPickValid && mInputEventPickPoint == worldPoint )
+        return mInputEventPick;
+
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneWindow_PickInputEventObjects);
+
+    // Fetch world query and clear results.
+    WorldQuery* pWorldQuery = getScene()->getWorldQuery( true );
+
+    // Set filter.
+    WorldQueryFilter queryFilter( mInputEventLayerMaskFilter, mInputEventGroupMaskFilter, true, mInputEventInvisibleFilter, true, true );
+    pWorldQuery->setQueryFilter( queryFilter );
+
+    // Perform world query.
+    pWorldQuery->anyQueryPoint( worldPoint );
+
+    // Fetch results.
+    const typeWorldQueryResultVector& queryResults = pWorldQuery->getQueryResults();
+    mInputEventPick.clear();
+    for ( typeWorldQueryResultVector::const_iterator resultItr = queryResults.begin(); resultItr != queryResults.end(); ++resultItr )
+    {
+        mInputEventPick.push_back( resultItr->mpSceneObject );
+    }
+    pWorldQuery->clearQuery();
+
+    // Sort the pick by Id.
+    dQsort( mInputEventPick.address(), mInputEventPick.size(), sizeof(SceneObject*), sceneObjectIdSort );
+
+    // Flag the pick as valid.
+    mInputEventPickPoint = worldPoint;
+    mInputEventPickValid = true;
+
+    return mInputEventPick;
+}
+
+//-----------------------------------------------------------------------------
+
 void SceneWindow::onMouseEnter( const GuiEvent& event )
 {
     // Dispatch input event.
@@ -1619,6 +1676,9 @@ void SceneWindow::onRender( Point2I offset, const RectI& updateRect )
     if ( !pScene )
         return;
 
+    // The scene is about to change on-screen so invalidate the input event pick.
+    invalidateInputEventPick();
+
     // Calculate current camera View ( if needed ).
     calculateCameraView( &mCameraCurrent );
 
@@ -131,7 +131,10 @@ private:
     U32                 mInputEventGroupMaskFilter;
     U32                 mInputEventLayerMaskFilter;
     bool                mInputEventInvisibleFilter;
-    typeWorldQueryResultVector mInputEventQuery;
+    typeSceneObjectVector mInputEventPick;
+    Vector2             mInputEventPickPoint;
+    bool                mInputEventPickValid;
+    typeSceneObjectVector mInputEventWatched;
     typeSceneObjectVector mInputEventEntering;
     typeSceneObjectVector mInputEventLeaving;
     SimSet              mInputEventWatching;
@@ -147,6 +150,7 @@ private:
     void dispatchInputEvent( StringTableEntry name, const GuiEvent& event );
     void sendWindowInputEvent( StringTableEntry name, const GuiEvent& event );
     void sendObjectInputEvent( StringTableEntry, const GuiEvent& event );
+    const typeSceneObjectVector& pickInputEventObjects( const Vector2& worldPoint );
 
     inline void calculateCameraView( CameraView* pCameraView );
 
@@ -202,7 +206,8 @@ public:
     inline bool getUseWindowInputEvents( void ) const { return mUseWindowInputEvents; };
     inline bool getUseObjectInputEvents( void ) const { return mUseObjectInputEvents; };
     inline void clearWatchedInputEvents( void ) { mInputEventWatching.clear(); }
-    inline void removeFromInputEventPick(SceneObject* pSceneObject ) { mInputEventWatching.removeObject((SimObject*)pSceneObject); }
+    inline void removeFromInputEventPick(SceneObject* pSceneObject ) { mInputEventWatching.removeObject((SimObject*)pSceneObject); mInputEventPickValid = false; }
+    inline void invalidateInputEventPick( void ) { mInputEventPickValid = false; }
 
     void addInputListener( SimObject* pSimObject );
     void removeInputListener( SimObject* pSimObject );
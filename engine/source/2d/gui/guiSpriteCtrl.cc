@@ -178,6 +178,10 @@ void GuiSpriteCtrl::onRender( Point2I offset, const RectI &updateRect)
 {
 	// Call parent.
 	ImageFrameProvider::renderGui( *this, offset, updateRect );
+
+    // Keep animations updating when the canvas only redraws dirty regions.
+    if ( !isStaticFrameProvider() )
+        setUpdate();
 }
 
 //------------------------------------------------------------------------------
@@ -107,6 +107,21 @@ public:
         if ( worldProfile.solvePosition > maxWorldProfile.solvePosition ) maxWorldProfile.solvePosition = worldProfile.solvePosition;
         if ( worldProfile.broadphase > maxWorldProfile.broadphase ) maxWorldProfile.broadphase = worldProfile.broadphase;
         if ( worldProfile.solveTOI > maxWorldProfile.solveTOI ) maxWorldProfile.solveTOI = worldProfile.solveTOI;
+
+        // Trace counters.
+        if ( TraceProfiler::isEnabled() )
+        {
+            TraceProfiler::counter( "DebugStats_FPS", fps );
+            TraceProfiler::counter( "DebugStats_ObjectsVisible", (F32)objectsVisible );
+            TraceProfiler::counter( "DebugStats_ObjectsAwake", (F32)objectsAwake );
+            TraceProfiler::counter( "DebugStats_RenderRequests", (F32)renderRequests );
+            TraceProfiler::counter( "DebugStats_BodyCount", (F32)bodyCount );
+            TraceProfiler::counter( "DebugStats_ContactCount", (F32)contactCount );
+            TraceProfiler::counter( "DebugStats_BatchFlushes", (F32)batchFlushes );
+            TraceProfiler::counter( "DebugStats_BatchTrianglesSubmitted", (F32)batchTrianglesSubmitted );
+            TraceProfiler::counter( "DebugStats_ParticlesUsed", (F32)particlesUsed );
+            TraceProfiler::counter( "DebugStats_WorldStep", worldProfile.step );
+        }
     }
 
     /// Reset debug stats.
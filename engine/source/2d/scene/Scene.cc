@@ -56,6 +56,10 @@
 #include "2d/core/particleSystem.h"
 #endif
 
+#ifndef _REPLAY_BENCHMARK_H_
+#include "game/replayBenchmark.h"
+#endif
+
 // Script bindings.
 #include "Scene_ScriptBinding.h"
 
@@ -152,6 +156,7 @@ Scene::Scene() :
     mWorldGravity(0.0f, 0.0f),
     mVelocityIterations(8),
     mPositionIterations(3),
+    mBodyPoolCapacity(256),
 
     /// Joint access.
     mJointMasterId(1),
@@ -160,6 +165,9 @@ Scene::Scene() :
     mSceneTime(0.0f),
     mScenePause(false),
 
+    /// Batched animation.
+    mImageFrameAnimator(true),
+
     /// Debug and metrics.
     mDebugMask(0X00000000),
     mpDebugSceneObject(NULL),
@@ -179,6 +187,7 @@ Scene::Scene() :
     VECTOR_SET_ASSOCIATION( mDeleteRequestsTemp );
     VECTOR_SET_ASSOCIATION( mEndContacts );
     VECTOR_SET_ASSOCIATION( mAssetPreloads );
+    VECTOR_SET_ASSOCIATION( mBodyPool );
      
     // Initialize layer sort mode.
     for ( U32 n = 0; n < MAX_LAYERS_SUPPORTED; ++n )
@@ -264,6 +273,9 @@ void Scene::onRemove()
     mpWorld->DestroyBody( mpGroundBody );
     mpGroundBody = NULL;
 
+    // Forget recycled bodies.  The world destroys them.
+    mBodyPool.clear();
+
     // Delete physics world and world query.
     delete mpWorldQuery;
     delete mpWorld;
@@ -280,6 +292,94 @@ void Scene::onRemove()
 
 //-----------------------------------------------------------------------------
 
+b2Body* Scene::createBody( const b2BodyDef& bodyDefinition )
+{
+    // Create a new body if none are recycled.
+    if ( mBodyPool.size() == 0 )
+        return mpWorld->CreateBody( &bodyDefinition );
+
+    // Fetch a recycled body.
+    b2Body* pBody = mBodyPool.last();
+    mBodyPool.pop_back();
+
+    // Configure it as the definition would.
+    // The body is inactive so none of this touches the broad-phase.
+    pBody->SetUserData( bodyDefinition.userData );
+    pBody->SetType( bodyDefinition.type );
+    pBody->SetTransform( bodyDefinition.position, bodyDefinition.angle );
+    pBody->SetLinearDamping( bodyDefinition.linearDamping );
+    pBody->SetAngularDamping( bodyDefinition.angularDamping );
+    pBody->SetGravityScale( bodyDefinition.gravityScale );
+    pBody->SetFixedRotation( bodyDefinition.fixedRotation );
+    pBody->SetBullet( bodyDefinition.bullet );
+    pBody->SetSleepingAllowed( bodyDefinition.allowSleep );
+    pBody->SetAwake( bodyDefinition.awake );
+    pBody->SetLinearVelocity( bodyDefinition.linearVelocity );
+    pBody->SetAngularVelocity( bodyDefinition.angularVelocity );
+    pBody->SetActive( bodyDefinition.active );
+
+    return pBody;
+}
+
+//-----------------------------------------------------------------------------
+
+void Scene::destroyBody( b2Body* pBody )
+{
+    // Sanity!
+    AssertFatal( pBody != NULL, "Scene::destroyBody() - Cannot destroy a NULL body." );
+    AssertFatal( pBody != mpGroundBody, "Scene::destroyBody() - Cannot destroy the ground body." );
+
+    // Destroy the body if the pool is full.
+    if ( mBodyPool.size() >= (S32)mBodyPoolCapacity )
+    {
+        mpWorld->DestroyBody( pBody );
+        return;
+    }
+
+    // Destroy attached joints as destroying the body would.
+    b2JointEdge* pJointEdge = pBody->GetJointList();
+    while ( pJointEdge != NULL )
+    {
+        b2Joint* pJoint = pJointEdge->joint;
+        pJointEdge = pJointEdge->next;
+
+        SayGoodbye( pJoint );
+        mpWorld->DestroyJoint( pJoint );
+    }
+
+    // Destroy fixtures.  This also destroys their contacts.
+    b2Fixture* pFixture = pBody->GetFixtureList();
+    while ( pFixture != NULL )
+    {
+        b2Fixture* pNextFixture = pFixture->GetNext();
+        pBody->DestroyFixture( pFixture );
+        pFixture = pNextFixture;
+    }
+
+    // Park the body where the solver ignores it.
+    pBody->SetActive( false );
+    pBody->SetAwake( false );
+    pBody->SetUserData( NULL );
+
+    mBodyPool.push_back( pBody );
+}
+
+//-----------------------------------------------------------------------------
+
+void Scene::setBodyPoolCapacity( const U32 capacity )
+{
+    mBodyPoolCapacity = capacity;
+
+    // Destroy any bodies beyond the new capacity.
+    while ( mBodyPool.size() > (S32)mBodyPoolCapacity )
+    {
+        mpWorld->DestroyBody( mBodyPool.last() );
+        mBodyPool.pop_back();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 void Scene::onDeleteNotify( SimObject* object )
 {
     // Ignore if we're not monitoring a debug banner scene object.
@@ -749,6 +849,12 @@ void Scene::processTick( void )
         // Update scene time.
         mSceneTime += Tickable::smTickSec;
 
+        // Objects are about to move so invalidate the SceneWindow input event picks.
+        for( U32 i = 0; i < (U32)mAttachedSceneWindows.size(); ++i )
+        {
+            (dynamic_cast<SceneWindow*>(mAttachedSceneWindows[i]))->invalidateInputEventPick();
+        }
+
         // Clear ticked scene objects.
         mTickedSceneObjects.clear();
 
@@ -846,7 +952,9 @@ void Scene::processTick( void )
         if ( isNormalScene )
         {
             // Step the physics.
+            ReplayBenchmark::beginSample( ReplayBenchmark::SamplePhysics );
             mpWorld->Step( Tickable::smTickSec, mVelocityIterations, mPositionIterations );
+            ReplayBenchmark::endSample( ReplayBenchmark::SamplePhysics );
         }
 
         // Debug Profiling.
@@ -869,6 +977,13 @@ void Scene::processTick( void )
             mTickedSceneObjects[i]->integrateObject( mSceneTime, Tickable::smTickSec, pDebugStats );
         }
 
+        // ****************************************************
+        // Integrate animations.
+        // ****************************************************
+
+        // Advance the animations of the objects that were integrated.
+        mImageFrameAnimator.update( Tickable::smTickSec );
+
         // ****************************************************
         // Post-Integrate Stage.
         // ****************************************************
@@ -1339,6 +1454,12 @@ void Scene::addToScene( SceneObject* pSceneObject )
     // Register with the scene.
     pSceneObject->OnRegisterScene( this );
 
+    // Invalidate the SceneWindow input event picks.
+    for( U32 i = 0; i < (U32)mAttachedSceneWindows.size(); ++i )
+    {
+        (dynamic_cast<SceneWindow*>(mAttachedSceneWindows[i]))->invalidateInputEventPick();
+    }
+
     // Perform callback only if properly added to the simulation.
     if ( pSceneObject->isProperlyAdded() )
     {
@@ -75,6 +75,10 @@
 #include "assets/assetPtr.h"
 #endif
 
+#ifndef _IMAGE_FRAME_ANIMATOR_H_
+#include "2d/core/ImageFrameAnimator.h"
+#endif
+
 //-----------------------------------------------------------------------------
 
 extern EnumTable jointTypeTable;
@@ -172,6 +176,7 @@ public:
     typedef Vector<TickContact>                 typeContactVector;
     typedef HashMap<b2Contact*, TickContact>    typeContactHash;
     typedef Vector<AssetPtr<AssetBase>*>        typeAssetPtrVector;
+    typedef Vector<b2Body*>                     typeBodyVector;
 
     /// Scene Debug Options.
     enum DebugOption
@@ -219,6 +224,10 @@ private:
     b2BlockAllocator            mBlockAllocator;
     b2Body*                     mpGroundBody;
 
+    /// Recycled physics bodies.
+    typeBodyVector              mBodyPool;
+    U32                         mBodyPoolCapacity;
+
     /// Scene occupancy.
     typeSceneObjectVector       mSceneObjects;
     typeSceneObjectVector       mTickedSceneObjects;
@@ -238,6 +247,9 @@ private:
     F32                         mSceneTime;
     bool                        mScenePause;
 
+    /// Batched animation.
+    ImageFrameAnimator          mImageFrameAnimator;
+
     /// Debug and metrics.
     DebugStats                  mDebugStats;
     U32                         mDebugMask;
@@ -332,6 +344,11 @@ public:
     inline WorldQuery*      getWorldQuery( const bool clearQuery = false ) { if ( clearQuery ) mpWorldQuery->clearQuery(); return mpWorldQuery; }
     b2BlockAllocator*       getBlockAllocator( void )                   { return &mBlockAllocator; }
     inline b2Body*          getGroundBody( void ) const                 { return mpGroundBody; }
+    b2Body*                 createBody( const b2BodyDef& bodyDefinition );
+    void                    destroyBody( b2Body* pBody );
+    void                    setBodyPoolCapacity( const U32 capacity );
+    inline U32              getBodyPoolCapacity( void ) const           { return mBodyPoolCapacity; }
+    inline U32              getBodyPoolCount( void ) const              { return mBodyPool.size(); }
     virtual ePhysicsProxyType getPhysicsProxyType( void ) const         { return PhysicsProxy::PHYSIC_PROXY_GROUNDBODY; }
     void                    setGravity( const b2Vec2& gravity )         { mWorldGravity = gravity; if (mpWorld) mpWorld->SetGravity( gravity ); }
     inline b2Vec2           getGravity( void )                          { if (mpWorld) mWorldGravity = mpWorld->GetGravity(); return mWorldGravity; }
@@ -355,6 +372,8 @@ public:
 
     inline SimSet*			getControllers( void )						{ return mControllers; }
 
+    inline ImageFrameAnimator* getImageFrameAnimator( void )            { return &mImageFrameAnimator; }
+
     inline S32              getAssetPreloadCount( void ) const          { return mAssetPreloads.size(); }
     const AssetPtr<AssetBase>* getAssetPreload( const S32 index ) const;
     void                    addAssetPreload( const char* pAssetId );
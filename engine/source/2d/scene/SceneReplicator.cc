@@ -0,0 +1,429 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "2d/scene/SceneReplicator.h"
+
+#ifndef _SCENE_H_
+#include "2d/scene/Scene.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "2d/sceneobject/SceneObject.h"
+#endif
+
+#ifndef _NETCONNECTION_H_
+#include "network/netConnection.h"
+#endif
+
+#ifndef _BITSTREAM_H_
+#include "io/bitStream.h"
+#endif
+
+#ifndef _CONSOLETYPES_H_
+#include "console/consoleTypes.h"
+#endif
+
+// Script bindings.
+#include "SceneReplicator_ScriptBinding.h"
+
+//-----------------------------------------------------------------------------
+
+IMPLEMENT_CO_NETOBJECT_V1(SceneReplicator);
+
+//-----------------------------------------------------------------------------
+
+SceneReplicator::SceneReplicator() :
+    mPositionQuantum( 0.01f ),
+    mAngleQuantum( 0.001f ),
+    mVelocityQuantum( 0.01f ),
+    mSource( FieldCount ),
+    mRefreshStamp( 0 ),
+    mReceiver( FieldCount )
+{
+    // Always ghost to every connection.
+    mNetFlags.set( ScopeAlways | Ghostable );
+}
+
+//-----------------------------------------------------------------------------
+
+SceneReplicator::~SceneReplicator()
+{
+    clearChannels();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::initPersistFields()
+{
+    // Call parent.
+    Parent::initPersistFields();
+
+    addProtectedField("PositionQuantum", TypeF32, Offset(mPositionQuantum, SceneReplicator), &setQuantum, &defaultProtectedGetFn, "The precision positions are sent with, in world units.");
+    addProtectedField("AngleQuantum", TypeF32, Offset(mAngleQuantum, SceneReplicator), &setQuantum, &defaultProtectedGetFn, "The precision angles and angular velocities are sent with, in radians.");
+    addProtectedField("VelocityQuantum", TypeF32, Offset(mVelocityQuantum, SceneReplicator), &setQuantum, &defaultProtectedGetFn, "The precision linear velocities are sent with, in world units per second.");
+}
+
+//-----------------------------------------------------------------------------
+
+bool SceneReplicator::setQuantum( void* obj, const char* data )
+{
+    SceneReplicator* pReplicator = static_cast<SceneReplicator*>( obj );
+
+    // The quanta are sent once when ghosting starts so they cannot change afterwards.
+    if ( pReplicator->isProperlyAdded() )
+    {
+        Con::warnf( "SceneReplicator::setQuantum() - Quanta cannot be changed once the replicator has been added." );
+        return false;
+    }
+
+    if ( dAtof( data ) <= 0.0f )
+    {
+        Con::warnf( "SceneReplicator::setQuantum() - Invalid quantum '%s'.", data );
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::onRemove()
+{
+    // Drop any connections and client objects.
+    clearChannels();
+    mReceiver.reset( this );
+
+    // Call parent.
+    Parent::onRemove();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::setScene( Scene* pScene )
+{
+    mScene = pScene;
+
+    // Client objects can move to the new scene straight away.
+    if ( isClientObject() && pScene != NULL )
+    {
+        for ( S32 slot = 0; slot < mGhostObjects.size(); ++slot )
+        {
+            SceneObject* pSceneObject = mGhostObjects[slot];
+
+            if ( pSceneObject == NULL || pSceneObject->getScene() == pScene )
+                continue;
+
+            if ( pSceneObject->getScene() != NULL )
+                pSceneObject->getScene()->removeFromScene( pSceneObject );
+
+            pScene->addToScene( pSceneObject );
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneReplicator::getReplicatedObjectCount( void ) const
+{
+    if ( isServerObject() )
+        return mSource.getActiveSlotCount();
+
+    U32 objectCount = 0;
+    for ( S32 slot = 0; slot < mGhostObjects.size(); ++slot )
+    {
+        if ( !mGhostObjects[slot].isNull() )
+            objectCount++;
+    }
+
+    return objectCount;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::quantizeObject( const SceneObject* pSceneObject, S32* pFields ) const
+{
+    const Vector2 position = pSceneObject->getPosition();
+    const Vector2 linearVelocity = pSceneObject->getLinearVelocity();
+
+    pFields[FieldPositionX]         = GhostDelta::quantize( position.x, mPositionQuantum );
+    pFields[FieldPositionY]         = GhostDelta::quantize( position.y, mPositionQuantum );
+    pFields[FieldAngle]             = GhostDelta::quantize( pSceneObject->getAngle(), mAngleQuantum );
+    pFields[FieldLinearVelocityX]   = GhostDelta::quantize( linearVelocity.x, mVelocityQuantum );
+    pFields[FieldLinearVelocityY]   = GhostDelta::quantize( linearVelocity.y, mVelocityQuantum );
+    pFields[FieldAngularVelocity]   = GhostDelta::quantize( pSceneObject->getAngularVelocity(), mAngleQuantum );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::applyFields( SceneObject* pSceneObject, const S32* pFields ) const
+{
+    pSceneObject->setPosition( Vector2( GhostDelta::dequantize( pFields[FieldPositionX], mPositionQuantum ), GhostDelta::dequantize( pFields[FieldPositionY], mPositionQuantum ) ) );
+    pSceneObject->setAngle( GhostDelta::dequantize( pFields[FieldAngle], mAngleQuantum ) );
+    pSceneObject->setLinearVelocity( Vector2( GhostDelta::dequantize( pFields[FieldLinearVelocityX], mVelocityQuantum ), GhostDelta::dequantize( pFields[FieldLinearVelocityY], mVelocityQuantum ) ) );
+    pSceneObject->setAngularVelocity( GhostDelta::dequantize( pFields[FieldAngularVelocity], mAngleQuantum ) );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::processTick()
+{
+    // Only the server tracks the scene.
+    if ( isClientObject() )
+        return;
+
+    if ( refreshSlots() )
+        setMaskBits( ObjectsMask );
+}
+
+//-----------------------------------------------------------------------------
+
+bool SceneReplicator::refreshSlots( void )
+{
+    bool changed = false;
+    S32 fields[FieldCount];
+    const U32 stamp = ++mRefreshStamp;
+
+    if ( !mScene.isNull() )
+    {
+        const U32 objectCount = mScene->getSceneObjectCount();
+
+        for ( U32 index = 0; index < objectCount; ++index )
+        {
+            SceneObject* pSceneObject = mScene->getSceneObject( index );
+            const SimObjectId objectId = pSceneObject->getId();
+
+            quantizeObject( pSceneObject, fields );
+
+            U32 slot;
+            typeSlotHash::iterator itr = mSlotHash.find( objectId );
+
+            if ( itr == mSlotHash.end() )
+            {
+                slot = mSource.allocateSlot( StringTable->insert( pSceneObject->getClassName() ), fields );
+
+                if ( slot >= (U32)mSlotIds.size() )
+                {
+                    mSlotIds.setSize( slot + 1 );
+                    mSlotStamps.setSize( slot + 1 );
+                }
+
+                mSlotIds[slot] = objectId;
+                mSlotHash.insert( objectId, slot );
+                changed = true;
+            }
+            else
+            {
+                slot = itr->value;
+                changed |= mSource.setFields( slot, fields );
+            }
+
+            mSlotStamps[slot] = stamp;
+        }
+    }
+
+    // Free the slots of objects that have left the scene.
+    const U32 slotCount = mSource.getSlotCount();
+
+    for ( U32 slot = 0; slot < slotCount; ++slot )
+    {
+        if ( !mSource.getSlot( slot ).mActive || mSlotStamps[slot] == stamp )
+            continue;
+
+        mSlotHash.erase( mSlotIds[slot] );
+        mSource.freeSlot( slot );
+        changed = true;
+    }
+
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+
+GhostDeltaChannel* SceneReplicator::findChannel( NetConnection* conn, const bool create )
+{
+    GhostDeltaChannel* pChannel = NULL;
+
+    for ( S32 index = 0; index < mChannels.size(); )
+    {
+        ConnectionChannel& channel = mChannels[index];
+
+        // Discard channels for connections that have gone.
+        if ( channel.mConnection.isNull() )
+        {
+            delete channel.mpChannel;
+            mChannels.erase_fast( index );
+            continue;
+        }
+
+        if ( channel.mConnection == conn )
+            pChannel = channel.mpChannel;
+
+        index++;
+    }
+
+    if ( pChannel == NULL && create )
+    {
+        pChannel = new GhostDeltaChannel( &mSource );
+
+        mChannels.increment();
+        mChannels.last().mConnection = conn;
+        mChannels.last().mpChannel = pChannel;
+    }
+
+    return pChannel;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::clearChannels( void )
+{
+    for ( S32 index = 0; index < mChannels.size(); ++index )
+        delete mChannels[index].mpChannel;
+
+    mChannels.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneReplicator::packUpdate( NetConnection* conn, U32 mask, BitStream* stream )
+{
+    GhostDeltaChannel* pChannel = findChannel( conn, true );
+
+    // Updates outside ghost packets, such as the event that delivers us as a ScopeAlways
+    // object, are never notified so they carry a snapshot the channel does not track.
+    const bool snapshot = !conn->isWritingGhostUpdates();
+
+    // Newly ghosted so the client knows nothing yet.
+    if ( stream->writeFlag( snapshot || (mask & InitialUpdateMask) ) )
+    {
+        pChannel->reset();
+
+        stream->write( mPositionQuantum );
+        stream->write( mAngleQuantum );
+        stream->write( mVelocityQuantum );
+    }
+
+    if ( snapshot )
+    {
+        // Create whatever did not fit with the first ghost updates.
+        if ( pChannel->writeSnapshot( stream ) )
+            setMaskBits( ObjectsMask );
+
+        return 0;
+    }
+
+    // The objects are always written so that every update is matched by a notification.
+    const bool pending = pChannel->writePacket( stream );
+
+    return pending ? (mask & ObjectsMask) : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::unpackUpdate( NetConnection* conn, BitStream* stream )
+{
+    if ( stream->readFlag() )
+    {
+        mReceiver.reset( this );
+
+        stream->read( &mPositionQuantum );
+        stream->read( &mAngleQuantum );
+        stream->read( &mVelocityQuantum );
+    }
+
+    if ( !mReceiver.readPacket( stream, this ) )
+        conn->setLastError( "Invalid scene replicator update." );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::onGhostUpdateNotify( NetConnection* conn, bool delivered )
+{
+    GhostDeltaChannel* pChannel = findChannel( conn, false );
+
+    if ( pChannel != NULL )
+        pChannel->packetNotify( delivered );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::onDeltaCreate( const U32 slot, StringTableEntry tag, const S32* pFields )
+{
+    // Create an object of the same type as on the server.
+    ConsoleObject* pObject = ConsoleObject::create( tag );
+    SceneObject* pSceneObject = dynamic_cast<SceneObject*>( pObject );
+
+    if ( pSceneObject == NULL )
+    {
+        Con::warnf( "SceneReplicator::onDeltaCreate() - '%s' is not a scene object type, using SceneObject instead.", tag );
+        delete pObject;
+        pSceneObject = new SceneObject();
+    }
+
+    if ( !pSceneObject->registerObject() )
+    {
+        Con::warnf( "SceneReplicator::onDeltaCreate() - Could not register a '%s' object.", tag );
+        delete pSceneObject;
+        return;
+    }
+
+    // The client copy is driven purely by the server.
+    pSceneObject->setBodyType( b2_kinematicBody );
+
+    if ( !mScene.isNull() )
+        mScene->addToScene( pSceneObject );
+
+    applyFields( pSceneObject, pFields );
+
+    if ( slot >= (U32)mGhostObjects.size() )
+        mGhostObjects.setSize( slot + 1 );
+
+    mGhostObjects[slot] = pSceneObject;
+
+    Con::executef( this, 2, "onGhostObjectAdded", pSceneObject->getIdString() );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::onDeltaUpdate( const U32 slot, const S32* pFields )
+{
+    if ( slot >= (U32)mGhostObjects.size() || mGhostObjects[slot].isNull() )
+        return;
+
+    applyFields( mGhostObjects[slot], pFields );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneReplicator::onDeltaRemove( const U32 slot )
+{
+    if ( slot >= (U32)mGhostObjects.size() || mGhostObjects[slot].isNull() )
+        return;
+
+    SceneObject* pSceneObject = mGhostObjects[slot];
+    mGhostObjects[slot] = NULL;
+
+    Con::executef( this, 2, "onGhostObjectRemoved", pSceneObject->getIdString() );
+
+    pSceneObject->safeDelete();
+}
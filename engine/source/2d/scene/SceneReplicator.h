@@ -0,0 +1,156 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _SCENE_REPLICATOR_H_
+#define _SCENE_REPLICATOR_H_
+
+#ifndef _NETOBJECT_H_
+#include "network/netObject.h"
+#endif
+
+#ifndef _TICKABLE_H_
+#include "platform/Tickable.h"
+#endif
+
+#ifndef _GHOSTDELTA_H_
+#include "network/ghostDelta.h"
+#endif
+
+#ifndef _HASHTABLE_H
+#include "collection/hashTable.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+class Scene;
+class SceneObject;
+
+//-----------------------------------------------------------------------------
+
+/// Replicates the objects of a scene to clients through a single ghost.
+///
+/// Scene objects are not net objects and a connection can only hold a few
+/// thousand ghosts, so rather than ghosting each object the replicator keeps a
+/// table of the scene's objects and sends their quantised position, angle and
+/// velocities as delta compressed records (see GhostDelta).  On the client the
+/// records create, drive and delete kinematic copies of the objects.  The
+/// quanta are sent with the initial update so both sides always agree.
+
+class SceneReplicator : public NetObject, public virtual Tickable, public GhostDeltaListener
+{
+    typedef NetObject Parent;
+
+public:
+    enum MaskBits
+    {
+        InitialUpdateMask   = BIT(0),
+        ObjectsMask         = BIT(1),
+    };
+
+    enum ReplicatedField
+    {
+        FieldPositionX,
+        FieldPositionY,
+        FieldAngle,
+        FieldLinearVelocityX,
+        FieldLinearVelocityY,
+        FieldAngularVelocity,
+
+        FieldCount
+    };
+
+private:
+    struct ConnectionChannel
+    {
+        SimObjectPtr<NetConnection> mConnection;
+        GhostDeltaChannel*          mpChannel;
+    };
+
+    typedef HashMap<SimObjectId, U32> typeSlotHash;
+
+    SimObjectPtr<Scene>         mScene;
+    F32                         mPositionQuantum;
+    F32                         mAngleQuantum;
+    F32                         mVelocityQuantum;
+
+    // Server.
+    GhostDeltaSource            mSource;
+    typeSlotHash                mSlotHash;
+    Vector<SimObjectId>         mSlotIds;
+    Vector<U32>                 mSlotStamps;
+    U32                         mRefreshStamp;
+    Vector<ConnectionChannel>   mChannels;
+
+    // Client.
+    GhostDeltaReceiver          mReceiver;
+    Vector<SimObjectPtr<SceneObject> > mGhostObjects;
+
+public:
+    SceneReplicator();
+    virtual ~SceneReplicator();
+
+    static void initPersistFields();
+    virtual void onRemove();
+
+    /// Scene to replicate (server) or to add replicated objects to (client).
+    void setScene( Scene* pScene );
+    inline Scene* getScene( void ) const                { return mScene; }
+
+    /// Number of objects currently replicated (server) or replicated into this ghost (client).
+    U32 getReplicatedObjectCount( void ) const;
+
+    /// Quantise the replicated state of a scene object.
+    void quantizeObject( const SceneObject* pSceneObject, S32* pFields ) const;
+
+    /// Apply quantised state to a scene object.
+    void applyFields( SceneObject* pSceneObject, const S32* pFields ) const;
+
+    // Tickable.
+    virtual void interpolateTick( F32 delta ) {}
+    virtual void processTick();
+    virtual void advanceTime( F32 timeDelta ) {}
+
+    // Networking.
+    virtual U32  packUpdate( NetConnection* conn, U32 mask, BitStream* stream );
+    virtual void unpackUpdate( NetConnection* conn, BitStream* stream );
+    virtual void onGhostUpdateNotify( NetConnection* conn, bool delivered );
+
+    // Delta records.
+    virtual void onDeltaCreate( const U32 slot, StringTableEntry tag, const S32* pFields );
+    virtual void onDeltaUpdate( const U32 slot, const S32* pFields );
+    virtual void onDeltaRemove( const U32 slot );
+
+    /// Declare Console Object.
+    DECLARE_CONOBJECT( SceneReplicator );
+
+protected:
+    /// Bring the slot table in line with the scene.  Returns true if anything changed.
+    bool refreshSlots( void );
+
+    GhostDeltaChannel* findChannel( NetConnection* conn, const bool create );
+    void clearChannels( void );
+
+    static bool setQuantum( void* obj, const char* data );
+};
+
+#endif // _SCENE_REPLICATOR_H_
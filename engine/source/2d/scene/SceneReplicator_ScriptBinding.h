@@ -0,0 +1,59 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+ConsoleMethod(SceneReplicator, setScene, void, 3, 3, "(scene) Sets the scene to replicate on the server, or the scene replicated objects are added to on the client.\n"
+              "@param scene The scene to use or an empty string for none.\n"
+              "@return No return value.")
+{
+    // Find the scene.
+    Scene* pScene = NULL;
+
+    if ( *argv[2] != 0 )
+    {
+        if ( !Sim::findObject( argv[2], pScene ) )
+        {
+            Con::warnf( "SceneReplicator::setScene() - Could not find scene '%s'.", argv[2] );
+            return;
+        }
+    }
+
+    object->setScene( pScene );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneReplicator, getScene, S32, 2, 2, "() Gets the scene the replicator is using.\n"
+              "@return The scene Id or zero if none.")
+{
+    Scene* pScene = object->getScene();
+
+    return pScene == NULL ? 0 : pScene->getId();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneReplicator, getReplicatedObjectCount, S32, 2, 2, "() Gets the number of objects being replicated.\n"
+              "@return The number of objects replicated by the server or created on the client.")
+{
+    return object->getReplicatedObjectCount();
+}
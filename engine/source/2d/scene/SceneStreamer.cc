@@ -0,0 +1,666 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "2d/scene/SceneStreamer.h"
+
+#ifndef _SCENE_H_
+#include "2d/scene/Scene.h"
+#endif
+
+#ifndef _SCENE_WINDOW_H_
+#include "2d/gui/SceneWindow.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "2d/sceneobject/SceneObject.h"
+#endif
+
+#ifndef _SCENE_OBJECT_SET_H_
+#include "2d/sceneobject/SceneObjectSet.h"
+#endif
+
+#ifndef _TAML_H_
+#include "persistence/taml/taml.h"
+#endif
+
+#ifndef _RESMANAGER_H_
+#include "io/resource/resourceManager.h"
+#endif
+
+#ifndef _CONSOLETYPES_H_
+#include "console/consoleTypes.h"
+#endif
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+// Script bindings.
+#include "SceneStreamer_ScriptBinding.h"
+
+//-----------------------------------------------------------------------------
+
+IMPLEMENT_CONOBJECT(SceneStreamer);
+
+//-----------------------------------------------------------------------------
+
+static EnumTable::Enums cellStateLookup[] =
+                {
+                { SceneStreamer::CellEmpty,     "Empty" },
+                { SceneStreamer::CellReading,   "Reading" },
+                { SceneStreamer::CellAdding,    "Adding" },
+                { SceneStreamer::CellLoaded,    "Loaded" },
+                { SceneStreamer::CellRemoving,  "Removing" },
+                };
+
+//-----------------------------------------------------------------------------
+
+SceneStreamer::SceneStreamer() :
+    mFocusArea( 0.0f, 0.0f, 0.0f, 0.0f ),
+    mCellPath( StringTable->EmptyString ),
+    mCellSize( 100.0f ),
+    mLoadDistance( 50.0f ),
+    mUnloadDistance( 100.0f ),
+    mObjectBudget( 100 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SceneStreamer::~SceneStreamer()
+{
+    unloadAll();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::initPersistFields()
+{
+    // Call parent.
+    Parent::initPersistFields();
+
+    addField("CellPath", TypeString, Offset(mCellPath, SceneStreamer), "The directory the cell files are stored in.");
+    addProtectedField("CellSize", TypeF32, Offset(mCellSize, SceneStreamer), &setCellSize, &defaultProtectedGetFn, "The width and height of each cell in world units.");
+    addProtectedField("LoadDistance", TypeF32, Offset(mLoadDistance, SceneStreamer), &setLoadDistance, &defaultProtectedGetFn, "How far beyond the camera area cells are loaded, in world units.");
+    addProtectedField("UnloadDistance", TypeF32, Offset(mUnloadDistance, SceneStreamer), &setUnloadDistance, &defaultProtectedGetFn, "How far beyond the camera area cells are kept before they unload, in world units.");
+    addField("ObjectBudget", TypeS32, Offset(mObjectBudget, SceneStreamer), "The number of objects added to or deleted from the scene per tick.  Zero is unlimited.");
+}
+
+//-----------------------------------------------------------------------------
+
+bool SceneStreamer::onAdd()
+{
+    // Call parent.
+    if ( !Parent::onAdd() )
+        return false;
+
+    // Stream every tick.
+    setProcessTicks( true );
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::onRemove()
+{
+    // Stop streaming.
+    setProcessTicks( false );
+
+    // Remove all the streamed objects.
+    unloadAll();
+
+    // Call parent.
+    Parent::onRemove();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::setScene( Scene* pScene )
+{
+    // Objects streamed into the old scene would be left there so remove them.
+    if ( pScene != mScene )
+        unloadAll();
+
+    mScene = pScene;
+}
+
+//-----------------------------------------------------------------------------
+
+RectF SceneStreamer::getFocusArea( void ) const
+{
+    // Use the scene window camera if there is one.
+    return mSceneWindow.isNull() ? mFocusArea : mSceneWindow->getCameraArea();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::setCellSize( const F32 cellSize )
+{
+    // Sanity!
+    if ( cellSize <= 0.0f )
+    {
+        Con::warnf( "SceneStreamer::setCellSize() - Invalid cell size '%g'.", cellSize );
+        return;
+    }
+
+    // The cells change so remove everything streamed with the old size.
+    if ( mNotEqual( cellSize, mCellSize ) )
+        unloadAll();
+
+    mCellSize = cellSize;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::setLoadDistance( const F32 loadDistance )
+{
+    // Sanity!
+    if ( loadDistance < 0.0f )
+    {
+        Con::warnf( "SceneStreamer::setLoadDistance() - Invalid load distance '%g'.", loadDistance );
+        return;
+    }
+
+    mLoadDistance = loadDistance;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::setUnloadDistance( const F32 unloadDistance )
+{
+    // Sanity!
+    if ( unloadDistance < 0.0f )
+    {
+        Con::warnf( "SceneStreamer::setUnloadDistance() - Invalid unload distance '%g'.", unloadDistance );
+        return;
+    }
+
+    mUnloadDistance = unloadDistance;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::getCell( const Vector2& worldPosition, S32& cellX, S32& cellY ) const
+{
+    cellX = (S32)mFloor( worldPosition.x / mCellSize );
+    cellY = (S32)mFloor( worldPosition.y / mCellSize );
+}
+
+//-----------------------------------------------------------------------------
+
+StringTableEntry SceneStreamer::getCellFilePath( const S32 cellX, const S32 cellY ) const
+{
+    // Expand the cell path.
+    char cellPathBuffer[1024];
+    Con::expandPath( cellPathBuffer, sizeof(cellPathBuffer), mCellPath );
+
+    // Format the cell file.
+    char filePathBuffer[1024];
+    dSprintf( filePathBuffer, sizeof(filePathBuffer), "%s/cell_%d_%d.taml", cellPathBuffer, cellX, cellY );
+
+    return StringTable->insert( filePathBuffer );
+}
+
+//-----------------------------------------------------------------------------
+
+SceneStreamer::CellState SceneStreamer::getCellState( const S32 cellX, const S32 cellY ) const
+{
+    Cell* pCell = findCell( cellX, cellY );
+
+    return pCell == NULL ? CellEmpty : pCell->mState;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneStreamer::getLoadedCellCount( void ) const
+{
+    U32 cellCount = 0;
+    for ( S32 index = 0; index < mCells.size(); ++index )
+    {
+        if ( mCells[index]->mState == CellAdding || mCells[index]->mState == CellLoaded )
+            cellCount++;
+    }
+
+    return cellCount;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneStreamer::getStreamedObjectCount( void ) const
+{
+    U32 objectCount = 0;
+    for ( S32 index = 0; index < mCells.size(); ++index )
+    {
+        if ( !mCells[index]->mObjects.isNull() )
+            objectCount += mCells[index]->mObjects->size();
+    }
+
+    return objectCount;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SceneStreamer::isSettled( void ) const
+{
+    for ( S32 index = 0; index < mCells.size(); ++index )
+    {
+        if ( mCells[index]->mState != CellEmpty && mCells[index]->mState != CellLoaded )
+            return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::flush( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_Flush);
+
+    updateCells( true );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::unloadAll( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_UnloadAll);
+
+    while( mCells.size() > 0 )
+        destroyCell( mCells.size() - 1 );
+}
+
+//-----------------------------------------------------------------------------
+
+bool SceneStreamer::writeCells( Scene* pScene ) const
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_WriteCells);
+
+    // Sanity!
+    AssertFatal( pScene != NULL, "SceneStreamer::writeCells() - Cannot write a NULL scene." );
+
+    // Finish if there is nowhere to write.
+    if ( mCellPath == StringTable->EmptyString )
+    {
+        // Warn.
+        Con::warnf( "SceneStreamer::writeCells() - No cell path has been set." );
+        return false;
+    }
+
+    typedef HashMap<U64, U32> typeCellSetHash;
+
+    typeCellSetHash cellSetHash;
+    Vector<SceneObjectSet*> cellSets;
+    Vector<Point2I> cellCoordinates;
+
+    // Gather the scene objects by cell.
+    typeSceneObjectVectorConstRef sceneObjects = pScene->getSceneObjects();
+    for ( S32 index = 0; index < sceneObjects.size(); ++index )
+    {
+        SceneObject* pSceneObject = sceneObjects[index];
+
+        // Fetch the cell.
+        S32 cellX, cellY;
+        getCell( pSceneObject->getPosition(), cellX, cellY );
+        const U64 cellKey = getCellKey( cellX, cellY );
+
+        // Find the cell set.
+        typeCellSetHash::iterator cellSetItr = cellSetHash.find( cellKey );
+
+        SceneObjectSet* pCellSet;
+
+        // Is this a new cell?
+        if ( cellSetItr == cellSetHash.end() )
+        {
+            // Yes, so create its set.
+            pCellSet = new SceneObjectSet();
+            pCellSet->registerObject();
+            cellSetHash.insert( cellKey, cellSets.size() );
+            cellSets.push_back( pCellSet );
+            cellCoordinates.push_back( Point2I( cellX, cellY ) );
+        }
+        else
+        {
+            pCellSet = cellSets[cellSetItr->value];
+        }
+
+        pCellSet->addObject( pSceneObject );
+    }
+
+    Taml taml;
+    bool cellsWritten = true;
+
+    // Write the cells.
+    for ( S32 index = 0; index < cellSets.size(); ++index )
+    {
+        StringTableEntry cellFilePath = getCellFilePath( cellCoordinates[index].x, cellCoordinates[index].y );
+
+        // Make sure the cell path exists.
+        Platform::createPath( cellFilePath );
+
+        if ( !taml.write( cellSets[index], cellFilePath ) )
+            cellsWritten = false;
+
+        // Remove the set leaving the objects in the scene.
+        cellSets[index]->deleteObject();
+    }
+
+    return cellsWritten;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::processTick()
+{
+    updateCells( false );
+}
+
+//-----------------------------------------------------------------------------
+
+const char* SceneStreamer::getCellStateDescription( const CellState cellState )
+{
+    // Search for Mnemonic.
+    for (U32 i = 0; i < (sizeof(cellStateLookup) / sizeof(EnumTable::Enums)); i++)
+    {
+        if( cellStateLookup[i].index == cellState )
+            return cellStateLookup[i].label;
+    }
+
+    // Warn.
+    Con::warnf( "SceneStreamer::getCellStateDescription() - Invalid cell state." );
+
+    return StringTable->EmptyString;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::updateCells( const bool flushing )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_UpdateCells);
+
+    // Finish if there is nothing to stream into.
+    if ( mScene.isNull() || mCellPath == StringTable->EmptyString )
+        return;
+
+    const RectF focusArea = getFocusArea();
+    const F32 unloadDistance = getMax( mUnloadDistance, mLoadDistance );
+
+    // Fetch the cells within the load distance.
+    S32 loadMinX, loadMinY, loadMaxX, loadMaxY;
+    getCell( Vector2( focusArea.point.x - mLoadDistance, focusArea.point.y - mLoadDistance ), loadMinX, loadMinY );
+    getCell( Vector2( focusArea.point.x + focusArea.extent.x + mLoadDistance, focusArea.point.y + focusArea.extent.y + mLoadDistance ), loadMaxX, loadMaxY );
+
+    // Fetch the cells within the unload distance.
+    S32 keepMinX, keepMinY, keepMaxX, keepMaxY;
+    getCell( Vector2( focusArea.point.x - unloadDistance, focusArea.point.y - unloadDistance ), keepMinX, keepMinY );
+    getCell( Vector2( focusArea.point.x + focusArea.extent.x + unloadDistance, focusArea.point.y + focusArea.extent.y + unloadDistance ), keepMaxX, keepMaxY );
+
+    // Start streaming any cells that have come into range.
+    for ( S32 cellY = loadMinY; cellY <= loadMaxY; ++cellY )
+    {
+        for ( S32 cellX = loadMinX; cellX <= loadMaxX; ++cellX )
+        {
+            if ( findCell( cellX, cellY ) == NULL )
+                createCell( cellX, cellY );
+        }
+    }
+
+    // Start removing any cells that have gone out of range.
+    for ( S32 index = mCells.size() - 1; index >= 0; --index )
+    {
+        Cell* pCell = mCells[index];
+
+        // Skip if still in range.
+        if ( pCell->mX >= keepMinX && pCell->mX <= keepMaxX && pCell->mY >= keepMinY && pCell->mY <= keepMaxY )
+            continue;
+
+        // Cells without objects can go straight away.
+        if ( pCell->mState == CellEmpty || pCell->mState == CellReading )
+        {
+            destroyCell( index );
+            continue;
+        }
+
+        pCell->mState = CellRemoving;
+    }
+
+    U32 budget = flushing || mObjectBudget == 0 ? U32_MAX : mObjectBudget;
+
+    // Remove objects first to make room for new ones.
+    for ( S32 index = mCells.size() - 1; index >= 0 && budget > 0; --index )
+    {
+        Cell* pCell = mCells[index];
+
+        if ( pCell->mState != CellRemoving )
+            continue;
+
+        budget -= removeCellObjects( pCell, budget );
+
+        // Destroy the cell once its objects have gone.
+        if ( pCell->mObjects.isNull() )
+            destroyCell( index );
+    }
+
+    const Vector2 focusCentre = focusArea.centre();
+
+    // Read the nearest cell whose file has arrived.  Reading registers every object
+    // in the cell so only one is read per tick unless flushing.
+    while( budget > 0 )
+    {
+        Cell* pNearestCell = NULL;
+        F32 nearestDistanceSquared = F32_MAX;
+
+        for ( S32 index = 0; index < mCells.size(); ++index )
+        {
+            Cell* pCell = mCells[index];
+
+            // Skip if not ready to read.  Flushing waits for the file instead.
+            if ( pCell->mState != CellReading || ( !flushing && ResourceManager->isPrefetchPending( pCell->mFilePath ) ) )
+                continue;
+
+            const Vector2 cellCentre( (F32(pCell->mX) + 0.5f) * mCellSize, (F32(pCell->mY) + 0.5f) * mCellSize );
+            const F32 distanceSquared = (cellCentre - focusCentre).LengthSquared();
+
+            if ( distanceSquared < nearestDistanceSquared )
+            {
+                pNearestCell = pCell;
+                nearestDistanceSquared = distanceSquared;
+            }
+        }
+
+        if ( pNearestCell == NULL )
+            break;
+
+        readCell( pNearestCell );
+
+        if ( !flushing )
+            break;
+    }
+
+    // Add objects from the cells that have been read.
+    for ( S32 index = 0; index < mCells.size() && budget > 0; ++index )
+    {
+        Cell* pCell = mCells[index];
+
+        if ( pCell->mState == CellAdding )
+            budget -= addCellObjects( pCell, budget );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+SceneStreamer::Cell* SceneStreamer::findCell( const S32 cellX, const S32 cellY ) const
+{
+    typeCellHash::const_iterator cellItr = mCellHash.find( getCellKey( cellX, cellY ) );
+
+    return cellItr == mCellHash.end() ? NULL : cellItr->value;
+}
+
+//-----------------------------------------------------------------------------
+
+SceneStreamer::Cell* SceneStreamer::createCell( const S32 cellX, const S32 cellY )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_CreateCell);
+
+    Cell* pCell = new Cell();
+    pCell->mX = cellX;
+    pCell->mY = cellY;
+    pCell->mFilePath = getCellFilePath( cellX, cellY );
+    pCell->mPendingCount = 0;
+
+    // Start reading the cell file on the read threads if there is one.
+    pCell->mState = ResourceManager->prefetch( pCell->mFilePath, AsyncReadRequest::PriorityNormal ) ? CellReading : CellEmpty;
+
+    mCells.push_back( pCell );
+    mCellHash.insert( getCellKey( cellX, cellY ), pCell );
+
+    return pCell;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneStreamer::destroyCell( const U32 cellIndex )
+{
+    // Sanity!
+    AssertFatal( cellIndex < (U32)mCells.size(), "SceneStreamer::destroyCell() - Cell index is out of range." );
+
+    Cell* pCell = mCells[cellIndex];
+
+    // Stop reading the cell file if it is still queued.
+    if ( pCell->mState == CellReading )
+        ResourceManager->cancelPrefetch( pCell->mFilePath );
+
+    // Delete any objects left.
+    if ( !pCell->mObjects.isNull() )
+    {
+        pCell->mObjects->deleteObjects();
+        pCell->mObjects->deleteObject();
+    }
+
+    mCellHash.erase( getCellKey( pCell->mX, pCell->mY ) );
+    mCells.erase_fast( cellIndex );
+    delete pCell;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SceneStreamer::readCell( Cell* pCell )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_ReadCell);
+
+    // Read the cell.  The file comes from the prefetch if it has been read.
+    Taml taml;
+    SceneObjectSet* pCellSet = taml.read<SceneObjectSet>( pCell->mFilePath );
+
+    // Did we read the cell?
+    if ( pCellSet == NULL )
+    {
+        // No, so warn and don't try again while the cell is in range.
+        Con::warnf( "SceneStreamer::readCell() - Could not read the cell file '%s'.", pCell->mFilePath );
+        pCell->mState = CellEmpty;
+        return false;
+    }
+
+    pCell->mObjects = pCellSet;
+    pCell->mPendingCount = pCellSet->size();
+    pCell->mState = CellAdding;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneStreamer::addCellObjects( Cell* pCell, const U32 budget )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_AddCellObjects);
+
+    U32 addedCount = 0;
+
+    while( !pCell->mObjects.isNull() && addedCount < budget )
+    {
+        const U32 objectCount = pCell->mObjects->size();
+
+        // Objects deleted before being added shrink the set.
+        pCell->mPendingCount = getMin( pCell->mPendingCount, objectCount );
+
+        if ( pCell->mPendingCount == 0 )
+            break;
+
+        // Add the next object.
+        SceneObject* pSceneObject = pCell->mObjects->at( objectCount - pCell->mPendingCount );
+        pCell->mPendingCount--;
+        mScene->addToScene( pSceneObject );
+        addedCount++;
+    }
+
+    // Finish if there are more to add.
+    if ( !pCell->mObjects.isNull() && pCell->mPendingCount > 0 )
+        return addedCount;
+
+    pCell->mState = CellLoaded;
+
+    // Perform callback.
+    if ( isMethod( "onCellLoaded" ) )
+        Con::executef( this, 3, "onCellLoaded", Con::getIntArg( pCell->mX ), Con::getIntArg( pCell->mY ) );
+
+    return addedCount;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneStreamer::removeCellObjects( Cell* pCell, const U32 budget )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(SceneStreamer_RemoveCellObjects);
+
+    U32 removedCount = 0;
+
+    // Delete objects from the end of the set.
+    while( !pCell->mObjects.isNull() && pCell->mObjects->size() > 0 && removedCount < budget )
+    {
+        pCell->mObjects->last()->deleteObject();
+        removedCount++;
+    }
+
+    // Finish if there are more to delete.
+    if ( !pCell->mObjects.isNull() && pCell->mObjects->size() > 0 )
+        return removedCount;
+
+    // Delete the set.
+    if ( !pCell->mObjects.isNull() )
+        pCell->mObjects->deleteObject();
+
+    pCell->mObjects = NULL;
+
+    // Perform callback.
+    if ( isMethod( "onCellUnloaded" ) )
+        Con::executef( this, 3, "onCellUnloaded", Con::getIntArg( pCell->mX ), Con::getIntArg( pCell->mY ) );
+
+    return removedCount;
+}
@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _SCENE_STREAMER_H_
+#define _SCENE_STREAMER_H_
+
+#ifndef _SIMBASE_H_
+#include "sim/simBase.h"
+#endif
+
+#ifndef _TICKABLE_H_
+#include "platform/Tickable.h"
+#endif
+
+#ifndef _HASHTABLE_H
+#include "collection/hashTable.h"
+#endif
+
+#ifndef _VECTOR2_H_
+#include "2d/core/Vector2.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+class Scene;
+class SceneWindow;
+class SceneObjectSet;
+
+//-----------------------------------------------------------------------------
+
+/// Streams the objects of a large scene in and out by spatial cell.
+///
+/// The world is divided into square cells and each cell's objects are stored in
+/// their own Taml file, "cell_<x>_<y>.taml" in the cell path, with a SceneObjectSet
+/// as the root (see writeCells()).  Every tick the streamer takes the camera area of
+/// its scene window (or the focus area when there is no window) and:
+///
+/// - prefetches the file of each cell within the load distance on the resource
+///   manager's read threads,
+/// - reads at most one cell whose file has arrived, registering its objects,
+/// - adds read objects to the scene and deletes the objects of cells beyond the
+///   unload distance, no more than the object budget per tick in total.
+///
+/// Adding an object to the scene creates its physics body and is the bulk of the
+/// cost so spreading it over ticks keeps large cells from stalling a frame.  Cells
+/// are only ever read; changes to streamed objects are lost when they unload.
+class SceneStreamer : public SimObject, public virtual Tickable
+{
+    typedef SimObject Parent;
+
+public:
+    enum CellState
+    {
+        CellEmpty,          ///< No cell file exists.
+        CellReading,        ///< The cell file is being prefetched.
+        CellAdding,         ///< The cell has been read and its objects are being added to the scene.
+        CellLoaded,         ///< All the cell objects are in the scene.
+        CellRemoving,       ///< The cell objects are being deleted.
+    };
+
+    struct Cell
+    {
+        S32                 mX;
+        S32                 mY;
+        CellState           mState;
+        StringTableEntry    mFilePath;
+        SimObjectPtr<SceneObjectSet> mObjects;
+        U32                 mPendingCount;      ///< Objects at the end of the set not yet added to the scene.
+    };
+
+private:
+    typedef HashMap<U64, Cell*> typeCellHash;
+
+    SimObjectPtr<Scene>         mScene;
+    SimObjectPtr<SceneWindow>   mSceneWindow;
+    RectF                       mFocusArea;
+
+    StringTableEntry            mCellPath;
+    F32                         mCellSize;
+    F32                         mLoadDistance;
+    F32                         mUnloadDistance;
+    U32                         mObjectBudget;
+
+    typeCellHash                mCellHash;
+    Vector<Cell*>               mCells;
+
+public:
+    SceneStreamer();
+    virtual ~SceneStreamer();
+
+    static void initPersistFields();
+    virtual bool onAdd();
+    virtual void onRemove();
+
+    /// Scene the streamed objects are added to.
+    void setScene( Scene* pScene );
+    inline Scene* getScene( void ) const                        { return mScene; }
+
+    /// Scene window whose camera drives the streaming.
+    inline void setSceneWindow( SceneWindow* pSceneWindow )     { mSceneWindow = pSceneWindow; }
+    inline SceneWindow* getSceneWindow( void ) const            { return mSceneWindow; }
+
+    /// Area that drives the streaming when there is no scene window.
+    inline void setFocusArea( const RectF& focusArea )          { mFocusArea = focusArea; }
+    RectF getFocusArea( void ) const;
+
+    /// Cell layout.
+    inline void setCellPath( const char* pCellPath )            { mCellPath = StringTable->insert( pCellPath ); }
+    inline StringTableEntry getCellPath( void ) const           { return mCellPath; }
+    void setCellSize( const F32 cellSize );
+    inline F32 getCellSize( void ) const                        { return mCellSize; }
+    void setLoadDistance( const F32 loadDistance );
+    inline F32 getLoadDistance( void ) const                    { return mLoadDistance; }
+    void setUnloadDistance( const F32 unloadDistance );
+    inline F32 getUnloadDistance( void ) const                  { return mUnloadDistance; }
+
+    /// Objects added to or deleted from the scene per tick.  Zero is unlimited.
+    inline void setObjectBudget( const U32 objectBudget )       { mObjectBudget = objectBudget; }
+    inline U32 getObjectBudget( void ) const                    { return mObjectBudget; }
+
+    /// Cell containing a world position.
+    void getCell( const Vector2& worldPosition, S32& cellX, S32& cellY ) const;
+
+    /// File a cell is stored in.
+    StringTableEntry getCellFilePath( const S32 cellX, const S32 cellY ) const;
+
+    /// State of a cell, CellEmpty if it is not being streamed.
+    CellState getCellState( const S32 cellX, const S32 cellY ) const;
+
+    /// Number of cells with objects read and number of streamed objects that exist.
+    U32 getLoadedCellCount( void ) const;
+    U32 getStreamedObjectCount( void ) const;
+
+    /// Whether every cell in range is loaded and every cell out of range has gone.
+    bool isSettled( void ) const;
+
+    /// Stream until settled, reading cell files immediately.
+    void flush( void );
+
+    /// Delete every streamed object.
+    void unloadAll( void );
+
+    /// Split the objects of a scene into cell files in the cell path.  The objects stay in the scene.
+    bool writeCells( Scene* pScene ) const;
+
+    // Tickable.
+    virtual void interpolateTick( F32 delta ) {}
+    virtual void processTick();
+    virtual void advanceTime( F32 timeDelta ) {}
+
+    static const char* getCellStateDescription( const CellState cellState );
+
+    /// Declare Console Object.
+    DECLARE_CONOBJECT( SceneStreamer );
+
+protected:
+    /// Stream one tick's worth of work.
+    void updateCells( const bool flushing );
+
+    Cell* findCell( const S32 cellX, const S32 cellY ) const;
+    Cell* createCell( const S32 cellX, const S32 cellY );
+    void destroyCell( const U32 cellIndex );
+    bool readCell( Cell* pCell );
+    U32 addCellObjects( Cell* pCell, const U32 budget );
+    U32 removeCellObjects( Cell* pCell, const U32 budget );
+
+    static inline U64 getCellKey( const S32 cellX, const S32 cellY ) { return (U64(U32(cellX)) << 32) | U32(cellY); }
+
+    static bool setCellSize( void* obj, const char* data )      { static_cast<SceneStreamer*>( obj )->setCellSize( dAtof(data) ); return false; }
+    static bool setLoadDistance( void* obj, const char* data )  { static_cast<SceneStreamer*>( obj )->setLoadDistance( dAtof(data) ); return false; }
+    static bool setUnloadDistance( void* obj, const char* data ) { static_cast<SceneStreamer*>( obj )->setUnloadDistance( dAtof(data) ); return false; }
+};
+
+#endif // _SCENE_STREAMER_H_
@@ -0,0 +1,220 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, setScene, void, 3, 3, "(scene) Sets the scene streamed objects are added to.\n"
+              "Any objects streamed into a previous scene are deleted.\n"
+              "@param scene The scene to use or an empty string for none.\n"
+              "@return No return value.")
+{
+    // Find the scene.
+    Scene* pScene = NULL;
+
+    if ( *argv[2] != 0 )
+    {
+        if ( !Sim::findObject( argv[2], pScene ) )
+        {
+            Con::warnf( "SceneStreamer::setScene() - Could not find scene '%s'.", argv[2] );
+            return;
+        }
+    }
+
+    object->setScene( pScene );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getScene, S32, 2, 2, "() Gets the scene streamed objects are added to.\n"
+              "@return The scene Id or zero if none.")
+{
+    Scene* pScene = object->getScene();
+
+    return pScene == NULL ? 0 : pScene->getId();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, setSceneWindow, void, 3, 3, "(sceneWindow) Sets the scene window whose camera drives the streaming.\n"
+              "@param sceneWindow The scene window to use or an empty string to use the focus area.\n"
+              "@return No return value.")
+{
+    // Find the scene window.
+    SceneWindow* pSceneWindow = NULL;
+
+    if ( *argv[2] != 0 )
+    {
+        if ( !Sim::findObject( argv[2], pSceneWindow ) )
+        {
+            Con::warnf( "SceneStreamer::setSceneWindow() - Could not find scene window '%s'.", argv[2] );
+            return;
+        }
+    }
+
+    object->setSceneWindow( pSceneWindow );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getSceneWindow, S32, 2, 2, "() Gets the scene window whose camera drives the streaming.\n"
+              "@return The scene window Id or zero if none.")
+{
+    SceneWindow* pSceneWindow = object->getSceneWindow();
+
+    return pSceneWindow == NULL ? 0 : pSceneWindow->getId();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, setFocusArea, void, 3, 6, "(x1 / y1 / x2 / y2) Sets the area that drives the streaming when there is no scene window.\n"
+              "@param x1,y1 The lower-left corner of the area.\n"
+              "@param x2,y2 The upper-right corner of the area.\n"
+              "@return No return value.")
+{
+    Vector2 v1, v2;
+
+    // Upper left and lower right bound.
+    if ( (argc == 3) && (Utility::mGetStringElementCount(argv[2]) == 4) )
+    {
+        v1 = Utility::mGetStringElementVector(argv[2]);
+        v2 = Utility::mGetStringElementVector(argv[2], 2);
+    }
+    else if ( (argc == 6) )
+    {
+        v1 = Vector2(dAtof(argv[2]), dAtof(argv[3]));
+        v2 = Vector2(dAtof(argv[4]), dAtof(argv[5]));
+    }
+    else
+    {
+        Con::warnf("SceneStreamer::setFocusArea() - Invalid number of parameters!");
+        return;
+    }
+
+    object->setFocusArea( RectF( getMin( v1.x, v2.x ), getMin( v1.y, v2.y ), mFabs( v2.x - v1.x ), mFabs( v2.y - v1.y ) ) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getFocusArea, const char*, 2, 2, "() Gets the area that drives the streaming.\n"
+              "@return The area as \"x1 y1 x2 y2\", taken from the scene window camera if there is one.")
+{
+    const RectF focusArea = object->getFocusArea();
+
+    char* pBuffer = Con::getReturnBuffer(64);
+    dSprintf( pBuffer, 64, "%g %g %g %g", focusArea.point.x, focusArea.point.y, focusArea.point.x + focusArea.extent.x, focusArea.point.y + focusArea.extent.y );
+    return pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getCell, const char*, 3, 4, "(x / y) Gets the cell containing a world position.\n"
+              "@param x,y The world position.\n"
+              "@return The cell as \"x y\".")
+{
+    Vector2 worldPosition;
+
+    if ( argc == 3 )
+        worldPosition = Utility::mGetStringElementVector(argv[2]);
+    else
+        worldPosition = Vector2(dAtof(argv[2]), dAtof(argv[3]));
+
+    S32 cellX, cellY;
+    object->getCell( worldPosition, cellX, cellY );
+
+    char* pBuffer = Con::getReturnBuffer(32);
+    dSprintf( pBuffer, 32, "%d %d", cellX, cellY );
+    return pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getCellFile, const char*, 4, 4, "(cellX, cellY) Gets the file a cell is stored in.\n"
+              "@param cellX,cellY The cell.\n"
+              "@return The cell file path.")
+{
+    return object->getCellFilePath( dAtoi(argv[2]), dAtoi(argv[3]) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getCellState, const char*, 4, 4, "(cellX, cellY) Gets the streaming state of a cell.\n"
+              "@param cellX,cellY The cell.\n"
+              "@return One of \"Empty\", \"Reading\", \"Adding\", \"Loaded\" or \"Removing\".")
+{
+    return SceneStreamer::getCellStateDescription( object->getCellState( dAtoi(argv[2]), dAtoi(argv[3]) ) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getLoadedCellCount, S32, 2, 2, "() Gets the number of cells whose objects have been read.\n"
+              "@return The number of cells.")
+{
+    return object->getLoadedCellCount();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, getStreamedObjectCount, S32, 2, 2, "() Gets the number of streamed objects that currently exist.\n"
+              "@return The number of objects.")
+{
+    return object->getStreamedObjectCount();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, isSettled, bool, 2, 2, "() Gets whether all the cells in range are loaded and all those out of range have gone.\n"
+              "@return Whether streaming has settled.")
+{
+    return object->isSettled();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, flush, void, 2, 2, "() Streams everything for the current focus immediately, for instance after a teleport.\n"
+              "@return No return value.")
+{
+    object->flush();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, unloadAll, void, 2, 2, "() Deletes every streamed object.\n"
+              "@return No return value.")
+{
+    object->unloadAll();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(SceneStreamer, writeCells, bool, 3, 3, "(scene) Splits the objects of a scene into cell files in the cell path.\n"
+              "The objects stay in the scene.\n"
+              "@param scene The scene to write.\n"
+              "@return Whether all the cells were written.")
+{
+    // Find the scene.
+    Scene* pScene = NULL;
+    if ( !Sim::findObject( argv[2], pScene ) )
+    {
+        Con::warnf( "SceneStreamer::writeCells() - Could not find scene '%s'.", argv[2] );
+        return false;
+    }
+
+    return object->writeCells( pScene );
+}
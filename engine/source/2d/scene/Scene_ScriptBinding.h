@@ -100,6 +100,23 @@ ConsoleMethod(Scene, getPositionIterations, S32, 2, 2,  "() Gets the number of p
 
 //-----------------------------------------------------------------------------
 
+ConsoleMethod(Scene, setBodyPoolCapacity, void, 3, 3,   "(capacity) Sets how many physics bodies of removed objects are kept for reuse.\n"
+                                                        "@param capacity The number of bodies kept for reuse.\n"
+                                                        "@return No return value." )
+{
+    object->setBodyPoolCapacity( dAtoi(argv[2]) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(Scene, getBodyPoolCapacity, S32, 2, 2,    "() Gets how many physics bodies of removed objects are kept for reuse.\n"
+                                                        "@return The number of bodies kept for reuse." )
+{
+    return object->getBodyPoolCapacity();
+}
+
+//-----------------------------------------------------------------------------
+
 ConsoleMethod(Scene, add, void, 3, 3,   "(sceneObject) Add the SceneObject to the scene.\n"
                                         "@param sceneObject The SceneObject to add to the scene.\n"
                                         "@return No return value.")
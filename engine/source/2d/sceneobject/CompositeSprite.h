@@ -104,6 +104,10 @@ protected:
     static bool         writeBatchLayout( void* obj, StringTableEntry pFieldName )          { return static_cast<CompositeSprite*>(obj)->getBatchLayout() != CompositeSprite::NO_LAYOUT; }
     static bool         setBatchCulling(void* obj, const char* data)                        { STATIC_VOID_CAST_TO(CompositeSprite, SpriteBatch, obj)->setBatchCulling(dAtob(data)); return false; }
     static bool         writeBatchCulling( void* obj, StringTableEntry pFieldName )         { return !static_cast<CompositeSprite*>(obj)->getBatchCulling(); }
+    static bool         setBatchStatic(void* obj, const char* data)                         { STATIC_VOID_CAST_TO(CompositeSprite, SpriteBatch, obj)->setBatchStatic(dAtob(data)); return false; }
+    static bool         writeBatchStatic( void* obj, StringTableEntry pFieldName )          { return static_cast<CompositeSprite*>(obj)->getBatchStatic(); }
+    static bool         setBatchChunkSize(void* obj, const char* data)                      { STATIC_VOID_CAST_TO(CompositeSprite, SpriteBatch, obj)->setBatchChunkSize(dAtof(data)); return false; }
+    static bool         writeBatchChunkSize( void* obj, StringTableEntry pFieldName )       { return mNotEqual( static_cast<CompositeSprite*>(obj)->getBatchChunkSize(), 16.0f ); }
 };
 
 #endif // _COMPOSITE_SPRITE_H_
@@ -129,6 +129,55 @@ ConsoleMethod(CompositeSprite, getBatchCulling, bool, 2, 2,    "() - Gets whethe
 
 //-----------------------------------------------------------------------------
 
+ConsoleMethod(CompositeSprite, setBatchStatic, void, 3, 3,      "(bool batchStatic) - Sets whether the sprites are baked into static chunks.\n"
+                                                                "Sprites are grouped by cell and texture into prebuilt vertex blocks that are culled and rendered per chunk.\n"
+                                                                "A chunk is only rebuilt when one of its sprites changes so this is intended for large composites that rarely change such as tile maps.\n"
+                                                                "Animated sprites are still rendered individually.\n"
+                                                                "@return No return value." )
+{
+    // Fetch batch static.
+    const bool batchStatic = dAtob(argv[2]);
+
+    STATIC_VOID_CAST_TO(CompositeSprite, SpriteBatch, object)->setBatchStatic( batchStatic );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(CompositeSprite, getBatchStatic, bool, 2, 2,      "() - Gets whether the sprites are baked into static chunks or not.\n"
+                                                                "@return Whether the sprites are baked into static chunks or not." )
+{
+    return object->getBatchStatic();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(CompositeSprite, setBatchChunkSize, void, 3, 3,   "(float chunkSize) - Sets the local size of the cells used to group sprites into static chunks.\n"
+                                                                "@return No return value." )
+{
+    STATIC_VOID_CAST_TO(CompositeSprite, SpriteBatch, object)->setBatchChunkSize( dAtof(argv[2]) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(CompositeSprite, getBatchChunkSize, F32, 2, 2,    "() - Gets the local size of the cells used to group sprites into static chunks.\n"
+                                                                "@return The local size of the static chunk cells." )
+{
+    return object->getBatchChunkSize();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleMethod(CompositeSprite, getBatchChunkCount, S32, 2, 2,   "() - Gets the number of static chunks.\n"
+                                                                "@return The number of static chunks." )
+{
+    // Make sure any pending sprites are in their chunks.
+    object->updateStaticChunks();
+
+    return object->getStaticChunkCount();
+}
+
+//-----------------------------------------------------------------------------
+
 ConsoleMethod(CompositeSprite, setBatchSortMode, void, 3, 3,    "(renderSortMode) - Sets the batch render sort mode.\n"
                                                                 "The render sort mode is used when isolated batch mode is on.\n"
                                                                 "@return No return value." )
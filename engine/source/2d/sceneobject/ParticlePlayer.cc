@@ -336,6 +336,9 @@ void ParticlePlayer::integrateObject( const F32 totalTime, const F32 elapsedTime
                 }
             };
 
+            // Update the particle animations.
+            pEmitterNode->getImageFrameAnimator()->update( scaledTime );
+
             // Skip generating new particles if the emitter is paused.
             if ( pEmitterNode->getPaused() )
                 continue;
@@ -1282,6 +1285,9 @@ void ParticlePlayer::configureParticle( EmitterNode* pEmitterNode, ParticleSyste
 
         // Play it.
         frameProvider.playAnimation( animationAsset );
+
+        // Integrate it with the other particles of the emitter.
+        frameProvider.setAnimator( pEmitterNode->getImageFrameAnimator() );
     }
 
 
@@ -1380,19 +1386,6 @@ void ParticlePlayer::integrateParticle( EmitterNode* pEmitterNode, ParticleSyste
                                 mClampF( alphaChannel.getFieldValue( particleAge ) * alphaChannelScale.getFieldValue( 0.0f ), alphaChannel.getMinValue(), alphaChannel.getMaxValue() ) );
 
 
-    // **********************************************************************************************************************
-    // Integrate Particle.
-    // **********************************************************************************************************************
-
-
-    // Is the emitter in static mode?
-    if ( !pParticleAssetEmitter->isStaticFrameProvider() )
-    {
-        // No, so update animation.
-        pParticleNode->mFrameProvider.updateAnimation( elapsedTime );
-    }
-
-
     // **********************************************************************************************************************
     // Calculate New Velocity...
     // **********************************************************************************************************************
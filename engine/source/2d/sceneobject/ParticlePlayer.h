@@ -52,12 +52,14 @@ private:
         ParticlePlayer*                 mOwner;
         ParticleAssetEmitter*           mpAssetEmitter;
         ParticleSystem::ParticleNode    mParticleNodeHead;
+        ImageFrameAnimator              mImageFrameAnimator;
         F32                             mTimeSinceLastGeneration;
         bool                            mPaused;
         bool                            mVisible;
 
     public:
-        EmitterNode( ParticlePlayer* pParticlePlayer, ParticleAssetEmitter* pParticleAssetEmitter )
+        EmitterNode( ParticlePlayer* pParticlePlayer, ParticleAssetEmitter* pParticleAssetEmitter ) :
+            mImageFrameAnimator( false )
         {
             // Sanity!
             AssertFatal( pParticlePlayer != NULL, "EmitterNode() - Cannot have a NULL owner." );
@@ -96,6 +98,8 @@ private:
         inline ParticleSystem::ParticleNode* getLastParticle( void ) const { return mParticleNodeHead.mPreviousNode; }
         inline ParticleSystem::ParticleNode* getParticleNodeHead( void ) { return &mParticleNodeHead; }
 
+        inline ImageFrameAnimator* getImageFrameAnimator( void ) { return &mImageFrameAnimator; }
+
         inline void setTimeSinceLastGeneration( const F32 timeSinceLastGeneration ) { mTimeSinceLastGeneration = timeSinceLastGeneration; }
         inline F32 getTimeSinceLastGeneration( void ) const { return mTimeSinceLastGeneration; }
 
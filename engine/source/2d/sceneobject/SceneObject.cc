@@ -68,6 +68,10 @@
 #include "string/stringUnit.h"
 #endif
 
+#ifndef _OBJECTPOOL_H_
+#include "memory/objectPool.h"
+#endif
+
 // Script bindings.
 #include "SceneObject_ScriptBinding.h"
 
@@ -384,7 +388,7 @@ void SceneObject::OnRegisterScene( Scene* pScene )
     mpScene = pScene;
 
     // Create the physics body.
-    mpBody = pScene->getWorld()->CreateBody( &mBodyDefinition );
+    mpBody = pScene->createBody( mBodyDefinition );
 
     // Set active status.
     if ( !isEnabled() ) mpBody->SetActive( false );
@@ -478,7 +482,7 @@ void SceneObject::OnUnregisterScene( Scene* pScene )
     mpCurrentContacts = NULL;
 
     // Destroy the physics body.
-    mpScene->getWorld()->DestroyBody( mpBody );
+    mpScene->destroyBody( mpBody );
     mpBody = NULL;
 
     // Destroy world proxy Id.
@@ -3285,6 +3289,59 @@ U32 SceneObject::getGlobalSceneObjectCount( void )
 
 //-----------------------------------------------------------------------------
 
+static ObjectPoolAllocator& getSceneObjectPool( void )
+{
+    // Created on first use so it exists before any scene object.
+    static ObjectPoolAllocator sceneObjectPool( 4096 );
+    return sceneObjectPool;
+}
+
+//-----------------------------------------------------------------------------
+
+void* SceneObject::allocateInstance( const dsize_t size, const AbstractClassRep* pClassRep )
+{
+    // Objects created by their class rep have a pool per type.
+    return getSceneObjectPool().alloc( size, pClassRep );
+}
+
+//-----------------------------------------------------------------------------
+
+void* SceneObject::operator new( size_t size )
+{
+    // The type is unknown here so objects created directly share a pool with types of a similar size.
+    return getSceneObjectPool().alloc( size );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneObject::operator delete( void* pMemory )
+{
+    getSceneObjectPool().free( pMemory );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneObject::setObjectPoolCapacity( const U32 capacity )
+{
+    getSceneObjectPool().setCapacity( capacity );
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneObject::getObjectPoolCapacity( void )
+{
+    return getSceneObjectPool().getCapacity();
+}
+
+//-----------------------------------------------------------------------------
+
+const ObjectPoolAllocator& SceneObject::getObjectPool( void )
+{
+    return getSceneObjectPool();
+}
+
+//-----------------------------------------------------------------------------
+
 void SceneObject::onTamlCustomWrite( TamlCustomNodes& customNodes )
 {
     // Debug Profiling.
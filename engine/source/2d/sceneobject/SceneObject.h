@@ -69,6 +69,10 @@
 
 //-----------------------------------------------------------------------------
 
+class ObjectPoolAllocator;
+
+//-----------------------------------------------------------------------------
+
 struct tDestroyNotification
 {
     SceneObject*    mpSceneObject;
@@ -243,6 +247,16 @@ public:
     SceneObject();
     virtual ~SceneObject();
 
+    /// Pooled allocation.
+    static void*            allocateInstance( const dsize_t size, const AbstractClassRep* pClassRep );
+    static void*            operator new( size_t size );
+    static void*            operator new( size_t size, void* pMemory )  { return pMemory; }
+    static void             operator delete( void* pMemory );
+    static void             operator delete( void* pMemory, void* )     {}
+    static void             setObjectPoolCapacity( const U32 capacity );
+    static U32              getObjectPoolCapacity( void );
+    static const ObjectPoolAllocator& getObjectPool( void );
+
     /// Engine.
     virtual bool            onAdd();
     virtual void            onRemove();
@@ -28,6 +28,24 @@ ConsoleFunction( getGlobalSceneObjectCount, S32, 1, 1,  "() - Gets the system-wi
 
 //-----------------------------------------------------------------------------
 
+ConsoleFunction( setSceneObjectPoolCapacity, void, 2, 2,  "(capacity) - Sets how many scene-objects of each type are allocated from a pool.\n"
+                                                        "Further scene-objects of a type are allocated from the heap.\n"
+                                                        "@param capacity The number of scene-objects of each type allocated from a pool.\n"
+                                                        "@return No return value." )
+{
+    SceneObject::setObjectPoolCapacity( dAtoi(argv[1]) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( getSceneObjectPoolCapacity, S32, 1, 1,  "() - Gets how many scene-objects of each type are allocated from a pool.\n"
+                                                        "@return The number of scene-objects of each type allocated from a pool." )
+{
+    return SceneObject::getObjectPoolCapacity();
+}
+
+//-----------------------------------------------------------------------------
+
 ConsoleMethod(SceneObject, addToScene, void, 3, 3, "(Scene scene) Add the object to a scene.\n"
                                                       "@param scene the scene you wish to add this object to."
                                                       "@return No return value.")
@@ -54,6 +54,10 @@
 #include "console/consoleTypes.h"
 #endif
 
+#ifndef _RESMANAGER_H_
+#include "io/resource/resourceManager.h"
+#endif
+
 // Script bindings.
 #include "assetManager_ScriptBinding.h"
 
@@ -885,6 +889,59 @@ bool AssetManager::renameReferencedAsset( const char* pAssetIdFrom, const char*
 
 //-----------------------------------------------------------------------------
 
+bool AssetManager::prefetchAsset( const char* pAssetId )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(AssetManager_PrefetchAsset);
+
+    // Sanity!
+    AssertFatal( pAssetId != NULL, "Cannot prefetch NULL asset Id." );
+
+    // Find asset.
+    AssetDefinition* pAssetDefinition = findAsset( pAssetId );
+
+    // Did we find the asset?
+    if ( pAssetDefinition == NULL )
+    {
+        // No, so warn.
+        Con::warnf( "Asset Manager: Failed to prefetch asset Id '%s' as it does not exist.", pAssetId );
+        return false;
+    }
+
+    // Finish if the asset is already loaded.
+    if ( pAssetDefinition->mpAssetBase != NULL )
+        return true;
+
+    // Queue a read of the asset definition file.
+    if ( !ResourceManager->prefetch( pAssetDefinition->mAssetBaseFilePath, AsyncReadRequest::PriorityNormal ) )
+        return false;
+
+    // Fetch asset Id.
+    StringTableEntry assetId = StringTable->insert( pAssetId );
+
+    // Find any asset dependencies.
+    typeAssetDependsOnHash::iterator assetDependenciesItr = mAssetDependsOn.find( assetId );
+
+    // Queue reads of any dependency asset definition files that are not loaded.
+    // NOTE: Only the immediate dependencies are prefetched as they are acquired when this asset loads.
+    while( assetDependenciesItr != mAssetDependsOn.end() && assetDependenciesItr->key == assetId )
+    {
+        // Find dependency asset.
+        AssetDefinition* pDependencyDefinition = findAsset( assetDependenciesItr->value );
+
+        // Queue the dependency if it is not loaded.
+        if ( pDependencyDefinition != NULL && pDependencyDefinition->mpAssetBase == NULL )
+            ResourceManager->prefetch( pDependencyDefinition->mAssetBaseFilePath, AsyncReadRequest::PriorityLow );
+
+        // Next dependency.
+        assetDependenciesItr++;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
 bool AssetManager::releaseAsset( const char* pAssetId )
 {
     // Debug Profiling.
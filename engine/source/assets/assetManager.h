@@ -322,6 +322,9 @@ public:
     bool releaseAsset( const char* pAssetId );
     void purgeAssets( void );
 
+    /// Asset prefetching.
+    bool prefetchAsset( const char* pAssetId );
+
     /// Asset deletion.
     bool deleteAsset( const char* pAssetId, const bool deleteLooseFiles, const bool deleteDependencies );
 
@@ -321,6 +321,17 @@ ConsoleMethod( AssetManager, releaseAsset, bool, 3, 3,          "(assetId) - Rel
 
 //-----------------------------------------------------------------------------
 
+ConsoleMethod( AssetManager, prefetchAsset, bool, 3, 3,         "(assetId) - Queue a background read of the specified asset Id and its dependencies.\n"
+                                                                "A later 'acquireAsset' reads the asset from memory if the read has completed.\n"
+                                                                "@param assetId The selected asset Id.\n"
+                                                                "@return Whether the asset read was queued or not.")
+{
+    // Prefetch asset.
+    return object->prefetchAsset( argv[2] );
+}
+
+//-----------------------------------------------------------------------------
+
 ConsoleMethod( AssetManager, purgeAssets, void, 2, 2,           "() - Purge all assets that are not referenced even if they are set to not auto-unload.\n"
                                                                 "Assets can be in this state because they are either set to not auto-unload or the asset manager has/is disabling auto-unload.\n"
                                                                 "@return No return value.")
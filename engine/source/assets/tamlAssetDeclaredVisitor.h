@@ -47,13 +47,13 @@
 class TamlAssetDeclaredVisitor : public TamlXmlVisitor
 {
 protected:
-    virtual bool visit( TiXmlElement* pXmlElement, TamlXmlParser& xmlParser )
+    virtual bool visit( TamlXmlElement& xmlElement, TamlXmlParser& xmlParser )
     {
         // Debug Profiling.
         PROFILE_SCOPE(TamlAssetDeclaredVisitor_VisitElement);
 
         // Finish if this is not the root element.
-        if ( pXmlElement != pXmlElement->GetDocument()->RootElement() )
+        if ( !xmlElement.isRoot() )
             return true;
 
         // Fetch asset field names.
@@ -64,44 +64,47 @@ protected:
         StringTableEntry assetInternalField = StringTable->insert( ASSET_BASE_ASSETINTERNAL_FIELD );
 
         // Iterate attributes.
-        for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+        for ( U32 index = 0; index < xmlElement.getAttributeCount(); ++index )
         {
+            // Fetch attribute.
+            TamlXmlAttribute& xmlAttribute = xmlElement.getAttribute( index );
+
             // Insert attribute name.
-            StringTableEntry attributeName = StringTable->insert( pAttribute->Name() );
+            StringTableEntry attributeName = StringTable->insert( xmlAttribute.getName() );
 
             // Asset name?
             if ( attributeName == assetNameField )
             {
                 // Yes, so assign it.
-                mAssetDefinition.mAssetName = StringTable->insert( pAttribute->Value() );
+                mAssetDefinition.mAssetName = StringTable->insert( xmlAttribute.getValue() );
                 continue;
             }
             // Asset description?
             else if ( attributeName == assetDescriptionField )
             {
                 // Yes, so assign it.
-                mAssetDefinition.mAssetDescription = StringTable->insert( pAttribute->Value() );
+                mAssetDefinition.mAssetDescription = StringTable->insert( xmlAttribute.getValue() );
                 continue;
             }
             // Asset description?
             else if ( attributeName == assetCategoryField )
             {
                 // Yes, so assign it.
-                mAssetDefinition.mAssetCategory = StringTable->insert( pAttribute->Value() );
+                mAssetDefinition.mAssetCategory = StringTable->insert( xmlAttribute.getValue() );
                 continue;
             }
             // Asset auto-unload?
             else if ( attributeName == assetAutoUnloadField )
             {
                 // Yes, so assign it.
-                mAssetDefinition.mAssetAutoUnload = dAtob( pAttribute->Value() );
+                mAssetDefinition.mAssetAutoUnload = dAtob( xmlAttribute.getValue() );
                 continue;
             }
             // Asset internal?
             else if ( attributeName == assetInternalField )
             {
                 // Yes, so assign it.
-                mAssetDefinition.mAssetInternal = dAtob( pAttribute->Value() );
+                mAssetDefinition.mAssetInternal = dAtob( xmlAttribute.getValue() );
                 continue;
             }
         }
@@ -120,12 +123,12 @@ protected:
         mAssetDefinition.mAssetBaseFilePath = StringTable->insert( xmlParser.getParsingFilename() );
 
         // Set asset type.
-        mAssetDefinition.mAssetType = StringTable->insert( pXmlElement->Value() );
+        mAssetDefinition.mAssetType = StringTable->insert( xmlElement.getName() );
 
         return true;
     }
 
-    virtual bool visit( TiXmlAttribute* pAttribute, TamlXmlParser& xmlParser )
+    virtual bool visit( TamlXmlAttribute& xmlAttribute, TamlXmlParser& xmlParser )
     {
         // Debug Profiling.
         PROFILE_SCOPE(TamlAssetDeclaredVisitor_VisitAttribute);
@@ -134,7 +137,7 @@ protected:
         AssertFatal( mAssetDefinition.mAssetName != StringTable->EmptyString, "Cannot generate asset dependencies without asset name." );
 
         // Fetch asset reference.
-        const char* pAssetReference = pAttribute->Value();
+        const char* pAssetReference = xmlAttribute.getValue();
 
         // Fetch field word count.
         const U32 fieldWordCount = StringUnit::getUnitCount( pAssetReference, ASSET_ASSIGNMENT_TOKEN );
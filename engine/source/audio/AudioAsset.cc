@@ -98,6 +98,8 @@ AudioAsset::AudioAsset()
    mDescription.mConeOutsideVolume   = 1.0f;
    mDescription.mConeVector.set(0, 0, 1);
 
+   mPreload                          = false;
+
 }
 
 //--------------------------------------------------------------------------
@@ -111,6 +113,7 @@ void AudioAsset::initPersistFields()
    addProtectedField("VolumeChannel", TypeS32, Offset(mDescription.mVolumeChannel, AudioAsset), &setVolumeChannel, &defaultProtectedGetFn, &writeVolumeChannel, "");
    addProtectedField("Looping", TypeBool, Offset(mDescription.mIsLooping, AudioAsset), &setLooping, &defaultProtectedGetFn, &writeLooping, "");
    addProtectedField("Streaming", TypeBool, Offset(mDescription.mIsStreaming, AudioAsset), &setStreaming, &defaultProtectedGetFn, &writeStreaming, "");
+   addProtectedField("Preload", TypeBool, Offset(mPreload, AudioAsset), &setPreload, &defaultProtectedGetFn, &writePreload, "Whether the audio is decoded when the asset is loaded rather than when first played.");
 
    //addField("is3D",              TypeBool,    Offset(mDescription.mIs3D, AudioAsset));
    //addField("referenceDistance", TypeF32,     Offset(mDescription.mReferenceDistance, AudioAsset));
@@ -141,6 +144,7 @@ void AudioAsset::copyTo(SimObject* object)
     pAsset->setVolumeChannel( getVolumeChannel() );
     pAsset->setLooping( getLooping() );
     pAsset->setStreaming( getStreaming() );
+    pAsset->setPreload( getPreload() );
 }
 
 //--------------------------------------------------------------------------
@@ -167,6 +171,19 @@ void AudioAsset::initializeAsset( void )
         mDescription.mConeOutsideVolume   = mClampF(mDescription.mConeOutsideVolume, 0.0f, 1.0f);
         mDescription.mConeVector.normalize();
     }
+
+    // Release any previously preloaded buffer.
+    mPreloadBuffer = NULL;
+
+    // Decode the audio now if requested.
+    // Streaming audio is decoded as it plays so cannot be preloaded.
+    if ( mPreload && !mDescription.mIsStreaming && mAudioFile != StringTable->EmptyString )
+    {
+        mPreloadBuffer = AudioBuffer::find( mAudioFile );
+
+        if ( mPreloadBuffer.isNull() || mPreloadBuffer->getALBuffer() == 0 )
+            Con::warnf( "AudioAsset::initializeAsset() - Failed to preload audio file '%s'.", mAudioFile );
+    }
 }
 
 //--------------------------------------------------------------------------
@@ -253,6 +270,21 @@ void AudioAsset::setStreaming( const bool streaming )
 
 //--------------------------------------------------------------------------
 
+void AudioAsset::setPreload( const bool preload )
+{
+    // Ignore no change.
+    if ( preload == mPreload )
+        return;
+
+    // Update.
+    mPreload = preload;
+
+    // Refresh the asset.
+    refreshAsset();
+}
+
+//--------------------------------------------------------------------------
+
 void AudioAsset::setDescription( const Audio::Description& audioDescription )
 {
     // Update.
@@ -59,6 +59,8 @@ private:
 
    StringTableEntry mAudioFile;
    Audio::Description mDescription;
+   bool mPreload;
+   Resource<AudioBuffer> mPreloadBuffer;
 
 public:
    AudioAsset();
@@ -80,6 +82,9 @@ public:
    void setStreaming( const bool streaming );
    inline bool getStreaming( void ) const { return mDescription.mIsStreaming; }
 
+   void setPreload( const bool preload );
+   inline bool getPreload( void ) const { return mPreload; }
+
    void setDescription( const Audio::Description& audioDescription );
    inline const Audio::Description& getAudioDescription( void ) const { return mDescription; }
 
@@ -107,6 +112,9 @@ protected:
 
     static bool setStreaming( void* obj, const char* data )                     { static_cast<AudioAsset*>(obj)->setStreaming(dAtob(data)); return false; }
     static bool writeStreaming( void* obj, StringTableEntry pFieldName )        { return static_cast<AudioAsset*>(obj)->getStreaming() == true; }
+
+    static bool setPreload( void* obj, const char* data )                       { static_cast<AudioAsset*>(obj)->setPreload(dAtob(data)); return false; }
+    static bool writePreload( void* obj, StringTableEntry pFieldName )          { return static_cast<AudioAsset*>(obj)->getPreload() == true; }
 };
 
 #endif  // _AUDIO_ASSET_H_
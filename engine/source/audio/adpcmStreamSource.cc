@@ -0,0 +1,553 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "audio/adpcmStreamSource.h"
+#include "audio/imaAdpcm.h"
+#include "console/console.h"
+#include "memory/frameAllocator.h"
+#include "debug/traceProfiler.h"
+
+//-----------------------------------------------------------------------------
+
+/// Walk the RIFF chunks of a WAV stream until the specified chunk is found.
+/// The stream is left positioned at the start of the chunk data.
+static bool findWAVChunk(Stream *stream, const char *chunkId, U32 *chunkSize)
+{
+    while (stream->getStatus() == Stream::Ok)
+    {
+        char id[4];
+        U32 size;
+        if (!stream->read(4, id) || !stream->read(&size))
+            return false;
+
+        if (!dStrncmp(id, chunkId, 4))
+        {
+            *chunkSize = size;
+            return true;
+        }
+
+        // Skip the chunk, rounded up to a WORD.
+        if (!stream->setPosition(stream->getPosition() + size + (size & 1)))
+            return false;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool readWAVRiffHeader(Stream *stream)
+{
+    char riff[4];
+    char wave[4];
+    U32 size;
+
+    if (!stream->read(4, riff) || !stream->read(&size) || !stream->read(4, wave))
+        return false;
+
+    return !dStrncmp(riff, "RIFF", 4) && !dStrncmp(wave, "WAVE", 4);
+}
+
+//-----------------------------------------------------------------------------
+
+bool AdpcmStreamSource::isAdpcmFile(const char *filename)
+{
+    Stream *stream = ResourceManager->openStream(filename);
+    if (stream == NULL)
+        return false;
+
+    U16 format = 0;
+    U32 chunkSize;
+    if (readWAVRiffHeader(stream) && findWAVChunk(stream, "fmt ", &chunkSize))
+        stream->read(&format);
+
+    ResourceManager->closeStream(stream);
+
+    return format == ImaAdpcm::WaveFormatTag;
+}
+
+//-----------------------------------------------------------------------------
+
+void AdpcmStreamSource::DecodeThread::run(void *arg)
+{
+    while (!checkForStop())
+    {
+        // Decode into any chunk the main thread has finished with.
+        U32 index;
+        if (!mSource->mDecodeFinished && mSource->mFreeChunks.pop(index))
+        {
+            mSource->decodeChunk(mSource->mChunks[index]);
+            mSource->mDecodedChunks.push(index);
+            continue;
+        }
+
+        // Wait for a chunk to be returned or to be asked to stop.
+        mSource->mChunkSemaphore.acquire();
+    }
+
+    FrameAllocator::releaseThread();
+    TraceProfiler::releaseThread();
+}
+
+//-----------------------------------------------------------------------------
+
+AdpcmStreamSource::AdpcmStreamSource(const char *filename) :
+    mFreeChunks(DecodedChunkCount),
+    mDecodedChunks(DecodedChunkCount),
+    mChunkSemaphore(0)
+{
+    mStream = NULL;
+    mThread = NULL;
+    mBlockBuffer = NULL;
+    mBuffersAllocated = false;
+    mBufferList[0] = 0;
+
+    for (U32 i = 0; i < DecodedChunkCount; i++)
+        mChunks[i].mData = NULL;
+
+    clear();
+
+    mFilename = filename;
+}
+
+//-----------------------------------------------------------------------------
+
+AdpcmStreamSource::~AdpcmStreamSource()
+{
+    freeStream();
+}
+
+//-----------------------------------------------------------------------------
+
+void AdpcmStreamSource::clear()
+{
+    freeStream();
+
+    mHandle = NULL_AUDIOHANDLE;
+    mSource = NULL;
+
+    dMemset(&mDescription, 0, sizeof(Audio::Description));
+    mEnvironment = 0;
+    mPosition.set(0.f,0.f,0.f);
+    mDirection.set(0.f,1.f,0.f);
+    mPitch = 1.f;
+    mScore = 0.f;
+    mCullTime = 0;
+
+    mDataStart = 0;
+    mDataSize = 0;
+    mDataLeft = 0;
+    mDecodeFinished = false;
+    mDecodeTime = 0;
+
+    mFormat = AL_FORMAT_MONO16;
+    mChannels = 0;
+    mSampleRate = 0;
+    mBlockAlign = 0;
+    mFramesPerBlock = 0;
+    mBlocksPerChunk = 0;
+    mTotalFrames = 0;
+
+    mBuffersQueued = 0;
+    mFramesPlayed = 0;
+    mEndQueued = false;
+
+    bFinishedPlaying = false;
+    bIsValid = false;
+}
+
+//-----------------------------------------------------------------------------
+
+bool AdpcmStreamSource::readHeader()
+{
+    U32 chunkSize;
+
+    if (!readWAVRiffHeader(mStream) || !findWAVChunk(mStream, "fmt ", &chunkSize))
+        return false;
+
+    const U32 formatStart = mStream->getPosition();
+
+    U16 format, channels, blockAlign, bitsPerSample;
+    U32 sampleRate, bytesPerSec;
+    mStream->read(&format);
+    mStream->read(&channels);
+    mStream->read(&sampleRate);
+    mStream->read(&bytesPerSec);
+    mStream->read(&blockAlign);
+    mStream->read(&bitsPerSample);
+
+    if (format != ImaAdpcm::WaveFormatTag || bitsPerSample != 4 || (channels != 1 && channels != 2))
+    {
+        Con::warnf("AdpcmStreamSource - '%s' is not a mono or stereo IMA ADPCM file.", mFilename);
+        return false;
+    }
+
+    mChannels = channels;
+    mSampleRate = sampleRate;
+    mBlockAlign = blockAlign;
+    mFramesPerBlock = ImaAdpcm::getFramesPerBlock(blockAlign, channels);
+    mFormat = channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+
+    if (mFramesPerBlock == 0)
+        return false;
+
+    // Skip the rest of the format chunk.
+    mStream->setPosition(formatStart + chunkSize + (chunkSize & 1));
+
+    if (!findWAVChunk(mStream, "data", &chunkSize))
+        return false;
+
+    mDataStart = mStream->getPosition();
+    mDataSize = chunkSize;
+    mDataLeft = chunkSize;
+
+    // Work out the total length, including a trailing partial block.
+    const U32 fullBlocks = mDataSize / mBlockAlign;
+    mTotalFrames = (fullBlocks * mFramesPerBlock) + ImaAdpcm::getFramesPerBlock(mDataSize % mBlockAlign, mChannels);
+
+    // Size chunks to a whole number of blocks.
+    mBlocksPerChunk = getMax((U32)1, (U32)(TargetChunkSize / (mFramesPerBlock * mChannels * sizeof(S16))));
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool AdpcmStreamSource::initStream()
+{
+    // Release anything left from a previous initialization.
+    freeStream();
+
+    alSourceStop(mSource);
+    alSourcei(mSource, AL_BUFFER, 0);
+
+    // Start playback state afresh.
+    mDecodeFinished = false;
+    mDecodeTime = 0;
+    mBuffersQueued = 0;
+    mFramesPlayed = 0;
+    mEndQueued = false;
+    bFinishedPlaying = false;
+
+    mStream = ResourceManager->openStream(mFilename);
+    if (mStream == NULL)
+        return false;
+
+    if (!readHeader())
+    {
+        freeStream();
+        return false;
+    }
+
+    // Allocate the decode buffers.
+    mBlockBuffer = new U8[mBlockAlign];
+
+    const U32 chunkSamples = mBlocksPerChunk * mFramesPerBlock * mChannels;
+    for (U32 i = 0; i < DecodedChunkCount; i++)
+    {
+        mChunks[i].mData = new S16[chunkSamples];
+        mChunks[i].mFrames = 0;
+        mChunks[i].mEndOfStream = false;
+    }
+
+    // Clear Error Code
+    alGetError();
+
+    alGenBuffers(NUMBUFFERS, mBufferList);
+    if (alGetError() != AL_NO_ERROR)
+    {
+        freeStream();
+        return false;
+    }
+
+    mBuffersAllocated = true;
+
+    // Decode the first chunks synchronously so playback can start immediately.
+    // The decode thread isn't running yet so it is safe to use the chunks directly.
+    for (U32 i = 0; i < DecodedChunkCount; i++)
+    {
+        if (i < NUMBUFFERS && !mDecodeFinished)
+        {
+            decodeChunk(mChunks[i]);
+            mDecodedChunks.push(i);
+        }
+        else
+        {
+            mFreeChunks.push(i);
+        }
+    }
+
+    for (U32 i = 0; i < NUMBUFFERS; i++)
+    {
+        if (!queueBuffer(mBufferList[i]))
+            mIdleBuffers.push_back(mBufferList[i]);
+    }
+
+    alSourcei(mSource, AL_LOOPING, AL_FALSE);
+
+    // Decode the rest in the background.
+    mThread = new DecodeThread(this);
+    mThread->start();
+
+    bIsValid = true;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void AdpcmStreamSource::decodeChunk(DecodedChunk& chunk)
+{
+    const U64 startTime = Platform::getRealMicroseconds();
+
+    chunk.mFrames = 0;
+    chunk.mEndOfStream = false;
+
+    for (U32 block = 0; block < mBlocksPerChunk; block++)
+    {
+        if (mDataLeft == 0)
+        {
+            if (!mDescription.mIsLooping)
+            {
+                chunk.mEndOfStream = true;
+                break;
+            }
+
+            // Loop back to the start of the data.
+            mStream->setPosition(mDataStart);
+            mDataLeft = mDataSize;
+        }
+
+        const U32 readSize = getMin(mDataLeft, mBlockAlign);
+        if (!mStream->read(readSize, mBlockBuffer))
+        {
+            chunk.mEndOfStream = true;
+            break;
+        }
+
+        mDataLeft -= readSize;
+        chunk.mFrames += ImaAdpcm::decodeBlock(mBlockBuffer, readSize, mChannels, chunk.mData + (chunk.mFrames * mChannels));
+    }
+
+    // Flag the end as soon as the data runs out so no empty chunk is needed.
+    if (mDataLeft == 0 && !mDescription.mIsLooping)
+        chunk.mEndOfStream = true;
+
+    if (chunk.mEndOfStream)
+        mDecodeFinished = true;
+
+    mDecodeTime += U32(Platform::getRealMicroseconds() - startTime);
+}
+
+//-----------------------------------------------------------------------------
+
+S32 AdpcmStreamSource::findBuffer(ALuint buffer) const
+{
+    for (S32 i = 0; i < NUMBUFFERS; i++)
+    {
+        if (mBufferList[i] == buffer)
+            return i;
+    }
+
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+bool AdpcmStreamSource::queueBuffer(ALuint buffer)
+{
+    if (mEndQueued)
+        return false;
+
+    U32 index;
+    if (!mDecodedChunks.pop(index))
+        return false;
+
+    DecodedChunk& chunk = mChunks[index];
+
+    bool queued = false;
+    if (chunk.mFrames > 0)
+    {
+        alBufferData(buffer, mFormat, chunk.mData, chunk.mFrames * mChannels * sizeof(S16), mSampleRate);
+        alSourceQueueBuffers(mSource, 1, &buffer);
+
+        const S32 bufferIndex = findBuffer(buffer);
+        if (bufferIndex >= 0)
+            mBufferFrames[bufferIndex] = chunk.mFrames;
+
+        mBuffersQueued++;
+        queued = true;
+    }
+
+    if (chunk.mEndOfStream)
+        mEndQueued = true;
+
+    // Hand the chunk back to the decoder.
+    mFreeChunks.push(index);
+    mChunkSemaphore.release();
+
+    return queued;
+}
+
+//-----------------------------------------------------------------------------
+
+bool AdpcmStreamSource::updateBuffers()
+{
+    // don't do anything if buffer isn't initialized
+    if (!bIsValid)
+        return false;
+
+    // reset AL error code
+    alGetError();
+
+    // Unqueue any buffers that have finished playing.
+    ALint processed = 0;
+    alGetSourcei(mSource, AL_BUFFERS_PROCESSED, &processed);
+
+    while (processed > 0)
+    {
+        ALuint buffer;
+        alSourceUnqueueBuffers(mSource, 1, &buffer);
+        if (alGetError() != AL_NO_ERROR)
+            return false;
+
+        const S32 bufferIndex = findBuffer(buffer);
+        if (bufferIndex >= 0)
+            mFramesPlayed += mBufferFrames[bufferIndex];
+
+        mBuffersQueued--;
+        mIdleBuffers.push_back(buffer);
+        processed--;
+    }
+
+    // Refill idle buffers with whatever the decoder has ready.
+    while (mIdleBuffers.size() > 0 && queueBuffer(mIdleBuffers.last()))
+        mIdleBuffers.pop_back();
+
+    // Restart the source if it ran dry while waiting for the decoder.
+    if (mBuffersQueued > 0)
+    {
+        ALint state = AL_PLAYING;
+        alGetSourcei(mSource, AL_SOURCE_STATE, &state);
+        if (state == AL_STOPPED)
+            alSourcePlay(mSource);
+    }
+
+    if (mBuffersQueued == 0 && mEndQueued)
+    {
+        bFinishedPlaying = true;
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void AdpcmStreamSource::freeStream()
+{
+    if (mThread != NULL)
+    {
+        mThread->stop();
+        mChunkSemaphore.release();
+        mThread->join();
+        delete mThread;
+        mThread = NULL;
+    }
+
+    if (mStream != NULL)
+        ResourceManager->closeStream(mStream);
+    mStream = NULL;
+
+    if (mBuffersAllocated)
+    {
+        alDeleteBuffers(NUMBUFFERS, mBufferList);
+        for (U32 i = 0; i < NUMBUFFERS; i++)
+            mBufferList[i] = 0;
+
+        mBuffersAllocated = false;
+    }
+
+    mIdleBuffers.clear();
+
+    // Drain the chunk queues.
+    U32 index;
+    while (mFreeChunks.pop(index)) {}
+    while (mDecodedChunks.pop(index)) {}
+
+    for (U32 i = 0; i < DecodedChunkCount; i++)
+    {
+        delete [] mChunks[i].mData;
+        mChunks[i].mData = NULL;
+    }
+
+    delete [] mBlockBuffer;
+    mBlockBuffer = NULL;
+
+    bIsValid = false;
+}
+
+//-----------------------------------------------------------------------------
+
+F32 AdpcmStreamSource::getElapsedTime()
+{
+    if (mSampleRate == 0)
+        return 0.f;
+
+    // Only whole buffers are counted as not every OpenAL implementation
+    // supports querying the offset within the playing buffer.
+    U32 frames = mFramesPlayed;
+    if (mTotalFrames > 0)
+        frames %= mTotalFrames;
+
+    return F32(frames) / F32(mSampleRate);
+}
+
+//-----------------------------------------------------------------------------
+
+F32 AdpcmStreamSource::getTotalTime()
+{
+    if (mSampleRate == 0)
+        return 0.f;
+
+    return F32(mTotalFrames) / F32(mSampleRate);
+}
+
+//-----------------------------------------------------------------------------
+
+U32 AdpcmStreamSource::getMemoryUsage()
+{
+    if (!bIsValid)
+        return 0;
+
+    // Decoded chunks plus the same again for the OpenAL buffer copies.
+    const U32 chunkSize = mBlocksPerChunk * mFramesPerBlock * mChannels * sizeof(S16);
+    return (chunkSize * (DecodedChunkCount + NUMBUFFERS)) + mBlockAlign;
+}
+
+//-----------------------------------------------------------------------------
+
+F32 AdpcmStreamSource::getDecodeTime()
+{
+    return F32(mDecodeTime) / 1000.f;
+}
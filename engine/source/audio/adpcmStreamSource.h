@@ -0,0 +1,135 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _ADPCMSTREAMSOURCE_H_
+#define _ADPCMSTREAMSOURCE_H_
+
+#ifndef _AUDIOSTREAMSOURCE_H_
+#include "audio/audioStreamSource.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_THREAD_H_
+#include "platform/threads/thread.h"
+#endif
+
+#ifndef _PLATFORM_THREAD_SEMAPHORE_H_
+#include "platform/threads/semaphore.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_LOCKFREEQUEUE_H_
+#include "platform/threads/lockFreeQueue.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// Streams IMA ADPCM compressed WAV files.
+///
+/// Blocks are decoded on a background thread into a ring of PCM chunks.
+/// updateBuffers() only copies decoded chunks into the OpenAL buffer queue
+/// so the main thread never pays for decoding.
+class AdpcmStreamSource: public AudioStreamSource
+{
+public:
+    AdpcmStreamSource(const char *filename);
+    virtual ~AdpcmStreamSource();
+
+    virtual bool initStream();
+    virtual bool updateBuffers();
+    virtual void freeStream();
+    virtual F32 getElapsedTime();
+    virtual F32 getTotalTime();
+    virtual U32 getMemoryUsage();
+    virtual F32 getDecodeTime();
+
+    /// Check whether the specified file is an IMA ADPCM WAV file.
+    static bool isAdpcmFile(const char *filename);
+
+private:
+    enum
+    {
+        DecodedChunkCount = NUMBUFFERS + 4,
+        TargetChunkSize = 32768,
+    };
+
+    struct DecodedChunk
+    {
+        S16*    mData;
+        U32     mFrames;
+        bool    mEndOfStream;
+    };
+
+    class DecodeThread : public Thread
+    {
+        AdpcmStreamSource* mSource;
+
+    public:
+        DecodeThread(AdpcmStreamSource* source) : Thread(0, NULL, false), mSource(source) {}
+        virtual void run(void *arg = 0);
+    };
+
+    // Stream state (owned by the decode thread once it is running).
+    Stream*                 mStream;
+    U32                     mDataStart;
+    U32                     mDataSize;
+    U32                     mDataLeft;
+    U8*                     mBlockBuffer;
+    bool                    mDecodeFinished;
+    volatile U32            mDecodeTime;        ///< Microseconds spent decoding.
+
+    // Format.
+    ALenum                  mFormat;
+    U32                     mChannels;
+    U32                     mSampleRate;
+    U32                     mBlockAlign;
+    U32                     mFramesPerBlock;
+    U32                     mBlocksPerChunk;
+    U32                     mTotalFrames;
+
+    // Decoded chunk ring.
+    DecodedChunk            mChunks[DecodedChunkCount];
+    LockFreeSPSCQueue<U32>  mFreeChunks;
+    LockFreeSPSCQueue<U32>  mDecodedChunks;
+    Semaphore               mChunkSemaphore;
+    DecodeThread*           mThread;
+
+    // OpenAL state (main thread).
+    ALuint                  mBufferList[NUMBUFFERS];
+    U32                     mBufferFrames[NUMBUFFERS];
+    Vector<ALuint>          mIdleBuffers;
+    U32                     mBuffersQueued;
+    U32                     mFramesPlayed;
+    bool                    mEndQueued;
+    bool                    mBuffersAllocated;
+
+    void clear();
+    bool readHeader();
+    void decodeChunk(DecodedChunk& chunk);
+    bool queueBuffer(ALuint buffer);
+    S32 findBuffer(ALuint buffer) const;
+};
+
+#endif // _ADPCMSTREAMSOURCE_H_
@@ -840,6 +840,18 @@ AUDIOHANDLE alxCreateSource(const Audio::Description& desc,
          AssertFatal(!mStreamingInactiveList.findImage(streamSource->mHandle), "alxCreateSource: handle in inactive list");
          AssertFatal(!mStreamingCulledList.findImage(streamSource->mHandle), "alxCreateSource: handle in culled list");
 
+         // queue the initial buffers now the source is assigned
+         if (!streamSource->initStream())
+         {
+            Con::warnf("alxCreateSource: failed to initialize stream '%s'.", filename);
+            delete streamSource;
+
+            mSampleEnvironment[index] = 0;
+            mHandle[index] = NULL_AUDIOHANDLE;
+            mBuffer[index] = 0;
+            return NULL_AUDIOHANDLE;
+         }
+
          alxSourcePlay(streamSource);
 
          // add to the looping list
@@ -2402,6 +2414,13 @@ bool OpenALInit()
 {
    OpenALShutdown();
 
+   // Leave audio without a device when headless.
+   if(Platform::isHeadless())
+   {
+      Con::printf("   OpenAL disabled when running headless.");
+      return false;
+   }
+
    if(!OpenALDLLInit())
       return false;
 
@@ -22,6 +22,8 @@
 
 #include "platform/platformAL.h"
 #include "audio/audioBuffer.h"
+#include "audio/audioMixer.h"
+#include "audio/imaAdpcm.h"
 #include "io/stream.h"
 #include "console/console.h"
 #include "memory/frameAllocator.h"
@@ -106,10 +108,14 @@ AudioBuffer::AudioBuffer(StringTableEntry filename)
    mFilename = filename;
    mLoading = false;
    malBuffer = 0;
+   mMixerSample = NULL;
 }
 
 AudioBuffer::~AudioBuffer()
 {
+   if (mMixerSample)
+      mMixerSample->release();
+
    if( malBuffer != 0 ) 
    {
      alGetError();
@@ -221,10 +227,57 @@ ALuint AudioBuffer::getALBuffer()
    return 0;
 }
 
+AudioMixerSample* AudioBuffer::getMixerSample()
+{
+   if (mMixerSample)
+      return mMixerSample;
+
+   S32 len = dStrlen(mFilename);
+   if(len <= 3 || dStricmp(mFilename + len - 4, ".wav"))
+      return NULL;
+
+   ResourceObject * obj = ResourceManager->find(mFilename);
+   if(!obj)
+      return NULL;
+
+   ALenum  format;
+   char   *data;
+   ALsizei size;
+   ALsizei freq;
+
+   if (!readWAVData(obj, &format, &data, &size, &freq))
+      return NULL;
+
+   const U32 channels = (format == AL_FORMAT_STEREO8 || format == AL_FORMAT_STEREO16) ? 2 : 1;
+   const U32 bits = (format == AL_FORMAT_MONO8 || format == AL_FORMAT_STEREO8) ? 8 : 16;
+   mMixerSample = AudioMixerSample::createFromPCM(data, size, bits, channels, freq);
+   delete [] data;
+
+   return mMixerSample;
+}
+
 /*!   The Read a WAV file from the given ResourceObject and initialize
       an alBuffer with it.
 */
 bool AudioBuffer::readWAV(ResourceObject *obj)
+{
+   ALenum  format = AL_FORMAT_MONO16;
+   char   *data   = NULL;
+   ALsizei size   = 0;
+   ALsizei freq   = 22050;
+
+   if (!readWAVData(obj, &format, &data, &size, &freq))
+      return false;
+
+   alBufferData(malBuffer, format, data, size, freq);
+   delete [] data;
+   return (alGetError() == AL_NO_ERROR);
+}
+
+/*!   Read the PCM data of a WAV file from the given ResourceObject.
+      The caller owns the returned data.
+*/
+bool AudioBuffer::readWAVData(ResourceObject *obj, ALenum *pFormat, char **pData, ALsizei *pSize, ALsizei *pFreq)
 {
    WAVChunkHdr chunkHdr;
    WAVFmtExHdr fmtExHdr;
@@ -276,7 +329,14 @@ bool AudioBuffer::readWAV(ResourceObject *obj)
          else
          {
             stream->read(sizeof(WAVFmtExHdr), &fmtExHdr);
-            chunkRemaining -= sizeof(WAVFmtExHdr);
+            chunkRemaining -= sizeof(WAVFmtHdr) + sizeof(WAVFmtExHdr);
+
+            // IMA ADPCM is decoded to 16-bit PCM on load.
+            if (fmtHdr.format==ImaAdpcm::WaveFormatTag && fmtHdr.channels <= 2)
+            {
+               format=(fmtHdr.channels==1?AL_FORMAT_MONO16:AL_FORMAT_STEREO16);
+               freq=fmtHdr.samplesPerSec;
+            }
          }
       }
       // WAV Format header
@@ -311,9 +371,36 @@ bool AudioBuffer::readWAV(ResourceObject *obj)
             else
                break;
          }
-         else if (fmtHdr.format==0x0011)
+         else if (fmtHdr.format==ImaAdpcm::WaveFormatTag)
          {
             //IMA ADPCM
+            const U32 blockAlign = fmtHdr.blockAlign;
+            const U32 framesPerBlock = ImaAdpcm::getFramesPerBlock(blockAlign, fmtHdr.channels);
+            if (framesPerBlock == 0 || fmtHdr.channels > 2)
+               break;
+
+            // Decode the whole chunk up front so the buffer can be shared.
+            const U32 blockCount = (chunkHdr.size + blockAlign - 1) / blockAlign;
+            data = new char[blockCount * framesPerBlock * fmtHdr.channels * sizeof(S16)];
+            S16 *pcm = (S16*)data;
+            U8 *block = new U8[blockAlign];
+
+            U32 frames = 0;
+            U32 dataLeft = chunkHdr.size;
+            while (dataLeft > 0)
+            {
+               const U32 readSize = getMin(dataLeft, blockAlign);
+               if (!stream->read(readSize, block))
+                  break;
+
+               frames += ImaAdpcm::decodeBlock(block, readSize, fmtHdr.channels, pcm + (frames * fmtHdr.channels));
+               dataLeft -= readSize;
+            }
+
+            delete [] block;
+
+            size = frames * fmtHdr.channels * sizeof(S16);
+            chunkRemaining -= chunkHdr.size - dataLeft;
          }
          else if (fmtHdr.format==0x0055)
          {
@@ -354,9 +441,11 @@ bool AudioBuffer::readWAV(ResourceObject *obj)
    ResourceManager->closeStream(stream);
    if (data)
    {
-      alBufferData(malBuffer, format, data, size, freq);
-      delete [] data;
-      return (alGetError() == AL_NO_ERROR);
+      *pFormat = format;
+      *pData   = data;
+      *pSize   = size;
+      *pFreq   = freq;
+      return true;
    }
 
    return false;
@@ -35,6 +35,8 @@
 
 //--------------------------------------------------------------------------
 
+class AudioMixerSample;
+
 class AudioBuffer: public ResourceInstance
 {
    friend class AudioThread;
@@ -43,14 +45,17 @@ private:
    StringTableEntry  mFilename;
    bool              mLoading;
    ALuint            malBuffer;
+   AudioMixerSample* mMixerSample;
 
    bool readRIFFchunk(Stream &s, const char *seekLabel, U32 *size);
    bool readWAV(ResourceObject *obj);
+   bool readWAVData(ResourceObject *obj, ALenum *pFormat, char **pData, ALsizei *pSize, ALsizei *pFreq);
 
 public:
    AudioBuffer(StringTableEntry filename);
    ~AudioBuffer();
    ALuint getALBuffer();
+   AudioMixerSample* getMixerSample();
    bool isLoading() {return(mLoading);}
 
    static Resource<AudioBuffer> find(const char *filename);
@@ -42,6 +42,10 @@
 #include "audio/audioAsset.h"
 #endif
 
+#ifndef _AUDIOSTREAMSOURCE_H_
+#include "audio/audioStreamSource.h"
+#endif
+
 #ifdef TORQUE_OS_IOS
 #include "platformiOS/iOSStreamSource.h"
 #endif
@@ -679,6 +683,23 @@ ConsoleFunction(alxGetStreamDuration, F32, 2, 2, "( handle ) Use the alxGetStrea
    return alxGetStreamDuration( handle );
 }
 
+//-----------------------------------------------
+ConsoleFunction(alxGetStreamStats, const char *, 2, 2, "( handle ) Use the alxGetStreamStats function to get the decoder statistics for a streaming sound.\n"
+                                                                "@param handle The ID (a non-negative integer) corresponding to a previously set up streaming sound source.\n"
+                                                                "@return Returns \"memoryBytes decodeMs\" or an empty string for an invalid handle.\n"
+                                                                "@sa alxGetStreamPosition, alxGetStreamDuration")
+{
+   AUDIOHANDLE handle = dAtoi(argv[1]);
+
+   AudioStreamSource* streamSource = alxFindAudioStreamSource( handle );
+   if( streamSource == NULL )
+      return "";
+
+   char* pBuffer = Con::getReturnBuffer(64);
+   dSprintf(pBuffer, 64, "%d %g", streamSource->getMemoryUsage(), streamSource->getDecodeTime());
+   return pBuffer;
+}
+
 #ifdef TORQUE_OS_IOS
 ConsoleFunction(startiOSAudioStream, S32, 2, 2,  "(audio-assetId) - Play the audio asset Id.\n"
                                                     "@param audio-assetId The asset Id to play.  This *must* be an MP3 to work correctly.\n"
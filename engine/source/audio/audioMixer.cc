@@ -0,0 +1,840 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "audio/audioMixer.h"
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _STRINGTABLE_H_
+#include "string/stringTable.h"
+#endif
+
+#ifndef _PLATFORMENDIAN_H_
+#include "platform/platformEndian.h"
+#endif
+
+#ifndef _ASSET_MANAGER_H_
+#include "assets/assetManager.h"
+#endif
+
+#ifndef _AUDIO_H_
+#include "audio/audio.h"
+#endif
+
+#ifndef _AUDIO_ASSET_H_
+#include "audio/audioAsset.h"
+#endif
+
+#ifndef _AUDIOBUFFER_H_
+#include "audio/audioBuffer.h"
+#endif
+
+#ifndef _FRAMEALLOCATOR_H_
+#include "memory/frameAllocator.h"
+#endif
+
+#ifndef _TRACE_PROFILER_H_
+#include "debug/traceProfiler.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_ATOMIC_H_
+#include "platform/threads/atomic.h"
+#endif
+
+#include "memory/safeDelete.h"
+
+#if defined(TORQUE_CPU_X86) && (defined(TORQUE_COMPILER_VISUALC) || defined(__SSE__))
+#define TORQUE_AUDIO_MIXER_SSE
+#include <xmmintrin.h>
+#endif
+
+// Script bindings.
+#include "audioMixer_ScriptBinding.h"
+
+//-----------------------------------------------------------------------------
+
+#define MIXER_MIN_GAIN  0.05f     // Voices quieter than this are not started (matches the OpenAL layer).
+
+AudioMixer* gAudioMixer = NULL;
+
+//-----------------------------------------------------------------------------
+
+AudioMixerSample::AudioMixerSample( F32* pData, const U32 frameCount, const U32 channels, const U32 sampleRate ) :
+   mData( pData ),
+   mFrameCount( frameCount ),
+   mChannels( channels ),
+   mSampleRate( sampleRate ),
+   mRefCount( 1 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixerSample::~AudioMixerSample()
+{
+   delete [] mData;
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixerSample* AudioMixerSample::createFromPCM( const void* pData, const U32 dataSize, const U32 bitsPerSample, const U32 channels, const U32 sampleRate )
+{
+   // Sanity!
+   if ( pData == NULL || (channels != 1 && channels != 2) || (bitsPerSample != 8 && bitsPerSample != 16) || sampleRate == 0 )
+   {
+      Con::warnf( "AudioMixerSample::createFromPCM() - Unsupported format: %d channel(s), %d bits, %dHz.", channels, bitsPerSample, sampleRate );
+      return NULL;
+   }
+
+   const U32 sampleCount = dataSize / (bitsPerSample / 8);
+   const U32 frameCount = sampleCount / channels;
+
+   if ( frameCount == 0 )
+      return NULL;
+
+   F32* pSamples = new F32[frameCount * channels];
+
+   if ( bitsPerSample == 8 )
+   {
+      const U8* pSource = (const U8*)pData;
+      for ( U32 index = 0; index < frameCount * channels; ++index )
+         pSamples[index] = (F32(pSource[index]) - 128.0f) * (1.0f / 128.0f);
+   }
+   else
+   {
+      const S16* pSource = (const S16*)pData;
+      for ( U32 index = 0; index < frameCount * channels; ++index )
+         pSamples[index] = F32(pSource[index]) * (1.0f / 32768.0f);
+   }
+
+   return new AudioMixerSample( pSamples, frameCount, channels, sampleRate );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixerSample::acquire( void )
+{
+   dAtomicIncrement( mRefCount );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixerSample::release( void )
+{
+   if ( dAtomicDecrement( mRefCount ) == 0 )
+      delete this;
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixerFileSink::AudioMixerFileSink( const char* pFilename ) :
+   mSampleRate( 0 ),
+   mDataSize( 0 ),
+   mOpen( false )
+{
+   mFilename = StringTable->insert( pFilename );
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixerFileSink::~AudioMixerFileSink()
+{
+   close();
+}
+
+//-----------------------------------------------------------------------------
+
+bool AudioMixerFileSink::open( const U32 sampleRate )
+{
+   char pathBuffer[1024];
+   Con::expandPath( pathBuffer, sizeof(pathBuffer), mFilename );
+
+   if ( !mStream.open( pathBuffer, FileStream::Write ) )
+   {
+      Con::warnf( "AudioMixerFileSink::open() - Could not open '%s' for writing.", pathBuffer );
+      return false;
+   }
+
+   mSampleRate = sampleRate;
+   mDataSize = 0;
+   mOpen = true;
+
+   // Write a provisional header, the sizes are patched on close.
+   writeHeader();
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixerFileSink::writeHeader( void )
+{
+   const U16 channels = AudioMixer::OutputChannels;
+   const U16 bitsPerSample = 16;
+   const U16 blockAlign = channels * (bitsPerSample / 8);
+
+   mStream.write( 4, "RIFF" );
+   mStream.write( U32(36 + mDataSize) );
+   mStream.write( 4, "WAVE" );
+   mStream.write( 4, "fmt " );
+   mStream.write( U32(16) );
+   mStream.write( U16(1) );
+   mStream.write( channels );
+   mStream.write( mSampleRate );
+   mStream.write( U32(mSampleRate * blockAlign) );
+   mStream.write( blockAlign );
+   mStream.write( bitsPerSample );
+   mStream.write( 4, "data" );
+   mStream.write( mDataSize );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixerFileSink::write( const F32* pFrames, const U32 frameCount )
+{
+   if ( !mOpen )
+      return;
+
+   const U32 ChunkSamples = 1024;
+   S16 chunk[ChunkSamples];
+
+   U32 samplesRemaining = frameCount * AudioMixer::OutputChannels;
+   while ( samplesRemaining > 0 )
+   {
+      const U32 samples = getMin( samplesRemaining, ChunkSamples );
+
+      for ( U32 index = 0; index < samples; ++index )
+         chunk[index] = convertHostToLEndian( S16(pFrames[index] * 32767.0f) );
+
+      mStream.write( samples * sizeof(S16), chunk );
+
+      pFrames += samples;
+      samplesRemaining -= samples;
+      mDataSize += samples * sizeof(S16);
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixerFileSink::close( void )
+{
+   if ( !mOpen )
+      return;
+
+   // Patch the header sizes.
+   mStream.setPosition( 0 );
+   writeHeader();
+   mStream.close();
+
+   mOpen = false;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::MixerThread::run( void* arg )
+{
+   const U32 startTime = Platform::getRealMilliseconds();
+   U64 framesMixed = 0;
+
+   while ( !checkForStop() )
+   {
+      mMixer->mixBlock( mMixer->mBlockFrames );
+      framesMixed += mMixer->mBlockFrames;
+
+      // Real-time sinks consume output at the sample rate so don't run ahead of the wall clock.
+      if ( mMixer->mSink->isRealTime() )
+      {
+         const U32 mixedTime = U32( (framesMixed * 1000) / mMixer->mSampleRate );
+         const U32 elapsedTime = Platform::getRealMilliseconds() - startTime;
+
+         if ( mixedTime > elapsedTime )
+            Platform::sleep( mixedTime - elapsedTime );
+      }
+   }
+
+   FrameAllocator::releaseThread();
+   TraceProfiler::releaseThread();
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixer::AudioMixer( const U32 sampleRate, const U32 maxVoices, const U32 blockFrames ) :
+   mSampleRate( sampleRate ),
+   mMaxVoices( maxVoices ),
+   mBlockFrames( blockFrames ),
+   mLastHandle( 0 ),
+   mSink( NULL ),
+   mThread( NULL ),
+   mMasterVolume( 1.0f ),
+   mStatsSequence( 0 ),
+   mCommands( CommandQueueSize ),
+   mRetired( CommandQueueSize )
+{
+   AssertFatal( sampleRate > 0, "AudioMixer() - Invalid sample rate." );
+   AssertFatal( maxVoices > 0, "AudioMixer() - Invalid voice count." );
+   AssertFatal( blockFrames > 0, "AudioMixer() - Invalid block size." );
+
+   // Allocate the output and scratch blocks 16-byte aligned for the SIMD paths.
+   const U32 blockSize = mBlockFrames * OutputChannels * sizeof(F32);
+   mBufferMemory = dMalloc( (blockSize * 2) + 16 );
+   mOutput = (F32*)((((dsize_t)mBufferMemory) + 15) & ~((dsize_t)15));
+   mScratch = (F32*)(((U8*)mOutput) + blockSize);
+
+   mVoices.reserve( mMaxVoices );
+
+   resetStats();
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixer::~AudioMixer()
+{
+   stop();
+
+   dFree( mBufferMemory );
+}
+
+//-----------------------------------------------------------------------------
+
+bool AudioMixer::start( AudioMixerSink* pSink, const bool threaded )
+{
+   AssertFatal( pSink != NULL, "AudioMixer::start() - Invalid sink." );
+
+   // Stop any current output.
+   stop();
+
+   if ( !pSink->open( mSampleRate ) )
+      return false;
+
+   mSink = pSink;
+
+   if ( threaded )
+   {
+      mThread = new MixerThread( this );
+      mThread->start();
+   }
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::stop( void )
+{
+   if ( mSink == NULL )
+      return;
+
+   if ( mThread != NULL )
+   {
+      mThread->stop();
+      mThread->join();
+      delete mThread;
+      mThread = NULL;
+   }
+
+   // Drain outstanding commands then retire every voice so all samples are released.
+   processCommands();
+
+   while ( mVoices.size() > 0 )
+      retireVoice( mVoices.size() - 1 );
+
+   do
+   {
+      flushRetired();
+      update();
+   }
+   while ( mPendingRetired.size() > 0 );
+
+   publishStats();
+
+   mSink->close();
+   mSink = NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+bool AudioMixer::pushCommand( const Command& command )
+{
+   if ( mCommands.push( command ) )
+      return true;
+
+   mCommandsDropped++;
+   return false;
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixer::VoiceHandle AudioMixer::play( AudioMixerSample* pSample, const F32 volume, const F32 pitch, const bool looping )
+{
+   if ( mSink == NULL || pSample == NULL )
+      return 0;
+
+   // Generate a new handle, skipping the invalid handle on wrap.
+   if ( ++mLastHandle == 0 )
+      ++mLastHandle;
+
+   Command command;
+   command.mType = CommandPlay;
+   command.mHandle = mLastHandle;
+   command.mSample = pSample;
+   command.mValue = volume;
+   command.mPitch = getMax( pitch, 0.0f );
+   command.mLooping = looping;
+
+   // The voice holds its own reference until it is retired.
+   pSample->acquire();
+
+   if ( !pushCommand( command ) )
+   {
+      pSample->release();
+      return 0;
+   }
+
+   mLiveHandles.push_back( mLastHandle );
+
+   return mLastHandle;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::stopVoice( const VoiceHandle handle )
+{
+   if ( !isPlaying( handle ) )
+      return;
+
+   Command command;
+   command.mType = CommandStop;
+   command.mHandle = handle;
+   pushCommand( command );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::stopAll( void )
+{
+   if ( mSink == NULL )
+      return;
+
+   Command command;
+   command.mType = CommandStopAll;
+   command.mHandle = 0;
+   pushCommand( command );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::setVolume( const VoiceHandle handle, const F32 volume )
+{
+   if ( !isPlaying( handle ) )
+      return;
+
+   Command command;
+   command.mType = CommandVolume;
+   command.mHandle = handle;
+   command.mValue = volume;
+   pushCommand( command );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::setPitch( const VoiceHandle handle, const F32 pitch )
+{
+   if ( !isPlaying( handle ) )
+      return;
+
+   Command command;
+   command.mType = CommandPitch;
+   command.mHandle = handle;
+
+   // Voices can't play backwards.
+   command.mValue = getMax( pitch, 0.0f );
+   pushCommand( command );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::setMasterVolume( const F32 volume )
+{
+   if ( mSink == NULL )
+   {
+      mMasterVolume = volume;
+      return;
+   }
+
+   Command command;
+   command.mType = CommandMasterVolume;
+   command.mHandle = 0;
+   command.mValue = volume;
+   pushCommand( command );
+}
+
+//-----------------------------------------------------------------------------
+
+bool AudioMixer::isPlaying( const VoiceHandle handle ) const
+{
+   return handle != 0 && mLiveHandles.find_next( handle ) >= 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::update( void )
+{
+   RetiredVoice retired;
+   while ( mRetired.pop( retired ) )
+   {
+      const S32 index = mLiveHandles.find_next( retired.mHandle );
+      if ( index >= 0 )
+         mLiveHandles.erase_fast( index );
+
+      retired.mSample->release();
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::render( const U32 frameCount )
+{
+   AssertFatal( mThread == NULL, "AudioMixer::render() - Cannot render synchronously whilst the mixer thread is running." );
+
+   if ( mSink == NULL )
+      return;
+
+   U32 framesRemaining = frameCount;
+   while ( framesRemaining > 0 )
+   {
+      const U32 frames = getMin( framesRemaining, mBlockFrames );
+      mixBlock( frames );
+      framesRemaining -= frames;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+AudioMixer::Stats AudioMixer::getStats( void ) const
+{
+   // Retry if the mixer published whilst we were copying.
+   Stats stats;
+   U32 sequence;
+   do
+   {
+      sequence = dAtomicRead( mStatsSequence );
+      stats = mPublishedStats;
+      dMemoryBarrier();
+   }
+   while ( (sequence & 1) != 0 || sequence != mStatsSequence );
+
+   stats.mCommandsDropped = mCommandsDropped;
+
+   return stats;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::resetStats( void )
+{
+   mCommandsDropped = 0;
+
+   // The mixer thread owns its counters so have it reset them.
+   if ( mThread != NULL )
+   {
+      Command command;
+      command.mType = CommandResetStats;
+      command.mHandle = 0;
+      pushCommand( command );
+      return;
+   }
+
+   dMemset( &mMixerStats, 0, sizeof(mMixerStats) );
+   publishStats();
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::publishStats( void )
+{
+   dAtomicWrite( mStatsSequence, mStatsSequence + 1 );
+   dMemoryBarrier();
+
+   mPublishedStats = mMixerStats;
+
+   dAtomicWrite( mStatsSequence, mStatsSequence + 1 );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::processCommands( void )
+{
+   Command command;
+   while ( mCommands.pop( command ) )
+   {
+      switch( command.mType )
+      {
+      case CommandPlay:
+         startVoice( command );
+         break;
+
+      case CommandStopAll:
+         while ( mVoices.size() > 0 )
+            retireVoice( mVoices.size() - 1 );
+         break;
+
+      case CommandMasterVolume:
+         mMasterVolume = command.mValue;
+         break;
+
+      case CommandResetStats:
+         dMemset( &mMixerStats, 0, sizeof(mMixerStats) );
+         break;
+
+      default:
+         for ( U32 index = 0; index < (U32)mVoices.size(); ++index )
+         {
+            Voice& voice = mVoices[index];
+
+            if ( voice.mHandle != command.mHandle )
+               continue;
+
+            if ( command.mType == CommandStop )
+               retireVoice( index );
+            else if ( command.mType == CommandVolume )
+               voice.mVolume = command.mValue;
+            else if ( command.mType == CommandPitch )
+               voice.mPitch = command.mValue;
+
+            break;
+         }
+         break;
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::startVoice( const Command& command )
+{
+   Voice voice;
+   voice.mHandle = command.mHandle;
+   voice.mSample = command.mSample;
+   voice.mPosition = 0.0;
+   voice.mVolume = command.mValue;
+   voice.mPitch = command.mPitch;
+   voice.mLooping = command.mLooping;
+
+   // Don't start voices that cannot be heard.
+   if ( voice.mVolume * mMasterVolume < MIXER_MIN_GAIN )
+   {
+      mMixerStats.mVoicesRejected++;
+      mVoices.push_back( voice );
+      retireVoice( mVoices.size() - 1 );
+      return;
+   }
+
+   // Cull the quietest voice if we're out of voices and the new one is louder.
+   if ( mVoices.size() >= mMaxVoices )
+   {
+      U32 quietestIndex = 0;
+      for ( U32 index = 1; index < (U32)mVoices.size(); ++index )
+      {
+         if ( mVoices[index].mVolume < mVoices[quietestIndex].mVolume )
+            quietestIndex = index;
+      }
+
+      // Reject the new voice if it is no louder.
+      if ( mVoices[quietestIndex].mVolume >= voice.mVolume )
+      {
+         mMixerStats.mVoicesRejected++;
+         mVoices.push_back( voice );
+         retireVoice( mVoices.size() - 1 );
+         return;
+      }
+
+      mMixerStats.mVoicesCulled++;
+      retireVoice( quietestIndex );
+   }
+
+   mMixerStats.mVoicesStarted++;
+   mVoices.push_back( voice );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::retireVoice( const U32 index )
+{
+   RetiredVoice retired;
+   retired.mHandle = mVoices[index].mHandle;
+   retired.mSample = mVoices[index].mSample;
+
+   // Hold on to the voice if the main thread hasn't caught up yet.
+   if ( mPendingRetired.size() > 0 || !mRetired.push( retired ) )
+      mPendingRetired.push_back( retired );
+
+   mVoices.erase_fast( index );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::flushRetired( void )
+{
+   while ( mPendingRetired.size() > 0 && mRetired.push( mPendingRetired.front() ) )
+      mPendingRetired.pop_front();
+}
+
+//-----------------------------------------------------------------------------
+
+U32 AudioMixer::resampleVoice( Voice& voice, const U32 frameCount )
+{
+   const AudioMixerSample* pSample = voice.mSample;
+   const F32* pData = pSample->getData();
+   const U32 sampleFrames = pSample->getFrameCount();
+   const bool stereo = pSample->getChannels() == 2;
+   const F64 step = ( F64(pSample->getSampleRate()) / F64(mSampleRate) ) * voice.mPitch;
+
+   F64 position = voice.mPosition;
+   F32* pOutput = mScratch;
+
+   U32 frame = 0;
+   for ( ; frame < frameCount; ++frame )
+   {
+      if ( position >= sampleFrames )
+      {
+         if ( !voice.mLooping )
+            break;
+
+         while ( position >= sampleFrames )
+            position -= sampleFrames;
+      }
+
+      // Linear interpolation between adjacent frames.
+      const U32 frame0 = U32(position);
+      const F32 fraction = F32(position - frame0);
+      U32 frame1 = frame0 + 1;
+      if ( frame1 >= sampleFrames )
+         frame1 = voice.mLooping ? 0 : frame0;
+
+      if ( stereo )
+      {
+         const F32* p0 = pData + (frame0 * 2);
+         const F32* p1 = pData + (frame1 * 2);
+         pOutput[0] = p0[0] + (p1[0] - p0[0]) * fraction;
+         pOutput[1] = p0[1] + (p1[1] - p0[1]) * fraction;
+      }
+      else
+      {
+         const F32 value = pData[frame0] + (pData[frame1] - pData[frame0]) * fraction;
+         pOutput[0] = value;
+         pOutput[1] = value;
+      }
+
+      pOutput += 2;
+      position += step;
+   }
+
+   voice.mPosition = position;
+
+   return frame;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::mixAccumulate( F32* pOutput, const F32* pSource, const F32 gain, const U32 frameCount )
+{
+   const U32 sampleCount = frameCount * OutputChannels;
+   U32 index = 0;
+
+#ifdef TORQUE_AUDIO_MIXER_SSE
+   const __m128 gainVector = _mm_set1_ps( gain );
+   for ( ; index + 4 <= sampleCount; index += 4 )
+   {
+      const __m128 source = _mm_load_ps( pSource + index );
+      const __m128 output = _mm_load_ps( pOutput + index );
+      _mm_store_ps( pOutput + index, _mm_add_ps( output, _mm_mul_ps( source, gainVector ) ) );
+   }
+#endif
+
+   for ( ; index < sampleCount; ++index )
+      pOutput[index] += pSource[index] * gain;
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::clampOutput( F32* pOutput, const U32 frameCount )
+{
+   const U32 sampleCount = frameCount * OutputChannels;
+   U32 index = 0;
+
+#ifdef TORQUE_AUDIO_MIXER_SSE
+   const __m128 minVector = _mm_set1_ps( -1.0f );
+   const __m128 maxVector = _mm_set1_ps( 1.0f );
+   for ( ; index + 4 <= sampleCount; index += 4 )
+   {
+      const __m128 output = _mm_load_ps( pOutput + index );
+      _mm_store_ps( pOutput + index, _mm_max_ps( minVector, _mm_min_ps( output, maxVector ) ) );
+   }
+#endif
+
+   for ( ; index < sampleCount; ++index )
+      pOutput[index] = mClampF( pOutput[index], -1.0f, 1.0f );
+}
+
+//-----------------------------------------------------------------------------
+
+void AudioMixer::mixBlock( const U32 frameCount )
+{
+   AssertFatal( frameCount <= mBlockFrames, "AudioMixer::mixBlock() - Frame count exceeds block size." );
+
+   const U32 startTime = Platform::getRealMilliseconds();
+
+   flushRetired();
+   processCommands();
+
+   dMemset( mOutput, 0, frameCount * OutputChannels * sizeof(F32) );
+
+   mMixerStats.mActiveVoices = mVoices.size();
+
+   // Iterate backwards as finished voices are removed as we go.
+   for ( S32 index = mVoices.size() - 1; index >= 0; --index )
+   {
+      Voice& voice = mVoices[index];
+
+      const U32 framesRendered = resampleVoice( voice, frameCount );
+      const F32 gain = voice.mVolume * mMasterVolume;
+
+      if ( framesRendered > 0 && gain > 0.0f )
+         mixAccumulate( mOutput, mScratch, gain, framesRendered );
+
+      if ( framesRendered < frameCount )
+         retireVoice( index );
+   }
+
+   clampOutput( mOutput, frameCount );
+
+   mSink->write( mOutput, frameCount );
+
+   mMixerStats.mBlocksMixed++;
+   mMixerStats.mFramesMixed += frameCount;
+   mMixerStats.mMixTime += Platform::getRealMilliseconds() - startTime;
+
+   publishStats();
+}
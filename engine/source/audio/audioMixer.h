@@ -0,0 +1,297 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _AUDIO_MIXER_H_
+#define _AUDIO_MIXER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_THREAD_H_
+#include "platform/threads/thread.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_LOCKFREEQUEUE_H_
+#include "platform/threads/lockFreeQueue.h"
+#endif
+
+#ifndef _FILE_STREAM_H
+#include "io/fileStream.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// Immutable, reference-counted 32-bit float PCM data that the mixer plays from.
+/// Samples are shared between all voices playing them and are only released on the main thread.
+class AudioMixerSample
+{
+private:
+   F32*           mData;
+   U32            mFrameCount;
+   U32            mChannels;
+   U32            mSampleRate;
+   volatile S32   mRefCount;
+
+   AudioMixerSample( F32* pData, const U32 frameCount, const U32 channels, const U32 sampleRate );
+   ~AudioMixerSample();
+
+public:
+   /// Convert 8-bit unsigned or 16-bit signed interleaved PCM into a new sample.
+   /// The returned sample has a single reference owned by the caller.
+   static AudioMixerSample* createFromPCM( const void* pData, const U32 dataSize, const U32 bitsPerSample, const U32 channels, const U32 sampleRate );
+
+   void acquire( void );
+   void release( void );
+
+   inline const F32* getData( void ) const { return mData; }
+   inline U32 getFrameCount( void ) const { return mFrameCount; }
+   inline U32 getChannels( void ) const { return mChannels; }
+   inline U32 getSampleRate( void ) const { return mSampleRate; }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Destination for mixed output.  Output is always interleaved stereo 32-bit float.
+class AudioMixerSink
+{
+public:
+   virtual ~AudioMixerSink() {}
+
+   virtual bool open( const U32 sampleRate ) = 0;
+   virtual void write( const F32* pFrames, const U32 frameCount ) = 0;
+   virtual void close( void ) = 0;
+
+   /// Whether the mixer thread should pace itself against the wall clock.
+   /// Non real-time sinks are fed as fast as the mixer can produce output.
+   virtual bool isRealTime( void ) const = 0;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Sink that discards output, used for headless runs and benchmarking.
+class AudioMixerNullSink : public AudioMixerSink
+{
+private:
+   bool mRealTime;
+   U64  mFramesWritten;
+
+public:
+   AudioMixerNullSink( const bool realTime ) : mRealTime( realTime ), mFramesWritten( 0 ) {}
+
+   virtual bool open( const U32 sampleRate ) { mFramesWritten = 0; return true; }
+   virtual void write( const F32* pFrames, const U32 frameCount ) { mFramesWritten += frameCount; }
+   virtual void close( void ) {}
+   virtual bool isRealTime( void ) const { return mRealTime; }
+
+   inline U64 getFramesWritten( void ) const { return mFramesWritten; }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Sink that writes 16-bit stereo WAV files.
+class AudioMixerFileSink : public AudioMixerSink
+{
+private:
+   StringTableEntry  mFilename;
+   FileStream        mStream;
+   U32               mSampleRate;
+   U32               mDataSize;
+   bool              mOpen;
+
+   void writeHeader( void );
+
+public:
+   AudioMixerFileSink( const char* pFilename );
+   virtual ~AudioMixerFileSink();
+
+   virtual bool open( const U32 sampleRate );
+   virtual void write( const F32* pFrames, const U32 frameCount );
+   virtual void close( void );
+   virtual bool isRealTime( void ) const { return false; }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Software mixer that renders any number of voices into an AudioMixerSink.
+///
+/// Voices are controlled from the main thread via a lock-free command queue and
+/// are mixed either synchronously with render() or on a dedicated mixer thread.
+/// Finished or culled voices are handed back through a second queue so that
+/// their samples are always released on the main thread in update().
+class AudioMixer
+{
+public:
+   typedef U32 VoiceHandle;
+
+   enum Constants
+   {
+      OutputChannels       = 2,
+      DefaultMaxVoices     = 32,
+      DefaultBlockFrames   = 512,
+      CommandQueueSize     = 1024,
+   };
+
+   /// Mixer statistics.  Everything but mCommandsDropped is counted by the
+   /// thread doing the mixing and published once per block.
+   struct Stats
+   {
+      U32   mActiveVoices;       ///< Voices mixed in the last block.
+      U32   mVoicesStarted;      ///< Voices that were given a mixer slot.
+      U32   mVoicesCulled;       ///< Playing voices stopped to make room for a louder one.
+      U32   mVoicesRejected;     ///< Voices never started because they were inaudible or no louder than any playing voice.
+      U32   mCommandsDropped;    ///< Commands lost because the command queue was full.
+      U32   mBlocksMixed;
+      U64   mFramesMixed;
+      U32   mMixTime;            ///< Total milliseconds spent mixing.
+   };
+
+private:
+   enum CommandType
+   {
+      CommandPlay,
+      CommandStop,
+      CommandStopAll,
+      CommandVolume,
+      CommandPitch,
+      CommandMasterVolume,
+      CommandResetStats,
+   };
+
+   struct Command
+   {
+      CommandType          mType;
+      VoiceHandle          mHandle;
+      AudioMixerSample*    mSample;
+      F32                  mValue;
+      F32                  mPitch;
+      bool                 mLooping;
+   };
+
+   struct Voice
+   {
+      VoiceHandle          mHandle;
+      AudioMixerSample*    mSample;
+      F64                  mPosition;
+      F32                  mVolume;
+      F32                  mPitch;
+      bool                 mLooping;
+   };
+
+   struct RetiredVoice
+   {
+      VoiceHandle          mHandle;
+      AudioMixerSample*    mSample;
+   };
+
+   class MixerThread : public Thread
+   {
+      AudioMixer* mMixer;
+
+   public:
+      MixerThread( AudioMixer* pMixer ) : Thread( 0, NULL, false ), mMixer( pMixer ) {}
+      virtual void run( void* arg = 0 );
+   };
+
+   U32                                 mSampleRate;
+   U32                                 mMaxVoices;
+   U32                                 mBlockFrames;
+
+   // Main thread state.
+   VoiceHandle                         mLastHandle;
+   Vector<VoiceHandle>                 mLiveHandles;
+   AudioMixerSink*                     mSink;
+   MixerThread*                        mThread;
+
+   // Mixer state.
+   Vector<Voice>                       mVoices;
+   Vector<RetiredVoice>                mPendingRetired;
+   F32                                 mMasterVolume;
+   F32*                                mOutput;
+   F32*                                mScratch;
+   void*                               mBufferMemory;
+   Stats                               mMixerStats;
+
+   // Statistics published for the main thread.
+   Stats                               mPublishedStats;
+   volatile U32                        mStatsSequence;      ///< Odd whilst mPublishedStats is being written.
+   U32                                 mCommandsDropped;    ///< Main thread only.
+
+   LockFreeSPSCQueue<Command>          mCommands;
+   LockFreeSPSCQueue<RetiredVoice>     mRetired;
+
+   bool pushCommand( const Command& command );
+   void processCommands( void );
+   void startVoice( const Command& command );
+   void retireVoice( const U32 index );
+   void flushRetired( void );
+   U32 resampleVoice( Voice& voice, const U32 frameCount );
+   void mixBlock( const U32 frameCount );
+   void publishStats( void );
+
+   static void mixAccumulate( F32* pOutput, const F32* pSource, const F32 gain, const U32 frameCount );
+   static void clampOutput( F32* pOutput, const U32 frameCount );
+
+public:
+   AudioMixer( const U32 sampleRate, const U32 maxVoices = DefaultMaxVoices, const U32 blockFrames = DefaultBlockFrames );
+   ~AudioMixer();
+
+   /// Start mixing into the sink.  The mixer does not take ownership of the sink.
+   /// @param threaded Whether to mix on a dedicated thread or only when render() is called.
+   bool start( AudioMixerSink* pSink, const bool threaded );
+   void stop( void );
+   inline bool isStarted( void ) const { return mSink != NULL; }
+   inline bool isThreaded( void ) const { return mThread != NULL; }
+
+   /// Main thread: control voices.  Negative pitches are clamped to zero.
+   VoiceHandle play( AudioMixerSample* pSample, const F32 volume, const F32 pitch, const bool looping );
+   void stopVoice( const VoiceHandle handle );
+   void stopAll( void );
+   void setVolume( const VoiceHandle handle, const F32 volume );
+   void setPitch( const VoiceHandle handle, const F32 pitch );
+   void setMasterVolume( const F32 volume );
+   bool isPlaying( const VoiceHandle handle ) const;
+   inline U32 getLiveVoiceCount( void ) const { return mLiveHandles.size(); }
+
+   /// Main thread: release samples of voices that finished playing.
+   void update( void );
+
+   /// Synchronously mix the specified number of frames.  Only valid when not threaded.
+   void render( const U32 frameCount );
+
+   inline U32 getSampleRate( void ) const { return mSampleRate; }
+
+   /// Main thread: get a consistent copy of the statistics, even whilst the mixer thread is running.
+   Stats getStats( void ) const;
+   void resetStats( void );
+};
+
+//-----------------------------------------------------------------------------
+
+extern AudioMixer* gAudioMixer;
+
+#endif // _AUDIO_MIXER_H_
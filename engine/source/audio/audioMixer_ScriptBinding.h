@@ -0,0 +1,243 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+extern F32 mAudioChannelVolumes[Audio::AudioVolumeChannels];
+
+static AudioMixerSink* sAudioMixerSink = NULL;
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunctionGroupBegin( AudioMixer, "Functions dealing with the software audio mixer.");
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerStart, bool, 2, 6, "(sink, [fileName], [threaded], [sampleRate], [maxVoices]) - Start the software audio mixer.\n"
+                                            "@param sink Either 'null' (real-time, discards output), 'nullFast' (discards output as fast as possible) or 'file' (writes a WAV file).\n"
+                                            "@param fileName The WAV file to write when using the 'file' sink.\n"
+                                            "@param threaded Whether to mix on a dedicated thread (default) or only when alxMixerRender() is called.\n"
+                                            "@param sampleRate The output sample rate.  Defaults to 44100.\n"
+                                            "@param maxVoices The maximum number of concurrent voices before culling.\n"
+                                            "@return Whether the mixer was started or not." )
+{
+    // Stop any existing mixer.
+    SAFE_DELETE( gAudioMixer );
+    SAFE_DELETE( sAudioMixerSink );
+
+    // Create the sink.
+    const char* pSinkName = argv[1];
+    if ( dStricmp( pSinkName, "null" ) == 0 )
+    {
+        sAudioMixerSink = new AudioMixerNullSink( true );
+    }
+    else if ( dStricmp( pSinkName, "nullFast" ) == 0 )
+    {
+        sAudioMixerSink = new AudioMixerNullSink( false );
+    }
+    else if ( dStricmp( pSinkName, "file" ) == 0 )
+    {
+        if ( argc < 3 || *argv[2] == 0 )
+        {
+            Con::warnf( "alxMixerStart() - A file name is required for the 'file' sink." );
+            return false;
+        }
+
+        sAudioMixerSink = new AudioMixerFileSink( argv[2] );
+    }
+    else
+    {
+        Con::warnf( "alxMixerStart() - Unknown sink '%s'.", pSinkName );
+        return false;
+    }
+
+    const bool threaded = argc > 3 ? dAtob( argv[3] ) : true;
+    const U32 sampleRate = argc > 4 ? dAtoi( argv[4] ) : DEFAULT_SOUND_OUTPUT_RATE;
+    const U32 maxVoices = argc > 5 ? dAtoi( argv[5] ) : AudioMixer::DefaultMaxVoices;
+
+    gAudioMixer = new AudioMixer( getMax( sampleRate, (U32)8000 ), getMax( maxVoices, (U32)1 ) );
+
+    if ( !gAudioMixer->start( sAudioMixerSink, threaded ) )
+    {
+        SAFE_DELETE( gAudioMixer );
+        SAFE_DELETE( sAudioMixerSink );
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerStop, void, 1, 1, "() - Stop the software audio mixer.\n"
+                                            "@return No return value." )
+{
+    SAFE_DELETE( gAudioMixer );
+    SAFE_DELETE( sAudioMixerSink );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerPlay, S32, 2, 4,   "(audio-assetId, [volume], [pitch]) - Play the audio asset Id on the software mixer.\n"
+                                            "@param audio-assetId The asset Id to play.\n"
+                                            "@param volume The volume to play at.  Defaults to the asset volume.\n"
+                                            "@param pitch The pitch to play at.  Defaults to 1.\n"
+                                            "@return The mixer voice handle or 0 on error." )
+{
+    if ( gAudioMixer == NULL )
+    {
+        Con::warnf( "alxMixerPlay() - The mixer has not been started." );
+        return 0;
+    }
+
+    // Fetch asset Id.
+    const char* pAssetId = argv[1];
+
+    // Acquire audio asset.
+    AudioAsset* pAudioAsset = AssetDatabase.acquireAsset<AudioAsset>( pAssetId );
+
+    // Did we get the audio asset?
+    if ( pAudioAsset == NULL )
+    {
+        // No, so warn.
+        Con::warnf( "alxMixerPlay() - Could not find audio asset '%s'.", pAssetId );
+        return 0;
+    }
+
+    AudioMixer::VoiceHandle handle = 0;
+
+    Resource<AudioBuffer> buffer = AudioBuffer::find( pAudioAsset->getAudioFile() );
+    AudioMixerSample* pSample = bool(buffer) ? buffer->getMixerSample() : NULL;
+
+    if ( pSample != NULL )
+    {
+        const Audio::Description& description = pAudioAsset->getAudioDescription();
+
+        F32 volume = argc > 2 ? dAtof( argv[2] ) : description.mVolume;
+        if ( description.mVolumeChannel >= 0 && description.mVolumeChannel < Audio::AudioVolumeChannels )
+            volume *= mAudioChannelVolumes[description.mVolumeChannel];
+
+        const F32 pitch = argc > 3 ? dAtof( argv[3] ) : 1.0f;
+
+        handle = gAudioMixer->play( pSample, volume, pitch, description.mIsLooping );
+    }
+    else
+    {
+        Con::warnf( "alxMixerPlay() - Could not load the audio file for asset '%s'.", pAssetId );
+    }
+
+    // Release asset.
+    AssetDatabase.releaseAsset( pAssetId );
+
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerStopVoice, void, 2, 2, "(handle) - Stop a voice playing on the software mixer.\n"
+                                                "@param handle The voice handle returned by alxMixerPlay().\n"
+                                                "@return No return value." )
+{
+    if ( gAudioMixer != NULL )
+        gAudioMixer->stopVoice( dAtoi( argv[1] ) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerStopAll, void, 1, 1,   "() - Stop all voices playing on the software mixer.\n"
+                                                "@return No return value." )
+{
+    if ( gAudioMixer != NULL )
+        gAudioMixer->stopAll();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerIsPlaying, bool, 2, 2, "(handle) - Check whether a voice is still playing on the software mixer.\n"
+                                                "@param handle The voice handle returned by alxMixerPlay().\n"
+                                                "@return Whether the voice is playing or not." )
+{
+    return gAudioMixer != NULL && gAudioMixer->isPlaying( dAtoi( argv[1] ) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerSetMasterVolume, void, 2, 2,   "(volume) - Set the master volume of the software mixer.\n"
+                                                        "@param volume The master volume in the range [0, 1].\n"
+                                                        "@return No return value." )
+{
+    if ( gAudioMixer != NULL )
+        gAudioMixer->setMasterVolume( mClampF( dAtof( argv[1] ), 0.0f, 1.0f ) );
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerRender, void, 2, 2,    "(frames) - Synchronously mix the specified number of frames.  Only valid when the mixer is not threaded.\n"
+                                                "@param frames The number of frames to mix.\n"
+                                                "@return No return value." )
+{
+    if ( gAudioMixer == NULL || gAudioMixer->isThreaded() )
+    {
+        Con::warnf( "alxMixerRender() - The mixer must be started without a thread." );
+        return;
+    }
+
+    gAudioMixer->render( dAtoi( argv[1] ) );
+    gAudioMixer->update();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerGetStats, const char*, 1, 1,   "() - Get the software mixer statistics.\n"
+                                                        "@return 'activeVoices liveVoices started culled rejected droppedCommands blocks frames mixTimeMs'." )
+{
+    if ( gAudioMixer == NULL )
+        return StringTable->EmptyString;
+
+    const AudioMixer::Stats stats = gAudioMixer->getStats();
+
+    char* pBuffer = Con::getReturnBuffer( 128 );
+    dSprintf( pBuffer, 128, "%d %d %d %d %d %d %d %d %d",
+        stats.mActiveVoices,
+        gAudioMixer->getLiveVoiceCount(),
+        stats.mVoicesStarted,
+        stats.mVoicesCulled,
+        stats.mVoicesRejected,
+        stats.mCommandsDropped,
+        stats.mBlocksMixed,
+        U32(stats.mFramesMixed),
+        stats.mMixTime );
+
+    return pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( alxMixerResetStats, void, 1, 1,    "() - Reset the software mixer statistics.\n"
+                                                    "@return No return value." )
+{
+    if ( gAudioMixer != NULL )
+        gAudioMixer->resetStats();
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunctionGroupEnd( AudioMixer );
@@ -58,6 +58,8 @@ class AudioStreamSource
         virtual void freeStream() = 0;
       virtual F32 getElapsedTime() = 0;
       virtual F32 getTotalTime() = 0;
+        virtual U32 getMemoryUsage() { return 0; }
+        virtual F32 getDecodeTime() { return 0.f; }
         //void clear();
 
         AUDIOHANDLE             mHandle;
@@ -30,12 +30,18 @@
 #include "audio/audioStreamSourceFactory.h"
 
 #include "audio/wavStreamSource.h"
+#include "audio/adpcmStreamSource.h"
 
 AudioStreamSource* AudioStreamSourceFactory::getNewInstance(const char *filename)
 {
 	S32 len = dStrlen(filename);
 	if(len > 3 && !dStricmp(filename + len - 4, ".wav"))
+	{
+		if(AdpcmStreamSource::isAdpcmFile(filename))
+			return new AdpcmStreamSource(filename);
+
 		return new WavStreamSource(filename);
+	}
 	
 	return NULL;
 }
@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "audio/imaAdpcm.h"
+
+#ifndef _PLATFORMENDIAN_H_
+#include "platform/platformEndian.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+static const S32 sImaStepTable[89] =
+{
+   7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+   19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+   50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+   130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+   337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+   876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+   2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+   5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+   15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const S32 sImaIndexTable[16] =
+{
+   -1, -1, -1, -1, 2, 4, 6, 8,
+   -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+//-----------------------------------------------------------------------------
+
+struct ImaChannelState
+{
+   S32 mPredictor;
+   S32 mStepIndex;
+
+   inline S16 decodeNibble( const U8 nibble )
+   {
+      const S32 step = sImaStepTable[mStepIndex];
+
+      S32 difference = step >> 3;
+      if ( nibble & 4 ) difference += step;
+      if ( nibble & 2 ) difference += step >> 1;
+      if ( nibble & 1 ) difference += step >> 2;
+
+      mPredictor += ( nibble & 8 ) ? -difference : difference;
+
+      if ( mPredictor > 32767 )
+         mPredictor = 32767;
+      else if ( mPredictor < -32768 )
+         mPredictor = -32768;
+
+      mStepIndex += sImaIndexTable[nibble];
+
+      if ( mStepIndex < 0 )
+         mStepIndex = 0;
+      else if ( mStepIndex > 88 )
+         mStepIndex = 88;
+
+      return (S16)mPredictor;
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+U32 ImaAdpcm::getFramesPerBlock( const U32 blockSize, const U32 channels )
+{
+   // Each channel has a 4-byte header holding the first sample.
+   const U32 headerSize = 4 * channels;
+
+   if ( channels == 0 || blockSize < headerSize )
+      return 0;
+
+   // Channel data is interleaved in 4-byte (8 sample) groups.
+   const U32 groups = (blockSize - headerSize) / headerSize;
+   return 1 + (groups * 8);
+}
+
+//-----------------------------------------------------------------------------
+
+U32 ImaAdpcm::decodeBlock( const U8* pBlock, const U32 blockSize, const U32 channels, S16* pOutput )
+{
+   const U32 frameCount = getFramesPerBlock( blockSize, channels );
+   if ( frameCount == 0 || channels > 2 )
+      return 0;
+
+   ImaChannelState state[2];
+
+   // Read the channel headers.
+   for ( U32 channel = 0; channel < channels; ++channel )
+   {
+      const U8* pHeader = pBlock + (channel * 4);
+      state[channel].mPredictor = (S16)( pHeader[0] | (pHeader[1] << 8) );
+      state[channel].mStepIndex = pHeader[2] > 88 ? 88 : pHeader[2];
+      pOutput[channel] = (S16)state[channel].mPredictor;
+   }
+
+   const U8* pData = pBlock + (channels * 4);
+   const U32 groups = (frameCount - 1) / 8;
+
+   for ( U32 group = 0; group < groups; ++group )
+   {
+      for ( U32 channel = 0; channel < channels; ++channel )
+      {
+         S16* pSamples = pOutput + ((1 + (group * 8)) * channels) + channel;
+
+         for ( U32 byte = 0; byte < 4; ++byte )
+         {
+            const U8 value = *pData++;
+            pSamples[0]        = state[channel].decodeNibble( value & 0x0F );
+            pSamples[channels] = state[channel].decodeNibble( value >> 4 );
+            pSamples += channels * 2;
+         }
+      }
+   }
+
+   return frameCount;
+}
@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _IMA_ADPCM_H_
+#define _IMA_ADPCM_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// Decoder for IMA ADPCM (WAVE format 0x0011) audio.
+///
+/// IMA ADPCM stores 4-bit deltas in self-contained blocks, compressing 16-bit
+/// PCM roughly 4:1 whilst remaining cheap enough to decode on the fly.
+namespace ImaAdpcm
+{
+   enum Constants
+   {
+      WaveFormatTag = 0x0011,
+   };
+
+   /// Get the number of sample frames stored in a block of the specified size.
+   U32 getFramesPerBlock( const U32 blockSize, const U32 channels );
+
+   /// Decode a single block into interleaved 16-bit PCM.
+   /// The block may be shorter than the nominal block size at the end of the data.
+   /// @return The number of sample frames written.
+   U32 decodeBlock( const U8* pBlock, const U32 blockSize, const U32 channels, S16* pOutput );
+}
+
+#endif // _IMA_ADPCM_H_
@@ -350,3 +350,9 @@ F32 WavStreamSource::getTotalTime()
    Con::warnf( "GetTotalTime not implemented in WaveStreams yet" );
    return -1.f;
 }
+
+U32 WavStreamSource::getMemoryUsage()
+{
+   // Each allocated OpenAL buffer holds up to one read of PCM data.
+   return bBuffersAllocated ? NUMBUFFERS * BUFFERSIZE : 0;
+}
@@ -38,6 +38,7 @@ class WavStreamSource: public AudioStreamSource
         virtual void freeStream();
       virtual F32 getElapsedTime();
       virtual F32 getTotalTime();
+        virtual U32 getMemoryUsage();
 
     private:
         ALuint				    mBufferList[NUMBUFFERS];
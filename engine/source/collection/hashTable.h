@@ -39,6 +39,17 @@ namespace Hash
       return data;
    }
 
+   inline U32 hash(S32 data)
+   {
+      return U32(data);
+   }
+
+   inline U32 hash(U64 data)
+   {
+      // Spread the high half so keys packed from two values don't cancel out.
+      return U32(data) ^ (U32(data >> 32) * 0x9E3779B1);
+   }
+
    inline U32 hash(const void *data)
    {
       return (U32)data;
@@ -52,7 +52,9 @@
 
 BehaviorComponent::BehaviorComponent() :
     mMasterBehaviorId( 1 ),
-    mpBehaviorFieldNames( NULL )
+    mpBehaviorFieldNames( NULL ),
+    mBehaviorRouteSequence( 0 ),
+    mBehaviorRouteGeneration( 0 )
 {
     SIMSET_SET_ASSOCIATION( mBehaviors );
 }
@@ -192,6 +194,9 @@ bool BehaviorComponent::addBehavior( BehaviorInstance* bi )
     // Store behavior.
     mBehaviors.pushObject( bi );
 
+    // Invalidate the method routes.
+    invalidateBehaviorRoutes();
+
     // Notify if the behavior instance is destroyed.
     deleteNotify( bi );
 
@@ -217,6 +222,9 @@ bool BehaviorComponent::removeBehavior( BehaviorInstance *bi, bool deleteBehavio
         {
             mBehaviors.removeObject( *itr );
 
+            // Invalidate the method routes.
+            invalidateBehaviorRoutes();
+
             // Perform callback if allowed.
             if( bi->isProperlyAdded() && bi->isMethod("onBehaviorRemove") )
                 Con::executef( bi , 1, "onBehaviorRemove" );
@@ -281,7 +289,13 @@ bool BehaviorComponent::reOrder( BehaviorInstance *obj, U32 desiredIndex /* = 0
         return false;
 
     SimObject *target = mBehaviors.at( desiredIndex );
-    return mBehaviors.reOrder( obj, target );
+    if ( !mBehaviors.reOrder( obj, target ) )
+        return false;
+
+    // Invalidate the method routes.
+    invalidateBehaviorRoutes();
+
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -925,14 +939,11 @@ bool BehaviorComponent::handlesConsoleMethod( const char *fname, S32 *routingId
    if( dStricmp( fname, "delete" ) == 0 )
       return Parent::handlesConsoleMethod( fname, routingId );
 
-   for( SimSet::iterator nItr = mBehaviors.begin(); nItr != mBehaviors.end(); nItr++ )
+   // Is the method routed to any behavior?
+   if( !mBehaviors.empty() && findBehaviorRoutes( StringTable->insert( fname ) ) != NULL )
    {
-      SimObject *pComponent = dynamic_cast<SimObject *>(*nItr);
-      if( pComponent != NULL && pComponent->isMethod( fname ) )
-      {
-         *routingId = -2; // -2 denotes method on component
-         return true;
-      }
+      *routingId = -2; // -2 denotes method on component
+      return true;
    }
 
    // Let parent handle it
@@ -948,118 +959,152 @@ const char *BehaviorComponent::callOnBehaviors( U32 argc, const char *argv[] )
 {   
     if( mBehaviors.empty() )   
         return Parent::callOnBehaviors( argc, argv );
-      
-    // Copy the arguments to avoid weird clobbery situations.
-    FrameTemp<char *> argPtrs (argc);
-   
-    U32 strdupWatermark = FrameAllocator::getWaterMark();
-    for( U32 i = 0; i < argc; i++ )
+
+    // Fetch the behaviors that handle the method.
+    const typeBehaviorRouteVector* pRoutes = findBehaviorRoutes( StringTable->insert( argv[0] ) );
+
+    // If this isn't handled by a behavior then pass along to the parent DynamicConsoleMethodComponent
+    // to deal with it.  If the parent cannot handle the message it will return an error string.
+    if ( pRoutes == NULL )
+        return Parent::callOnBehaviors( argc, argv );
+
+    // Only the last behavior handling the method is called just as with components.
+    return executeBehaviorRoute( pRoutes->last(), argc, argv );
+}
+
+const char *BehaviorComponent::_callMethod( U32 argc, const char *argv[], bool callThis /* = true  */ )
+{   
+    if( mBehaviors.empty() )   
+        return Parent::_callMethod( argc, argv, callThis );
+
+    // Fetch the behaviors that handle the method.
+    const typeBehaviorRouteVector* pRoutes = findBehaviorRoutes( StringTable->insert( argv[0] ) );
+
+    if ( pRoutes != NULL )
     {
-        argPtrs[i] = reinterpret_cast<char *>( FrameAllocator::alloc( dStrlen( argv[i] ) + 1 ) );
-        dStrcpy( argPtrs[i], argv[i] );
+        // Take a copy of the routes as the behaviors may change whilst they're being called.
+        const U32 routeCount = (U32)pRoutes->size();
+        FrameTemp<BehaviorRoute> routes( routeCount );
+        dMemcpy( ~routes, pRoutes->address(), sizeof(BehaviorRoute) * routeCount );
+
+        // Fetch the route generation.
+        const U32 routeGeneration = mBehaviorRouteGeneration;
+
+        for( U32 index = 0; index < routeCount; ++index )
+        {
+            const BehaviorRoute& route = routes[index];
+
+            // Skip the behavior if it has been removed by a previous call.
+            if ( routeGeneration != mBehaviorRouteGeneration && !containsBehavior( route.mpBehavior ) )
+                continue;
+
+            executeBehaviorRoute( route, argc, argv );
+        }
     }
 
-    // Walk backwards through the list just as with components
-    const char* result = "";
-    bool handled = false;
-    for( SimSet::iterator i = (mBehaviors.end()-1); i >= mBehaviors.begin(); i-- )
+    // Pass this up to the parent since a BehaviorComponent is still a DynamicConsoleMethodComponent
+    // it needs to be able to contain other components and behave properly
+    return Parent::_callMethod( argc, argv, callThis );
+}
+
+//-----------------------------------------------------------------------------
+
+const BehaviorComponent::typeBehaviorRouteVector* BehaviorComponent::findBehaviorRoutes( StringTableEntry methodName )
+{
+    // Invalidate the method routes if any namespace has changed.
+    if ( mBehaviorRouteSequence != Namespace::mCacheSequence )
     {
-        BehaviorInstance *pBehavior = dynamic_cast<BehaviorInstance *>( *i );
-        AssertFatal( pBehavior, "BehaviorComponent::callOnBehaviors - Bad behavior instance in list." );
-        AssertFatal( pBehavior->getId() > 0, "Invalid id for behavior component" );
+        invalidateBehaviorRoutes();
+        mBehaviorRouteSequence = Namespace::mCacheSequence;
+    }
+
+    // Is the method already routed?
+    typeBehaviorRouteHash::iterator routeItr = mBehaviorRoutes.find( methodName );
+    if ( routeItr != mBehaviorRoutes.end() )
+        return routeItr->value;
+
+    // No, so find the behaviors that handle the method.
+    typeBehaviorRouteVector* pRoutes = NULL;
+    for( SimSet::iterator itr = mBehaviors.begin(); itr != mBehaviors.end(); ++itr )
+    {
+        BehaviorInstance *pBehavior = static_cast<BehaviorInstance *>( *itr );
 
         // Use the BehaviorInstance's namespace
         Namespace *pNamespace = pBehavior->getNamespace();
-        if(!pNamespace)
+        if( !pNamespace )
             continue;
 
-        // Lookup the Callback Namespace entry and then splice callback
-        const char *cbName = StringTable->insert(argv[0]);
-        Namespace::Entry *pNSEntry = pNamespace->lookup(cbName);
-        if( pNSEntry )
-        {
-            // Set %this to our BehaviorInstance's Object ID
-            argPtrs[1] = const_cast<char *>( pBehavior->getIdString() );
-
-            // Change the Current Console object, execute, restore Object
-            SimObject *save = gEvalState.thisObject;
-            gEvalState.thisObject = pBehavior;
+        // Lookup the namespace entry.
+        Namespace::Entry *pNSEntry = pNamespace->lookup( methodName );
+        if( !pNSEntry )
+            continue;
 
-            result = pNSEntry->execute(argc, const_cast<const char **>( ~argPtrs ), &gEvalState);
+        // Add the route.
+        if ( pRoutes == NULL )
+            pRoutes = new typeBehaviorRouteVector();
 
-            gEvalState.thisObject = save;
-            handled = true;
-            break;
-        }
+        BehaviorRoute route;
+        route.mpBehavior = pBehavior;
+        route.mpNamespaceEntry = pNSEntry;
+        pRoutes->push_back( route );
     }
 
-    // If this wasn't handled by a behavior above then pass along to the parent DynamicConsoleMethodComponent
-    // to deal with it.  If the parent cannot handle the message it will return an error string.
-    if (!handled)
+    // Store the routes.
+    mBehaviorRoutes.insert( methodName, pRoutes );
+
+    return pRoutes;
+}
+
+//-----------------------------------------------------------------------------
+
+void BehaviorComponent::invalidateBehaviorRoutes( void )
+{
+    // Delete the routes.
+    for( typeBehaviorRouteHash::iterator routeItr = mBehaviorRoutes.begin(); routeItr != mBehaviorRoutes.end(); ++routeItr )
     {
-        result = Parent::callOnBehaviors( argc, argv );
+        delete routeItr->value;
     }
 
-    // Clean up.
-    FrameAllocator::setWaterMark( strdupWatermark );
+    mBehaviorRoutes.clear();
 
-    return result;
+    // Bump the route generation.
+    mBehaviorRouteGeneration++;
 }
 
 //-----------------------------------------------------------------------------
 
-const char *BehaviorComponent::_callMethod( U32 argc, const char *argv[], bool callThis /* = true  */ )
-{   
-    if( mBehaviors.empty() )   
-        return Parent::_callMethod( argc, argv, callThis );
-     
-    // Copy the arguments to avoid weird clobbery situations.
-    FrameTemp<char *> argPtrs (argc);
-   
-    U32 strdupWatermark = FrameAllocator::getWaterMark();
-    for( U32 i = 0; i < argc; i++ )
+bool BehaviorComponent::containsBehavior( BehaviorInstance* pBehavior )
+{
+    for( SimSet::iterator itr = mBehaviors.begin(); itr != mBehaviors.end(); ++itr )
     {
-        argPtrs[i] = reinterpret_cast<char *>( FrameAllocator::alloc( dStrlen( argv[i] ) + 1 ) );
-        dStrcpy( argPtrs[i], argv[i] );
+        if ( *itr == pBehavior )
+            return true;
     }
 
-    for( SimSet::iterator i = mBehaviors.begin(); i != mBehaviors.end(); i++ )
-    {
-        BehaviorInstance *pBehavior = dynamic_cast<BehaviorInstance *>( *i );
-        AssertFatal( pBehavior, "BehaviorComponent::_callMethod - Bad behavior instance in list." );
-        AssertFatal( pBehavior->getId() > 0, "Invalid id for behavior component" );
-
-        // Use the BehaviorInstance's namespace
-        Namespace *pNamespace = pBehavior->getNamespace();
-        if(!pNamespace)
-            continue;
+    return false;
+}
 
-        // Lookup the Callback Namespace entry and then splice callback
-        const char *cbName = StringTable->insert(argv[0]);
-        Namespace::Entry *pNSEntry = pNamespace->lookup(cbName);
-        if( pNSEntry )
-        {
-            // Set %this to our BehaviorInstance's Object ID
-            argPtrs[1] = const_cast<char *>( pBehavior->getIdString() );
+//-----------------------------------------------------------------------------
 
-            // Change the Current Console object, execute, restore Object
-            SimObject *save = gEvalState.thisObject;
-            gEvalState.thisObject = pBehavior;
+const char* BehaviorComponent::executeBehaviorRoute( const BehaviorRoute& route, U32 argc, const char** argv )
+{
+    BehaviorInstance* pBehavior = route.mpBehavior;
+    AssertFatal( pBehavior->getId() > 0, "Invalid id for behavior component" );
 
-            pNSEntry->execute(argc, const_cast<const char **>( ~argPtrs ), &gEvalState);
+    // Pass the arguments through, setting %this to our BehaviorInstance's Object ID.
+    FrameTemp<const char *> argPtrs( argc );
+    dMemcpy( ~argPtrs, argv, sizeof(const char *) * argc );
+    argPtrs[1] = pBehavior->getIdString();
 
-            gEvalState.thisObject = save;
-        }
-    }
+    // Change the Current Console object, execute, restore Object
+    SimObject *save = gEvalState.thisObject;
+    gEvalState.thisObject = pBehavior;
 
-    // Pass this up to the parent since a BehaviorComponent is still a DynamicConsoleMethodComponent
-    // it needs to be able to contain other components and behave properly
-    const char* fnRet = Parent::_callMethod( argc, argv, callThis );
+    const char* result = route.mpNamespaceEntry->execute( argc, ~argPtrs, &gEvalState );
 
-    // Clean up.
-    FrameAllocator::setWaterMark( strdupWatermark );
+    gEvalState.thisObject = save;
 
-    return fnRet;
+    return result;
 }
 
 //-----------------------------------------------------------------------------
@@ -39,6 +39,17 @@ class BehaviorComponent : public DynamicConsoleMethodComponent
     typedef DynamicConsoleMethodComponent Parent;
 
 private:
+    /// A behavior that handles a routed method.
+    struct BehaviorRoute
+    {
+        BehaviorInstance*   mpBehavior;
+        Namespace::Entry*   mpNamespaceEntry;
+    };
+
+    /// Maps a method name to the behaviors that handle it in behavior order or NULL if no behavior handles it.
+    typedef Vector<BehaviorRoute> typeBehaviorRouteVector;
+    typedef HashMap<StringTableEntry, typeBehaviorRouteVector*> typeBehaviorRouteHash;
+
     /// Component Behaviors
     SimSet  mBehaviors;
 
@@ -47,6 +58,11 @@ private:
 
     Vector<StringTableEntry>* mpBehaviorFieldNames;
 
+    /// Method routing.
+    typeBehaviorRouteHash mBehaviorRoutes;
+    U32 mBehaviorRouteSequence;
+    U32 mBehaviorRouteGeneration;
+
 
 public:
     /// A behavior port connection.
@@ -87,11 +103,16 @@ protected:
 private:
     void destroyBehaviorOutputConnections( BehaviorInstance* pOutputBehavior );
     void destroyBehaviorInputConnections( BehaviorInstance* pInputBehavior );
+
+    const typeBehaviorRouteVector* findBehaviorRoutes( StringTableEntry methodName );
+    void invalidateBehaviorRoutes( void );
+    bool containsBehavior( BehaviorInstance* pBehavior );
+    const char* executeBehaviorRoute( const BehaviorRoute& route, U32 argc, const char** argv );
     
   
 public:
     BehaviorComponent();
-    virtual ~BehaviorComponent() {}
+    virtual ~BehaviorComponent() { invalidateBehaviorRoutes(); }
 
     /// SimObject overrides
     virtual bool onAdd();
@@ -121,6 +142,7 @@ public:
     /// DynamicConsoleMethodComponent Overrides
     virtual bool handlesConsoleMethod( const char *fname, S32 *routingId );
     virtual const char* callOnBehaviors( U32 argc, const char *argv[] );
+    inline U32 getBehaviorRouteCount( void ) const { return mBehaviorRoutes.size(); }
 
     /// SimComponent overrides
     virtual void write( Stream &stream, U32 tabStop, U32 flags = 0 );
@@ -104,6 +104,31 @@ struct ExprNode : StmtNode
    virtual U32 precompile(TypeReq type) = 0;
    virtual U32 compile(U32 *codeStream, U32 ip, TypeReq type) = 0;
    virtual TypeReq getPreferredType() = 0;
+
+   /// @name Constant Folding
+   ///
+   /// Evaluate the expression at compile time, producing exactly the value the VM
+   /// would leave on the float or int stack. Returns false if the expression is not
+   /// made up entirely of numeric literals.
+   /// @{
+
+   virtual bool foldFloat(F64 &value) { return false; }
+   virtual bool foldInt(S64 &value) { return false; }
+   /// @}
+};
+
+/// A constant an operator node has been folded to during precompile.
+struct FoldedConstant
+{
+   bool valid;
+   bool integer;
+   F64 floatValue;
+   S64 intValue;
+   U32 index;
+
+   /// Try to fold the node for the given type; allocates the table entry the value needs.
+   U32 precompile(ExprNode *node, bool isInteger, TypeReq type);
+   U32 compile(U32 *codeStream, U32 ip, TypeReq type);
 };
 
 struct ReturnStmtNode : StmtNode
@@ -158,10 +183,14 @@ struct BinaryExprNode : ExprNode
 
 struct FloatBinaryExprNode : BinaryExprNode
 {
+   FoldedConstant folded;
+
    static FloatBinaryExprNode *alloc(S32 op, ExprNode *left, ExprNode *right);
    U32 precompile(TypeReq type);
    U32 compile(U32 *codeStream, U32 ip, TypeReq type);
    TypeReq getPreferredType();
+   bool foldFloat(F64 &value);
+   bool foldInt(S64 &value);
 };
 
 struct ConditionalExprNode : ExprNode
@@ -180,6 +209,7 @@ struct IntBinaryExprNode : BinaryExprNode
 {
    TypeReq subType;
    U32 operand;
+   FoldedConstant folded;
 
    static IntBinaryExprNode *alloc(S32 op, ExprNode *left, ExprNode *right);
 
@@ -187,6 +217,8 @@ struct IntBinaryExprNode : BinaryExprNode
    U32 precompile(TypeReq type);
    U32 compile(U32 *codeStream, U32 ip, TypeReq type);
    TypeReq getPreferredType();
+   bool foldFloat(F64 &value);
+   bool foldInt(S64 &value);
 };
 
 struct StreqExprNode : BinaryExprNode
@@ -221,22 +253,28 @@ struct IntUnaryExprNode : ExprNode
    S32 op;
    ExprNode *expr;
    bool integer;
+   FoldedConstant folded;
 
    static IntUnaryExprNode *alloc(S32 op, ExprNode *expr);
    U32 precompile(TypeReq type);
    U32 compile(U32 *codeStream, U32 ip, TypeReq type);
    TypeReq getPreferredType();
+   bool foldFloat(F64 &value);
+   bool foldInt(S64 &value);
 };
 
 struct FloatUnaryExprNode : ExprNode
 {
    S32 op;
    ExprNode *expr;
+   FoldedConstant folded;
 
    static FloatUnaryExprNode *alloc(S32 op, ExprNode *expr);
    U32 precompile(TypeReq type);
    U32 compile(U32 *codeStream, U32 ip, TypeReq type);
    TypeReq getPreferredType();
+   bool foldFloat(F64 &value);
+   bool foldInt(S64 &value);
 };
 
 struct VarNode : ExprNode
@@ -259,6 +297,8 @@ struct IntNode : ExprNode
    U32 precompile(TypeReq type);
    U32 compile(U32 *codeStream, U32 ip, TypeReq type);
    TypeReq getPreferredType();
+   bool foldFloat(F64 &value);
+   bool foldInt(S64 &value);
 };
 
 struct FloatNode : ExprNode
@@ -270,6 +310,8 @@ struct FloatNode : ExprNode
    U32 precompile(TypeReq type);
    U32 compile(U32 *codeStream, U32 ip, TypeReq type);
    TypeReq getPreferredType();
+   bool foldFloat(F64 &value);
+   bool foldInt(S64 &value);
 };
 
 struct StrConstNode : ExprNode
@@ -174,6 +174,91 @@ static U32 conversionOp(TypeReq src, TypeReq dst)
    return OP_INVALID;
 }
 
+// OP_STR_TO_NONE does nothing unless it directly follows a call (OP_CALLFUNC
+// looks ahead for it), so other nodes can leave it out.
+static bool isConversionNeeded(TypeReq src, TypeReq dst)
+{
+   return src != dst && !(src == TypeReqString && dst == TypeReqNone);
+}
+
+//------------------------------------------------------------
+
+// Convert a float the way OP_FLT_TO_UINT does, failing where the cast is undefined.
+static bool foldFloatToInt(F64 value, S64 &result)
+{
+   if(!(value > -9223372036854775808.0 && value < 9223372036854775808.0))
+      return false;
+   result = (S64)value;
+   return true;
+}
+
+// OP_LOADIMMED_UINT zero-extends its operand, so only these values survive the trip.
+static bool isImmediateInt(S64 value)
+{
+   return value >= 0 && value <= S64(0xFFFFFFFF);
+}
+
+U32 FoldedConstant::precompile(ExprNode *node, bool isInteger, TypeReq type)
+{
+   valid = false;
+   integer = isInteger;
+   if(integer)
+   {
+      if(!node->foldInt(intValue))
+         return 0;
+      if(type == TypeReqUInt && !isImmediateInt(intValue))
+         return 0;
+   }
+   else
+   {
+      if(!node->foldFloat(floatValue))
+         return 0;
+      if(type == TypeReqUInt && (!foldFloatToInt(floatValue, intValue) || !isImmediateInt(intValue)))
+         return 0;
+   }
+   valid = true;
+
+   switch(type)
+   {
+   case TypeReqNone:
+      return 0;
+   case TypeReqFloat:
+      index = getCurrentFloatTable()->add(integer ? F64(intValue) : floatValue);
+      break;
+   case TypeReqString:
+      if(integer)
+         index = getCurrentStringTable()->addIntString(U32(intValue));
+      else
+         index = getCurrentStringTable()->addFloatString(floatValue);
+      break;
+   default:
+      break;
+   }
+   return 2;
+}
+
+U32 FoldedConstant::compile(U32 *codeStream, U32 ip, TypeReq type)
+{
+   switch(type)
+   {
+   case TypeReqUInt:
+      codeStream[ip++] = OP_LOADIMMED_UINT;
+      codeStream[ip++] = U32(intValue);
+      break;
+   case TypeReqFloat:
+      codeStream[ip++] = OP_LOADIMMED_FLT;
+      codeStream[ip++] = index;
+      break;
+   case TypeReqString:
+      codeStream[ip++] = OP_LOADIMMED_STR;
+      codeStream[ip++] = index;
+      break;
+   default:
+      break;
+   }
+   return ip;
+}
+
 //------------------------------------------------------------
 
 U32 BreakStmtNode::precompileStmt(U32 loopCount)
@@ -477,6 +562,10 @@ TypeReq ConditionalExprNode::getPreferredType()
 
 U32 FloatBinaryExprNode::precompile(TypeReq type)
 {
+   U32 foldedSize = folded.precompile(this, false, type);
+   if(folded.valid)
+      return foldedSize;
+
    U32 addSize = left->precompile(TypeReqFloat) + right->precompile(TypeReqFloat) + 1;
    if(type != TypeReqFloat)
       addSize++;
@@ -486,6 +575,9 @@ U32 FloatBinaryExprNode::precompile(TypeReq type)
 
 U32 FloatBinaryExprNode::compile(U32 *codeStream, U32 ip, TypeReq type)
 {
+   if(folded.valid)
+      return folded.compile(codeStream, ip, type);
+
    ip = right->compile(codeStream, ip, TypeReqFloat);
    ip = left->compile(codeStream, ip, TypeReqFloat);
    U32 operand = OP_INVALID;
@@ -515,6 +607,38 @@ TypeReq FloatBinaryExprNode::getPreferredType()
    return TypeReqFloat;
 }
 
+bool FloatBinaryExprNode::foldFloat(F64 &value)
+{
+   F64 leftValue, rightValue;
+   if(!left->foldFloat(leftValue) || !right->foldFloat(rightValue))
+      return false;
+
+   switch(op)
+   {
+   case '+':
+      value = leftValue + rightValue;
+      break;
+   case '-':
+      value = leftValue - rightValue;
+      break;
+   case '/':
+      value = leftValue / rightValue;
+      break;
+   case '*':
+      value = leftValue * rightValue;
+      break;
+   default:
+      return false;
+   }
+   return true;
+}
+
+bool FloatBinaryExprNode::foldInt(S64 &value)
+{
+   F64 floatValue;
+   return foldFloat(floatValue) && foldFloatToInt(floatValue, value);
+}
+
 //------------------------------------------------------------
 
 void IntBinaryExprNode::getSubTypeOperand()
@@ -575,6 +699,10 @@ void IntBinaryExprNode::getSubTypeOperand()
 
 U32 IntBinaryExprNode::precompile(TypeReq type)
 {
+   U32 foldedSize = folded.precompile(this, true, type);
+   if(folded.valid)
+      return foldedSize;
+
    getSubTypeOperand();
    U32 addSize = left->precompile(subType) + right->precompile(subType) + 1;
    if(operand == OP_OR || operand == OP_AND)
@@ -588,6 +716,9 @@ U32 IntBinaryExprNode::precompile(TypeReq type)
 
 U32 IntBinaryExprNode::compile(U32 *codeStream, U32 ip, TypeReq type)
 {
+   if(folded.valid)
+      return folded.compile(codeStream, ip, type);
+
    if(operand == OP_OR || operand == OP_AND)
    {
       ip = left->compile(codeStream, ip, subType);
@@ -612,6 +743,91 @@ TypeReq IntBinaryExprNode::getPreferredType()
    return TypeReqUInt;
 }
 
+bool IntBinaryExprNode::foldInt(S64 &value)
+{
+   getSubTypeOperand();
+   if(subType == TypeReqFloat)
+   {
+      F64 leftValue, rightValue;
+      if(!left->foldFloat(leftValue) || !right->foldFloat(rightValue))
+         return false;
+
+      switch(operand)
+      {
+      case OP_CMPEQ:
+         value = leftValue == rightValue;
+         break;
+      case OP_CMPGR:
+         value = leftValue > rightValue;
+         break;
+      case OP_CMPGE:
+         value = leftValue >= rightValue;
+         break;
+      case OP_CMPLT:
+         value = leftValue < rightValue;
+         break;
+      case OP_CMPLE:
+         value = leftValue <= rightValue;
+         break;
+      case OP_CMPNE:
+         value = leftValue != rightValue;
+         break;
+      default:
+         return false;
+      }
+      return true;
+   }
+
+   S64 leftValue, rightValue;
+   if(!left->foldInt(leftValue) || !right->foldInt(rightValue))
+      return false;
+
+   switch(operand)
+   {
+   case OP_XOR:
+      value = leftValue ^ rightValue;
+      break;
+   case OP_MOD:
+      value = rightValue != 0 ? leftValue % rightValue : 0;
+      break;
+   case OP_BITAND:
+      value = leftValue & rightValue;
+      break;
+   case OP_BITOR:
+      value = leftValue | rightValue;
+      break;
+   case OP_SHR:
+      if(rightValue < 0 || rightValue >= 64)
+         return false;
+      value = leftValue >> rightValue;
+      break;
+   case OP_SHL:
+      if(!isImmediateInt(leftValue) || rightValue < 0 || rightValue >= 32)
+         return false;
+      value = leftValue << rightValue;
+      break;
+   // The short circuit jumps leave the deciding operand on the stack.
+   case OP_OR:
+      value = leftValue ? leftValue : rightValue;
+      break;
+   case OP_AND:
+      value = leftValue ? rightValue : leftValue;
+      break;
+   default:
+      return false;
+   }
+   return true;
+}
+
+bool IntBinaryExprNode::foldFloat(F64 &value)
+{
+   S64 intValue;
+   if(!foldInt(intValue))
+      return false;
+   value = F64(intValue);
+   return true;
+}
+
 //------------------------------------------------------------
 
 U32 StreqExprNode::precompile(TypeReq type)
@@ -722,6 +938,10 @@ TypeReq CommaCatExprNode::getPreferredType()
 
 U32 IntUnaryExprNode::precompile(TypeReq type)
 {
+   U32 foldedSize = folded.precompile(this, true, type);
+   if(folded.valid)
+      return foldedSize;
+
    integer = true;
    TypeReq prefType = expr->getPreferredType();
    if(op == '!' && (prefType == TypeReqFloat || prefType == TypeReqString))
@@ -736,6 +956,9 @@ U32 IntUnaryExprNode::precompile(TypeReq type)
 
 U32 IntUnaryExprNode::compile(U32 *codeStream, U32 ip, TypeReq type)
 {
+   if(folded.valid)
+      return folded.compile(codeStream, ip, type);
+
    ip = expr->compile(codeStream, ip, integer ? TypeReqUInt : TypeReqFloat);
    if(op == '!')
       codeStream[ip++] = integer ? OP_NOT : OP_NOTF;
@@ -751,10 +974,47 @@ TypeReq IntUnaryExprNode::getPreferredType()
    return TypeReqUInt;
 }
 
+bool IntUnaryExprNode::foldInt(S64 &value)
+{
+   TypeReq prefType = expr->getPreferredType();
+   if(op == '!' && (prefType == TypeReqFloat || prefType == TypeReqString))
+   {
+      F64 floatValue;
+      if(!expr->foldFloat(floatValue))
+         return false;
+      value = !floatValue;
+      return true;
+   }
+
+   S64 intValue;
+   if(!expr->foldInt(intValue))
+      return false;
+   if(op == '!')
+      value = !intValue;
+   else if(op == '~')
+      value = ~intValue;
+   else
+      return false;
+   return true;
+}
+
+bool IntUnaryExprNode::foldFloat(F64 &value)
+{
+   S64 intValue;
+   if(!foldInt(intValue))
+      return false;
+   value = F64(intValue);
+   return true;
+}
+
 //------------------------------------------------------------
 
 U32 FloatUnaryExprNode::precompile(TypeReq type)
 {
+   U32 foldedSize = folded.precompile(this, false, type);
+   if(folded.valid)
+      return foldedSize;
+
    U32 exprSize = expr->precompile(TypeReqFloat);
    if(type != TypeReqFloat)
       return exprSize + 2;
@@ -764,6 +1024,9 @@ U32 FloatUnaryExprNode::precompile(TypeReq type)
 
 U32 FloatUnaryExprNode::compile(U32 *codeStream, U32 ip, TypeReq type)
 {
+   if(folded.valid)
+      return folded.compile(codeStream, ip, type);
+
    ip = expr->compile(codeStream, ip, TypeReqFloat);
    codeStream[ip++] = OP_NEG;
    if(type != TypeReqFloat)
@@ -776,6 +1039,21 @@ TypeReq FloatUnaryExprNode::getPreferredType()
    return TypeReqFloat;
 }
 
+bool FloatUnaryExprNode::foldFloat(F64 &value)
+{
+   F64 floatValue;
+   if(!expr->foldFloat(floatValue))
+      return false;
+   value = -floatValue;
+   return true;
+}
+
+bool FloatUnaryExprNode::foldInt(S64 &value)
+{
+   F64 floatValue;
+   return foldFloat(floatValue) && foldFloatToInt(floatValue, value);
+}
+
 //------------------------------------------------------------
 
 U32 VarNode::precompile(TypeReq type)
@@ -790,9 +1068,8 @@ U32 VarNode::precompile(TypeReq type)
    // OP_LOADVAR (type)
 
    // else
-   // OP_SETCURVAR
+   // OP_SETCURVAR_LOADVAR (type)
    // varName
-   // OP_LOADVAR (type)
    if(type == TypeReqNone)
       return 0;
 
@@ -800,7 +1077,7 @@ U32 VarNode::precompile(TypeReq type)
    if(arrayIndex)
       return arrayIndex->precompile(TypeReqString) + 6;
    else
-      return 3;
+      return 2;
 }
 
 U32 VarNode::compile(U32 *codeStream, U32 ip, TypeReq type)
@@ -808,6 +1085,25 @@ U32 VarNode::compile(U32 *codeStream, U32 ip, TypeReq type)
    if(type == TypeReqNone)
       return ip;
 
+   if(!arrayIndex)
+   {
+      switch(type)
+      {
+      case TypeReqUInt:
+         codeStream[ip++] = OP_SETCURVAR_LOADVAR_UINT;
+         break;
+      case TypeReqFloat:
+         codeStream[ip++] = OP_SETCURVAR_LOADVAR_FLT;
+         break;
+      default:
+         codeStream[ip++] = OP_SETCURVAR_LOADVAR_STR;
+         break;
+      }
+      codeStream[ip] = STEtoU32(varName, ip);
+      ip++;
+      return ip;
+   }
+
    codeStream[ip++] = arrayIndex ? OP_LOADIMMED_IDENT : OP_SETCURVAR;
    codeStream[ip] = STEtoU32(varName, ip);
    ip++;
@@ -880,6 +1176,18 @@ TypeReq IntNode::getPreferredType()
    return TypeReqUInt;
 }
 
+bool IntNode::foldFloat(F64 &result)
+{
+   result = F64(value);
+   return true;
+}
+
+bool IntNode::foldInt(S64 &result)
+{
+   result = S64(U32(value));
+   return true;
+}
+
 //------------------------------------------------------------
 
 U32 FloatNode::precompile(TypeReq type)
@@ -920,6 +1228,21 @@ TypeReq FloatNode::getPreferredType()
    return TypeReqFloat;
 }
 
+bool FloatNode::foldFloat(F64 &result)
+{
+   result = value;
+   return true;
+}
+
+bool FloatNode::foldInt(S64 &result)
+{
+   // Matches the U32 cast in compile(), which is only defined in this range.
+   if(!(value >= 0 && value < 4294967296.0))
+      return false;
+   result = S64(U32(value));
+   return true;
+}
+
 //------------------------------------------------------------
 
 U32 StrConstNode::precompile(TypeReq type)
@@ -1052,11 +1375,10 @@ U32 AssignExprNode::precompile(TypeReq type)
 
    //else
    // eval expr
-   // OP_SETCURVAR_CREATE
+   // OP_SETCURVAR_CREATE_SAVEVAR
    // varname
-   // OP_SAVEVAR
    U32 addSize = 0;
-   if(type != subType)
+   if(isConversionNeeded(subType, type))
       addSize = 1;
 
    U32 retSize = expr->precompile(subType);
@@ -1069,7 +1391,7 @@ U32 AssignExprNode::precompile(TypeReq type)
          return arrayIndex->precompile(TypeReqString) + retSize + addSize + 6;
    }
    else
-      return retSize + addSize + 3;
+      return retSize + addSize + 2;
 }
 
 U32 AssignExprNode::compile(U32 *codeStream, U32 ip, TypeReq type)
@@ -1089,28 +1411,41 @@ U32 AssignExprNode::compile(U32 *codeStream, U32 ip, TypeReq type)
       codeStream[ip++] = OP_SETCURVAR_ARRAY_CREATE;
       if(subType == TypeReqString)
          codeStream[ip++] = OP_TERMINATE_REWIND_STR;
+      switch(subType)
+      {
+      case TypeReqString:
+         codeStream[ip++] = OP_SAVEVAR_STR;
+         break;
+      case TypeReqUInt:
+         codeStream[ip++] = OP_SAVEVAR_UINT;
+         break;
+      case TypeReqFloat:
+         codeStream[ip++] = OP_SAVEVAR_FLT;
+         break;
+      default:
+         break;
+      }
    }
    else
    {
-      codeStream[ip++] = OP_SETCURVAR_CREATE;
+      switch(subType)
+      {
+      case TypeReqString:
+         codeStream[ip++] = OP_SETCURVAR_CREATE_SAVEVAR_STR;
+         break;
+      case TypeReqUInt:
+         codeStream[ip++] = OP_SETCURVAR_CREATE_SAVEVAR_UINT;
+         break;
+      case TypeReqFloat:
+         codeStream[ip++] = OP_SETCURVAR_CREATE_SAVEVAR_FLT;
+         break;
+      default:
+         break;
+      }
       codeStream[ip] = STEtoU32(varName, ip);
       ip++;
    }
-   switch(subType)
-   {
-   case TypeReqString:
-      codeStream[ip++] = OP_SAVEVAR_STR;
-      break;
-   case TypeReqUInt:
-      codeStream[ip++] = OP_SAVEVAR_UINT;
-      break;
-   case TypeReqFloat:
-      codeStream[ip++] = OP_SAVEVAR_FLT;
-      break;
-    default:
-       break;
-   }
-   if(type != subType)
+   if(isConversionNeeded(subType, type))
       codeStream[ip++] = conversionOp(subType, type);
    return ip;
 }
@@ -1482,7 +1817,7 @@ U32 SlotAssignNode::precompile(TypeReq type)
    // convert to return type if necessary.
 
    U32 size = 0;
-   if(type != TypeReqString)
+   if(isConversionNeeded(TypeReqString, type))
       size++;
 
    precompileIdent(slotName);
@@ -1525,7 +1860,7 @@ U32 SlotAssignNode::compile(U32 *codeStream, U32 ip, TypeReq type)
    }
    codeStream[ip++] = OP_TERMINATE_REWIND_STR;
    codeStream[ip++] = OP_SAVEFIELD_STR;
-   if(type != TypeReqString)
+   if(isConversionNeeded(TypeReqString, type))
       codeStream[ip++] = conversionOp(TypeReqString, type);
    return ip;
 }
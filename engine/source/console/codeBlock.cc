@@ -24,6 +24,7 @@
 #include "console/codeBlock.h"
 #include "io/resource/resourceManager.h"
 #include "math/mMath.h"
+#include "platform/platformFileIO.h"
 
 #include "debug/telnetDebugger.h"
 
@@ -57,6 +58,7 @@ CodeBlock::CodeBlock()
    fullPath = NULL;
    modPath = NULL;
    mRoot = StringTable->EmptyString;
+   mappedFile = NULL;
 }
 
 CodeBlock::~CodeBlock()
@@ -66,8 +68,13 @@ CodeBlock::~CodeBlock()
 
    if(name)
       removeFromCodeList();
-   delete[] const_cast<char*>(globalStrings);
-   delete[] const_cast<char*>(functionStrings);
+   if(mappedFile)
+      delete mappedFile;
+   else
+   {
+      delete[] const_cast<char*>(globalStrings);
+      delete[] const_cast<char*>(functionStrings);
+   }
    delete[] globalFloats;
    delete[] functionFloats;
    delete[] code;
@@ -348,7 +355,7 @@ void CodeBlock::calcBreakList()
        pRemoteDebugger->addCodeBlock( this );
 }
 
-bool CodeBlock::read(StringTableEntry fileName, Stream &st)
+bool CodeBlock::read(StringTableEntry fileName, Stream &st, File *mappedFile)
 {
    const StringTableEntry exePath = Platform::getMainDotCsDir();
    const StringTableEntry cwd = Platform::getCurrentDirectory();
@@ -391,19 +398,44 @@ bool CodeBlock::read(StringTableEntry fileName, Stream &st)
    //
    addToCodeList();
 
+   // Use the string tables in place if the stream is over a mapped file.
+   char *mappedData = NULL;
+   if(mappedFile)
+   {
+      this->mappedFile = mappedFile;
+      // Tagged strings are converted in place, so writes must not fault.
+      mappedData = (char *)mappedFile->map(NULL, true);
+   }
+
    U32 globalSize,size,i;
    st.read(&size);
    if(size)
    {
       globalSize = size;
-      globalStrings = new char[size];
-      st.read(size, globalStrings);
+      if(mappedData)
+      {
+         globalStrings = mappedData + st.getPosition();
+         st.setPosition(st.getPosition() + size);
+      }
+      else
+      {
+         globalStrings = new char[size];
+         st.read(size, globalStrings);
+      }
    }
    st.read(&size);
    if(size)
    {
-      functionStrings = new char[size];
-      st.read(size, functionStrings);
+      if(mappedData)
+      {
+         functionStrings = mappedData + st.getPosition();
+         st.setPosition(st.getPosition() + size);
+      }
+      else
+      {
+         functionStrings = new char[size];
+         st.read(size, functionStrings);
+      }
    }
    st.read(&size);
    if(size)
@@ -471,6 +503,22 @@ bool CodeBlock::read(StringTableEntry fileName, Stream &st)
 
 
 bool CodeBlock::compile(const char *codeFileName, StringTableEntry fileName, const char *script)
+{
+   if(!parseScript(fileName, script))
+      return false;
+
+   FileStream st;
+   if(!ResourceManager->openFileForWrite(st, codeFileName)) 
+      return false;
+   st.write(DSO_VERSION);
+
+   writeCompiled(st);
+   st.close();
+
+   return true;
+}
+
+bool CodeBlock::parseScript(StringTableEntry fileName, const char *script)
 {
    gSyntaxError = false;
 
@@ -495,11 +543,11 @@ bool CodeBlock::compile(const char *codeFileName, StringTableEntry fileName, con
       return false;
    }   
 
-   FileStream st;
-   if(!ResourceManager->openFileForWrite(st, codeFileName)) 
-      return false;
-   st.write(DSO_VERSION);
+   return true;
+}
 
+void CodeBlock::writeCompiled(Stream &st)
+{
    // Reset all our value tables...
    resetTables();
 
@@ -559,9 +607,6 @@ bool CodeBlock::compile(const char *codeFileName, StringTableEntry fileName, con
    getIdentTable().write(st);
 
    consoleAllocReset();
-   st.close();
-
-   return true;
 }
 
 const char *CodeBlock::compileExec(StringTableEntry fileName, const char *string, bool noCalls, int setFrame)
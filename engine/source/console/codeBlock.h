@@ -27,6 +27,7 @@
 #include "console/consoleParser.h"
 
 class Stream;
+class File;
 
 
 /// Core TorqueScript code management class.
@@ -82,6 +83,9 @@ public:
    CodeBlock *nextFile;
    StringTableEntry mRoot;
 
+   /// Mapped file the string tables point into, if the code was read from one.
+   File *mappedFile;
+
 
    void addToCodeList();
    void removeFromCodeList();
@@ -104,9 +108,24 @@ public:
    void getFunctionArgs(char buffer[1024], U32 offset);
    const char *getFileLine(U32 ip);
 
-   bool read(StringTableEntry fileName, Stream &st);
+   /// Reads compiled code.
+   ///
+   /// @param fileName The file name the code was compiled from.
+   /// @param st The stream to read from.
+   /// @param mappedFile A mapped file that the stream reads from the start of.
+   /// The string tables are used in place rather than copied and the CodeBlock
+   /// takes ownership of the file.
+   bool read(StringTableEntry fileName, Stream &st, File *mappedFile = NULL);
+
    bool compile(const char *dsoName, StringTableEntry fileName, const char *script);
 
+   /// Parses a script ready for writeCompiled().
+   /// @return False if the script has a syntax error.
+   bool parseScript(StringTableEntry fileName, const char *script);
+
+   /// Compiles the script parsed by parseScript() and writes it to a stream in the DSO format, without the version.
+   void writeCompiled(Stream &st);
+
    void incRefCount();
    void decRefCount();
 
@@ -39,6 +39,7 @@
 #include "string/stringStack.h"
 #include "messaging/message.h"
 #include "memory/frameAllocator.h"
+#include "game/replayBenchmark.h"
 
 #include "debug/telnetDebugger.h"
 
@@ -48,6 +49,17 @@
 
 using namespace Compiler;
 
+// GCC and Clang can jump straight from one opcode handler to the next through a
+// table of label addresses, giving each handler its own (better predicted)
+// indirect branch. Everything else goes back through the switch.
+#if defined(TORQUE_COMPILER_GCC)
+#define OPCODE(op)      case op: label_##op
+#define NEXT_OPCODE()   { instruction = code[ip++]; goto *opcodeLabels[instruction < OP_INVALID ? instruction : OP_INVALID]; }
+#else
+#define OPCODE(op)      case op
+#define NEXT_OPCODE()   break
+#endif
+
 enum EvalConstants {
    MaxStackSize = 1024,
    MethodOnComponent = -2
@@ -453,6 +465,9 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
    U32 stackStart = STR.mStartStackSize;
 #endif
 
+   // Time script execution for the replay benchmark.
+   ReplayBenchmark::SampleScope benchmarkSample( ReplayBenchmark::SampleScript );
+
    static char traceBuffer[1024];
    U32 i;
 
@@ -579,14 +594,52 @@ const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNam
    // OP_LOADFIELD_*) to store temporary values for the fields.
    static S32 VAL_BUFFER_SIZE = 1024;
    FrameTemp<char> valBuffer( VAL_BUFFER_SIZE );
-   
+
+#if defined(TORQUE_COMPILER_GCC)
+   // Must list every opcode in the order of the enum in compiler.h.
+   static void * const opcodeLabels[] = {
+      &&label_OP_FUNC_DECL, &&label_OP_CREATE_OBJECT, &&label_OP_ADD_OBJECT,
+      &&label_OP_END_OBJECT, &&label_OP_JMPIFFNOT, &&label_OP_JMPIFNOT,
+      &&label_OP_JMPIFF, &&label_OP_JMPIF, &&label_OP_JMPIFNOT_NP,
+      &&label_OP_JMPIF_NP, &&label_OP_JMP, &&label_OP_RETURN,
+      &&label_OP_CMPEQ, &&label_OP_CMPGR, &&label_OP_CMPGE,
+      &&label_OP_CMPLT, &&label_OP_CMPLE, &&label_OP_CMPNE,
+      &&label_OP_XOR, &&label_OP_MOD, &&label_OP_BITAND,
+      &&label_OP_BITOR, &&label_OP_NOT, &&label_OP_NOTF,
+      &&label_OP_ONESCOMPLEMENT, &&label_OP_SHR, &&label_OP_SHL,
+      &&label_OP_AND, &&label_OP_OR, &&label_OP_ADD,
+      &&label_OP_SUB, &&label_OP_MUL, &&label_OP_DIV,
+      &&label_OP_NEG, &&label_OP_SETCURVAR, &&label_OP_SETCURVAR_CREATE,
+      &&label_OP_SETCURVAR_ARRAY, &&label_OP_SETCURVAR_ARRAY_CREATE, &&label_OP_LOADVAR_UINT,
+      &&label_OP_LOADVAR_FLT, &&label_OP_LOADVAR_STR, &&label_OP_SAVEVAR_UINT,
+      &&label_OP_SAVEVAR_FLT, &&label_OP_SAVEVAR_STR, &&label_OP_SETCURVAR_LOADVAR_UINT,
+      &&label_OP_SETCURVAR_LOADVAR_FLT, &&label_OP_SETCURVAR_LOADVAR_STR, &&label_OP_SETCURVAR_CREATE_SAVEVAR_UINT,
+      &&label_OP_SETCURVAR_CREATE_SAVEVAR_FLT, &&label_OP_SETCURVAR_CREATE_SAVEVAR_STR, &&label_OP_SETCUROBJECT,
+      &&label_OP_SETCUROBJECT_NEW, &&label_OP_SETCUROBJECT_INTERNAL, &&label_OP_SETCURFIELD,
+      &&label_OP_SETCURFIELD_ARRAY, &&label_OP_LOADFIELD_UINT, &&label_OP_LOADFIELD_FLT,
+      &&label_OP_LOADFIELD_STR, &&label_OP_SAVEFIELD_UINT, &&label_OP_SAVEFIELD_FLT,
+      &&label_OP_SAVEFIELD_STR, &&label_OP_STR_TO_UINT, &&label_OP_STR_TO_FLT,
+      &&label_OP_STR_TO_NONE, &&label_OP_FLT_TO_UINT, &&label_OP_FLT_TO_STR,
+      &&label_OP_FLT_TO_NONE, &&label_OP_UINT_TO_FLT, &&label_OP_UINT_TO_STR,
+      &&label_OP_UINT_TO_NONE, &&label_OP_LOADIMMED_UINT, &&label_OP_LOADIMMED_FLT,
+      &&label_OP_TAG_TO_STR, &&label_OP_LOADIMMED_STR, &&label_OP_DOCBLOCK_STR,
+      &&label_OP_LOADIMMED_IDENT, &&label_OP_CALLFUNC_RESOLVE, &&label_OP_CALLFUNC,
+      &&label_OP_ADVANCE_STR, &&label_OP_ADVANCE_STR_APPENDCHAR, &&label_OP_ADVANCE_STR_COMMA,
+      &&label_OP_ADVANCE_STR_NUL, &&label_OP_REWIND_STR, &&label_OP_TERMINATE_REWIND_STR,
+      &&label_OP_COMPARE_STR, &&label_OP_PUSH, &&label_OP_PUSH_FRAME,
+      &&label_OP_BREAK, &&label_OP_INVALID
+   };
+   AssertFatal(sizeof(opcodeLabels) / sizeof(opcodeLabels[0]) == OP_INVALID + 1, "CodeBlock::exec - opcode label table is out of date.");
+#endif
+
+   U32 instruction;
    for(;;)
    {
-      U32 instruction = code[ip++];
+      instruction = code[ip++];
 breakContinue:
       switch(instruction)
       {
-         case OP_FUNC_DECL:
+         OPCODE(OP_FUNC_DECL):
             if(!noCalls)
             {
                fnName       = U32toSTE(code[ip]);
@@ -618,7 +671,7 @@ breakContinue:
             ip = code[ip + 4];
             break;
 
-         case OP_CREATE_OBJECT:
+         OPCODE(OP_CREATE_OBJECT):
          {
             // Read some useful info.
             objParent        = U32toSTE(code[ip    ]);
@@ -782,7 +835,7 @@ breakContinue:
             break;
          }
 
-         case OP_ADD_OBJECT:
+         OPCODE(OP_ADD_OBJECT):
          {
             // See OP_SETCURVAR for why we do this.
             curFNDocBlock = NULL;
@@ -900,7 +953,7 @@ breakContinue:
             break;
          }
 
-         case OP_END_OBJECT:
+         OPCODE(OP_END_OBJECT):
          {
             // If we're not to be placed at the root, make sure we clean up
             // our group reference.
@@ -910,177 +963,177 @@ breakContinue:
             break;
          }
 
-         case OP_JMPIFFNOT:
+         OPCODE(OP_JMPIFFNOT):
             if(floatStack[FLT--])
             {
                ip++;
-               break;
+               NEXT_OPCODE();
             }
             ip = code[ip];
-            break;
-         case OP_JMPIFNOT:
+            NEXT_OPCODE();
+         OPCODE(OP_JMPIFNOT):
             if(intStack[UINT--])
             {
                ip++;
-               break;
+               NEXT_OPCODE();
             }
             ip = code[ip];
-            break;
-         case OP_JMPIFF:
+            NEXT_OPCODE();
+         OPCODE(OP_JMPIFF):
             if(!floatStack[FLT--])
             {
                ip++;
-               break;
+               NEXT_OPCODE();
             }
             ip = code[ip];
-            break;
-         case OP_JMPIF:
+            NEXT_OPCODE();
+         OPCODE(OP_JMPIF):
             if(!intStack[UINT--])
             {
                ip ++;
-               break;
+               NEXT_OPCODE();
             }
             ip = code[ip];
-            break;
-         case OP_JMPIFNOT_NP:
+            NEXT_OPCODE();
+         OPCODE(OP_JMPIFNOT_NP):
             if(intStack[UINT])
             {
                UINT--;
                ip++;
-               break;
+               NEXT_OPCODE();
             }
             ip = code[ip];
-            break;
-         case OP_JMPIF_NP:
+            NEXT_OPCODE();
+         OPCODE(OP_JMPIF_NP):
             if(!intStack[UINT])
             {
                UINT--;
                ip++;
-               break;
+               NEXT_OPCODE();
             }
             ip = code[ip];
-            break;
-         case OP_JMP:
+            NEXT_OPCODE();
+         OPCODE(OP_JMP):
             ip = code[ip];
-            break;
-         case OP_RETURN:
+            NEXT_OPCODE();
+         OPCODE(OP_RETURN):
             goto execFinished;
-         case OP_CMPEQ:
+         OPCODE(OP_CMPEQ):
             intStack[UINT+1] = bool(floatStack[FLT] == floatStack[FLT-1]);
             UINT++;
             FLT -= 2;
-            break;
+            NEXT_OPCODE();
 
-         case OP_CMPGR:
+         OPCODE(OP_CMPGR):
             intStack[UINT+1] = bool(floatStack[FLT] > floatStack[FLT-1]);
             UINT++;
             FLT -= 2;
-            break;
+            NEXT_OPCODE();
 
-         case OP_CMPGE:
+         OPCODE(OP_CMPGE):
             intStack[UINT+1] = bool(floatStack[FLT] >= floatStack[FLT-1]);
             UINT++;
             FLT -= 2;
-            break;
+            NEXT_OPCODE();
 
-         case OP_CMPLT:
+         OPCODE(OP_CMPLT):
             intStack[UINT+1] = bool(floatStack[FLT] < floatStack[FLT-1]);
             UINT++;
             FLT -= 2;
-            break;
+            NEXT_OPCODE();
 
-         case OP_CMPLE:
+         OPCODE(OP_CMPLE):
             intStack[UINT+1] = bool(floatStack[FLT] <= floatStack[FLT-1]);
             UINT++;
             FLT -= 2;
-            break;
+            NEXT_OPCODE();
 
-         case OP_CMPNE:
+         OPCODE(OP_CMPNE):
             intStack[UINT+1] = bool(floatStack[FLT] != floatStack[FLT-1]);
             UINT++;
             FLT -= 2;
-            break;
+            NEXT_OPCODE();
 
-         case OP_XOR:
+         OPCODE(OP_XOR):
             intStack[UINT-1] = intStack[UINT] ^ intStack[UINT-1];
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_MOD:
+         OPCODE(OP_MOD):
             if(  intStack[UINT-1] != 0 )
                intStack[UINT-1] = intStack[UINT] % intStack[UINT-1];
             else
                intStack[UINT-1] = 0;
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_BITAND:
+         OPCODE(OP_BITAND):
             intStack[UINT-1] = intStack[UINT] & intStack[UINT-1];
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_BITOR:
+         OPCODE(OP_BITOR):
             intStack[UINT-1] = intStack[UINT] | intStack[UINT-1];
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_NOT:
+         OPCODE(OP_NOT):
             intStack[UINT] = !intStack[UINT];
-            break;
+            NEXT_OPCODE();
 
-         case OP_NOTF:
+         OPCODE(OP_NOTF):
             intStack[UINT+1] = !floatStack[FLT];
             FLT--;
             UINT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_ONESCOMPLEMENT:
+         OPCODE(OP_ONESCOMPLEMENT):
             intStack[UINT] = ~intStack[UINT];
-            break;
+            NEXT_OPCODE();
 
-         case OP_SHR:
+         OPCODE(OP_SHR):
             intStack[UINT-1] = intStack[UINT] >> intStack[UINT-1];
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_SHL:
+         OPCODE(OP_SHL):
             intStack[UINT-1] = intStack[UINT] << intStack[UINT-1];
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_AND:
+         OPCODE(OP_AND):
             intStack[UINT-1] = intStack[UINT] && intStack[UINT-1];
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_OR:
+         OPCODE(OP_OR):
             intStack[UINT-1] = intStack[UINT] || intStack[UINT-1];
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_ADD:
+         OPCODE(OP_ADD):
             floatStack[FLT-1] = floatStack[FLT] + floatStack[FLT-1];
             FLT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_SUB:
+         OPCODE(OP_SUB):
             floatStack[FLT-1] = floatStack[FLT] - floatStack[FLT-1];
             FLT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_MUL:
+         OPCODE(OP_MUL):
             floatStack[FLT-1] = floatStack[FLT] * floatStack[FLT-1];
             FLT--;
-            break;
-         case OP_DIV:
+            NEXT_OPCODE();
+         OPCODE(OP_DIV):
             floatStack[FLT-1] = floatStack[FLT] / floatStack[FLT-1];
             FLT--;
-            break;
-         case OP_NEG:
+            NEXT_OPCODE();
+         OPCODE(OP_NEG):
             floatStack[FLT] = -floatStack[FLT];
-            break;
+            NEXT_OPCODE();
 
-         case OP_SETCURVAR:
+         OPCODE(OP_SETCURVAR):
             var = U32toSTE(code[ip]);
             ip++;
 
@@ -1098,9 +1151,9 @@ breakContinue:
             // won't inappropriately carry forward to following function decls.
             curFNDocBlock = NULL;
             curNSDocBlock = NULL;
-            break;
+            NEXT_OPCODE();
 
-         case OP_SETCURVAR_CREATE:
+         OPCODE(OP_SETCURVAR_CREATE):
             var = U32toSTE(code[ip]);
             ip++;
 
@@ -1114,9 +1167,9 @@ breakContinue:
             // See OP_SETCURVAR for why we do this.
             curFNDocBlock = NULL;
             curNSDocBlock = NULL;
-            break;
+            NEXT_OPCODE();
 
-         case OP_SETCURVAR_ARRAY:
+         OPCODE(OP_SETCURVAR_ARRAY):
             var = STR.getSTValue();
 
             // See OP_SETCURVAR
@@ -1129,9 +1182,9 @@ breakContinue:
             // See OP_SETCURVAR for why we do this.
             curFNDocBlock = NULL;
             curNSDocBlock = NULL;
-            break;
+            NEXT_OPCODE();
 
-         case OP_SETCURVAR_ARRAY_CREATE:
+         OPCODE(OP_SETCURVAR_ARRAY_CREATE):
             var = STR.getSTValue();
 
             // See OP_SETCURVAR
@@ -1144,36 +1197,119 @@ breakContinue:
             // See OP_SETCURVAR for why we do this.
             curFNDocBlock = NULL;
             curNSDocBlock = NULL;
-            break;
+            NEXT_OPCODE();
 
-         case OP_LOADVAR_UINT:
+         OPCODE(OP_LOADVAR_UINT):
             intStack[UINT+1] = gEvalState.getIntVariable();
             UINT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_LOADVAR_FLT:
+         OPCODE(OP_LOADVAR_FLT):
             floatStack[FLT+1] = gEvalState.getFloatVariable();
             FLT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_LOADVAR_STR:
+         OPCODE(OP_LOADVAR_STR):
             val = gEvalState.getStringVariable();
             STR.setStringValue(val);
-            break;
+            NEXT_OPCODE();
 
-         case OP_SAVEVAR_UINT:
+         OPCODE(OP_SAVEVAR_UINT):
             gEvalState.setIntVariable((S32)intStack[UINT]);
-            break;
+            NEXT_OPCODE();
 
-         case OP_SAVEVAR_FLT:
+         OPCODE(OP_SAVEVAR_FLT):
             gEvalState.setFloatVariable(floatStack[FLT]);
-            break;
+            NEXT_OPCODE();
 
-         case OP_SAVEVAR_STR:
+         OPCODE(OP_SAVEVAR_STR):
             gEvalState.setStringVariable(STR.getStringValue());
-            break;
+            NEXT_OPCODE();
+
+         // The fused variable opcodes behave exactly like OP_SETCURVAR or
+         // OP_SETCURVAR_CREATE followed by the matching load or save.
+         OPCODE(OP_SETCURVAR_LOADVAR_UINT):
+            var = U32toSTE(code[ip]);
+            ip++;
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            gEvalState.setCurVarName(var);
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            intStack[UINT+1] = gEvalState.getIntVariable();
+            UINT++;
+            NEXT_OPCODE();
 
-         case OP_SETCUROBJECT:
+         OPCODE(OP_SETCURVAR_LOADVAR_FLT):
+            var = U32toSTE(code[ip]);
+            ip++;
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            gEvalState.setCurVarName(var);
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            floatStack[FLT+1] = gEvalState.getFloatVariable();
+            FLT++;
+            NEXT_OPCODE();
+
+         OPCODE(OP_SETCURVAR_LOADVAR_STR):
+            var = U32toSTE(code[ip]);
+            ip++;
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            gEvalState.setCurVarName(var);
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            val = gEvalState.getStringVariable();
+            STR.setStringValue(val);
+            NEXT_OPCODE();
+
+         OPCODE(OP_SETCURVAR_CREATE_SAVEVAR_UINT):
+            var = U32toSTE(code[ip]);
+            ip++;
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            gEvalState.setCurVarNameCreate(var);
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.setIntVariable((S32)intStack[UINT]);
+            NEXT_OPCODE();
+
+         OPCODE(OP_SETCURVAR_CREATE_SAVEVAR_FLT):
+            var = U32toSTE(code[ip]);
+            ip++;
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            gEvalState.setCurVarNameCreate(var);
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.setFloatVariable(floatStack[FLT]);
+            NEXT_OPCODE();
+
+         OPCODE(OP_SETCURVAR_CREATE_SAVEVAR_STR):
+            var = U32toSTE(code[ip]);
+            ip++;
+            prevField = NULL;
+            prevObject = NULL;
+            curObject = NULL;
+            gEvalState.setCurVarNameCreate(var);
+            curFNDocBlock = NULL;
+            curNSDocBlock = NULL;
+
+            gEvalState.setStringVariable(STR.getStringValue());
+            NEXT_OPCODE();
+
+         OPCODE(OP_SETCUROBJECT):
             // Save the previous object for parsing vector fields.
             prevObject = curObject;
             val = STR.getStringValue();
@@ -1192,7 +1328,7 @@ breakContinue:
             curObject = Sim::findObject(val);
             break;
 
-         case OP_SETCUROBJECT_INTERNAL:
+         OPCODE(OP_SETCUROBJECT_INTERNAL):
             ++ip; // To skip the recurse flag if the object wasnt found
             if(curObject)
             {
@@ -1213,11 +1349,11 @@ breakContinue:
             }
             break;
 
-         case OP_SETCUROBJECT_NEW:
+         OPCODE(OP_SETCUROBJECT_NEW):
             curObject = currentNewObject;
             break;
 
-         case OP_SETCURFIELD:
+         OPCODE(OP_SETCURFIELD):
             // Save the previous field for parsing vector fields.
             prevField = curField;
             dStrcpy( prevFieldArray, curFieldArray );
@@ -1226,11 +1362,11 @@ breakContinue:
             ip++;
             break;
 
-         case OP_SETCURFIELD_ARRAY:
+         OPCODE(OP_SETCURFIELD_ARRAY):
             dStrcpy(curFieldArray, STR.getStringValue());
             break;
 
-         case OP_LOADFIELD_UINT:
+         OPCODE(OP_LOADFIELD_UINT):
             if(curObject)
                intStack[UINT+1] = U32(dAtoi(curObject->getDataField(curField, curFieldArray)));
             else
@@ -1244,7 +1380,7 @@ breakContinue:
             UINT++;
             break;
 
-         case OP_LOADFIELD_FLT:
+         OPCODE(OP_LOADFIELD_FLT):
             if(curObject)
                floatStack[FLT+1] = dAtof(curObject->getDataField(curField, curFieldArray));
             else
@@ -1257,7 +1393,7 @@ breakContinue:
             FLT++;
             break;
 
-         case OP_LOADFIELD_STR:
+         OPCODE(OP_LOADFIELD_STR):
             if(curObject)
             {
                val = curObject->getDataField(curField, curFieldArray);
@@ -1273,7 +1409,7 @@ breakContinue:
 
             break;
 
-         case OP_SAVEFIELD_UINT:
+         OPCODE(OP_SAVEFIELD_UINT):
             STR.setIntValue((U32)intStack[UINT]);
             if(curObject)
                curObject->setDataField(curField, curFieldArray, STR.getStringValue());
@@ -1286,7 +1422,7 @@ breakContinue:
             }
             break;
 
-         case OP_SAVEFIELD_FLT:
+         OPCODE(OP_SAVEFIELD_FLT):
             STR.setFloatValue(floatStack[FLT]);
             if(curObject)
                curObject->setDataField(curField, curFieldArray, STR.getStringValue());
@@ -1299,7 +1435,7 @@ breakContinue:
             }
             break;
 
-         case OP_SAVEFIELD_STR:
+         OPCODE(OP_SAVEFIELD_STR):
             if(curObject)
                curObject->setDataField(curField, curFieldArray, STR.getStringValue());
             else
@@ -1311,61 +1447,61 @@ breakContinue:
             }
             break;
 
-         case OP_STR_TO_UINT:
+         OPCODE(OP_STR_TO_UINT):
             intStack[UINT+1] = STR.getIntValue();
             UINT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_STR_TO_FLT:
+         OPCODE(OP_STR_TO_FLT):
             floatStack[FLT+1] = STR.getFloatValue();
             FLT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_STR_TO_NONE:
+         OPCODE(OP_STR_TO_NONE):
             // This exists simply to deal with certain typecast situations.
-            break;
+            NEXT_OPCODE();
 
-         case OP_FLT_TO_UINT:
+         OPCODE(OP_FLT_TO_UINT):
             intStack[UINT+1] = (S64)floatStack[FLT];
             FLT--;
             UINT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_FLT_TO_STR:
+         OPCODE(OP_FLT_TO_STR):
             STR.setFloatValue(floatStack[FLT]);
             FLT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_FLT_TO_NONE:
+         OPCODE(OP_FLT_TO_NONE):
             FLT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_UINT_TO_FLT:
+         OPCODE(OP_UINT_TO_FLT):
             floatStack[FLT+1] = (F64)intStack[UINT];
             UINT--;
             FLT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_UINT_TO_STR:
+         OPCODE(OP_UINT_TO_STR):
             STR.setIntValue((U32)intStack[UINT]);
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_UINT_TO_NONE:
+         OPCODE(OP_UINT_TO_NONE):
             UINT--;
-            break;
+            NEXT_OPCODE();
 
-         case OP_LOADIMMED_UINT:
+         OPCODE(OP_LOADIMMED_UINT):
             intStack[UINT+1] = code[ip++];
             UINT++;
-            break;
+            NEXT_OPCODE();
 
-         case OP_LOADIMMED_FLT:
+         OPCODE(OP_LOADIMMED_FLT):
             floatStack[FLT+1] = curFloatTable[code[ip]];
             ip++;
             FLT++;
-            break;
-         case OP_TAG_TO_STR:
+            NEXT_OPCODE();
+         OPCODE(OP_TAG_TO_STR):
             code[ip-1] = OP_LOADIMMED_STR;
             // it's possible the string has already been converted
             if(U8(curStringTable[code[ip]]) != StringTagPrefixByte)
@@ -1374,11 +1510,11 @@ breakContinue:
                dSprintf(curStringTable + code[ip] + 1, 7, "%d", id);
                *(curStringTable + code[ip]) = StringTagPrefixByte;
             }
-         case OP_LOADIMMED_STR:
+         OPCODE(OP_LOADIMMED_STR):
             STR.setStringValue(curStringTable + code[ip++]);
-            break;
+            NEXT_OPCODE();
 
-         case OP_DOCBLOCK_STR:
+         OPCODE(OP_DOCBLOCK_STR):
             {
                // If the first word of the doc is '\class' or '@class', then this
                // is a namespace doc block, otherwise it is a function doc block.
@@ -1409,11 +1545,11 @@ breakContinue:
 
             break;
 
-         case OP_LOADIMMED_IDENT:
+         OPCODE(OP_LOADIMMED_IDENT):
             STR.setStringValue(U32toSTE(code[ip++]));
-            break;
+            NEXT_OPCODE();
 
-         case OP_CALLFUNC_RESOLVE:
+         OPCODE(OP_CALLFUNC_RESOLVE):
             // This deals with a function that is potentially living in a namespace.
             fnNamespace = U32toSTE(code[ip+1]);
             fnName      = U32toSTE(code[ip]);
@@ -1436,7 +1572,7 @@ breakContinue:
             code[ip+1] = *((U32 *) &nsEntry);
             code[ip-1] = OP_CALLFUNC;
 
-         case OP_CALLFUNC:
+         OPCODE(OP_CALLFUNC):
          {
             // This routingId is set when we query the object as to whether
             // it handles this method.  It is set to an enum from the table
@@ -1653,40 +1789,40 @@ breakContinue:
                gEvalState.thisObject = saveObject;
             break;
          }
-         case OP_ADVANCE_STR:
+         OPCODE(OP_ADVANCE_STR):
             STR.advance();
-            break;
-         case OP_ADVANCE_STR_APPENDCHAR:
+            NEXT_OPCODE();
+         OPCODE(OP_ADVANCE_STR_APPENDCHAR):
             STR.advanceChar(code[ip++]);
-            break;
+            NEXT_OPCODE();
 
-         case OP_ADVANCE_STR_COMMA:
+         OPCODE(OP_ADVANCE_STR_COMMA):
             STR.advanceChar('_');
-            break;
+            NEXT_OPCODE();
 
-         case OP_ADVANCE_STR_NUL:
+         OPCODE(OP_ADVANCE_STR_NUL):
             STR.advanceChar(0);
-            break;
+            NEXT_OPCODE();
 
-         case OP_REWIND_STR:
+         OPCODE(OP_REWIND_STR):
             STR.rewind();
-            break;
+            NEXT_OPCODE();
 
-         case OP_TERMINATE_REWIND_STR:
+         OPCODE(OP_TERMINATE_REWIND_STR):
             STR.rewindTerminate();
-            break;
+            NEXT_OPCODE();
 
-         case OP_COMPARE_STR:
+         OPCODE(OP_COMPARE_STR):
             intStack[++UINT] = STR.compare();
-            break;
-         case OP_PUSH:
+            NEXT_OPCODE();
+         OPCODE(OP_PUSH):
             STR.push();
-            break;
+            NEXT_OPCODE();
 
-         case OP_PUSH_FRAME:
+         OPCODE(OP_PUSH_FRAME):
             STR.pushFrame();
-            break;
-         case OP_BREAK:
+            NEXT_OPCODE();
+         OPCODE(OP_BREAK):
          {
             //append the ip and codeptr before managing the breakpoint!
             AssertFatal( !gEvalState.stack.empty(), "Empty eval stack on break!");
@@ -1705,7 +1841,7 @@ breakContinue:
 
             goto breakContinue;
          }
-         case OP_INVALID:
+         OPCODE(OP_INVALID):
 
          default:
             // error!
@@ -0,0 +1,338 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "console/compiledScriptCache.h"
+#include "console/console.h"
+#include "console/compiler.h"
+#include "console/codeBlock.h"
+#include "string/stringTable.h"
+#include "io/fileStream.h"
+#include "io/memstream.h"
+#include "platform/platformFileIO.h"
+#include "platform/threads/thread.h"
+#include "platform/threads/atomic.h"
+#include "memory/frameAllocator.h"
+#include "debug/traceProfiler.h"
+#include "algorithm/hashFunction.h"
+#include <stdlib.h> // sources are read on worker threads so use malloc and free directly
+
+namespace CompiledScriptCache
+{
+
+enum
+{
+   /// Identifies a cache file ("TSCC").
+   CacheFileId = 0x43435354,
+
+   /// The file id, DSO version, hash and source size.
+   CacheHeaderSize = 5 * sizeof(U32),
+};
+
+//-----------------------------------------------------------------------------
+
+/// Expand $Scripts::cachePath into a full path.
+static void getCachePath(char *buffer, U32 bufferSize)
+{
+   char expandedPath[1024];
+   Con::expandPath(expandedPath, sizeof(expandedPath), Con::getVariable("$Scripts::cachePath"));
+   Platform::makeFullPathName(expandedPath, buffer, bufferSize);
+}
+
+/// Build the name of the cache file for a script hash.
+static void getCacheFileName(char *buffer, U32 bufferSize, const char *cachePath, U64 scriptHash)
+{
+   dSprintf(buffer, bufferSize, "%s/%08x%08x.dso", cachePath, U32(scriptHash >> 32), U32(scriptHash));
+}
+
+//-----------------------------------------------------------------------------
+
+bool isEnabled()
+{
+   return *Con::getVariable("$Scripts::cachePath") != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+U64 hashScript(const char *script, U32 scriptSize)
+{
+   U8 *data = (U8 *)script;
+   const U32 low = hash(data, scriptSize, 0);
+   const U32 high = hash(data, scriptSize, low);
+   return (U64(high) << 32) | low;
+}
+
+//-----------------------------------------------------------------------------
+
+CodeBlock *load(StringTableEntry fileName, const char *script, U32 scriptSize)
+{
+   const U64 scriptHash = hashScript(script, scriptSize);
+
+   char cachePath[1024];
+   char cacheFileName[1024];
+   getCachePath(cachePath, sizeof(cachePath));
+   getCacheFileName(cacheFileName, sizeof(cacheFileName), cachePath, scriptHash);
+
+   // Map the cache file.  Tagged strings are converted in place so the view must be writable.
+   File *file = new File;
+   const U8 *data = NULL;
+   U32 size = 0;
+   if(file->open(cacheFileName, File::Read) == File::Ok)
+      data = file->map(&size, true);
+
+   if(data == NULL || size < CacheHeaderSize)
+   {
+      delete file;
+      return NULL;
+   }
+
+   MemStream st(size, const_cast<U8 *>(data), true, false);
+
+   U32 fileId, version, hashLow, hashHigh, sourceSize;
+   st.read(&fileId);
+   st.read(&version);
+   st.read(&hashLow);
+   st.read(&hashHigh);
+   st.read(&sourceSize);
+
+   if(fileId != CacheFileId || version != DSO_VERSION || hashLow != U32(scriptHash) || hashHigh != U32(scriptHash >> 32) || sourceSize != scriptSize)
+   {
+      if(fileId == CacheFileId && version != DSO_VERSION)
+         Con::warnf("CompiledScriptCache::load - Found an old cached script (%s, ver %d < %d), ignoring.", cacheFileName, version, DSO_VERSION);
+
+      delete file;
+      return NULL;
+   }
+
+   // The code block owns the file from here.
+   CodeBlock *code = new CodeBlock;
+   code->read(fileName, st, file);
+   return code;
+}
+
+//-----------------------------------------------------------------------------
+
+bool store(StringTableEntry fileName, const char *script, U32 scriptSize)
+{
+   CodeBlock *code = new CodeBlock;
+   if(!code->parseScript(fileName, script))
+   {
+      delete code;
+      return false;
+   }
+
+   const U64 scriptHash = hashScript(script, scriptSize);
+
+   char cachePath[1024];
+   char cacheFileName[1024];
+   char tempFileName[1024];
+   getCachePath(cachePath, sizeof(cachePath));
+   getCacheFileName(cacheFileName, sizeof(cacheFileName), cachePath, scriptHash);
+   dSprintf(tempFileName, sizeof(tempFileName), "%s.tmp", cacheFileName);
+
+   FileStream st;
+   if(!Platform::createPath(tempFileName) || !st.open(tempFileName, FileStream::Write))
+   {
+      Con::warnf("CompiledScriptCache::store - Unable to write '%s'.", tempFileName);
+      Compiler::consoleAllocReset();
+      delete code;
+      return false;
+   }
+
+   st.write(U32(CacheFileId));
+   st.write(DSO_VERSION);
+   st.write(U32(scriptHash));
+   st.write(U32(scriptHash >> 32));
+   st.write(scriptSize);
+   code->writeCompiled(st);
+   st.close();
+   delete code;
+
+   // Move the file into place so a partly written one is never loaded.
+   if(Platform::isFile(cacheFileName))
+      Platform::fileDelete(cacheFileName);
+
+   if(!Platform::fileRename(tempFileName, cacheFileName))
+   {
+      Platform::fileDelete(tempFileName);
+      return false;
+   }
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+/// A script read and checked against the cache by a PrepareThread.
+struct PrepareJob
+{
+   const char *mFileName;
+   char *mScript;
+   U32 mScriptSize;
+   bool mCached;
+   volatile U32 mReady;
+};
+
+/// Reads scripts and checks whether they are cached.
+class PrepareThread : public Thread
+{
+   PrepareJob *mJobs;
+   U32 mJobCount;
+   volatile S32 *mNextJob;
+   const char *mCachePath;
+
+public:
+   PrepareThread(PrepareJob *jobs, U32 jobCount, volatile S32 *nextJob, const char *cachePath) :
+      Thread(0, NULL, false), mJobs(jobs), mJobCount(jobCount), mNextJob(nextJob), mCachePath(cachePath)
+   {
+   }
+
+   virtual void run(void *arg)
+   {
+      for(;;)
+      {
+         const U32 jobIndex = (U32)dAtomicIncrement(*mNextJob) - 1;
+         if(jobIndex >= mJobCount)
+            break;
+
+         PrepareJob &job = mJobs[jobIndex];
+
+         // Read the source.
+         File file;
+         if(file.open(job.mFileName, File::Read) == File::Ok)
+         {
+            const U32 size = file.getSize();
+            job.mScript = (char *)malloc(size + 1);
+            if(file.read(size, job.mScript) == File::Ok)
+            {
+               job.mScript[size] = 0;
+               job.mScriptSize = size;
+            }
+            else
+            {
+               free(job.mScript);
+               job.mScript = NULL;
+            }
+            file.close();
+         }
+
+         // Is it cached?
+         if(job.mScript)
+         {
+            char cacheFileName[1024];
+            getCacheFileName(cacheFileName, sizeof(cacheFileName), mCachePath, hashScript(job.mScript, job.mScriptSize));
+            job.mCached = file.open(cacheFileName, File::Read) == File::Ok;
+            file.close();
+         }
+
+         dAtomicWrite(job.mReady, 1);
+      }
+
+      FrameAllocator::releaseThread();
+      TraceProfiler::releaseThread();
+   }
+};
+
+U32 prepare(const char *path)
+{
+   if(!isEnabled())
+      return 0;
+
+   char cachePath[1024];
+   getCachePath(cachePath, sizeof(cachePath));
+
+   // Find the scripts.
+   Vector<Platform::FileInfo> files;
+   if(!Platform::dumpPath(path, files))
+      return 0;
+
+   Vector<PrepareJob> jobs;
+   for(S32 i = 0; i < files.size(); i++)
+   {
+      if(!Platform::hasExtension(files[i].pFileName, ".cs") && !Platform::hasExtension(files[i].pFileName, ".gui"))
+         continue;
+
+      char fileName[1024];
+      dSprintf(fileName, sizeof(fileName), "%s/%s", files[i].pFullPath, files[i].pFileName);
+
+      PrepareJob job;
+      job.mFileName = StringTable->insert(fileName, true);
+      job.mScript = NULL;
+      job.mScriptSize = 0;
+      job.mCached = false;
+      job.mReady = 0;
+      jobs.push_back(job);
+   }
+
+   if(jobs.empty())
+      return 0;
+
+   // Read and hash on the workers.
+   volatile S32 nextJob = 0;
+   const S32 threadVariable = Con::getIntVariable("$Scripts::cacheThreads", 4);
+   const U32 threadCount = threadVariable > 0 ? threadVariable : 1;
+   Vector<PrepareThread *> threads;
+   for(U32 i = 0; i < threadCount; i++)
+   {
+      threads.push_back(new PrepareThread(jobs.address(), jobs.size(), &nextJob, cachePath));
+      threads.last()->start();
+   }
+
+   // Compile what isn't cached in order as the jobs finish.
+   U32 compiledCount = 0;
+   for(S32 i = 0; i < jobs.size(); i++)
+   {
+      PrepareJob &job = jobs[i];
+      while(!dAtomicRead(job.mReady))
+         Platform::sleep(0);
+
+      if(job.mScript && !job.mCached)
+      {
+         if(store(job.mFileName, job.mScript, job.mScriptSize))
+            compiledCount++;
+      }
+
+      free(job.mScript);
+   }
+
+   for(S32 i = 0; i < threads.size(); i++)
+   {
+      threads[i]->join();
+      delete threads[i];
+   }
+
+   return compiledCount;
+}
+
+} // end namespace CompiledScriptCache
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(prepareScriptCache, S32, 2, 2, "(path) Compile every script under a path that is not in the compiled script cache.\n"
+                "@param path The directory to search.\n"
+                "@return The number of scripts compiled.")
+{
+   char pathBuffer[1024];
+   Con::expandPath(pathBuffer, sizeof(pathBuffer), argv[1]);
+
+   return CompiledScriptCache::prepare(pathBuffer);
+}
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _COMPILED_SCRIPT_CACHE_H_
+#define _COMPILED_SCRIPT_CACHE_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+class CodeBlock;
+
+//-----------------------------------------------------------------------------
+
+/// A cache of compiled scripts keyed by the hash of their source.
+///
+/// The cache is enabled by setting $Scripts::cachePath to a directory. Each
+/// compiled script is stored there as "<hash>.dso" so the cache is valid no
+/// matter where the sources live or what their timestamps are, and it can be
+/// shipped read-only. Cached scripts are mapped and their string tables used
+/// in place.
+namespace CompiledScriptCache
+{
+   /// Whether $Scripts::cachePath is set.
+   bool isEnabled();
+
+   /// Hash a script's source.
+   U64 hashScript(const char *script, U32 scriptSize);
+
+   /// Load the cached code for a script.
+   /// @return The code ready to execute, or NULL if the script is not cached.
+   CodeBlock *load(StringTableEntry fileName, const char *script, U32 scriptSize);
+
+   /// Compile a script into the cache.
+   /// @return False if the script has a syntax error or the cache could not be written.
+   bool store(StringTableEntry fileName, const char *script, U32 scriptSize);
+
+   /// Compile every script under a path that is not already cached.
+   ///
+   /// The sources are read and hashed on $Scripts::cacheThreads worker threads
+   /// (4 by default) while the calling thread compiles those that are missing
+   /// from the cache. The compiler is not thread safe so compiling is serial.
+   ///
+   /// @param path The directory to search.
+   /// @return The number of scripts compiled.
+   U32 prepare(const char *path);
+}
+
+#endif // _COMPILED_SCRIPT_CACHE_H_
@@ -93,6 +93,14 @@ namespace Compiler
       OP_SAVEVAR_FLT,
       OP_SAVEVAR_STR,
 
+      OP_SETCURVAR_LOADVAR_UINT,
+      OP_SETCURVAR_LOADVAR_FLT,
+      OP_SETCURVAR_LOADVAR_STR,
+
+      OP_SETCURVAR_CREATE_SAVEVAR_UINT,
+      OP_SETCURVAR_CREATE_SAVEVAR_FLT,
+      OP_SETCURVAR_CREATE_SAVEVAR_STR,
+
       OP_SETCUROBJECT,
       OP_SETCUROBJECT_NEW,
       OP_SETCUROBJECT_INTERNAL,
@@ -36,7 +36,11 @@
 #include "string/stringStack.h"
 #include "component/dynamicConsoleMethodComponent.h"
 #include "memory/safeDelete.h"
+#include "memory/frameAllocator.h"
+#include "debug/traceProfiler.h"
+#include "platform/threads/lockFreeQueue.h"
 #include <stdarg.h>
+#include <stdlib.h> // log lines cross threads so use malloc and free directly
 
 #ifndef _HASHTABLE_H
 #include "collection/hashTable.h"
@@ -193,10 +197,12 @@ namespace Con
 {
 
 static Vector<ConsumerCallback> gConsumers(__FILE__, __LINE__);
-static DataChunker consoleLogChunker;
 static Vector<ConsoleLogEntry> consoleLog(__FILE__, __LINE__);
 static bool consoleLogLocked;
 static bool logBufferEnabled=true;
+static S32 logBufferSize = 10000;
+static S32 logLevel = ConsoleLogEntry::Normal;
+static bool asyncLog = true;
 static S32 printLevel = 10;
 static FileStream consoleLogFile;
 static const char *defLogFileName = "console.log";
@@ -212,6 +218,133 @@ static SimObjectPtr<SimObject> tabObject;
 static U32 completionBaseStart;
 static U32 completionBaseLen;
 
+//------------------------------------------------------------------------------
+
+/// Write lines to the log file, opening and closing it around the batch in log mode 1.
+/// Set flushFile to push the lines to disk straight away in log mode 2.
+static void writeLogBatch(const char * const *lines, U32 count, const bool flushFile = false)
+{
+   // Lock.
+   MutexHandle mutex;
+   if( sLogMutex )
+      mutex.lock( sLogMutex, true );
+
+   // In mode 1, we open, append, close on each batch.
+   if ((consoleLogMode & 0x3) == 1) 
+   {
+      consoleLogFile.open(defLogFileName, FileStream::ReadWrite);
+   }
+
+   // Write to the log if its status is hunky-dory.
+   if ((consoleLogFile.getStatus() == Stream::Ok) || (consoleLogFile.getStatus() == Stream::EOS)) 
+   {
+      consoleLogFile.setPosition(consoleLogFile.getStreamSize());
+      for (U32 line = 0; line < count; line++)
+      {
+         consoleLogFile.write(dStrlen(lines[line]), lines[line]);
+         consoleLogFile.write(2, "\r\n");
+      }
+
+      if (flushFile && (consoleLogMode & 0x3) == 2)
+         consoleLogFile.Flush();
+   }
+
+   if ((consoleLogMode & 0x3) == 1) 
+   {
+      consoleLogFile.close();
+   }
+}
+
+//------------------------------------------------------------------------------
+
+/// Writes log lines on a background thread so printing never waits on the file.
+///
+/// Any thread can queue lines.  The writer wakes periodically and writes
+/// everything queued since it last ran as a single batch.  A thread that
+/// needs the lines on disk, or finds the queue full, writes them itself
+/// rather than waiting for the writer to wake.
+class ConsoleLogWriter : public Thread
+{
+   enum
+   {
+      QueueSize = 4096,    ///< Lines that can be queued before producers write them.
+      BatchSize = 256,     ///< Lines written per batch.
+      SleepMS = 20,        ///< How long the writer sleeps between batches.
+   };
+
+   LockFreeMPSCQueue<char*>   mQueue;
+
+   /// Only one thread may pop from the queue, and it must write what it
+   /// pops before another thread pops more, to keep the file in order.
+   Mutex                      mWriteMutex;
+
+   /// Write everything queued.
+   void writeQueued()
+   {
+      MutexHandle mutex;
+      mutex.lock(&mWriteMutex, true);
+
+      char* lines[BatchSize];
+      U32 count = 0;
+
+      while (mQueue.pop(lines[count]))
+      {
+         if (++count < BatchSize)
+            continue;
+
+         writeLogBatch(lines, count);
+         for (U32 line = 0; line < count; line++)
+            free(lines[line]);
+
+         count = 0;
+      }
+
+      if (count > 0)
+      {
+         writeLogBatch(lines, count);
+         for (U32 line = 0; line < count; line++)
+            free(lines[line]);
+      }
+   }
+
+public:
+   ConsoleLogWriter() : Thread(0, NULL, false), mQueue(QueueSize)
+   {
+   }
+
+   /// Queue a line for writing.  Writes the queue if it is full.
+   void push(const char *string)
+   {
+      const U32 length = dStrlen(string);
+      char *line = (char *)malloc(length + 1);
+      dMemcpy(line, string, length + 1);
+
+      while (!mQueue.push(line))
+         writeQueued();
+   }
+
+   /// Write every queued line on the calling thread.
+   void flush()
+   {
+      writeQueued();
+   }
+
+   virtual void run(void *arg)
+   {
+      while (!checkForStop())
+      {
+         writeQueued();
+         Platform::sleep(SleepMS);
+      }
+
+      writeQueued();
+      FrameAllocator::releaseThread();
+      TraceProfiler::releaseThread();
+   }
+};
+
+static ConsoleLogWriter *sLogWriter = NULL;
+
 #ifdef TORQUE_MULTITHREAD
 static S32 gMainThreadID = -1;
 #endif
@@ -232,7 +365,8 @@ ConsoleFunction( cls, void, 1, 1, "() Use the cls function to clear the console
 {
    if(consoleLogLocked)
       return;
-   consoleLogChunker.freeBlocks();
+   for(U32 i = 0; i < (U32)consoleLog.size(); i++)
+      dFree(const_cast<char*>(consoleLog[i].mString));
    consoleLog.setSize(0);
 };
 
@@ -279,6 +413,9 @@ void init()
    // Variables
    setVariable("Con::prompt", "% ");
    addVariable("Con::logBufferEnabled", TypeBool, &logBufferEnabled);
+   addVariable("Con::logBufferSize", TypeS32, &logBufferSize);
+   addVariable("Con::logLevel", TypeS32, &logLevel);
+   addVariable("Con::asyncLog", TypeBool, &asyncLog);
    addVariable("Con::printLevel", TypeS32, &printLevel);
    addVariable("Con::warnUndefinedVariables", TypeBool, &gWarnUndefinedScriptVariables);
 
@@ -291,6 +428,10 @@ void init()
 
    // And finally, the ACR...
    AbstractClassRep::initialize();
+
+   // Start the log writer.
+   sLogWriter = new ConsoleLogWriter;
+   sLogWriter->start();
 }
 
 //--------------------------------------
@@ -300,6 +441,17 @@ void shutdown()
    AssertFatal(active == true, "Con::shutdown should only be called once.");
    active = false;
 
+   // Write out anything still queued.
+   sLogWriter->stop();
+   sLogWriter->join();
+   SAFE_DELETE( sLogWriter );
+
+   // Release the in-memory log.
+   for(U32 i = 0; i < (U32)consoleLog.size(); i++)
+      dFree(const_cast<char*>(consoleLog[i].mString));
+   consoleLog.clear();
+   consoleLog.compact();
+
    consoleLogFile.close();
    Namespace::shutdown();
 
@@ -448,69 +600,81 @@ U32 tabComplete(char* inputBuffer, U32 cursorPos, U32 maxResultLength, bool forw
 }
 
 //------------------------------------------------------------------------------
-static void log(const char *string)
+/// Write a line to the log file.  Synchronous lines are on disk before this
+/// returns, so nothing logged ahead of an assert or crash is lost.
+static void logLine(const char *string, const bool sync = false)
 {
-   // Lock.
-   MutexHandle mutex;
-   if( sLogMutex )
-      mutex.lock( sLogMutex, true );
+   if (asyncLog && sLogWriter && !sync)
+   {
+      sLogWriter->push(string);
+   }
+   else
+   {
+      // Keep the file in order if we were writing asynchronously.
+      if (sLogWriter)
+         sLogWriter->flush();
+      writeLogBatch(&string, 1, sync);
+   }
+}
 
+static void log(ConsoleLogEntry::Level level, const char *string)
+{
    // Bail if we ain't logging.
    if (!consoleLogMode) 
    {
       return;
    }
 
-   // In mode 1, we open, append, close on each log write.
-   if ((consoleLogMode & 0x3) == 1) 
-   {
-      consoleLogFile.open(defLogFileName, FileStream::ReadWrite);
-   }
-
-   // Write to the log if its status is hunky-dory.
-   if ((consoleLogFile.getStatus() == Stream::Ok) || (consoleLogFile.getStatus() == Stream::EOS)) 
+   // If this is the first write...
+   if (newLogFile) 
    {
-      consoleLogFile.setPosition(consoleLogFile.getStreamSize());
-      // If this is the first write...
-      if (newLogFile) 
+      // Make a header.
+      Platform::LocalTime lt;
+      Platform::getLocalTime(lt);
+      char buffer[128];
+      dSprintf(buffer, sizeof(buffer), "//-------------------------- %d/%d/%d -- %02d:%02d:%02d -----",
+            lt.month + 1,
+            lt.monthday,
+            lt.year + 1900,
+            lt.hour,
+            lt.min,
+            lt.sec);
+      logLine(buffer);
+      newLogFile = false;
+      if (consoleLogMode & 0x4) 
       {
-         // Make a header.
-         Platform::LocalTime lt;
-         Platform::getLocalTime(lt);
-         char buffer[128];
-         dSprintf(buffer, sizeof(buffer), "//-------------------------- %d/%d/%d -- %02d:%02d:%02d -----\r\n",
-               lt.month + 1,
-               lt.monthday,
-               lt.year + 1900,
-               lt.hour,
-               lt.min,
-               lt.sec);
-         consoleLogFile.write(dStrlen(buffer), buffer);
-         newLogFile = false;
-         if (consoleLogMode & 0x4) 
-         {
-            // Dump anything that has been printed to the console so far.
-            consoleLogMode -= 0x4;
-            U32 size, line;
-            ConsoleLogEntry *log;
-            getLockLog(log, size);
-            for (line = 0; line < size; line++) 
-            {
-               consoleLogFile.write(dStrlen(log[line].mString), log[line].mString);
-               consoleLogFile.write(2, "\r\n");
-            }
-            unlockLog();
-         }
+         // Dump anything that has been printed to the console so far.
+         consoleLogMode -= 0x4;
+         U32 size, line;
+         ConsoleLogEntry *log;
+         getLockLog(log, size);
+         for (line = 0; line < size; line++) 
+            logLine(log[line].mString);
+         unlockLog();
       }
-      // Now write what we came here to write.
-      consoleLogFile.write(dStrlen(string), string);
-      consoleLogFile.write(2, "\r\n");
    }
 
-   if ((consoleLogMode & 0x3) == 1) 
-   {
-      consoleLogFile.close();
-   }
+   // Now write what we came here to write.  Errors (including asserts) are
+   // written straight away in case we are about to go down.
+   logLine(string, level == ConsoleLogEntry::Error);
+}
+
+//------------------------------------------------------------------------------
+
+/// Drop the oldest entries once the in-memory log grows past Con::logBufferSize.
+static void trimLogBuffer()
+{
+   const U32 size = consoleLog.size();
+   if (logBufferSize <= 0 || size <= (U32)logBufferSize || consoleLogLocked)
+      return;
+
+   // Drop an extra quarter of the buffer so trimming doesn't happen on every line.
+   const U32 drop = getMin(size, size - logBufferSize + logBufferSize / 4);
+   for (U32 i = 0; i < drop; i++)
+      dFree(const_cast<char*>(consoleLog[i].mString));
+
+   dMemmove(consoleLog.address(), consoleLog.address() + drop, (size - drop) * sizeof(ConsoleLogEntry));
+   consoleLog.setSize(size - drop);
 }
 
 //------------------------------------------------------------------------------
@@ -578,20 +742,21 @@ static void _printf(ConsoleLogEntry::Level level, ConsoleLogEntry::Type type, co
          if(eofPos)
             *eofPos = 0;
 
-         log(pos);
+         log(level, pos);
          if(logBufferEnabled && !consoleLogLocked)
          {
             ConsoleLogEntry entry;
             entry.mLevel  = level;
             entry.mType   = type;
-            entry.mString = (const char *)consoleLogChunker.alloc(dStrlen(pos) + 1);
-            dStrcpy(const_cast<char*>(entry.mString), pos);
+            entry.mString = dStrdup(pos);
             consoleLog.push_back(entry);
          }
          if(!eofPos)
             break;
          pos = eofPos + 1;
       }
+
+      trimLogBuffer();
    }
 
    Con::active = true;
@@ -653,6 +818,10 @@ public:
 //------------------------------------------------------------------------------
 void printf(const char* fmt,...)
 {
+   // Filter before paying for the formatting.
+   if(logLevel > ConsoleLogEntry::Normal)
+      return;
+
    va_list argptr;
    va_start(argptr, fmt);
    char buf[8192];
@@ -666,6 +835,10 @@ void printf(const char* fmt,...)
 
 void warnf(ConsoleLogEntry::Type type, const char* fmt,...)
 {
+   // Filter before paying for the formatting.
+   if(logLevel > ConsoleLogEntry::Warning)
+      return;
+
    va_list argptr;
    va_start(argptr, fmt);
    char buf[8192];
@@ -692,6 +865,10 @@ void errorf(ConsoleLogEntry::Type type, const char* fmt,...)
 
 void warnf(const char* fmt,...)
 {
+   // Filter before paying for the formatting.
+   if(logLevel > ConsoleLogEntry::Warning)
+      return;
+
    va_list argptr;
    va_start(argptr, fmt);
    char buf[8192];
@@ -1127,6 +1304,10 @@ void setLogMode(S32 newMode)
 {
    if ((newMode & 0x3) != (consoleLogMode & 0x3))
    {
+      // Finish writing with the current mode.
+      if (sLogWriter)
+         sLogWriter->flush();
+
       if (newMode && !consoleLogMode)
       {
          // Enabling logging when it was previously disabled.
@@ -1146,6 +1327,11 @@ void setLogMode(S32 newMode)
    }
 }
 
+S32 getLogMode()
+{
+   return consoleLogMode;
+}
+
 Namespace *lookupNamespace(const char *ns)
 {
    if(!ns)
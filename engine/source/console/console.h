@@ -196,7 +196,8 @@ namespace Con
       //  02/16/07 - THB - 40->41 newmsg operator
       //  02/16/07 - PAUP - 41->42 DSOs are read with a pointer before every string(ASTnodes changed). Namespace and HashTable revamped
       //  05/17/10 - Luma - 42-43 Adding proper sceneObject physics flags, fixes in general
-      DSOVersion = 43,
+      //  10/19/26 - 43->44 Constant folding and fused variable load/store opcodes
+      DSOVersion = 44,
       MaxLineLength = 512,  ///< Maximum length of a line of console input.
       MaxDataTypes = 256    ///< Maximum number of registered data types.
    };
@@ -225,7 +226,7 @@ namespace Con
    /// Shuts down the console.
    ///
    /// This performs the following steps:
-   ///   - Closes the console log file.
+   ///   - Writes out any queued log lines and closes the console log file.
    ///   - Calls Namespace::shutdown() to shut down the scripting namespace hierarchy.
    void shutdown();
 
@@ -605,11 +606,20 @@ namespace Con
    /// @}
 
    /// @name Logging
+   ///
+   /// Log file writes are queued and written in batches by a background
+   /// thread unless $Con::asyncLog is false.  Errors are always written
+   /// before errorf returns so the log is complete if an assert or crash
+   /// follows.  The in-memory log used by the
+   /// GuiConsole keeps at most $Con::logBufferSize lines (zero for no limit),
+   /// and messages below $Con::logLevel (0 normal, 1 warnings, 2 errors) are
+   /// dropped before they are formatted.
    /// @{
 
    void getLockLog(ConsoleLogEntry * &log, U32 &size);
    void unlockLog(void);
    void setLogMode(S32 mode);
+   S32 getLogMode(void);
 
    /// @}
 
@@ -27,6 +27,7 @@
 #include "io/resource/resourceManager.h"
 #include "io/fileStream.h"
 #include "console/compiler.h"
+#include "console/compiledScriptCache.h"
 #include "platform/event.h"
 #include "game/gameInterface.h"
 #include "platform/platformInput.h"
@@ -954,6 +955,15 @@ ConsoleFunction(compile, bool, 2, 2, "( fileName ) Use the compile function to p
 #if defined(TORQUE_DEBUG)
    Con::printf("Compiling %s...", pathBuffer);
 #endif
+
+   // Compile into the cache if there is one.
+   if(CompiledScriptCache::isEnabled())
+   {
+      const bool cached = CompiledScriptCache::store(StringTable->insert(pathBuffer), script, scriptSize);
+      delete[] script;
+      return cached;
+   }
+
    CodeBlock *code = new CodeBlock();
    code->compile(nameBuffer, pathBuffer, script);
    delete code;
@@ -1178,6 +1188,61 @@ ConsoleFunction(exec, bool, 2, 4, "( fileName [ , nocalls [ , journalScript ] ]
    }
 #endif //TORQUE_ALLOW_JOURNALING
 
+   // Use the compiled script cache if there is one.  It is keyed by the source
+   // so the source is always read, but it is only parsed when it has changed.
+   if(compiled && CompiledScriptCache::isEnabled())
+   {
+      Stream *s = ResourceManager->openStream(scriptFileName);
+      if(s)
+      {
+         const U32 cacheScriptSize = ResourceManager->getSize(scriptFileName);
+         char *cacheScript = new char[cacheScriptSize + 1];
+         s->read(cacheScriptSize, cacheScript);
+         ResourceManager->closeStream(s);
+         cacheScript[cacheScriptSize] = 0;
+
+         F32 st1 = (F32)Platform::getRealMilliseconds();
+
+         CodeBlock *code = CompiledScriptCache::load(scriptFileName, cacheScript, cacheScriptSize);
+         if(code == NULL)
+         {
+            #if defined(TORQUE_DEBUG)
+            Con::printf("Compiling %s...", scriptFileName);
+            #endif
+            if(CompiledScriptCache::store(scriptFileName, cacheScript, cacheScriptSize))
+               code = CompiledScriptCache::load(scriptFileName, cacheScript, cacheScriptSize);
+         }
+
+         if(code)
+         {
+            delete [] cacheScript;
+            code->exec(0, scriptFileName, NULL, 0, NULL, noCalls, NULL, 0);
+         }
+         else if(Compiler::gSyntaxError)
+         {
+            // The errors have already been reported.
+            delete [] cacheScript;
+            execDepth--;
+            return false;
+         }
+         else
+         {
+            // The cache can't be written so run the source.
+            CodeBlock *newCodeBlock = new CodeBlock();
+            newCodeBlock->compileExec(scriptFileName, cacheScript, noCalls, 0);
+            delete [] cacheScript;
+         }
+
+         F32 et1 = (F32)Platform::getRealMilliseconds();
+
+         if ( scriptExecutionEcho )
+            Con::printf("Loaded cached script %s. Took %.0f ms", scriptFileName, et1 - st1);
+
+         execDepth--;
+         return true;
+      }
+   }
+
    // Ok, we let's try to load and compile the script.
    ResourceObject *rScr = ResourceManager->find(scriptFileName);
    ResourceObject *rCom = NULL;
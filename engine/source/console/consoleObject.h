@@ -415,7 +415,7 @@ public:
     }
 
     /// Wrap constructor.
-    ConsoleObject* create() const { return new T; }
+    ConsoleObject* create() const { return constructInPlace( (T*)T::allocateInstance( sizeof(T), this ) ); }
 };
 
 //-----------------------------------------------------------------------------
@@ -501,6 +501,11 @@ public:
     /// @{
     static ConsoleObject* create(const char*  in_pClassName);
     static ConsoleObject* create(const U32 groupId, const U32 typeId, const U32 in_classId);
+
+    /// Allocate the memory for an instance created by its class rep.
+    ///
+    /// A class can hide this to allocate by type, in which case its operator delete must free it.
+    static void* allocateInstance( const dsize_t size, const AbstractClassRep* pClassRep ) { return ::operator new( size ); }
     /// @}
 
 public:
@@ -25,6 +25,10 @@
 
 #include "torqueConfig.h"
 
+#ifndef _TRACE_PROFILER_H_
+#include "debug/traceProfiler.h"
+#endif
+
 #ifdef TORQUE_ENABLE_PROFILER
 
 struct ProfilerData;
@@ -151,17 +155,20 @@ struct ProfilerData
 #undef PROFILE_START
 #define PROFILE_START(name) \
 static ProfilerRootData pdata##name##obj (#name); \
+TraceProfiler::begin(#name); \
 if(gProfiler) gProfiler->hashPush(& pdata##name##obj )
 
 #undef PROFILE_END
-#define PROFILE_END() if(gProfiler) gProfiler->hashPop()
+#define PROFILE_END() TraceProfiler::end(); if(gProfiler) gProfiler->hashPop()
 
 class ScopedProfiler {
 public:
    ScopedProfiler(ProfilerRootData *data) {
+      TraceProfiler::begin(data->mName);
       if (gProfiler) gProfiler->hashPush(data);
    }
    ~ScopedProfiler() {
+      TraceProfiler::end();
       if (gProfiler) gProfiler->hashPop();
    }
 };
@@ -171,6 +178,18 @@ public:
    static ProfilerRootData pdata##name##obj (#name); \
    ScopedProfiler scopedProfiler##name##obj(&pdata##name##obj);
 
+#elif !defined(TORQUE_DISABLE_TRACE_PROFILER)
+
+// Without the Profiler the macros only feed the TraceProfiler.
+#undef PROFILE_START
+#define PROFILE_START(name) TraceProfiler::begin(#name)
+
+#undef PROFILE_END
+#define PROFILE_END() TraceProfiler::end()
+
+#undef PROFILE_SCOPE
+#define PROFILE_SCOPE(name) TraceProfiler::Scope traceScope##name##obj(#name)
+
 #endif
 
 #endif
@@ -0,0 +1,359 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "platform/platform.h"
+#include "debug/traceProfiler.h"
+#include "platform/platformTLS.h"
+#include "platform/threads/atomic.h"
+#include "platform/threads/thread.h"
+#include "math/mMathFn.h"
+#include "collection/vector.h"
+#include "io/fileStream.h"
+#include "console/console.h"
+
+//-----------------------------------------------------------------------------
+
+/// A per-thread ring of events.  Only the owning thread writes to it; the
+/// exporter reads it without locking and discards anything overwritten while
+/// it was reading.  Buffers are never freed.  A buffer given up by
+/// releaseThread() keeps its events until another thread takes it over.
+struct TraceProfiler::ThreadBuffer
+{
+   volatile U32   mActive; ///< Owned by a running thread.
+   U32            mThreadId;
+   Event*         mEvents;
+   volatile U32   mHead;   ///< Number of events written (owned by the thread).
+   ThreadBuffer*  mNext;
+};
+
+bool TraceProfiler::smEnabled = false;
+TraceProfiler::ThreadBuffer* volatile TraceProfiler::smBufferList = NULL;
+U64 TraceProfiler::smEnableTime = 0;
+U64 TraceProfiler::smLastFrameTime = 0;
+U32 TraceProfiler::smHitchThreshold = 0;
+char TraceProfiler::smHitchFileName[256] = "";
+
+//-----------------------------------------------------------------------------
+
+static ThreadStorage& getBufferStorage()
+{
+   // Constructed on first use by setEnabled(), before any thread can record.
+   static ThreadStorage sBufferStorage;
+   return sBufferStorage;
+}
+
+//-----------------------------------------------------------------------------
+
+TraceProfiler::ThreadBuffer* TraceProfiler::getThreadBuffer()
+{
+   ThreadBuffer* pBuffer = static_cast<ThreadBuffer*>( getBufferStorage().get() );
+   if ( pBuffer != NULL )
+      return pBuffer;
+
+   // First event on this thread.  Take over the buffer of a thread that has
+   // exited if there is one, otherwise create a new one.
+   for ( pBuffer = smBufferList; pBuffer != NULL; pBuffer = pBuffer->mNext )
+   {
+      if ( dAtomicCompareAndSwap( pBuffer->mActive, 0, 1 ) )
+         break;
+   }
+
+   if ( pBuffer != NULL )
+   {
+      // Drop the events of the previous thread.
+      pBuffer->mThreadId = ThreadManager::getCurrentThreadId();
+      dAtomicWrite( pBuffer->mHead, 0 );
+   }
+   else
+   {
+      pBuffer = new ThreadBuffer;
+      pBuffer->mActive = 1;
+      pBuffer->mThreadId = ThreadManager::getCurrentThreadId();
+      pBuffer->mEvents = new Event[BufferEvents];
+      pBuffer->mHead = 0;
+
+      // Publish it to the exporter.
+      do
+      {
+         pBuffer->mNext = smBufferList;
+      }
+      while ( !dAtomicCompareAndSwapPtr( smBufferList, pBuffer->mNext, pBuffer ) );
+   }
+
+   getBufferStorage().set( pBuffer );
+   return pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+
+void TraceProfiler::record( const char* name, const U32 type, const F32 value )
+{
+   ThreadBuffer* pBuffer = getThreadBuffer();
+
+   const U32 head = pBuffer->mHead;
+   Event& event = pBuffer->mEvents[head & (BufferEvents - 1)];
+   event.mName = name;
+   event.mTime = Platform::getRealMicroseconds();
+   event.mValue = value;
+   event.mType = type;
+
+   dAtomicWrite( pBuffer->mHead, head + 1 );
+}
+
+//-----------------------------------------------------------------------------
+
+void TraceProfiler::releaseThread( void )
+{
+   // Nothing to do if the profiler was never enabled.
+   if ( smBufferList == NULL )
+      return;
+
+   ThreadBuffer* pBuffer = static_cast<ThreadBuffer*>( getBufferStorage().get() );
+   if ( pBuffer == NULL )
+      return;
+
+   getBufferStorage().set( NULL );
+   dAtomicWrite( pBuffer->mActive, 0 );
+}
+
+//-----------------------------------------------------------------------------
+
+U32 TraceProfiler::getBufferCount( void )
+{
+   U32 count = 0;
+   for ( ThreadBuffer* pBuffer = smBufferList; pBuffer != NULL; pBuffer = pBuffer->mNext )
+      count++;
+
+   return count;
+}
+
+//-----------------------------------------------------------------------------
+
+void TraceProfiler::setEnabled( const bool enabled )
+{
+   // Ignore no change.
+   if ( enabled == smEnabled )
+      return;
+
+   if ( enabled )
+   {
+      getBufferStorage();
+      smEnableTime = Platform::getRealMicroseconds();
+      smLastFrameTime = 0;
+   }
+
+   smEnabled = enabled;
+}
+
+//-----------------------------------------------------------------------------
+
+void TraceProfiler::markFrame( void )
+{
+   if ( !smEnabled )
+      return;
+
+   const U64 now = Platform::getRealMicroseconds();
+
+   // Export the frame that just finished if it was a hitch.
+   if ( smHitchThreshold > 0 && smLastFrameTime > 0 && now - smLastFrameTime > (U64)smHitchThreshold * 1000 )
+   {
+      smHitchThreshold = 0;
+      Con::warnf( "TraceProfiler::markFrame() - Captured a %.1fms frame to '%s'.", F32(now - smLastFrameTime) / 1000.0f, smHitchFileName );
+      exportTrace( smHitchFileName, 2 );
+   }
+
+   smLastFrameTime = now;
+   record( "Frame", EventFrame, 0.0f );
+}
+
+//-----------------------------------------------------------------------------
+
+void TraceProfiler::captureHitch( const U32 thresholdMs, const char* fileName )
+{
+   dStrncpy( smHitchFileName, fileName, sizeof(smHitchFileName) - 1 );
+   smHitchFileName[sizeof(smHitchFileName) - 1] = '\0';
+   smHitchThreshold = thresholdMs;
+}
+
+//-----------------------------------------------------------------------------
+
+static void writeString( FileStream& stream, const char* string )
+{
+   stream.write( dStrlen(string), string );
+}
+
+//-----------------------------------------------------------------------------
+
+bool TraceProfiler::exportTrace( const char* fileName, const U32 frames )
+{
+   Vector<Event> events;
+   Vector<U32> threadStart;
+   Vector<U32> threadIds;
+
+   // Snapshot every thread's ring.  Threads keep recording while we copy so
+   // anything that may have been overwritten during the copy is dropped.
+   for ( ThreadBuffer* pBuffer = smBufferList; pBuffer != NULL; pBuffer = pBuffer->mNext )
+   {
+      const U32 head = dAtomicRead( pBuffer->mHead );
+      const U32 count = getMin( head, (U32)BufferEvents );
+      const U32 first = head - count;
+      const U32 start = events.size();
+
+      events.increment( count );
+      for ( U32 index = 0; index < count; index++ )
+         events[start + index] = pBuffer->mEvents[(first + index) & (BufferEvents - 1)];
+
+      const U32 written = dAtomicRead( pBuffer->mHead ) - first;
+      const U32 dropped = written > (U32)BufferEvents ? getMin( written - (U32)BufferEvents, count ) : 0;
+      if ( dropped > 0 )
+      {
+         dMemmove( events.address() + start, events.address() + start + dropped, (count - dropped) * sizeof(Event) );
+         events.setSize( start + count - dropped );
+      }
+
+      threadStart.push_back( start );
+      threadIds.push_back( pBuffer->mThreadId );
+   }
+   threadStart.push_back( events.size() );
+
+   // Find where the requested frames start.  Frames are only marked by the
+   // main thread so the markers are already in order.
+   Vector<U64> frameTimes;
+   for ( U32 index = 0; index < (U32)events.size(); index++ )
+   {
+      if ( events[index].mType == EventFrame && events[index].mTime >= smEnableTime )
+         frameTimes.push_back( events[index].mTime );
+   }
+
+   U64 startTime = smEnableTime;
+   if ( frames > 0 && (U32)frameTimes.size() >= frames )
+      startTime = frameTimes[frameTimes.size() - frames];
+
+   FileStream stream;
+   if ( !stream.open( fileName, FileStream::Write ) )
+   {
+      Con::warnf( "TraceProfiler::exportTrace() - Could not open '%s' for writing.", fileName );
+      return false;
+   }
+
+   char buffer[512];
+   bool firstEvent = true;
+   writeString( stream, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+
+   for ( U32 thread = 0; thread < (U32)threadIds.size(); thread++ )
+   {
+      const U32 threadId = threadIds[thread];
+      bool isMainThread = false;
+      S32 depth = 0;
+
+      for ( U32 index = threadStart[thread]; index < threadStart[thread + 1]; index++ )
+      {
+         const Event& event = events[index];
+         if ( event.mTime < startTime )
+            continue;
+
+         const U32 time = U32( event.mTime - startTime );
+
+         switch ( event.mType )
+         {
+         case EventBegin:
+            depth++;
+            dSprintf( buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%u,\"pid\":1,\"tid\":%u}", event.mName, time, threadId );
+            break;
+
+         case EventEnd:
+            // Skip the ends of blocks that started before the exported range.
+            if ( depth == 0 )
+               continue;
+            depth--;
+            dSprintf( buffer, sizeof(buffer), "{\"ph\":\"E\",\"ts\":%u,\"pid\":1,\"tid\":%u}", time, threadId );
+            break;
+
+         case EventCounter:
+            dSprintf( buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%u,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%g}}", event.mName, time, threadId, event.mValue );
+            break;
+
+         case EventFrame:
+            isMainThread = true;
+            dSprintf( buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%u,\"pid\":1,\"tid\":%u}", event.mName, time, threadId );
+            break;
+
+         default:
+            continue;
+         }
+
+         writeString( stream, firstEvent ? "" : ",\n" );
+         writeString( stream, buffer );
+         firstEvent = false;
+      }
+
+      // Name the threads.
+      dSprintf( buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}", threadId, isMainThread ? "Main" : "Thread", threadId );
+      writeString( stream, firstEvent ? "" : ",\n" );
+      writeString( stream, buffer );
+      firstEvent = false;
+   }
+
+   writeString( stream, "\n]}\n" );
+   stream.close();
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunctionGroupBegin( TraceProfiler, "Timeline trace profiler functionality.");
+
+ConsoleFunction( traceProfilerEnable, void, 2, 2, "(bool enable) Enables (or disables) recording of the timeline trace.\n"
+                "@param enable Whether to record trace events.\n"
+                "@return No return value.")
+{
+   TraceProfiler::setEnabled( dAtob(argv[1]) );
+}
+
+ConsoleFunction( traceProfilerExport, bool, 2, 3, "(string fileName, [int frames]) Exports the recorded timeline as Chrome trace JSON.\n"
+                "The file can be opened with chrome://tracing or https://ui.perfetto.dev.\n"
+                "@param fileName The file to write.\n"
+                "@param frames The number of most recent frames to export.  Everything recorded is exported if omitted or zero.\n"
+                "@return Whether the trace was written.")
+{
+   char pathBuffer[1024];
+   Con::expandPath( pathBuffer, sizeof(pathBuffer), argv[1] );
+
+   const U32 frames = argc > 2 ? dAtoi(argv[2]) : 0;
+   return TraceProfiler::exportTrace( pathBuffer, frames );
+}
+
+ConsoleFunction( traceProfilerCaptureHitch, void, 3, 3, "(int thresholdMs, string fileName) Exports the next frame taking longer than the threshold, along with the frame before it.\n"
+                "The capture happens once and only while the trace profiler is enabled.\n"
+                "@param thresholdMs The frame time in milliseconds which counts as a hitch.  Zero cancels the capture.\n"
+                "@param fileName The file to write.\n"
+                "@return No return value.")
+{
+   char pathBuffer[1024];
+   Con::expandPath( pathBuffer, sizeof(pathBuffer), argv[2] );
+
+   TraceProfiler::captureHitch( dAtoi(argv[1]), pathBuffer );
+}
+
+ConsoleFunctionGroupEnd( TraceProfiler );
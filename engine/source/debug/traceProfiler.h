@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _TRACE_PROFILER_H_
+#define _TRACE_PROFILER_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// The TraceProfiler records a timeline of PROFILE_START/PROFILE_END/PROFILE_SCOPE
+/// events, counters and frame markers which can be exported as a Chrome trace
+/// (chrome://tracing or https://ui.perfetto.dev).
+///
+/// Unlike the Profiler, which aggregates totals on the main thread and is only
+/// compiled in with TORQUE_ENABLE_PROFILER, the TraceProfiler is always compiled
+/// in (unless TORQUE_DISABLE_TRACE_PROFILER is defined) and records from every
+/// thread.  Each thread writes into its own lock-free ring buffer so recording
+/// an event is a timer read and a store.  When disabled, each event costs a
+/// single branch which makes it cheap enough to leave in release builds.
+///
+/// Examples of script use:
+/// @code
+/// traceProfilerEnable(true);                       // start recording
+/// traceProfilerExport("trace.json", 10);           // export the last 10 frames
+/// traceProfilerCaptureHitch(50, "hitch.json");     // export the next frame taking longer than 50ms
+/// @endcode
+class TraceProfiler
+{
+public:
+   enum EventType
+   {
+      EventBegin,
+      EventEnd,
+      EventCounter,
+      EventFrame
+   };
+
+   /// A recorded event.  Names must be string literals or otherwise outlive the profiler.
+   struct Event
+   {
+      const char* mName;
+      U64         mTime;   ///< Microseconds.
+      F32         mValue;  ///< Counter value.
+      U32         mType;
+   };
+
+   struct ThreadBuffer;
+
+   enum
+   {
+      BufferEvents = 1 << 16, ///< Events kept per thread (must be a power of two).
+   };
+
+private:
+   static bool             smEnabled;
+   static ThreadBuffer* volatile smBufferList;
+   static U64              smEnableTime;
+   static U64              smLastFrameTime;
+   static U32              smHitchThreshold;
+   static char             smHitchFileName[256];
+
+   static ThreadBuffer* getThreadBuffer();
+   static void record( const char* name, const U32 type, const F32 value );
+
+public:
+   /// Enable or disable recording.  Events recorded before enabling are not exported.
+   static void setEnabled( const bool enabled );
+   static inline bool isEnabled( void ) { return smEnabled; }
+
+   /// Record the start of a named block on the calling thread.
+   static inline void begin( const char* name ) { if ( smEnabled ) record( name, EventBegin, 0.0f ); }
+
+   /// Record the end of the most recent block on the calling thread.
+   static inline void end( void ) { if ( smEnabled ) record( NULL, EventEnd, 0.0f ); }
+
+   /// Record the value of a named counter.
+   static inline void counter( const char* name, const F32 value ) { if ( smEnabled ) record( name, EventCounter, value ); }
+
+   /// Mark the start of a frame.  Called once per main loop iteration.
+   static void markFrame( void );
+
+   /// Give the calling thread's ring up for reuse by the next thread that records.
+   /// Worker threads should call this before they exit.
+   static void releaseThread( void );
+
+   /// The number of rings created, including those waiting for reuse.
+   static U32 getBufferCount( void );
+
+   /// Export the last "frames" frames (or everything recorded when zero) as Chrome trace JSON.
+   static bool exportTrace( const char* fileName, const U32 frames );
+
+   /// Export the first frame that takes longer than "thresholdMs" to the given file.
+   /// A threshold of zero cancels the capture.
+   static void captureHitch( const U32 thresholdMs, const char* fileName );
+
+   /// Records a block for the lifetime of the object.
+   class Scope
+   {
+   public:
+      Scope( const char* name ) { TraceProfiler::begin( name ); }
+      ~Scope() { TraceProfiler::end(); }
+   };
+};
+
+#endif // _TRACE_PROFILER_H_
@@ -27,6 +27,7 @@
 #include "platform/platformVideo.h"
 #include "platform/platformInput.h"
 #include "platform/platformAudio.h"
+#include "audio/audioMixer.h"
 #include "platform/event.h"
 #include "game/gameInterface.h"
 #include "collection/vector.h"
@@ -52,12 +53,14 @@
 #include "network/netStringTable.h"
 #include "memory/frameAllocator.h"
 #include "game/version.h"
+#include "game/replayBenchmark.h"
 #include "debug/profiler.h"
 #include "network/serverQuery.h"
 #include "game/defaultGame.h"
 #include "platform/nativeDialogs/msgBox.h"
 #include "platform/nativeDialogs/fileDialog.h"
 #include "memory/safeDelete.h"
+#include "messaging/dispatcher.h"
 
 #include <stdio.h>
 
@@ -73,6 +76,10 @@
 #include "module/moduleManager.h"
 #endif
 
+#ifndef _IMAGE_FRAME_ANIMATOR_H_
+#include "2d/core/ImageFrameAnimator.h"
+#endif
+
 #ifndef _ASSET_MANAGER_H_
 #include "assets/assetManager.h"
 #endif
@@ -185,6 +192,9 @@ void shutdownLibraries()
     Sim::shutdown();
     Platform::shutdown();
 
+    // Destroy the self-ticking image-frame animator.
+    ImageFrameAnimator::destroySelfTickAnimator();
+
     NetStringTable::destroy();
     Con::shutdown();
 
@@ -247,6 +257,10 @@ bool initializeGame(int argc, const char **argv)
         argc -= 2;
     }
 
+    // Let the replay benchmark process the command-line.
+    if ( !ReplayBenchmark::processCommandLine( argc, argv ) )
+        return false;
+
     // Scan executable location and all sub-directories.
     ResourceManager->setWriteablePath(Platform::getCurrentDirectory());
     ResourceManager->addPath( Platform::getCurrentDirectory() );
@@ -434,10 +448,12 @@ void DefaultGame::mainLoop( void )
 #ifdef TORQUE_OS_IOS_PROFILE
     iPhoneProfilerStart("MAIN_LOOP");
 #endif	
+         TraceProfiler::markFrame();
          PROFILE_START(MainLoop);
 #ifdef TORQUE_ALLOW_JOURNALING
          PROFILE_START(JournalMain);
    Game->journalProcess();
+   ReplayBenchmark::process();
          PROFILE_END();
 #endif // TORQUE_ALLOW_JOURNALING
          PROFILE_START(NetProcessMain);
@@ -453,10 +469,14 @@ void DefaultGame::mainLoop( void )
    TelDebugger->process();
          PROFILE_END();
          PROFILE_START(TimeManagerProcessMain);
-   TimeManager::process(); // guaranteed to produce an event
+   if ( !ReplayBenchmark::isActive() ) // the replay runs as fast as possible.
+      TimeManager::process(); // guaranteed to produce an event
          PROFILE_END();
          PROFILE_START(GameProcessEvents);
     Game->processEvents(); // process all non-sim posted events.
+         PROFILE_END();
+         PROFILE_START(ResourceProcessAsyncReads);
+    ResourceManager->processAsyncReads(); // dispatch completed file reads.
          PROFILE_END();
          PROFILE_END();
     
@@ -479,6 +499,10 @@ void DefaultGame::mainShutdown( void )
     shutdownGame();
     shutdownLibraries();
 
+    // Exit with the replay benchmark result.
+    if ( ReplayBenchmark::isActive() )
+        Platform::forceShutdown( ReplayBenchmark::getExitCode() );
+
     if( Game->requiresRestart() )
     Platform::restartInstance();
 }
@@ -546,6 +570,7 @@ void DefaultGame::processQuitEvent()
 void DefaultGame::processTimeEvent(TimeEvent *event)
 {
     PROFILE_START(ProcessTimeEvent);
+   ReplayBenchmark::beginSample(ReplayBenchmark::SampleTick);
    U32 elapsedTime = event->elapsedTime;
 
    if(elapsedTime > 1024)
@@ -568,6 +593,9 @@ void DefaultGame::processTimeEvent(TimeEvent *event)
    Platform::advanceTime(elapsedTime);
    bool tickPass;
 
+   // Hand over packets the network simulator has finished delaying.
+   GNet->processSimulation();
+
     PROFILE_START(ServerProcess);
 #ifdef TORQUE_OS_IOS_PROFILE
 iPhoneProfilerStart("SERVER_PROC");
@@ -594,6 +622,10 @@ iPhoneProfilerStart("SERVER_PROC");
 #endif
     PROFILE_END();
 
+   PROFILE_START(DeliverPostedMessages);
+   Dispatcher::deliverPostedMessages();
+   PROFILE_END();
+
    PROFILE_START(ClientProcess);
 #ifdef TORQUE_OS_IOS_PROFILE
     iPhoneProfilerStart("CLIENT_PROC");
@@ -618,6 +650,10 @@ iPhoneProfilerStart("SERVER_PROC");
       alxUpdate();
       lastAudioUpdate = realTime;
    }
+
+   // Release voices the software mixer has finished with.
+   if ( gAudioMixer != NULL )
+      gAudioMixer->update();
 #endif
 
 #ifdef TORQUE_OS_IOS_PROFILE
@@ -645,11 +681,21 @@ iPhoneProfilerStart("GL_RENDER");
 iPhoneProfilerEnd("GL_RENDER");
 #endif
    }
+   else if(Canvas && Platform::isHeadless())
+   {
+      // Without a window, only prepare the frame.
+      PROFILE_START(PreRenderFrame);
+      Canvas->renderFrame(true);
+      PROFILE_END();
+      gFrameCount++;
+   }
    GNet->checkTimeouts();
     
 #ifdef TORQUE_ALLOW_MUSICPLAYER
     updateVolume();
 #endif
+   ReplayBenchmark::endSample(ReplayBenchmark::SampleTick);
+   ReplayBenchmark::endFrame();
    PROFILE_END();
 }
 
@@ -0,0 +1,489 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "game/replayBenchmark.h"
+
+#ifndef _GAMEINTERFACE_H_
+#include "game/gameInterface.h"
+#endif
+
+#ifndef _FILESTREAM_H_
+#include "io/fileStream.h"
+#endif
+
+#ifndef _TEXTURE_MANAGER_H_
+#include "graphics/TextureManager.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+bool                            ReplayBenchmark::smActive = false;
+bool                            ReplayBenchmark::smFinished = false;
+ReplayBenchmark::ExitCode       ReplayBenchmark::smExitCode = ReplayBenchmark::ExitPassed;
+U32                             ReplayBenchmark::smTickMs = ReplayBenchmark::DefaultTickMs;
+U32                             ReplayBenchmark::smTolerance = ReplayBenchmark::DefaultTolerance;
+char                            ReplayBenchmark::smJournalFile[1024];
+char                            ReplayBenchmark::smReportFile[1024];
+char                            ReplayBenchmark::smBaselineFile[1024];
+U32                             ReplayBenchmark::smDepth[SampleCount];
+U64                             ReplayBenchmark::smStart[SampleCount];
+U64                             ReplayBenchmark::smAccumulated[SampleCount];
+Vector<ReplayBenchmark::Frame>  ReplayBenchmark::smFrames;
+
+//-----------------------------------------------------------------------------
+
+static const char* sSampleNames[ReplayBenchmark::SampleCount] =
+{
+    "tick",
+    "renderPrepare",
+    "script",
+    "physics",
+};
+
+//-----------------------------------------------------------------------------
+
+static S32 QSORT_CALLBACK compareSampleTimes( const void* a, const void* b )
+{
+    const U32 timeA = *(const U32*)a;
+    const U32 timeB = *(const U32*)b;
+
+    return timeA < timeB ? -1 : timeA > timeB ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ReplayBenchmark::processCommandLine( S32 argc, const char **argv )
+{
+    char recordFile[1024];
+    recordFile[0] = 0;
+    smJournalFile[0] = 0;
+    smReportFile[0] = 0;
+    smBaselineFile[0] = 0;
+
+    // Find the replay arguments which all take a value.
+    for( S32 argIndex = 1; argIndex < argc; ++argIndex )
+    {
+        // Fetch argument.
+        const char* pArg = argv[argIndex];
+
+        // Fetch the file-path buffer the argument is for, if any.
+        char* pFileBuffer = NULL;
+        if ( dStricmp( pArg, REPLAY_BENCHMARK_ARG_JOURNAL ) == 0 )
+            pFileBuffer = smJournalFile;
+        else if ( dStricmp( pArg, REPLAY_BENCHMARK_ARG_REPORT ) == 0 )
+            pFileBuffer = smReportFile;
+        else if ( dStricmp( pArg, REPLAY_BENCHMARK_ARG_BASELINE ) == 0 )
+            pFileBuffer = smBaselineFile;
+        else if ( dStricmp( pArg, REPLAY_BENCHMARK_ARG_RECORD ) == 0 )
+            pFileBuffer = recordFile;
+        else if ( dStricmp( pArg, REPLAY_BENCHMARK_ARG_TICK ) != 0 && dStricmp( pArg, REPLAY_BENCHMARK_ARG_TOLERANCE ) != 0 )
+            continue;
+
+        // Is there a value?
+        if ( argIndex + 1 >= argc )
+        {
+            // No, so warn.
+            Con::errorf( "ReplayBenchmark: The command-line argument '%s' requires a value.", pArg );
+            return false;
+        }
+
+        // Fetch value.
+        const char* pValue = argv[++argIndex];
+
+        if ( pFileBuffer != NULL )
+            Platform::makeFullPathName( pValue, pFileBuffer, sizeof(smJournalFile) );
+        else if ( dStricmp( pArg, REPLAY_BENCHMARK_ARG_TICK ) == 0 )
+            smTickMs = getMax( dAtoi( pValue ), 1 );
+        else
+            smTolerance = getMax( dAtoi( pValue ), 0 );
+    }
+
+    // Finish if there is nothing to record or replay.
+    if ( recordFile[0] == 0 && smJournalFile[0] == 0 )
+        return true;
+
+#ifdef TORQUE_ALLOW_JOURNALING
+    // Are we replaying?
+    if ( smJournalFile[0] == 0 )
+    {
+        // No, so record the journal from startup.
+        Game->saveJournal( recordFile );
+        Con::printf( "ReplayBenchmark: Recording journal '%s'.", recordFile );
+        return true;
+    }
+
+    // Is the journal present?
+    if ( !Platform::isFile( smJournalFile ) )
+    {
+        // No, so warn.
+        Con::errorf( "ReplayBenchmark: Cannot find the journal '%s'.", smJournalFile );
+        smExitCode = ExitFailed;
+        return false;
+    }
+
+    // Run without a window, GL context or audio device.
+    Platform::setHeadless( true );
+    TextureManager::mDGLRender = false;
+
+    // Advance by the fixed tick whatever time was recorded in the journal.
+    Con::setIntVariable( "timeAdvance", smTickMs );
+
+    // Reset the samples.
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+    {
+        smDepth[sampleIndex] = 0;
+        smAccumulated[sampleIndex] = 0;
+    }
+    smFrames.clear();
+
+    Game->playJournal( smJournalFile, false );
+    smActive = true;
+
+    Con::printf( "ReplayBenchmark: Replaying journal '%s' with a %dms tick.", smJournalFile, smTickMs );
+    return true;
+#else
+    // Warn.
+    Con::errorf( "ReplayBenchmark: Recording and replaying journals requires TORQUE_ALLOW_JOURNALING." );
+    smExitCode = ExitFailed;
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void ReplayBenchmark::startSample( const Sample sample )
+{
+    // Only time the outermost sample.
+    if ( smDepth[sample]++ == 0 )
+        smStart[sample] = Platform::getRealMicroseconds();
+}
+
+//-----------------------------------------------------------------------------
+
+void ReplayBenchmark::stopSample( const Sample sample )
+{
+    // Ignore a sample that was started before the benchmark.
+    if ( smDepth[sample] == 0 )
+        return;
+
+    if ( --smDepth[sample] == 0 )
+        smAccumulated[sample] += Platform::getRealMicroseconds() - smStart[sample];
+}
+
+//-----------------------------------------------------------------------------
+
+void ReplayBenchmark::endFrame( void )
+{
+    // Finish if not active.
+    if ( !smActive )
+        return;
+
+    // Record the frame.
+    Frame frame;
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+    {
+        frame.mTime[sampleIndex] = (U32)smAccumulated[sampleIndex];
+        smAccumulated[sampleIndex] = 0;
+    }
+    smFrames.push_back( frame );
+}
+
+//-----------------------------------------------------------------------------
+
+void ReplayBenchmark::process( void )
+{
+    // Finish if not active or the journal is still playing.
+    if ( !smActive || smFinished || Game->isJournalReading() )
+        return;
+
+    smFinished = true;
+
+    Con::printf( "ReplayBenchmark: Finished replaying %d frames.", smFrames.size() );
+
+    // Summarize the frames.
+    Summary summary;
+    summarize( summary );
+
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+    {
+        Con::printf( "ReplayBenchmark: > %-14s mean %10.1fus, p95 %10.1fus", sSampleNames[sampleIndex], summary.mMean[sampleIndex], summary.mP95[sampleIndex] );
+    }
+
+    smExitCode = ExitPassed;
+
+    // Write the report.
+    if ( smReportFile[0] != 0 && !writeReport( smReportFile ) )
+        smExitCode = ExitFailed;
+
+    // Compare against the baseline.
+    if ( smBaselineFile[0] != 0 && smExitCode == ExitPassed )
+    {
+        Summary baseline;
+
+        // Is there a baseline?
+        if ( Platform::isFile( smBaselineFile ) )
+        {
+            // Yes, so compare against it.
+            if ( readBaseline( smBaselineFile, baseline ) )
+                smExitCode = compare( summary, baseline );
+            else
+                smExitCode = ExitFailed;
+        }
+        else
+        {
+            // No, so this run becomes the baseline.
+            if ( writeBaseline( smBaselineFile, summary ) )
+                Con::printf( "ReplayBenchmark: Wrote the baseline '%s'.", smBaselineFile );
+            else
+                smExitCode = ExitFailed;
+        }
+    }
+
+    // Quit.
+    Game->setRunning( false );
+}
+
+//-----------------------------------------------------------------------------
+
+void ReplayBenchmark::summarize( Summary& summary )
+{
+    const U32 frameCount = smFrames.size();
+
+    Vector<U32> times;
+    times.setSize( frameCount );
+
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+    {
+        summary.mMean[sampleIndex] = 0.0f;
+        summary.mP95[sampleIndex] = 0.0f;
+
+        // Skip if there are no frames.
+        if ( frameCount == 0 )
+            continue;
+
+        U64 total = 0;
+        for ( U32 frameIndex = 0; frameIndex < frameCount; ++frameIndex )
+        {
+            times[frameIndex] = smFrames[frameIndex].mTime[sampleIndex];
+            total += times[frameIndex];
+        }
+
+        dQsort( times.address(), frameCount, sizeof(U32), compareSampleTimes );
+
+        summary.mMean[sampleIndex] = (F32)((F64)total / frameCount);
+        summary.mP95[sampleIndex] = (F32)times[((frameCount - 1) * 95) / 100];
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool ReplayBenchmark::writeReport( const char* pFileName )
+{
+    FileStream stream;
+
+    // File opened?
+    if ( !stream.open( pFileName, FileStream::Write ) )
+    {
+        // No, so warn.
+        Con::errorf( "ReplayBenchmark: Could not open the report '%s' for write.", pFileName );
+        return false;
+    }
+
+    char lineBuffer[256];
+    const U32 frameCount = smFrames.size();
+    const bool json = Platform::hasExtension( pFileName, ".json" );
+
+    if ( json )
+    {
+        dSprintf( lineBuffer, sizeof(lineBuffer), "{ \"tickMs\": %d, \"frames\": [", smTickMs );
+        stream.writeLine( (U8*)lineBuffer );
+    }
+    else
+    {
+        dSprintf( lineBuffer, sizeof(lineBuffer), "frame,%s_us,%s_us,%s_us,%s_us", sSampleNames[0], sSampleNames[1], sSampleNames[2], sSampleNames[3] );
+        stream.writeLine( (U8*)lineBuffer );
+    }
+
+    for ( U32 frameIndex = 0; frameIndex < frameCount; ++frameIndex )
+    {
+        const U32* pTime = smFrames[frameIndex].mTime;
+
+        if ( json )
+        {
+            dSprintf( lineBuffer, sizeof(lineBuffer), "  { \"%s\": %d, \"%s\": %d, \"%s\": %d, \"%s\": %d }%s",
+                sSampleNames[0], pTime[0], sSampleNames[1], pTime[1], sSampleNames[2], pTime[2], sSampleNames[3], pTime[3],
+                frameIndex + 1 < frameCount ? "," : "" );
+        }
+        else
+        {
+            dSprintf( lineBuffer, sizeof(lineBuffer), "%d,%d,%d,%d,%d", frameIndex, pTime[0], pTime[1], pTime[2], pTime[3] );
+        }
+
+        stream.writeLine( (U8*)lineBuffer );
+    }
+
+    if ( json )
+    {
+        dSprintf( lineBuffer, sizeof(lineBuffer), "] }" );
+        stream.writeLine( (U8*)lineBuffer );
+    }
+
+    stream.close();
+
+    Con::printf( "ReplayBenchmark: Wrote the report '%s'.", pFileName );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ReplayBenchmark::readBaseline( const char* pFileName, Summary& baseline )
+{
+    FileStream stream;
+
+    // File opened?
+    if ( !stream.open( pFileName, FileStream::Read ) )
+    {
+        // No, so warn.
+        Con::errorf( "ReplayBenchmark: Could not open the baseline '%s' for read.", pFileName );
+        return false;
+    }
+
+    bool found[SampleCount];
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+        found[sampleIndex] = false;
+
+    // Read the "metric,mean_us,p95_us" lines.
+    char lineBuffer[256];
+    while( stream.getStatus() == Stream::Ok )
+    {
+        stream.readLine( (U8*)lineBuffer, sizeof(lineBuffer) );
+
+        char name[64];
+        F32 mean, p95;
+        if ( dSscanf( lineBuffer, "%63[^,],%f,%f", name, &mean, &p95 ) != 3 )
+            continue;
+
+        for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+        {
+            if ( dStricmp( name, sSampleNames[sampleIndex] ) != 0 )
+                continue;
+
+            baseline.mMean[sampleIndex] = mean;
+            baseline.mP95[sampleIndex] = p95;
+            found[sampleIndex] = true;
+        }
+    }
+
+    stream.close();
+
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+    {
+        if ( found[sampleIndex] )
+            continue;
+
+        // Warn.
+        Con::errorf( "ReplayBenchmark: The baseline '%s' has no '%s' metric.", pFileName, sSampleNames[sampleIndex] );
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ReplayBenchmark::writeBaseline( const char* pFileName, const Summary& summary )
+{
+    FileStream stream;
+
+    // File opened?
+    if ( !stream.open( pFileName, FileStream::Write ) )
+    {
+        // No, so warn.
+        Con::errorf( "ReplayBenchmark: Could not open the baseline '%s' for write.", pFileName );
+        return false;
+    }
+
+    char lineBuffer[256];
+    dStrcpy( lineBuffer, "metric,mean_us,p95_us" );
+    stream.writeLine( (U8*)lineBuffer );
+
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+    {
+        dSprintf( lineBuffer, sizeof(lineBuffer), "%s,%.1f,%.1f", sSampleNames[sampleIndex], summary.mMean[sampleIndex], summary.mP95[sampleIndex] );
+        stream.writeLine( (U8*)lineBuffer );
+    }
+
+    stream.close();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+ReplayBenchmark::ExitCode ReplayBenchmark::compare( const Summary& summary, const Summary& baseline )
+{
+    const F32 limit = 1.0f + smTolerance / 100.0f;
+
+    ExitCode exitCode = ExitPassed;
+
+    for ( U32 sampleIndex = 0; sampleIndex < SampleCount; ++sampleIndex )
+    {
+        const F32 mean = summary.mMean[sampleIndex];
+        const F32 p95 = summary.mP95[sampleIndex];
+        const F32 baselineMean = baseline.mMean[sampleIndex];
+        const F32 baselineP95 = baseline.mP95[sampleIndex];
+
+        // Changes of under a microsecond are noise.
+        const bool regressed =
+            ( mean > baselineMean * limit && mean - baselineMean >= 1.0f ) ||
+            ( p95 > baselineP95 * limit && p95 - baselineP95 >= 1.0f );
+
+        const F32 meanChange = baselineMean > 0.0f ? ( mean / baselineMean - 1.0f ) * 100.0f : 0.0f;
+        const F32 p95Change = baselineP95 > 0.0f ? ( p95 / baselineP95 - 1.0f ) * 100.0f : 0.0f;
+
+        if ( regressed )
+        {
+            Con::errorf( "ReplayBenchmark: > %-14s REGRESSED mean %+.1f%%, p95 %+.1f%% (tolerance %d%%).", sSampleNames[sampleIndex], meanChange, p95Change, smTolerance );
+            exitCode = ExitRegressed;
+        }
+        else
+        {
+            Con::printf( "ReplayBenchmark: > %-14s passed mean %+.1f%%, p95 %+.1f%%.", sSampleNames[sampleIndex], meanChange, p95Change );
+        }
+    }
+
+    return exitCode;
+}
+
+//-----------------------------------------------------------------------------
+
+const char* ReplayBenchmark::getSampleName( const Sample sample )
+{
+    AssertFatal( sample < SampleCount, "ReplayBenchmark::getSampleName() - Invalid sample." );
+
+    return sSampleNames[sample];
+}
@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _REPLAY_BENCHMARK_H_
+#define _REPLAY_BENCHMARK_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define REPLAY_BENCHMARK_ARG_JOURNAL        "-replay"
+#define REPLAY_BENCHMARK_ARG_TICK           "-replayTick"
+#define REPLAY_BENCHMARK_ARG_REPORT         "-replayReport"
+#define REPLAY_BENCHMARK_ARG_BASELINE       "-replayBaseline"
+#define REPLAY_BENCHMARK_ARG_TOLERANCE      "-replayTolerance"
+#define REPLAY_BENCHMARK_ARG_RECORD         "-recordJournal"
+
+//-----------------------------------------------------------------------------
+
+/// Replays a journal headless as a repeatable performance test.
+///
+/// Started with "-replay <journal>" on the command-line, the engine runs without
+/// a window, GL context or audio device, plays the journal back with a fixed
+/// tick of "-replayTick <ms>" (16 by default) and does not wait between frames.
+/// Each frame records the time spent ticking, preparing the canvas for rendering,
+/// executing script and stepping physics.
+///
+/// When the journal ends the frames are written to "-replayReport <file>" (JSON if
+/// the file ends with ".json", CSV otherwise) and a summary is compared against
+/// "-replayBaseline <file>".  A metric whose mean or 95th percentile is more than
+/// "-replayTolerance <percent>" (10 by default) slower than the baseline fails the
+/// run.  If the baseline does not exist it is written from this run instead.
+///
+/// The process exits with ExitPassed, ExitRegressed or ExitFailed.  Journals to
+/// replay are recorded from startup with "-recordJournal <journal>".
+///
+/// Journal recording and playback require TORQUE_ALLOW_JOURNALING.
+class ReplayBenchmark
+{
+public:
+    enum Sample
+    {
+        SampleTick,
+        SampleRenderPrepare,
+        SampleScript,
+        SamplePhysics,
+
+        SampleCount
+    };
+
+    enum ExitCode
+    {
+        ExitPassed = 0,
+        ExitRegressed = 1,
+        ExitFailed = 2,
+    };
+
+    // Constants.
+    static const U32 DefaultTickMs = 16;
+    static const U32 DefaultTolerance = 10;
+
+    /// Times a sample for the lifetime of the object.
+    class SampleScope
+    {
+        Sample mSample;
+
+    public:
+        SampleScope( const Sample sample ) : mSample( sample ) { ReplayBenchmark::beginSample( sample ); }
+        ~SampleScope() { ReplayBenchmark::endSample( mSample ); }
+    };
+
+private:
+    struct Frame
+    {
+        U32 mTime[SampleCount];     ///< Microseconds.
+    };
+
+    struct Summary
+    {
+        F32 mMean[SampleCount];     ///< Microseconds.
+        F32 mP95[SampleCount];      ///< Microseconds.
+    };
+
+    static bool             smActive;
+    static bool             smFinished;
+    static ExitCode         smExitCode;
+    static U32              smTickMs;
+    static U32              smTolerance;
+    static char             smJournalFile[1024];
+    static char             smReportFile[1024];
+    static char             smBaselineFile[1024];
+
+    static U32              smDepth[SampleCount];
+    static U64              smStart[SampleCount];
+    static U64              smAccumulated[SampleCount];
+    static Vector<Frame>    smFrames;
+
+    static void startSample( const Sample sample );
+    static void stopSample( const Sample sample );
+
+    static void summarize( Summary& summary );
+    static bool writeReport( const char* pFileName );
+    static bool readBaseline( const char* pFileName, Summary& baseline );
+    static bool writeBaseline( const char* pFileName, const Summary& summary );
+    static ExitCode compare( const Summary& summary, const Summary& baseline );
+
+public:
+    /// Handle the replay command-line arguments.  Returns false if the arguments are invalid.
+    static bool processCommandLine( S32 argc, const char **argv );
+
+    static inline bool isActive( void ) { return smActive; }
+    static inline ExitCode getExitCode( void ) { return smExitCode; }
+
+    /// Time a sample.  Nested samples of the same kind are only timed once.
+    static inline void beginSample( const Sample sample ) { if ( smActive ) startSample( sample ); }
+    static inline void endSample( const Sample sample ) { if ( smActive ) stopSample( sample ); }
+
+    /// Record the samples taken since the last frame.
+    static void endFrame( void );
+
+    /// Check whether the journal has finished and if so, report and quit.
+    static void process( void );
+
+    static const char* getSampleName( const Sample sample );
+};
+
+#endif // _REPLAY_BENCHMARK_H_
@@ -237,6 +237,13 @@ void TextureManager::resurrectManager( void )
     // Post begin resurrection event.
     postTextureEvent(BeginResurrection);
 
+    // Read all the bitmaps in the background while the first ones are decoded.
+    for ( TextureObject* pPrefetch = TextureDictionary::TextureObjectChain; pPrefetch != NULL; pPrefetch = pPrefetch->next )
+    {
+        if ( pPrefetch->mHandleType == TextureHandle::BitmapTexture )
+            prefetchTexture( pPrefetch->mTextureKey );
+    }
+
     // Resurrect textures.
     TextureObject* probe = TextureDictionary::TextureObjectChain;
     while (probe) 
@@ -689,6 +696,29 @@ void TextureManager::refresh( TextureObject* pTextureObject )
 
 //--------------------------------------------------------------------------------------------------------------------
 
+bool TextureManager::prefetchTexture( const char *textureName )
+{
+    // Sanity!
+    AssertFatal( textureName != NULL, "Texture Manager:  Cannot prefetch a NULL texture name." );
+
+    char fileNameBuffer[512];
+    Platform::makeFullPathName( textureName, fileNameBuffer, 512 );
+
+    // Queue the first of the supported extensions that exists, as loadBitmap() would load.
+    U32 len = dStrlen(fileNameBuffer);
+    for (U32 i = 0; i < EXT_ARRAY_SIZE; i++)
+    {
+        dStrcpy(fileNameBuffer + len, extArray[i]);
+
+        if ( ResourceManager->find( fileNameBuffer ) != NULL )
+            return ResourceManager->prefetch( fileNameBuffer, AsyncReadRequest::PriorityNormal );
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+
 void TextureManager::refresh( const char *textureName )
 {
     // Finish if no texture name specified.
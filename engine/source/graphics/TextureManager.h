@@ -94,6 +94,7 @@ public:
     static void resurrectManager();
     static void flush();
     static void refresh( const char *textureName );
+    static bool prefetchTexture( const char *textureName );
     static S32 getBitmapResidentSize( void ) { return mBitmapResidentSize; }
     static S32 getTextureResidentSize( void ) { return mTextureResidentSize; }
     static S32 getTextureResidentWasteSize( void ) { return mTextureResidentWasteSize; }
@@ -24,6 +24,7 @@
 #include "platform/platformFont.h"
 #include "debug/profiler.h"
 #include "platform/threads/mutex.h"
+#include "platform/threads/thread.h"
 #include "console/console.h"
 #include "io/stream.h"
 #include "graphics/gBitmap.h"
@@ -39,6 +40,7 @@
 
 S32 GFont::smSheetIdCount = 0;
 const U32 GFont::csm_fileVersion = 3;
+void* GFont::smRasterMutex = NULL;
 
 ConsoleFunction(populateFontCacheString, void, 4, 4, "(faceName, size, string) "
                 "Populate the font cache for the specified font with characters from the specified string."
@@ -65,6 +67,34 @@ ConsoleFunction(populateFontCacheString, void, 4, 4, "(faceName, size, string) "
    f->getStrWidthPrecise(argv[3]);
 }
 
+ConsoleFunction(prewarmFontCacheString, void, 4, 4, "(faceName, size, string) "
+                "Rasterise the characters in the specified string for the specified font on a background thread. "
+                "The characters are added to the font's texture sheets when they are first used.\n"
+                "@param faceName The font's name\n"
+                "@param size The size of the font.\n"
+                "@param string The characters to rasterise\n"
+                "@return No return value.")
+{
+   Resource<GFont> f = GFont::create(argv[1], dAtoi(argv[2]), Con::getVariable("$GUI::fontCacheDirectory"));
+
+   if(f.isNull())
+   {
+      Con::errorf("prewarmFontCacheString - could not load font '%s %d'!", argv[1], dAtoi(argv[2]));
+      return;
+   }
+
+   if(!f->hasPlatformFont())
+   {
+      Con::errorf("prewarmFontCacheString - font '%s %d' has no platform font! Cannot generate more characters.", argv[1], dAtoi(argv[2]));
+      return;
+   }
+
+   const U32 len = dStrlen(argv[3]);
+   FrameTemp<UTF16> str16(len + 1);
+   convertUTF8toUTF16(argv[3], str16, len + 1);
+   f->prewarm(str16, dStrlen(str16));
+}
+
 ConsoleFunction(populateFontCacheRange, void, 5, 5, "(faceName, size, rangeStart, rangeEnd) - "
                 "Populate the font cache for the specified font with Unicode code points in the specified range. "
                 "Note we only support BMP-0, so code points range from 0 to 65535."
@@ -441,6 +471,61 @@ Resource<GFont> GFont::create(const char *faceName, U32 size, const char *cacheD
 
 //-------------------------------------------------------------------------
 
+/// Rasterises queued characters so the main thread only has to pack them.
+class GFont::PrewarmThread : public Thread
+{
+   GFont* mFont;
+
+public:
+   PrewarmThread(GFont* font) : Thread(0, NULL, false), mFont(font) {}
+
+   virtual void run(void *arg = 0)
+   {
+      while(!checkForStop())
+      {
+         // Fetch the next character, finishing when there are none left.
+         Mutex::lockMutex(mFont->mMutex);
+         if(mFont->mPrewarmChars.empty())
+         {
+            mFont->mPrewarmRunning = false;
+            Mutex::unlockMutex(mFont->mMutex);
+            FrameAllocator::releaseThread();
+            TraceProfiler::releaseThread();
+            return;
+         }
+         const UTF16 ch = mFont->mPrewarmChars.last();
+         mFont->mPrewarmChars.pop_back();
+         Mutex::unlockMutex(mFont->mMutex);
+
+         // Skip anything already loaded.  This is only a hint as the main
+         // thread may load the character at any time.
+         if(mFont->mRemapTable[ch] != -1 || !mFont->mPlatformFont->isValidChar(ch))
+            continue;
+
+         PendingGlyph glyph;
+         glyph.mChar = ch;
+
+         Mutex::lockMutex(smRasterMutex);
+         glyph.mCharInfo = mFont->mPlatformFont->getCharInfo(ch);
+         Mutex::unlockMutex(smRasterMutex);
+
+         Mutex::lockMutex(mFont->mMutex);
+         mFont->mPendingGlyphs.push_back(glyph);
+         mFont->mPendingGlyphCount = mFont->mPendingGlyphs.size();
+         Mutex::unlockMutex(mFont->mMutex);
+      }
+
+      Mutex::lockMutex(mFont->mMutex);
+      mFont->mPrewarmRunning = false;
+      Mutex::unlockMutex(mFont->mMutex);
+
+      FrameAllocator::releaseThread();
+      TraceProfiler::releaseThread();
+   }
+};
+
+//-------------------------------------------------------------------------
+
 GFont::GFont()
 {
    VECTOR_SET_ASSOCIATION(mCharInfoList);
@@ -459,6 +544,15 @@ GFont::GFont()
    mNeedSave = false;
    
    mMutex = Mutex::createMutex();
+
+   if(smRasterMutex == NULL)
+      smRasterMutex = Mutex::createMutex();
+
+   mPendingGlyphCount = 0;
+   mPrewarmRunning = false;
+   mPrewarmThread = NULL;
+
+   clearLayoutCache();
 }
 
 GFont::~GFont()
@@ -478,6 +572,19 @@ GFont::~GFont()
    
    S32 i;
 
+   // Stop rasterising in the background.
+   if(mPrewarmThread)
+   {
+      mPrewarmThread->stop();
+      mPrewarmThread->join();
+      SAFE_DELETE(mPrewarmThread);
+   }
+
+   for(i = 0;i < mPendingGlyphs.size();i++)
+   {
+       SAFE_DELETE_ARRAY(mPendingGlyphs[i].mCharInfo.bitmapData);
+   }
+
    for(i = 0;i < mCharInfoList.size();i++)
    {
        SAFE_DELETE_ARRAY(mCharInfoList[i].bitmapData);
@@ -518,6 +625,9 @@ void GFont::dumpInfo()
    else
       Con::printf("      - No mapped codepoints.", mapBegin, mapEnd);
    Con::printf("      - Platform font is %s.", (mPlatformFont ? "present" : "not present") );
+
+   const U32 layoutQueries = mLayoutCacheHits + mLayoutCacheMisses;
+   Con::printf("      - Layout cache hit %d of %d queries.", mLayoutCacheHits, layoutQueries);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -527,10 +637,20 @@ bool GFont::loadCharInfo(const UTF16 ch)
     if(mRemapTable[ch] != -1)
         return true;    // Not really an error
 
+    // The character may already have been rasterised in the background.
+    if(mPendingGlyphCount)
+    {
+        flushPendingGlyphs();
+        if(mRemapTable[ch] != -1)
+            return true;
+    }
+
     if(mPlatformFont && mPlatformFont->isValidChar(ch))
     {
-        Mutex::lockMutex(mMutex); // the CharInfo returned by mPlatformFont is static data, must protect from changes.
-        PlatformFont::CharInfo &ci = mPlatformFont->getCharInfo(ch);
+        Mutex::lockMutex(smRasterMutex); // the CharInfo returned by mPlatformFont is static data, must protect from changes.
+        PlatformFont::CharInfo ci = mPlatformFont->getCharInfo(ch);
+        Mutex::unlockMutex(smRasterMutex);
+
         if(ci.bitmapData)
             addBitmap(ci);
 
@@ -541,14 +661,13 @@ bool GFont::loadCharInfo(const UTF16 ch)
         mNeedSave = true;
 #endif
 
-        Mutex::unlockMutex(mMutex);
         return true;
     }
 
     return false;
 }
 
-void GFont::addBitmap(PlatformFont::CharInfo &charInfo)
+void GFont::addBitmap(PlatformFont::CharInfo &charInfo, bool refreshSheet)
 {
    // If this is called inside a glBegin - glEnd block, the texture will not be
    // updated properly.
@@ -625,7 +744,97 @@ void GFont::addBitmap(PlatformFont::CharInfo &charInfo)
       }
    }
    
-   mTextureSheets[mCurSheet].refresh();
+   if(refreshSheet)
+      mTextureSheets[mCurSheet].refresh();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void GFont::prewarm(const UTF16 *chars, U32 count)
+{
+   if(!mPlatformFont || count == 0)
+      return;
+
+   bool startThread = false;
+
+   Mutex::lockMutex(mMutex);
+   for(U32 i = 0; i < count; i++)
+   {
+      if(chars[i] != 0 && mRemapTable[chars[i]] == -1)
+         mPrewarmChars.push_back(chars[i]);
+   }
+
+   if(!mPrewarmRunning && !mPrewarmChars.empty())
+   {
+      mPrewarmRunning = true;
+      startThread = true;
+   }
+   Mutex::unlockMutex(mMutex);
+
+   if(!startThread)
+      return;
+
+   // Any previous thread has already finished so this won't block.
+   if(mPrewarmThread)
+   {
+      mPrewarmThread->join();
+      SAFE_DELETE(mPrewarmThread);
+   }
+
+   mPrewarmThread = new PrewarmThread(this);
+   mPrewarmThread->start();
+}
+
+bool GFont::isPrewarming()
+{
+   Mutex::lockMutex(mMutex);
+   const bool running = mPrewarmRunning;
+   Mutex::unlockMutex(mMutex);
+
+   return running;
+}
+
+void GFont::flushPendingGlyphs()
+{
+   Vector<PendingGlyph> glyphs;
+
+   Mutex::lockMutex(mMutex);
+   glyphs.merge(mPendingGlyphs);
+   mPendingGlyphs.clear();
+   mPendingGlyphCount = 0;
+   Mutex::unlockMutex(mMutex);
+
+   if(glyphs.empty())
+      return;
+
+   PROFILE_SCOPE(GFont_flushPendingGlyphs);
+
+   // Pack all the glyphs before uploading each modified sheet once.
+   const S32 firstSheet = getMax(mCurSheet, 0);
+   for(S32 i = 0; i < glyphs.size(); i++)
+   {
+      PendingGlyph& glyph = glyphs[i];
+
+      // The main thread may have loaded the character in the meantime.
+      if(mRemapTable[glyph.mChar] != -1)
+      {
+         SAFE_DELETE_ARRAY(glyph.mCharInfo.bitmapData);
+         continue;
+      }
+
+      if(glyph.mCharInfo.bitmapData)
+         addBitmap(glyph.mCharInfo, false);
+
+      mCharInfoList.push_back(glyph.mCharInfo);
+      mRemapTable[glyph.mChar] = mCharInfoList.size() - 1;
+//don't save UFTs on the iPhone
+#ifndef TORQUE_OS_IOS
+      mNeedSave = true;
+#endif
+   }
+
+   for(S32 i = firstSheet; i <= mCurSheet; i++)
+      mTextureSheets[i].refresh();
 }
 
 void GFont::addSheet()
@@ -717,6 +926,22 @@ U32 GFont::getStrNWidth(const UTF16 *str, U32 n)
 {
    AssertFatal(str != NULL, "GFont::getStrNWidth: String is NULL");
 
+   if (str == NULL || str[0] == '\0' || n == 0)   
+      return 0;
+
+   U64 hash;
+   U32 length, width;
+   if (findLayout(str, n, LayoutWidth, hash, length, width))
+      return width;
+
+   width = calcStrNWidth(str, n);
+   storeLayout(hash, length, LayoutWidth, width);
+   return width;
+}
+
+U32 GFont::calcStrNWidth(const UTF16 *str, U32 n)
+{
+
    if (str == NULL || str[0] == '\0' || n == 0)   
       return 0;
       
@@ -756,6 +981,22 @@ U32 GFont::getStrNWidthPrecise(const UTF16 *str, U32 n)
 {
    AssertFatal(str != NULL, "GFont::getStrNWidth: String is NULL");
 
+   if (str == NULL || str[0] == '\0' || n == 0)   
+      return(0);
+
+   U64 hash;
+   U32 length, width;
+   if (findLayout(str, n, LayoutWidthPrecise, hash, length, width))
+      return width;
+
+   width = calcStrNWidthPrecise(str, n);
+   storeLayout(hash, length, LayoutWidthPrecise, width);
+   return width;
+}
+
+U32 GFont::calcStrNWidthPrecise(const UTF16 *str, U32 n)
+{
+
    if (str == NULL || str[0] == '\0' || n == 0)   
       return(0);
       
@@ -799,6 +1040,22 @@ U32 GFont::getBreakPos(const UTF16 *str16, U32 slen, U32 width, bool breakOnWhit
    if(slen==0)
       return 0;
 
+   // The query type is packed in with the width.
+   const U32 key = (width << 2) | (breakOnWhitespace ? LayoutBreakOnWhitespace : LayoutBreak);
+
+   U64 hash;
+   U32 length, breakPos;
+   if (findLayout(str16, slen, key, hash, length, breakPos))
+      return breakPos;
+
+   breakPos = calcBreakPos(str16, slen, width, breakOnWhitespace);
+   storeLayout(hash, length, key, breakPos);
+   return breakPos;
+}
+
+U32 GFont::calcBreakPos(const UTF16 *str16, U32 slen, U32 width, bool breakOnWhitespace)
+{
+
    U32 ret = 0;
    U32 lastws = 0;
    UTF16 c;
@@ -833,6 +1090,63 @@ U32 GFont::getBreakPos(const UTF16 *str16, U32 slen, U32 width, bool breakOnWhit
    return ret;
 }
 
+//////////////////////////////////////////////////////////////////////////
+
+void GFont::clearLayoutCache()
+{
+   dMemset(mLayoutCache, 0, sizeof(mLayoutCache));
+   mLayoutCacheHits = 0;
+   mLayoutCacheMisses = 0;
+}
+
+bool GFont::findLayout(const UTF16 *str, U32 n, U32 key, U64 &hash, U32 &length, U32 &result)
+{
+   // FNV-1a over the characters up to the terminator or the requested count.
+   hash = 14695981039346656037ULL;
+   for(length = 0; length < n && str[length] != 0; length++)
+   {
+      hash ^= str[length];
+      hash *= 1099511628211ULL;
+   }
+
+   // Measuring past the terminator can give a different result.
+   if(length < n)
+   {
+      hash ^= 0x10000;
+      hash *= 1099511628211ULL;
+   }
+
+   // Short strings aren't worth caching.
+   if(length < LayoutCacheMinLength)
+   {
+      length = 0;
+      return false;
+   }
+
+   const LayoutCacheEntry& entry = mLayoutCache[(U32(hash) ^ (key * 2654435761U)) & (LayoutCacheSize - 1)];
+   if(entry.mHash == hash && entry.mKey == key && entry.mLength == length)
+   {
+      mLayoutCacheHits++;
+      result = entry.mResult;
+      return true;
+   }
+
+   mLayoutCacheMisses++;
+   return false;
+}
+
+void GFont::storeLayout(U64 hash, U32 length, U32 key, U32 result)
+{
+   if(length == 0)
+      return;
+
+   LayoutCacheEntry& entry = mLayoutCache[(U32(hash) ^ (key * 2654435761U)) & (LayoutCacheSize - 1)];
+   entry.mHash = hash;
+   entry.mKey = key;
+   entry.mLength = length;
+   entry.mResult = result;
+}
+
 void GFont::wrapString(const UTF8 *txt, U32 lineWidth, Vector<U32> &startLineOffset, Vector<U32> &lineLen)
 {
    Con::errorf("GFont::wrapString(): Not yet converted to be UTF-8 safe");
@@ -1184,6 +1498,9 @@ void GFont::importStrip(const char *fileName, U32 padding, U32 kerning)
    mCurSheet = mCurX = mCurY = 0;
    mTextureSheets.clear();
 
+   // Kerning changes the character advances.
+   clearLayoutCache();
+
    //  Now, load the font strip.
    GBitmap *strip = GBitmap::load(fileName);
 
@@ -59,6 +59,9 @@ class GFont : public ResourceInstance
 {
    friend ResourceInstance* constructNewFont(Stream& stream);
 
+   class PrewarmThread;
+   friend class PrewarmThread;
+
    static const U32 csm_fileVersion;
    static S32 smSheetIdCount;
    
@@ -69,6 +72,17 @@ public:
    {
       TabWidthInSpaces = 3,
       TextureSheetSize = 256,
+      LayoutCacheSize = 512,       ///< Number of cached layout results, must be a power of two.
+      LayoutCacheMinLength = 8,    ///< Shorter strings are cheaper to measure than to look up.
+   };
+
+   /// Layout cache query types.
+   enum LayoutQuery
+   {
+      LayoutWidth,
+      LayoutWidthPrecise,
+      LayoutBreak,
+      LayoutBreakOnWhitespace,
    };
 
 
@@ -96,18 +110,53 @@ private:
                                           //    be accessed through the getCharInfo(U32)
                                           //    function to account for remapping...
    S32             mRemapTable[65536];    // - Index remapping
+
+   /// Cached result of a width or line-break query.
+   struct LayoutCacheEntry
+   {
+      U64 mHash;     ///< Hash of the string contents.
+      U32 mKey;      ///< Query type and width.
+      U32 mLength;   ///< Length of the string.
+      U32 mResult;
+   };
+
+   LayoutCacheEntry mLayoutCache[LayoutCacheSize];
+   U32 mLayoutCacheHits;
+   U32 mLayoutCacheMisses;
+
+   /// Glyph rasterised by the prewarm thread waiting to be packed into a sheet.
+   struct PendingGlyph
+   {
+      UTF16 mChar;
+      PlatformFont::CharInfo mCharInfo;
+   };
+
+   Vector<PendingGlyph> mPendingGlyphs;    ///< Guarded by mMutex.
+   Vector<UTF16> mPrewarmChars;           ///< Guarded by mMutex.
+   volatile U32 mPendingGlyphCount;
+   bool mPrewarmRunning;                  ///< Guarded by mMutex.
+   PrewarmThread* mPrewarmThread;
+
+   /// Platform fonts may share rasterising state so only one glyph is rasterised at a time.
+   static void* smRasterMutex;
 public:
    GFont();
    virtual ~GFont();
 
 protected:
     bool loadCharInfo(const UTF16 ch);
-    void addBitmap(PlatformFont::CharInfo &charInfo);
+    void addBitmap(PlatformFont::CharInfo &charInfo, bool refreshSheet = true);
     void addSheet(void);
     void assignSheet(S32 sheetNum, GBitmap *bmp);
 
     void *mMutex;
 
+    bool findLayout(const UTF16 *str, U32 n, U32 key, U64 &hash, U32 &length, U32 &result);
+    void storeLayout(U64 hash, U32 length, U32 key, U32 result);
+    U32 calcStrNWidth(const UTF16 *str, U32 n);
+    U32 calcStrNWidthPrecise(const UTF16 *str, U32 n);
+    U32 calcBreakPos(const UTF16 *str, U32 slen, U32 width, bool breakOnWhitespace);
+
 public:
    static Resource<GFont> create(const char *faceName, U32 size, const char *cacheDirectory, U32 charset = TGE_ANSI_CHARSET);
 
@@ -145,6 +194,21 @@ public:
    
    void wrapString(const UTF8 *string, U32 width, Vector<U32> &startLineOffset, Vector<U32> &lineLen);
 
+   /// Discard all cached width and line-break results.
+   void clearLayoutCache();
+
+   /// Rasterise the specified characters on a background thread.  The glyphs
+   /// are packed into the texture sheets the next time a missing character
+   /// is requested or when flushPendingGlyphs() is called.
+   void prewarm(const UTF16 *chars, U32 count);
+
+   /// Returns true whilst characters are still being rasterised in the background.
+   bool isPrewarming();
+
+   /// Pack any glyphs rasterised in the background into the texture sheets.
+   /// Must be called from the main thread.
+   void flushPendingGlyphs();
+
    /// Dump information about this font to the console.
    void dumpInfo();
 
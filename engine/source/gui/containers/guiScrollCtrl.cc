@@ -226,14 +226,20 @@ void GuiScrollCtrl::addObject(SimObject *object)
 
 GuiControl* GuiScrollCtrl::findHitControl(const Point2I &pt, S32 initialLayer)
 {
-   if(pt.x < mProfile->mBorderThickness || pt.y < mProfile->mBorderThickness)
-      return this;
-   if(pt.x >= mBounds.extent.x - mProfile->mBorderThickness - (mHasVScrollBar ? mScrollBarThickness : 0) ||
-      pt.y >= mBounds.extent.y - mProfile->mBorderThickness - (mHasHScrollBar ? mScrollBarThickness : 0))
+   if(!getChildHitRect().pointInRect(pt))
       return this;
    return Parent::findHitControl(pt, initialLayer);
 }
 
+RectI GuiScrollCtrl::getChildHitRect()
+{
+   // Children can't be hit through the border or the scroll bars.
+   S32 thickness = mProfile->mBorderThickness;
+   return RectI(thickness, thickness,
+                mBounds.extent.x - thickness * 2 - (mHasVScrollBar ? mScrollBarThickness : 0),
+                mBounds.extent.y - thickness * 2 - (mHasHScrollBar ? mScrollBarThickness : 0));
+}
+
 void GuiScrollCtrl::computeSizes()
 {
    S32 thickness = (mProfile ? mProfile->mBorderThickness : 1);
@@ -250,6 +256,7 @@ void GuiScrollCtrl::computeSizes()
    mHasHScrollBar = (mForceHScrollBar == ScrollBarAlwaysOn);
 
    setUpdate();
+   invalidateHitIndex();
 
    if (calcChildExtents())
    {
@@ -419,6 +426,7 @@ void GuiScrollCtrl::scrollTo(S32 x, S32 y)
       GuiControl *ctrl = (GuiControl *) (*i);
       ctrl->mBounds.point -= delta;
    }
+   invalidateHitIndex();
    calcThumbs();
 
    // Execute callback
@@ -219,6 +219,7 @@ public:
    virtual void drawHScrollBar(const Point2I &offset);
    virtual void drawScrollCorner(const Point2I &offset);
    virtual GuiControl* findHitControl(const Point2I &pt, S32 initialLayer = -1);
+   virtual RectI getChildHitRect();
 };
 
 #endif //_GUI_SCROLL_CTRL_H
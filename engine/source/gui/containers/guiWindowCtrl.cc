@@ -175,6 +175,14 @@ GuiControl* GuiWindowCtrl::findHitControl(const Point2I &pt, S32 initialLayer)
       return this;
 }
 
+RectI GuiWindowCtrl::getChildHitRect()
+{
+   // A minimized window hides its children.
+   if (mMinimized)
+      return RectI(0, 0, 0, 0);
+   return Parent::getChildHitRect();
+}
+
 void GuiWindowCtrl::resize(const Point2I &newPosition, const Point2I &newExtent)
 {
    Parent::resize(newPosition, newExtent);
@@ -363,6 +371,7 @@ void GuiWindowCtrl::onMouseUp(const GuiEvent &event)
                         mStandardBounds.extent);
          //set the flag
          mMinimized = false;
+         invalidateHitIndex();
       }
       else
       {
@@ -422,6 +431,7 @@ void GuiWindowCtrl::onMouseUp(const GuiEvent &event)
 
          //set the flag
          mMinimized = true;
+         invalidateHitIndex();
       }
    }
 
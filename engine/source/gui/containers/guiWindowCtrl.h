@@ -125,6 +125,7 @@ class GuiWindowCtrl : public GuiTextCtrl
       void setFont(S32 fntTag);
 
       GuiControl* findHitControl(const Point2I &pt, S32 initialLayer = -1);
+      RectI getChildHitRect();
       void resize(const Point2I &newPosition, const Point2I &newExtent);
 
       void onMouseDown(const GuiEvent &event);
@@ -54,6 +54,7 @@ class GuiSubmenuBackgroundCtrl : public GuiMenuBackgroundCtrl
 public:
    GuiSubmenuBackgroundCtrl(GuiMenuBar *ctrl, GuiMenuTextListCtrl* textList);
    bool pointInControl(const Point2I & parentCoordPoint);
+   bool hasCustomHitTest() { return true; }
    void onMouseDown(const GuiEvent &event);
 };
 
@@ -31,6 +31,7 @@
 #include "gui/guiControl.h"
 #include "gui/guiCanvas.h"
 #include "game/gameInterface.h"
+#include "game/replayBenchmark.h"
 
 IMPLEMENT_CONOBJECT(GuiCanvas);
 
@@ -191,6 +192,41 @@ ConsoleMethod( GuiCanvas, reset, void, 2, 2, "() Use the reset method to reset t
    Canvas->resetUpdateRegions();
 }
 
+ConsoleMethod( GuiCanvas, getRenderStats, const char*, 2, 2, "() Gets the rendering statistics for the last frame.\n"
+                                                                "@return Returns \"rendered cached idleFrames\" where rendered and cached are the number of controls drawn and left untouched in the last frame and idleFrames is the number of frames skipped since the last call to resetRenderStats().")
+{
+   char* pBuffer = Con::getReturnBuffer(64);
+   dSprintf(pBuffer, 64, "%d %d %d", object->getRenderedControls(), object->getCachedControls(), object->getIdleFrames());
+   return pBuffer;
+}
+
+ConsoleMethod( GuiCanvas, resetRenderStats, void, 2, 2, "() Resets the idle frame count reported by getRenderStats().\n"
+                                                                "@return No return value")
+{
+   object->resetIdleFrames();
+}
+
+ConsoleMethod( GuiCanvas, getHitTestStats, const char*, 2, 2, "() Gets the hit-testing statistics.\n"
+                                                                "@return Returns \"tested entries rebuilds\" where tested is the number of controls tested by the last hit-test, entries is the number of controls in the hit index and rebuilds is the number of index rebuilds since the last call to resetHitTestStats().")
+{
+   char* pBuffer = Con::getReturnBuffer(64);
+   dSprintf(pBuffer, 64, "%d %d %d", object->getHitTestCost(), object->getHitIndexSize(), object->getHitIndexRebuilds());
+   return pBuffer;
+}
+
+ConsoleMethod( GuiCanvas, resetHitTestStats, void, 2, 2, "() Resets the index rebuild count reported by getHitTestStats().\n"
+                                                                "@return No return value")
+{
+   object->resetHitTestStats();
+}
+
+ConsoleMethod( GuiCanvas, invalidateHitIndex, void, 2, 2, "() Forces the hit index to be rebuilt before the next hit-test.\n"
+                                                                "Call this after moving controls without going through resize().\n"
+                                                                "@return No return value")
+{
+   object->invalidateHitIndex();
+}
+
 ConsoleMethod( GuiCanvas, getCursorPos, const char*, 2, 2, "() Use the getCursorPos method to retrieve the current position of the mouse pointer.\n"
                                                                 "@return Returns a vector containing the �x y� coordinates of the cursor in the canvas")
 {
@@ -349,6 +385,16 @@ ConsoleFunction( createCanvas, bool, 2, 2, "( WindowTitle ) Use the createCanvas
 {
     AssertISV(!Canvas, "CreateCanvas: canvas has already been instantiated");
 
+    // Is the engine running headless?
+    if ( Platform::isHeadless() )
+    {
+        // Yes, so create the canvas without a window.
+        Canvas = new GuiCanvas();
+        Canvas->registerObject("Canvas");
+        Canvas->setExtent(Point2I(MIN_RESOLUTION_X, MIN_RESOLUTION_Y));
+        return true;
+    }
+
     Platform::initWindow(Point2I(MIN_RESOLUTION_X, MIN_RESOLUTION_Y), argv[1]);
 
 
@@ -460,6 +506,17 @@ GuiCanvas::GuiCanvas()
     /// Background color.
     mBackgroundColor.set( 0.0f, 0.0f, 0.0f, 0.0f );
     mUseBackgroundColor = true;
+
+    mUseDirtyRendering = false;
+    mRenderedControls = 0;
+    mCachedControls = 0;
+    mIdleFrames = 0;
+
+    mUseHitIndex = false;
+    mHitIndexDirty = true;
+    mHitGridSize.set(0, 0);
+    mHitTestCost = 0;
+    mHitIndexRebuilds = 0;
 }
 
 GuiCanvas::~GuiCanvas()
@@ -479,6 +536,43 @@ void GuiCanvas::initPersistFields()
     // Physics.
     addField("UseBackgroundColor", TypeBool, Offset(mUseBackgroundColor, GuiCanvas), "" );
     addField("BackgroundColor", TypeColorF, Offset(mBackgroundColor, GuiCanvas), "" );
+    addProtectedField("UseDirtyRendering", TypeBool, Offset(mUseDirtyRendering, GuiCanvas), &setUseDirtyRendering, &defaultProtectedGetFn, "Whether only dirty regions are repainted and clean frames are skipped." );
+    addProtectedField("UseHitIndex", TypeBool, Offset(mUseHitIndex, GuiCanvas), &setUseHitIndex, &defaultProtectedGetFn, "Whether mouse hit-testing uses a cached spatial index of the controls." );
+}
+
+//------------------------------------------------------------------------------
+
+void GuiCanvas::setUseDirtyRendering( const bool useDirtyRendering )
+{
+    // Ignore no change.
+    if ( useDirtyRendering == mUseDirtyRendering )
+        return;
+
+    mUseDirtyRendering = useDirtyRendering;
+
+    // Start from a fully painted canvas.
+    resetUpdateRegions();
+}
+
+//------------------------------------------------------------------------------
+
+void GuiCanvas::setUseHitIndex( const bool useHitIndex )
+{
+    // Ignore no change.
+    if ( useHitIndex == mUseHitIndex )
+        return;
+
+    mUseHitIndex = useHitIndex;
+
+    // Release the index when it is no longer used.
+    if ( !mUseHitIndex )
+    {
+        mHitEntries.clear();
+        mHitCellStart.clear();
+        mHitCellEntries.clear();
+    }
+
+    mHitIndexDirty = true;
 }
 
 //------------------------------------------------------------------------------
@@ -954,6 +1048,156 @@ void GuiCanvas::findMouseControl(const GuiEvent &event)
    }
 }
 
+GuiControl* GuiCanvas::findHitControl(const Point2I &pt, S32 initialLayer)
+{
+   smHitTestCount = 0;
+
+   // Layered searches and points off the canvas walk the control tree.
+   if (!mUseHitIndex || initialLayer >= 0 || !RectI(Point2I(0, 0), mBounds.extent).pointInRect(pt))
+   {
+      GuiControl *hitCtrl = Parent::findHitControl(pt, initialLayer);
+      mHitTestCost = smHitTestCount;
+      return hitCtrl;
+   }
+
+   // The canvas extent is also set directly when the window resizes.
+   const Point2I gridSize((mBounds.extent.x + HitCellSize - 1) / HitCellSize,
+                          (mBounds.extent.y + HitCellSize - 1) / HitCellSize);
+   if (mHitIndexDirty || gridSize != mHitGridSize)
+      buildHitIndex();
+
+   GuiControl *hitCtrl = findIndexedHitControl(pt);
+
+   // Controls can be moved without going through resize(), so make sure the
+   // hit control is still under the point and rebuild the index if it is not.
+   if (hitCtrl != this && !RectI(hitCtrl->localToGlobalCoord(Point2I(0, 0)), hitCtrl->getExtent()).pointInRect(pt))
+   {
+      buildHitIndex();
+      hitCtrl = findIndexedHitControl(pt);
+   }
+
+   mHitTestCost = smHitTestCount;
+   return hitCtrl;
+}
+
+void GuiCanvas::buildHitIndex()
+{
+   mHitEntries.clear();
+   mHitCellStart.clear();
+   mHitCellEntries.clear();
+   mHitIndexDirty = false;
+   mHitIndexRebuilds++;
+
+   addHitEntries(this, Point2I(0, 0), RectI(Point2I(0, 0), mBounds.extent));
+
+   mHitGridSize.set((mBounds.extent.x + HitCellSize - 1) / HitCellSize,
+                    (mBounds.extent.y + HitCellSize - 1) / HitCellSize);
+   if (mHitGridSize.x <= 0 || mHitGridSize.y <= 0)
+   {
+      mHitGridSize.set(0, 0);
+      return;
+   }
+
+   // Count the entries overlapping each cell, then turn the counts into
+   // offsets so every cell's entries are contiguous in mHitCellEntries.
+   const U32 cellCount = mHitGridSize.x * mHitGridSize.y;
+   mHitCellStart.setSize(cellCount + 1);
+   dMemset(mHitCellStart.address(), 0, (cellCount + 1) * sizeof(U32));
+
+   for (U32 i = 0; i < (U32)mHitEntries.size(); i++)
+   {
+      const RectI &clipRect = mHitEntries[i].mClipRect;
+      for (S32 y = clipRect.point.y / HitCellSize; y <= (clipRect.point.y + clipRect.extent.y - 1) / HitCellSize; y++)
+         for (S32 x = clipRect.point.x / HitCellSize; x <= (clipRect.point.x + clipRect.extent.x - 1) / HitCellSize; x++)
+            mHitCellStart[y * mHitGridSize.x + x + 1]++;
+   }
+
+   for (U32 cell = 0; cell < cellCount; cell++)
+      mHitCellStart[cell + 1] += mHitCellStart[cell];
+
+   // Entries are visited in hit order so each cell stays sorted.
+   Vector<U32> cellFill;
+   cellFill.setSize(cellCount);
+   dMemcpy(cellFill.address(), mHitCellStart.address(), cellCount * sizeof(U32));
+   mHitCellEntries.setSize(mHitCellStart[cellCount]);
+
+   for (U32 i = 0; i < (U32)mHitEntries.size(); i++)
+   {
+      const RectI &clipRect = mHitEntries[i].mClipRect;
+      for (S32 y = clipRect.point.y / HitCellSize; y <= (clipRect.point.y + clipRect.extent.y - 1) / HitCellSize; y++)
+         for (S32 x = clipRect.point.x / HitCellSize; x <= (clipRect.point.x + clipRect.extent.x - 1) / HitCellSize; x++)
+            mHitCellEntries[cellFill[y * mHitGridSize.x + x]++] = i;
+   }
+}
+
+void GuiCanvas::addHitEntries(GuiControl *ctrl, const Point2I &offset, const RectI &clipRect)
+{
+   // Mirror GuiControl::findHitControl: children in z order (last to first),
+   // each child's own children ahead of it, and only modal controls are hits.
+   iterator i = ctrl->end();
+   while (i != ctrl->begin())
+   {
+      i--;
+      GuiControl *child = static_cast<GuiControl *>(*i);
+      if (!child->mVisible)
+         continue;
+
+      const Point2I childOffset = offset + child->getPosition();
+      RectI childRect(childOffset, child->getExtent());
+      if (!childRect.intersect(clipRect))
+         continue;
+
+      HitEntry entry;
+      entry.mControl = child;
+      entry.mClipRect = childRect;
+      entry.mParentOffset = offset;
+      entry.mCustom = child->hasCustomHitTest();
+
+      if (entry.mCustom)
+      {
+         mHitEntries.push_back(entry);
+         continue;
+      }
+
+      RectI childHitRect = child->getChildHitRect();
+      childHitRect.point += childOffset;
+      if (childHitRect.intersect(childRect))
+         addHitEntries(child, childOffset, childHitRect);
+
+      if (child->mProfile && child->mProfile->mModal)
+         mHitEntries.push_back(entry);
+   }
+}
+
+GuiControl* GuiCanvas::findIndexedHitControl(const Point2I &pt)
+{
+   if (mHitCellStart.empty())
+      return this;
+
+   const U32 cell = (pt.y / HitCellSize) * mHitGridSize.x + (pt.x / HitCellSize);
+   for (U32 i = mHitCellStart[cell]; i < mHitCellStart[cell + 1]; i++)
+   {
+      const HitEntry &entry = mHitEntries[mHitCellEntries[i]];
+      smHitTestCount++;
+      if (!entry.mClipRect.pointInRect(pt))
+         continue;
+
+      if (!entry.mCustom)
+         return entry.mControl;
+
+      // Let controls with their own hit-testing resolve the point.
+      GuiControl *ctrl = entry.mControl;
+      const Point2I parentPoint = pt - entry.mParentOffset;
+      if (ctrl->pointInControl(parentPoint))
+      {
+         GuiControl *hitCtrl = ctrl->findHitControl(parentPoint - ctrl->getPosition());
+         if (hitCtrl->mProfile->mModal)
+            return hitCtrl;
+      }
+   }
+   return this;
+}
+
 //Luma: Some fixes from the forums, Dave Calabrese
 //http://www.garagegames.com/community/forums/viewthread/93467/1#comment-669559
 void GuiCanvas::rootScreenTouchDown(const GuiEvent &event)
@@ -1496,7 +1740,7 @@ void GuiCanvas::paint()
 
 void GuiCanvas::maintainSizing()
 {
-   Point2I size = Platform::getWindowSize();
+   Point2I size = getCanvasSize();
 
    if(size.x == 0 || size.y == 0)
       return;
@@ -1527,16 +1771,8 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
 {
    PROFILE_START(CanvasPreRender);
 
-#ifndef TORQUE_OS_IOS
-    
-   if(mRenderFront)
-      glDrawBuffer(GL_FRONT);
-   else
-      glDrawBuffer(GL_BACK);
-#endif
-
    // Make sure the root control is the size of the canvas.
-   Point2I size = Platform::getWindowSize();
+   Point2I size = getCanvasSize();
 
    if(size.x == 0 || size.y == 0)
    {
@@ -1547,17 +1783,33 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
 
    RectI screenRect(0, 0, size.x, size.y);
 
-   maintainSizing();
+   {
+      ReplayBenchmark::SampleScope benchmarkSample(ReplayBenchmark::SampleRenderPrepare);
+
+      maintainSizing();
 
-   //preRender (recursive) all controls
-   preRender();
+      //preRender (recursive) all controls
+      preRender();
+   }
    PROFILE_END();
    if(preRenderOnly)
       return;
 
-   // for now, just always reset the update regions - this is a
-   // fix for FSAA on ATI cards
-   resetUpdateRegions();
+#ifndef TORQUE_OS_IOS
+    
+   if(mRenderFront)
+      glDrawBuffer(GL_FRONT);
+   else
+      glDrawBuffer(GL_BACK);
+#endif
+
+   // unless only dirty regions are being rendered, just always reset
+   // the update regions - this is a fix for FSAA on ATI cards
+   if (!mUseDirtyRendering)
+      resetUpdateRegions();
+
+   GuiControl::smRenderedCount = 0;
+   GuiControl::smCachedCount = 0;
 
 // Moved this below object integration for performance reasons. -JDD
 //   // finish the gl render so we don't get too far ahead of ourselves
@@ -1582,26 +1834,19 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
    if(!mouseCursor)
       mouseCursor = defaultCursor;
 
-   if(lastCursorON && lastCursor)
-   {
-      Point2I spot = lastCursor->getHotSpot();
-      Point2I cext = lastCursor->getExtent();
-      Point2I pos = lastCursorPt - spot;
-      addUpdateRegion(pos - Point2I(2, 2), Point2I(cext.x + 4, cext.y + 4));
-   }
-   if(cursorVisible && mouseCursor)
+   updateCursorRegion(mouseCursor, cursorVisible, cursorPos);
+
+   // Tooltips are drawn over everything else so repaint the whole canvas
+   // whilst one is showing or is due to be shown.
+   if (mUseDirtyRendering && bool(mMouseControl))
    {
-      Point2I spot = mouseCursor->getHotSpot();
-      Point2I cext = mouseCursor->getExtent();
-      Point2I pos = cursorPos - spot;
+      const bool tooltipDue = hoverControl == mMouseControl && mMouseControl->hasTooltip() &&
+         (Platform::getRealMilliseconds() - hoverControlStart) >= (U32)mMouseControl->mTipHoverTime;
 
-      addUpdateRegion(pos - Point2I(2, 2), Point2I(cext.x + 4, cext.y + 4));
+      if (hoverPositionSet || tooltipDue)
+         resetUpdateRegions();
    }
 
-    lastCursorON = cursorVisible;
-    lastCursor = mouseCursor;
-    lastCursorPt = cursorPos;
-
    RectI updateUnion;
    buildUpdateUnion(&updateUnion);
    if (updateUnion.intersect(screenRect))
@@ -1610,7 +1855,19 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
     if ( mUseBackgroundColor )
     {
         glClearColor( mBackgroundColor.red, mBackgroundColor.green, mBackgroundColor.blue, mBackgroundColor.alpha );
-        glClear(GL_COLOR_BUFFER_BIT);	
+
+        // Only clear the dirty region so the rest of the previous frame is kept.
+        if ( mUseDirtyRendering )
+        {
+            glScissor( updateUnion.point.x, size.y - (updateUnion.point.y + updateUnion.extent.y), updateUnion.extent.x, updateUnion.extent.y );
+            glEnable( GL_SCISSOR_TEST );
+            glClear( GL_COLOR_BUFFER_BIT );
+            glDisable( GL_SCISSOR_TEST );
+        }
+        else
+        {
+            glClear(GL_COLOR_BUFFER_BIT);	
+        }
     }
 
       //render the dialogs
@@ -1621,6 +1878,7 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
          dglSetClipRect(updateUnion);
          glDisable( GL_CULL_FACE );
          contentCtrl->onRender(contentCtrl->getPosition(), updateUnion);
+         GuiControl::smRenderedCount++;
       }
 
       // Tooltip resource
@@ -1694,6 +1952,19 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
          mouseCursor->render(pos);
       }
    }
+   else if (mUseDirtyRendering)
+   {
+      // Nothing is dirty so the displayed frame is still valid.
+      mRenderedControls = 0;
+      mCachedControls = 0;
+      mIdleFrames++;
+
+      PROFILE_END();
+      return;
+   }
+
+   mRenderedControls = GuiControl::smRenderedCount;
+   mCachedControls = GuiControl::smCachedCount;
 
    PROFILE_END();
 
@@ -1718,28 +1989,50 @@ void GuiCanvas::swapBuffers()
    PROFILE_END();
 }
 
-void GuiCanvas::buildUpdateUnion(RectI *updateUnion)
+void GuiCanvas::updateCursorRegion(GuiCursor *cursor, const bool visible, const Point2I &pos)
 {
-   *updateUnion = mOldUpdateRects[0];
-
-   //the update region should encompass the oldUpdateRects, and the curUpdateRect
-   Point2I upperL;
-   Point2I lowerR;
+   // a cursor that has not changed is already on screen
+   if(visible == lastCursorON && cursor == lastCursor && pos == lastCursorPt)
+      return;
 
-   upperL.x = getMin(mOldUpdateRects[0].point.x, mOldUpdateRects[1].point.x);
-   upperL.x = getMin(upperL.x, mCurUpdateRect.point.x);
+   if(lastCursorON && lastCursor)
+   {
+      Point2I spot = lastCursor->getHotSpot();
+      Point2I cext = lastCursor->getExtent();
+      Point2I oldPos = lastCursorPt - spot;
+      addUpdateRegion(oldPos - Point2I(2, 2), Point2I(cext.x + 4, cext.y + 4));
+   }
+   if(visible && cursor)
+   {
+      Point2I spot = cursor->getHotSpot();
+      Point2I cext = cursor->getExtent();
+      Point2I newPos = pos - spot;
+      addUpdateRegion(newPos - Point2I(2, 2), Point2I(cext.x + 4, cext.y + 4));
+   }
 
-   upperL.y = getMin(mOldUpdateRects[0].point.y, mOldUpdateRects[1].point.y);
-   upperL.y = getMin(upperL.y, mCurUpdateRect.point.y);
+   lastCursorON = visible;
+   lastCursor = cursor;
+   lastCursorPt = pos;
+}
 
-   lowerR.x = getMax(mOldUpdateRects[0].point.x + mOldUpdateRects[0].extent.x, mOldUpdateRects[1].point.x + mOldUpdateRects[1].extent.x);
-   lowerR.x = getMax(lowerR.x, mCurUpdateRect.point.x + mCurUpdateRect.extent.x);
+void GuiCanvas::buildUpdateUnion(RectI *updateUnion)
+{
+   //the update region should encompass the oldUpdateRects, and the curUpdateRect.
+   //empty rects are skipped, otherwise they would stretch the union to the origin.
+   const RectI *rects[3] = { &mOldUpdateRects[0], &mOldUpdateRects[1], &mCurUpdateRect };
 
-   lowerR.y = getMax(mOldUpdateRects[0].point.y + mOldUpdateRects[0].extent.y, mOldUpdateRects[1].point.y + mOldUpdateRects[1].extent.y);
-   lowerR.y = getMax(lowerR.y, mCurUpdateRect.point.y + mCurUpdateRect.extent.y);
+   updateUnion->point.set(0,0);
+   updateUnion->extent.set(0,0);
+   for(U32 i = 0; i < 3; i++)
+   {
+      if(!rects[i]->isValidRect())
+         continue;
 
-   updateUnion->point = upperL;
-   updateUnion->extent = lowerR - upperL;
+      if(updateUnion->isValidRect())
+         updateUnion->unionRects(*rects[i]);
+      else
+         *updateUnion = *rects[i];
+   }
 
    //shift the oldUpdateRects
    mOldUpdateRects[0] = mOldUpdateRects[1];
@@ -1751,7 +2044,10 @@ void GuiCanvas::buildUpdateUnion(RectI *updateUnion)
 
 void GuiCanvas::addUpdateRegion(Point2I pos, Point2I ext)
 {
-   if(mCurUpdateRect.extent.x == 0)
+   if(ext.x <= 0 || ext.y <= 0)
+      return;
+
+   if(!mCurUpdateRect.isValidRect())
    {
       mCurUpdateRect.point = pos;
       mCurUpdateRect.extent = ext;
@@ -72,6 +72,16 @@
 /// screen will be painted normally. If you are making an animated GuiControl
 /// you need to add your control to the dirty areas of the canvas.
 ///
+/// By default the whole canvas is still repainted every frame. Setting
+/// UseDirtyRendering makes the canvas repaint only the dirty regions, leaving
+/// the rest of the previous frames in place, and skip rendering and the buffer
+/// swap entirely when nothing is dirty.
+///
+/// Setting UseHitIndex makes mouse hit-testing use a flattened index of the
+/// visible, modal controls bucketed into a screen grid, instead of walking the
+/// whole control tree on every mouse move. The index is rebuilt lazily when a
+/// control is added, removed, resized, shown or hidden.
+///
 class GuiCanvas : public GuiControl
 {
 
@@ -91,6 +101,39 @@ protected:
    RectI      mOldUpdateRects[2];
    RectI      mCurUpdateRect;
    F32        rLastFrameTime;
+
+   bool       mUseDirtyRendering;  ///< Only repaint dirty regions and skip frames where nothing is dirty.
+   U32        mRenderedControls;   ///< Controls rendered in the last frame.
+   U32        mCachedControls;     ///< Controls left untouched in the last frame.
+   U32        mIdleFrames;         ///< Frames skipped because nothing was dirty.
+   /// @}
+
+   /// @name Hit Testing
+   /// @{
+
+   /// A control in the hit index, stored in hit order.
+   struct HitEntry
+   {
+      GuiControl* mControl;
+      RectI       mClipRect;     ///< Screen area the control can be hit in.
+      Point2I     mParentOffset; ///< Screen position of the control's parent.
+      bool        mCustom;       ///< Resolve the hit using the control's own findHitControl.
+   };
+
+   enum { HitCellSize = 64 };
+
+   bool              mUseHitIndex;       ///< Hit-test using the index rather than the control tree.
+   bool              mHitIndexDirty;     ///< The layout has changed since the index was built.
+   Vector<HitEntry>  mHitEntries;
+   Vector<U32>       mHitCellStart;      ///< Offset of each cell's first entry in mHitCellEntries.
+   Vector<U32>       mHitCellEntries;    ///< Entry indices per cell, in hit order.
+   Point2I           mHitGridSize;       ///< Grid size in cells.
+   U32               mHitTestCost;       ///< Controls tested by the last hit-test.
+   U32               mHitIndexRebuilds;  ///< Index rebuilds since the last resetHitTestStats().
+
+   void buildHitIndex();
+   void addHitEntries(GuiControl *ctrl, const Point2I &offset, const RectI &clipRect);
+   GuiControl* findIndexedHitControl(const Point2I &pt);
    /// @}
 
    /// @name Cursor Properties
@@ -165,6 +208,9 @@ protected:
 
    /// @}
 
+   static bool setUseDirtyRendering( void* obj, const char* data ) { static_cast<GuiCanvas*>(obj)->setUseDirtyRendering(dAtob(data)); return false; }
+   static bool setUseHitIndex( void* obj, const char* data ) { static_cast<GuiCanvas*>(obj)->setUseHitIndex(dAtob(data)); return false; }
+
 public:
    DECLARE_CONOBJECT(GuiCanvas);
    GuiCanvas();
@@ -179,6 +225,24 @@ public:
     inline void             setUseBackgroundColor( const bool useBackgroundColor ) { mUseBackgroundColor = useBackgroundColor; }
     inline bool             getUseBackgroundColor( void ) const         { return mUseBackgroundColor; }
 
+    /// Dirty rendering.
+    void                    setUseDirtyRendering( const bool useDirtyRendering );
+    inline bool             getUseDirtyRendering( void ) const          { return mUseDirtyRendering; }
+    inline U32              getRenderedControls( void ) const           { return mRenderedControls; }
+    inline U32              getCachedControls( void ) const             { return mCachedControls; }
+    inline U32              getIdleFrames( void ) const                 { return mIdleFrames; }
+    inline void             resetIdleFrames( void )                     { mIdleFrames = 0; }
+
+    /// Hit testing.
+    void                    setUseHitIndex( const bool useHitIndex );
+    inline bool             getUseHitIndex( void ) const                { return mUseHitIndex; }
+    inline U32              getHitTestCost( void ) const                { return mHitTestCost; }
+    inline U32              getHitIndexSize( void ) const               { return mHitEntries.size(); }
+    inline U32              getHitIndexRebuilds( void ) const           { return mHitIndexRebuilds; }
+    inline void             resetHitTestStats( void )                   { mHitIndexRebuilds = 0; }
+    virtual void            invalidateHitIndex( void )                  { mHitIndexDirty = true; }
+    virtual GuiControl*     findHitControl( const Point2I &pt, S32 initialLayer = -1 );
+
    /// @name Rendering methods
    ///
    /// @{
@@ -203,8 +267,19 @@ public:
    /// Resizes the content control to match the canvas size.
    void maintainSizing();
 
+   /// Size of the window, or of the canvas itself when running headless.
+   Point2I getCanvasSize() const { return Platform::isHeadless() ? mBounds.extent : Platform::getWindowSize(); }
+
+   /// Marks the areas under the old and new cursor dirty, but only if the
+   /// cursor moved, changed image, or was shown or hidden since the last call.
+   /// @param   cursor    Cursor to draw this frame
+   /// @param   visible   Whether the cursor is drawn
+   /// @param   pos       Screen position of the cursor's hot spot
+   virtual void updateCursorRegion(GuiCursor *cursor, const bool visible, const Point2I &pos);
+
    /// This builds a rectangle which encompasses all of the dirty regions to be
-   /// repainted
+   /// repainted. Empty regions are ignored, so the union is empty when nothing
+   /// is dirty.
    /// @param   updateUnion   (out) Rectangle which surrounds all dirty areas
    virtual void buildUpdateUnion(RectI *updateUnion);
 
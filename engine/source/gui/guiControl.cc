@@ -52,6 +52,10 @@ GuiEditCtrl *GuiControl::smEditorHandle = NULL;
 
 bool GuiControl::smDesignTime = false;
 
+U32 GuiControl::smRenderedCount = 0;
+U32 GuiControl::smCachedCount = 0;
+U32 GuiControl::smHitTestCount = 0;
+
 GuiControl::GuiControl()
 {
    mLayer = 0;
@@ -229,7 +233,11 @@ void GuiControl::addObject(SimObject *object)
 
    AssertFatal(!ctrl->isAwake(), "GuiControl::addObject: object is already awake before add");
    if(mAwake)
+   {
       ctrl->awaken();
+      ctrl->setUpdate();
+      invalidateHitIndex();
+   }
 
   // If we are a child, notify our parent that we've been removed
   GuiControl *parent = ctrl->getParent();
@@ -243,7 +251,12 @@ void GuiControl::removeObject(SimObject *object)
 {
    AssertFatal(mAwake == static_cast<GuiControl*>(object)->isAwake(), "GuiControl::removeObject: child control wake state is bad");
    if (mAwake)
+   {
+      // Repaint the area the control occupied.
+      static_cast<GuiControl*>(object)->setUpdate();
       static_cast<GuiControl*>(object)->sleep();
+      invalidateHitIndex();
+   }
     Parent::removeObject(object);
 }
 
@@ -348,9 +361,14 @@ void GuiControl::resize(const Point2I &newPosition, const Point2I &newExtent)
       if (parent)
          parent->childResized(this);
       setUpdate();
+      invalidateHitIndex();
    }
-   else {
+   else if (newPosition != mBounds.point) {
+      //update both the old and new areas
+      setUpdate();
       mBounds.point = newPosition;
+      setUpdate();
+      invalidateHitIndex();
    }
 }
 void GuiControl::setPosition( const Point2I &newPosition )
@@ -637,6 +655,12 @@ void GuiControl::renderChildControls(Point2I offset, const RectI &updateRect)
             dglSetClipRect(childClip);
             glDisable(GL_CULL_FACE);
             ctrl->onRender(childPosition, childClip);
+            smRenderedCount++;
+         }
+         else
+         {
+            // Outside the dirty region so the previous frame is still valid.
+            smCachedCount++;
          }
       }
       size_cpy = objectList.size(); //	CHRIS: i know its wierd but the size of the list changes sometimes during execution of this loop
@@ -838,8 +862,10 @@ void GuiControl::setControlProfile(GuiControlProfile *prof)
       mProfile->decRefCount();
    mProfile = prof;
    if(mAwake)
+   {
       mProfile->incRefCount();
-
+      invalidateHitIndex();
+   }
 }
 
 void GuiControl::onPreRender()
@@ -1262,6 +1288,7 @@ GuiControl* GuiControl::findHitControl(const Point2I &pt, S32 initialLayer)
    {
       i--;
       GuiControl *ctrl = static_cast<GuiControl *>(*i);
+      smHitTestCount++;
       if (initialLayer >= 0 && ctrl->mLayer > initialLayer)
       {
          continue;
@@ -1278,6 +1305,13 @@ GuiControl* GuiControl::findHitControl(const Point2I &pt, S32 initialLayer)
    return this;
 }
 
+void GuiControl::invalidateHitIndex()
+{
+   GuiCanvas *root = getRoot();
+   if (root)
+      root->invalidateHitIndex();
+}
+
 // -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- //
 
 bool GuiControl::isMouseLocked()
@@ -1687,6 +1721,7 @@ void GuiControl::setVisible(bool value)
     mVisible = value;
    iterator i;
    setUpdate();
+   invalidateHitIndex();
    for(i = begin(); i != end(); i++)
    {
       GuiControl *ctrl = static_cast<GuiControl *>(*i);
@@ -124,6 +124,14 @@ public:
     static bool smDesignTime; ///< static GuiControl boolean that specifies if the GUI Editor is active
     /// @}
 
+    /// @name Render Statistics
+    /// The canvas resets these at the start of each frame.
+    /// @{
+    static U32 smRenderedCount; ///< Number of controls rendered this frame.
+    static U32 smCachedCount;   ///< Number of visible controls left untouched because they were outside the dirty region.
+    static U32 smHitTestCount;  ///< Number of controls tested by findHitControl since the canvas last reset it.
+    /// @}
+
     /// @name Design Time Editor Access
     /// @{
     static GuiEditCtrl *smEditorHandle; ///< static GuiEditCtrl pointer that gives controls access to editor-NULL if editor is closed
@@ -384,6 +392,9 @@ public:
     /// @param   tipText     optional alternate tip to be rendered
     virtual bool renderTooltip(Point2I cursorPos, const char* tipText = NULL );
 
+    /// Returns true if this control has tooltip text to show
+    inline bool hasTooltip() const { return mTooltip != NULL && mTooltip[0] != '\0'; }
+
     /// Called when this control should render its children
     /// @param   offset   The location this control is to begin rendering
     /// @param   updateRect   The screen area this control has drawing access to
@@ -458,6 +469,18 @@ public:
     /// @param   initialLayer  Layer of gui objects to begin the search
     virtual GuiControl* findHitControl(const Point2I &pt, S32 initialLayer = -1);
 
+    /// Returns the area, in local coordinates, in which findHitControl will
+    /// look for hits among the children of this control
+    virtual RectI getChildHitRect() { return RectI(Point2I(0, 0), mBounds.extent); }
+
+    /// Returns true if pointInControl has been overridden with something other
+    /// than a bounds test, in which case the canvas hit index defers to the
+    /// control's own findHitControl
+    virtual bool hasCustomHitTest() { return false; }
+
+    /// Tells the canvas that the layout has changed and its hit index must be rebuilt
+    virtual void invalidateHitIndex();
+
     /// Lock the mouse within the provided control
     /// @param   lockingControl   Control to lock the mouse within
     void mouseLock(GuiControl *lockingControl);
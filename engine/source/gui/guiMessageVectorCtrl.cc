@@ -389,23 +389,23 @@ void GuiMessageVectorCtrl::createLineWrapping(LineWrapping& rWrapping, const cha
       // Ok, there's some actual text in this line.  How long is it?
       U32 baseLength = mProfile->mFont->getStrNWidthPrecise((const UTF8 *)&string[rLine.start], rLine.end-rLine.start+1);
       if (baseLength > splitWidth) {
-         // DMMNOTE: Replace with bin search eventually
-         U32 currPos;
-         U32 breakPos;
-         for (currPos = 0; currPos < (U32)(rLine.end-rLine.start+1); currPos++) {
-            U32 currLength = mProfile->mFont->getStrNWidthPrecise((const UTF8 *)&string[rLine.start], currPos+1);
-            if (currLength > splitWidth) {
-               // Make sure that the currPos has advanced, then set the breakPoint.
-               breakPos = currPos != 0 ? currPos - 1 : 0;
-               break;
-            }
-         }
-         if (currPos == rLine.end-rLine.start+1) {
-            AssertFatal(false, "Error, if the line must be broken, the position must be before this point!");
-            currLine++;
-            continue;
+         // Binary search for the first position that doesn't fit.  We know the
+         //  whole line doesn't, so the search always finds a position.
+         U32 low  = 0;
+         U32 high = rLine.end-rLine.start;
+         while (low < high) {
+            U32 mid = (low + high) / 2;
+            U32 currLength = mProfile->mFont->getStrNWidthPrecise((const UTF8 *)&string[rLine.start], mid+1);
+            if (currLength > splitWidth)
+               high = mid;
+            else
+               low = mid + 1;
          }
 
+         // Make sure that the currPos has advanced, then set the breakPoint.
+         U32 currPos  = low;
+         U32 breakPos = currPos != 0 ? currPos - 1 : 0;
+
          // Ok, the character at breakPos is the last valid char we can render.  We
          //  want to scan back to the first whitespace character (which, in the bounds
          //  of the line, is guaranteed to be a space or a tab).
@@ -681,10 +681,12 @@ void GuiMessageVectorCtrl::inspectPostApply()
 void GuiMessageVectorCtrl::parentResized(const Point2I& oldSize,
                                          const Point2I& newSize)
 {
+   const S32 oldWidth = mBounds.extent.x;
    Parent::parentResized(oldSize, newSize);
 
-   // If we have a MesssageVector, detach/reattach so we can reflow the text.
-   if (mMessageVector)
+   // If we have a MesssageVector and the width has changed, detach/reattach
+   //  so we can reflow the text.
+   if (mMessageVector && mBounds.extent.x != oldWidth)
    {
       MessageVector *reflowme = mMessageVector;
 
@@ -223,7 +223,7 @@ const U32 GuiTreeViewCtrl::Item::getDisplayTextLength()
 
 void GuiTreeViewCtrl::Item::getDisplayText(U32 bufLen, char *buf)
 {
-   FrameAllocatorMarker txtAlloc;
+   FrameAllocatorMarker txtAlloc("GuiTreeViewCtrl::Item::getDisplayText");
 
    if(mState.test(Item::InspectorData))
    {
@@ -254,7 +254,7 @@ const S32 GuiTreeViewCtrl::Item::getDisplayTextWidth(GFont *font)
    if( !font )
       return 0;
 
-   FrameAllocatorMarker txtAlloc;
+   FrameAllocatorMarker txtAlloc("GuiTreeViewCtrl::Item::getDisplayTextWidth");
    U32 bufLen = getDisplayTextLength();
    if( bufLen == 0 )
       return 0;
@@ -1145,7 +1145,7 @@ bool GuiTreeViewCtrl::buildIconTable(const char * icons)
    U32 textLen = temp ? ( temp - icons ) : dStrlen( icons );
 
    // Allocate temporary space.
-   FrameAllocatorMarker txtBuff;
+   FrameAllocatorMarker txtBuff("GuiTreeViewCtrl::buildIconTable");
    char* drawText = (char*)txtBuff.alloc(sizeof(char) * (textLen + 4));
    dStrncpy( drawText, icons, textLen );
    drawText[textLen] = '\0';
@@ -1250,7 +1250,7 @@ bool GuiTreeViewCtrl::hitTest(const Point2I & pnt, Item* & item, BitSet32 & flag
    min += mTextOffset;
 
    // Check against the text.
-   FrameAllocatorMarker txtAlloc;
+   FrameAllocatorMarker txtAlloc("GuiTreeViewCtrl::hitTest");
    U32 bufLen = item->getDisplayTextLength();
    char *buf = (char*)txtAlloc.alloc(bufLen);
    item->getDisplayText(bufLen, buf);
@@ -3001,7 +3001,7 @@ void GuiTreeViewCtrl::onRenderCell(Point2I offset, Point2I cell, bool, bool )
    RectI drawRect( offset, mCellSize );
    dglClearBitmapModulation();
 
-   FrameAllocatorMarker txtBuff;
+   FrameAllocatorMarker txtBuff("GuiTreeViewCtrl::onRenderCell");
 
    // Ok, we have the item. There are a few possibilities at this point:
    //    - We need to draw inheritance lines and a treeview-chosen icon
@@ -136,6 +136,20 @@ public:
    /// Reads a ranged signed integer written with writeRangedS32.
    S32 readRangedS32( S32 min, S32 max );
 
+   /// Writes an unsigned integer using a short prefix code so that small
+   /// values take few bits (5, 12, 21 or 35 bits in total).
+   void writeVarU32( U32 value );
+
+   /// Reads an unsigned integer written with writeVarU32.
+   U32 readVarU32( void );
+
+   /// Writes a signed integer zig-zag mapped onto writeVarU32 so that values
+   /// close to zero in either direction take few bits.  Suited to deltas.
+   void writeVarS32( S32 value );
+
+   /// Reads a signed integer written with writeVarS32.
+   S32 readVarS32( void );
+
    // read and write floats... floats are 0 to 1 inclusive, signed floats are -1 to 1 inclusive
 
    F32  readFloat(S32 bitCount);
@@ -191,6 +205,10 @@ public:
    bool testBit(S32 bitCount);
 
    bool isFull() { return bitNum > (bufSize << 3); }
+
+   /// Moves the point at which isFull() reports the stream full without
+   /// touching the data.  Writes may still run past it up to the maximum write size.
+   void setWriteSize(S32 size) { AssertFatal((size << 3) <= maxWriteBitNum, "BitStream::setWriteSize - Size is past the end of the buffer."); bufSize = size; }
    bool isValid() { return !error; }
 
    bool _read (const U32 size,void* d);
@@ -267,7 +285,7 @@ inline S32 BitStream::getCurPos() const
 
 inline void BitStream::setCurPos(const U32 in_position)
 {
-   AssertFatal(in_position < (U32)(bufSize << 3), "Out of range bitposition");
+   AssertFatal(in_position <= (U32)(bufSize << 3), "Out of range bitposition");
    bitNum = S32(in_position);
 }
 
@@ -318,6 +336,41 @@ inline S32 BitStream::readRangedS32( S32 min, S32 max )
    return readRangedU32( 0, ( max - min ) ) + min;
 }
 
+inline void BitStream::writeVarU32( U32 value )
+{
+   if ( writeFlag( value < (1 << 4) ) )
+      writeInt( S32(value), 4 );
+   else if ( writeFlag( value < (1 << 10) ) )
+      writeInt( S32(value), 10 );
+   else if ( writeFlag( value < (1 << 18) ) )
+      writeInt( S32(value), 18 );
+   else
+      writeInt( S32(value), 32 );
+}
+
+inline U32 BitStream::readVarU32( void )
+{
+   if ( readFlag() )
+      return U32(readInt( 4 ));
+   else if ( readFlag() )
+      return U32(readInt( 10 ));
+   else if ( readFlag() )
+      return U32(readInt( 18 ));
+
+   return U32(readInt( 32 ));
+}
+
+inline void BitStream::writeVarS32( S32 value )
+{
+   writeVarU32( (U32(value) << 1) ^ U32(value >> 31) );
+}
+
+inline S32 BitStream::readVarS32( void )
+{
+   const U32 value = readVarU32();
+   return S32(value >> 1) ^ -S32(value & 1);
+}
+
 inline void BitStream::writeRangedF32( F32 value, F32 min, F32 max, U32 numBits )
 {
    value = ( mClampF( value, min, max ) - min ) / ( max - min );
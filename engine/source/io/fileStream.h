@@ -77,6 +77,9 @@ public:
 
    bool Flush();
 
+   // maps the whole file read-only, see File::map(). The view lives until close().
+   const U8 *map(U32 *o_pSize = NULL) { return mFile.map(o_pSize); }
+
 
 protected:
    // more mandatory methods from Stream base class...
@@ -0,0 +1,543 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "io/resource/asyncReadQueue.h"
+#include "platform/platformFileIO.h"
+#include "platform/threads/thread.h"
+#include "platform/threads/mutex.h"
+#include "platform/threads/semaphore.h"
+#include "platform/threads/atomic.h"
+#include "io/zip/zipArchive.h"
+#include "console/console.h"
+#include "memory/safeDelete.h"
+#include "memory/frameAllocator.h"
+#include "debug/traceProfiler.h"
+
+//------------------------------------------------------------------------------
+
+class AsyncReadWorker : public Thread
+{
+   AsyncReadQueue* mQueue;
+
+public:
+   AsyncReadWorker( AsyncReadQueue* pQueue ) : Thread( 0, NULL, false ), mQueue( pQueue )
+   {
+   }
+
+   virtual void run( void* arg = 0 )
+   {
+      while ( !checkForStop() )
+      {
+         mQueue->mPendingSemaphore->acquire();
+
+         if ( checkForStop() )
+            break;
+
+         // The main thread may have taken the request in wait() or cancel().
+         AsyncReadRequest* pRequest = mQueue->popPending();
+         if ( pRequest == NULL )
+            continue;
+
+         pRequest->read();
+         mQueue->finishRead( pRequest );
+      }
+
+      FrameAllocator::releaseThread();
+      TraceProfiler::releaseThread();
+   }
+};
+
+//------------------------------------------------------------------------------
+
+AsyncReadRequest::AsyncReadRequest( StringTableEntry path, Priority priority, Callback callback, void* pUserData ) :
+   mPath( path ),
+   mFilePath( NULL ),
+   mZipArchive( NULL ),
+   mCentralDir( NULL ),
+   mHasData( false ),
+   mPriority( priority ),
+   mStatus( Pending ),
+   mCancelled( false ),
+   mData( NULL ),
+   mSize( 0 ),
+   mCallback( callback ),
+   mUserData( pUserData ),
+   mRefCount( 1 ),
+   mNext( NULL )
+{
+}
+
+AsyncReadRequest::~AsyncReadRequest()
+{
+   if ( mData )
+      dRealFree( mData );
+
+   if ( mFilePath )
+      dFree( mFilePath );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadRequest::setFileSource( const char* pFilePath )
+{
+   AssertFatal( getStatus() == Pending, "AsyncReadRequest::setFileSource() - Request has already been submitted." );
+
+   if ( mFilePath )
+      dFree( mFilePath );
+
+   mFilePath = dStrdup( pFilePath );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadRequest::setZipSource( Zip::ZipArchive* pArchive, const Zip::CentralDir* pCentralDir )
+{
+   AssertFatal( getStatus() == Pending, "AsyncReadRequest::setZipSource() - Request has already been submitted." );
+   AssertFatal( pArchive->canReadMapped( pCentralDir ), "AsyncReadRequest::setZipSource() - File cannot be read from the archive mapping." );
+
+   mZipArchive = pArchive;
+   mCentralDir = pCentralDir;
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadRequest::setData( U8* pData, U32 size )
+{
+   AssertFatal( getStatus() == Pending, "AsyncReadRequest::setData() - Request has already been submitted." );
+
+   mData = pData;
+   mSize = size;
+   mHasData = true;
+}
+
+//------------------------------------------------------------------------------
+
+AsyncReadRequest::Status AsyncReadRequest::getStatus( void ) const
+{
+   return (Status)dAtomicRead( mStatus );
+}
+
+//------------------------------------------------------------------------------
+
+U8* AsyncReadRequest::takeData( void )
+{
+   U8* pData = mData;
+   mData = NULL;
+   return pData;
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadRequest::read( void )
+{
+   // [Note] This runs on the workers, so it only touches the request itself
+   // and allocates with dRealMalloc() rather than the memory manager.
+   bool ok = false;
+
+   if ( mHasData )
+   {
+      ok = mData != NULL || mSize == 0;
+   }
+   else if ( mFilePath != NULL )
+   {
+      File file;
+      if ( file.open( mFilePath, File::Read ) == File::Ok )
+      {
+         mSize = file.getSize();
+         if ( mSize == 0 )
+         {
+            ok = true;
+         }
+         else
+         {
+            U32 bytesRead = 0;
+            mData = (U8*)dRealMalloc( mSize );
+            ok = mData != NULL && file.read( mSize, (char*)mData, &bytesRead ) != File::IOError && bytesRead == mSize;
+         }
+
+         file.close();
+      }
+   }
+   else if ( mZipArchive != NULL )
+   {
+      ok = mZipArchive->readMappedFile( mCentralDir, mData, mSize );
+   }
+
+   if ( !ok )
+   {
+      if ( mData )
+         dRealFree( mData );
+
+      mData = NULL;
+      mSize = 0;
+   }
+
+   // Publish the status last so anyone polling sees the data first.
+   dAtomicWrite( mStatus, ok ? Complete : Failed );
+}
+
+//------------------------------------------------------------------------------
+
+AsyncReadQueue::AsyncReadQueue() :
+   mMutex( new Mutex ),
+   mPendingSemaphore( new Semaphore( 0 ) ),
+   mShutdown( false )
+{
+   for ( U32 i = 0; i < AsyncReadRequest::PriorityCount; i++ )
+   {
+      mPendingHead[i] = NULL;
+      mPendingTail[i] = NULL;
+   }
+}
+
+//------------------------------------------------------------------------------
+
+AsyncReadQueue::~AsyncReadQueue()
+{
+   shutdown();
+
+   // Drop the queue's reference to anything that was never dispatched.
+   for ( S32 i = 0; i < mCompleted.size(); i++ )
+      release( mCompleted[i] );
+   mCompleted.clear();
+
+   SAFE_DELETE( mPendingSemaphore );
+   SAFE_DELETE( mMutex );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::startWorkers( void )
+{
+   S32 threadCount = Con::getIntVariable( "$pref::ResourceManager::asyncReadThreads", DefaultThreadCount );
+   if ( threadCount < 1 )
+      threadCount = 1;
+
+   for ( S32 i = 0; i < threadCount; i++ )
+   {
+      AsyncReadWorker* pWorker = new AsyncReadWorker( this );
+      pWorker->start();
+      mWorkers.push_back( pWorker );
+   }
+}
+
+//------------------------------------------------------------------------------
+
+AsyncReadRequest* AsyncReadQueue::create( StringTableEntry path, AsyncReadRequest::Priority priority, AsyncReadRequest::Callback callback, void* pUserData )
+{
+   AssertFatal( priority < AsyncReadRequest::PriorityCount, "AsyncReadQueue::create() - Invalid priority." );
+
+   return new AsyncReadRequest( path, priority, callback, pUserData );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::submit( AsyncReadRequest* pRequest )
+{
+   // The queue holds a reference until the completion has been dispatched.
+   acquire( pRequest );
+
+   MutexHandle handle;
+   handle.lock( mMutex, true );
+
+   if ( mShutdown || pRequest->mHasData || ( pRequest->mFilePath == NULL && pRequest->mZipArchive == NULL ) )
+   {
+      // Nothing to read, so it is already done.
+      pRequest->read();
+      mCompleted.push_back( pRequest );
+      return;
+   }
+
+   const U32 priority = pRequest->mPriority;
+   if ( mPendingTail[priority] )
+      mPendingTail[priority]->mNext = pRequest;
+   else
+      mPendingHead[priority] = pRequest;
+   mPendingTail[priority] = pRequest;
+
+   handle.unlock();
+
+   if ( mWorkers.empty() )
+      startWorkers();
+
+   mPendingSemaphore->release();
+}
+
+//------------------------------------------------------------------------------
+
+AsyncReadRequest* AsyncReadQueue::popPending( void )
+{
+   MutexHandle handle;
+   handle.lock( mMutex, true );
+
+   for ( S32 priority = AsyncReadRequest::PriorityCount - 1; priority >= 0; priority-- )
+   {
+      AsyncReadRequest* pRequest = mPendingHead[priority];
+      if ( pRequest == NULL )
+         continue;
+
+      mPendingHead[priority] = pRequest->mNext;
+      if ( mPendingHead[priority] == NULL )
+         mPendingTail[priority] = NULL;
+      pRequest->mNext = NULL;
+
+      dAtomicWrite( pRequest->mStatus, AsyncReadRequest::Reading );
+      mInFlight.push_back( pRequest );
+      return pRequest;
+   }
+
+   return NULL;
+}
+
+//------------------------------------------------------------------------------
+
+bool AsyncReadQueue::unlinkPending( AsyncReadRequest* pRequest )
+{
+   // Must be called with the mutex held.
+   if ( pRequest->getStatus() != AsyncReadRequest::Pending )
+      return false;
+
+   const U32 priority = pRequest->mPriority;
+   AsyncReadRequest* pPrevious = NULL;
+   for ( AsyncReadRequest* pWalk = mPendingHead[priority]; pWalk; pPrevious = pWalk, pWalk = pWalk->mNext )
+   {
+      if ( pWalk != pRequest )
+         continue;
+
+      if ( pPrevious )
+         pPrevious->mNext = pWalk->mNext;
+      else
+         mPendingHead[priority] = pWalk->mNext;
+
+      if ( mPendingTail[priority] == pWalk )
+         mPendingTail[priority] = pPrevious;
+
+      pWalk->mNext = NULL;
+      return true;
+   }
+
+   return false;
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::finishRead( AsyncReadRequest* pRequest )
+{
+   MutexHandle handle;
+   handle.lock( mMutex, true );
+
+   const S32 index = mInFlight.find_next( pRequest );
+   if ( index != -1 )
+      mInFlight.erase_fast( index );
+   mCompleted.push_back( pRequest );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::acquire( AsyncReadRequest* pRequest )
+{
+   pRequest->mRefCount++;
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::release( AsyncReadRequest* pRequest )
+{
+   AssertFatal( pRequest->mRefCount > 0, "AsyncReadQueue::release() - Request has already been released." );
+
+   if ( --pRequest->mRefCount == 0 )
+      delete pRequest;
+}
+
+//------------------------------------------------------------------------------
+
+bool AsyncReadQueue::cancel( AsyncReadRequest* pRequest )
+{
+   MutexHandle handle;
+   handle.lock( mMutex, true );
+
+   if ( pRequest->mCancelled )
+      return false;
+
+   pRequest->mCancelled = true;
+
+   if ( unlinkPending( pRequest ) )
+   {
+      // Never reached a worker, so drop the queue's reference right away.
+      dAtomicWrite( pRequest->mStatus, AsyncReadRequest::Cancelled );
+      handle.unlock();
+      release( pRequest );
+      return true;
+   }
+
+   // A read in flight is thrown away when it is dispatched.
+   return pRequest->getStatus() == AsyncReadRequest::Reading;
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::wait( AsyncReadRequest* pRequest )
+{
+   MutexHandle handle;
+   handle.lock( mMutex, true );
+
+   if ( unlinkPending( pRequest ) )
+   {
+      // Still waiting for a worker, so read it here rather than wait for one.
+      dAtomicWrite( pRequest->mStatus, AsyncReadRequest::Reading );
+      handle.unlock();
+
+      pRequest->read();
+
+      handle.lock( mMutex, true );
+      mCompleted.push_back( pRequest );
+      return;
+   }
+
+   handle.unlock();
+
+   while ( !pRequest->isDone() )
+      Platform::sleep( 1 );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::flushArchive( Zip::ZipArchive* pArchive )
+{
+   MutexHandle handle;
+   handle.lock( mMutex, true );
+
+   // Fail anything still waiting to read from the archive.
+   for ( U32 priority = 0; priority < AsyncReadRequest::PriorityCount; priority++ )
+   {
+      AsyncReadRequest* pWalk = mPendingHead[priority];
+      while ( pWalk )
+      {
+         AsyncReadRequest* pNext = pWalk->mNext;
+         if ( pWalk->mZipArchive == pArchive )
+         {
+            unlinkPending( pWalk );
+            dAtomicWrite( pWalk->mStatus, AsyncReadRequest::Failed );
+            mCompleted.push_back( pWalk );
+         }
+         pWalk = pNext;
+      }
+   }
+
+   // Wait for reads in flight to finish with it.
+   for ( ;; )
+   {
+      bool reading = false;
+      for ( S32 i = 0; i < mInFlight.size() && !reading; i++ )
+         reading = mInFlight[i]->mZipArchive == pArchive;
+
+      if ( !reading )
+         break;
+
+      handle.unlock();
+      Platform::sleep( 1 );
+      handle.lock( mMutex, true );
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::dispatch( AsyncReadRequest* pRequest )
+{
+   if ( pRequest->mCancelled )
+   {
+      if ( pRequest->mData )
+         dRealFree( pRequest->mData );
+
+      pRequest->mData = NULL;
+      pRequest->mSize = 0;
+      dAtomicWrite( pRequest->mStatus, AsyncReadRequest::Cancelled );
+   }
+   else if ( pRequest->mCallback )
+   {
+      pRequest->mCallback( pRequest, pRequest->mUserData );
+   }
+
+   release( pRequest );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::process( void )
+{
+   // Take the completed list so callbacks can issue new reads.
+   VectorPtr<AsyncReadRequest*> completed;
+   {
+      MutexHandle handle;
+      handle.lock( mMutex, true );
+
+      if ( mCompleted.empty() )
+         return;
+
+      completed = mCompleted;
+      mCompleted.clear();
+   }
+
+   for ( S32 i = 0; i < completed.size(); i++ )
+      dispatch( completed[i] );
+}
+
+//------------------------------------------------------------------------------
+
+void AsyncReadQueue::shutdown( void )
+{
+   if ( mShutdown )
+      return;
+
+   // Fail anything still pending.
+   {
+      MutexHandle handle;
+      handle.lock( mMutex, true );
+
+      mShutdown = true;
+
+      for ( U32 priority = 0; priority < AsyncReadRequest::PriorityCount; priority++ )
+      {
+         while ( mPendingHead[priority] )
+         {
+            AsyncReadRequest* pRequest = mPendingHead[priority];
+            unlinkPending( pRequest );
+            dAtomicWrite( pRequest->mStatus, AsyncReadRequest::Failed );
+            mCompleted.push_back( pRequest );
+         }
+      }
+   }
+
+   for ( S32 i = 0; i < mWorkers.size(); i++ )
+      mWorkers[i]->stop();
+
+   for ( S32 i = 0; i < mWorkers.size(); i++ )
+      mPendingSemaphore->release();
+
+   for ( S32 i = 0; i < mWorkers.size(); i++ )
+   {
+      mWorkers[i]->join();
+      delete mWorkers[i];
+   }
+   mWorkers.clear();
+}
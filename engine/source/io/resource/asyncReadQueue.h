@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _ASYNC_READ_QUEUE_H_
+#define _ASYNC_READ_QUEUE_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+#ifndef _STRINGTABLE_H_
+#include "string/stringTable.h"
+#endif
+#ifndef _MEMSTREAM_H_
+#include "io/memstream.h"
+#endif
+
+class Mutex;
+class Semaphore;
+class AsyncReadQueue;
+class AsyncReadWorker;
+
+namespace Zip
+{
+   class ZipArchive;
+   class CentralDir;
+}
+
+//------------------------------------------------------------------------------
+
+/// A single file read issued through the AsyncReadQueue.
+///
+/// A request reads a whole file into one buffer. It is either polled like a
+/// future (isDone(), getData()) or given a callback which the queue calls on
+/// the main thread from AsyncReadQueue::process() once the read has finished.
+///
+/// Requests are reference counted. Whoever issued the request holds a
+/// reference and must hand it back with AsyncReadQueue::release() when done
+/// with it; the queue holds its own reference until the completion has been
+/// dispatched, so a callback still arrives after an early release().
+class AsyncReadRequest
+{
+   friend class AsyncReadQueue;
+   friend class AsyncReadWorker;
+
+public:
+   enum Priority
+   {
+      PriorityLow,         ///< Speculative reads, e.g. prefetching the next level.
+      PriorityNormal,      ///< Data needed soon.
+      PriorityHigh,        ///< Data needed this frame.
+      PriorityCount
+   };
+
+   enum Status
+   {
+      Pending,             ///< Waiting for a worker.
+      Reading,             ///< Being read.
+      Complete,            ///< Read succeeded; getData() holds the file.
+      Failed,              ///< The file could not be read.
+      Cancelled            ///< Cancelled before it completed.
+   };
+
+   /// Called on the main thread once the request is Complete or Failed.
+   typedef void (*Callback)( AsyncReadRequest* pRequest, void* pUserData );
+
+protected:
+   StringTableEntry     mPath;
+
+   // Where the data comes from.  Disk files and files in mapped zips are read
+   // on the workers, anything else is read up front and set with setData().
+   char*                mFilePath;
+   Zip::ZipArchive*     mZipArchive;
+   const Zip::CentralDir* mCentralDir;
+   bool                 mHasData;
+
+   Priority             mPriority;
+   volatile U32         mStatus;
+   bool                 mCancelled;
+
+   U8*                  mData;
+   U32                  mSize;
+
+   Callback             mCallback;
+   void*                mUserData;
+
+   U32                  mRefCount;
+   AsyncReadRequest*    mNext;
+
+   AsyncReadRequest( StringTableEntry path, Priority priority, Callback callback, void* pUserData );
+   ~AsyncReadRequest();
+
+   /// Read the file on the calling thread.
+   void read( void );
+
+public:
+   /// Read from a file on disk.
+   void setFileSource( const char* pFilePath );
+
+   /// Read from a file in a mapped zip archive.  See Zip::ZipArchive::canReadMapped().
+   void setZipSource( Zip::ZipArchive* pArchive, const Zip::CentralDir* pCentralDir );
+
+   /// Complete the request with data that has already been read.  The request
+   /// takes ownership of the data, which must be allocated with dRealMalloc().
+   /// A NULL pointer with a non-zero size fails the request.
+   void setData( U8* pData, U32 size );
+
+   inline StringTableEntry getPath( void ) const      { return mPath; }
+   inline Priority getPriority( void ) const          { return mPriority; }
+   Status getStatus( void ) const;
+   inline bool isDone( void ) const                   { return getStatus() >= Complete; }
+
+   /// The file contents, valid once the request is Complete.
+   inline const U8* getData( void ) const             { return mData; }
+   inline U32 getSize( void ) const                   { return mSize; }
+
+   /// Take ownership of the file contents.  Free them with dRealFree().
+   U8* takeData( void );
+};
+
+//------------------------------------------------------------------------------
+
+/// Queue of whole file reads serviced by a pool of worker threads.
+///
+/// Pending reads are serviced highest priority first, oldest first within a
+/// priority.  The pool is started on the first read and its size is taken from
+/// $pref::ResourceManager::asyncReadThreads (default 2).
+///
+/// The queue is owned by the ResManager; see ResManager::readAsync() and
+/// ResManager::prefetch() for the usual way in.
+class AsyncReadQueue
+{
+   friend class AsyncReadWorker;
+
+public:
+   enum
+   {
+      DefaultThreadCount = 2
+   };
+
+protected:
+   Mutex*                     mMutex;
+   Semaphore*                 mPendingSemaphore;
+   AsyncReadRequest*          mPendingHead[AsyncReadRequest::PriorityCount];
+   AsyncReadRequest*          mPendingTail[AsyncReadRequest::PriorityCount];
+   VectorPtr<AsyncReadRequest*> mInFlight;
+   VectorPtr<AsyncReadRequest*> mCompleted;
+   VectorPtr<AsyncReadWorker*> mWorkers;
+   bool                       mShutdown;
+
+   void startWorkers( void );
+   AsyncReadRequest* popPending( void );
+   bool unlinkPending( AsyncReadRequest* pRequest );
+   void finishRead( AsyncReadRequest* pRequest );
+   void dispatch( AsyncReadRequest* pRequest );
+
+public:
+   AsyncReadQueue();
+   ~AsyncReadQueue();
+
+   /// Create a request.  Set its source and then submit() it.  The request
+   /// is returned holding the caller's reference.
+   AsyncReadRequest* create( StringTableEntry path, AsyncReadRequest::Priority priority, AsyncReadRequest::Callback callback = NULL, void* pUserData = NULL );
+
+   /// Queue a request.  Requests completed with setData() go straight to the
+   /// completed list.
+   void submit( AsyncReadRequest* pRequest );
+
+   /// Add a reference to a request.
+   void acquire( AsyncReadRequest* pRequest );
+
+   /// Release a reference to a request, freeing it when the last one goes.
+   void release( AsyncReadRequest* pRequest );
+
+   /// Cancel a request.  Its callback will not be called.
+   /// @return Whether the request was cancelled before it completed.
+   bool cancel( AsyncReadRequest* pRequest );
+
+   /// Block until a request is done.  A request still waiting for a worker is
+   /// read on the calling thread instead.  Must be called from the main thread.
+   void wait( AsyncReadRequest* pRequest );
+
+   /// Wait for any reads from an archive that is about to be closed and fail any
+   /// still pending.
+   void flushArchive( Zip::ZipArchive* pArchive );
+
+   /// Dispatch completed requests.  Called once per frame on the main thread.
+   void process( void );
+
+   /// Stop the workers.  Pending requests fail.
+   void shutdown( void );
+};
+
+//------------------------------------------------------------------------------
+
+/// Read only stream over the data of a completed request.  It owns the data
+/// and frees it when it is deleted, so it can be closed with ResManager::closeStream().
+class AsyncReadStream : public MemStream
+{
+   typedef MemStream Parent;
+
+protected:
+   U8* mOwnedData;
+
+public:
+   AsyncReadStream( const U32 size, U8* pData ) : Parent( size, pData, true, false ), mOwnedData( pData ) {}
+   virtual ~AsyncReadStream() { dRealFree( mOwnedData ); }
+};
+
+#endif // _ASYNC_READ_QUEUE_H_
@@ -28,6 +28,7 @@
 #include "io/fileStream.h"
 #include "io/resizeStream.h"
 #include "memory/frameAllocator.h"
+#include "math/mMathFn.h"
 
 #include "io/zip/zipArchive.h"
 
@@ -39,6 +40,9 @@
 
 #include "memory/safeDelete.h"
 
+/// Default for $pref::ResourceManager::prefetchBudget, in megabytes.
+static const S32 DefaultPrefetchBudget = 64;
+
 ResManager *ResourceManager = NULL;
 
 const char *ResManager::smExcludedDirectories = ".svn;CVS";
@@ -63,6 +67,10 @@ void ResourceObject::destruct ()
    // Free if it is ResourceObject::File and is NOT ResourceObject::VolumeBlock
    if((flags & ResourceObject::File) && !(flags & ResourceObject::VolumeBlock) )
    {
+      // Reads on the workers may still be using the archive's mapping
+      if(mZipArchive && ResourceManager)
+         ResourceManager->getReadQueue().flushArchive(mZipArchive);
+
       // [tom, 10/26/2006] We don't want to delete if it's a volume block since
       // the archive will be freed when the zip file resource object is freed.
       SAFE_DELETE(mZipArchive);
@@ -162,6 +170,10 @@ void ResourceObject::getFileTimes (FileTime * createTime, FileTime * modifyTime)
 
 ResManager::~ResManager ()
 {
+   // Stop the read workers before any archive they read from is freed
+   clearPrefetched();
+   mReadQueue.shutdown();
+
    purge ();
    // volume list should be gone.
 
@@ -841,7 +853,10 @@ bool ResManager::getCrc (const char *fileName, U32 & crcVal,
       U32 waterMark = 0xFFFFFFFF;
 
       U8 *buffer;
-      U32 maxSize = FrameAllocator::getHighWaterMark () - FrameAllocator::getWaterMark ();
+      // the arena can grow past the frame, but only use what is left of the frame
+      U32 maxSize = 0;
+      if (FrameAllocator::getWaterMark () < FrameAllocator::getHighWaterMark ())
+         maxSize = FrameAllocator::getHighWaterMark () - FrameAllocator::getWaterMark ();
       if (maxSize < (U32)obj->fileSize)
          buffer = new U8[obj->fileSize];
       else
@@ -966,6 +981,14 @@ Stream * ResManager::openStream (ResourceObject * obj)
    if (echoFileNames)
       Con::printf ("FILE ACCESS: %s/%s", obj->path, obj->name);
 
+   // if it was read ahead of time
+   if (mPrefetched.size())
+   {
+      Stream *prefetched = takePrefetched (StringTable->insert (buildPath (obj->path, obj->name)));
+      if (prefetched)
+         return prefetched;
+   }
+
    // used for openStream stream access
    FileStream *diskStream = NULL;
 
@@ -1370,3 +1393,222 @@ ConsoleFunction(isUsingVFS, bool, 1, 1, "()\n"
 {
    return ResourceManager->isUsingVFS();
 }
+
+//------------------------------------------------------------------------------
+
+StringTableEntry ResManager::getReadPath (const char *fileName, ResourceObject *&obj)
+{
+   char expanded[1024];
+   char fullPath[1024];
+   Con::expandPath (expanded, sizeof (expanded), fileName);
+   Platform::makeFullPathName (expanded, fullPath, sizeof (fullPath));
+
+   obj = find (fullPath);
+   if (obj)
+      return StringTable->insert (buildPath (obj->path, obj->name));
+
+   return StringTable->insert (fullPath);
+}
+
+//------------------------------------------------------------------------------
+
+AsyncReadRequest* ResManager::readAsync (const char *fileName, AsyncReadRequest::Priority priority,
+                                         AsyncReadRequest::Callback callback, void *userData)
+{
+   ResourceObject *obj = NULL;
+   StringTableEntry path = getReadPath (fileName, obj);
+
+   AsyncReadRequest *request = mReadQueue.create (path, priority, callback, userData);
+
+   if (obj && (obj->flags & ResourceObject::VolumeBlock))
+   {
+      if (obj->mZipArchive->canReadMapped (obj->mCentralDir))
+      {
+         request->setZipSource (obj->mZipArchive, obj->mCentralDir);
+      }
+      else
+      {
+         // Only the zip streams can read this one and they aren't thread safe,
+         // so read it now. Without any data the request fails.
+         Stream *stream = openStream (obj);
+         if (stream)
+         {
+            U32 size = stream->getStreamSize ();
+            U8 *data = size > 0 ? (U8 *) dRealMalloc (size) : NULL;
+
+            if (size == 0 || (data && stream->read (size, data)))
+               request->setData (data, size);
+            else if (data)
+               dRealFree (data);
+
+            closeStream (stream);
+         }
+      }
+   }
+   else
+   {
+      request->setFileSource (path);
+   }
+
+   mReadQueue.submit (request);
+   return request;
+}
+
+//------------------------------------------------------------------------------
+
+bool ResManager::prefetch (const char *fileName, AsyncReadRequest::Priority priority)
+{
+   ResourceObject *obj = NULL;
+   StringTableEntry path = getReadPath (fileName, obj);
+
+   for (S32 i = 0; i < mPrefetched.size (); i++)
+   {
+      if (mPrefetched[i]->getPath () == path)
+         return true;
+   }
+
+   // Don't bother queueing something we know isn't there
+   if (!obj && !Platform::isFile (path))
+      return false;
+
+   mPrefetched.push_back (readAsync (path, priority));
+   return true;
+}
+
+//------------------------------------------------------------------------------
+
+Stream* ResManager::takePrefetched (StringTableEntry path)
+{
+   for (S32 i = 0; i < mPrefetched.size (); i++)
+   {
+      AsyncReadRequest *request = mPrefetched[i];
+      if (request->getPath () != path)
+         continue;
+
+      mPrefetched.erase (mPrefetched.begin () + i);
+      mReadQueue.wait (request);
+
+      // MemStream can't represent an empty file, so those take the usual path
+      Stream *stream = NULL;
+      if (request->getStatus () == AsyncReadRequest::Complete && request->getSize () > 0)
+      {
+         const U32 size = request->getSize ();
+         stream = new AsyncReadStream (size, request->takeData ());
+      }
+
+      mReadQueue.release (request);
+      return stream;
+   }
+
+   return NULL;
+}
+
+//------------------------------------------------------------------------------
+
+Stream* ResManager::openPrefetchedStream (const char *fileName)
+{
+   if (mPrefetched.empty ())
+      return NULL;
+
+   ResourceObject *obj = NULL;
+   return takePrefetched (getReadPath (fileName, obj));
+}
+
+//------------------------------------------------------------------------------
+
+bool ResManager::isPrefetchPending (const char *fileName)
+{
+   if (mPrefetched.empty ())
+      return false;
+
+   ResourceObject *obj = NULL;
+   StringTableEntry path = getReadPath (fileName, obj);
+
+   for (S32 i = 0; i < mPrefetched.size (); i++)
+   {
+      if (mPrefetched[i]->getPath () == path)
+         return !mPrefetched[i]->isDone ();
+   }
+
+   return false;
+}
+
+//------------------------------------------------------------------------------
+
+void ResManager::cancelPrefetch (const char *fileName)
+{
+   if (mPrefetched.empty ())
+      return;
+
+   ResourceObject *obj = NULL;
+   StringTableEntry path = getReadPath (fileName, obj);
+
+   for (S32 i = 0; i < mPrefetched.size (); i++)
+   {
+      AsyncReadRequest *request = mPrefetched[i];
+      if (request->getPath () != path)
+         continue;
+
+      mPrefetched.erase (mPrefetched.begin () + i);
+      mReadQueue.cancel (request);
+      mReadQueue.release (request);
+      return;
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void ResManager::clearPrefetched ()
+{
+   for (S32 i = 0; i < mPrefetched.size (); i++)
+   {
+      mReadQueue.cancel (mPrefetched[i]);
+      mReadQueue.release (mPrefetched[i]);
+   }
+   mPrefetched.clear ();
+}
+
+//------------------------------------------------------------------------------
+
+void ResManager::processAsyncReads ()
+{
+   mReadQueue.process ();
+
+   if (mPrefetched.empty ())
+      return;
+
+   // Keep unopened prefetches within budget, dropping the oldest first
+   const U32 budget = U32 (getMax (Con::getIntVariable ("$pref::ResourceManager::prefetchBudget", DefaultPrefetchBudget), 0)) * 1024 * 1024;
+
+   U32 total = 0;
+   for (S32 i = 0; i < mPrefetched.size (); i++)
+   {
+      if (mPrefetched[i]->isDone ())
+         total += mPrefetched[i]->getSize ();
+   }
+
+   while (total > budget && mPrefetched.size ())
+   {
+      AsyncReadRequest *request = mPrefetched[0];
+      if (request->isDone ())
+         total -= request->getSize ();
+
+      mReadQueue.cancel (request);
+      mReadQueue.release (request);
+      mPrefetched.pop_front ();
+   }
+}
+
+//------------------------------------------------------------------------------
+
+ConsoleFunction(prefetchFile, bool, 2, 3, "(fileName, [priority])\n"
+                "Read a file on a background thread ahead of when it is needed.\n"
+                "@param fileName The file to read.\n"
+                "@param priority 0 (low, the default), 1 (normal) or 2 (high).\n"
+                "@return Returns true if the file was queued or is already prefetched")
+{
+   S32 priority = argc > 2 ? dAtoi (argv[2]) : AsyncReadRequest::PriorityLow;
+   priority = mClamp (priority, (S32) AsyncReadRequest::PriorityLow, (S32) AsyncReadRequest::PriorityHigh);
+
+   return ResourceManager->prefetch (argv[1], (AsyncReadRequest::Priority) priority);
+}
@@ -39,6 +39,9 @@
 #ifndef _CRC_H_
 #include "algorithm/crc.h"
 #endif
+#ifndef _ASYNC_READ_QUEUE_H_
+#include "io/resource/asyncReadQueue.h"
+#endif
 
 class Stream;
 class FileStream;
@@ -388,6 +391,15 @@ private:
 
    RegisteredExtension *registeredList;
 
+   AsyncReadQueue mReadQueue;                      ///< Queue servicing readAsync().
+   VectorPtr<AsyncReadRequest*> mPrefetched;       ///< Prefetched reads not yet opened, oldest first.
+
+   /// Full path used to key reads of a file, and its resource object if it has one.
+   StringTableEntry getReadPath(const char *fileName, ResourceObject *&obj);
+
+   /// Open a stream over a prefetched file, or NULL if it wasn't prefetched.
+   Stream* takePrefetched(StringTableEntry path);
+
    static const char *smExcludedDirectories;
    ResManager();
 public:
@@ -477,6 +489,44 @@ public:
    /// Opens a file for writing!
    bool openFileForWrite(FileStream &fs, const char *fileName, U32 accessMode = File::Write);
 
+   /// @name Asynchronous Reads
+   /// Whole files can be read on the AsyncReadQueue worker threads. Disk files
+   /// and files in mapped zips are read on the workers; files in other zips are
+   /// read when the request is made.
+   /// @{
+
+   /// Read a whole file asynchronously. The callback, if any, is called from
+   /// processAsyncReads() on the main thread. Release the request with
+   /// getReadQueue().release() when done with it.
+   AsyncReadRequest* readAsync(const char *fileName, AsyncReadRequest::Priority priority = AsyncReadRequest::PriorityNormal,
+                               AsyncReadRequest::Callback callback = NULL, void *userData = NULL);
+
+   /// Read a file ahead of when it is needed. The next openStream() or
+   /// openPrefetchedStream() of the file gets the data without touching the disk.
+   /// Unopened prefetches are dropped oldest first once they take up more than
+   /// $pref::ResourceManager::prefetchBudget megabytes (default 64).
+   bool prefetch(const char *fileName, AsyncReadRequest::Priority priority = AsyncReadRequest::PriorityLow);
+
+   /// Open a stream over a prefetched file, waiting for the read if it is still
+   /// in progress. Returns NULL if the file was not prefetched.
+   Stream* openPrefetchedStream(const char *fileName);
+
+   /// Whether a file is being prefetched and its read has not finished yet, so
+   /// opening it now would wait for the read.
+   bool isPrefetchPending(const char *fileName);
+
+   /// Drop a prefetched file that has not been opened, cancelling its read if it hasn't started.
+   void cancelPrefetch(const char *fileName);
+
+   /// Drop any prefetched files that have not been opened.
+   void clearPrefetched();
+
+   /// Dispatch completed reads. Called once per frame.
+   void processAsyncReads();
+
+   AsyncReadQueue& getReadQueue()                    { return mReadQueue; }
+   /// @}
+
 #ifdef TORQUE_DEBUG
    void dumpResources(const bool onlyLoaded = true);                        ///< Dumps all loaded resources to the console.
 #endif
@@ -21,12 +21,18 @@
 //-----------------------------------------------------------------------------
 
 #include "platform/platform.h"
+#include "platform/threads/thread.h"
+#include "platform/threads/atomic.h"
 #include "io/stream.h"
 #include "io/fileStream.h"
 #include "io/filterStream.h"
+#include "io/memstream.h"
 #include "io/zip/zipCryptStream.h"
 #include "algorithm/crc.h"
+#include "math/mMathFn.h"
 #include "io/resource/resourceManager.h"
+#include "memory/frameAllocator.h"
+#include "debug/traceProfiler.h"
 
 #include "console/console.h"
 
@@ -34,6 +40,8 @@
 #include "io/zip/compressor.h"
 #include "io/zip/zipTempStream.h"
 #include "io/zip/zipStatFilter.h"
+#include "io/zip/zipMemStream.h"
+#include "zlib.h"
 
 #ifdef TORQUE_ZIP_AES
 #include "core/zipAESCryptStream.h"
@@ -45,6 +53,48 @@
 namespace Zip
 {
 
+// Local file header layout, for reading headers straight out of a mapped archive
+static const U32 LocalHeaderSignature = 0x04034b50;
+static const U32 LocalHeaderSize = 30;
+static const U32 LocalHeaderNameLen = 26;
+static const U32 LocalHeaderExtraLen = 28;
+
+static inline U16 readLE16(const U8 *ptr)
+{
+   return U16(ptr[0] | (ptr[1] << 8));
+}
+
+static inline U32 readLE32(const U8 *ptr)
+{
+   return U32(ptr[0]) | (U32(ptr[1]) << 8) | (U32(ptr[2]) << 16) | (U32(ptr[3]) << 24);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// Worker thread for ZipArchive::prefetch()
+//////////////////////////////////////////////////////////////////////////
+
+class ZipPrefetchWorker : public Thread
+{
+   ZipArchive::PrefetchJob *mJobs;
+   U32 mCount;
+   volatile S32 *mNextJob;
+
+public:
+   ZipPrefetchWorker(ZipArchive::PrefetchJob *jobs, U32 count, volatile S32 *nextJob)
+      : Thread(0, NULL, false), mJobs(jobs), mCount(count), mNextJob(nextJob)
+   {
+   }
+
+   virtual void run(void *arg = 0)
+   {
+      ZipArchive::runPrefetchJobs(mJobs, mCount, mNextJob);
+
+      // The calling thread runs jobs too, so only the worker lets go of its arena and trace ring.
+      FrameAllocator::releaseThread();
+      TraceProfiler::releaseThread();
+   }
+};
+
 //////////////////////////////////////////////////////////////////////////
 // Constructor/Destructor
 //////////////////////////////////////////////////////////////////////////
@@ -55,10 +105,19 @@ ZipArchive::ZipArchive()
    mMode = Read;
    
    mDiskStream = NULL;
+   mMapStream = NULL;
+   mMapBase = NULL;
+   mMapSize = 0;
 
    mFilename = NULL;
 
    mRoot = NULL;
+
+   mIndex = NULL;
+   mIndexSize = 0;
+   mIndexCount = 0;
+
+   mPrefetchCount = 0;
 }
 
 ZipArchive::~ZipArchive()
@@ -73,6 +132,8 @@ ZipArchive::~ZipArchive()
 bool ZipArchive::readCentralDirectory()
 {
    mEntries.clear();
+   clearIndex();
+   mPrefetchCount = 0;
    SAFE_DELETE(mRoot);
    mRoot = new ZipEntry;
    mRoot->mName = StringTable->EmptyString;
@@ -149,6 +210,7 @@ void ZipArchive::insertEntry(ZipEntry *ze)
             newEntry->mCD.setFilename(path);
 
             root->mChildren.insert(newEntry, ptr);
+            indexEntry(newEntry);
          }
 
          root = newEntry;
@@ -166,6 +228,7 @@ void ZipArchive::insertEntry(ZipEntry *ze)
             ze->mParent = root;
             root->mChildren.insert(ze, ptr);
             mEntries.push_back(ze);
+            indexEntry(ze);
          }
          else
          {
@@ -216,6 +279,11 @@ void ZipArchive::removeEntry(ZipEntry *ze)
       }
    }
 
+   unindexEntry(ze);
+
+   if(ze->mPrefetched)
+      --mPrefetchCount;
+
    // [tom, 2/2/2007] This must be last, as ze is no longer valid once it's
    // removed from the parent.
    ZipEntry *z = ze->mParent->mChildren.remove(ze->mName);
@@ -232,47 +300,279 @@ CentralDir *ZipArchive::findFileInfo(const char *filename)
 
 ZipArchive::ZipEntry *ZipArchive::findZipEntry(const char *filename)
 {
-   char path[1024];
-   dStrncpy(path, filename, sizeof(path));
-   path[sizeof(path) - 1] = 0;
+   if(mIndexCount == 0 || filename == NULL)
+      return NULL;
 
-   for(U32 i = 0;i < dStrlen(path);++i)
+   U32 hash = hashPath(filename);
+   U32 mask = mIndexSize - 1;
+
+   for(U32 i = hash & mask;mIndex[i].mEntry;i = (i + 1) & mask)
    {
-      if(path[i] == '\\')
-         path[i] = '/';
+      if(mIndex[i].mHash == hash && pathsMatch(mIndex[i].mEntry->mCD.mFilename, filename))
+         return mIndex[i].mEntry;
    }
 
-   ZipEntry *root = mRoot;
+   return NULL;
+}
 
-   char *ptr = path, *slash = NULL;
-   do
+//////////////////////////////////////////////////////////////////////////
+
+U32 ZipArchive::hashPath(const char *path)
+{
+   // FNV-1a, with both kinds of slash hashing the same
+   U32 hash = 2166136261u;
+   for(const char *ptr = path;*ptr;++ptr)
    {
-      slash = dStrchr(ptr, '/');
-      if(slash)
+      U8 c = *ptr == '\\' ? '/' : *ptr;
+      hash = (hash ^ c) * 16777619u;
+   }
+   return hash;
+}
+
+bool ZipArchive::pathsMatch(const char *a, const char *b)
+{
+   for(;*a && *b;++a, ++b)
+   {
+      char ca = *a == '\\' ? '/' : *a;
+      char cb = *b == '\\' ? '/' : *b;
+      if(ca != cb)
+         return false;
+   }
+   return *a == *b;
+}
+
+void ZipArchive::indexEntry(ZipEntry *ze)
+{
+   // Keep the load at or below half so probe runs stay short
+   if((mIndexCount + 1) * 2 > mIndexSize)
+      growIndex();
+
+   U32 hash = hashPath(ze->mCD.mFilename);
+   U32 mask = mIndexSize - 1;
+
+   U32 i = hash & mask;
+   for(;mIndex[i].mEntry;i = (i + 1) & mask)
+   {
+      // A newer entry with the same path shadows the old one
+      if(mIndex[i].mHash == hash && pathsMatch(mIndex[i].mEntry->mCD.mFilename, ze->mCD.mFilename))
       {
-         // Find the directory
-         *slash = 0;
+         mIndex[i].mEntry = ze;
+         return;
+      }
+   }
 
-         ZipEntry *newEntry;
-         if((newEntry = root->mChildren.retrieve(ptr)) == NULL)
-            return NULL;
+   mIndex[i].mHash = hash;
+   mIndex[i].mEntry = ze;
+   ++mIndexCount;
+}
 
-         root = newEntry;
+void ZipArchive::unindexEntry(ZipEntry *ze)
+{
+   if(mIndexCount == 0)
+      return;
 
-         ptr = slash + 1;
+   U32 mask = mIndexSize - 1;
+   U32 i = hashPath(ze->mCD.mFilename) & mask;
+   for(;mIndex[i].mEntry != ze;i = (i + 1) & mask)
+   {
+      if(mIndex[i].mEntry == NULL)
+         return;
+   }
+
+   // Shift the rest of the probe run back over the hole so lookups never
+   // stop early. An entry can fill the hole if the hole lies between its
+   // home slot and where it is now.
+   U32 hole = i;
+   for(U32 j = (i + 1) & mask;mIndex[j].mEntry;j = (j + 1) & mask)
+   {
+      U32 home = mIndex[j].mHash & mask;
+      if(((j - home) & mask) >= ((j - hole) & mask))
+      {
+         mIndex[hole] = mIndex[j];
+         hole = j;
       }
-      else
+   }
+
+   mIndex[hole].mEntry = NULL;
+   --mIndexCount;
+}
+
+void ZipArchive::growIndex()
+{
+   IndexSlot *oldIndex = mIndex;
+   U32 oldSize = mIndexSize;
+
+   mIndexSize = oldSize ? oldSize * 2 : 64;
+   mIndex = new IndexSlot[mIndexSize];
+   dMemset(mIndex, 0, sizeof(IndexSlot) * mIndexSize);
+
+   U32 mask = mIndexSize - 1;
+   for(U32 i = 0;i < oldSize;++i)
+   {
+      if(oldIndex[i].mEntry == NULL)
+         continue;
+
+      U32 j = oldIndex[i].mHash & mask;
+      while(mIndex[j].mEntry)
+         j = (j + 1) & mask;
+
+      mIndex[j] = oldIndex[i];
+   }
+
+   delete [] oldIndex;
+}
+
+void ZipArchive::clearIndex()
+{
+   SAFE_DELETE_ARRAY(mIndex);
+   mIndexSize = 0;
+   mIndexCount = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+const U8 *ZipArchive::getMappedData(const CentralDir *fileCD) const
+{
+   if(mMapBase == NULL)
+      return NULL;
+
+   U32 offset = fileCD->mLocalHeadOffset;
+   if(offset >= mMapSize || mMapSize - offset < LocalHeaderSize)
+      return NULL;
+
+   const U8 *header = mMapBase + offset;
+   if(readLE32(header) != LocalHeaderSignature)
+      return NULL;
+
+   // The local header's name and extra field lengths may differ from the central directory
+   U32 dataOffset = offset + LocalHeaderSize + readLE16(header + LocalHeaderNameLen) + readLE16(header + LocalHeaderExtraLen);
+   if(dataOffset > mMapSize || mMapSize - dataOffset < fileCD->mCompressedSize)
+      return NULL;
+
+   return mMapBase + dataOffset;
+}
+
+U8 *ZipArchive::inflateEntry(const CentralDir *fileCD, const U8 *source)
+{
+   // [Note] This runs on the prefetch workers, so it must not touch the
+   // archive and allocates with dRealMalloc() rather than the memory manager.
+   U8 *data = (U8 *)dRealMalloc(fileCD->mUncompressedSize);
+   if(data == NULL)
+      return NULL;
+
+   z_stream zs;
+   dMemset(&zs, 0, sizeof(zs));
+   zs.next_in = (Bytef *)source;
+   zs.avail_in = fileCD->mCompressedSize;
+   zs.next_out = data;
+   zs.avail_out = fileCD->mUncompressedSize;
+
+   bool ok = false;
+   if(inflateInit2(&zs, -MAX_WBITS) == Z_OK)
+   {
+      ok = inflate(&zs, Z_FINISH) == Z_STREAM_END && zs.total_out == fileCD->mUncompressedSize;
+      inflateEnd(&zs);
+   }
+
+   if(! ok)
+   {
+      dRealFree(data);
+      return NULL;
+   }
+
+   return data;
+}
+
+Stream *ZipArchive::openMappedFile(const CentralDir *fileCD)
+{
+   // MemStream can't represent an empty file
+   if(fileCD->mUncompressedSize == 0)
+      return NULL;
+
+   if(mPrefetchCount > 0)
+   {
+      ZipEntry *ze = findZipEntry(fileCD->mFilename);
+      if(ze && &ze->mCD == fileCD && ze->mPrefetched)
       {
-         // Find the file
-         ZipEntry *ze;
-         if((ze = root->mChildren.retrieve(ptr)) != NULL)
-            return ze;
+         U8 *data = ze->mPrefetched;
+         ze->mPrefetched = NULL;
+         --mPrefetchCount;
+
+         return new ZipMemStream(fileCD->mUncompressedSize, data, true);
       }
-   } while(slash);
+   }
+
+   const U8 *source = getMappedData(fileCD);
+   if(source == NULL)
+      return NULL;
+
+   if(fileCD->mCompressMethod == Stored && fileCD->mCompressedSize == fileCD->mUncompressedSize)
+      return new ZipMemStream(fileCD->mUncompressedSize, source, false);
+
+   if(fileCD->mCompressMethod == Deflated && fileCD->mUncompressedSize <= WholeInflateLimit)
+   {
+      U8 *data = inflateEntry(fileCD, source);
+      if(data)
+         return new ZipMemStream(fileCD->mUncompressedSize, data, true);
+   }
 
    return NULL;
 }
 
+bool ZipArchive::canReadMapped(const CentralDir *fileCD) const
+{
+   if(mMapBase == NULL || (fileCD->mFlags & Encrypted) != 0 ||
+      (fileCD->mInternalFlags & (CDFileDirty | CDFileDeleted | CDFileOpen)) != 0)
+      return false;
+
+   if(fileCD->mCompressMethod != Stored && fileCD->mCompressMethod != Deflated)
+      return false;
+
+   return getMappedData(fileCD) != NULL;
+}
+
+bool ZipArchive::readMappedFile(const CentralDir *fileCD, U8 *&data, U32 &size) const
+{
+   data = NULL;
+   size = 0;
+
+   if(! canReadMapped(fileCD))
+      return false;
+
+   if(fileCD->mUncompressedSize == 0)
+      return true;
+
+   const U8 *source = getMappedData(fileCD);
+   if(fileCD->mCompressMethod == Deflated)
+   {
+      data = inflateEntry(fileCD, source);
+   }
+   else if(fileCD->mCompressedSize == fileCD->mUncompressedSize)
+   {
+      data = (U8 *)dRealMalloc(fileCD->mUncompressedSize);
+      if(data)
+         dMemcpy(data, source, fileCD->mUncompressedSize);
+   }
+
+   if(data == NULL)
+      return false;
+
+   size = fileCD->mUncompressedSize;
+   return true;
+}
+
+void ZipArchive::runPrefetchJobs(PrefetchJob *jobs, U32 count, volatile S32 *nextJob)
+{
+   for(;;)
+   {
+      S32 job = dAtomicIncrement(*nextJob) - 1;
+      if(job >= (S32)count)
+         break;
+
+      jobs[job].mData = inflateEntry(&jobs[job].mEntry->mCD, jobs[job].mSource);
+   }
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 Stream *ZipArchive::createNewFile(const char *filename, Compressor *method)
@@ -533,7 +833,20 @@ bool ZipArchive::openArchive(const char *filename, AccessMode mode /* = Read */)
    {
       setFilename(filename);
 
-      if(openArchive(mDiskStream, mode))
+      // Archives we only read from are mapped, and everything including the
+      // central directory is then read from memory
+      Stream *stream = mDiskStream;
+      if(mode == Read)
+      {
+         mMapBase = mDiskStream->map(&mMapSize);
+         if(mMapBase)
+         {
+            mMapStream = new MemStream(mMapSize, const_cast<U8 *>(mMapBase), true, false);
+            stream = mMapStream;
+         }
+      }
+
+      if(openArchive(stream, mode))
          return true;
    }
    
@@ -584,6 +897,11 @@ void ZipArchive::closeArchive()
    }
    mTempFiles.clear();
 
+   // The mapping goes away with the disk stream
+   SAFE_DELETE(mMapStream);
+   mMapBase = NULL;
+   mMapSize = 0;
+
    // Close the zip file stream and clean up
    if(mDiskStream)
    {
@@ -598,6 +916,8 @@ void ZipArchive::closeArchive()
    SAFE_FREE(mFilename);
    SAFE_DELETE(mRoot);
    mEntries.clear();
+   clearIndex();
+   mPrefetchCount = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -656,6 +976,14 @@ void ZipArchive::closeFile(Stream *stream)
       delete currentStream;
    }
 
+   // Mapped and inflated files are plain streams that we created
+   ZipMemStream *memStream = dynamic_cast<ZipMemStream *>(stream);
+   if(memStream)
+   {
+      delete memStream;
+      return;
+   }
+
    ZipTempStream *tempStream = dynamic_cast<ZipTempStream *>(stream);
    if(tempStream && (tempStream->getCentralDir()->mInternalFlags & CDFileOpen))
    {
@@ -675,6 +1003,15 @@ Stream *ZipArchive::openFileForRead(const CentralDir *fileCD)
    if((fileCD->mInternalFlags & (CDFileDeleted | CDFileOpen)) != 0)
       return NULL;
 
+   // Mapped archives hand out memory streams for anything that isn't dirty
+   // or encrypted, falling back to the filter streams when that fails
+   if(mMapBase && (fileCD->mInternalFlags & CDFileDirty) == 0 && (fileCD->mFlags & Encrypted) == 0)
+   {
+      Stream *mapped = openMappedFile(fileCD);
+      if(mapped)
+         return mapped;
+   }
+
    Stream *stream = mStream;
 
    if(fileCD->mInternalFlags & CDFileDirty)
@@ -762,6 +1099,106 @@ Stream *ZipArchive::openFileForRead(const CentralDir *fileCD)
 
 //////////////////////////////////////////////////////////////////////////
 
+U32 ZipArchive::prefetch(const char **filenames, U32 count)
+{
+   if(mMapBase == NULL || mMode != Read || count == 0)
+      return 0;
+
+   Vector<PrefetchJob> jobs;
+   jobs.reserve(count);
+
+   for(U32 i = 0;i < count;++i)
+   {
+      ZipEntry *ze = findZipEntry(filenames[i]);
+      if(ze == NULL || ze->mIsDirectory || ze->mPrefetched)
+         continue;
+
+      // Stored files are already free to open, and anything else we can't
+      // inflate whole takes the usual path when it is opened
+      const CentralDir &cd = ze->mCD;
+      if(cd.mCompressMethod != Deflated || (cd.mFlags & Encrypted) ||
+         (cd.mInternalFlags & (CDFileDirty | CDFileDeleted | CDFileOpen)) ||
+         cd.mUncompressedSize == 0 || cd.mUncompressedSize > WholeInflateLimit)
+         continue;
+
+      const U8 *source = getMappedData(&cd);
+      if(source == NULL)
+         continue;
+
+      PrefetchJob job;
+      job.mEntry = ze;
+      job.mSource = source;
+      job.mData = NULL;
+      jobs.push_back(job);
+   }
+
+   if(jobs.empty())
+      return 0;
+
+   // The calling thread works through the batch too, so a single file never needs a worker
+   S32 maxThreads = getMax(Con::getIntVariable("$Pref::Zip::PrefetchThreads", DefaultPrefetchThreads), 0);
+   U32 numThreads = getMin(U32(maxThreads), U32(jobs.size() - 1));
+
+   volatile S32 nextJob = 0;
+   VectorPtr<ZipPrefetchWorker *> workers;
+   for(U32 i = 0;i < numThreads;++i)
+   {
+      ZipPrefetchWorker *worker = new ZipPrefetchWorker(jobs.address(), jobs.size(), &nextJob);
+      worker->start();
+      workers.push_back(worker);
+   }
+
+   runPrefetchJobs(jobs.address(), jobs.size(), &nextJob);
+
+   for(S32 i = 0;i < workers.size();++i)
+   {
+      workers[i]->join();
+      delete workers[i];
+   }
+
+   U32 inflated = 0;
+   for(S32 i = 0;i < jobs.size();++i)
+   {
+      PrefetchJob &job = jobs[i];
+      if(job.mData == NULL)
+      {
+         if(isVerbose())
+            Con::errorf("ZipArchive::prefetch - %s: Could not inflate %s", mFilename ? mFilename : "<no filename>", job.mEntry->mCD.mFilename);
+         continue;
+      }
+
+      // The same file may have been listed more than once
+      if(job.mEntry->mPrefetched)
+      {
+         dRealFree(job.mData);
+         continue;
+      }
+
+      job.mEntry->mPrefetched = job.mData;
+      ++mPrefetchCount;
+      ++inflated;
+   }
+
+   return inflated;
+}
+
+void ZipArchive::releasePrefetched()
+{
+   for(S32 i = 0;i < mEntries.size() && mPrefetchCount > 0;++i)
+   {
+      ZipEntry *ze = mEntries[i];
+      if(ze->mPrefetched)
+      {
+         dRealFree(ze->mPrefetched);
+         ze->mPrefetched = NULL;
+         --mPrefetchCount;
+      }
+   }
+   mPrefetchCount = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 bool ZipArchive::addFile(const char *filename, const char *pathInZip, bool replace /* = true */)
 {
    Stream *source = ResourceManager->openStream(filename);
@@ -25,6 +25,7 @@
 #include "io/zip/compressor.h"
 
 #include "io/fileStream.h"
+#include "io/memstream.h"
 
 #include "collection/simpleHashTable.h"
 #include "collection/vector.h"
@@ -50,6 +51,7 @@ namespace Zip
 
 // Forward Refs
 class ZipTempStream;
+class ZipPrefetchWorker;
 
 // [tom, 10/18/2006] This will be split up into a separate interface for allowing
 // the resource manager to handle any kind of archive relatively easily.
@@ -252,6 +254,21 @@ class ZipTempStream;
 /// Encrypted zip support will be improved in a future version. For now, a more
 /// secure method of storing the password is left as an exercise for the reader.
 /// 
+/// <h3>Mapped Archives</h3>
+/// 
+/// When an archive is opened from disk for #Read, the whole file is mapped into
+/// memory with File::map() and reads no longer go through the disk stream.
+/// Stored files are returned as a stream pointing straight into the mapping and
+/// deflated files are inflated into a single buffer in one go. Large, encrypted
+/// or otherwise unusual files still use the filter stream path described above.
+/// 
+/// Lookups by filename use a flat hash of every entry's full path instead of
+/// walking the directory tree one path segment at a time.
+/// 
+/// If you know which files you are about to load, prefetch() inflates them on
+/// worker threads ahead of time. The next openFile() of a prefetched file hands
+/// over the inflated buffer without any further work on the calling thread.
+/// 
 /// <h3>Accessing Zip files from script</h3>
 /// 
 /// ZipArchive is a C++ class and thus cannot be used from script. However,
@@ -288,15 +305,51 @@ protected:
       
       SimpleHashTable<struct ZipEntry> mChildren;
 
+      /// Whole file inflated by prefetch(), handed to the next openFileForRead()
+      U8 *mPrefetched;
+
       ZipEntry()
       {
          mName = "";
          mIsDirectory = false;
+         mPrefetched = NULL;
+      }
+
+      ~ZipEntry()
+      {
+         if(mPrefetched)
+            dRealFree(mPrefetched);
       }
    };
 
+   /// Slot in the flat path index
+   struct IndexSlot
+   {
+      U32 mHash;
+      ZipEntry *mEntry;
+   };
+
+   /// A file to be inflated by prefetch()
+   struct PrefetchJob
+   {
+      ZipEntry *mEntry;
+      const U8 *mSource;
+      U8 *mData;
+   };
+
+   enum
+   {
+      /// Deflated files larger than this are streamed rather than inflated whole
+      WholeInflateLimit = 16 * 1024 * 1024,
+      /// Default for $Pref::Zip::PrefetchThreads
+      DefaultPrefetchThreads = 4,
+   };
+
+   friend class ZipPrefetchWorker;
+
    Stream *mStream;
    FileStream *mDiskStream;
+   MemStream *mMapStream;
    AccessMode mMode;
 
    EndOfCentralDir mEOCD;
@@ -306,6 +359,18 @@ protected:
    ZipEntry *mRoot;
    VectorPtr<ZipEntry *> mEntries;
 
+   // mIndex is an open addressed hash of every entry keyed on its full path,
+   // so lookups don't have to walk mRoot a segment at a time
+   IndexSlot *mIndex;
+   U32 mIndexSize;
+   U32 mIndexCount;
+
+   // Read-only view of the whole archive when it was opened from disk for Read
+   const U8 *mMapBase;
+   U32 mMapSize;
+
+   U32 mPrefetchCount;
+
    const char *mFilename;
 
    VectorPtr<ZipTempStream *> mTempFiles;
@@ -317,6 +382,18 @@ protected:
    
    ZipEntry *findZipEntry(const char *filename);
 
+   static U32 hashPath(const char *path);
+   static bool pathsMatch(const char *a, const char *b);
+   void indexEntry(ZipEntry *ze);
+   void unindexEntry(ZipEntry *ze);
+   void growIndex();
+   void clearIndex();
+
+   const U8 *getMappedData(const CentralDir *fileCD) const;
+   Stream *openMappedFile(const CentralDir *fileCD);
+   static U8 *inflateEntry(const CentralDir *fileCD, const U8 *source);
+   static void runPrefetchJobs(PrefetchJob *jobs, U32 count, volatile S32 *nextJob);
+
    Stream *createNewFile(const char *filename, Compressor *method);
    Stream *createNewFile(const char *filename, const char *method)
    {
@@ -477,6 +554,63 @@ public:
    /// @see ZipArchive::openFile(const char *, AccessMode), ZipArchive::closeFile()
    //////////////////////////////////////////////////////////////////////////
    Stream *openFileForRead(const CentralDir *fileCD);
+
+   //////////////////////////////////////////////////////////////////////////
+   /// @brief Determine if the archive is mapped into memory
+   ///
+   /// Archives opened from disk for #Read are mapped. See the mapped archive
+   /// section of the class documentation.
+   //////////////////////////////////////////////////////////////////////////
+   bool isMapped() const                              { return mMapBase != NULL; }
+
+   //////////////////////////////////////////////////////////////////////////
+   /// @brief Determine if a file can be read with readMappedFile()
+   ///
+   /// @param fileCD Pointer to central directory of the file
+   /// @see ZipArchive::readMappedFile()
+   //////////////////////////////////////////////////////////////////////////
+   bool canReadMapped(const CentralDir *fileCD) const;
+
+   //////////////////////////////////////////////////////////////////////////
+   /// @brief Read a whole file from a mapped archive
+   ///
+   /// Unlike the rest of ZipArchive, this only reads from the mapping and may
+   /// be called from any thread. The archive must stay open, and must not be
+   /// written to, until the call returns.
+   ///
+   /// @param fileCD Pointer to central directory of the file to read
+   /// @param data Receives the file contents, to be freed with dRealFree(). NULL for empty files.
+   /// @param size Receives the size of the file
+   /// @return true for success, false for failure
+   /// @see ZipArchive::canReadMapped()
+   //////////////////////////////////////////////////////////////////////////
+   bool readMappedFile(const CentralDir *fileCD, U8 *&data, U32 &size) const;
+
+   //////////////////////////////////////////////////////////////////////////
+   /// @brief Inflate a batch of files ahead of time
+   ///
+   /// The files are inflated in parallel on up to $Pref::Zip::PrefetchThreads
+   /// worker threads (default 4) plus the calling thread, and prefetch() returns
+   /// once they are all done. Each inflated file is handed to the next
+   /// openFile() or openFileForRead() for it, so it only makes sense to
+   /// prefetch files you are about to load.
+   ///
+   /// Only deflated files in a mapped archive are prefetched. Stored files
+   /// are already free to open and anything else is skipped.
+   ///
+   /// @param filenames Array of filenames in the zip
+   /// @param count Number of filenames in the array
+   /// @return Number of files that were inflated
+   /// @see ZipArchive::releasePrefetched()
+   //////////////////////////////////////////////////////////////////////////
+   U32 prefetch(const char **filenames, U32 count);
+
+   //////////////////////////////////////////////////////////////////////////
+   /// @brief Free any prefetched files that were never opened
+   ///
+   /// @see ZipArchive::prefetch()
+   //////////////////////////////////////////////////////////////////////////
+   void releasePrefetched();
    // @}
 
    /// @name Archiver Style File Access Methods
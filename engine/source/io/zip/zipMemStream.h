@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "io/memstream.h"
+
+#ifndef _ZIPMEMSTREAM_H_
+#define _ZIPMEMSTREAM_H_
+
+namespace Zip
+{
+
+/// @addtogroup zipint_group
+/// @ingroup zip_group
+// @{
+
+/// Read-only stream over a file that is entirely in memory.
+///
+/// Stored files in a mapped archive point straight into the mapping, while
+/// deflated files are inflated whole into a buffer that the stream owns and
+/// frees with dRealFree() when it is deleted. Both ZipArchive::closeFile() and
+/// ResManager::closeStream() delete it.
+class ZipMemStream : public MemStream
+{
+   typedef MemStream Parent;
+
+protected:
+   void *mOwnedBuffer;
+
+public:
+   ZipMemStream(const U32 size, const void *buffer, bool ownsBuffer)
+      : Parent(size, const_cast<void *>(buffer), true, false), mOwnedBuffer(ownsBuffer ? const_cast<void *>(buffer) : NULL)
+   {
+   }
+
+   virtual ~ZipMemStream()
+   {
+      if(mOwnedBuffer)
+         dRealFree(mOwnedBuffer);
+   }
+};
+
+// @}
+
+} // end namespace Zip
+
+#endif // _ZIPMEMSTREAM_H_
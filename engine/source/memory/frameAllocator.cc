@@ -20,18 +20,419 @@
 // IN THE SOFTWARE.
 //-----------------------------------------------------------------------------
 
+
 #include "frameAllocator.h"
 #include "console/console.h"
+#include "platform/platformTLS.h"
+#include "platform/threads/atomic.h"
+#include "platform/threads/thread.h"
+#include "math/mMathFn.h"
 
-U8*   FrameAllocator::smBuffer = NULL;
-U32   FrameAllocator::smWaterMark = 0;
-U32   FrameAllocator::smHighWaterMark = 0;
+/// This #define is used by the FrameAllocator to align starting addresses to
+/// be byte aligned to this value. This is important on the 360 and possibly
+/// on other platforms as well. Use this #define anywhere alignment is needed.
+///
+/// NOTE: Do not change this value per-platform unless you have a very good
+/// reason for doing so. It has the potential to cause inconsistencies in 
+/// memory which is allocated and expected to be contiguous.
+#define TORQUE_BYTE_ALIGNMENT 4
 
-#if defined(TORQUE_DEBUG)
+//-----------------------------------------------------------------------------
 
-ConsoleFunction(getMaxFrameAllocation, S32, 1,1, "getMaxFrameAllocation();")
+/// A block of arena memory.  The data follows the header.
+struct FrameAllocator::Block
+{
+   Block*   mPrev;
+   Block*   mNext;
+   U32      mBase;   ///< Water mark at the start of the block.
+   U32      mSize;
+
+   U8* getData() { return reinterpret_cast<U8*>(this + 1); }
+};
+
+/// The peak usage recorded against a tag.
+struct FrameAllocator::TagStats
+{
+   const char* mTag;
+   U32         mPeak;
+   U32         mScopes;
+};
+
+/// A thread's arena.  Only the owning thread changes it; dumpStats() reads
+/// the statistics of other threads without locking.  Arenas are never freed.
+/// An arena given up by releaseThread() keeps its statistics until another
+/// thread takes it over.
+struct FrameAllocator::Arena
+{
+   volatile U32 mActive;      ///< Owned by a running thread.
+   U32      mThreadId;
+   U32      mBlockSize;
+   Block*   mFirst;
+   Block*   mCurrent;
+   U32      mWaterMark;
+   U32      mPeakWaterMark;
+   U32      mScopePeak;       ///< Highest water mark in the innermost tagged scope.
+   U32      mCapacity;
+   U32      mBlockCount;
+   U32      mGrowCount;       ///< Blocks linked because the others were full.
+   U32      mTagCount;
+   TagStats mTags[MaxTags];
+   Arena*   mNext;
+};
+
+FrameAllocator::Arena* volatile FrameAllocator::smArenaList = NULL;
+
+//-----------------------------------------------------------------------------
+
+static ThreadStorage& getArenaStorage()
+{
+   // Constructed by init() on the main thread before any worker can allocate.
+   static ThreadStorage sArenaStorage;
+   return sArenaStorage;
+}
+
+//-----------------------------------------------------------------------------
+
+FrameAllocator::Arena* FrameAllocator::getArena()
 {
-   return sgMaxFrameAllocation;
+   Arena* pArena = static_cast<Arena*>( getArenaStorage().get() );
+   if ( pArena != NULL )
+      return pArena;
+
+   // First use on this thread.  Take over the arena of a thread that has
+   // exited if there is one, otherwise create a new one.
+   for ( pArena = smArenaList; pArena != NULL; pArena = pArena->mNext )
+   {
+      if ( dAtomicCompareAndSwap( pArena->mActive, 0, 1 ) )
+         break;
+   }
+
+   if ( pArena != NULL )
+   {
+      Arena* pNext = pArena->mNext;
+      dMemset( pArena, 0, sizeof(Arena) );
+      pArena->mActive = 1;
+      pArena->mNext = pNext;
+   }
+   else
+   {
+      pArena = new Arena;
+      dMemset( pArena, 0, sizeof(Arena) );
+      pArena->mActive = 1;
+
+      // Publish it to dumpStats().
+      do
+      {
+         pArena->mNext = smArenaList;
+      }
+      while ( !dAtomicCompareAndSwapPtr( smArenaList, pArena->mNext, pArena ) );
+   }
+
+   pArena->mThreadId = ThreadManager::getCurrentThreadId();
+   pArena->mBlockSize = ThreadBlockSize;
+
+   getArenaStorage().set( pArena );
+   return pArena;
+}
+
+//-----------------------------------------------------------------------------
+
+FrameAllocator::Block* FrameAllocator::nextBlock(Arena* pArena, const U32 allocSize)
+{
+   Block* pCurrent = pArena->mCurrent;
+   Block* pNext = pCurrent != NULL ? pCurrent->mNext : pArena->mFirst;
+
+   // Free the rest of the chain if the next block is too small to use.
+   if ( pNext != NULL && pNext->mSize < allocSize )
+   {
+      while ( pNext != NULL )
+      {
+         Block* pFree = pNext;
+         pNext = pNext->mNext;
+
+         pArena->mCapacity -= pFree->mSize;
+         pArena->mBlockCount--;
+         dFree( pFree );
+      }
+
+      if ( pCurrent != NULL )
+         pCurrent->mNext = NULL;
+      else
+         pArena->mFirst = NULL;
+   }
+
+   if ( pNext == NULL )
+   {
+      const U32 blockSize = getMax( pArena->mBlockSize, allocSize );
+      pNext = static_cast<Block*>( dMalloc( sizeof(Block) + blockSize ) );
+      pNext->mPrev = pCurrent;
+      pNext->mNext = NULL;
+      pNext->mSize = blockSize;
+
+      if ( pCurrent != NULL )
+      {
+         pCurrent->mNext = pNext;
+         pArena->mGrowCount++;
+      }
+      else
+      {
+         pArena->mFirst = pNext;
+      }
+
+      pArena->mCapacity += blockSize;
+      pArena->mBlockCount++;
+   }
+
+   // Water marks carry on from where the previous block was left.
+   pNext->mBase = pArena->mWaterMark;
+   pArena->mCurrent = pNext;
+   return pNext;
 }
 
+//-----------------------------------------------------------------------------
+
+void FrameAllocator::init(const U32 frameSize)
+{
+   Arena* pArena = getArena();
+   AssertFatal(pArena->mWaterMark == 0, "Error, already in use");
+
+   pArena->mBlockSize = frameSize;
+
+   // Allocate the first block up front.
+   if ( pArena->mFirst == NULL )
+      nextBlock( pArena, frameSize );
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameAllocator::destroy()
+{
+   releaseThread();
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameAllocator::releaseThread()
+{
+   Arena* pArena = static_cast<Arena*>( getArenaStorage().get() );
+   if ( pArena == NULL )
+      return;
+
+   AssertFatal(pArena->mWaterMark == 0, "Error, frame memory is still in use");
+
+   // Free the blocks.  The arena keeps its statistics until it is reused.
+   Block* pBlock = pArena->mFirst;
+   while ( pBlock != NULL )
+   {
+      Block* pFree = pBlock;
+      pBlock = pBlock->mNext;
+      dFree( pFree );
+   }
+
+   pArena->mFirst = NULL;
+   pArena->mCurrent = NULL;
+   pArena->mCapacity = 0;
+   pArena->mBlockCount = 0;
+
+   getArenaStorage().set( NULL );
+   dAtomicWrite( pArena->mActive, 0 );
+}
+
+//-----------------------------------------------------------------------------
+
+U32 FrameAllocator::getArenaCount()
+{
+   U32 count = 0;
+   for ( Arena* pArena = smArenaList; pArena != NULL; pArena = pArena->mNext )
+      count++;
+
+   return count;
+}
+
+//-----------------------------------------------------------------------------
+
+void* FrameAllocator::alloc(const U32 allocSize)
+{
+   U32 _allocSize = allocSize;
+#ifdef TORQUE_DEBUG
+   _allocSize+=4;
 #endif
+
+   Arena* pArena = getArena();
+   Block* pBlock = pArena->mCurrent;
+
+   // Keep all frame allocator allocations aligned to DWORD boundries on the 360
+   // Add 3, mask out the lower 3 bits.
+   U32 offset = 0;
+   if ( pBlock != NULL )
+      offset = ( pArena->mWaterMark - pBlock->mBase + ( TORQUE_BYTE_ALIGNMENT - 1 ) ) & (~( TORQUE_BYTE_ALIGNMENT - 1 ));
+
+   // Move to the next block if this one is full.
+   if ( pBlock == NULL || offset + _allocSize > pBlock->mSize )
+   {
+      pBlock = nextBlock( pArena, _allocSize );
+      offset = 0;
+   }
+
+   // Sanity check.
+   AssertFatal( !( offset & ( TORQUE_BYTE_ALIGNMENT - 1 ) ), "Frame allocation is not on a 4-byte boundry." );
+
+   U8* p = pBlock->getData() + offset;
+   pArena->mWaterMark = pBlock->mBase + offset + _allocSize;
+
+   if (pArena->mWaterMark > pArena->mScopePeak)
+   {
+      pArena->mScopePeak = pArena->mWaterMark;
+      if (pArena->mWaterMark > pArena->mPeakWaterMark)
+         pArena->mPeakWaterMark = pArena->mWaterMark;
+   }
+
+#ifdef TORQUE_DEBUG
+   U32 *flag = (U32*) (p + _allocSize - 4);
+   *flag = 0xdeadbeef ^ pArena->mWaterMark;
+#endif
+   return p;
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameAllocator::setWaterMark(const U32 waterMark)
+{
+   Arena* pArena = getArena();
+   AssertFatal(waterMark <= pArena->mWaterMark, "Error, invalid waterMark");
+
+   Block* pBlock = pArena->mCurrent;
+
+#ifdef TORQUE_DEBUG
+   if( pBlock != NULL && pArena->mWaterMark - pBlock->mBase >= 4 )
+   {
+      U32 *flag = (U32*) (pBlock->getData() + pArena->mWaterMark - pBlock->mBase - 4);
+      AssertFatal( *flag == (0xdeadbeef ^ pArena->mWaterMark), "FrameAllocator guard overwritten!");
+   }
+#endif
+
+   // Step back to the block holding the water mark.
+   while ( pBlock != NULL && waterMark < pBlock->mBase )
+      pBlock = pBlock->mPrev;
+
+   pArena->mCurrent = pBlock;
+   pArena->mWaterMark = waterMark;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 FrameAllocator::getWaterMark()
+{
+   return getArena()->mWaterMark;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 FrameAllocator::getHighWaterMark()
+{
+   return getArena()->mBlockSize;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 FrameAllocator::getPeakWaterMark()
+{
+   return getArena()->mPeakWaterMark;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 FrameAllocator::beginTag()
+{
+   Arena* pArena = getArena();
+   const U32 outerPeak = pArena->mScopePeak;
+   pArena->mScopePeak = pArena->mWaterMark;
+   return outerPeak;
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameAllocator::endTag(const char* pTag, const U32 waterMark, const U32 outerPeak)
+{
+   Arena* pArena = getArena();
+   const U32 used = pArena->mScopePeak - waterMark;
+
+   // The outer scope saw everything this one did.
+   pArena->mScopePeak = getMax( outerPeak, pArena->mScopePeak );
+
+   TagStats* pStats = findTag( pArena, pTag );
+   if ( pStats == NULL )
+   {
+      if ( pArena->mTagCount == MaxTags )
+         return;
+
+      pStats = &pArena->mTags[pArena->mTagCount];
+      pStats->mTag = pTag;
+      pStats->mPeak = 0;
+      pStats->mScopes = 0;
+      pArena->mTagCount++;
+   }
+
+   pStats->mPeak = getMax( pStats->mPeak, used );
+   pStats->mScopes++;
+}
+
+//-----------------------------------------------------------------------------
+
+FrameAllocator::TagStats* FrameAllocator::findTag(Arena* pArena, const char* pTag)
+{
+   // Tags are usually literals so try their addresses first.
+   for ( U32 index = 0; index < pArena->mTagCount; ++index )
+   {
+      if ( pArena->mTags[index].mTag == pTag )
+         return &pArena->mTags[index];
+   }
+
+   for ( U32 index = 0; index < pArena->mTagCount; ++index )
+   {
+      if ( dStrcmp( pArena->mTags[index].mTag, pTag ) == 0 )
+         return &pArena->mTags[index];
+   }
+
+   return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 FrameAllocator::getTagPeak(const char* pTag)
+{
+   const TagStats* pStats = findTag( getArena(), pTag );
+   return pStats != NULL ? pStats->mPeak : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void FrameAllocator::dumpStats()
+{
+   Con::printf( "Frame allocator:" );
+
+   for ( Arena* pArena = smArenaList; pArena != NULL; pArena = pArena->mNext )
+   {
+      Con::printf( "  Thread %u%s: %u bytes in %u blocks, peak %u bytes, grown %u times.",
+         pArena->mThreadId, pArena->mActive ? "" : " (exited)", pArena->mCapacity, pArena->mBlockCount, pArena->mPeakWaterMark, pArena->mGrowCount );
+
+      for ( U32 index = 0; index < pArena->mTagCount; ++index )
+      {
+         const TagStats& stats = pArena->mTags[index];
+         Con::printf( "    %s: peak %u bytes over %u scopes.", stats.mTag, stats.mPeak, stats.mScopes );
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction(getMaxFrameAllocation, S32, 1,1, "getMaxFrameAllocation();")
+{
+   return FrameAllocator::getPeakWaterMark();
+}
+
+ConsoleFunction(dumpFrameAllocatorStats, void, 1, 1, "() Prints the frame allocator usage of every thread.\n"
+                "@return No return value.")
+{
+   FrameAllocator::dumpStats();
+}
@@ -43,110 +43,75 @@
 ///   // Free frameAllocator memory
 ///   FrameAllocator::setWaterMark(waterMark);
 /// @endcode
+///
+/// Every thread has its own arena, so worker threads can use the allocator
+/// for scratch data just like the main thread. The arena of the thread that
+/// calls init() starts with a block of the given size; other threads get an
+/// arena on first use that grows in blocks of ThreadBlockSize. When a block
+/// fills up, another is linked from the heap rather than failing, and the
+/// water mark carries on across blocks. Blocks are kept for reuse after the
+/// water mark drops back. A worker thread calls releaseThread() before it
+/// exits, which frees its blocks and hands its arena to the next new thread.
+///
+/// A FrameAllocatorMarker given a tag records the most memory used inside its
+/// scope against that tag. dumpFrameAllocatorStats() reports these for each
+/// thread.
 class FrameAllocator
 {
-   static U8*   smBuffer;
-   static U32   smHighWaterMark;
-   static U32   smWaterMark;
-
-  public:
-   inline static void init(const U32 frameSize);
-   inline static void destroy();
-
-   inline static void* alloc(const U32 allocSize);
-
-   inline static void setWaterMark(const U32);
-   inline static U32  getWaterMark();
-   inline static U32  getHighWaterMark();
-};
-
-#if defined(TORQUE_DEBUG)
-static U32 sgMaxFrameAllocation = 0;
-#endif
-
-void FrameAllocator::init(const U32 frameSize)
-{
-   AssertFatal(smBuffer == NULL, "Error, already initialized");
-   smBuffer = new U8[frameSize];
-   smWaterMark = 0;
-   smHighWaterMark = frameSize;
-}
-
-void FrameAllocator::destroy()
-{
-   AssertFatal(smBuffer != NULL, "Error, not initialized");
+public:
+   enum Constants
+   {
+      ThreadBlockSize = 64 * 1024,  ///< Block size for arenas of threads that did not call init().
+      MaxTags = 32,                 ///< Tags tracked per thread.  Further tags are not recorded.
+   };
 
-   delete [] smBuffer;
-   smBuffer = NULL;
-   smWaterMark = 0;
-   smHighWaterMark = 0;
-}
+   static void init(const U32 frameSize);
+   static void destroy();
 
-/// This #define is used by the FrameAllocator to align starting addresses to
-/// be byte aligned to this value. This is important on the 360 and possibly
-/// on other platforms as well. Use this #define anywhere alignment is needed.
-///
-/// NOTE: Do not change this value per-platform unless you have a very good
-/// reason for doing so. It has the potential to cause inconsistencies in 
-/// memory which is allocated and expected to be contiguous.
-#define TORQUE_BYTE_ALIGNMENT 4
+   static void* alloc(const U32 allocSize);
 
+   static void setWaterMark(const U32);
+   static U32  getWaterMark();
 
-void* FrameAllocator::alloc(const U32 allocSize)
-{
-   U32 _allocSize = allocSize;
-#ifdef TORQUE_DEBUG
-   _allocSize+=4;
-#endif
-   AssertFatal(smBuffer != NULL, "Error, no buffer!");
-   AssertFatal(smWaterMark + _allocSize <= smHighWaterMark, "Error alloc too large, increase frame size!");
+   /// The size of the calling thread's frame: the size given to init(), or
+   /// ThreadBlockSize on other threads.  Allocating past it still succeeds but
+   /// links another block from the heap.
+   static U32  getHighWaterMark();
 
-   // Keep all frame allocator allocations aligned to DWORD boundries on the 360
-   // Add 3, mask out the lower 3 bits.
-   smWaterMark = ( smWaterMark + ( TORQUE_BYTE_ALIGNMENT - 1 ) ) & (~( TORQUE_BYTE_ALIGNMENT - 1 ));
+   /// The most bytes the calling thread has had allocated at once.
+   static U32  getPeakWaterMark();
 
-   // Sanity check.
-   AssertFatal( !( smWaterMark & ( TORQUE_BYTE_ALIGNMENT - 1 ) ), "Frame allocation is not on a 4-byte boundry." );
+   /// Start measuring a tagged scope.
+   /// @return A value to pass to endTag().
+   static U32  beginTag();
 
-   U8* p = &smBuffer[smWaterMark];
-   smWaterMark += _allocSize;
+   /// Record the most used since the water mark was at waterMark against the tag.
+   static void endTag(const char* pTag, const U32 waterMark, const U32 outerPeak);
 
-#if defined(TORQUE_DEBUG)
-   if (smWaterMark > sgMaxFrameAllocation)
-      sgMaxFrameAllocation = smWaterMark;
-#endif
+   /// The most the calling thread has used inside scopes with the tag.
+   static U32  getTagPeak(const char* pTag);
 
-#ifdef TORQUE_DEBUG
-   U32 *flag = (U32*) &smBuffer[smWaterMark-4];
-   *flag = 0xdeadbeef ^ smWaterMark;
-#endif
-   return p;
-}
+   /// Free the calling thread's blocks and give its arena up for reuse.
+   /// Worker threads should call this before they exit.
+   static void releaseThread();
 
+   /// The number of arenas created, including those waiting for reuse.
+   static U32  getArenaCount();
 
-void FrameAllocator::setWaterMark(const U32 waterMark)
-{
-   AssertFatal(waterMark < smHighWaterMark, "Error, invalid waterMark");
+   /// Print the usage of every thread's arena.
+   static void dumpStats();
 
-#ifdef TORQUE_DEBUG
-   if(smWaterMark >= 4 )
-   {
-      U32 *flag = (U32*) &smBuffer[smWaterMark-4];
-      AssertFatal( *flag == (0xdeadbeef ^ smWaterMark), "FrameAllocator guard overwritten!");
-   }
-#endif
-   smWaterMark = waterMark;
-}
+private:
+   struct Block;
+   struct TagStats;
+   struct Arena;
 
-U32 FrameAllocator::getWaterMark()
-{
-   return smWaterMark;
-}
+   static Arena* getArena();
+   static TagStats* findTag(Arena* pArena, const char* pTag);
+   static Block* nextBlock(Arena* pArena, const U32 allocSize);
 
-U32 FrameAllocator::getHighWaterMark()
-{
-   return smHighWaterMark;
-}
+   static Arena* volatile smArenaList;
+};
 
 /// Helper class to deal with FrameAllocator usage.
 ///
@@ -163,18 +128,27 @@ U32 FrameAllocator::getHighWaterMark()
 /// automatically restore the watermark on the FrameAllocator. In situations
 /// with complex branches, this can be a significant headache remover, as you
 /// don't have to remember to reset the FrameAllocator on every posssible branch.
+///
+/// Passing a tag (which must outlive the program, such as a string literal)
+/// records the most memory used in the scope for the allocator statistics.
 class FrameAllocatorMarker
 {
    U32 mMarker;
+   U32 mOuterPeak;
+   const char* mTag;
 
 public:
-   FrameAllocatorMarker()
+   FrameAllocatorMarker(const char* tag = NULL) : mTag(tag)
    {
       mMarker = FrameAllocator::getWaterMark();
+      mOuterPeak = mTag != NULL ? FrameAllocator::beginTag() : 0;
    }
 
    ~FrameAllocatorMarker()
    {
+      if (mTag != NULL)
+         FrameAllocator::endTag(mTag, mMarker, mOuterPeak);
+
       FrameAllocator::setWaterMark(mMarker);
    }
 
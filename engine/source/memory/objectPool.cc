@@ -0,0 +1,194 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "memory/objectPool.h"
+
+#ifndef _MMATHFN_H_
+#include "math/mMathFn.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+ObjectPool::ObjectPool( const dsize_t slotSize, const U32 capacity ) :
+   mCapacity( capacity ),
+   mUsedCount( 0 ),
+   mPeakCount( 0 ),
+   mSlabUsed( SlabSlots ),
+   mpFreeList( NULL )
+{
+   // Slots must hold a free list link and stay aligned.
+   mSlotSize = getMax( slotSize, dsize_t( sizeof(FreeSlot) ) );
+   mSlotSize = ( mSlotSize + SlotAlignment - 1 ) & ~dsize_t( SlotAlignment - 1 );
+
+   VECTOR_SET_ASSOCIATION( mSlabs );
+}
+
+//-----------------------------------------------------------------------------
+
+ObjectPool::~ObjectPool()
+{
+   AssertWarn( mUsedCount == 0, "ObjectPool::~ObjectPool() - Slots are still in use." );
+
+   for ( S32 index = 0; index < mSlabs.size(); ++index )
+      dFree( mSlabs[index] );
+}
+
+//-----------------------------------------------------------------------------
+
+void* ObjectPool::alloc( void )
+{
+   if ( mUsedCount >= mCapacity )
+      return NULL;
+
+   void* pSlot;
+
+   if ( mpFreeList != NULL )
+   {
+      // Reuse the most recently freed slot.
+      pSlot = mpFreeList;
+      mpFreeList = mpFreeList->mpNext;
+   }
+   else
+   {
+      // Carve a slot from the newest slab, allocating another if it is full.
+      if ( mSlabUsed == SlabSlots )
+      {
+         mSlabs.push_back( (U8*)dMalloc( mSlotSize * SlabSlots ) );
+         mSlabUsed = 0;
+      }
+
+      pSlot = mSlabs.last() + mSlotSize * mSlabUsed++;
+   }
+
+   mUsedCount++;
+   if ( mUsedCount > mPeakCount )
+      mPeakCount = mUsedCount;
+
+   return pSlot;
+}
+
+//-----------------------------------------------------------------------------
+
+void ObjectPool::free( void* pSlot )
+{
+   AssertFatal( pSlot != NULL, "ObjectPool::free() - Cannot free a NULL slot." );
+   AssertFatal( mUsedCount > 0, "ObjectPool::free() - No slots are in use." );
+
+   FreeSlot* pFreeSlot = (FreeSlot*)pSlot;
+   pFreeSlot->mpNext = mpFreeList;
+   mpFreeList = pFreeSlot;
+   mUsedCount--;
+}
+
+//-----------------------------------------------------------------------------
+
+ObjectPoolAllocator::ObjectPoolAllocator( const U32 capacity ) :
+   mCapacity( capacity ),
+   mHeapCount( 0 ),
+   mLastPool( -1 )
+{
+   VECTOR_SET_ASSOCIATION( mPools );
+   VECTOR_SET_ASSOCIATION( mPoolKeys );
+}
+
+//-----------------------------------------------------------------------------
+
+ObjectPoolAllocator::~ObjectPoolAllocator()
+{
+   for ( S32 index = 0; index < mPools.size(); ++index )
+      delete mPools[index];
+}
+
+//-----------------------------------------------------------------------------
+
+void* ObjectPoolAllocator::alloc( const dsize_t size, const void* pKey )
+{
+   const dsize_t slotSize = size + sizeof(Header);
+
+   ObjectPool* pPool = findPool( slotSize, pKey );
+   Header* pHeader = (Header*)pPool->alloc();
+
+   if ( pHeader == NULL )
+   {
+      // The pool is full so use the heap.
+      pHeader = (Header*)dMalloc( slotSize );
+      pPool = NULL;
+      mHeapCount++;
+   }
+
+   pHeader->mpPool = pPool;
+   return pHeader + 1;
+}
+
+//-----------------------------------------------------------------------------
+
+void ObjectPoolAllocator::free( void* pMemory )
+{
+   if ( pMemory == NULL )
+      return;
+
+   Header* pHeader = (Header*)pMemory - 1;
+
+   if ( pHeader->mpPool != NULL )
+   {
+      pHeader->mpPool->free( pHeader );
+      return;
+   }
+
+   dFree( pHeader );
+   mHeapCount--;
+}
+
+//-----------------------------------------------------------------------------
+
+void ObjectPoolAllocator::setCapacity( const U32 capacity )
+{
+   mCapacity = capacity;
+
+   for ( S32 index = 0; index < mPools.size(); ++index )
+      mPools[index]->setCapacity( capacity );
+}
+
+//-----------------------------------------------------------------------------
+
+ObjectPool* ObjectPoolAllocator::findPool( const dsize_t slotSize, const void* pKey )
+{
+   // Objects of one type tend to be created in runs.
+   if ( mLastPool >= 0 && mPoolKeys[mLastPool] == pKey && mPools[mLastPool]->getSlotSize() >= slotSize && mPools[mLastPool]->getSlotSize() - slotSize < ObjectPool::SlotAlignment )
+      return mPools[mLastPool];
+
+   for ( S32 index = 0; index < mPools.size(); ++index )
+   {
+      ObjectPool* pPool = mPools[index];
+      if ( mPoolKeys[index] == pKey && pPool->getSlotSize() >= slotSize && pPool->getSlotSize() - slotSize < ObjectPool::SlotAlignment )
+      {
+         mLastPool = index;
+         return pPool;
+      }
+   }
+
+   mLastPool = mPools.size();
+   mPools.push_back( new ObjectPool( slotSize, mCapacity ) );
+   mPoolKeys.push_back( pKey );
+   return mPools.last();
+}
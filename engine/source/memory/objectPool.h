@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _OBJECTPOOL_H_
+#define _OBJECTPOOL_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// A fixed-capacity pool of equally sized memory slots.
+///
+/// Slots are carved from slabs of SlabSlots slots as the pool grows, so
+/// objects allocated together sit together in memory.  Freed slots go on a
+/// free list and are handed out again most recently freed first, while they
+/// are still warm in the cache.  The slabs are only released when the pool is
+/// destroyed.
+///
+/// alloc() returns NULL once the capacity is in use so the caller can fall
+/// back to the heap.  The pool is not thread-safe.
+class ObjectPool
+{
+public:
+   enum Constants
+   {
+      SlabSlots = 32,      ///< Slots carved from each slab.
+      SlotAlignment = 16,  ///< Slot sizes are rounded up to this.
+   };
+
+   ObjectPool( const dsize_t slotSize, const U32 capacity );
+   ~ObjectPool();
+
+   /// Allocate a slot.
+   /// @return NULL if the pool is at capacity.
+   void* alloc( void );
+
+   /// Return a slot from this pool.
+   void free( void* pSlot );
+
+   /// Change the most slots that may be in use at once.  Slots already in use are unaffected.
+   inline void setCapacity( const U32 capacity ) { mCapacity = capacity; }
+   inline U32 getCapacity( void ) const { return mCapacity; }
+
+   inline dsize_t getSlotSize( void ) const { return mSlotSize; }
+   inline U32 getUsedCount( void ) const { return mUsedCount; }
+   inline U32 getPeakCount( void ) const { return mPeakCount; }
+   inline U32 getSlabCount( void ) const { return mSlabs.size(); }
+
+private:
+   struct FreeSlot
+   {
+      FreeSlot* mpNext;
+   };
+
+   dsize_t        mSlotSize;
+   U32            mCapacity;
+   U32            mUsedCount;
+   U32            mPeakCount;
+   U32            mSlabUsed;     ///< Slots carved from the newest slab.
+   FreeSlot*      mpFreeList;
+   Vector<U8*>    mSlabs;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Allocates objects of any size from an ObjectPool per key.
+///
+/// The key is normally the class rep of the object being created, so every
+/// class gets its own slabs and capacity.  Allocations without a key, such as
+/// those made by a class-specific operator new which only sees the size, come
+/// from a pool per slot size shared by every class that rounds up to it.  Each
+/// allocation carries a small header naming its pool so free() needs no size,
+/// and once a pool is at capacity the allocation comes from the heap instead.
+class ObjectPoolAllocator
+{
+public:
+   ObjectPoolAllocator( const U32 capacity );
+   ~ObjectPoolAllocator();
+
+   void* alloc( const dsize_t size, const void* pKey = NULL );
+   void free( void* pMemory );
+
+   /// Change the capacity of every pool, including those created later.
+   void setCapacity( const U32 capacity );
+   inline U32 getCapacity( void ) const { return mCapacity; }
+
+   inline U32 getPoolCount( void ) const { return mPools.size(); }
+   inline const ObjectPool* getPool( const U32 index ) const { return mPools[index]; }
+   inline const void* getPoolKey( const U32 index ) const { return mPoolKeys[index]; }
+
+   /// Allocations that did not fit in their pool.
+   inline U32 getHeapCount( void ) const { return mHeapCount; }
+
+private:
+   /// Precedes every allocation, keeping the object aligned.
+   union Header
+   {
+      ObjectPool* mpPool;
+      U8          mAlign[ObjectPool::SlotAlignment];
+   };
+
+   ObjectPool* findPool( const dsize_t slotSize, const void* pKey );
+
+   U32                  mCapacity;
+   U32                  mHeapCount;
+   S32                  mLastPool;
+   Vector<ObjectPool*>  mPools;
+   Vector<const void*>  mPoolKeys;
+};
+
+#endif // _OBJECTPOOL_H_
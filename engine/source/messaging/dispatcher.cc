@@ -37,6 +37,9 @@
 #include "platform/threads/mutex.h"
 #include "collection/simpleHashTable.h"
 #include "memory/safeDelete.h"
+#include "platform/threads/lockFreeQueue.h"
+#include "platform/platformTLS.h"
+#include <stdlib.h> // posted messages cross threads so use malloc and free directly
 
 namespace Dispatcher
 {
@@ -77,34 +80,216 @@ void IMessageListener::onRemoveFromQueue(StringTableEntry queue)
 // Global State
 //////////////////////////////////////////////////////////////////////////
 
+enum
+{
+   /// Maximum number of queues that can be registered at once.
+   MaxQueues = 1024,
+
+   /// Messages that can be posted before they have to be delivered.
+   PostQueueSize = 8192,
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief A message waiting in the post queue
+///
+/// The message and data strings are stored in the same allocation,
+/// directly after the structure.
+//////////////////////////////////////////////////////////////////////////
+struct PostedMessage
+{
+   QueueHandle mQueue;
+   const char *mMessage;
+   const char *mData;
+};
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Internal class used by the dispatcher
+///
+/// The mutex only guards queue and listener registration. Dispatchers find
+/// queues through the handle table without locking and count themselves in
+/// #mActiveDispatches under the current epoch. Retired queues and listener
+/// lists are freed by waitForDispatches(), which moves the epoch on and
+/// waits for the dispatches counted under the previous one to finish.
 //////////////////////////////////////////////////////////////////////////
 static struct _DispatchData
 {
    void *mMutex;
    SimpleHashTable<MessageQueue> mQueues;
 
-   _DispatchData()
+   MessageQueue * volatile mQueueTable[MaxQueues];
+   U32 mQueueSerials[MaxQueues];
+   Vector<U32> mFreeQueueSlots;
+
+   volatile U32 mEpoch;
+   volatile S32 mActiveDispatches[2];
+   VectorPtr<MessageQueue::ListenerList *> mRetiredListeners;
+   VectorPtr<MessageQueue *> mRetiredQueues;
+
+   /// Serializes waitForDispatches(). Never taken by a dispatch.
+   void *mWaitMutex;
+
+   LockFreeMPSCQueue<PostedMessage *> mPostedMessages;
+
+   _DispatchData() : mEpoch(0), mPostedMessages(PostQueueSize)
    {
       mMutex = Mutex::createMutex();
+      mWaitMutex = Mutex::createMutex();
+      mActiveDispatches[0] = 0;
+      mActiveDispatches[1] = 0;
+
+      for(U32 i = 0;i < MaxQueues;i++)
+      {
+         mQueueTable[i] = NULL;
+         mQueueSerials[i] = 1;
+      }
+
+      // Hand out the lowest slots first.
+      for(U32 i = MaxQueues;i > 0;i--)
+         mFreeQueueSlots.push_back(i - 1);
    }
 
    ~_DispatchData()
    {
+      // Drop anything that was never delivered.
+      PostedMessage *posted;
+      while(mPostedMessages.pop(posted))
+         free(posted);
+
       if(Mutex::lockMutex( mMutex ) )
       {
+         for(U32 i = 0;i < MaxQueues;i++)
+            mQueueTable[i] = NULL;
+
          mQueues.clearTables();
 
+         for(S32 i = 0;i < mRetiredListeners.size();i++)
+            delete mRetiredListeners[i];
+         for(S32 i = 0;i < mRetiredQueues.size();i++)
+            delete mRetiredQueues[i];
+
          Mutex::unlockMutex( mMutex );
       }
 
       Mutex::destroyMutex( mMutex );
       //SAFE_DELETE(mMutex);
       mMutex = NULL;
+
+      Mutex::destroyMutex( mWaitMutex );
+      mWaitMutex = NULL;
    }
 } gDispatchData;
 
+/// Number of dispatches in progress on the calling thread.
+static ThreadStorage& getDispatchDepthStorage()
+{
+   static ThreadStorage sDispatchDepth;
+   return sDispatchDepth;
+}
+
+static bool isDispatching()
+{
+   return getDispatchDepthStorage().get() != NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Marks the scope of a lock-free dispatch
+//////////////////////////////////////////////////////////////////////////
+struct DispatchScope
+{
+   U32 mEpoch;
+
+   DispatchScope()
+   {
+      mEpoch = dAtomicRead(gDispatchData.mEpoch) & 1;
+      dAtomicIncrement(gDispatchData.mActiveDispatches[mEpoch]);
+
+      ThreadStorage &depth = getDispatchDepthStorage();
+      depth.set((void *)((dsize_t)depth.get() + 1));
+   }
+
+   ~DispatchScope()
+   {
+      ThreadStorage &depth = getDispatchDepthStorage();
+      depth.set((void *)((dsize_t)depth.get() - 1));
+
+      dAtomicDecrement(gDispatchData.mActiveDispatches[mEpoch]);
+   }
+};
+
+/// Find a queue by handle. Must be called within a DispatchScope.
+static MessageQueue *findQueue(QueueHandle handle)
+{
+   MessageQueue *queue = gDispatchData.mQueueTable[handle & (MaxQueues - 1)];
+   if(queue == NULL || queue->mHandle != handle)
+      return NULL;
+
+   return queue;
+}
+
+/// Wait for the dispatches that were counted under the current epoch to finish.
+static void waitForEpoch()
+{
+   const U32 epoch = dAtomicRead(gDispatchData.mEpoch);
+   dAtomicWrite(gDispatchData.mEpoch, epoch + 1);
+
+   while(dAtomicAdd(gDispatchData.mActiveDispatches[epoch & 1], 0) != 0)
+      Platform::sleep(0);
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Wait for other threads to stop using anything retired so far and free it
+///
+/// Every dispatch that could have seen a retired queue or listener list was
+/// counted under one of the two epochs, so waiting out both covers them all.
+/// The dispatcher mutex must not be locked, so that the listeners being
+/// waited for can still register and unregister. Does nothing when called
+/// from within a dispatch, since that dispatch may be using the retired
+/// lists; they are freed by a later call instead.
+//////////////////////////////////////////////////////////////////////////
+static void waitForDispatches()
+{
+   if(isDispatching())
+      return;
+
+   MutexHandle wh;
+   if(! wh.lock(gDispatchData.mWaitMutex, true))
+      return;
+
+   VectorPtr<MessageQueue::ListenerList *> retiredListeners;
+   VectorPtr<MessageQueue *> retiredQueues;
+   {
+      MutexHandle mh;
+      if(! mh.lock(gDispatchData.mMutex, true))
+         return;
+
+      retiredListeners = gDispatchData.mRetiredListeners;
+      retiredQueues = gDispatchData.mRetiredQueues;
+      gDispatchData.mRetiredListeners.clear();
+      gDispatchData.mRetiredQueues.clear();
+   }
+
+   waitForEpoch();
+   waitForEpoch();
+
+   for(S32 i = 0;i < retiredListeners.size();i++)
+      delete retiredListeners[i];
+
+   for(S32 i = 0;i < retiredQueues.size();i++)
+      delete retiredQueues[i];
+}
+
+/// Publish a new listener list for a queue. Dispatcher mutex must be locked.
+static void swapListeners(MessageQueue *queue, MessageQueue::ListenerList *listeners)
+{
+   MessageQueue::ListenerList *oldListeners = queue->mListeners;
+
+   // Make sure the list is complete before it can be seen.
+   dMemoryBarrier();
+   queue->mListeners = listeners;
+
+   gDispatchData.mRetiredListeners.push_back(oldListeners);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Queue Registration
 //////////////////////////////////////////////////////////////////////////
@@ -120,38 +305,78 @@ bool isQueueRegistered(const char *name)
    return false;
 }
 
-void registerMessageQueue(const char *name)
+QueueHandle registerMessageQueue(const char *name)
 {
-   if(isQueueRegistered(name))
-      return;
+   MutexHandle mh;
+   if(! mh.lock(gDispatchData.mMutex, true))
+      return InvalidQueueHandle;
 
-   if(Mutex::lockMutex( gDispatchData.mMutex, true ))
-   {
-      MessageQueue *queue = new MessageQueue;
-      queue->mQueueName = StringTable->insert(name);
-      gDispatchData.mQueues.insert(queue, name);
+   MessageQueue *queue = gDispatchData.mQueues.retrieve(name);
+   if(queue != NULL)
+      return queue->mHandle;
 
-      Mutex::unlockMutex( gDispatchData.mMutex );
+   if(gDispatchData.mFreeQueueSlots.empty())
+   {
+      Con::errorf("Dispatcher::registerMessageQueue - Unable to register queue '%s', the maximum of %d queues are registered", name, MaxQueues);
+      return InvalidQueueHandle;
    }
+
+   const U32 slot = gDispatchData.mFreeQueueSlots.last();
+   gDispatchData.mFreeQueueSlots.pop_back();
+
+   queue = new MessageQueue;
+   queue->mQueueName = StringTable->insert(name);
+   queue->mHandle = (gDispatchData.mQueueSerials[slot] * MaxQueues) | slot;
+   gDispatchData.mQueues.insert(queue, name);
+
+   // Make sure the queue is complete before it can be seen.
+   dMemoryBarrier();
+   gDispatchData.mQueueTable[slot] = queue;
+
+   return queue->mHandle;
 }
 
-void unregisterMessageQueue(const char *name)
+QueueHandle getQueueHandle(const char *name)
 {
    MutexHandle mh;
    if(mh.lock(gDispatchData.mMutex, true))
    {
+      MessageQueue *queue = gDispatchData.mQueues.retrieve(name);
+      if(queue != NULL)
+         return queue->mHandle;
+   }
+
+   return InvalidQueueHandle;
+}
+
+void unregisterMessageQueue(const char *name)
+{
+   {
+      MutexHandle mh;
+      if(! mh.lock(gDispatchData.mMutex, true))
+         return;
+
       MessageQueue *queue = gDispatchData.mQueues.remove(name);
       if(queue == NULL)
          return;
 
+      // Stop new dispatches finding the queue and retire the slot's handle.
+      const U32 slot = queue->mHandle & (MaxQueues - 1);
+      gDispatchData.mQueueTable[slot] = NULL;
+      gDispatchData.mQueueSerials[slot]++;
+      gDispatchData.mFreeQueueSlots.push_back(slot);
+
       // Tell the listeners about it
-      for(S32 i = 0;i < queue->mListeners.size();i++)
+      const MessageQueue::ListenerList *listeners = queue->mListeners;
+      for(S32 i = 0;i < listeners->size();i++)
       {
-         queue->mListeners[i]->onRemoveFromQueue(name);
+         (*listeners)[i]->onRemoveFromQueue(name);
       }
 
-      delete queue;
+      gDispatchData.mRetiredQueues.push_back(queue);
    }
+
+   waitForDispatches();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -163,26 +388,34 @@ bool registerMessageListener(const char *queue, IMessageListener *listener)
    if(! isQueueRegistered(queue))
       registerMessageQueue(queue);
 
-   MutexHandle mh;
-
-   if(! mh.lock(gDispatchData.mMutex, true))
-      return false;
-
-   MessageQueue *q = gDispatchData.mQueues.retrieve(queue);
-   if(q == NULL)
    {
-      Con::errorf("Dispatcher::registerMessageListener - Queue '%s' not found?! It should have been added automatically!", queue);
-      return false;
-   }
+      MutexHandle mh;
 
-   for(VectorPtr<IMessageListener *>::iterator i = q->mListeners.begin();i != q->mListeners.end();i++)
-   {
-      if(*i == listener)
+      if(! mh.lock(gDispatchData.mMutex, true))
+         return false;
+
+      MessageQueue *q = gDispatchData.mQueues.retrieve(queue);
+      if(q == NULL)
+      {
+         Con::errorf("Dispatcher::registerMessageListener - Queue '%s' not found?! It should have been added automatically!", queue);
          return false;
+      }
+
+      const MessageQueue::ListenerList *listeners = q->mListeners;
+      for(MessageQueue::ListenerList::const_iterator i = listeners->begin();i != listeners->end();i++)
+      {
+         if(*i == listener)
+            return false;
+      }
+
+      MessageQueue::ListenerList *newListeners = new MessageQueue::ListenerList(*listeners);
+      newListeners->push_front(listener);
+      swapListeners(q, newListeners);
+
+      listener->onAddToQueue(StringTable->insert(queue));
    }
 
-   q->mListeners.push_front(listener);
-   listener->onAddToQueue(StringTable->insert(queue));
+   waitForDispatches();
    return true;
 }
 
@@ -191,24 +424,37 @@ void unregisterMessageListener(const char *queue, IMessageListener *listener)
    if(! isQueueRegistered(queue))
       return;
 
-   MutexHandle mh;
+   {
+      MutexHandle mh;
 
-   if(! mh.lock(gDispatchData.mMutex, true))
-      return;
+      if(! mh.lock(gDispatchData.mMutex, true))
+         return;
 
-   MessageQueue *q = gDispatchData.mQueues.retrieve(queue);
-   if(q == NULL)
-      return;
+      MessageQueue *q = gDispatchData.mQueues.retrieve(queue);
+      if(q == NULL)
+         return;
 
-   for(VectorPtr<IMessageListener *>::iterator i = q->mListeners.begin();i != q->mListeners.end();i++)
-   {
-      if(*i == listener)
+      const MessageQueue::ListenerList *listeners = q->mListeners;
+      S32 i;
+      for(i = 0;i < listeners->size();i++)
       {
-         listener->onRemoveFromQueue(StringTable->insert(queue));
-         q->mListeners.erase(i);
-         return;
+         if((*listeners)[i] == listener)
+            break;
       }
+
+      if(i == listeners->size())
+         return;
+
+      listener->onRemoveFromQueue(StringTable->insert(queue));
+
+      MessageQueue::ListenerList *newListeners = new MessageQueue::ListenerList(*listeners);
+      newListeners->erase(i);
+      swapListeners(q, newListeners);
    }
+
+   // The listener may be freed as soon as we return, so wait for any
+   // dispatch on another thread that could still call it.
+   waitForDispatches();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -217,41 +463,51 @@ void unregisterMessageListener(const char *queue, IMessageListener *listener)
 
 bool dispatchMessage(const char *queue, const char *msg, const char *data)
 {
-   MutexHandle mh;
-
-   if(! mh.lock(gDispatchData.mMutex, true))
-      return true;
-
-   MessageQueue *q = gDispatchData.mQueues.retrieve(queue);
-   if(q == NULL)
+   const QueueHandle handle = getQueueHandle(queue);
+   if(handle == InvalidQueueHandle)
    {
       Con::errorf("Dispatcher::dispatchMessage - Attempting to dispatch to unknown queue '%s'", queue);
       return true;
    }
 
-   return q->dispatchMessage(msg, data);
+   return dispatchMessage(handle, msg, data);
 }
 
+bool dispatchMessage(QueueHandle queue, const char *msg, const char *data)
+{
+   DispatchScope scope;
+
+   MessageQueue *q = findQueue(queue);
+   if(q == NULL)
+      return true;
+
+   return q->dispatchMessage(msg, data);
+}
 
 bool dispatchMessageObject(const char *queue, Message *msg)
 {
-   MutexHandle mh;
+   const QueueHandle handle = getQueueHandle(queue);
+   if(handle == InvalidQueueHandle)
+   {
+      Con::errorf("Dispatcher::dispatchMessage - Attempting to dispatch to unknown queue '%s'", queue);
+      return true;
+   }
+
+   return dispatchMessageObject(handle, msg);
+}
 
+bool dispatchMessageObject(QueueHandle queue, Message *msg)
+{
    if(msg == NULL)
       return true;
 
    msg->addReference();
 
-   if(! mh.lock(gDispatchData.mMutex, true))
-   {
-      msg->freeReference();
-      return true;
-   }
+   DispatchScope scope;
 
-   MessageQueue *q = gDispatchData.mQueues.retrieve(queue);
+   MessageQueue *q = findQueue(queue);
    if(q == NULL)
    {
-      Con::errorf("Dispatcher::dispatchMessage - Attempting to dispatch to unknown queue '%s'", queue);
       msg->freeReference();
       return true;
    }
@@ -278,6 +534,59 @@ bool dispatchMessageObject(const char *queue, Message *msg)
    return bResult;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Deferred Delivery
+//////////////////////////////////////////////////////////////////////////
+
+void postMessage(QueueHandle queue, const char *msg, const char *data)
+{
+   const U32 msgLength = dStrlen(msg) + 1;
+   const U32 dataLength = dStrlen(data) + 1;
+
+   PostedMessage *posted = (PostedMessage *)malloc(sizeof(PostedMessage) + msgLength + dataLength);
+   char *strings = (char *)(posted + 1);
+   dMemcpy(strings, msg, msgLength);
+   dMemcpy(strings + msgLength, data, dataLength);
+
+   posted->mQueue = queue;
+   posted->mMessage = strings;
+   posted->mData = strings + msgLength;
+
+   while(! gDispatchData.mPostedMessages.push(posted))
+   {
+      // The main thread delivers the messages, so it can't wait for room.
+      if(Con::isMainThread())
+      {
+         dispatchMessage(queue, posted->mMessage, posted->mData);
+         free(posted);
+         return;
+      }
+
+      Platform::sleep(1);
+   }
+}
+
+U32 deliverPostedMessages()
+{
+   // Only deliver what is already posted so listeners that post can't keep us here.
+   const U32 postedCount = gDispatchData.mPostedMessages.size();
+
+   U32 delivered = 0;
+   PostedMessage *posted;
+   while(delivered < postedCount && gDispatchData.mPostedMessages.pop(posted))
+   {
+      dispatchMessage(posted->mQueue, posted->mMessage, posted->mData);
+      free(posted);
+      delivered++;
+   }
+
+   // Free anything that was retired from within a dispatch.
+   if(getRetiredCount() != 0)
+      waitForDispatches();
+
+   return delivered;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Internal Functions
 //////////////////////////////////////////////////////////////////////////
@@ -287,6 +596,15 @@ MessageQueue * getMessageQueue(const char *name)
    return gDispatchData.mQueues.retrieve(name);
 }
 
+U32 getRetiredCount()
+{
+   MutexHandle mh;
+   if(! mh.lock(gDispatchData.mMutex, true))
+      return 0;
+
+   return gDispatchData.mRetiredListeners.size() + gDispatchData.mRetiredQueues.size();
+}
+
 extern bool lockDispatcherMutex()
 {
    return Mutex::lockMutex(gDispatchData.mMutex);
@@ -316,7 +634,7 @@ ConsoleFunction(registerMessageQueue, void, 2, 2, "(queueName) Registers given m
                 "@param queueName The name of the message queue\n"
                 "@return No Return Value")
 {
-   return registerMessageQueue(argv[1]);
+   registerMessageQueue(argv[1]);
 }
 
 ConsoleFunction(unregisterMessageQueue, void, 2, 2, "(queueName) Unregisters given message queue\n"
@@ -382,3 +700,19 @@ ConsoleFunction(dispatchMessageObject, bool, 3, 3, "(queueName, message) Dispatc
 
    return dispatchMessageObject(argv[1], msg);
 }
+
+ConsoleFunction(postMessage, void, 3, 4, "(queueName, event, data) Posts a message to given message queue to be delivered at the end of the frame\n"
+                "@param queueName The queue to post to\n"
+                "@param event The message you are passing\n"
+                "@param data Data\n"
+                "@return No Return Value")
+{
+   QueueHandle queue = getQueueHandle(argv[1]);
+   if(queue == InvalidQueueHandle)
+   {
+      Con::errorf("postMessage - Attempting to post to unknown queue '%s'", argv[1]);
+      return;
+   }
+
+   postMessage(queue, argv[2], argc > 3 ? argv[3] : "" );
+}
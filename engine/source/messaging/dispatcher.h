@@ -122,24 +122,71 @@ public:
    virtual void onRemoveFromQueue(StringTableEntry queue);
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Handle to a registered message queue
+///
+/// Handles are cheaper to dispatch to than queue names and stay unique for
+/// the lifetime of the process, so a handle to a queue that has since been
+/// unregistered is simply ignored.
+//////////////////////////////////////////////////////////////////////////
+typedef U32 QueueHandle;
+
+/// A handle that never refers to a queue.
+const QueueHandle InvalidQueueHandle = 0;
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Internal class for tracking message queues
+///
+/// The listener list is never modified once it is published. Registering or
+/// unregistering a listener swaps in a new list and retires the old one
+/// until every dispatch that could be using it has finished, so dispatching
+/// never locks. A listener that is removed from the queue part way through a
+/// dispatch is skipped, since a callback on the dispatching thread may have
+/// unregistered and freed it.
 //////////////////////////////////////////////////////////////////////////
 struct MessageQueue
 {
+   typedef Vector<IMessageListener *> ListenerList;
+
    StringTableEntry mQueueName;
-   VectorPtr<IMessageListener *> mListeners;
+   QueueHandle mHandle;
+   ListenerList * volatile mListeners;
 
-   MessageQueue() : mQueueName("")
+   MessageQueue() : mQueueName(""), mHandle(InvalidQueueHandle), mListeners(new ListenerList)
    {
    }
 
-   bool isEmpty()    { return mListeners.size() == 0; }
+   ~MessageQueue()
+   {
+      delete mListeners;
+   }
+
+   bool isEmpty()    { return mListeners->size() == 0; }
+
+   /// Is a listener from the list being dispatched still registered?
+   bool isListening(const ListenerList *listeners, IMessageListener *listener) const
+   {
+      // Nothing has been unregistered unless the list was swapped.
+      const ListenerList *current = mListeners;
+      if(current == listeners)
+         return true;
+
+      for(ListenerList::const_iterator i = current->begin();i != current->end();i++)
+      {
+         if(*i == listener)
+            return true;
+      }
+      return false;
+   }
 
    bool dispatchMessage(const char* event, const char* data)
    {
-      for(VectorPtr<IMessageListener *>::iterator i = mListeners.begin();i != mListeners.end();i++)
+      const ListenerList *listeners = mListeners;
+      for(ListenerList::const_iterator i = listeners->begin();i != listeners->end();i++)
       {
+         if( !isListening(listeners, *i) )
+            continue;
+
          if( !(*i)->onMessageReceived(mQueueName, event, data) )
             return false;
       }
@@ -148,8 +195,12 @@ struct MessageQueue
 
    bool dispatchMessageObject(Message *msg)
    {
-      for(VectorPtr<IMessageListener *>::iterator i = mListeners.begin();i != mListeners.end();i++)
+      const ListenerList *listeners = mListeners;
+      for(ListenerList::const_iterator i = listeners->begin();i != listeners->end();i++)
       {
+         if( !isListening(listeners, *i) )
+            continue;
+
          if( !(*i)->onMessageObjectReceived(mQueueName, msg) )
             return false;
       }
@@ -177,9 +228,19 @@ extern bool isQueueRegistered(const char *name);
 /// @brief Register a message queue
 /// 
 /// @param name The name of the message queue to register
-/// @see isQueueRegistered(), unregisterMessageQueue()
+/// @return The handle of the queue, or #InvalidQueueHandle if it could not be registered
+/// @see isQueueRegistered(), unregisterMessageQueue(), getQueueHandle()
+//////////////////////////////////////////////////////////////////////////
+extern QueueHandle registerMessageQueue(const char *name);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Get the handle of a registered message queue
+/// 
+/// @param name The name of the message queue
+/// @return The handle of the queue, or #InvalidQueueHandle if it is not registered
+/// @see registerMessageQueue()
 //////////////////////////////////////////////////////////////////////////
-extern void registerMessageQueue(const char *name);
+extern QueueHandle getQueueHandle(const char *name);
 
 //////////////////////////////////////////////////////////////////////////
 /// @brief Unregister a message queue
@@ -202,6 +263,11 @@ extern bool registerMessageListener(const char *queue, IMessageListener *listene
 //////////////////////////////////////////////////////////////////////////
 /// @brief Unregister a listener with a queue
 /// 
+/// Waits for any dispatch on another thread that could still call the
+/// listener, so it is safe to free once this returns. Called from within
+/// a dispatch it cannot wait, so a listener shared with other threads
+/// should not be freed by its own callback.
+/// 
 /// @param queue The name of the queue to unregister the listener
 /// @param listener The listener interface that was passed to registerMessageListener()
 /// @see registerMessageListener()
@@ -234,6 +300,63 @@ extern bool dispatchMessage(const char *queue, const char *msg, const char *data
 //////////////////////////////////////////////////////////////////////////
 extern bool dispatchMessageObject(const char *queue, Message *msg);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Dispatch a message to a queue by handle
+/// 
+/// Unlike dispatching by name, this never locks and is safe to call from
+/// any thread. The listeners are called on the calling thread.
+/// 
+/// @param queue Handle of the queue to dispatch the message to
+/// @param msg Message to dispatch
+/// @param data Data for message
+/// @return true for success, false for failure
+/// @see getQueueHandle()
+//////////////////////////////////////////////////////////////////////////
+extern bool dispatchMessage(QueueHandle queue, const char *msg, const char *data);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Dispatch a message object to a queue by handle
+/// 
+/// @param queue Handle of the queue to dispatch the message to
+/// @param msg Message to dispatch
+/// @return true for success, false for failure
+/// @see dispatchMessage()
+//////////////////////////////////////////////////////////////////////////
+extern bool dispatchMessageObject(QueueHandle queue, Message *msg);
+
+// @}
+
+/// @name Deferred Delivery
+// @{
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Post a message to a queue for later delivery
+/// 
+/// The message and data are copied and the message is delivered by the next
+/// call to deliverPostedMessages(). Posting is lock-free and safe to call
+/// from any number of threads. Messages are delivered in the order they
+/// were posted unless the post queue fills up on the main thread, in which
+/// case the message is dispatched immediately.
+/// 
+/// @param queue Handle of the queue to post the message to
+/// @param msg Message to post
+/// @param data Data for message
+/// @see deliverPostedMessages()
+//////////////////////////////////////////////////////////////////////////
+extern void postMessage(QueueHandle queue, const char *msg, const char *data);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Deliver the messages posted with postMessage()
+/// 
+/// This is called once per frame by the game loop and must only be called
+/// from one thread. Messages posted by the listeners are delivered by the
+/// next call.
+/// 
+/// @return The number of messages delivered
+/// @see postMessage()
+//////////////////////////////////////////////////////////////////////////
+extern U32 deliverPostedMessages();
+
 // @}
 
 //////////////////////////////////////////////////////////////////////////
@@ -265,6 +388,11 @@ extern void unlockDispatcherMutex();
 //////////////////////////////////////////////////////////////////////////
 extern MessageQueue *getMessageQueue(const char *name);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Internal function: count the retired queues and listener lists not yet freed.
+//////////////////////////////////////////////////////////////////////////
+extern U32 getRetiredCount();
+
 // @}
 
 // @}
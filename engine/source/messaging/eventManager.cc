@@ -61,7 +61,7 @@ bool EventManagerListener::onMessageReceived( StringTableEntry queue, const char
 //-----------------------------------------------------------------------------
 // Constructor
 //-----------------------------------------------------------------------------
-EventManager::EventManager() : mQueue( NULL )
+EventManager::EventManager() : mQueue( NULL ), mQueueHandle( Dispatcher::InvalidQueueHandle )
 {
    addEventManager( this );
 }
@@ -97,12 +97,13 @@ void EventManager::setMessageQueue( const char* queue )
       unregisterAllEvents();
       Dispatcher::unregisterMessageListener( mQueue, &mListener );
       Dispatcher::unregisterMessageQueue( mQueue );
+      mQueueHandle = Dispatcher::InvalidQueueHandle;
    }
 
    // Register the new queue.
    if( queue && *queue )
    {
-      Dispatcher::registerMessageQueue( queue );
+      mQueueHandle = Dispatcher::registerMessageQueue( queue );
       Dispatcher::registerMessageListener( queue, &mListener );
       mQueue = StringTable->insert( queue );
    }
@@ -208,7 +209,7 @@ void EventManager::unregisterEvent( const char* event )
 //-----------------------------------------------------------------------------
 bool EventManager::postEvent( const char* event, const char* data )
 {
-   return Dispatcher::dispatchMessage( mQueue, event, data );
+   return Dispatcher::dispatchMessage( mQueueHandle, event, data );
 }
 
 //-----------------------------------------------------------------------------
@@ -92,6 +92,8 @@ class EventManager : public SimObject
 private:
    /// The name of the message queue.
    StringTableEntry mQueue;
+   /// The handle of the message queue.
+   Dispatcher::QueueHandle mQueueHandle;
    /// Registered events.
    Vector<StringTableEntry> mEvents;
 
@@ -38,6 +38,10 @@
 #include "console/consoleTypes.h"
 #endif
 
+#ifndef _COMPILED_SCRIPT_CACHE_H_
+#include "console/compiledScriptCache.h"
+#endif
+
 // Script bindings.
 #include "moduleManager_ScriptBinding.h"
 
@@ -419,6 +423,9 @@ bool ModuleManager::loadModuleGroup( const char* pModuleGroup )
         // Do we have a script file-path specified?
         if ( pLoadReadyModuleDefinition->getModuleScriptFilePath() != StringTable->EmptyString )
         {
+            // Compile any of the module's scripts that aren't in the compiled script cache.
+            CompiledScriptCache::prepare( pLoadReadyModuleDefinition->getModulePath() );
+
             // Yes, so execute the script file.
             const bool scriptFileExecuted = dAtob( Con::executef(2, "exec", pLoadReadyModuleDefinition->getModuleScriptFilePath() ) );
 
@@ -782,6 +789,9 @@ bool ModuleManager::loadModuleExplicit( const char* pModuleId, const U32 version
         // Do we have a script file-path specified?
         if ( pLoadReadyModuleDefinition->getModuleScriptFilePath() != StringTable->EmptyString )
         {
+            // Compile any of the module's scripts that aren't in the compiled script cache.
+            CompiledScriptCache::prepare( pLoadReadyModuleDefinition->getModulePath() );
+
             // Yes, so execute the script file.
             const bool scriptFileExecuted = dAtob( Con::executef(2, "exec", pLoadReadyModuleDefinition->getModuleScriptFilePath() ) );
 
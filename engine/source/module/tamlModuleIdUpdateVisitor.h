@@ -40,13 +40,16 @@
 class TamlModuleIdUpdateVisitor : public TamlXmlVisitor
 {
 protected:
-    virtual bool visit( TiXmlElement* pXmlElement, TamlXmlParser& xmlParser )
+    virtual bool visit( TamlXmlElement& xmlElement, TamlXmlParser& xmlParser )
     {
         // Iterate attributes.
-        for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+        for ( U32 index = 0; index < xmlElement.getAttributeCount(); ++index )
         {
+            // Fetch attribute.
+            TamlXmlAttribute& xmlAttribute = xmlElement.getAttribute( index );
+
             // Fetch attribute value.
-            const char* pAttributeValue = pAttribute->Value();
+            const char* pAttributeValue = xmlAttribute.getValue();
 
             // Fetch value length.
             const U32 valueLenth = dStrlen(pAttributeValue);
@@ -68,7 +71,7 @@ protected:
                         mModuleIdTo, pAttributeValue+1+mModuleIdLengthFrom );
 
                     // Assign new value.
-                    pAttribute->SetValue( newAttributeValueBuffer );
+                    xmlAttribute.setValue( newAttributeValueBuffer );
                 }
 
                 // Skip to next attribute.
@@ -83,14 +86,14 @@ protected:
                     mModuleIdTo, pAttributeValue+mModuleIdLengthFrom );
 
                 // Assign new value.
-                pAttribute->SetValue( newAttributeValueBuffer );
+                xmlAttribute.setValue( newAttributeValueBuffer );
             }
         }
 
         return true;
     }
 
-    virtual bool visit( TiXmlAttribute* pAttribute, TamlXmlParser& xmlParser ) { return true; }
+    virtual bool visit( TamlXmlAttribute& xmlAttribute, TamlXmlParser& xmlParser ) { return true; }
 
 public:
     TamlModuleIdUpdateVisitor() :
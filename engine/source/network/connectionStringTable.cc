@@ -85,6 +85,7 @@ IMPLEMENT_CO_NETEVENT_V1(NetStringEvent);
 ConnectionStringTable::ConnectionStringTable(NetConnection *parent)
 {
    mParent = parent;
+   mPendingCount = 0;
    for(U32 i = 0; i < EntryCount; i++)
    {
       mEntryTable[i].nextHash = NULL;
@@ -150,6 +151,7 @@ U32 ConnectionStringTable::checkString(NetStringHandle &string, bool *isOnOtherS
    mHashTable[hashIndex] = newEntry;
 
    mParent->postNetEvent(new NetStringEvent(newEntry->index, string));
+   mPendingCount++;
    if(isOnOtherSide)
       *isOnOtherSide = false;
    return newEntry->index;
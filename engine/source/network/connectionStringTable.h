@@ -54,6 +54,9 @@ private:
    /// Connection over which we are maintaining this string table.
    NetConnection *mParent;
 
+   /// Number of strings sent to the other side and not yet confirmed.
+   U32 mPendingCount;
+
    inline void pushBack(Entry *entry) // pushes an entry to the back of the LRU list
    {
       entry->prevLink->nextLink = entry->nextLink;
@@ -73,10 +76,15 @@ public:
    /// Has the specified string been received on the other side?
    inline void confirmStringReceived(NetStringHandle &string, U32 index)
    {
+      if(mPendingCount)
+         mPendingCount--;
       if(mEntryTable[index].string == string)
          mEntryTable[index].receiveConfirmed = true;
    }
 
+   /// Number of strings on their way to the other side.
+   inline U32 getPendingCount() { return mPendingCount; }
+
    U32 checkString(NetStringHandle &stringTableId, bool *stringOnOtherSide = NULL);  ///< Checks if the global string ID is
                                                                                   ///  currently valid for this connection
                                                                                   ///  and returns the table ID.
@@ -0,0 +1,613 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "network/ghostDelta.h"
+
+#ifndef _BITSTREAM_H_
+#include "io/bitStream.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+GhostDeltaSource::GhostDeltaSource( const U32 fieldCount ) :
+   mFieldCount( fieldCount )
+{
+   AssertFatal( fieldCount > 0 && fieldCount <= GhostDelta::MaxFields, "GhostDeltaSource() - Invalid field count." );
+}
+
+//-----------------------------------------------------------------------------
+
+U32 GhostDeltaSource::allocateSlot( StringTableEntry tag, const S32* pFields )
+{
+   U32 slot;
+
+   if ( mFreeSlots.size() > 0 )
+   {
+      slot = mFreeSlots.last();
+      mFreeSlots.pop_back();
+   }
+   else
+   {
+      slot = mSlots.size();
+      mSlots.increment();
+      mSlots.last().mGeneration = 0;
+      mSlots.last().mVersion = 0;
+   }
+
+   Slot& entry = mSlots[slot];
+   entry.mTag = tag;
+   entry.mGeneration++;
+   entry.mVersion++;
+   entry.mActive = true;
+   dMemcpy( entry.mFields, pFields, sizeof(S32) * mFieldCount );
+
+   return slot;
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaSource::freeSlot( const U32 slot )
+{
+   AssertFatal( slot < (U32)mSlots.size() && mSlots[slot].mActive, "GhostDeltaSource::freeSlot() - Slot is not in use." );
+
+   mSlots[slot].mActive = false;
+   mSlots[slot].mVersion++;
+   mFreeSlots.push_back( slot );
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaSource::clear( void )
+{
+   for ( U32 slot = 0; slot < (U32)mSlots.size(); ++slot )
+   {
+      if ( mSlots[slot].mActive )
+         freeSlot( slot );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+bool GhostDeltaSource::setFields( const U32 slot, const S32* pFields )
+{
+   AssertFatal( slot < (U32)mSlots.size() && mSlots[slot].mActive, "GhostDeltaSource::setFields() - Slot is not in use." );
+
+   Slot& entry = mSlots[slot];
+
+   if ( dMemcmp( entry.mFields, pFields, sizeof(S32) * mFieldCount ) == 0 )
+      return false;
+
+   dMemcpy( entry.mFields, pFields, sizeof(S32) * mFieldCount );
+   entry.mVersion++;
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+GhostDeltaChannel::GhostDeltaChannel( const GhostDeltaSource* pSource ) :
+   mpSource( pSource ),
+   mPacketHead( 0 ),
+   mRecordHead( 0 ),
+   mStalePackets( 0 ),
+   mSequence( 0 ),
+   mCursor( 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaChannel::reset( void )
+{
+   // Notifications for the packets still in flight are ignored when they arrive.
+   mStalePackets += getPacketsInFlight();
+
+   mSlots.clear();
+   mPackets.clear();
+   mRecords.clear();
+   mPacketHead = 0;
+   mRecordHead = 0;
+   mSequence = 0;
+   mCursor = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+U32 GhostDeltaChannel::getRequiredRecord( const U32 slot ) const
+{
+   const GhostDeltaSource::Slot& source = mpSource->getSlot( slot );
+   const SlotState& state = mSlots[slot];
+
+   // Slot free so make sure the client has nothing left in it.
+   if ( !source.mActive )
+   {
+      if ( state.mGeneration == 0 || (state.mLastKind == GhostDelta::RecordRemove && !state.mResend) )
+         return GhostDelta::RecordEnd;
+
+      return GhostDelta::RecordRemove;
+   }
+
+   // Creation not acknowledged so (re)send it unless the current one is in flight.
+   if ( state.mAckedGeneration != source.mGeneration )
+   {
+      if ( state.mGeneration == source.mGeneration &&
+           state.mLastKind == GhostDelta::RecordCreate &&
+           state.mSentVersion == source.mVersion &&
+           !state.mResend )
+         return GhostDelta::RecordEnd;
+
+      return GhostDelta::RecordCreate;
+   }
+
+   return ( state.mSentVersion != source.mVersion || state.mResend ) ? GhostDelta::RecordUpdate : GhostDelta::RecordEnd;
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaChannel::trackSourceSlots( void )
+{
+   const U32 slotCount = mpSource->getSlotCount();
+
+   // Track any slots the source has grown since.
+   if ( (U32)mSlots.size() < slotCount )
+   {
+      const U32 previousCount = mSlots.size();
+      mSlots.setSize( slotCount );
+      dMemset( mSlots.address() + previousCount, 0, sizeof(SlotState) * (slotCount - previousCount) );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaChannel::writeCreate( BitStream* stream, const GhostDeltaSource::Slot& source ) const
+{
+   stream->writeVarU32( source.mGeneration );
+   stream->writeString( source.mTag );
+
+   for ( U32 field = 0; field < mpSource->getFieldCount(); ++field )
+      stream->writeVarS32( source.mFields[field] );
+}
+
+//-----------------------------------------------------------------------------
+
+bool GhostDeltaChannel::writePacket( BitStream* stream )
+{
+   const U32 fieldCount = mpSource->getFieldCount();
+   const U32 slotCount = mpSource->getSlotCount();
+
+   trackSourceSlots();
+
+   const U32 sequence = ++mSequence;
+   stream->writeInt( S32(sequence & GhostDelta::SequenceMask), GhostDelta::SequenceBits );
+
+   PacketRecord packet;
+   packet.mSequence = sequence;
+   packet.mRecordCount = 0;
+
+   bool pending = false;
+   S32 previousSlot = -1;
+   U32 slot = mCursor < slotCount ? mCursor : 0;
+
+   for ( U32 visited = 0; visited < slotCount; ++visited, ++slot )
+   {
+      if ( slot == slotCount )
+         slot = 0;
+
+      const U32 kind = getRequiredRecord( slot );
+
+      if ( kind == GhostDelta::RecordEnd )
+         continue;
+
+      const GhostDeltaSource::Slot& source = mpSource->getSlot( slot );
+      SlotState& state = mSlots[slot];
+
+      // Write the record, rewinding if it doesn't fit.
+      const S32 mark = stream->getCurPos();
+
+      stream->writeInt( S32(kind), GhostDelta::RecordKindBits );
+      stream->writeVarS32( S32(slot) - previousSlot - 1 );
+
+      if ( kind == GhostDelta::RecordCreate )
+      {
+         writeCreate( stream, source );
+      }
+      else if ( kind == GhostDelta::RecordUpdate )
+      {
+         // Only use the baseline if the client is bound to still have it.
+         const bool useBaseline = state.mHasBaseline && state.mInFlight < GhostDelta::HistorySize;
+
+         stream->writeVarU32( useBaseline ? sequence - state.mBaselineSequence : 0 );
+
+         for ( U32 field = 0; field < fieldCount; ++field )
+         {
+            const S32 baseline = useBaseline ? state.mBaseline[field] : 0;
+
+            if ( stream->writeFlag( source.mFields[field] != baseline ) )
+               stream->writeVarS32( source.mFields[field] - baseline );
+         }
+      }
+
+      if ( stream->isFull() )
+      {
+         stream->setCurPos( mark );
+         mCursor = slot;
+         pending = true;
+         break;
+      }
+
+      previousSlot = S32(slot);
+
+      // Record what was sent.
+      mRecords.increment();
+      SentRecord& record = mRecords.last();
+      record.mSlot = slot;
+      record.mKind = kind;
+
+      if ( kind == GhostDelta::RecordRemove )
+      {
+         record.mGeneration = state.mGeneration;
+      }
+      else
+      {
+         record.mGeneration = source.mGeneration;
+         dMemcpy( record.mFields, source.mFields, sizeof(S32) * fieldCount );
+
+         if ( kind == GhostDelta::RecordCreate && state.mGeneration != source.mGeneration )
+         {
+            state.mGeneration = source.mGeneration;
+            state.mHasBaseline = false;
+         }
+      }
+
+      state.mSentVersion = source.mVersion;
+      state.mLastSendSequence = sequence;
+      state.mLastKind = kind;
+      state.mResend = false;
+      state.mInFlight++;
+      packet.mRecordCount++;
+   }
+
+   stream->writeInt( GhostDelta::RecordEnd, GhostDelta::RecordKindBits );
+
+   // Every packet is queued, even an empty one, to stay in step with the notifications.
+   mPackets.push_back( packet );
+
+   return pending;
+}
+
+//-----------------------------------------------------------------------------
+
+bool GhostDeltaChannel::writeSnapshot( BitStream* stream )
+{
+   // The client starts again from the snapshot.
+   reset();
+   trackSourceSlots();
+
+   const U32 fieldCount = mpSource->getFieldCount();
+   const U32 slotCount = mpSource->getSlotCount();
+
+   const U32 sequence = ++mSequence;
+   stream->writeInt( S32(sequence & GhostDelta::SequenceMask), GhostDelta::SequenceBits );
+
+   bool pending = false;
+   S32 previousSlot = -1;
+
+   for ( U32 slot = 0; slot < slotCount; ++slot )
+   {
+      const GhostDeltaSource::Slot& source = mpSource->getSlot( slot );
+
+      if ( !source.mActive )
+         continue;
+
+      // Write the record, rewinding if it doesn't fit.
+      const S32 mark = stream->getCurPos();
+
+      stream->writeInt( GhostDelta::RecordCreate, GhostDelta::RecordKindBits );
+      stream->writeVarS32( S32(slot) - previousSlot - 1 );
+      writeCreate( stream, source );
+
+      if ( stream->isFull() )
+      {
+         // The slots left out are still unknown to the client so the next packets create them.
+         stream->setCurPos( mark );
+         mCursor = slot;
+         pending = true;
+         break;
+      }
+
+      previousSlot = S32(slot);
+
+      // The client is bound to hold the snapshot before it reads anything newer.
+      SlotState& state = mSlots[slot];
+      state.mGeneration = source.mGeneration;
+      state.mAckedGeneration = source.mGeneration;
+      state.mSentVersion = source.mVersion;
+      state.mLastSendSequence = sequence;
+      state.mBaselineSequence = sequence;
+      state.mLastKind = GhostDelta::RecordCreate;
+      state.mHasBaseline = true;
+      dMemcpy( state.mBaseline, source.mFields, sizeof(S32) * fieldCount );
+   }
+
+   stream->writeInt( GhostDelta::RecordEnd, GhostDelta::RecordKindBits );
+
+   return pending;
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaChannel::packetNotify( const bool delivered )
+{
+   // Packets written before a reset are no longer tracked.
+   if ( mStalePackets > 0 )
+   {
+      mStalePackets--;
+      return;
+   }
+
+   AssertFatal( mPacketHead < (U32)mPackets.size(), "GhostDeltaChannel::packetNotify() - No packet in flight." );
+   if ( mPacketHead == (U32)mPackets.size() )
+      return;
+
+   const U32 fieldCount = mpSource->getFieldCount();
+   const PacketRecord& packet = mPackets[mPacketHead++];
+
+   for ( U32 index = 0; index < packet.mRecordCount; ++index )
+   {
+      const SentRecord& record = mRecords[mRecordHead++];
+      SlotState& state = mSlots[record.mSlot];
+
+      state.mInFlight--;
+
+      if ( !delivered )
+      {
+         // Only the most recent send matters; anything newer already carries fresher state.
+         if ( state.mLastSendSequence == packet.mSequence )
+            state.mResend = true;
+
+         continue;
+      }
+
+      switch( record.mKind )
+      {
+      case GhostDelta::RecordCreate:
+         if ( record.mGeneration != state.mGeneration )
+            break;
+
+         state.mAckedGeneration = record.mGeneration;
+         // Fall through, the created state is the first baseline.
+
+      case GhostDelta::RecordUpdate:
+         if ( record.mGeneration != state.mAckedGeneration )
+            break;
+
+         dMemcpy( state.mBaseline, record.mFields, sizeof(S32) * fieldCount );
+         state.mBaselineSequence = packet.mSequence;
+         state.mHasBaseline = true;
+         break;
+
+      case GhostDelta::RecordRemove:
+         if ( record.mGeneration != state.mGeneration )
+            break;
+
+         state.mGeneration = 0;
+         state.mAckedGeneration = 0;
+         state.mHasBaseline = false;
+         break;
+      }
+   }
+
+   compactQueues();
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaChannel::compactQueues( void )
+{
+   // Nothing in flight so simply start again.
+   if ( mPacketHead == (U32)mPackets.size() )
+   {
+      mPackets.clear();
+      mRecords.clear();
+      mPacketHead = 0;
+      mRecordHead = 0;
+      return;
+   }
+
+   // Otherwise shuffle down once the consumed part dominates.
+   if ( mPacketHead < 64 || mPacketHead * 2 < (U32)mPackets.size() )
+      return;
+
+   const U32 packetCount = mPackets.size() - mPacketHead;
+   dMemmove( mPackets.address(), mPackets.address() + mPacketHead, sizeof(PacketRecord) * packetCount );
+   mPackets.setSize( packetCount );
+   mPacketHead = 0;
+
+   const U32 recordCount = mRecords.size() - mRecordHead;
+   dMemmove( mRecords.address(), mRecords.address() + mRecordHead, sizeof(SentRecord) * recordCount );
+   mRecords.setSize( recordCount );
+   mRecordHead = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+GhostDeltaReceiver::GhostDeltaReceiver( const U32 fieldCount ) :
+   mFieldCount( fieldCount ),
+   mSequence( 0 )
+{
+   AssertFatal( fieldCount > 0 && fieldCount <= GhostDelta::MaxFields, "GhostDeltaReceiver() - Invalid field count." );
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaReceiver::reset( GhostDeltaListener* pListener )
+{
+   for ( U32 slot = 0; slot < (U32)mSlots.size(); ++slot )
+   {
+      if ( mSlots[slot].mActive && pListener != NULL )
+         pListener->onDeltaRemove( slot );
+   }
+
+   mSlots.clear();
+   mSequence = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostDeltaReceiver::pushHistory( Slot& slot, const S32* pFields )
+{
+   const U32 index = slot.mHistoryCount++ % GhostDelta::HistorySize;
+
+   slot.mSequence[index] = mSequence;
+   dMemcpy( slot.mFields[index], pFields, sizeof(S32) * mFieldCount );
+   slot.mLatest = index;
+}
+
+//-----------------------------------------------------------------------------
+
+bool GhostDeltaReceiver::readPacket( BitStream* stream, GhostDeltaListener* pListener )
+{
+   // Expand the sequence; the gap between updates is always far smaller than its range.
+   const U32 sequence = U32(stream->readInt( GhostDelta::SequenceBits ));
+   mSequence += (sequence - mSequence) & GhostDelta::SequenceMask;
+
+   S32 previousSlot = -1;
+   S32 fields[GhostDelta::MaxFields];
+
+   while( true )
+   {
+      const U32 kind = U32(stream->readInt( GhostDelta::RecordKindBits ));
+
+      if ( kind == GhostDelta::RecordEnd )
+         break;
+
+      const S32 slotIndex = previousSlot + 1 + stream->readVarS32();
+
+      if ( !stream->isValid() || slotIndex < 0 || slotIndex >= GhostDelta::MaxSlots )
+      {
+         Con::errorf( "GhostDeltaReceiver::readPacket() - Invalid slot %d.", slotIndex );
+         return false;
+      }
+
+      previousSlot = slotIndex;
+
+      if ( slotIndex >= mSlots.size() )
+      {
+         const U32 previousCount = mSlots.size();
+         mSlots.setSize( slotIndex + 1 );
+         dMemset( mSlots.address() + previousCount, 0, sizeof(Slot) * (mSlots.size() - previousCount) );
+      }
+
+      Slot& slot = mSlots[slotIndex];
+
+      if ( kind == GhostDelta::RecordCreate )
+      {
+         const U32 generation = stream->readVarU32();
+
+         char tag[256];
+         stream->readString( tag );
+
+         for ( U32 field = 0; field < mFieldCount; ++field )
+            fields[field] = stream->readVarS32();
+
+         // A resend of a creation we already have is just new state.
+         if ( slot.mActive && slot.mGeneration == generation )
+         {
+            pushHistory( slot, fields );
+
+            if ( pListener != NULL )
+               pListener->onDeltaUpdate( slotIndex, fields );
+
+            continue;
+         }
+
+         if ( slot.mActive && pListener != NULL )
+            pListener->onDeltaRemove( slotIndex );
+
+         slot.mActive = true;
+         slot.mGeneration = generation;
+         slot.mTag = StringTable->insert( tag );
+         slot.mHistoryCount = 0;
+         pushHistory( slot, fields );
+
+         if ( pListener != NULL )
+            pListener->onDeltaCreate( slotIndex, slot.mTag, fields );
+      }
+      else if ( kind == GhostDelta::RecordUpdate )
+      {
+         const U32 age = stream->readVarU32();
+
+         // Find the baseline.
+         const S32* pBaseline = NULL;
+
+         if ( age != 0 && slot.mActive )
+         {
+            const U32 baselineSequence = mSequence - age;
+            const U32 historyCount = getMin( slot.mHistoryCount, (U32)GhostDelta::HistorySize );
+
+            for ( U32 index = 0; index < historyCount; ++index )
+            {
+               if ( slot.mSequence[index] == baselineSequence )
+               {
+                  pBaseline = slot.mFields[index];
+                  break;
+               }
+            }
+         }
+
+         for ( U32 field = 0; field < mFieldCount; ++field )
+         {
+            const S32 baseline = pBaseline != NULL ? pBaseline[field] : 0;
+            fields[field] = stream->readFlag() ? baseline + stream->readVarS32() : baseline;
+         }
+
+         // The stream stays in step but the values are meaningless without the baseline.
+         if ( !slot.mActive || (age != 0 && pBaseline == NULL) )
+         {
+            Con::warnf( "GhostDeltaReceiver::readPacket() - Missing baseline for slot %d.", slotIndex );
+            continue;
+         }
+
+         pushHistory( slot, fields );
+
+         if ( pListener != NULL )
+            pListener->onDeltaUpdate( slotIndex, fields );
+      }
+      else
+      {
+         if ( !slot.mActive )
+            continue;
+
+         slot.mActive = false;
+
+         if ( pListener != NULL )
+            pListener->onDeltaRemove( slotIndex );
+      }
+   }
+
+   return stream->isValid();
+}
@@ -0,0 +1,266 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _GHOSTDELTA_H_
+#define _GHOSTDELTA_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+#ifndef _STRINGTABLE_H_
+#include "string/stringTable.h"
+#endif
+#ifndef _MMATHFN_H_
+#include "math/mMathFn.h"
+#endif
+
+class BitStream;
+
+//-----------------------------------------------------------------------------
+/// @defgroup ghostDelta Delta Compressed Ghost Records
+///
+/// Replicates a table of quantised records through a single ghost.
+///
+/// A GhostDeltaSource holds the authoritative state of a set of slots on the
+/// server.  Each slot is a short, fixed list of integer fields which the owner
+/// has already quantised.  Every connection owns a GhostDeltaChannel which writes
+/// the slots that changed into its ghost updates, delta encoding each one against
+/// the last state the client acknowledged and only sending the fields that differ
+/// from it.  On the client a GhostDeltaReceiver keeps a short history of received
+/// states per slot so that any baseline the server may still pick can be found.
+///
+/// Packet notifications (see NetObject::onGhostUpdateNotify()) drive the channel.
+/// A delivered packet promotes the states it carried to acknowledged baselines
+/// and a dropped packet marks the slots it carried for resending, with whatever
+/// their state is by then.
+///
+/// @{
+
+namespace GhostDelta
+{
+   enum Constants
+   {
+      MaxFields      = 8,        ///< Maximum number of fields in a record.
+      HistorySize    = 4,        ///< Received states remembered per slot by the receiver.
+      MaxSlots       = 1 << 20,  ///< Upper bound on the slot index accepted from the wire.
+      SequenceBits   = 16,       ///< Bits used to send the packet sequence.
+      SequenceMask   = (1 << SequenceBits) - 1,
+      RecordKindBits = 2,        ///< Bits used to send a record kind.
+   };
+
+   /// Record kinds on the wire.
+   enum RecordKind
+   {
+      RecordEnd      = 0,        ///< No more records in this update.
+      RecordUpdate   = 1,        ///< Field changes against a baseline, or absolute values.
+      RecordCreate   = 2,        ///< A new slot generation with its type tag and absolute values.
+      RecordRemove   = 3,        ///< The slot is no longer in use.
+   };
+
+   /// Quantise a value to the nearest multiple of the quantum.
+   inline S32 quantize( const F32 value, const F32 quantum )
+   {
+      return (S32)mFloor( mClampF( value / quantum, -1.0e9f, 1.0e9f ) + 0.5f );
+   }
+
+   /// Expand a quantised value.
+   inline F32 dequantize( const S32 value, const F32 quantum )
+   {
+      return F32(value) * quantum;
+   }
+}
+
+//-----------------------------------------------------------------------------
+/// Authoritative, quantised slot state on the server.
+class GhostDeltaSource
+{
+public:
+   struct Slot
+   {
+      StringTableEntry mTag;                          ///< Type tag sent when the slot is created on a client.
+      U32              mGeneration;                   ///< Incremented each time the slot is allocated.
+      U32              mVersion;                      ///< Incremented each time the fields change.
+      bool             mActive;                       ///< Is the slot in use?
+      S32              mFields[GhostDelta::MaxFields];
+   };
+
+   GhostDeltaSource( const U32 fieldCount );
+
+   /// Allocate a slot, reusing a free one if possible.
+   U32 allocateSlot( StringTableEntry tag, const S32* pFields );
+
+   /// Release a slot.  Connections remove it from their clients.
+   void freeSlot( const U32 slot );
+
+   /// Free every slot.
+   void clear( void );
+
+   /// Set the fields of a slot.  Returns true if any of them changed.
+   bool setFields( const U32 slot, const S32* pFields );
+
+   inline U32 getFieldCount( void ) const                { return mFieldCount; }
+   inline U32 getSlotCount( void ) const                 { return mSlots.size(); }
+   inline U32 getActiveSlotCount( void ) const           { return mSlots.size() - mFreeSlots.size(); }
+   inline const Slot& getSlot( const U32 slot ) const    { return mSlots[slot]; }
+
+private:
+   U32          mFieldCount;
+   Vector<Slot> mSlots;
+   Vector<U32>  mFreeSlots;
+};
+
+//-----------------------------------------------------------------------------
+/// Per connection delta encoder for a GhostDeltaSource.
+///
+/// Every call to writePacket() must be matched, in order, by exactly one call to
+/// packetNotify() once the fate of that packet is known.  Snapshots written by
+/// writeSnapshot() are not notified.
+class GhostDeltaChannel
+{
+public:
+   GhostDeltaChannel( const GhostDeltaSource* pSource );
+
+   /// Forget everything the client knows, e.g. when the owning object is ghosted afresh.
+   void reset( void );
+
+   /// Write the slots that need sending until the stream is full.
+   ///
+   /// @returns True if some slots did not fit and another update is needed.
+   bool writePacket( BitStream* stream );
+
+   /// Start the client afresh with every active slot, for a stream that is bound to arrive
+   /// before any packet written afterwards, e.g. a guaranteed event.  No notification follows
+   /// so the slots written become the acknowledged baselines straight away.
+   ///
+   /// @returns True if some slots did not fit and an update is needed to create them.
+   bool writeSnapshot( BitStream* stream );
+
+   /// Notification for the oldest packet still in flight.
+   void packetNotify( const bool delivered );
+
+   /// Number of packets written and not yet notified.
+   inline U32 getPacketsInFlight( void ) const           { return mPackets.size() - mPacketHead; }
+
+private:
+   /// What the channel believes the client holds for a slot.
+   struct SlotState
+   {
+      U32  mGeneration;                               ///< Generation last created on the client (0 = none).
+      U32  mAckedGeneration;                          ///< Generation whose creation was acknowledged.
+      U32  mSentVersion;                              ///< Source version carried by the most recent send.
+      U32  mLastSendSequence;                         ///< Packet sequence of the most recent send.
+      U32  mBaselineSequence;                         ///< Packet sequence of the acknowledged baseline.
+      U32  mInFlight;                                 ///< Sends for this slot not yet notified.
+      U32  mLastKind;                                 ///< Record kind of the most recent send.
+      bool mResend;                                   ///< The most recent send was dropped.
+      bool mHasBaseline;                              ///< mBaseline holds acknowledged fields.
+      S32  mBaseline[GhostDelta::MaxFields];
+   };
+
+   /// A record written into a packet that is still in flight.
+   struct SentRecord
+   {
+      U32 mSlot;
+      U32 mKind;
+      U32 mGeneration;
+      S32 mFields[GhostDelta::MaxFields];
+   };
+
+   struct PacketRecord
+   {
+      U32 mSequence;
+      U32 mRecordCount;
+   };
+
+   U32 getRequiredRecord( const U32 slot ) const;
+   void trackSourceSlots( void );
+   void writeCreate( BitStream* stream, const GhostDeltaSource::Slot& source ) const;
+   void compactQueues( void );
+
+   const GhostDeltaSource* mpSource;
+   Vector<SlotState>       mSlots;
+   Vector<PacketRecord>    mPackets;
+   Vector<SentRecord>      mRecords;
+   U32                     mPacketHead;
+   U32                     mRecordHead;
+   U32                     mStalePackets;
+   U32                     mSequence;
+   U32                     mCursor;
+};
+
+//-----------------------------------------------------------------------------
+/// Receives the records decoded by a GhostDeltaReceiver.
+class GhostDeltaListener
+{
+public:
+   virtual ~GhostDeltaListener() {}
+
+   virtual void onDeltaCreate( const U32 slot, StringTableEntry tag, const S32* pFields ) = 0;
+   virtual void onDeltaUpdate( const U32 slot, const S32* pFields ) = 0;
+   virtual void onDeltaRemove( const U32 slot ) = 0;
+};
+
+//-----------------------------------------------------------------------------
+/// Client side decoder for the updates written by a GhostDeltaChannel.
+class GhostDeltaReceiver
+{
+public:
+   GhostDeltaReceiver( const U32 fieldCount );
+
+   /// Remove every active slot, notifying the listener (if any).
+   void reset( GhostDeltaListener* pListener );
+
+   /// Read one update written by GhostDeltaChannel::writePacket().
+   ///
+   /// @returns False if the update was malformed.
+   bool readPacket( BitStream* stream, GhostDeltaListener* pListener );
+
+   inline U32 getSlotCount( void ) const                 { return mSlots.size(); }
+   inline bool isActive( const U32 slot ) const          { return slot < (U32)mSlots.size() && mSlots[slot].mActive; }
+   inline const S32* getFields( const U32 slot ) const   { return mSlots[slot].mFields[mSlots[slot].mLatest]; }
+
+private:
+   struct Slot
+   {
+      bool             mActive;
+      U32              mGeneration;
+      StringTableEntry mTag;
+      U32              mHistoryCount;
+      U32              mLatest;
+      U32              mSequence[GhostDelta::HistorySize];
+      S32              mFields[GhostDelta::HistorySize][GhostDelta::MaxFields];
+   };
+
+   void pushHistory( Slot& slot, const S32* pFields );
+
+   U32          mFieldCount;
+   U32          mSequence;
+   Vector<Slot> mSlots;
+};
+
+/// @}
+
+#endif // _GHOSTDELTA_H_
@@ -158,12 +158,20 @@ static U32 gPacketRateToServer = 32;
 static U32 gPacketUpdateDelayToServer = 32;
 static U32 gPacketRateToClient = 10;
 static U32 gPacketSize = 200;
+static bool gAdaptiveRate = true;
+static F32 gEventWeight = 1.0f;
+static F32 gGhostWeight = 1.0f;
+static F32 gStringWeight = 2.0f;
 
 void NetConnection::consoleInit()
 {
    Con::addVariable("pref::Net::PacketRateToServer",  TypeS32, &gPacketRateToServer);
    Con::addVariable("pref::Net::PacketRateToClient",  TypeS32, &gPacketRateToClient);
    Con::addVariable("pref::Net::PacketSize",          TypeS32, &gPacketSize);
+   Con::addVariable("pref::Net::AdaptiveRate",        TypeBool, &gAdaptiveRate);
+   Con::addVariable("pref::Net::EventWeight",         TypeF32, &gEventWeight);
+   Con::addVariable("pref::Net::GhostWeight",         TypeF32, &gGhostWeight);
+   Con::addVariable("pref::Net::StringWeight",        TypeF32, &gStringWeight);
    Con::addVariable("Stats::netBitsSent",       TypeS32, &gNetBitsSent);
    Con::addVariable("Stats::netBitsReceived",   TypeS32, &gNetBitsReceived);
    Con::addVariable("Stats::netGhostUpdates",   TypeS32, &gGhostUpdates);
@@ -280,6 +288,7 @@ NetConnection::NetConnection()
    mGhostingSequence = 0;
    mGhosting = false;
    mScoping = false;
+   mWritingGhostUpdates = false;
    mGhostArray = NULL;
    mGhostRefs = NULL;
    mGhostLookupTable = NULL;
@@ -393,6 +402,13 @@ ConsoleMethod( NetConnection, getPacketLoss, S32, 2, 2, "() Use the getPacketLos
    return( S32( 100 * object->getPacketLoss() ) );
 }
 
+ConsoleMethod( NetConnection, getRateScale, F32, 2, 2, "() Use the getRateScale method to find how much of the negotiated packet rate congestion control currently allows.\n"
+                                                                "@return Returns a value between 0.0 and 1.0, the fraction of the negotiated rate in use.\n"
+                                                                "@sa getPing, getPacketLoss")
+{
+   return object->getRateScale();
+}
+
 ConsoleMethod( NetConnection, checkMaxRate, void, 2, 2, "() Use the checkMaxRate method to retrieve the current maximum packet rate for this connection.\n"
                                                                 "The period may not neccesarily be one second. To adjust packet rates, see the preference variables above\n"
                                                                 "@return Returns an integer value representing the maximum number of packets that can be transmitted by this connection per transmission period.")
@@ -480,15 +496,20 @@ void NetConnection::handleNotify(bool recvd)
    if(note->maxRateChanged && !recvd)
       mMaxRate.changed = true;
 
+   U32 curTime = Platform::getVirtualMilliseconds();
    if(recvd) 
    {
       // Running average of roundTrip time
-      U32 curTime = Platform::getVirtualMilliseconds();
       mRoundTripTime = (mRoundTripTime + (curTime - note->sendTime)) * 0.5f;
+      mRateControl.packetDelivered(note->sendTime, curTime);
       packetReceived(note);
    }
    else
+   {
+      mRateControl.packetDropped(note->sendTime, curTime);
       packetDropped(note);
+   }
+   mPacketLoss = mRateControl.getPacketLoss();
 
    delete note;
 }
@@ -571,6 +592,16 @@ void NetConnection::checkPacketSend(bool force)
 {
    U32 curTime = Platform::getVirtualMilliseconds();
    U32 delay = isConnectionToServer() ? gPacketUpdateDelayToServer : mCurRate.updateDelay;
+   U32 packetSize = mCurRate.packetSize;
+
+   // Scale the negotiated rate down to what the path is carrying.  Our acks
+   // ride on the other side's packets, so allow for its send delay; a client
+   // sends at no less than 8 packets per second (see checkMaxRate).
+   if(gAdaptiveRate && isNetworkConnection())
+   {
+      mRateControl.setAckDelay(isConnectionToServer() ? mCurRate.updateDelay : 1024 / 8);
+      mRateControl.adjustSend(delay, packetSize);
+   }
 
    if(!force)
    {
@@ -587,7 +618,7 @@ void NetConnection::checkPacketSend(bool force)
    if(windowFull())
       return;
 
-   BitStream *stream = BitStream::getPacketStream(mCurRate.packetSize);
+   BitStream *stream = BitStream::getPacketStream(packetSize);
    buildSendPacketHeader(stream);
 
    mLastUpdateTime = curTime;
@@ -670,7 +701,22 @@ void NetConnection::readPacket(BitStream *bstream)
 
 void NetConnection::writePacket(BitStream *bstream, PacketNotify *note)
 {
+   // While ghosts are waiting, events only fill their weighted share of the
+   // packet and the ghosts get the rest.  String table entries travel as
+   // events, so pending ones add their weight to the event share.
+   const U32 packetSize = bstream->getStreamSize();
+   const U32 usedSize = bstream->getPosition();
+   if(isGhostingFrom() && mGhosting && mGhostZeroUpdateIndex > 0 && packetSize > usedSize)
+   {
+      F32 eventWeight = getMax(gEventWeight, 0.0f);
+      if(mStringTable && mStringTable->getPendingCount())
+         eventWeight += getMax(gStringWeight, 0.0f);
+      const F32 totalWeight = eventWeight + getMax(gGhostWeight, 0.0f);
+      if(totalWeight > 0)
+         bstream->setWriteSize(usedSize + U32((packetSize - usedSize) * eventWeight / totalWeight));
+   }
    eventWritePacket(bstream, note);
+   bstream->setWriteSize(packetSize);
    ghostWritePacket(bstream, note);
 }
 
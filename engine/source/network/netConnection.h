@@ -42,6 +42,10 @@
 #ifndef _H_CONNECTIONSTRINGTABLE
 #include "network/connectionStringTable.h"
 #endif
+
+#ifndef _NETRATECONTROL_H_
+#include "network/netRateControl.h"
+#endif
 //----------------------------------------------------------------------------
 // the sim connection encapsulates the packet stream,
 // ghost manager, event manager and playerPSC of the old tribes net code
@@ -484,6 +488,9 @@ private:
     U32 mSimulatedPing;
     F32 mSimulatedPacketLoss;
 
+    /// Congestion control, scaling mCurRate to what the path can carry.
+    NetRateControl mRateControl;
+
     /// @}
 
     /// @name State
@@ -586,6 +593,7 @@ public:
     U32 getProtocolVersion()                     { return mProtocolVersion; }
     F32 getRoundTripTime()                       { return mRoundTripTime; }
     F32 getPacketLoss()                          { return( mPacketLoss ); }
+    F32 getRateScale()                           { return mRateControl.getRateScale(); }
 
     static char mErrorBuffer[256];
     static void setLastError(const char *fmt,...);
@@ -770,6 +778,7 @@ protected:
 
     bool mGhosting;             ///< Am I currently ghosting objects?
     bool mScoping;              ///< am I currently scoping objects?
+    bool mWritingGhostUpdates;  ///< Am I packing object updates into a ghost packet?
     U32  mGhostingSequence;     ///< Sequence number describing this ghosting session.
 
     NetObject **mLocalGhosts;  ///< Local ghost for remote object.
@@ -879,6 +888,12 @@ public:
     /// Are we ghosting?
     bool isGhosting() { return mGhosting; }
 
+    /// Are object updates currently being packed into a ghost packet?
+    ///
+    /// Only updates packed while this is true are followed by NetObject::onGhostUpdateNotify().
+    /// Updates packed elsewhere, such as the event that delivers a ScopeAlways object, are not.
+    bool isWritingGhostUpdates() { return mWritingGhostUpdates; }
+
     /// Begin to stop ghosting an object.
     void detachObject(GhostInfo *info);
 
@@ -221,6 +221,10 @@ void NetConnection::ghostPacketDropped(PacketNotify *notify)
          packRef->ghost->flags &= ~GhostInfo::KillingGhost;
       }
 
+      // let the object know the update it packed was lost
+      if(!(packRef->ghostInfoFlags & GhostInfo::KillingGhost) && packRef->ghost->obj)
+         packRef->ghost->obj->onGhostUpdateNotify(this, false);
+
       delete packRef;
       packRef = temp;
    }
@@ -247,6 +251,11 @@ void NetConnection::ghostPacketReceived(PacketNotify *notify)
 
       *walk = 0;
 
+      // let the object know the update it packed arrived
+
+      if(!(packRef->ghostInfoFlags & GhostInfo::KillingGhost) && packRef->ghost->obj)
+         packRef->ghost->obj->onGhostUpdateNotify(this, true);
+
       // if this object was ghosting , it is now ghosted
 
       if(packRef->ghostInfoFlags & GhostInfo::Ghosting)
@@ -379,6 +388,7 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
    bstream->writeInt(sendSize - 3, GhostIndexBitSize);
 
    U32 count = 0;
+   mWritingGhostUpdates = true;
    //
    for(i = mGhostZeroUpdateIndex - 1; i >= 0 && !bstream->isFull(); i--)
    {
@@ -453,6 +463,7 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
       walk->updateSkipCount = 0;
       count++;
    }
+   mWritingGhostUpdates = false;
    //Con::printf("Ghosts updated: %d (%d remain)", count, mGhostZeroUpdateIndex);
    // no more objects...
    bstream->writeFlag(false);
@@ -81,7 +81,28 @@ NetConnection *NetInterface::findPendingConnection(const NetAddress *address, U3
 
 void NetInterface::processPacketReceiveEvent(PacketReceiveEvent *prEvent)
 {
+   // Packets pass through the simulator first when it is on.
+   if(mSimulator.isEnabled())
+   {
+      mSimulator.send(*prEvent, Platform::getVirtualMilliseconds());
+      return;
+   }
+   dispatchPacket(prEvent);
+}
+
+void NetInterface::processSimulation()
+{
+   if(!mSimulator.getPendingCount())
+      return;
 
+   static PacketReceiveEvent packet;
+   U32 time = Platform::getVirtualMilliseconds();
+   while(mSimulator.receive(time, packet))
+      dispatchPacket(&packet);
+}
+
+void NetInterface::dispatchPacket(PacketReceiveEvent *prEvent)
+{
    U32 dataSize = prEvent->size - PacketReceiveEventHeaderSize;
    BitStream pStream(prEvent->data, dataSize);
 
@@ -637,5 +658,31 @@ ConsoleFunction(allowConnections,void,2,2,"( enable ) Use the allowConnections t
    GNet->setAllowsConnections(dAtob(argv[1]));
 }
 
+ConsoleFunction(setNetSimulation,void,1,7,"( [latency], [jitter], [packetLoss], [reorder], [bandwidth], [queueLimit] ) Use the setNetSimulation function to simulate a poor network link for every packet this game receives. Call it with no arguments to turn the simulation off.\n"
+                                                                "@param latency Fixed delay added to each packet, in milliseconds.\n"
+                                                                "@param jitter Random extra delay of up to this many milliseconds.\n"
+                                                                "@param packetLoss Fraction of packets to drop, between 0.0 and 1.0.\n"
+                                                                "@param reorder Fraction of packets to hold back so that later packets overtake them, between 0.0 and 1.0.\n"
+                                                                "@param bandwidth Link capacity in bytes per second, or 0 for unlimited.\n"
+                                                                "@param queueLimit Longest a packet may queue for the link before it is dropped, in milliseconds.\n"
+                                                                "@return No return value\n"
+                                                                "@sa NetConnection::setSimulatedNetParams")
+{
+   NetSimulator::Conditions conditions;
+   if(argc > 1)
+      conditions.latency = getMax(dAtoi(argv[1]), 0);
+   if(argc > 2)
+      conditions.jitter = getMax(dAtoi(argv[2]), 0);
+   if(argc > 3)
+      conditions.packetLoss = dAtof(argv[3]);
+   if(argc > 4)
+      conditions.reorder = dAtof(argv[4]);
+   if(argc > 5)
+      conditions.bandwidth = getMax(dAtoi(argv[5]), 0);
+   if(argc > 6)
+      conditions.queueLimit = getMax(dAtoi(argv[6]), 0);
+   GNet->setSimulatedConditions(conditions);
+}
+
 ConsoleFunctionGroupEnd(NetInterface);
 
@@ -23,6 +23,10 @@
 #ifndef _H_NETINTERFACE
 #define _H_NETINTERFACE
 
+#ifndef _NETSIMULATOR_H_
+#include "network/netSimulator.h"
+#endif
+
 /// NetInterface class.  Manages all valid and pending notify protocol connections.
 ///
 /// @see NetConnection, GameConnection, NetObject, NetEvent
@@ -62,6 +66,7 @@ protected:
    U32                     mRandomHashData[12];    ///< Data that gets hashed with connect challenge requests to prevent connection spoofing.
    bool                    mRandomDataInitialized; ///< Have we initialized our random number generator?
    bool                    mAllowConnections;      ///< Is this NetInterface allowing connections at this time?
+   NetSimulator            mSimulator;             ///< Simulated network conditions applied to received packets.
 
    enum NetInterfaceConstants
    {
@@ -103,6 +108,9 @@ protected:
 
    /// @}
 
+   /// Handles a received packet once it has cleared the network simulator.
+   void dispatchPacket(PacketReceiveEvent *event);
+
    /// Calculate an MD5 sum representing a connection, and store it into addressDigest.
    void computeNetMD5(const NetAddress *address, U32 connectSequence, U32 addressDigest[4]);
 
@@ -118,6 +126,14 @@ public:
    /// Dispatch function for processing all network packets through this NetInterface.
    virtual void processPacketReceiveEvent(PacketReceiveEvent *event);
 
+   /// Sets the simulated network conditions applied to every packet received.
+   /// Set them on both ends to affect both directions.
+   void setSimulatedConditions(const NetSimulator::Conditions &conditions) { mSimulator.setConditions(conditions); }
+   NetSimulator &getSimulator() { return mSimulator; }
+
+   /// Dispatches received packets the network simulator has finished delaying.
+   void processSimulation();
+
    /// Handles all packets that don't fall into the category of connection handshake or game data.
    virtual void handleInfoPacket(const NetAddress *address, U8 packetType, BitStream *stream);
 
@@ -249,6 +249,10 @@ void NetObject::unpackUpdate(NetConnection*, BitStream*)
 {
 }
 
+void NetObject::onGhostUpdateNotify(NetConnection*, bool)
+{
+}
+
 void NetObject::onCameraScopeQuery(NetConnection *cr, CameraScopeQuery* /*camInfo*/)
 {
    // default behavior -
@@ -351,6 +351,20 @@ public:
    /// @param   stream  stream to read from
    virtual void unpackUpdate(NetConnection * conn, BitStream *stream);
 
+   /// Called on the server once the fate of an update written by packUpdate is known.
+   ///
+   /// Notifications for a connection arrive in the same order the updates were packed,
+   /// so an object that delta encodes against previously acknowledged state can keep a
+   /// queue of the updates it has in flight and pop one per notification.  Updates that
+   /// are dropped have their mask bits re-flagged by the ghost manager as usual.
+   ///
+   /// Only updates packed into ghost packets are notified (see NetConnection::isWritingGhostUpdates()).
+   /// The initial update of a ScopeAlways object travels in a guaranteed event and is not.
+   ///
+   /// @param   conn       Net connection the update was sent over
+   /// @param   delivered  True if the packet holding the update arrived, false if it was dropped
+   virtual void onGhostUpdateNotify(NetConnection * conn, bool delivered);
+
    /// Queries the object about information used to determine scope.
    ///
    /// Something that is 'in scope' is somehow interesting to the client.
@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "network/netRateControl.h"
+
+#ifndef _MMATHFN_H_
+#include "math/mMathFn.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+const F32 NetRateControl::MinRateScale = 0.05f;
+const F32 NetRateControl::IncreaseStep = 0.05f;
+const F32 NetRateControl::BackoffScale = 0.7f;
+const F32 NetRateControl::DelayFactor = 1.25f;
+
+// Weight given to each new sample in the smoothed statistics.
+static const F32 sRoundTripGain = 0.125f;
+static const F32 sVarianceGain = 0.25f;
+static const F32 sLossGain = 1.0f / 32.0f;
+
+// How fast the lowest round trip time creeps back up so a route change that
+// lengthens the path is eventually accepted, in milliseconds per sample.
+static const F32 sMinRoundTripDrift = 0.05f;
+
+//-----------------------------------------------------------------------------
+
+NetRateControl::NetRateControl()
+{
+   mAckDelay = 0;
+   reset();
+}
+
+//-----------------------------------------------------------------------------
+
+void NetRateControl::reset( void )
+{
+   mRateScale = 1.0f;
+   mRoundTripTime = 0.0f;
+   mRoundTripVariance = 0.0f;
+   mMinRoundTripTime = 0.0f;
+   mPacketLoss = 0.0f;
+   mLastBackoffTime = 0;
+   mLastIncreaseTime = 0;
+   mHaveSample = false;
+}
+
+//-----------------------------------------------------------------------------
+
+void NetRateControl::packetDelivered( const U32 sendTime, const U32 time )
+{
+   const F32 sample = F32( time - sendTime );
+
+   if ( !mHaveSample )
+   {
+      mRoundTripTime = sample;
+      mRoundTripVariance = sample * 0.5f;
+      mMinRoundTripTime = sample;
+      mHaveSample = true;
+   }
+   else
+   {
+      mRoundTripVariance += sVarianceGain * ( mFabs( sample - mRoundTripTime ) - mRoundTripVariance );
+      mRoundTripTime += sRoundTripGain * ( sample - mRoundTripTime );
+      mMinRoundTripTime = getMin( mMinRoundTripTime + sMinRoundTripDrift, sample );
+   }
+
+   mPacketLoss -= sLossGain * mPacketLoss;
+
+   // Queueing delay is the earliest sign of congestion.
+   if ( mRoundTripTime > mMinRoundTripTime * DelayFactor + DelayMargin + mAckDelay )
+   {
+      backoff( sendTime, time );
+      return;
+   }
+
+   // Probe for more bandwidth once per round trip, as the previous step
+   // has only just had time to show up in the samples.
+   if ( S32( time - mLastIncreaseTime ) < S32( mRoundTripTime ) )
+      return;
+
+   mRateScale = getMin( mRateScale + IncreaseStep, 1.0f );
+   mLastIncreaseTime = time;
+}
+
+//-----------------------------------------------------------------------------
+
+void NetRateControl::packetDropped( const U32 sendTime, const U32 time )
+{
+   mPacketLoss += sLossGain * ( 1.0f - mPacketLoss );
+   backoff( sendTime, time );
+}
+
+//-----------------------------------------------------------------------------
+
+void NetRateControl::backoff( const U32 sendTime, const U32 time )
+{
+   // Packets sent before the last cut were sent too fast for the old rate and
+   // say nothing about the new one.
+   if ( S32( sendTime - mLastBackoffTime ) <= 0 )
+      return;
+
+   mRateScale = getMax( mRateScale * BackoffScale, MinRateScale );
+   mLastBackoffTime = time;
+   mLastIncreaseTime = time;
+}
+
+//-----------------------------------------------------------------------------
+
+void NetRateControl::adjustSend( U32& updateDelay, U32& packetSize ) const
+{
+   if ( mRateScale >= 1.0f || updateDelay == 0 || packetSize == 0 )
+      return;
+
+   const F32 scaledSize = F32( packetSize ) * mRateScale;
+   if ( scaledSize >= F32( MinPacketSize ) )
+   {
+      packetSize = U32( scaledSize );
+      return;
+   }
+
+   // Too small to be worth sending, so send minimum sized packets less often.
+   const F32 bytesPerMS = scaledSize / F32( updateDelay );
+   packetSize = getMin( packetSize, U32( MinPacketSize ) );
+   updateDelay = getMin( U32( F32( packetSize ) / bytesPerMS ), U32( MaxUpdateDelay ) );
+}
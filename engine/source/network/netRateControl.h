@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _NETRATECONTROL_H_
+#define _NETRATECONTROL_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+//-----------------------------------------------------------------------------
+/// Congestion control for a NetConnection.
+///
+/// The packet rate and size a connection negotiates are treated as a ceiling.
+/// The controller scales the rate actually used between MinRateScale and the
+/// full negotiated rate from what packet notifications say about the path:
+///
+/// - Every delivered packet gives a round trip sample, and the rate is raised
+///   by IncreaseStep once per round trip (additive increase).
+/// - A dropped packet, or a smoothed round trip time that has grown well past
+///   the lowest one seen plus the time the peer may sit on an acknowledgement,
+///   means a queue is building somewhere.  The rate is cut
+///   by BackoffScale (multiplicative decrease), at most once per round trip:
+///   only packets sent after the last cut can cause another.
+///
+/// The rate is applied by shrinking packets first, so updates keep arriving
+/// as often as negotiated, and only stretching the delay between packets once
+/// they reach MinPacketSize.
+class NetRateControl
+{
+public:
+   enum Constants
+   {
+      MinPacketSize  = 64,       ///< Smallest packet the controller shrinks to, in bytes.
+      MaxUpdateDelay = 1024,     ///< Longest delay the controller stretches to, in milliseconds.
+      DelayMargin    = 50,       ///< Round trip growth tolerated before backing off, in milliseconds.
+   };
+
+   NetRateControl();
+
+   /// Forget everything learnt about the path and return to the full rate.
+   void reset( void );
+
+   /// Set the longest time the peer may hold an acknowledgement before its
+   /// next packet carries it, in milliseconds.
+   inline void setAckDelay( const U32 ackDelay ) { mAckDelay = ackDelay; }
+
+   /// A packet sent at sendTime was delivered.
+   void packetDelivered( const U32 sendTime, const U32 time );
+
+   /// A packet sent at sendTime was dropped.
+   void packetDropped( const U32 sendTime, const U32 time );
+
+   /// Scale a negotiated packet delay and size to the current rate.
+   void adjustSend( U32& updateDelay, U32& packetSize ) const;
+
+   /// The fraction of the negotiated rate in use.
+   inline F32 getRateScale( void ) const { return mRateScale; }
+
+   /// Smoothed round trip time in milliseconds.
+   inline F32 getRoundTripTime( void ) const { return mRoundTripTime; }
+
+   /// Smoothed mean deviation of the round trip time in milliseconds.
+   inline F32 getRoundTripVariance( void ) const { return mRoundTripVariance; }
+
+   /// Smoothed fraction of packets dropped.
+   inline F32 getPacketLoss( void ) const { return mPacketLoss; }
+
+   static const F32 MinRateScale;   ///< Lowest fraction of the negotiated rate used.
+   static const F32 IncreaseStep;   ///< Rate fraction added each round trip without congestion.
+   static const F32 BackoffScale;   ///< Rate multiplier on congestion.
+   static const F32 DelayFactor;    ///< Round trip growth, relative to the lowest seen, tolerated before backing off.
+
+private:
+   void backoff( const U32 sendTime, const U32 time );
+
+   F32  mRateScale;
+   F32  mRoundTripTime;
+   F32  mRoundTripVariance;
+   F32  mMinRoundTripTime;
+   F32  mPacketLoss;
+   U32  mLastBackoffTime;
+   U32  mLastIncreaseTime;
+   U32  mAckDelay;
+   bool mHaveSample;
+};
+
+#endif // _NETRATECONTROL_H_
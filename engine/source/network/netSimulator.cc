@@ -0,0 +1,161 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "network/netSimulator.h"
+
+#ifndef _MMATHFN_H_
+#include "math/mMathFn.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+NetSimulator::Conditions::Conditions()
+{
+   latency = 0;
+   jitter = 0;
+   packetLoss = 0.0f;
+   reorder = 0.0f;
+   bandwidth = 0;
+   queueLimit = 250;
+}
+
+//-----------------------------------------------------------------------------
+
+NetSimulator::NetSimulator( const S32 seed ) :
+   mRandom( seed ),
+   mLinkFreeTime( 0.0 ),
+   mSentCount( 0 ),
+   mLostCount( 0 ),
+   mOverflowCount( 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+NetSimulator::~NetSimulator()
+{
+   clear();
+
+   for ( S32 index = 0; index < mFree.size(); index++ )
+      delete mFree[index];
+}
+
+//-----------------------------------------------------------------------------
+
+void NetSimulator::setConditions( const Conditions& conditions )
+{
+   mConditions = conditions;
+   mConditions.packetLoss = mClampF( mConditions.packetLoss, 0.0f, 1.0f );
+   mConditions.reorder = mClampF( mConditions.reorder, 0.0f, 1.0f );
+}
+
+//-----------------------------------------------------------------------------
+
+bool NetSimulator::isEnabled( void ) const
+{
+   return mConditions.latency || mConditions.jitter || mConditions.bandwidth ||
+      mConditions.packetLoss > 0.0f || mConditions.reorder > 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+
+bool NetSimulator::send( const PacketReceiveEvent& packet, const U32 time )
+{
+   mSentCount++;
+
+   F64 departTime = F64( time );
+   if ( mConditions.bandwidth )
+   {
+      // Wait behind everything already queued on the link.
+      const F64 startTime = getMax( mLinkFreeTime, F64( time ) );
+      if ( startTime - F64( time ) > F64( mConditions.queueLimit ) )
+      {
+         mOverflowCount++;
+         return false;
+      }
+
+      const U32 dataSize = packet.size - PacketReceiveEventHeaderSize;
+      mLinkFreeTime = startTime + F64( dataSize ) * 1000.0 / F64( mConditions.bandwidth );
+      departTime = mLinkFreeTime;
+   }
+
+   // Loss happens after the link so dropped packets still used bandwidth.
+   if ( mConditions.packetLoss > 0.0f && mRandom.randF() < mConditions.packetLoss )
+   {
+      mLostCount++;
+      return false;
+   }
+
+   U32 delay = mConditions.latency;
+   if ( mConditions.jitter )
+      delay += mRandom.randI() % ( mConditions.jitter + 1 );
+   if ( mConditions.reorder > 0.0f && mRandom.randF() < mConditions.reorder )
+      delay += getMax( mConditions.latency + mConditions.jitter, U32( MinReorderDelay ) );
+
+   Pending* pending;
+   if ( mFree.size() )
+   {
+      pending = mFree.last();
+      mFree.pop_back();
+   }
+   else
+      pending = new Pending;
+
+   pending->mDeliverTime = U32( mCeil( F32( departTime ) ) ) + delay;
+   dMemcpy( &pending->mPacket, &packet, packet.size );
+
+   // Most packets are due after everything already pending, so search from the back.
+   S32 index = mPending.size();
+   while ( index > 0 && S32( mPending[index - 1]->mDeliverTime - pending->mDeliverTime ) > 0 )
+      index--;
+   mPending.insert( index );
+   mPending[index] = pending;
+
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool NetSimulator::receive( const U32 time, PacketReceiveEvent& packet )
+{
+   if ( mPending.empty() || S32( mPending.first()->mDeliverTime - time ) > 0 )
+      return false;
+
+   Pending* pending = mPending.first();
+   mPending.pop_front();
+
+   dMemcpy( &packet, &pending->mPacket, pending->mPacket.size );
+   mFree.push_back( pending );
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void NetSimulator::clear( void )
+{
+   for ( S32 index = 0; index < mPending.size(); index++ )
+      mFree.push_back( mPending[index] );
+
+   mPending.clear();
+   mLinkFreeTime = 0.0;
+}
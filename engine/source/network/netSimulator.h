@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _NETSIMULATOR_H_
+#define _NETSIMULATOR_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _EVENT_H_
+#include "platform/event.h"
+#endif
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+//-----------------------------------------------------------------------------
+/// Simulates a poor network link for received packets.
+///
+/// Packets passed to send() are delayed, dropped or reordered according to
+/// the current conditions and come back out of receive() once they are due.
+/// A bandwidth limit models a bottleneck link: packets queue behind each other
+/// and are dropped once they would wait longer than the queue limit, which is
+/// what congestion control reacts to.
+///
+/// The simulator only knows about time through its arguments, so it can be
+/// driven offline as well as by NetInterface.
+class NetSimulator
+{
+public:
+   struct Conditions
+   {
+      U32 latency;      ///< Fixed one way delay in milliseconds.
+      U32 jitter;       ///< Random extra delay of up to this many milliseconds.
+      F32 packetLoss;   ///< Fraction of packets dropped at random.
+      F32 reorder;      ///< Fraction of packets held back long enough for later ones to overtake them.
+      U32 bandwidth;    ///< Link capacity in bytes per second, or zero for unlimited.
+      U32 queueLimit;   ///< Longest a packet may wait for the link, in milliseconds.
+
+      Conditions();
+   };
+
+   enum Constants
+   {
+      MinReorderDelay = 10,   ///< Least extra delay given to a reordered packet, in milliseconds.
+   };
+
+   NetSimulator( const S32 seed = 1 );
+   ~NetSimulator();
+
+   /// Change the conditions.  Packets already in flight keep their timing.
+   void setConditions( const Conditions& conditions );
+   inline const Conditions& getConditions( void ) const { return mConditions; }
+
+   /// Does any condition differ from a perfect link?
+   bool isEnabled( void ) const;
+
+   /// Put a packet on the link.
+   /// @return False if the packet was dropped.
+   bool send( const PacketReceiveEvent& packet, const U32 time );
+
+   /// Take the next packet due by the given time.
+   /// @return False if no packet is due.
+   bool receive( const U32 time, PacketReceiveEvent& packet );
+
+   /// Drop every packet in flight.
+   void clear( void );
+
+   inline U32 getPendingCount( void ) const { return mPending.size(); }
+   inline U32 getSentCount( void ) const { return mSentCount; }
+   inline U32 getLostCount( void ) const { return mLostCount; }
+   inline U32 getOverflowCount( void ) const { return mOverflowCount; }
+
+private:
+   struct Pending
+   {
+      U32                  mDeliverTime;
+      PacketReceiveEvent   mPacket;
+   };
+
+   Conditions        mConditions;
+   RandomLCG         mRandom;
+   Vector<Pending*>  mPending;      ///< In delivery order.  Packets due at the same time keep their sending order.
+   Vector<Pending*>  mFree;
+   F64               mLinkFreeTime; ///< When the link finishes sending the packets queued on it.
+   U32               mSentCount;
+   U32               mLostCount;
+   U32               mOverflowCount;
+};
+
+#endif // _NETSIMULATOR_H_
@@ -74,6 +74,10 @@
 #include "audio/audioAsset.h"
 #endif
 
+#ifndef _RESMANAGER_H_
+#include "io/resource/resourceManager.h"
+#endif
+
 // Script bindings.
 #include "taml_ScriptBinding.h"
 
@@ -221,16 +225,21 @@ SimObject* Taml::read( const char* pFilename )
     // Expand the file-name into the file-path buffer.
     Con::expandPath( mFilePathBuffer, sizeof(mFilePathBuffer), pFilename );
 
-    FileStream stream;
+    // Use the file if it was read ahead of time.
+    Stream* pPrefetchedStream = ResourceManager->openPrefetchedStream( mFilePathBuffer );
+
+    FileStream fileStream;
 
     // File opened?
-    if ( !stream.open( mFilePathBuffer, FileStream::Read ) )
+    if ( pPrefetchedStream == NULL && !fileStream.open( mFilePathBuffer, FileStream::Read ) )
     {
         // No, so warn.
         Con::warnf("Taml::read() - Could not open filename '%s' for read.", mFilePathBuffer );
         return NULL;
     }
 
+    Stream& stream = pPrefetchedStream != NULL ? *pPrefetchedStream : fileStream;
+
     // Get the file auto-format mode.
     const TamlFormatMode formatMode = getFileAutoFormatMode( mFilePathBuffer );
 
@@ -241,7 +250,10 @@ SimObject* Taml::read( const char* pFilename )
     SimObject* pSimObject = read( stream, formatMode );
 
     // Close file.
-    stream.close();
+    if ( pPrefetchedStream != NULL )
+        ResourceManager->closeStream( pPrefetchedStream );
+    else
+        fileStream.close();
 
     // Reset the compilation.
     resetCompilation();
@@ -303,7 +315,7 @@ bool Taml::write( FileStream& stream, SimObject* pSimObject, const TamlFormatMod
 
 //-----------------------------------------------------------------------------
 
-SimObject* Taml::read( FileStream& stream, const TamlFormatMode formatMode )
+SimObject* Taml::read( Stream& stream, const TamlFormatMode formatMode )
 {
     // Format appropriately.
     switch( formatMode )
@@ -114,8 +114,8 @@ private:
     void compileCustomNodeState( TamlCustomNode* pCustomNode );
 
     bool write( FileStream& stream, SimObject* pSimObject, const TamlFormatMode formatMode );
-    SimObject* read( FileStream& stream, const TamlFormatMode formatMode );
-    template<typename T> inline T* read( FileStream& stream, const TamlFormatMode formatMode )
+    SimObject* read( Stream& stream, const TamlFormatMode formatMode );
+    template<typename T> inline T* read( Stream& stream, const TamlFormatMode formatMode )
     {
         SimObject* pSimObject = read( stream, formatMode );
         if ( pSimObject == NULL )
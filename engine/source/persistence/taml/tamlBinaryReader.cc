@@ -31,7 +31,7 @@
 
 //-----------------------------------------------------------------------------
 
-SimObject* TamlBinaryReader::read( FileStream& stream )
+SimObject* TamlBinaryReader::read( Stream& stream )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlBinaryReader_Read);
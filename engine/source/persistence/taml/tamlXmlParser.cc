@@ -27,6 +27,50 @@
 
 //-----------------------------------------------------------------------------
 
+static bool writeEscapedValue( Stream& stream, const char* pValue )
+{
+    const char* pRun = pValue;
+
+    // Iterate value.
+    for ( const char* pCharacter = pValue; *pCharacter != 0; ++pCharacter )
+    {
+        const char* pEntity;
+
+        // Fetch any entity needed for the character.
+        switch( *pCharacter )
+        {
+            case '&':   pEntity = "&amp;"; break;
+            case '<':   pEntity = "&lt;"; break;
+            case '>':   pEntity = "&gt;"; break;
+            case '"':   pEntity = "&quot;"; break;
+            case '\'':  pEntity = "&apos;"; break;
+            default:    continue;
+        }
+
+        // Write the run before the entity then the entity itself.
+        if ( !stream.write( U32(pCharacter - pRun), pRun ) || !stream.writeStringBuffer( pEntity ) )
+            return false;
+
+        pRun = pCharacter + 1;
+    }
+
+    // Write the remaining run.
+    return stream.writeStringBuffer( pRun );
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlXmlAttribute::setValue( const char* pValue )
+{
+    // Sanity!
+    AssertFatal( mpParser != NULL, "TamlXmlAttribute::setValue() - Attribute is not being parsed." );
+    AssertFatal( pValue != NULL, "TamlXmlAttribute::setValue() - Cannot set a NULL value." );
+
+    mpParser->editValue( *this, pValue );
+}
+
+//-----------------------------------------------------------------------------
+
 bool TamlXmlParser::parse( const char* pFilename, TamlXmlVisitor& visitor, const bool writeDocument )
 {
     // Debug Profiling.
@@ -38,111 +82,253 @@ bool TamlXmlParser::parse( const char* pFilename, TamlXmlVisitor& visitor, const
     char filenameBuffer[1024];
     Con::expandPath( filenameBuffer, sizeof(filenameBuffer), pFilename );
 
-    FileStream stream;
+    File file;
 
     // File open for read?
-    if ( !stream.open( filenameBuffer, FileStream::Read ) )
+    if ( file.open( filenameBuffer, File::Read ) != File::Ok )
     {
         // No, so warn.
         Con::warnf("TamlXmlParser::parse() - Could not open filename '%s' for parse.", filenameBuffer );
         return false;
     }
 
-    TiXmlDocument xmlDocument;
+    // Map the document privately so it can be tokenized in-place.  Only the pages
+    // reached before the visitor stops are ever read.
+    U32 documentSize = 0;
+    char* pDocument = (char*)file.map( &documentSize, true );
 
-    // Load document from stream.
-    if ( !xmlDocument.LoadFile( stream ) )
+    // Mapped the document?
+    if ( pDocument == NULL )
     {
-        // Warn!
+        // No, so warn.
         Con::warnf("TamlXmlParser: Could not load Taml XML file from stream.");
         return false;
     }
 
-    // Close the stream.
-    stream.close();
+    mTokenizer.reset( pDocument, documentSize );
 
     // Set parsing filename.
     mpParsingFilename = filenameBuffer;
 
+    // Find the root element.
+    TamlXmlTokenizer::TokenType tokenType;
+    while( (tokenType = mTokenizer.next()) == TamlXmlTokenizer::TextToken ) {}
+
     // Parse root element.
-    parseElement( xmlDocument.RootElement(), visitor );
+    if ( tokenType == TamlXmlTokenizer::StartElementToken )
+        parseElement( visitor, true );
 
     // Reset parsing filename.
     mpParsingFilename = NULL;
 
-    // Are we writing the document?
-    if ( writeDocument )
+    // Release the document.
+    mAttributes.clear();
+    file.unmap();
+    file.close();
+
+    // Did the document fail to parse?
+    if ( mTokenizer.getTokenType() == TamlXmlTokenizer::ErrorToken || tokenType == TamlXmlTokenizer::EndDocumentToken )
     {
-        // Yes, so open for write?
-        if ( !stream.open( filenameBuffer, FileStream::Write ) )
-        {
-            // No, so warn.
-            Con::warnf("TamlXmlParser::parse() - Could not open filename '%s' for write.", filenameBuffer );
-            return false;
-        }
+        // Yes, so warn.
+        Con::warnf("TamlXmlParser: Could not load Taml XML file '%s': %s [row=%d column=%d]",
+            filenameBuffer,
+            tokenType == TamlXmlTokenizer::EndDocumentToken ? "No root element found." : mTokenizer.getError(),
+            mTokenizer.getRow(),
+            mTokenizer.getColumn() );
+
+        clearEdits();
+        return false;
+    }
 
-        // Yes, so save the document.
-        if ( !xmlDocument.SaveFile( stream ) )
+    // Are we writing the document?
+    if ( writeDocument && mEdits.size() > 0 )
+    {
+        // Yes, so write the edited values.
+        if ( !writeEdits( filenameBuffer ) )
         {
-            // Warn!
-            Con::warnf("TamlXmlParser: Could not save Taml XML document.");
+            clearEdits();
             return false;
         }
-
-        // Close the stream.
-        stream.close();
     }
 
+    clearEdits();
+
     return true;
 }
 
 //-----------------------------------------------------------------------------
 
-bool TamlXmlParser::parseElement( TiXmlElement* pXmlElement, TamlXmlVisitor& visitor )
+bool TamlXmlParser::parseElement( TamlXmlVisitor& visitor, const bool isRoot )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlXmlParser_ParseElement);
 
+    // Fetch the attributes.
+    const U32 attributeCount = mTokenizer.getAttributeCount();
+    mAttributes.setSize( attributeCount );
+    for ( U32 index = 0; index < attributeCount; ++index )
+    {
+        const TamlXmlTokenizer::Attribute& attribute = mTokenizer.getAttribute( index );
+        TamlXmlAttribute& xmlAttribute = mAttributes[index];
+        xmlAttribute.mpParser = this;
+        xmlAttribute.mpName = attribute.mpName;
+        xmlAttribute.mpValue = attribute.mpValue;
+        xmlAttribute.mValueOffset = attribute.mValueOffset;
+        xmlAttribute.mValueLength = attribute.mValueLength;
+    }
+
+    TamlXmlElement xmlElement;
+    xmlElement.mpName = mTokenizer.getName();
+    xmlElement.mIsRoot = isRoot;
+    xmlElement.mpAttributes = mAttributes.address();
+    xmlElement.mAttributeCount = attributeCount;
+
     // Visit this element (stop processing if instructed).
-    if ( !visitor.visit( pXmlElement, *this ) )
+    if ( !visitor.visit( xmlElement, *this ) )
         return false;
 
     // Parse attributes (stop processing if instructed).
-    if ( !parseAttributes( pXmlElement, visitor ) )
+    if ( !parseAttributes( xmlElement, visitor ) )
         return false;
 
-    // Fetch any children.
-    TiXmlNode* pChildXmlNode = pXmlElement->FirstChild();
-
-    // Do we have any element children?
-    if ( pChildXmlNode != NULL && pChildXmlNode->Type() == TiXmlNode::TINYXML_ELEMENT )
+    // Iterate children as they are read.
+    while( true )
     {
-        // Iterate children.
-        for ( TiXmlElement* pChildXmlElement = dynamic_cast<TiXmlElement*>( pChildXmlNode ); pChildXmlElement; pChildXmlElement = pChildXmlElement->NextSiblingElement() )
-        {
-            // Parse element (stop processing if instructed).
-            if ( !parseElement( pChildXmlElement, visitor ) )
-                return false;
-        }
-    }
+        const TamlXmlTokenizer::TokenType tokenType = mTokenizer.next();
 
-    return true;
+        // Finish at the end of the element.
+        if ( tokenType == TamlXmlTokenizer::EndElementToken )
+            return true;
+
+        // Skip text.
+        if ( tokenType == TamlXmlTokenizer::TextToken )
+            continue;
+
+        // Stop if the document failed.
+        if ( tokenType != TamlXmlTokenizer::StartElementToken )
+            return false;
+
+        // Parse element (stop processing if instructed).
+        if ( !parseElement( visitor, false ) )
+            return false;
+    }
 }
 
 //-----------------------------------------------------------------------------
 
-bool TamlXmlParser::parseAttributes( TiXmlElement* pXmlElement, TamlXmlVisitor& visitor )
+bool TamlXmlParser::parseAttributes( TamlXmlElement& xmlElement, TamlXmlVisitor& visitor )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlXmlParser_ParseAttribute);
 
     // Iterate attributes.
-    for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+    for ( U32 index = 0; index < xmlElement.getAttributeCount(); ++index )
     {
         // Visit this attribute (stop processing if instructed).
-        if ( !visitor.visit( pAttribute, *this ) )
+        if ( !visitor.visit( xmlElement.getAttribute( index ), *this ) )
             return false;
     }
 
     return true;
 }
+
+//-----------------------------------------------------------------------------
+
+void TamlXmlParser::editValue( TamlXmlAttribute& xmlAttribute, const char* pValue )
+{
+    // Values are visited in document order so a repeated edit can only be the last one.
+    if ( mEdits.size() > 0 && mEdits.last().mOffset == xmlAttribute.mValueOffset )
+    {
+        // Replace the previous edit.
+        dFree( mEdits.last().mpValue );
+        mEdits.last().mpValue = dStrdup( pValue );
+    }
+    else
+    {
+        // Add the edit.
+        ValueEdit edit;
+        edit.mOffset = xmlAttribute.mValueOffset;
+        edit.mLength = xmlAttribute.mValueLength;
+        edit.mpValue = dStrdup( pValue );
+        mEdits.push_back( edit );
+    }
+
+    // Present the new value for the rest of the visit.
+    xmlAttribute.mpValue = mEdits.last().mpValue;
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlXmlParser::writeEdits( const char* pFilename )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlXmlParser_WriteEdits);
+
+    FileStream stream;
+
+    // Read the original document.
+    if ( !stream.open( pFilename, FileStream::Read ) )
+    {
+        // No, so warn.
+        Con::warnf("TamlXmlParser::parse() - Could not open filename '%s' for parse.", pFilename );
+        return false;
+    }
+
+    const U32 documentSize = stream.getStreamSize();
+    char* pDocument = new char[documentSize];
+    const bool documentRead = stream.read( documentSize, pDocument );
+    stream.close();
+
+    // File open for write?
+    if ( !documentRead || !stream.open( pFilename, FileStream::Write ) )
+    {
+        // No, so warn.
+        Con::warnf("TamlXmlParser::parse() - Could not open filename '%s' for write.", pFilename );
+        delete [] pDocument;
+        return false;
+    }
+
+    U32 position = 0;
+    bool documentWritten = true;
+
+    // Write the document replacing only the edited values.
+    for ( U32 index = 0; index < (U32)mEdits.size() && documentWritten; ++index )
+    {
+        const ValueEdit& edit = mEdits[index];
+
+        // Sanity!
+        AssertFatal( edit.mOffset >= position && edit.mOffset + edit.mLength <= documentSize, "TamlXmlParser::writeEdits() - Edit is outside of the document." );
+
+        documentWritten = stream.write( edit.mOffset - position, pDocument + position ) && writeEscapedValue( stream, edit.mpValue );
+        position = edit.mOffset + edit.mLength;
+    }
+
+    if ( documentWritten )
+        documentWritten = stream.write( documentSize - position, pDocument + position );
+
+    // Close the stream.
+    stream.close();
+
+    delete [] pDocument;
+
+    // Did we write the document?
+    if ( !documentWritten )
+    {
+        // No, so warn.
+        Con::warnf("TamlXmlParser: Could not save Taml XML document.");
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlXmlParser::clearEdits( void )
+{
+    // Free the edited values.
+    for ( U32 index = 0; index < (U32)mEdits.size(); ++index )
+        dFree( mEdits[index].mpValue );
+
+    mEdits.clear();
+}
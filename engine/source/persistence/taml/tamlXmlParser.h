@@ -33,12 +33,28 @@
 
 //-----------------------------------------------------------------------------
 
+/// Streams a Taml XML file through a visitor.
+///
+/// The file is mapped and tokenized in-place so elements are visited as they are reached
+/// and a visitor that stops early never causes the rest of the file to be read.  Any values
+/// changed by the visitor are written back by patching only those values in the original
+/// text so the rest of the document is left untouched.
 class TamlXmlParser
 {
+private:
+    friend class TamlXmlAttribute;
+
+    struct ValueEdit
+    {
+        U32     mOffset;
+        U32     mLength;
+        char*   mpValue;
+    };
+
 public:
     TamlXmlParser() :
         mpParsingFilename( NULL ) {}
-    virtual ~TamlXmlParser() {}
+    virtual ~TamlXmlParser() { clearEdits(); }
 
     /// Parse.
     bool parse( const char* pFilename, TamlXmlVisitor& visitor, const bool writeDocument );
@@ -47,11 +63,17 @@ public:
     inline const char* getParsingFilename( void ) const { return mpParsingFilename; }
 
 private:
-    const char* mpParsingFilename;
+    const char*                 mpParsingFilename;
+    TamlXmlTokenizer            mTokenizer;
+    Vector<TamlXmlAttribute>    mAttributes;
+    Vector<ValueEdit>           mEdits;
 
 private:
-    bool parseElement( TiXmlElement* pXmlElement, TamlXmlVisitor& visitor );
-    bool parseAttributes( TiXmlElement* pXmlElement, TamlXmlVisitor& visitor );
+    bool parseElement( TamlXmlVisitor& visitor, const bool isRoot );
+    bool parseAttributes( TamlXmlElement& xmlElement, TamlXmlVisitor& visitor );
+    void editValue( TamlXmlAttribute& xmlAttribute, const char* pValue );
+    bool writeEdits( const char* pFilename );
+    void clearEdits( void );
 };
 
-#endif // _TAML_XMLPARSER_H_
\ No newline at end of file
+#endif // _TAML_XMLPARSER_H_
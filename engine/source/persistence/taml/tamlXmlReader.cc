@@ -27,28 +27,57 @@
 
 //-----------------------------------------------------------------------------
 
-SimObject* TamlXmlReader::read( FileStream& stream )
+SimObject* TamlXmlReader::read( Stream& stream )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlXmlReader_Read);
 
-    // Create document.
-    TiXmlDocument xmlDocument;
+    // Fetch the document size.
+    const U32 documentSize = stream.getStreamSize() - stream.getPosition();
 
-    // Load document from stream.
-    if ( !xmlDocument.LoadFile( stream ) )
+    // Read the document.  It is tokenized in-place so this is the only copy made.
+    char* pDocument = new char[documentSize];
+    if ( documentSize == 0 || !stream.read( documentSize, pDocument ) )
     {
         // Warn!
         Con::warnf("Taml: Could not load Taml XML file from stream.");
+        delete [] pDocument;
         return NULL;
     }
 
+    mTokenizer.reset( pDocument, documentSize );
+
+    // Find the root element.
+    TamlXmlTokenizer::TokenType tokenType;
+    while( (tokenType = mTokenizer.next()) == TamlXmlTokenizer::TextToken ) {}
+
+    SimObject* pSimObject = NULL;
+
     // Parse root element.
-    SimObject* pSimObject = parseElement( xmlDocument.RootElement() );
+    if ( tokenType == TamlXmlTokenizer::StartElementToken )
+        pSimObject = parseElement();
+    else if ( tokenType == TamlXmlTokenizer::EndDocumentToken )
+        Con::warnf("Taml: Could not load Taml XML file from stream: No root element found.");
+
+    // Did the document fail to parse?
+    if ( mTokenizer.getTokenType() == TamlXmlTokenizer::ErrorToken )
+    {
+        // Yes, so warn.
+        Con::warnf("Taml: Could not load Taml XML file from stream: %s [row=%d column=%d]", mTokenizer.getError(), mTokenizer.getRow(), mTokenizer.getColumn() );
+
+        // Objects are created as the document is read so remove anything created before the error.
+        // Children are always created after their parents so removing them in reverse is safe.
+        for ( S32 index = mCreatedObjects.size() - 1; index >= 0; --index )
+            mCreatedObjects[index]->deleteObject();
+
+        pSimObject = NULL;
+    }
 
     // Reset parse.
     resetParse();
 
+    delete [] pDocument;
+
     return pSimObject;
 }
 
@@ -61,11 +90,17 @@ void TamlXmlReader::resetParse( void )
 
     // Clear object reference map.
     mObjectReferenceMap.clear();
+
+    // Clear attribute names.
+    mAttributeNames.clear();
+
+    // Clear created objects.
+    mCreatedObjects.clear();
 }
 
 //-----------------------------------------------------------------------------
 
-SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
+SimObject* TamlXmlReader::parseElement( void )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlXmlReader_ParseElement);
@@ -73,15 +108,21 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
     SimObject* pSimObject = NULL;
 
     // Fetch element name.
-    StringTableEntry typeName = StringTable->insert( pXmlElement->Value() );
+    StringTableEntry typeName = StringTable->insert( mTokenizer.getName() );
+
+    // Fetch attribute names.
+    fetchAttributeNames();
 
     // Fetch reference to Id.
-    const U32 tamlRefToId = getTamlRefToId( pXmlElement );
+    const U32 tamlRefToId = getTamlRefToId();
 
     // Do we have a reference to Id?
     if ( tamlRefToId != 0 )
     {
-        // Yes, so fetch reference.
+        // Yes, so skip the element.
+        mTokenizer.skipElement();
+
+        // Fetch reference.
         typeObjectReferenceHash::iterator referenceItr = mObjectReferenceMap.find( tamlRefToId );
 
         // Did we find the reference?
@@ -97,12 +138,12 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
     }
 
     // No, so fetch reference Id.
-    const U32 tamlRefId = getTamlRefId( pXmlElement );
+    const U32 tamlRefId = getTamlRefId();
 
 #ifdef TORQUE_DEBUG
     // Format the type location.
     char typeLocationBuffer[64];
-    dSprintf( typeLocationBuffer, sizeof(typeLocationBuffer), "Taml [format='xml' row=%d column=%d]", pXmlElement->Row(), pXmlElement->Column() );    
+    dSprintf( typeLocationBuffer, sizeof(typeLocationBuffer), "Taml [format='xml' row=%d column=%d]", mTokenizer.getRow(), mTokenizer.getColumn() );    
 
     // Create type.
     pSimObject = Taml::createType( typeName, mpTaml, typeLocationBuffer );
@@ -114,7 +155,11 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
 
     // Finish if we couldn't create the type.
     if ( pSimObject == NULL )
+    {
+        // Skip the element.
+        mTokenizer.skipElement();
         return NULL;
+    }
 
     // Find Taml callbacks.
     TamlCallbacks* pCallbacks = dynamic_cast<TamlCallbacks*>( pSimObject );
@@ -127,10 +172,10 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
     }
 
     // Parse attributes.
-    parseAttributes( pXmlElement, pSimObject );
+    parseAttributes( pSimObject );
 
     // Fetch object name.
-    StringTableEntry objectName = StringTable->insert( getTamlObjectName( pXmlElement ) );
+    StringTableEntry objectName = StringTable->insert( getTamlObjectName() );
 
     // Does the object require a name?
     if ( objectName == StringTable->EmptyString )
@@ -156,6 +201,10 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
     }
 
 
+    // Note the object if it was registered.
+    if ( pSimObject->isProperlyAdded() )
+        mCreatedObjects.push_back( pSimObject );
+
     // Do we have a reference Id?
     if ( tamlRefId != 0 )
     {
@@ -163,97 +212,107 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
         mObjectReferenceMap.insert( tamlRefId, pSimObject );
     }
 
-    // Fetch any children.
-    TiXmlNode* pChildXmlNode = pXmlElement->FirstChild();
-
     TamlCustomNodes customProperties;
 
-    // Do we have any element children?
-    if ( pChildXmlNode != NULL )
+    bool hasChildren = false;
+    TamlChildren* pChildren = NULL;
+    AbstractClassRep* pContainerChildClass = NULL;
+
+    // Iterate children as they are read.
+    while( true )
     {
-        // Fetch the Taml children.
-        TamlChildren* pChildren = dynamic_cast<TamlChildren*>( pSimObject );
+        const TamlXmlTokenizer::TokenType tokenType = mTokenizer.next();
 
-        // Fetch any container child class specifier.
-        AbstractClassRep* pContainerChildClass = pSimObject->getClassRep()->getContainerChildClass( true );
+        // Finish at the end of the element.
+        if ( tokenType == TamlXmlTokenizer::EndElementToken )
+            break;
 
-        // Iterate siblings.
-        do
+        // Finish if the document failed.
+        if ( tokenType != TamlXmlTokenizer::StartElementToken && tokenType != TamlXmlTokenizer::TextToken )
+            return pSimObject;
+
+        // Is this the first child?
+        if ( !hasChildren )
         {
-            // Fetch element.
-            TiXmlElement* pChildXmlElement = dynamic_cast<TiXmlElement*>( pChildXmlNode );
+            // Yes, so fetch the Taml children.
+            hasChildren = true;
+            pChildren = dynamic_cast<TamlChildren*>( pSimObject );
+
+            // Fetch any container child class specifier.
+            pContainerChildClass = pSimObject->getClassRep()->getContainerChildClass( true );
+        }
+
+        // Skip if this is not an element.
+        if ( tokenType != TamlXmlTokenizer::StartElementToken )
+            continue;
+
+        // Is this a standard child element?
+        if ( dStrchr( mTokenizer.getName(), '.' ) == NULL )
+        {
+            // Is this a Taml child?
+            if ( pChildren == NULL )
+            {
+                // No, so warn.
+                Con::warnf("Taml: Child element '%s' found under parent '%s' but object cannot have children.",
+                    mTokenizer.getName(),
+                    typeName );
 
-            // Move to next sibling.
-            pChildXmlNode = pChildXmlNode->NextSibling();
+                // Skip.
+                mTokenizer.skipElement();
+                continue;
+            }
+
+            // Yes, so parse child element.
+            SimObject* pChildSimObject = parseElement();
 
-            // Skip if this is not an element?
-            if ( pChildXmlElement == NULL )
+            // Skip if the child was not created.
+            if ( pChildSimObject == NULL )
                 continue;
 
-            // Is this a standard child element?
-            if ( dStrchr( pChildXmlElement->Value(), '.' ) == NULL )
+            // Do we have a container child class?
+            if ( pContainerChildClass != NULL )
             {
-                // Is this a Taml child?
-                if ( pChildren == NULL )
+                // Yes, so is the child object the correctly derived type?
+                if ( !pChildSimObject->getClassRep()->isClass( pContainerChildClass ) )
                 {
                     // No, so warn.
-                    Con::warnf("Taml: Child element '%s' found under parent '%s' but object cannot have children.",
-                        pChildXmlElement->Value(),
-                        pXmlElement->Value() );
+                    Con::warnf("Taml: Child element '%s' found under parent '%s' but object is restricted to children of type '%s'.",
+                        pChildSimObject->getClassName(),
+                        pSimObject->getClassName(),
+                        pContainerChildClass->getClassName() );
 
-                    // Skip.
-                    continue;
-                }
-
-                // Yes, so parse child element.
-                SimObject* pChildSimObject = parseElement( pChildXmlElement );
+                    // NOTE: We can't delete the object as it may be referenced elsewhere!
+                    pChildSimObject = NULL;
 
-                // Skip if the child was not created.
-                if ( pChildSimObject == NULL )
+                    // Skip.
                     continue;
-
-                // Do we have a container child class?
-                if ( pContainerChildClass != NULL )
-                {
-                    // Yes, so is the child object the correctly derived type?
-                    if ( !pChildSimObject->getClassRep()->isClass( pContainerChildClass ) )
-                    {
-                        // No, so warn.
-                        Con::warnf("Taml: Child element '%s' found under parent '%s' but object is restricted to children of type '%s'.",
-                            pChildSimObject->getClassName(),
-                            pSimObject->getClassName(),
-                            pContainerChildClass->getClassName() );
-
-                        // NOTE: We can't delete the object as it may be referenced elsewhere!
-                        pChildSimObject = NULL;
-
-                        // Skip.
-                        continue;
-                    }
                 }
+            }
 
-                // Add child.
-                pChildren->addTamlChild( pChildSimObject );
+            // Add child.
+            pChildren->addTamlChild( pChildSimObject );
 
-                // Find Taml callbacks for child.
-                TamlCallbacks* pChildCallbacks = dynamic_cast<TamlCallbacks*>( pChildSimObject );
+            // Find Taml callbacks for child.
+            TamlCallbacks* pChildCallbacks = dynamic_cast<TamlCallbacks*>( pChildSimObject );
 
-                // Do we have callbacks on the child?
-                if ( pChildCallbacks != NULL )
-                {
-                    // Yes, so perform callback.
-                    mpTaml->tamlAddParent( pChildCallbacks, pSimObject );
-                }
-            }
-            else
+            // Do we have callbacks on the child?
+            if ( pChildCallbacks != NULL )
             {
-                // No, so parse custom element.
-                parseCustomElement( pChildXmlElement, customProperties );
+                // Yes, so perform callback.
+                mpTaml->tamlAddParent( pChildCallbacks, pSimObject );
             }
         }
-        while( pChildXmlNode != NULL );
+        else
+        {
+            // No, so parse custom element.
+            parseCustomElement( customProperties );
+        }
+    }
 
-        // Call custom read.
+    // Did we have any children?
+    if ( hasChildren )
+    {
+        // Yes, so call custom read.
         mpTaml->tamlCustomRead( pCallbacks, customProperties );
     }
 
@@ -270,7 +329,7 @@ SimObject* TamlXmlReader::parseElement( TiXmlElement* pXmlElement )
 
 //-----------------------------------------------------------------------------
 
-void TamlXmlReader::parseAttributes( TiXmlElement* pXmlElement, SimObject* pSimObject )
+void TamlXmlReader::parseAttributes( SimObject* pSimObject )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlXmlReader_ParseAttributes);
@@ -279,10 +338,10 @@ void TamlXmlReader::parseAttributes( TiXmlElement* pXmlElement, SimObject* pSimO
     AssertFatal( pSimObject != NULL, "Taml: Cannot parse attributes on a NULL object." );
 
     // Iterate attributes.
-    for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+    for ( U32 index = 0; index < mTokenizer.getAttributeCount(); ++index )
     {
-        // Insert attribute name.
-        StringTableEntry attributeName = StringTable->insert( pAttribute->Name() );
+        // Fetch attribute name.
+        StringTableEntry attributeName = mAttributeNames[index];
 
         // Ignore if this is a Taml attribute.
         if (    attributeName == tamlRefIdName ||
@@ -291,60 +350,59 @@ void TamlXmlReader::parseAttributes( TiXmlElement* pXmlElement, SimObject* pSimO
             continue;
 
         // We can assume this is a field for now.
-        pSimObject->setPrefixedDataField( attributeName, NULL, pAttribute->Value() );
+        pSimObject->setPrefixedDataField( attributeName, NULL, mTokenizer.getAttribute( index ).mpValue );
     }
 }
 
 //-----------------------------------------------------------------------------
 
-void TamlXmlReader::parseCustomElement( TiXmlElement* pXmlElement, TamlCustomNodes& customNodes )
+void TamlXmlReader::parseCustomElement( TamlCustomNodes& customNodes )
 {
     // Debug Profiling.
     PROFILE_SCOPE(TamlXmlReader_ParseCustomElement);
 
     // Is this a standard child element?
-    const char* pPeriod = dStrchr( pXmlElement->Value(), '.' );
+    const char* pPeriod = dStrchr( mTokenizer.getName(), '.' );
 
     // Sanity!
     AssertFatal( pPeriod != NULL, "Parsing extended element but no period character found." );
 
-    // Fetch any custom XML node.
-    TiXmlNode* pCustomXmlNode = pXmlElement->FirstChild();
+    // The custom node is only added if the element has children.
+    TamlCustomNode* pCustomNode = NULL;
 
-    // Finish is no XML node exists.
-    if ( pCustomXmlNode == NULL )
-        return;
-
-    // Yes, so add custom node.
-    TamlCustomNode* pCustomNode = customNodes.addNode( pPeriod+1 );
-
-    do
+    while( true )
     {
-        // Fetch element.
-        TiXmlElement* pCustomXmlElement = dynamic_cast<TiXmlElement*>( pCustomXmlNode );
+        const TamlXmlTokenizer::TokenType tokenType = mTokenizer.next();
+
+        // Finish at the end of the element or if the document failed.
+        if ( tokenType != TamlXmlTokenizer::StartElementToken && tokenType != TamlXmlTokenizer::TextToken )
+            return;
 
-        // Move to next sibling.
-        pCustomXmlNode = pCustomXmlNode->NextSibling();
+        // Add custom node.
+        if ( pCustomNode == NULL )
+            pCustomNode = customNodes.addNode( pPeriod+1 );
 
         // Skip if this is not an element.
-        if ( pCustomXmlElement == NULL )
+        if ( tokenType != TamlXmlTokenizer::StartElementToken )
             continue;
 
         // Parse custom node.
-        parseCustomNode( pCustomXmlElement, pCustomNode );
+        parseCustomNode( pCustomNode );
     }
-    while ( pCustomXmlNode != NULL );
 }
 
 //-----------------------------------------------------------------------------
 
-void TamlXmlReader::parseCustomNode( TiXmlElement* pXmlElement, TamlCustomNode* pCustomNode )
+void TamlXmlReader::parseCustomNode( TamlCustomNode* pCustomNode )
 {
+    // Fetch attribute names.
+    fetchAttributeNames();
+
     // Is the node a proxy object?
-    if (  getTamlRefId( pXmlElement ) != 0 || getTamlRefToId( pXmlElement ) != 0 )
+    if (  getTamlRefId() != 0 || getTamlRefToId() != 0 )
     {
         // Yes, so parse proxy object.
-        SimObject* pProxyObject = parseElement( pXmlElement );
+        SimObject* pProxyObject = parseElement();
 
         // Add child node.
         pCustomNode->addNode( pProxyObject );
@@ -353,76 +411,79 @@ void TamlXmlReader::parseCustomNode( TiXmlElement* pXmlElement, TamlCustomNode*
     }
 
     // Yes, so add child node.
-    TamlCustomNode* pChildNode = pCustomNode->addNode( pXmlElement->Value() );
+    TamlCustomNode* pChildNode = pCustomNode->addNode( mTokenizer.getName() );
 
     // Iterate attributes.
-    for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+    for ( U32 index = 0; index < mTokenizer.getAttributeCount(); ++index )
     {
-        // Insert attribute name.
-        StringTableEntry attributeName = StringTable->insert( pAttribute->Name() );
+        // Fetch attribute name.
+        StringTableEntry attributeName = mAttributeNames[index];
 
         // Skip if a Taml reference attribute.
         if ( attributeName == tamlRefIdName || attributeName == tamlRefToIdName )
             continue;
 
         // Add node field.
-        pChildNode->addField( attributeName, pAttribute->Value() );
+        pChildNode->addField( attributeName, mTokenizer.getAttribute( index ).mpValue );
     }
 
-    // Fetch any element text.
-    const char* pElementText = pXmlElement->GetText();
+    bool firstChild = true;
 
-    // Do we have any element text?
-    if ( pElementText != NULL )
+    // Iterate children as they are read.
+    while( true )
     {
-        // Yes, so store it.
-        pChildNode->setNodeText( pElementText );
-    }
+        const TamlXmlTokenizer::TokenType tokenType = mTokenizer.next();
 
-    // Fetch any children.
-    TiXmlNode* pChildXmlNode = pXmlElement->FirstChild();
+        // Finish at the end of the element or if the document failed.
+        if ( tokenType != TamlXmlTokenizer::StartElementToken && tokenType != TamlXmlTokenizer::TextToken )
+            return;
 
-    // Do we have any element children?
-    if ( pChildXmlNode != NULL )
-    {
-        do
+        // Is this element text?
+        if ( tokenType == TamlXmlTokenizer::TextToken )
         {
-            // Yes, so fetch child element.
-            TiXmlElement* pChildXmlElement = dynamic_cast<TiXmlElement*>( pChildXmlNode );
+            // Yes, so store it if it's the first child.
+            if ( firstChild )
+                pChildNode->setNodeText( mTokenizer.getText() );
 
-            // Move to next sibling.
-            pChildXmlNode = pChildXmlNode->NextSibling();
+            firstChild = false;
+            continue;
+        }
 
-            // Skip if this is not an element.
-            if ( pChildXmlElement == NULL )
-                continue;
+        firstChild = false;
 
-            // Parse custom node.
-            parseCustomNode( pChildXmlElement, pChildNode );
-        }
-        while( pChildXmlNode != NULL );
+        // Parse custom node.
+        parseCustomNode( pChildNode );
     }
 }
 
 //-----------------------------------------------------------------------------
 
-U32 TamlXmlReader::getTamlRefId( TiXmlElement* pXmlElement )
+void TamlXmlReader::fetchAttributeNames( void )
 {
     // Debug Profiling.
-    PROFILE_SCOPE(TamlXmlReader_GetTamlRefId);
+    PROFILE_SCOPE(TamlXmlReader_FetchAttributeNames);
+
+    const U32 attributeCount = mTokenizer.getAttributeCount();
+
+    // Insert each attribute name once for all the lookups on this element.
+    mAttributeNames.setSize( attributeCount );
+    for ( U32 index = 0; index < attributeCount; ++index )
+        mAttributeNames[index] = StringTable->insert( mTokenizer.getAttribute( index ).mpName );
+}
 
+//-----------------------------------------------------------------------------
+
+U32 TamlXmlReader::getTamlRefId( void )
+{
     // Iterate attributes.
-    for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+    for ( U32 index = 0; index < mTokenizer.getAttributeCount(); ++index )
     {
-        // Insert attribute name.
-        StringTableEntry attributeName = StringTable->insert( pAttribute->Name() );
-
         // Skip if not the correct attribute.
-        if ( attributeName != tamlRefIdName )
+        if ( mAttributeNames[index] != tamlRefIdName )
             continue;
 
         // Return it.
-        return dAtoi( pAttribute->Value() );
+        return dAtoi( mTokenizer.getAttribute( index ).mpValue );
     }
 
     // Not found.
@@ -431,23 +492,17 @@ U32 TamlXmlReader::getTamlRefId( TiXmlElement* pXmlElement )
 
 //-----------------------------------------------------------------------------
 
-U32 TamlXmlReader::getTamlRefToId( TiXmlElement* pXmlElement )
+U32 TamlXmlReader::getTamlRefToId( void )
 {
-    // Debug Profiling.
-    PROFILE_SCOPE(TamlXmlReader_GetTamlRefToId);
-
     // Iterate attributes.
-    for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+    for ( U32 index = 0; index < mTokenizer.getAttributeCount(); ++index )
     {
-        // Insert attribute name.
-        StringTableEntry attributeName = StringTable->insert( pAttribute->Name() );
-
         // Skip if not the correct attribute.
-        if ( attributeName != tamlRefToIdName )
+        if ( mAttributeNames[index] != tamlRefToIdName )
             continue;
 
         // Return it.
-        return dAtoi( pAttribute->Value() );
+        return dAtoi( mTokenizer.getAttribute( index ).mpValue );
     }
 
     // Not found.
@@ -456,28 +511,19 @@ U32 TamlXmlReader::getTamlRefToId( TiXmlElement* pXmlElement )
 
 //-----------------------------------------------------------------------------
 
-const char* TamlXmlReader::getTamlObjectName( TiXmlElement* pXmlElement )
+const char* TamlXmlReader::getTamlObjectName( void )
 {
-    // Debug Profiling.
-    PROFILE_SCOPE(TamlXmlReader_GetTamlObjectName);
-
     // Iterate attributes.
-    for ( TiXmlAttribute* pAttribute = pXmlElement->FirstAttribute(); pAttribute; pAttribute = pAttribute->Next() )
+    for ( U32 index = 0; index < mTokenizer.getAttributeCount(); ++index )
     {
-        // Insert attribute name.
-        StringTableEntry attributeName = StringTable->insert( pAttribute->Name() );
-
         // Skip if not the correct attribute.
-        if ( attributeName != tamlNamedObjectName )
+        if ( mAttributeNames[index] != tamlNamedObjectName )
             continue;
 
         // Return it.
-        return pAttribute->Value();
+        return mTokenizer.getAttribute( index ).mpValue;
     }
 
     // Not found.
     return NULL;
 }
-
-
-
@@ -31,8 +31,8 @@
 #include "persistence/taml/taml.h"
 #endif
 
-#ifndef TINYXML_INCLUDED
-#include "persistence/tinyXML/tinyxml.h"
+#ifndef _TAML_XML_TOKENIZER_H_
+#include "persistence/taml/tamlXmlTokenizer.h"
 #endif
 
 //-----------------------------------------------------------------------------
@@ -47,7 +47,7 @@ public:
     virtual ~TamlXmlReader() {}
 
     /// Read.
-    SimObject* read( FileStream& stream );
+    SimObject* read( Stream& stream );
 
 private:
     Taml*               mpTaml;
@@ -56,17 +56,26 @@ private:
 
     typeObjectReferenceHash mObjectReferenceMap;
 
+    TamlXmlTokenizer    mTokenizer;
+
+    /// Attribute names of the current element.
+    Vector<StringTableEntry> mAttributeNames;
+
+    /// Objects created so far so they can be removed if the document fails.
+    Vector<SimObject*>  mCreatedObjects;
+
 private:
     void resetParse( void );
 
-    SimObject* parseElement( TiXmlElement* pXmlElement );
-    void parseAttributes( TiXmlElement* pXmlElement, SimObject* pSimObject );
-    void parseCustomElement( TiXmlElement* pXmlElement, TamlCustomNodes& pCustomNode );
-    void parseCustomNode( TiXmlElement* pXmlElement, TamlCustomNode* pCustomNode );
+    SimObject* parseElement( void );
+    void parseAttributes( SimObject* pSimObject );
+    void parseCustomElement( TamlCustomNodes& pCustomNode );
+    void parseCustomNode( TamlCustomNode* pCustomNode );
 
-    U32 getTamlRefId( TiXmlElement* pXmlElement );
-    U32 getTamlRefToId( TiXmlElement* pXmlElement );
-    const char* getTamlObjectName( TiXmlElement* pXmlElement );   
+    void fetchAttributeNames( void );
+    U32 getTamlRefId( void );
+    U32 getTamlRefToId( void );
+    const char* getTamlObjectName( void );
 };
 
 #endif // _TAML_XMLREADER_H_
\ No newline at end of file
@@ -0,0 +1,573 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "persistence/taml/tamlXmlTokenizer.h"
+
+// Debug Profiling.
+#include "debug/profiler.h"
+
+//-----------------------------------------------------------------------------
+
+static inline bool isXmlWhiteSpace( const char character )
+{
+    return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+}
+
+//-----------------------------------------------------------------------------
+
+static inline bool isXmlNameCharacter( const char character )
+{
+    return !isXmlWhiteSpace( character ) && character != '/' && character != '>' && character != '<' &&
+        character != '=' && character != '"' && character != '\'' && character != 0;
+}
+
+//-----------------------------------------------------------------------------
+
+TamlXmlTokenizer::TamlXmlTokenizer() :
+    mpBuffer( NULL ),
+    mpBufferEnd( NULL ),
+    mpCursor( NULL ),
+    mTokenType( EndDocumentToken ),
+    mpName( NULL ),
+    mpText( NULL ),
+    mpError( NULL ),
+    mTagAtCursor( false ),
+    mEmptyElementPending( false ),
+    mRow( 1 ),
+    mpLineStart( NULL ),
+    mTokenRow( 0 ),
+    mTokenColumn( 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void TamlXmlTokenizer::reset( char* pBuffer, const U32 bufferSize )
+{
+    // Sanity!
+    AssertFatal( pBuffer != NULL || bufferSize == 0, "TamlXmlTokenizer::reset() - Cannot tokenize a NULL buffer." );
+
+    mpBuffer = pBuffer;
+    mpBufferEnd = pBuffer + bufferSize;
+    mpCursor = pBuffer;
+
+    // Skip any UTF-8 byte-order mark.
+    if ( bufferSize >= 3 && U8(pBuffer[0]) == 0xEF && U8(pBuffer[1]) == 0xBB && U8(pBuffer[2]) == 0xBF )
+        mpCursor += 3;
+
+    mTokenType = StartElementToken;
+    mpName = NULL;
+    mpText = NULL;
+    mpError = NULL;
+    mTagAtCursor = false;
+    mEmptyElementPending = false;
+    mAttributes.clear();
+    mAttributeNameEnds.clear();
+    mOpenElements.clear();
+    mRow = 1;
+    mpLineStart = mpCursor;
+    mTokenRow = 0;
+    mTokenColumn = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+TamlXmlTokenizer::TokenType TamlXmlTokenizer::next( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlXmlTokenizer_Next);
+
+    // Finish if the document has ended or failed.
+    if ( mTokenType == EndDocumentToken || mTokenType == ErrorToken )
+        return mTokenType;
+
+    // Close an empty element.
+    if ( mEmptyElementPending )
+    {
+        mEmptyElementPending = false;
+        mpName = mOpenElements.last();
+        mOpenElements.pop_back();
+        return mTokenType = EndElementToken;
+    }
+
+    while( true )
+    {
+        char* pCursor = mpCursor;
+
+        // Is the cursor on a tag whose '<' has been overwritten by the previous text token?
+        if ( !mTagAtCursor )
+        {
+            // No, so skip any white space.
+            pCursor = skipWhiteSpace( pCursor );
+
+            // End of the document?
+            if ( pCursor == mpBufferEnd )
+            {
+                // Yes, so it must not end inside an element.
+                if ( mOpenElements.size() > 0 )
+                    return setError( "Unexpected end of document." );
+
+                mpCursor = pCursor;
+                return mTokenType = EndDocumentToken;
+            }
+
+            // Is this text?
+            if ( *pCursor != '<' )
+                return parseText( pCursor );
+        }
+
+        mTagAtCursor = false;
+
+        // Note the token location.
+        mTokenRow = mRow;
+        mTokenColumn = S32(pCursor - mpLineStart) + 1;
+
+        char* pTag = pCursor + 1;
+        const U32 remaining = U32(mpBufferEnd - pTag);
+
+        // End tag?
+        if ( remaining >= 1 && *pTag == '/' )
+            return parseEndTag( pTag + 1 );
+
+        // Processing instruction or declaration?
+        if ( remaining >= 1 && *pTag == '?' )
+        {
+            mpCursor = skipPast( pTag, "?>" );
+            if ( mpCursor == NULL )
+                return setError( "Unterminated processing instruction." );
+            continue;
+        }
+
+        if ( remaining >= 1 && *pTag == '!' )
+        {
+            // Comment?
+            if ( remaining >= 3 && dStrncmp( pTag, "!--", 3 ) == 0 )
+            {
+                mpCursor = skipPast( pTag + 3, "-->" );
+                if ( mpCursor == NULL )
+                    return setError( "Unterminated comment." );
+                continue;
+            }
+
+            // CDATA?
+            if ( remaining >= 8 && dStrncmp( pTag, "![CDATA[", 8 ) == 0 )
+                return parseCData( pTag + 8 );
+
+            // No, so skip anything else such as a DOCTYPE.
+            mpCursor = skipPast( pTag, ">" );
+            if ( mpCursor == NULL )
+                return setError( "Unterminated declaration." );
+            continue;
+        }
+
+        return parseStartTag( pTag );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool TamlXmlTokenizer::skipElement( void )
+{
+    // Debug Profiling.
+    PROFILE_SCOPE(TamlXmlTokenizer_SkipElement);
+
+    // Sanity!
+    AssertFatal( mTokenType == StartElementToken, "TamlXmlTokenizer::skipElement() - Can only skip an element after its start token." );
+
+    const U32 parentDepth = mOpenElements.size() - 1;
+
+    while( true )
+    {
+        const TokenType tokenType = next();
+
+        if ( tokenType == ErrorToken || tokenType == EndDocumentToken )
+            return false;
+
+        if ( tokenType == EndElementToken && mOpenElements.size() == parentDepth )
+            return true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TamlXmlTokenizer::TokenType TamlXmlTokenizer::parseStartTag( char* pTag )
+{
+    // Only one root element is allowed.
+    if ( mOpenElements.size() == 0 && mpName != NULL )
+        return setError( "Multiple root elements." );
+
+    // Fetch element name.
+    char* pCursor = pTag;
+    while( pCursor != mpBufferEnd && isXmlNameCharacter( *pCursor ) )
+        pCursor++;
+
+    if ( pCursor == pTag )
+        return setError( "Missing element name." );
+
+    // The name is terminated once the whole tag has been read as its terminator may be significant.
+    char* pNameEnd = pCursor;
+
+    mAttributes.clear();
+    mAttributeNameEnds.clear();
+
+    bool emptyElement = false;
+
+    // Read attributes.
+    while( true )
+    {
+        pCursor = skipWhiteSpace( pCursor );
+
+        if ( pCursor == mpBufferEnd )
+            return setError( "Unterminated element." );
+
+        // End of tag?
+        if ( *pCursor == '>' )
+        {
+            pCursor++;
+            break;
+        }
+
+        // End of empty element?
+        if ( *pCursor == '/' )
+        {
+            if ( pCursor + 1 == mpBufferEnd || pCursor[1] != '>' )
+                return setError( "Malformed empty element." );
+
+            pCursor += 2;
+            emptyElement = true;
+            break;
+        }
+
+        // Fetch attribute name.
+        char* pAttributeName = pCursor;
+        while( pCursor != mpBufferEnd && isXmlNameCharacter( *pCursor ) )
+            pCursor++;
+
+        if ( pCursor == pAttributeName )
+            return setError( "Malformed attribute." );
+
+        char* pAttributeNameEnd = pCursor;
+
+        pCursor = skipWhiteSpace( pCursor );
+        if ( pCursor == mpBufferEnd || *pCursor != '=' )
+            return setError( "Attribute is missing a value." );
+
+        pCursor = skipWhiteSpace( pCursor + 1 );
+        if ( pCursor == mpBufferEnd || ( *pCursor != '"' && *pCursor != '\'' ) )
+            return setError( "Attribute value is not quoted." );
+
+        // Decode the attribute value in-place.
+        const char quote = *pCursor++;
+        char* pValue = pCursor;
+        char* pWrite = pCursor;
+
+        while( pCursor != mpBufferEnd && *pCursor != quote )
+        {
+            if ( *pCursor == '&' )
+            {
+                pCursor = decodeEntity( pCursor, pWrite );
+            }
+            else if ( *pCursor == '\r' )
+            {
+                // Normalize line breaks as TinyXML does.
+                *pWrite++ = '\n';
+                pCursor++;
+                if ( pCursor != mpBufferEnd && *pCursor == '\n' )
+                    newLine( pCursor++ );
+            }
+            else
+            {
+                if ( *pCursor == '\n' )
+                    newLine( pCursor );
+                *pWrite++ = *pCursor++;
+            }
+        }
+
+        if ( pCursor == mpBufferEnd )
+            return setError( "Unterminated attribute value." );
+
+        Attribute attribute;
+        attribute.mpName = pAttributeName;
+        attribute.mpValue = pValue;
+        attribute.mValueOffset = U32(pValue - mpBuffer);
+        attribute.mValueLength = U32(pCursor - pValue);
+        mAttributes.push_back( attribute );
+        mAttributeNameEnds.push_back( pAttributeNameEnd );
+
+        // Terminate the value, skipping the closing quote.
+        *pWrite = 0;
+        pCursor++;
+    }
+
+    // Terminate the names now the tag has been read.
+    *pNameEnd = 0;
+    for( U32 index = 0; index < (U32)mAttributeNameEnds.size(); ++index )
+        *mAttributeNameEnds[index] = 0;
+
+    mpCursor = pCursor;
+    mpName = pTag;
+    mOpenElements.push_back( mpName );
+    mEmptyElementPending = emptyElement;
+
+    return mTokenType = StartElementToken;
+}
+
+//-----------------------------------------------------------------------------
+
+TamlXmlTokenizer::TokenType TamlXmlTokenizer::parseEndTag( char* pTag )
+{
+    // Fetch element name.
+    char* pCursor = pTag;
+    while( pCursor != mpBufferEnd && isXmlNameCharacter( *pCursor ) )
+        pCursor++;
+
+    char* pNameEnd = pCursor;
+
+    pCursor = skipWhiteSpace( pCursor );
+    if ( pCursor == mpBufferEnd || *pCursor != '>' )
+        return setError( "Malformed end tag." );
+
+    *pNameEnd = 0;
+
+    // Does the end tag match the open element?
+    if ( mOpenElements.size() == 0 || dStrcmp( mOpenElements.last(), pTag ) != 0 )
+        return setError( "End tag does not match the open element." );
+
+    mOpenElements.pop_back();
+    mpCursor = pCursor + 1;
+    mpName = pTag;
+
+    return mTokenType = EndElementToken;
+}
+
+//-----------------------------------------------------------------------------
+
+TamlXmlTokenizer::TokenType TamlXmlTokenizer::parseText( char* pText )
+{
+    // Text must be inside an element.
+    if ( mOpenElements.size() == 0 )
+        return setError( "Text found outside of the root element." );
+
+    // Condense white space in-place (leading white space has already been skipped).
+    char* pCursor = pText;
+    char* pWrite = pText;
+    bool whiteSpace = false;
+
+    while( pCursor != mpBufferEnd && *pCursor != '<' )
+    {
+        if ( isXmlWhiteSpace( *pCursor ) )
+        {
+            if ( *pCursor == '\n' )
+                newLine( pCursor );
+
+            whiteSpace = true;
+            pCursor++;
+            continue;
+        }
+
+        // Any run of white space becomes a single space.
+        if ( whiteSpace )
+        {
+            *pWrite++ = ' ';
+            whiteSpace = false;
+        }
+
+        if ( *pCursor == '&' )
+            pCursor = decodeEntity( pCursor, pWrite );
+        else
+            *pWrite++ = *pCursor++;
+    }
+
+    if ( pCursor == mpBufferEnd )
+        return setError( "Unexpected end of document." );
+
+    // Terminate the text.  This may overwrite the '<' of the next tag so note that it is there.
+    *pWrite = 0;
+    mpCursor = pCursor;
+    mTagAtCursor = true;
+    mpText = pText;
+
+    return mTokenType = TextToken;
+}
+
+//-----------------------------------------------------------------------------
+
+TamlXmlTokenizer::TokenType TamlXmlTokenizer::parseCData( char* pData )
+{
+    // Text must be inside an element.
+    if ( mOpenElements.size() == 0 )
+        return setError( "CDATA found outside of the root element." );
+
+    char* pCursor = skipPast( pData, "]]>" );
+    if ( pCursor == NULL )
+        return setError( "Unterminated CDATA." );
+
+    // CDATA is kept verbatim.
+    *(pCursor - 3) = 0;
+    mpCursor = pCursor;
+    mpText = pData;
+
+    return mTokenType = TextToken;
+}
+
+//-----------------------------------------------------------------------------
+
+TamlXmlTokenizer::TokenType TamlXmlTokenizer::setError( const char* pError )
+{
+    mpError = pError;
+
+    // Report the cursor unless lines have been scanned past it in which case the token location stands.
+    if ( mpCursor >= mpLineStart )
+    {
+        mTokenRow = mRow;
+        mTokenColumn = S32(mpCursor - mpLineStart) + 1;
+    }
+
+    return mTokenType = ErrorToken;
+}
+
+//-----------------------------------------------------------------------------
+
+char* TamlXmlTokenizer::skipWhiteSpace( char* pCursor )
+{
+    while( pCursor != mpBufferEnd && isXmlWhiteSpace( *pCursor ) )
+    {
+        if ( *pCursor == '\n' )
+            newLine( pCursor );
+
+        pCursor++;
+    }
+
+    return pCursor;
+}
+
+//-----------------------------------------------------------------------------
+
+char* TamlXmlTokenizer::skipPast( char* pCursor, const char* pTerminator )
+{
+    const U32 terminatorLength = dStrlen( pTerminator );
+
+    while( U32(mpBufferEnd - pCursor) >= terminatorLength )
+    {
+        if ( *pCursor == *pTerminator && dStrncmp( pCursor, pTerminator, terminatorLength ) == 0 )
+            return pCursor + terminatorLength;
+
+        if ( *pCursor == '\n' )
+            newLine( pCursor );
+
+        pCursor++;
+    }
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+char* TamlXmlTokenizer::decodeEntity( char* pRead, char*& pWrite )
+{
+    const U32 remaining = U32(mpBufferEnd - pRead);
+
+    // Character reference?
+    if ( remaining > 2 && pRead[1] == '#' )
+    {
+        const bool hex = pRead[2] == 'x';
+        char* pCursor = pRead + (hex ? 3 : 2);
+        char* pDigits = pCursor;
+        U32 codePoint = 0;
+
+        while( pCursor != mpBufferEnd && pCursor - pDigits < 8 )
+        {
+            const char character = *pCursor;
+            U32 digit;
+
+            if ( character >= '0' && character <= '9' )
+                digit = character - '0';
+            else if ( hex && character >= 'a' && character <= 'f' )
+                digit = character - 'a' + 10;
+            else if ( hex && character >= 'A' && character <= 'F' )
+                digit = character - 'A' + 10;
+            else
+                break;
+
+            codePoint = codePoint * (hex ? 16 : 10) + digit;
+            pCursor++;
+        }
+
+        // Encode as UTF-8.  The encoding is never longer than the reference so this is safe in-place.
+        if ( pCursor != pDigits && pCursor != mpBufferEnd && *pCursor == ';' && codePoint != 0 && codePoint <= 0x10FFFF )
+        {
+            if ( codePoint < 0x80 )
+            {
+                *pWrite++ = char(codePoint);
+            }
+            else if ( codePoint < 0x800 )
+            {
+                *pWrite++ = char(0xC0 | (codePoint >> 6));
+                *pWrite++ = char(0x80 | (codePoint & 0x3F));
+            }
+            else if ( codePoint < 0x10000 )
+            {
+                *pWrite++ = char(0xE0 | (codePoint >> 12));
+                *pWrite++ = char(0x80 | ((codePoint >> 6) & 0x3F));
+                *pWrite++ = char(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                *pWrite++ = char(0xF0 | (codePoint >> 18));
+                *pWrite++ = char(0x80 | ((codePoint >> 12) & 0x3F));
+                *pWrite++ = char(0x80 | ((codePoint >> 6) & 0x3F));
+                *pWrite++ = char(0x80 | (codePoint & 0x3F));
+            }
+
+            return pCursor + 1;
+        }
+    }
+    else
+    {
+        static const struct
+        {
+            const char* mpEntity;
+            U32         mLength;
+            char        mCharacter;
+        } entities[] =
+        {
+            { "&amp;", 5, '&' },
+            { "&lt;", 4, '<' },
+            { "&gt;", 4, '>' },
+            { "&quot;", 6, '"' },
+            { "&apos;", 6, '\'' },
+        };
+
+        for( U32 index = 0; index < sizeof(entities) / sizeof(entities[0]); ++index )
+        {
+            if ( remaining >= entities[index].mLength && dStrncmp( pRead, entities[index].mpEntity, entities[index].mLength ) == 0 )
+            {
+                *pWrite++ = entities[index].mCharacter;
+                return pRead + entities[index].mLength;
+            }
+        }
+    }
+
+    // Unknown entities are kept as they are.
+    *pWrite++ = *pRead;
+    return pRead + 1;
+}
@@ -0,0 +1,132 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TAML_XML_TOKENIZER_H_
+#define _TAML_XML_TOKENIZER_H_
+
+#ifndef _TVECTOR_H_
+#include "collection/vector.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// A streaming XML tokenizer for Taml documents.
+///
+/// The tokenizer works in-place on a caller-owned buffer: names, attribute values and
+/// text are decoded and null-terminated inside the buffer itself so nothing is copied and
+/// every string handed out stays valid for as long as the buffer does.  Consumers pull
+/// one token at a time and can act on each element as soon as its start tag is read.
+///
+/// Only what Taml documents use is supported: elements, attributes, text and CDATA.
+/// Comments, processing instructions and DOCTYPE declarations are skipped.  Text is
+/// condensed the same way TinyXML does so documents read identically with either.
+class TamlXmlTokenizer
+{
+public:
+    enum TokenType
+    {
+        StartElementToken,
+        EndElementToken,
+        TextToken,
+        EndDocumentToken,
+        ErrorToken
+    };
+
+    struct Attribute
+    {
+        const char* mpName;
+        const char* mpValue;
+        U32         mValueOffset;       ///< Offset of the raw value in the buffer.
+        U32         mValueLength;       ///< Length of the raw value in the buffer.
+    };
+
+public:
+    TamlXmlTokenizer();
+    virtual ~TamlXmlTokenizer() {}
+
+    /// Start tokenizing the buffer.  The buffer is modified as it is tokenized.
+    void reset( char* pBuffer, const U32 bufferSize );
+
+    /// Read the next token.  An empty element produces both a start and an end token.
+    TokenType next( void );
+
+    /// Skip the rest of the element whose start token was just read.
+    bool skipElement( void );
+
+    inline TokenType getTokenType( void ) const { return mTokenType; }
+
+    /// Element name for start and end tokens.
+    inline const char* getName( void ) const { return mpName; }
+
+    /// Text for text tokens.
+    inline const char* getText( void ) const { return mpText; }
+
+    /// Attributes for start tokens.
+    inline U32 getAttributeCount( void ) const { return mAttributes.size(); }
+    inline const Attribute& getAttribute( const U32 index ) const { return mAttributes[index]; }
+
+    /// Number of elements currently open, including one whose start token was just read.
+    inline U32 getDepth( void ) const { return mOpenElements.size(); }
+
+    /// Location of the current token.
+    inline S32 getRow( void ) const { return mTokenRow; }
+    inline S32 getColumn( void ) const { return mTokenColumn; }
+
+    /// Error description once an error token has been returned.
+    inline const char* getError( void ) const { return mpError; }
+
+private:
+    TokenType parseStartTag( char* pTag );
+    TokenType parseEndTag( char* pTag );
+    TokenType parseText( char* pText );
+    TokenType parseCData( char* pData );
+    TokenType setError( const char* pError );
+
+    char* skipWhiteSpace( char* pCursor );
+    char* skipPast( char* pCursor, const char* pTerminator );
+    char* decodeEntity( char* pRead, char*& pWrite );
+
+    inline void newLine( const char* pNewLine ) { mRow++; mpLineStart = pNewLine + 1; }
+
+private:
+    char*               mpBuffer;
+    char*               mpBufferEnd;
+    char*               mpCursor;
+
+    TokenType           mTokenType;
+    const char*         mpName;
+    const char*         mpText;
+    const char*         mpError;
+    bool                mTagAtCursor;
+    bool                mEmptyElementPending;
+
+    Vector<Attribute>   mAttributes;
+    Vector<char*>       mAttributeNameEnds;
+    Vector<const char*> mOpenElements;
+
+    S32                 mRow;
+    const char*         mpLineStart;
+    S32                 mTokenRow;
+    S32                 mTokenColumn;
+};
+
+#endif // _TAML_XML_TOKENIZER_H_
@@ -23,8 +23,8 @@
 #ifndef _TAML_XML_VISITOR_H_
 #define _TAML_XML_VISITOR_H_
 
-#ifndef TINYXML_INCLUDED
-#include "persistence/tinyXML/tinyxml.h"
+#ifndef _TAML_XML_TOKENIZER_H_
+#include "persistence/taml/tamlXmlTokenizer.h"
 #endif
 
 //-----------------------------------------------------------------------------
@@ -33,6 +33,64 @@ class TamlXmlParser;
 
 //-----------------------------------------------------------------------------
 
+/// An attribute presented to a visitor.  The name and value point into the document being
+/// parsed and are only valid for the duration of the visit.
+class TamlXmlAttribute
+{
+private:
+    friend class TamlXmlParser;
+
+public:
+    TamlXmlAttribute() :
+        mpParser( NULL ),
+        mpName( NULL ),
+        mpValue( NULL ),
+        mValueOffset( 0 ),
+        mValueLength( 0 ) {}
+
+    inline const char* getName( void ) const { return mpName; }
+    inline const char* getValue( void ) const { return mpValue; }
+
+    /// Change the value.  This is only written if the parser is writing the document.
+    void setValue( const char* pValue );
+
+private:
+    TamlXmlParser*  mpParser;
+    const char*     mpName;
+    const char*     mpValue;
+    U32             mValueOffset;
+    U32             mValueLength;
+};
+
+//-----------------------------------------------------------------------------
+
+/// An element presented to a visitor along with its attributes.
+class TamlXmlElement
+{
+private:
+    friend class TamlXmlParser;
+
+public:
+    TamlXmlElement() :
+        mpName( NULL ),
+        mIsRoot( false ),
+        mpAttributes( NULL ),
+        mAttributeCount( 0 ) {}
+
+    inline const char* getName( void ) const { return mpName; }
+    inline bool isRoot( void ) const { return mIsRoot; }
+    inline U32 getAttributeCount( void ) const { return mAttributeCount; }
+    inline TamlXmlAttribute& getAttribute( const U32 index ) const { AssertFatal( index < mAttributeCount, "TamlXmlElement::getAttribute() - Index out of range." ); return mpAttributes[index]; }
+
+private:
+    const char*         mpName;
+    bool                mIsRoot;
+    TamlXmlAttribute*   mpAttributes;
+    U32                 mAttributeCount;
+};
+
+//-----------------------------------------------------------------------------
+
 class TamlXmlVisitor
 {
 private:
@@ -46,8 +104,9 @@ public:
     virtual bool parse( const char* pFilename ) = 0;
 
 protected:
-    virtual bool visit( TiXmlElement* pXmlElement, TamlXmlParser& xmlParser ) = 0;
-    virtual bool visit( TiXmlAttribute* pAttribute, TamlXmlParser& xmlParser ) = 0;
+    /// Visits stop the parse as soon as one returns false so nothing after it is read.
+    virtual bool visit( TamlXmlElement& xmlElement, TamlXmlParser& xmlParser ) = 0;
+    virtual bool visit( TamlXmlAttribute& xmlAttribute, TamlXmlParser& xmlParser ) = 0;
 };
 
-#endif // _TAML_XML_VISITOR_H_
\ No newline at end of file
+#endif // _TAML_XML_VISITOR_H_
@@ -965,7 +965,7 @@ bool TiXmlDocument::LoadFile( const char* _filename, TiXmlEncoding encoding )
     }
 }
 
-bool TiXmlDocument::LoadFile( FileStream &stream, TiXmlEncoding encoding )
+bool TiXmlDocument::LoadFile( Stream &stream, TiXmlEncoding encoding )
 {
     // Delete the existing data:
     Clear();
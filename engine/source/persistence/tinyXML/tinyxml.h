@@ -1428,7 +1428,7 @@ public:
         will be interpreted as an XML file. TinyXML doesn't stream in XML from the current
         file location. Streaming may be added in the future.
     */
-    bool LoadFile( FileStream& stream, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
+    bool LoadFile( Stream& stream, TiXmlEncoding encoding = TIXML_DEFAULT_ENCODING );
     /// Save a file using the given FILE*. Returns true if successful.
     bool SaveFile( FileStream& stream ) const;
 
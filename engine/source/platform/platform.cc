@@ -31,6 +31,7 @@
 
 S32 sgBackgroundProcessSleepTime = 200;
 S32 sgTimeManagerProcessInterval = 0;
+static bool sgHeadless = false;
 
 
 void Platform::initConsole()
@@ -44,6 +45,16 @@ S32 Platform::getBackgroundSleepTime()
    return sgBackgroundProcessSleepTime;
 }
 
+void Platform::setHeadless( const bool headless )
+{
+   sgHeadless = headless;
+}
+
+bool Platform::isHeadless( void )
+{
+   return sgHeadless;
+}
+
 void Platform::cprintf( const char* str )
 {
     printf( "%s \n", str );
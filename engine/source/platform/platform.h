@@ -152,6 +152,10 @@ struct Platform
     static void restoreWindow();
     static void setMouseLock(bool locked);
 
+    /// Headless (no window, GL context or audio device).
+    static void setHeadless( const bool headless );
+    static bool isHeadless( void );
+
     /// GUI.
     static void AlertOK(const char *windowTitle, const char *message);
     static bool AlertOKCancel(const char *windowTitle, const char *message);
@@ -167,6 +171,7 @@ struct Platform
     static U32 getTime( void );
     static U32 getVirtualMilliseconds( void );
     static U32 getRealMilliseconds( void );
+    static U64 getRealMicroseconds( void );
     static void advanceTime(U32 delta);
     static S32 getBackgroundSleepTime();
     static void getLocalTime(LocalTime &);
@@ -59,6 +59,9 @@ public:
 
 private:
    void *handle;           ///< Pointer to the file handle.
+   void *mapHandle;        ///< Platform specific mapping object, if the platform needs one.
+   void *mapBase;          ///< Base of the read-only view created by map(), or NULL.
+   U32 mapSize;            ///< Size of the mapped view in bytes.
    Status currentStatus;   ///< Current status of the file (Ok, IOError, etc.).
    U32 capability;         ///< Keeps track of file capabilities.
 
@@ -130,6 +133,20 @@ public:
    /// Returns whether or not this file is capable of the given function.
    bool hasCapability(Capability cap) const;
 
+   /// Maps the whole file into memory for reading.
+   ///
+   /// Only files opened for Read can be mapped. The view stays valid until
+   /// unmap() or close() is called; calling map() again returns the same view.
+   ///
+   /// @param size Receives the size of the view in bytes, may be NULL.
+   /// @param copyOnWrite Whether the view may be written to. Written pages become
+   /// private copies and never reach the file. Ignored if the file is already mapped.
+   /// @returns Pointer to the start of the file, or NULL if it could not be mapped.
+   const U8 *map(U32 *size = NULL, bool copyOnWrite = false);
+
+   /// Releases the view created by map(). Safe to call when nothing is mapped.
+   void unmap();
+
 protected:
    Status setStatus();                 ///< Called after error encountered.
    Status setStatus(Status status);    ///< Setter for the current status.
@@ -0,0 +1,1163 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#include "platform/platformNetThread.unix.h"
+
+#ifdef TORQUE_NET_THREAD
+
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "memory/frameAllocator.h"
+#include "debug/traceProfiler.h"
+#include "math/mMathFn.h"
+
+#if defined(TORQUE_NET_THREAD_EPOLL)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#elif defined(TORQUE_NET_THREAD_KQUEUE)
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+
+// Linux suppresses SIGPIPE per send.  OS X and the BSDs set SO_NOSIGPIPE on
+// each stream socket in insert() instead.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+NetThread* gNetThread = NULL;
+
+//-----------------------------------------------------------------------------
+
+/// Network thread state for one socket.
+struct NetThread::SocketEntry
+{
+   NetSocket   socket;
+   U32         type;
+   U32         events;     ///< EventFlags currently registered with the poller.
+   bool        watched;    ///< Registered with the poller.
+   bool        dead;       ///< Failed or disconnected, waiting for the main thread to close it.
+   bool        queued;     ///< In the flush list.
+   Buffer*     sendHead;
+   Buffer*     sendTail;
+   U32         sendOffset; ///< Bytes of sendHead already written.
+
+   SocketEntry(NetSocket s, U32 t)
+   {
+      socket = s;
+      type = t;
+      events = 0;
+      watched = false;
+      dead = false;
+      queued = false;
+      sendHead = NULL;
+      sendTail = NULL;
+      sendOffset = 0;
+   }
+};
+
+//-----------------------------------------------------------------------------
+
+NetThread::BufferPool::BufferPool() :
+   mFree( NULL ),
+   mAllocated( 0 ),
+   mReturned( PoolSize )
+{
+}
+
+NetThread::BufferPool::~BufferPool()
+{
+   Buffer* buffer;
+   while ( mReturned.pop( buffer ) )
+      free( buffer );
+
+   while ( mFree )
+   {
+      buffer = mFree;
+      mFree = buffer->next;
+      delete buffer;
+   }
+}
+
+NetThread::Buffer* NetThread::BufferPool::alloc()
+{
+   Buffer* buffer;
+
+   // Only pick up returned buffers once the private list runs dry.
+   if ( !mFree )
+   {
+      while ( mReturned.pop( buffer ) )
+      {
+         buffer->next = mFree;
+         mFree = buffer;
+      }
+   }
+
+   if ( mFree )
+   {
+      buffer = mFree;
+      mFree = buffer->next;
+   }
+   else if ( mAllocated < PoolSize )
+   {
+      buffer = new Buffer;
+      mAllocated++;
+   }
+   else
+      return NULL;
+
+   buffer->next = NULL;
+   buffer->size = 0;
+   return buffer;
+}
+
+void NetThread::BufferPool::free( Buffer* buffer )
+{
+   buffer->next = mFree;
+   mFree = buffer;
+}
+
+void NetThread::BufferPool::release( Buffer* buffer )
+{
+   // The queue holds every buffer the pool can allocate so this cannot fail.
+   const bool released = mReturned.push( buffer );
+   AssertFatal( released, "NetThread::BufferPool::release() - Buffer released twice." );
+}
+
+bool NetThread::BufferPool::canAlloc()
+{
+   return mFree || mAllocated < PoolSize || !mReturned.isEmpty();
+}
+
+//-----------------------------------------------------------------------------
+
+NetThread::NetThread() :
+   Thread( 0, NULL, false ),
+   mPoller( -1 ),
+   mWake( -1 ),
+   mWakeSignal( -1 ),
+   mRunning( false ),
+   mCommands( QueueSize ),
+   mMessages( QueueSize )
+{
+}
+
+NetThread::~NetThread()
+{
+   stopThread();
+}
+
+bool NetThread::startThread()
+{
+   if ( mRunning )
+      return true;
+
+   if ( !createPoller() )
+   {
+      Con::errorf( "NetThread::startThread() - Unable to create poller: %s", strerror( errno ) );
+      destroyPoller();
+      return false;
+   }
+
+   mRunning = true;
+   start();
+   return true;
+}
+
+void NetThread::stopThread()
+{
+   if ( !mRunning )
+      return;
+
+   stop();
+   wake();
+   join();
+   mRunning = false;
+
+   // The thread has closed its sockets, including any it accepted.  Reclaim
+   // anything still in flight.
+   Command command;
+   while ( mCommands.pop( command ) )
+   {
+      if ( command.type == AddSocket )
+         ::close( command.socket );
+
+      while ( command.buffer )
+      {
+         Buffer* next = command.buffer->next;
+         mSendPool.free( command.buffer );
+         command.buffer = next;
+      }
+   }
+
+   Message message;
+   while ( mMessages.pop( message ) )
+   {
+      if ( message.buffer )
+         mReceivePool.free( message.buffer );
+   }
+
+   destroyPoller();
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined(TORQUE_NET_THREAD_EPOLL)
+
+bool NetThread::createPoller()
+{
+   mPoller = epoll_create1( EPOLL_CLOEXEC );
+   mWake = mWakeSignal = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+   if ( mPoller == -1 || mWake == -1 )
+      return false;
+
+   // The wake event is the only one without an entry.
+   epoll_event event;
+   event.events = EPOLLIN;
+   event.data.ptr = NULL;
+   return epoll_ctl( mPoller, EPOLL_CTL_ADD, mWake, &event ) == 0;
+}
+
+bool NetThread::setEvents( SocketEntry* entry, U32 events )
+{
+   epoll_event event;
+   event.events = 0;
+   if ( events & EventRead )
+      event.events |= EPOLLIN;
+   if ( events & EventWrite )
+      event.events |= EPOLLOUT;
+   event.data.ptr = entry;
+   return epoll_ctl( mPoller, entry->watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, entry->socket, &event ) == 0;
+}
+
+void NetThread::removeEvents( SocketEntry* entry )
+{
+   epoll_ctl( mPoller, EPOLL_CTL_DEL, entry->socket, NULL );
+}
+
+S32 NetThread::waitEvents( Event* events, S32 maxEvents, S32 timeoutMS )
+{
+   epoll_event polled[64];
+   const S32 count = epoll_wait( mPoller, polled, getMin( maxEvents, 64 ), timeoutMS );
+
+   for ( S32 index = 0; index < count; index++ )
+   {
+      const U32 flags = polled[index].events;
+      events[index].entry = (SocketEntry*)polled[index].data.ptr;
+      events[index].flags = 0;
+      if ( flags & EPOLLIN )
+         events[index].flags |= EventRead;
+      if ( flags & EPOLLOUT )
+         events[index].flags |= EventWrite;
+      if ( flags & ( EPOLLERR | EPOLLHUP ) )
+         events[index].flags |= EventHangup;
+   }
+
+   return count;
+}
+
+#elif defined(TORQUE_NET_THREAD_KQUEUE)
+
+bool NetThread::createPoller()
+{
+   mPoller = kqueue();
+   if ( mPoller == -1 )
+      return false;
+
+   fcntl( mPoller, F_SETFD, FD_CLOEXEC );
+
+   // There is no eventfd, so wake through a pipe.
+   S32 wakePipe[2];
+   if ( pipe( wakePipe ) == -1 )
+      return false;
+
+   mWake = wakePipe[0];
+   mWakeSignal = wakePipe[1];
+   for ( U32 index = 0; index < 2; index++ )
+   {
+      fcntl( wakePipe[index], F_SETFL, fcntl( wakePipe[index], F_GETFL ) | O_NONBLOCK );
+      fcntl( wakePipe[index], F_SETFD, FD_CLOEXEC );
+   }
+
+   // The wake event is the only one without an entry.
+   struct kevent change;
+   EV_SET( &change, mWake, EVFILT_READ, EV_ADD | EV_ENABLE, 0, 0, NULL );
+   return kevent( mPoller, &change, 1, NULL, 0, NULL ) == 0;
+}
+
+bool NetThread::setEvents( SocketEntry* entry, U32 events )
+{
+   // kqueue tracks each filter separately, so only submit the ones that changed.
+   const U32 current = entry->watched ? entry->events : 0;
+
+   struct kevent changes[2];
+   S32 count = 0;
+   if ( ( events ^ current ) & EventRead )
+   {
+      EV_SET( &changes[count], entry->socket, EVFILT_READ, ( events & EventRead ) ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, entry );
+      count++;
+   }
+   if ( ( events ^ current ) & EventWrite )
+   {
+      EV_SET( &changes[count], entry->socket, EVFILT_WRITE, ( events & EventWrite ) ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, entry );
+      count++;
+   }
+
+   return count == 0 || kevent( mPoller, changes, count, NULL, 0, NULL ) == 0;
+}
+
+void NetThread::removeEvents( SocketEntry* entry )
+{
+   struct kevent changes[2];
+   S32 count = 0;
+   if ( entry->events & EventRead )
+   {
+      EV_SET( &changes[count], entry->socket, EVFILT_READ, EV_DELETE, 0, 0, NULL );
+      count++;
+   }
+   if ( entry->events & EventWrite )
+   {
+      EV_SET( &changes[count], entry->socket, EVFILT_WRITE, EV_DELETE, 0, 0, NULL );
+      count++;
+   }
+
+   if ( count )
+      kevent( mPoller, changes, count, NULL, 0, NULL );
+}
+
+S32 NetThread::waitEvents( Event* events, S32 maxEvents, S32 timeoutMS )
+{
+   struct kevent polled[64];
+   struct timespec timeout;
+   timeout.tv_sec = timeoutMS / 1000;
+   timeout.tv_nsec = ( timeoutMS % 1000 ) * 1000000;
+
+   const S32 count = kevent( mPoller, NULL, 0, polled, getMin( maxEvents, 64 ), &timeout );
+
+   // Readable and writable arrive as separate events for the same socket.
+   for ( S32 index = 0; index < count; index++ )
+   {
+      events[index].entry = (SocketEntry*)polled[index].udata;
+      events[index].flags = 0;
+      if ( polled[index].filter == EVFILT_READ )
+         events[index].flags |= EventRead;
+      else if ( polled[index].filter == EVFILT_WRITE )
+         events[index].flags |= EventWrite;
+      if ( polled[index].flags & ( EV_EOF | EV_ERROR ) )
+         events[index].flags |= EventHangup;
+   }
+
+   return count;
+}
+
+#endif
+
+void NetThread::destroyPoller()
+{
+   if ( mPoller != -1 )
+      ::close( mPoller );
+   if ( mWake != -1 )
+      ::close( mWake );
+   if ( mWakeSignal != -1 && mWakeSignal != mWake )
+      ::close( mWakeSignal );
+   mPoller = mWake = mWakeSignal = -1;
+}
+
+//-----------------------------------------------------------------------------
+
+void NetThread::wake()
+{
+   // An eventfd takes exactly eight bytes.  A full wake pipe is already signalled.
+   const U64 count = 1;
+   ssize_t written = ::write( mWakeSignal, &count, sizeof( count ) );
+   (void)written;
+}
+
+void NetThread::pushCommand( const Command& command )
+{
+   while ( !mCommands.push( command ) )
+   {
+      wake();
+      Platform::sleep( 1 );
+   }
+
+   wake();
+}
+
+void NetThread::addSocket( NetSocket socket, SocketType type )
+{
+   Command command;
+   command.type = AddSocket;
+   command.socket = socket;
+   command.socketType = type;
+   command.buffer = NULL;
+   pushCommand( command );
+}
+
+void NetThread::closeSocket( NetSocket socket )
+{
+   Command command;
+   command.type = CloseSocket;
+   command.socket = socket;
+   command.socketType = 0;
+   command.buffer = NULL;
+   pushCommand( command );
+}
+
+bool NetThread::send( NetSocket socket, const U8* data, U32 size )
+{
+   Command command;
+   command.type = SendData;
+   command.socket = socket;
+   command.socketType = 0;
+
+   U32 waitStart = 0;
+   while ( size > 0 )
+   {
+      // Chain as many buffers as the pool allows into one command.
+      Buffer* head = NULL;
+      Buffer* tail = NULL;
+      while ( size > 0 )
+      {
+         Buffer* buffer = mSendPool.alloc();
+         if ( !buffer )
+            break;
+
+         buffer->size = getMin( size, (U32)MaxPacketDataSize );
+         dMemcpy( buffer->data, data, buffer->size );
+         data += buffer->size;
+         size -= buffer->size;
+
+         if ( tail )
+            tail->next = buffer;
+         else
+            head = buffer;
+         tail = buffer;
+      }
+
+      if ( head )
+      {
+         command.buffer = head;
+         pushCommand( command );
+         waitStart = 0;
+         continue;
+      }
+
+      // Every buffer is queued on a socket.  Wait for the thread to drain some.
+      const U32 time = Platform::getRealMilliseconds();
+      if ( !waitStart )
+         waitStart = time;
+      else if ( time - waitStart > SendTimeoutMS )
+      {
+         Con::warnf( "NetThread::send() - Send pool exhausted, dropped %d bytes.", size );
+         return false;
+      }
+
+      wake();
+      Platform::sleep( 1 );
+   }
+
+   return true;
+}
+
+bool NetThread::popMessage( Message& message )
+{
+   return mMessages.pop( message );
+}
+
+//-----------------------------------------------------------------------------
+
+bool NetThread::postMessage( const Message& message )
+{
+   while ( !mMessages.push( message ) )
+   {
+      if ( checkForStop() )
+         return false;
+      Platform::sleep( 1 );
+   }
+
+   return true;
+}
+
+bool NetThread::hasRoom( U32 messages )
+{
+   // size() can only overestimate from the producer side.
+   return mMessages.capacity() - mMessages.size() > messages;
+}
+
+NetThread::SocketEntry* NetThread::lookup( NetSocket socket )
+{
+   if ( socket < 0 || socket >= (NetSocket)mSockets.size() )
+      return NULL;
+
+   return mSockets[socket];
+}
+
+void NetThread::insert( SocketEntry* entry )
+{
+   if ( entry->socket >= (NetSocket)mSockets.size() )
+   {
+      const U32 oldSize = mSockets.size();
+      mSockets.setSize( entry->socket + 1 );
+      for ( U32 index = oldSize; index < (U32)mSockets.size(); index++ )
+         mSockets[index] = NULL;
+   }
+
+   mSockets[entry->socket] = entry;
+
+#ifdef SO_NOSIGPIPE
+   // A peer reset must not raise SIGPIPE on the network thread.
+   if ( entry->type == Stream || entry->type == Connecting )
+   {
+      const S32 noSigPipe = 1;
+      setsockopt( entry->socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof( noSigPipe ) );
+   }
+#endif
+
+   watch( entry );
+}
+
+void NetThread::watch( SocketEntry* entry )
+{
+   if ( entry->dead )
+      return;
+
+   U32 events = EventRead;
+   if ( entry->type == Connecting )
+      events = EventWrite;
+   else if ( entry->type == Stream && entry->sendHead )
+      events |= EventWrite;
+
+   if ( entry->watched && events == entry->events )
+      return;
+
+   if ( !setEvents( entry, events ) )
+   {
+      Con::errorf( "NetThread::watch() - Unable to watch socket %d: %s", entry->socket, strerror( errno ) );
+      disconnect( entry );
+      return;
+   }
+
+   entry->watched = true;
+   entry->events = events;
+}
+
+void NetThread::releaseSends( SocketEntry* entry )
+{
+   while ( entry->sendHead )
+   {
+      Buffer* next = entry->sendHead->next;
+      mSendPool.release( entry->sendHead );
+      entry->sendHead = next;
+   }
+
+   entry->sendTail = NULL;
+   entry->sendOffset = 0;
+}
+
+void NetThread::disconnect( SocketEntry* entry )
+{
+   if ( entry->dead )
+      return;
+
+   if ( entry->watched )
+      removeEvents( entry );
+
+   entry->watched = false;
+   entry->dead = true;
+   releaseSends( entry );
+
+   Message message;
+   dMemset( &message, 0, sizeof( message ) );
+   message.type = entry->type == Connecting ? ConnectFailed : Disconnected;
+   message.socket = entry->socket;
+   postMessage( message );
+}
+
+//-----------------------------------------------------------------------------
+
+void NetThread::processCommands()
+{
+   Command command;
+   while ( mCommands.pop( command ) )
+   {
+      SocketEntry* entry = lookup( command.socket );
+
+      switch ( command.type )
+      {
+      case AddSocket:
+         {
+            AssertFatal( !entry, "NetThread::processCommands() - Socket added twice." );
+            insert( new SocketEntry( command.socket, command.socketType ) );
+         }
+         break;
+
+      case SendData:
+         if ( !entry || entry->dead || ( entry->type != Stream && entry->type != Connecting ) )
+         {
+            while ( command.buffer )
+            {
+               Buffer* next = command.buffer->next;
+               mSendPool.release( command.buffer );
+               command.buffer = next;
+            }
+            break;
+         }
+
+         if ( entry->sendTail )
+            entry->sendTail->next = command.buffer;
+         else
+            entry->sendHead = command.buffer;
+
+         for ( entry->sendTail = command.buffer; entry->sendTail->next; entry->sendTail = entry->sendTail->next )
+            ;
+
+         // Flush once every queued command has been read so sends batch up.
+         if ( !entry->queued )
+         {
+            entry->queued = true;
+            mFlush.push_back( entry );
+         }
+         break;
+
+      case CloseSocket:
+         if ( entry )
+         {
+            // Data sent before the close still goes out if the socket will take it.
+            if ( entry->queued )
+            {
+               flush( entry );
+               mFlush.erase( mFlush.find_next( entry ) );
+            }
+
+            if ( entry->watched )
+               removeEvents( entry );
+
+            releaseSends( entry );
+            mSockets[command.socket] = NULL;
+            delete entry;
+         }
+
+         ::close( command.socket );
+
+         {
+            Message message;
+            dMemset( &message, 0, sizeof( message ) );
+            message.type = Closed;
+            message.socket = command.socket;
+            postMessage( message );
+         }
+         break;
+      }
+   }
+
+   for ( U32 index = 0; index < (U32)mFlush.size(); index++ )
+   {
+      mFlush[index]->queued = false;
+      flush( mFlush[index] );
+   }
+   mFlush.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+bool NetThread::receivePackets( SocketEntry* entry )
+{
+   for ( ;; )
+   {
+      if ( !hasRoom( 1 ) )
+         return false;
+
+      Buffer* buffer = mReceivePool.alloc();
+      if ( !buffer )
+         return false;
+
+      Message message;
+      socklen_t addressSize = sizeof( message.address );
+      const ssize_t bytesRead = ::recvfrom( entry->socket, buffer->data, MaxPacketDataSize, 0, &message.address, &addressSize );
+      if ( bytesRead <= 0 )
+      {
+         mReceivePool.free( buffer );
+         if ( bytesRead == -1 && errno != EINTR )
+            return true;
+         continue;
+      }
+
+      buffer->size = bytesRead;
+      message.type = PacketReceived;
+      message.socket = entry->socket;
+      message.incoming = InvalidSocket;
+      message.buffer = buffer;
+      if ( !postMessage( message ) )
+      {
+         mReceivePool.free( buffer );
+         return true;
+      }
+   }
+}
+
+bool NetThread::receiveStream( SocketEntry* entry )
+{
+   Buffer* buffers[ReadBatch];
+   iovec vectors[ReadBatch];
+
+   for ( ;; )
+   {
+      // Leave room for a Disconnected message after a full batch.
+      if ( !hasRoom( ReadBatch + 1 ) )
+         return false;
+
+      U32 count = 0;
+      while ( count < ReadBatch )
+      {
+         buffers[count] = mReceivePool.alloc();
+         if ( !buffers[count] )
+            break;
+
+         vectors[count].iov_base = buffers[count]->data;
+         vectors[count].iov_len = MaxPacketDataSize;
+         count++;
+      }
+
+      if ( count == 0 )
+         return false;
+
+      const ssize_t bytesRead = ::readv( entry->socket, vectors, count );
+
+      // Hand over the filled buffers, one receive event each.
+      U32 used = 0;
+      U32 remaining = bytesRead > 0 ? (U32)bytesRead : 0;
+      for ( ; used < count && remaining > 0; used++ )
+      {
+         Message message;
+         dMemset( &message, 0, sizeof( message ) );
+         message.type = DataReceived;
+         message.socket = entry->socket;
+         message.buffer = buffers[used];
+         message.buffer->size = getMin( remaining, (U32)MaxPacketDataSize );
+         remaining -= message.buffer->size;
+         if ( !postMessage( message ) )
+            mReceivePool.free( buffers[used] );
+      }
+
+      for ( U32 index = used; index < count; index++ )
+         mReceivePool.free( buffers[index] );
+
+      if ( bytesRead == 0 )
+      {
+         // Orderly shutdown by the peer.
+         disconnect( entry );
+         return true;
+      }
+
+      if ( bytesRead == -1 )
+      {
+         if ( errno == EINTR )
+            continue;
+
+         if ( errno != EAGAIN && errno != EWOULDBLOCK )
+         {
+            Con::errorf( "NetThread::receiveStream() - Error reading from socket %d: %s", entry->socket, strerror( errno ) );
+            disconnect( entry );
+         }
+         return true;
+      }
+
+      // A short read means the socket is drained.
+      if ( (U32)bytesRead < count * MaxPacketDataSize )
+         return true;
+   }
+}
+
+bool NetThread::acceptConnections( SocketEntry* entry )
+{
+   for ( ;; )
+   {
+      if ( !hasRoom( 1 ) )
+         return false;
+
+      Message message;
+      dMemset( &message, 0, sizeof( message ) );
+      socklen_t addressSize = sizeof( message.address );
+#if defined(TORQUE_NET_THREAD_EPOLL)
+      const NetSocket incoming = ::accept4( entry->socket, &message.address, &addressSize, SOCK_NONBLOCK | SOCK_CLOEXEC );
+      if ( incoming == InvalidSocket )
+         return true;
+#else
+      const NetSocket incoming = ::accept( entry->socket, &message.address, &addressSize );
+      if ( incoming == InvalidSocket )
+         return true;
+
+      fcntl( incoming, F_SETFL, fcntl( incoming, F_GETFL ) | O_NONBLOCK );
+      fcntl( incoming, F_SETFD, FD_CLOEXEC );
+#endif
+
+      message.type = Accepted;
+      message.socket = entry->socket;
+      message.incoming = incoming;
+      if ( !postMessage( message ) )
+      {
+         ::close( incoming );
+         return true;
+      }
+
+      // Start receiving straight away.  The main thread learns of the
+      // socket from the Accepted message, which arrives before any data.
+      insert( new SocketEntry( incoming, Stream ) );
+   }
+}
+
+void NetThread::finishConnect( SocketEntry* entry )
+{
+   S32 error = 0;
+   socklen_t errorSize = sizeof( error );
+   if ( getsockopt( entry->socket, SOL_SOCKET, SO_ERROR, &error, &errorSize ) == -1 || error != 0 )
+   {
+      Con::errorf( "NetThread::finishConnect() - Error connecting socket %d: %s", entry->socket, strerror( error ? error : errno ) );
+      disconnect( entry );
+      return;
+   }
+
+   entry->type = Stream;
+
+   Message message;
+   dMemset( &message, 0, sizeof( message ) );
+   message.type = Connected;
+   message.socket = entry->socket;
+   postMessage( message );
+
+   // Anything sent while connecting can go now.
+   flush( entry );
+   watch( entry );
+}
+
+void NetThread::flush( SocketEntry* entry )
+{
+   if ( entry->dead || entry->type != Stream )
+      return;
+
+   iovec vectors[WriteBatch];
+
+   while ( entry->sendHead )
+   {
+      U32 count = 0;
+      U32 total = 0;
+      U32 offset = entry->sendOffset;
+      for ( Buffer* buffer = entry->sendHead; buffer && count < WriteBatch; buffer = buffer->next )
+      {
+         vectors[count].iov_base = buffer->data + offset;
+         vectors[count].iov_len = buffer->size - offset;
+         total += buffer->size - offset;
+         offset = 0;
+         count++;
+      }
+
+      // sendmsg is writev with flags, and a peer reset must not raise SIGPIPE.
+      // MSG_NOSIGNAL is zero where SO_NOSIGPIPE is used instead.
+      msghdr header;
+      dMemset( &header, 0, sizeof( header ) );
+      header.msg_iov = vectors;
+      header.msg_iovlen = count;
+
+      const ssize_t bytesSent = ::sendmsg( entry->socket, &header, MSG_NOSIGNAL | MSG_DONTWAIT );
+      if ( bytesSent == -1 )
+      {
+         if ( errno == EINTR )
+            continue;
+
+         if ( errno != EAGAIN && errno != EWOULDBLOCK )
+         {
+            Con::errorf( "NetThread::flush() - Error sending on socket %d: %s", entry->socket, strerror( errno ) );
+            disconnect( entry );
+            return;
+         }
+         break;
+      }
+
+      // Release everything that went out completely.
+      U32 remaining = (U32)bytesSent;
+      while ( entry->sendHead && remaining >= entry->sendHead->size - entry->sendOffset )
+      {
+         remaining -= entry->sendHead->size - entry->sendOffset;
+         Buffer* next = entry->sendHead->next;
+         mSendPool.release( entry->sendHead );
+         entry->sendHead = next;
+         entry->sendOffset = 0;
+      }
+
+      if ( !entry->sendHead )
+         entry->sendTail = NULL;
+      else
+         entry->sendOffset += remaining;
+
+      // A short write means the socket buffer is full.
+      if ( (U32)bytesSent < total )
+         break;
+   }
+
+   // Wait for the socket to become writable again if anything is left.
+   watch( entry );
+}
+
+//-----------------------------------------------------------------------------
+
+void NetThread::run( void* arg )
+{
+   Event events[64];
+   bool stalled = false;
+
+   while ( !checkForStop() )
+   {
+      processCommands();
+
+      // Readable sockets are left unread while the message queue or receive
+      // pool is full.  They stay readable, so back off instead of spinning.
+      if ( stalled )
+         Platform::sleep( 1 );
+
+      const S32 count = waitEvents( events, 64, stalled ? 0 : WaitMS );
+      stalled = false;
+
+      for ( S32 index = 0; index < count; index++ )
+      {
+         SocketEntry* entry = events[index].entry;
+         if ( !entry )
+         {
+            // One read resets an eventfd.  A pipe may hold several wakes.
+            U64 value[8];
+            while ( ::read( mWake, value, sizeof( value ) ) > 0 )
+               ;
+            continue;
+         }
+
+         if ( entry->dead )
+            continue;
+
+         const U32 flags = events[index].flags;
+         switch ( entry->type )
+         {
+         case Connecting:
+            finishConnect( entry );
+            break;
+
+         case Datagram:
+            stalled |= !receivePackets( entry );
+            break;
+
+         case Listen:
+            stalled |= !acceptConnections( entry );
+            break;
+
+         case Stream:
+            if ( flags & EventWrite )
+               flush( entry );
+            if ( !entry->dead && ( flags & ( EventRead | EventHangup ) ) )
+               stalled |= !receiveStream( entry );
+            break;
+         }
+      }
+   }
+
+   // Close everything still open.  The main thread is waiting in stopThread()
+   // so there is nobody to tell.
+   for ( U32 index = 0; index < (U32)mSockets.size(); index++ )
+   {
+      SocketEntry* entry = mSockets[index];
+      if ( !entry )
+         continue;
+
+      releaseSends( entry );
+      ::close( entry->socket );
+      delete entry;
+      mSockets[index] = NULL;
+   }
+
+   mSockets.clear();
+   mFlush.clear();
+
+   FrameAllocator::releaseThread();
+   TraceProfiler::releaseThread();
+}
+
+//-----------------------------------------------------------------------------
+
+F32 NetThread::loopbackBenchmark( U32 total, U32 sendSize )
+{
+   if ( !mRunning || total == 0 || sendSize == 0 )
+      return 0.0f;
+
+   // Connect a pair of sockets over loopback.
+   sockaddr_in address;
+   socklen_t addressSize = sizeof( address );
+   dMemset( &address, 0, sizeof( address ) );
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+   NetSocket listener = ::socket( AF_INET, SOCK_STREAM, 0 );
+   NetSocket client = ::socket( AF_INET, SOCK_STREAM, 0 );
+   NetSocket server = InvalidSocket;
+   if ( listener != InvalidSocket && client != InvalidSocket &&
+        ::bind( listener, (sockaddr*)&address, sizeof( address ) ) == 0 &&
+        ::listen( listener, 1 ) == 0 &&
+        ::getsockname( listener, (sockaddr*)&address, &addressSize ) == 0 &&
+        ::connect( client, (sockaddr*)&address, sizeof( address ) ) == 0 )
+      server = ::accept( listener, NULL, NULL );
+
+   if ( listener != InvalidSocket )
+      ::close( listener );
+   if ( server == InvalidSocket )
+   {
+      Con::errorf( "NetThread::loopbackBenchmark() - Unable to connect over loopback: %s", strerror( errno ) );
+      if ( client != InvalidSocket )
+         ::close( client );
+      return 0.0f;
+   }
+
+   fcntl( client, F_SETFL, fcntl( client, F_GETFL ) | O_NONBLOCK );
+   fcntl( server, F_SETFL, fcntl( server, F_GETFL ) | O_NONBLOCK );
+   addSocket( client, Stream );
+   addSocket( server, Stream );
+
+   U8* payload = new U8[sendSize];
+   for ( U32 index = 0; index < sendSize; index++ )
+      payload[index] = U8( index );
+
+   // Keep a bounded amount in flight so the send pool never runs dry.  Each
+   // send takes at least one buffer however small it is.
+   const U32 window = getMin( U32( 1 << 20 ), U32( PoolSize / 2 ) * getMin( sendSize, (U32)MaxPacketDataSize ) );
+   U32 sent = 0;
+   U32 received = 0;
+   U32 receiveEvents = 0;
+   bool failed = false;
+   const U32 start = Platform::getRealMilliseconds();
+
+   while ( !failed && received < total )
+   {
+      while ( sent < total && sent - received < window )
+      {
+         const U32 size = getMin( sendSize, total - sent );
+         if ( !send( client, payload, size ) )
+         {
+            failed = true;
+            break;
+         }
+         sent += size;
+      }
+
+      bool idle = true;
+      Message message;
+      while ( popMessage( message ) )
+      {
+         idle = false;
+         if ( message.type == DataReceived && message.socket == server )
+         {
+            // Every send but the last is sendSize long, so the pattern
+            // restarts at each multiple of it.
+            for ( U32 index = 0; index < message.buffer->size && !failed; index++ )
+            {
+               if ( message.buffer->data[index] != U8( ( received + index ) % sendSize ) )
+               {
+                  Con::errorf( "NetThread::loopbackBenchmark() - Data corrupted at byte %d.", received + index );
+                  failed = true;
+               }
+            }
+
+            received += message.buffer->size;
+            receiveEvents++;
+         }
+         else
+            failed = true;
+
+         if ( message.buffer )
+            releaseBuffer( message.buffer );
+      }
+
+      if ( idle && Platform::getRealMilliseconds() - start > 60000 )
+      {
+         Con::errorf( "NetThread::loopbackBenchmark() - Timed out after %d of %d bytes.", received, total );
+         failed = true;
+      }
+   }
+
+   const U32 elapsed = getMax( Platform::getRealMilliseconds() - start, U32( 1 ) );
+   delete [] payload;
+
+   // Wait for both sockets to be released so none of their messages are left behind.
+   closeSocket( client );
+   closeSocket( server );
+   for ( U32 closed = 0; closed < 2; )
+   {
+      Message message;
+      if ( !popMessage( message ) )
+      {
+         Platform::sleep( 1 );
+         continue;
+      }
+
+      if ( message.type == Closed )
+         closed++;
+      if ( message.buffer )
+         releaseBuffer( message.buffer );
+   }
+
+   if ( failed )
+      return 0.0f;
+
+   const F32 megabytesPerSecond = ( F32( total ) / F32( 1 << 20 ) ) / ( F32( elapsed ) / 1000.0f );
+   Con::printf( "NetThread::loopbackBenchmark() - %d bytes in %d ms: %.1f MB/s, %d receive events of %.0f bytes on average.",
+      total, elapsed, megabytesPerSecond, receiveEvents, F32( received ) / F32( getMax( receiveEvents, U32( 1 ) ) ) );
+   return megabytesPerSecond;
+}
+
+//-----------------------------------------------------------------------------
+
+ConsoleFunction( netLoopbackBenchmark, F32, 1, 3, "([megabytes = 64], [sendSize = 4096]) Streams data through a loopback TCP connection serviced by a network thread.\n"
+                 "@param megabytes How much data to send.\n"
+                 "@param sendSize The bytes passed to each send.\n"
+                 "@return The throughput in megabytes per second, or zero on failure." )
+{
+   const U32 total = U32( argc > 1 ? getMax( dAtoi( argv[1] ), 1 ) : 64 ) << 20;
+   const U32 sendSize = argc > 2 ? mClamp( dAtoi( argv[2] ), 1, 1 << 20 ) : 4096;
+
+   // A private thread keeps the game's own sockets out of the measurement.
+   NetThread thread;
+   if ( !thread.startThread() )
+   {
+      Con::errorf( "netLoopbackBenchmark - Unable to start a network thread." );
+      return 0.0f;
+   }
+
+   const F32 megabytesPerSecond = thread.loopbackBenchmark( total, sendSize );
+   thread.stopThread();
+   return megabytesPerSecond;
+}
+
+#endif // TORQUE_NET_THREAD
@@ -0,0 +1,256 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _PLATFORM_NET_THREAD_UNIX_H_
+#define _PLATFORM_NET_THREAD_UNIX_H_
+
+#include "platform/platform.h"
+#include "platform/event.h"
+#include "platform/threads/thread.h"
+#include "platform/threads/lockFreeQueue.h"
+
+// The network thread waits on epoll on linux and kqueue on OS X and the BSDs.
+// Other unix platforms keep polling their sockets once per frame in
+// Net::process().
+#if defined(__linux__)
+#define TORQUE_NET_THREAD
+#define TORQUE_NET_THREAD_EPOLL
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
+#define TORQUE_NET_THREAD
+#define TORQUE_NET_THREAD_KQUEUE
+#endif
+
+#ifdef TORQUE_NET_THREAD
+
+#include <sys/socket.h>
+
+//-----------------------------------------------------------------------------
+
+/// Services every game socket from a single thread waiting on epoll or kqueue.
+///
+/// The main thread registers sockets and queues outgoing data through
+/// commands.  The network thread receives into pooled buffers and hands the
+/// results back as messages, which Net::process() turns into game events.
+/// Both directions use single producer, single consumer lock-free queues so
+/// neither thread ever waits on the other unless a queue or pool is full.
+///
+/// Only the network thread touches a socket once it has been added, until the
+/// main thread closes it and receives the Closed message back.
+class NetThread : public Thread
+{
+public:
+   enum Constants
+   {
+      PoolSize = 2048,        ///< Buffers in each pool.
+      QueueSize = 4096,       ///< Entries in each queue.
+      ReadBatch = 16,         ///< Buffers filled per readv call.
+      WriteBatch = 64,        ///< Buffers sent per sendmsg call.
+      WaitMS = 100,           ///< Longest the thread sleeps waiting for events.
+      SendTimeoutMS = 10000,  ///< Longest send() waits for a free buffer.
+   };
+
+   /// How the network thread services a socket.
+   enum SocketType
+   {
+      Datagram,               ///< Unconnected UDP or IPX port.
+      Stream,                 ///< Connected TCP socket.
+      Connecting,             ///< TCP socket with a connect in progress.
+      Listen,                 ///< TCP socket accepting connections.
+   };
+
+   enum MessageType
+   {
+      PacketReceived,         ///< A datagram arrived from address.
+      DataReceived,           ///< Stream data arrived.
+      Accepted,               ///< A listen socket accepted incoming from address.
+      Connected,              ///< A pending connect completed.
+      ConnectFailed,          ///< A pending connect failed.
+      Disconnected,           ///< The peer closed the stream or it errored.
+      Closed,                 ///< A socket closed by closeSocket() has been released.
+   };
+
+   /// A pooled buffer.  One buffer holds one packet or one receive event worth of stream data.
+   struct Buffer
+   {
+      Buffer*  next;
+      U32      size;
+      U8       data[MaxPacketDataSize];
+   };
+
+   struct Message
+   {
+      U32         type;
+      NetSocket   socket;
+      NetSocket   incoming;
+      sockaddr    address;
+      Buffer*     buffer;
+   };
+
+private:
+   /// A pool of buffers allocated on one thread and released on the other.
+   ///
+   /// The allocating thread keeps a private free list and only drains the
+   /// returned queue once that runs dry.
+   class BufferPool
+   {
+      Buffer*                          mFree;
+      U32                              mAllocated;
+      LockFreeSPSCQueue<Buffer*>       mReturned;
+
+   public:
+      BufferPool();
+      ~BufferPool();
+
+      /// Allocating thread: take a buffer.
+      /// @return NULL if all PoolSize buffers are in use.
+      Buffer* alloc();
+
+      /// Allocating thread: give back a buffer that was never handed over.
+      void free(Buffer* buffer);
+
+      /// Other thread: give back a buffer.
+      void release(Buffer* buffer);
+
+      /// Allocating thread: true if alloc() can succeed without waiting.
+      bool canAlloc();
+   };
+
+   enum CommandType
+   {
+      AddSocket,
+      CloseSocket,
+      SendData,
+   };
+
+   struct Command
+   {
+      U32         type;
+      NetSocket   socket;
+      U32         socketType;
+      Buffer*     buffer;
+   };
+
+   struct SocketEntry;
+
+   /// Socket readiness, translated from the epoll or kqueue flags.
+   enum EventFlags
+   {
+      EventRead = BIT(0),
+      EventWrite = BIT(1),
+      EventHangup = BIT(2),
+   };
+
+   struct Event
+   {
+      SocketEntry*   entry;   ///< NULL for the wake descriptor.
+      U32            flags;
+   };
+
+   S32                              mPoller;       ///< The epoll set or kqueue.
+   S32                              mWake;         ///< Read end of the wake descriptor.
+   S32                              mWakeSignal;   ///< Write end of the wake descriptor.
+   bool                             mRunning;
+
+   LockFreeSPSCQueue<Command>       mCommands;
+   LockFreeSPSCQueue<Message>       mMessages;
+   BufferPool                       mReceivePool;  ///< Allocated by the network thread.
+   BufferPool                       mSendPool;     ///< Allocated by the main thread.
+
+   /// Network thread state, indexed by socket.
+   Vector<SocketEntry*>             mSockets;
+   Vector<SocketEntry*>             mFlush;
+
+   void wake();
+   void pushCommand(const Command& command);
+
+   // Poller backend.
+   bool createPoller();
+   void destroyPoller();
+   bool setEvents(SocketEntry* entry, U32 events);
+   void removeEvents(SocketEntry* entry);
+   S32 waitEvents(Event* events, S32 maxEvents, S32 timeoutMS);
+
+   // Network thread.
+   bool postMessage(const Message& message);
+   bool hasRoom(U32 messages);
+   void processCommands();
+   SocketEntry* lookup(NetSocket socket);
+   void insert(SocketEntry* entry);
+   void watch(SocketEntry* entry);
+   void releaseSends(SocketEntry* entry);
+   void disconnect(SocketEntry* entry);
+   void finishConnect(SocketEntry* entry);
+   void flush(SocketEntry* entry);
+
+   /// Receive handlers return false when they stopped early because the
+   /// message queue or receive pool is full.
+   bool receivePackets(SocketEntry* entry);
+   bool receiveStream(SocketEntry* entry);
+   bool acceptConnections(SocketEntry* entry);
+
+public:
+   NetThread();
+   ~NetThread();
+
+   /// Create the poller and start the thread.
+   bool startThread();
+
+   /// Stop the thread and close every socket it still owns.
+   void stopThread();
+
+   bool isRunning() const { return mRunning; }
+
+   /// Hand a non-blocking socket to the network thread.
+   void addSocket(NetSocket socket, SocketType type);
+
+   /// Close a socket owned by the network thread.  Messages for the socket
+   /// may still arrive until the Closed message for it is returned.
+   void closeSocket(NetSocket socket);
+
+   /// Queue data to send on a stream socket.  Sends queued before the
+   /// network thread wakes are written together.
+   /// @return False if the send pool stayed exhausted for SendTimeoutMS.
+   bool send(NetSocket socket, const U8* data, U32 size);
+
+   /// Take the next message.  Any buffer must be given back with releaseBuffer().
+   bool popMessage(Message& message);
+
+   /// Give back a buffer from a message.
+   void releaseBuffer(Buffer* buffer) { mReceivePool.release(buffer); }
+
+   /// Stream data through a loopback TCP pair serviced by this thread and
+   /// check that it arrives intact.  Nothing else may pop messages meanwhile.
+   /// @param total Bytes to send.
+   /// @param sendSize Bytes passed to each send().
+   /// @return The throughput in megabytes per second, or zero on failure.
+   F32 loopbackBenchmark(U32 total, U32 sendSize);
+
+   virtual void run(void* arg = 0);
+};
+
+/// The network thread, created by Net::init().
+extern NetThread* gNetThread;
+
+#endif // TORQUE_NET_THREAD
+
+#endif // _PLATFORM_NET_THREAD_UNIX_H_
@@ -71,6 +71,15 @@ ConsoleFunction( setScreenMode, bool, 5, 5, "( width , height , bpp , fullScreen
                                                                 "@return Returns true if successful, otherwise false.\n"
                                                                 "@sa getDesktopResolution, getDisplayDeviceList, getResolutionList, nextResolution, prevResolution, setDisplayDevice, setRes, switchBitDepth")
 {
+   // Without a window, size the canvas so journaled input lines up.
+   if ( Platform::isHeadless() )
+   {
+      if ( Canvas )
+         Canvas->setExtent( Point2I( dAtoi( argv[1] ), dAtoi( argv[2] ) ) );
+
+      return true;
+   }
+
    return( Video::setScreenMode( dAtoi( argv[1] ), dAtoi( argv[2] ), dAtoi( argv[3] ), dAtob( argv[4] ) ) );
 }
 
@@ -29,6 +29,14 @@ ConsoleFunction( setMouseLock, void, 2, 2, "( isLocked ) Use the setMouseLock fu
 
 //-----------------------------------------------------------------------------
 
+ConsoleFunction( isHeadless, bool, 1, 1, "() Use the isHeadless function to check whether the engine is running without a window, GL context or audio device.\n"
+                                                                "@return Returns true if running headless, false otherwise.")
+{
+    return Platform::isHeadless();
+}
+
+//-----------------------------------------------------------------------------
+
 ConsoleFunction( getRealTime, S32, 1, 1, "() Use the getRealTime function to the computer time in milliseconds.\n"
                                                                 "@return Returns the current real time in milliseconds.\n"
                                                                 "@sa getSimTime")
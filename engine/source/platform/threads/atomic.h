@@ -0,0 +1,127 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _PLATFORM_THREADS_ATOMIC_H_
+#define _PLATFORM_THREADS_ATOMIC_H_
+
+#include "platform/types.h"
+
+#if defined(TORQUE_COMPILER_VISUALC)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedIncrement, _InterlockedDecrement, _InterlockedExchangeAdd, _InterlockedCompareExchange, _InterlockedExchange, _ReadWriteBarrier)
+#endif
+
+//-----------------------------------------------------------------------------
+/// @defgroup platformAtomic Atomic Operations
+///
+/// Minimal set of atomic primitives used by the lock-free containers.
+/// All read-modify-write operations act as full memory barriers.
+/// @{
+
+/// Issue a full memory barrier.
+inline void dMemoryBarrier()
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   long barrier;
+   _InterlockedExchange( &barrier, 0 );
+#elif defined(TORQUE_COMPILER_GCC)
+   __sync_synchronize();
+#else
+#  error "dMemoryBarrier: Unsupported compiler"
+#endif
+}
+
+/// Atomically increment the value, returning the incremented value.
+inline S32 dAtomicIncrement( volatile S32& ref )
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   return (S32)_InterlockedIncrement( (volatile long*)&ref );
+#else
+   return __sync_add_and_fetch( &ref, 1 );
+#endif
+}
+
+/// Atomically decrement the value, returning the decremented value.
+inline S32 dAtomicDecrement( volatile S32& ref )
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   return (S32)_InterlockedDecrement( (volatile long*)&ref );
+#else
+   return __sync_sub_and_fetch( &ref, 1 );
+#endif
+}
+
+/// Atomically add to the value, returning the resulting value.
+inline S32 dAtomicAdd( volatile S32& ref, S32 value )
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   return (S32)_InterlockedExchangeAdd( (volatile long*)&ref, value ) + value;
+#else
+   return __sync_add_and_fetch( &ref, value );
+#endif
+}
+
+/// Atomically set the value to "newValue" if it currently equals "oldValue".
+/// @return Whether the swap happened.
+inline bool dAtomicCompareAndSwap( volatile U32& ref, U32 oldValue, U32 newValue )
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   return (U32)_InterlockedCompareExchange( (volatile long*)&ref, (long)newValue, (long)oldValue ) == oldValue;
+#else
+   return __sync_bool_compare_and_swap( &ref, oldValue, newValue );
+#endif
+}
+
+/// Atomically set the pointer to "newValue" if it currently equals "oldValue".
+/// @return Whether the swap happened.
+template< class T >
+inline bool dAtomicCompareAndSwapPtr( T* volatile& ref, T* oldValue, T* newValue )
+{
+#if defined(TORQUE_COMPILER_VISUALC)
+   // Visual C++ builds only target 32-bit x86 (see types.visualc.h).
+   return _InterlockedCompareExchange( (volatile long*)&ref, (long)newValue, (long)oldValue ) == (long)oldValue;
+#else
+   return __sync_bool_compare_and_swap( &ref, oldValue, newValue );
+#endif
+}
+
+/// Read a value written by another thread.
+/// Any writes made by that thread before it published the value are visible afterwards.
+inline U32 dAtomicRead( volatile const U32& ref )
+{
+   const U32 value = ref;
+   dMemoryBarrier();
+   return value;
+}
+
+/// Publish a value to other threads.
+/// All writes made before the call are visible to a thread that reads the value.
+inline void dAtomicWrite( volatile U32& ref, U32 value )
+{
+   dMemoryBarrier();
+   ref = value;
+}
+
+/// @}
+
+#endif // _PLATFORM_THREADS_ATOMIC_H_
@@ -0,0 +1,201 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef _PLATFORM_THREADS_LOCKFREEQUEUE_H_
+#define _PLATFORM_THREADS_LOCKFREEQUEUE_H_
+
+#ifndef _PLATFORM_THREADS_ATOMIC_H_
+#include "platform/threads/atomic.h"
+#endif
+
+#ifndef _PLATFORMASSERT_H_
+#include "platform/platformAssert.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// A fixed-capacity, wait-free ring queue for exactly one producer thread and
+/// exactly one consumer thread.
+///
+/// The capacity is rounded up to a power of two.  Pushing into a full queue
+/// fails rather than blocking so callers can decide whether to drop or retry.
+template< class T >
+class LockFreeSPSCQueue
+{
+private:
+   T*             mItems;
+   U32            mMask;
+   volatile U32   mHead;   ///< Next index to pop (owned by the consumer).
+   volatile U32   mTail;   ///< Next index to push (owned by the producer).
+
+   LockFreeSPSCQueue( const LockFreeSPSCQueue& );
+   LockFreeSPSCQueue& operator=( const LockFreeSPSCQueue& );
+
+public:
+   LockFreeSPSCQueue( const U32 capacity ) :
+      mHead( 0 ),
+      mTail( 0 )
+   {
+      AssertFatal( capacity > 0, "LockFreeSPSCQueue() - Capacity must be non-zero." );
+
+      U32 size = 1;
+      while ( size < capacity )
+         size <<= 1;
+
+      mItems = new T[size];
+      mMask = size - 1;
+   }
+
+   ~LockFreeSPSCQueue()
+   {
+      delete [] mItems;
+   }
+
+   /// Producer: add an item.
+   /// @return False if the queue is full.
+   bool push( const T& item )
+   {
+      const U32 tail = mTail;
+      if ( tail - dAtomicRead( mHead ) > mMask )
+         return false;
+
+      mItems[tail & mMask] = item;
+      dAtomicWrite( mTail, tail + 1 );
+      return true;
+   }
+
+   /// Consumer: remove the oldest item.
+   /// @return False if the queue is empty.
+   bool pop( T& item )
+   {
+      const U32 head = mHead;
+      if ( head == dAtomicRead( mTail ) )
+         return false;
+
+      item = mItems[head & mMask];
+      dAtomicWrite( mHead, head + 1 );
+      return true;
+   }
+
+   /// Approximate item count; exact only when called from the producer or consumer while the other is idle.
+   inline U32 size( void ) const { return mTail - mHead; }
+   inline bool isEmpty( void ) const { return mTail == mHead; }
+   inline U32 capacity( void ) const { return mMask + 1; }
+};
+
+//-----------------------------------------------------------------------------
+
+/// A fixed-capacity, lock-free ring queue for any number of producer threads
+/// and exactly one consumer thread.
+///
+/// Each cell carries a sequence number which tells producers whether the cell
+/// is free and the consumer whether it has been filled, so producers only
+/// contend on claiming the tail index.  The capacity is rounded up to a power
+/// of two and pushing into a full queue fails rather than blocking.
+template< class T >
+class LockFreeMPSCQueue
+{
+private:
+   struct Cell
+   {
+      volatile U32   mSequence;
+      T              mItem;
+   };
+
+   Cell*          mCells;
+   U32            mMask;
+   U32            mHead;   ///< Next index to pop (owned by the consumer).
+   volatile U32   mTail;   ///< Next index to push (claimed by producers).
+
+   LockFreeMPSCQueue( const LockFreeMPSCQueue& );
+   LockFreeMPSCQueue& operator=( const LockFreeMPSCQueue& );
+
+public:
+   LockFreeMPSCQueue( const U32 capacity ) :
+      mHead( 0 ),
+      mTail( 0 )
+   {
+      AssertFatal( capacity > 0, "LockFreeMPSCQueue() - Capacity must be non-zero." );
+
+      U32 size = 1;
+      while ( size < capacity )
+         size <<= 1;
+
+      mCells = new Cell[size];
+      mMask = size - 1;
+
+      for ( U32 index = 0; index < size; index++ )
+         mCells[index].mSequence = index;
+   }
+
+   ~LockFreeMPSCQueue()
+   {
+      delete [] mCells;
+   }
+
+   /// Producer: add an item.  Safe to call from any thread.
+   /// @return False if the queue is full.
+   bool push( const T& item )
+   {
+      U32 tail = dAtomicRead( mTail );
+      for ( ;; )
+      {
+         Cell& cell = mCells[tail & mMask];
+         const S32 difference = (S32)( dAtomicRead( cell.mSequence ) - tail );
+
+         // The consumer has not released this cell yet so the queue is full.
+         if ( difference < 0 )
+            return false;
+
+         if ( difference == 0 && dAtomicCompareAndSwap( mTail, tail, tail + 1 ) )
+         {
+            cell.mItem = item;
+            dAtomicWrite( cell.mSequence, tail + 1 );
+            return true;
+         }
+
+         // Another producer claimed the cell first.
+         tail = dAtomicRead( mTail );
+      }
+   }
+
+   /// Consumer: remove the oldest item.
+   /// @return False if the queue is empty or the oldest item is still being pushed.
+   bool pop( T& item )
+   {
+      Cell& cell = mCells[mHead & mMask];
+      if ( dAtomicRead( cell.mSequence ) != mHead + 1 )
+         return false;
+
+      item = cell.mItem;
+      dAtomicWrite( cell.mSequence, mHead + mMask + 1 );
+      mHead++;
+      return true;
+   }
+
+   /// Approximate item count.
+   inline U32 size( void ) const { return mTail - mHead; }
+   inline U32 capacity( void ) const { return mMask + 1; }
+};
+
+#endif // _PLATFORM_THREADS_LOCKFREEQUEUE_H_
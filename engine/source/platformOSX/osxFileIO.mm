@@ -30,6 +30,7 @@
 
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 
 // Maximum character length for file paths
 #define MAX_MAC_PATH_LONG 2048
@@ -242,6 +243,9 @@ static void recurseDumpPath(const char* curPath, Vector<Platform::FileInfo>& fil
 File::File() : currentStatus(Closed), capability(0)
 {
     handle = NULL;
+    mapHandle = NULL;
+    mapBase = NULL;
+    mapSize = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -420,6 +424,9 @@ File::Status File::flush()
 
 File::Status File::close()
 {
+    // release any view before the file goes away
+    unmap();
+    
     // check if it's already closed...
     if (Closed == currentStatus)
         return currentStatus;
@@ -540,6 +547,49 @@ bool File::hasCapability(Capability cap) const
     return (0 != (U32(cap) & capability));
 }
 
+//-----------------------------------------------------------------------------
+// Map the whole file, read-only unless copy-on-write is asked for.  Only files
+// opened for Read can be mapped so the view can never go stale under our own
+// writes.
+//-----------------------------------------------------------------------------
+const U8 *File::map(U32 *size, bool copyOnWrite)
+{
+    if (mapBase == NULL)
+    {
+        if (currentStatus != Ok || capability != FileRead || handle == NULL)
+            return NULL;
+
+        U32 fileSize = getSize();
+        if (fileSize == 0)
+            return NULL;
+
+        void *view = mmap(NULL, fileSize, copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fileno((FILE*)handle), 0);
+        if (view == MAP_FAILED)
+            return NULL;
+
+        mapBase = view;
+        mapSize = fileSize;
+    }
+
+    if (size)
+        *size = mapSize;
+    return (const U8 *)mapBase;
+}
+
+//-----------------------------------------------------------------------------
+// Release the view created by map().
+//-----------------------------------------------------------------------------
+void File::unmap()
+{
+    if (mapBase == NULL)
+        return;
+
+    munmap(mapBase, mapSize);
+
+    mapBase = NULL;
+    mapSize = 0;
+}
+
 #pragma mark ---- Platform Namespace Methods ----
 
 //-----------------------------------------------------------------------------
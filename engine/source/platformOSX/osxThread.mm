@@ -25,6 +25,7 @@
 #import <errno.h>
 #import "memory/safeDelete.h"
 #import "platform/threads/thread.h"
+#import "platform/platformTLS.h"
 #import "platform/platformSemaphore.h"
 #import "platform/threads/mutex.h"
 #import "console/console.h"
@@ -181,6 +182,47 @@ bool ThreadManager::compare( U32 threadId_1, U32 threadId_2 )
    return (bool)pthread_equal((pthread_t)threadId_1, (pthread_t)threadId_2);
 }
 
+#pragma mark ---- ThreadStorage Class Methods ----
+
+//-----------------------------------------------------------------------------
+
+class PlatformThreadStorage
+{
+public:
+   pthread_key_t mThreadKey;
+};
+
+//-----------------------------------------------------------------------------
+
+ThreadStorage::ThreadStorage()
+{
+   mThreadStorage = (PlatformThreadStorage *) mStorage;
+   constructInPlace(mThreadStorage);
+
+   pthread_key_create(&mThreadStorage->mThreadKey, NULL);
+}
+
+//-----------------------------------------------------------------------------
+
+ThreadStorage::~ThreadStorage()
+{
+   pthread_key_delete(mThreadStorage->mThreadKey);
+}
+
+//-----------------------------------------------------------------------------
+
+void *ThreadStorage::get()
+{
+   return pthread_getspecific(mThreadStorage->mThreadKey);
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadStorage::set(void *value)
+{
+   pthread_setspecific(mThreadStorage->mThreadKey, value);
+}
+
 class ExecuteThread : public Thread
 {
     const char* zargs;
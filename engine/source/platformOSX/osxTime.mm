@@ -23,6 +23,7 @@
 #import "platformOSX/platformOSX.h"
 #import "platform/event.h"
 #import "game/gameInterface.h"
+#import <mach/mach_time.h>
 
 #pragma mark ---- TimeManager Class Methods ----
 
@@ -105,6 +106,17 @@ U32 Platform::getRealMilliseconds()
     return (U32)([NSDate timeIntervalSinceReferenceDate] * 1000);
 }
 
+//------------------------------------------------------------------------------
+// Gets a high resolution time in microseconds since some epoch.
+U64 Platform::getRealMicroseconds()
+{
+    static mach_timebase_info_data_t timebaseInfo = { 0, 0 };
+    if (timebaseInfo.denom == 0)
+        mach_timebase_info(&timebaseInfo);
+    
+    return (mach_absolute_time() * timebaseInfo.numer) / (timebaseInfo.denom * 1000);
+}
+
 //------------------------------------------------------------------------------
 // Gets the running time for this app in milliseconds
 U32 Platform::getVirtualMilliseconds()
@@ -257,6 +257,9 @@ File::File()
     AssertFatal(sizeof(HANDLE) == sizeof(void *), "File::File: cannot cast void* to HANDLE");
 
     handle = (void *)INVALID_HANDLE_VALUE;
+    mapHandle = NULL;
+    mapBase = NULL;
+    mapSize = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -283,7 +286,8 @@ File::~File()
 //-----------------------------------------------------------------------------
 File::Status File::open(const char *filename, const AccessMode openMode)
 {
-   static char filebuf[2048];
+   // Not static, files are opened from the async read workers too
+   char filebuf[2048];
    dStrcpy(filebuf, filename);
    backslash(filebuf);
 #ifdef UNICODE
@@ -479,6 +483,9 @@ File::Status File::flush()
 //-----------------------------------------------------------------------------
 File::Status File::close()
 {
+    // release any view before the handle goes away
+    unmap();
+
     // check if it's already closed...
     if (Closed == currentStatus)
         return currentStatus;
@@ -595,6 +602,59 @@ bool File::hasCapability(Capability cap) const
     return (0 != (U32(cap) & capability));
 }
 
+//-----------------------------------------------------------------------------
+// Map the whole file, read-only unless copy-on-write is asked for.  Only files
+// opened for Read can be mapped so the view can never go stale under our own
+// writes.
+//-----------------------------------------------------------------------------
+const U8 *File::map(U32 *size, bool copyOnWrite)
+{
+    if (NULL == mapBase)
+    {
+        if (Ok != currentStatus || FileRead != capability)
+            return NULL;
+
+        U32 fileSize = getSize();
+        if (0 == fileSize)
+            return NULL;
+
+        HANDLE mapping = CreateFileMapping((HANDLE)handle, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+        if (NULL == mapping)
+            return NULL;
+
+        void *view = MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+        if (NULL == view)
+        {
+            CloseHandle(mapping);
+            return NULL;
+        }
+
+        mapHandle = (void *)mapping;
+        mapBase = view;
+        mapSize = fileSize;
+    }
+
+    if (size)
+        *size = mapSize;
+    return (const U8 *)mapBase;
+}
+
+//-----------------------------------------------------------------------------
+// Release the view created by map().
+//-----------------------------------------------------------------------------
+void File::unmap()
+{
+    if (NULL == mapBase)
+        return;
+
+    UnmapViewOfFile(mapBase);
+    CloseHandle((HANDLE)mapHandle);
+
+    mapHandle = NULL;
+    mapBase = NULL;
+    mapSize = 0;
+}
+
 S32 Platform::compareFileTimes(const FileTime &a, const FileTime &b)
 {
    if(a.v2 > b.v2)
@@ -61,6 +61,21 @@ U32 Platform::getRealMilliseconds()
    return GetTickCount();
 }
 
+U64 Platform::getRealMicroseconds()
+{
+   static LARGE_INTEGER frequency = { 0 };
+   if ( frequency.QuadPart == 0 )
+      QueryPerformanceFrequency( &frequency );
+
+   LARGE_INTEGER counter;
+   QueryPerformanceCounter( &counter );
+
+   // Split the conversion to avoid overflowing the counter.
+   const U64 seconds = counter.QuadPart / frequency.QuadPart;
+   const U64 remainder = counter.QuadPart % frequency.QuadPart;
+   return (seconds * 1000000) + ((remainder * 1000000) / frequency.QuadPart);
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return winState.currentTime;
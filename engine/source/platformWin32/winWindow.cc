@@ -890,6 +890,9 @@ static LRESULT PASCAL WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM
    case WM_MENUSELECT:
       winState.renderThreadBlocked = true;
    case WM_PAINT:
+      // Parts of the window may have been uncovered so repaint all of it.
+      if(Canvas)
+         Canvas->resetUpdateRegions();
       if(winState.renderThreadBlocked)
          Canvas->renderFrame(false);
       break;
@@ -74,6 +74,7 @@
  #include <sys/stat.h>
  #include <unistd.h>
  #include <fcntl.h>
+ #include <sys/mman.h>
  #include <errno.h>
  #include <stdlib.h>
  
@@ -425,6 +426,9 @@ bool dPathCopy(const char *fromName, const char *toName, bool nooverwrite)
  //    AssertFatal(sizeof(int) == sizeof(void *), "File::File: cannot cast void* to int");
  
      handle = (void *)NULL;
+     mapHandle = NULL;
+     mapBase = NULL;
+     mapSize = 0;
  }
  
  //-----------------------------------------------------------------------------
@@ -643,6 +647,9 @@ bool dPathCopy(const char *fromName, const char *toName, bool nooverwrite)
  //-----------------------------------------------------------------------------
  File::Status File::close()
  {
+    // release any view before the descriptor goes away
+    unmap();
+
     // if the handle is non-NULL, close it if necessary and free it
     if (NULL != handle)
     {
@@ -782,6 +789,49 @@ bool dPathCopy(const char *fromName, const char *toName, bool nooverwrite)
  {
      return (0 != (U32(cap) & capability));
  }
+
+ //-----------------------------------------------------------------------------
+ // Map the whole file, read-only unless copy-on-write is asked for.  Only files
+ // opened for Read can be mapped so the view can never go stale under our own
+ // writes.
+ //-----------------------------------------------------------------------------
+ const U8 *File::map(U32 *size, bool copyOnWrite)
+ {
+    if (NULL == mapBase)
+    {
+       if (Ok != currentStatus || FileRead != capability || NULL == handle)
+          return NULL;
+
+       U32 fileSize = getSize();
+       if (0 == fileSize)
+          return NULL;
+
+       void *view = mmap(NULL, fileSize, copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, *((int *)handle), 0);
+       if (MAP_FAILED == view)
+          return NULL;
+
+       mapBase = view;
+       mapSize = fileSize;
+    }
+
+    if (size)
+       *size = mapSize;
+    return (const U8 *)mapBase;
+ }
+
+ //-----------------------------------------------------------------------------
+ // Release the view created by map().
+ //-----------------------------------------------------------------------------
+ void File::unmap()
+ {
+    if (NULL == mapBase)
+       return;
+
+    munmap(mapBase, mapSize);
+
+    mapBase = NULL;
+    mapSize = 0;
+ }
  
  //-----------------------------------------------------------------------------
  S32 Platform::compareFileTimes(const FileTime &a, const FileTime &b)
@@ -24,6 +24,7 @@
 #include "platform/platform.h"
 #include "platform/event.h"
 #include "platform/platformNetAsync.h"
+#include "platform/platformNetThread.unix.h"
 
 #include <unistd.h>
 #include <sys/types.h>
@@ -78,17 +79,55 @@ struct Socket
          state = InvalidState;
          remoteAddr[0] = 0;
          remotePort = -1;
+         threaded = false;
       }
 
       NetSocket fd;
       S32 state;
       char remoteAddr[256];
       S32 remotePort;
+      // true once the network thread services this socket
+      bool threaded;
 };
 
 // list of polled sockets
 static Vector<Socket*> gPolledSockets;
 
+#ifdef TORQUE_NET_THREAD
+// sockets closed on the network thread whose Closed message has not
+// come back yet.  messages for them are dropped.
+static Vector<NetSocket> gClosingSockets;
+
+static void closeThreadSocket(NetSocket fd)
+{
+   gClosingSockets.push_back(fd);
+   gNetThread->closeSocket(fd);
+}
+
+// hand a socket that no longer needs a name lookup to the network thread
+static void threadPolledSocket(Socket* sock)
+{
+   if (!gNetThread || sock->threaded)
+      return;
+
+   switch (sock->state)
+   {
+      case Connected:
+         gNetThread->addSocket(sock->fd, NetThread::Stream);
+         break;
+      case ConnectionPending:
+         gNetThread->addSocket(sock->fd, NetThread::Connecting);
+         break;
+      case Listening:
+         gNetThread->addSocket(sock->fd, NetThread::Listen);
+         break;
+      default:
+         return;
+   }
+   sock->threaded = true;
+}
+#endif
+
 static Socket* addPolledSocket(NetSocket& fd, S32 state,
                                char* remoteAddr = NULL, S32 port = -1)
 {
@@ -100,9 +139,20 @@ static Socket* addPolledSocket(NetSocket& fd, S32 state,
    if (port != -1)
       sock->remotePort = port;
    gPolledSockets.push_back(sock);
+#ifdef TORQUE_NET_THREAD
+   threadPolledSocket(sock);
+#endif
    return sock;
 }
 
+static Socket* findPolledSocket(NetSocket fd)
+{
+   for (S32 i = 0; i < gPolledSockets.size(); ++i)
+      if (gPolledSockets[i]->fd == fd)
+         return gPolledSockets[i];
+   return NULL;
+}
+
 enum {
    MaxConnections = 1024,
 };
@@ -125,6 +175,15 @@ S32 Poll(NetSocket fd, S32 eventMask, S32 timeoutMs)
 bool Net::init()
 {
    NetAsync::startAsync();
+#ifdef TORQUE_NET_THREAD
+   // if epoll is unavailable the sockets are polled every frame instead
+   gNetThread = new NetThread();
+   if (!gNetThread->startThread())
+   {
+      delete gNetThread;
+      gNetThread = NULL;
+   }
+#endif
    return(true);
 }
 
@@ -134,6 +193,15 @@ void Net::shutdown()
       closeConnectTo(gPolledSockets[0]->fd);
    
    closePort();
+#ifdef TORQUE_NET_THREAD
+   if (gNetThread)
+   {
+      gNetThread->stopThread();
+      delete gNetThread;
+      gNetThread = NULL;
+   }
+   gClosingSockets.clear();
+#endif
    NetAsync::stopAsync();
 }
 
@@ -316,14 +384,24 @@ void Net::closeConnectTo(NetSocket sock)
 #endif	//TORQUE_ALLOW_JOURNALING
 
    // if this socket is in the list of polled sockets, remove it
+   bool threaded = false;
    for (int i = 0; i < gPolledSockets.size(); ++i)
       if (gPolledSockets[i]->fd == sock)
       {
+         threaded = gPolledSockets[i]->threaded;
          delete gPolledSockets[i];
          gPolledSockets.erase(i);
          break;
       }
    
+#ifdef TORQUE_NET_THREAD
+   // the network thread owns the socket and closes it
+   if (threaded)
+   {
+      closeThreadSocket(sock);
+      return;
+   }
+#endif
    closeSocket(sock);
 }
 
@@ -339,7 +417,15 @@ Net::Error Net::sendtoSocket(NetSocket socket, const U8 *buffer, int bufferSize)
    }
 #endif	//TORQUE_ALLOW_JOURNALING
 
-   Net::Error e = send(socket, buffer, bufferSize);
+   Net::Error e;
+#ifdef TORQUE_NET_THREAD
+   // queue the data for the network thread rather than blocking on the socket
+   Socket* sock = findPolledSocket(socket);
+   if (sock && sock->threaded)
+      e = gNetThread->send(socket, buffer, bufferSize) ? NoError : WouldBlock;
+   else
+#endif
+      e = send(socket, buffer, bufferSize);
    
 #ifdef	TORQUE_ALLOW_JOURNALING
    if(Game->isJournalWriting())
@@ -348,12 +434,24 @@ Net::Error Net::sendtoSocket(NetSocket socket, const U8 *buffer, int bufferSize)
    return e;
 }
 
+// close the udp or ipx port socket, which the network thread owns if it is running
+static void closePortSocket(int &fd)
+{
+   if(fd == InvalidSocket)
+      return;
+#ifdef TORQUE_NET_THREAD
+   if(gNetThread)
+      closeThreadSocket(fd);
+   else
+#endif
+      close(fd);
+   fd = InvalidSocket;
+}
+
 bool Net::openPort(S32 port)
 {
-   if(udpSocket != InvalidSocket)
-      close(udpSocket);
-   if(ipxSocket != InvalidSocket)
-      close(ipxSocket);
+   closePortSocket(udpSocket);
+   closePortSocket(ipxSocket);
       
    udpSocket = socket(AF_INET, SOCK_DGRAM, 0);
    ipxSocket = socket(AF_IPX, SOCK_DGRAM, 0);
@@ -402,16 +500,23 @@ bool Net::openPort(S32 port)
          Con::printf("Unable to initialize IPX - error %d", error);
       }
    }
+#ifdef TORQUE_NET_THREAD
+   if(gNetThread)
+   {
+      if(udpSocket != InvalidSocket)
+         gNetThread->addSocket(udpSocket, NetThread::Datagram);
+      if(ipxSocket != InvalidSocket)
+         gNetThread->addSocket(ipxSocket, NetThread::Datagram);
+   }
+#endif
    netPort = port;
    return ipxSocket != InvalidSocket || udpSocket != InvalidSocket;
 }
 
 void Net::closePort()
 {
-   if(ipxSocket != InvalidSocket)
-      close(ipxSocket);
-   if(udpSocket != InvalidSocket)
-      close(udpSocket);
+   closePortSocket(ipxSocket);
+   closePortSocket(udpSocket);
 }
 
 Net::Error Net::sendto(const NetAddress *address, const U8 *buffer, S32 bufferSize)
@@ -443,13 +548,129 @@ Net::Error Net::sendto(const NetAddress *address, const U8 *buffer, S32 bufferSi
    }
 }
 
+// convert the source address of a packet.  returns false if the packet
+// should be ignored.
+static bool getPacketSource(const sockaddr *sa, NetAddress *address)
+{
+   if(sa->sa_family == AF_INET)
+      IPSocketToNetAddress((const sockaddr_in *) sa, address);
+   else if(sa->sa_family == AF_IPX)
+      IPXSocketToNetAddress((const sockaddr_ipx *) sa, address);
+   else
+      return false;
+
+   // skip packets we sent to ourselves
+   if(address->type == NetAddress::IPAddress &&
+      address->netNum[0] == 127 &&
+      address->netNum[1] == 0 &&
+      address->netNum[2] == 0 &&
+      address->netNum[3] == 1 &&
+      address->port == netPort)
+      return false;
+   return true;
+}
+
+#ifdef TORQUE_NET_THREAD
+// turn a message from the network thread into a game event
+static void processNetThreadMessage(const NetThread::Message &message)
+{
+   static PacketReceiveEvent receiveEvent;
+   static ConnectedNotifyEvent notifyEvent;
+   static ConnectedAcceptEvent acceptEvent;
+   static ConnectedReceiveEvent cReceiveEvent;
+
+   if (message.type == NetThread::Closed)
+   {
+      S32 index = gClosingSockets.find_next(message.socket);
+      if (index != -1)
+         gClosingSockets.erase(index);
+      return;
+   }
+
+   // the socket was closed after the message was sent
+   if (gClosingSockets.find_next(message.socket) != -1)
+   {
+      if (message.type == NetThread::Accepted)
+         closeThreadSocket(message.incoming);
+      if (message.buffer)
+         gNetThread->releaseBuffer(message.buffer);
+      return;
+   }
+
+   Socket *sock = NULL;
+   switch (message.type)
+   {
+      case NetThread::PacketReceived:
+         if (getPacketSource(&message.address, &receiveEvent.sourceAddress))
+         {
+            dMemcpy(receiveEvent.data, message.buffer->data, message.buffer->size);
+            receiveEvent.size = PacketReceiveEventHeaderSize + message.buffer->size;
+            Game->postEvent(receiveEvent);
+         }
+         break;
+      case NetThread::DataReceived:
+         cReceiveEvent.tag = message.socket;
+         dMemcpy(cReceiveEvent.data, message.buffer->data, message.buffer->size);
+         cReceiveEvent.size = ConnectedReceiveEventHeaderSize + message.buffer->size;
+         Game->postEvent(cReceiveEvent);
+         break;
+      case NetThread::Accepted:
+         // the network thread is already receiving on the new socket
+         sock = new Socket();
+         sock->fd = message.incoming;
+         sock->state = Connected;
+         sock->threaded = true;
+         gPolledSockets.push_back(sock);
+
+         IPSocketToNetAddress((const sockaddr_in *) &message.address, &acceptEvent.address);
+         acceptEvent.portTag = message.socket;
+         acceptEvent.connectionTag = message.incoming;
+         Game->postEvent(acceptEvent);
+         break;
+      case NetThread::Connected:
+         sock = findPolledSocket(message.socket);
+         if (sock)
+            sock->state = Connected;
+         notifyEvent.tag = message.socket;
+         notifyEvent.state = ConnectedNotifyEvent::Connected;
+         Game->postEvent(notifyEvent);
+         break;
+      case NetThread::ConnectFailed:
+      case NetThread::Disconnected:
+         notifyEvent.tag = message.socket;
+         notifyEvent.state = message.type == NetThread::ConnectFailed ?
+            ConnectedNotifyEvent::ConnectFailed : ConnectedNotifyEvent::Disconnected;
+         Game->postEvent(notifyEvent);
+         Net::closeConnectTo(message.socket);
+         break;
+   }
+
+   if (message.buffer)
+      gNetThread->releaseBuffer(message.buffer);
+}
+#endif
+
 void Net::process()
 {
+#ifdef TORQUE_NET_THREAD
+   // the network thread has done the receiving.  just post what it found.
+   if (gNetThread)
+   {
+      NetThread::Message message;
+      while (gNetThread->popMessage(message))
+         processNetThreadMessage(message);
+   }
+#endif
+
    sockaddr sa;
 
    PacketReceiveEvent receiveEvent;
    for(;;)
    {
+#ifdef TORQUE_NET_THREAD
+      if(gNetThread)
+         break;
+#endif
       U32 addrLen = sizeof(sa);
       S32 bytesRead = -1;
       if(udpSocket != InvalidSocket)
@@ -463,20 +684,7 @@ void Net::process()
       if(bytesRead == -1)
          break;
       
-      if(sa.sa_family == AF_INET)
-         IPSocketToNetAddress((sockaddr_in *) &sa, &receiveEvent.sourceAddress);
-      else if(sa.sa_family == AF_IPX)
-         IPXSocketToNetAddress((sockaddr_ipx *) &sa, &receiveEvent.sourceAddress);
-      else
-         continue;
-         
-      NetAddress &na = receiveEvent.sourceAddress;
-      if(na.type == NetAddress::IPAddress &&
-         na.netNum[0] == 127 &&
-         na.netNum[1] == 0 &&
-         na.netNum[2] == 0 &&
-         na.netNum[3] == 1 &&
-         na.port == netPort)
+      if(!getPacketSource(&sa, &receiveEvent.sourceAddress))
          continue;
       if(bytesRead <= 0)
          continue;
@@ -510,6 +718,14 @@ void Net::process()
    {
       removeSock = false;
       currentSock = gPolledSockets[i];
+
+      // the network thread services this socket
+      if (currentSock->threaded)
+      {
+         i++;
+         continue;
+      }
+
       switch (currentSock->state)
       {
          case InvalidState:
@@ -650,7 +866,13 @@ void Net::process()
       if (removeSock)
          closeConnectTo(currentSock->fd);
       else
+      {
+#ifdef TORQUE_NET_THREAD
+         // a resolved name lookup is now connecting, so hand it over
+         threadPolledSocket(currentSock);
+#endif
          i++;
+      }
    }
 }
                  
@@ -67,6 +67,13 @@ U32 Platform::getRealMilliseconds()
    return x86UNIXGetTickCount();
 }
 
+U64 Platform::getRealMicroseconds()
+{
+   timeval t;
+   gettimeofday(&t, NULL);
+   return ((U64)t.tv_sec * 1000000) + t.tv_usec;
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return x86UNIXState->currentTime;
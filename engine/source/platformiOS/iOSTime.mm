@@ -94,6 +94,12 @@ U32 Platform::getRealMilliseconds()
    return ret;
 }   
 
+/// Gets a high resolution time in microseconds since some epoch.
+U64 Platform::getRealMicroseconds()
+{
+   return (U64)(mach_absolute_time() * absolute_to_seconds * 1000000.0);
+}
+
 U32 Platform::getVirtualMilliseconds()
 {
    return platState.currentTime;   
@@ -27,192 +27,134 @@
 //----------------------------------------------------------------------------
 extern S32 HashPointer(StringTableEntry e);
 
-SimNameDictionary::SimNameDictionary()
+static inline U32 hashName(StringTableEntry name)
 {
+   return U32(HashPointer(name));
+}
+
+SimObjectNameTable::SimObjectNameTable(NextObjectMember next)
+{
+   nextObject = next;
    hashTable = NULL;
+   hashTableSize = 0;
+   hashEntryCount = 0;
+   oldHashTable = NULL;
+   oldHashTableSize = 0;
+   rehashIndex = 0;
    mutex = Mutex::createMutex();
 }
 
-SimNameDictionary::~SimNameDictionary()
+SimObjectNameTable::~SimObjectNameTable()
 {
    delete[] hashTable;
+   delete[] oldHashTable;
    Mutex::destroyMutex(mutex);
 }
 
-void SimNameDictionary::insert(SimObject* obj)
+void SimObjectNameTable::migrateBuckets(S32 count)
 {
-   if(!obj->objectName)
-      return;
-
-   Mutex::lockMutex(mutex);
-   
-   if(!hashTable)
-   {
-      hashTable = new SimObject *[DefaultTableSize];
-      hashTableSize = DefaultTableSize;
-      hashEntryCount = 0;
-      S32 i;
-      for(i = 0; i < hashTableSize; i++)
-         hashTable[i] = NULL;
-   }
-   S32 idx = HashPointer(obj->objectName) % hashTableSize;
-   obj->nextNameObject = hashTable[idx];
-   hashTable[idx] = obj;
-   hashEntryCount++;
-   if(hashEntryCount > hashTableSize)
+   while(count-- > 0 && rehashIndex < oldHashTableSize)
    {
-      // resize the hash table
-      S32 i;
-      SimObject *head = NULL, *walk, *temp;
-   	for(i = 0; i < hashTableSize; i++) {
-   		walk = hashTable[i];
-         while(walk)
-         {
-            temp = walk->nextNameObject;
-            walk->nextNameObject = head;
-            head = walk;
-            walk = temp;
-         }
-   	}
-      delete[] hashTable;
-      hashTableSize = hashTableSize * 2 + 1;
-      hashTable = new SimObject *[hashTableSize];
+      SimObject *walk = oldHashTable[rehashIndex];
+      oldHashTable[rehashIndex++] = NULL;
 
-      for(i = 0; i < hashTableSize;i++)
-         hashTable[i] = NULL;
-      while(head)
+      while(walk)
       {
-         temp = head->nextNameObject;
-         idx = HashPointer(head->objectName) % hashTableSize;
-         head->nextNameObject = hashTable[idx];
-         hashTable[idx] = head;
-         head = temp;
-      }
-   }
-   Mutex::unlockMutex(mutex);
-}
+         SimObject *temp = walk->*nextObject;
 
-SimObject* SimNameDictionary::find(StringTableEntry name)
-{
-   // NULL is a valid lookup - it will always return NULL
-   if(!hashTable)
-      return NULL;
-      
-   Mutex::lockMutex(mutex);
+         // Append so that objects sharing a name keep their order.
+         SimObject **tail = &hashTable[hashName(walk->objectName) % hashTableSize];
+         while(*tail)
+            tail = &((*tail)->*nextObject);
+         walk->*nextObject = NULL;
+         *tail = walk;
 
-   S32 idx = HashPointer(name) % hashTableSize;
-   SimObject *walk = hashTable[idx];
-   while(walk)
-   {
-      if(walk->objectName == name)
-      {
-         Mutex::unlockMutex(mutex);
-         return walk;
+         walk = temp;
       }
-      walk = walk->nextNameObject;
    }
 
-   Mutex::unlockMutex(mutex);
-   return NULL;
+   if(rehashIndex >= oldHashTableSize)
+   {
+      delete[] oldHashTable;
+      oldHashTable = NULL;
+      oldHashTableSize = 0;
+      rehashIndex = 0;
+   }
 }
 
-void SimNameDictionary::remove(SimObject* obj)
+bool SimObjectNameTable::unlink(SimObject **walk, SimObject *obj)
 {
-   if(!obj->objectName)
-      return;
-
-   Mutex::lockMutex(mutex);
-
-   SimObject **walk = &hashTable[HashPointer(obj->objectName) % hashTableSize];
    while(*walk)
    {
       if(*walk == obj)
       {
-         *walk = obj->nextNameObject;
-			obj->nextNameObject = (SimObject*)-1;
+         *walk = obj->*nextObject;
+         obj->*nextObject = (SimObject*)-1;
          hashEntryCount--;
-
-         Mutex::unlockMutex(mutex);
-         return;
+         return true;
       }
-      walk = &((*walk)->nextNameObject);
+      walk = &((*walk)->*nextObject);
    }
-
-   Mutex::unlockMutex(mutex);
-}	
-
-//----------------------------------------------------------------------------
-
-SimManagerNameDictionary::SimManagerNameDictionary()
-{
-   hashTable = new SimObject *[DefaultTableSize];
-   hashTableSize = DefaultTableSize;
-   hashEntryCount = 0;
-   S32 i;
-   for(i = 0; i < hashTableSize; i++)
-      hashTable[i] = NULL;
-   mutex = Mutex::createMutex();
+   return false;
 }
 
-SimManagerNameDictionary::~SimManagerNameDictionary()
-{
-   delete[] hashTable;
-   Mutex::destroyMutex(mutex);
-}
-
-void SimManagerNameDictionary::insert(SimObject* obj)
+void SimObjectNameTable::insert(SimObject* obj)
 {
    if(!obj->objectName)
       return;
 
    Mutex::lockMutex(mutex);
 
-   S32 idx = HashPointer(obj->objectName) % hashTableSize;
-   obj->nextManagerNameObject = hashTable[idx];
+   if(!hashTable)
+   {
+      hashTable = new SimObject *[DefaultTableSize];
+      hashTableSize = DefaultTableSize;
+      hashEntryCount = 0;
+      S32 i;
+      for(i = 0; i < hashTableSize; i++)
+         hashTable[i] = NULL;
+   }
+
+   if(oldHashTable)
+      migrateBuckets(RehashBucketStep);
+
+   S32 idx = hashName(obj->objectName) % hashTableSize;
+   obj->*nextObject = hashTable[idx];
    hashTable[idx] = obj;
    hashEntryCount++;
    if(hashEntryCount > hashTableSize)
    {
-      // resize the hash table
-      S32 i;
-      SimObject *head = NULL, *walk, *temp;
-   	for(i = 0; i < hashTableSize; i++) {
-   		walk = hashTable[i];
-         while(walk)
-         {
-            temp = walk->nextManagerNameObject;
-            walk->nextManagerNameObject = head;
-            head = walk;
-            walk = temp;
-         }
-   	}
-      delete[] hashTable;
+      // A growing table has always finished migrating by now but
+      // make sure before replacing the old table.
+      if(oldHashTable)
+         migrateBuckets(oldHashTableSize);
+
+      // Start migrating to a larger table.
+      oldHashTable = hashTable;
+      oldHashTableSize = hashTableSize;
+      rehashIndex = 0;
+
       hashTableSize = hashTableSize * 2 + 1;
       hashTable = new SimObject *[hashTableSize];
-
-      for(i = 0; i < hashTableSize;i++)
+      S32 i;
+      for(i = 0; i < hashTableSize; i++)
          hashTable[i] = NULL;
-      while(head)
-      {
-         temp = head->nextManagerNameObject;
-         idx = HashPointer(head->objectName) % hashTableSize;
-         head->nextManagerNameObject = hashTable[idx];
-         hashTable[idx] = head;
-         head = temp;
-      }
    }
-   
+
    Mutex::unlockMutex(mutex);
 }
 
-SimObject* SimManagerNameDictionary::find(StringTableEntry name)
+SimObject* SimObjectNameTable::find(StringTableEntry name)
 {
    // NULL is a valid lookup - it will always return NULL
+   if(!hashTable)
+      return NULL;
 
    Mutex::lockMutex(mutex);
 
-   S32 idx = HashPointer(name) % hashTableSize;
-   SimObject *walk = hashTable[idx];
+   // Objects inserted since the table grew are in the new table so search it first.
+   const U32 hash = hashName(name);
+   SimObject *walk = hashTable[hash % hashTableSize];
    while(walk)
    {
       if(walk->objectName == name)
@@ -220,61 +162,124 @@ SimObject* SimManagerNameDictionary::find(StringTableEntry name)
          Mutex::unlockMutex(mutex);
          return walk;
       }
-      walk = walk->nextManagerNameObject;
+      walk = walk->*nextObject;
+   }
+
+   // Search the old table if the bucket has not been migrated yet.
+   if(oldHashTable)
+   {
+      S32 idx = hash % oldHashTableSize;
+      if(idx >= rehashIndex)
+      {
+         walk = oldHashTable[idx];
+         while(walk)
+         {
+            if(walk->objectName == name)
+            {
+               Mutex::unlockMutex(mutex);
+               return walk;
+            }
+            walk = walk->*nextObject;
+         }
+      }
    }
 
    Mutex::unlockMutex(mutex);
    return NULL;
 }
 
-void SimManagerNameDictionary::remove(SimObject* obj)
+void SimObjectNameTable::remove(SimObject* obj)
 {
-   if(!obj->objectName)
+   if(!obj->objectName || !hashTable)
       return;
 
    Mutex::lockMutex(mutex);
 
-   SimObject **walk = &hashTable[HashPointer(obj->objectName) % hashTableSize];
-   while(*walk)
-   {
-      if(*walk == obj)
-      {
-         *walk = obj->nextManagerNameObject;
-			obj->nextManagerNameObject = (SimObject*)-1;
-         hashEntryCount--;
+   const U32 hash = hashName(obj->objectName);
+   if(!unlink(&hashTable[hash % hashTableSize], obj) && oldHashTable)
+      unlink(&oldHashTable[hash % oldHashTableSize], obj);
 
-         Mutex::unlockMutex(mutex);
-         return;
-      }
-      walk = &((*walk)->nextManagerNameObject);
-   }
+   if(oldHashTable)
+      migrateBuckets(RehashBucketStep);
 
    Mutex::unlockMutex(mutex);
-}	
+}
+
+//----------------------------------------------------------------------------
+
+SimNameDictionary::SimNameDictionary() : SimObjectNameTable(&SimObject::nextNameObject)
+{
+}
+
+//----------------------------------------------------------------------------
+
+SimManagerNameDictionary::SimManagerNameDictionary() : SimObjectNameTable(&SimObject::nextManagerNameObject)
+{
+}
 
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
 
 SimIdDictionary::SimIdDictionary()
 {
-   for(S32 i = 0; i < DefaultTableSize; i++)
-      table[i] = NULL;
+   table = new Entry[DefaultTableSize];
+   tableMask = DefaultTableSize - 1;
+   entryCount = 0;
+   for(U32 i = 0; i <= tableMask; i++)
+      table[i].object = NULL;
    mutex = Mutex::createMutex();
 }
 
 SimIdDictionary::~SimIdDictionary()
 {
+   delete[] table;
    Mutex::destroyMutex(mutex);
 }
 
+void SimIdDictionary::resize(U32 newSize)
+{
+   AssertFatal( isPow2(newSize) && newSize > entryCount, "SimIdDictionary::resize - Invalid table size!" );
+
+   Entry *oldTable = table;
+   const U32 oldSize = tableMask + 1;
+
+   table = new Entry[newSize];
+   tableMask = newSize - 1;
+   for(U32 i = 0; i <= tableMask; i++)
+      table[i].object = NULL;
+
+   for(U32 i = 0; i < oldSize; i++)
+   {
+      if(!oldTable[i].object)
+         continue;
+
+      U32 idx = oldTable[i].id & tableMask;
+      while(table[idx].object)
+         idx = (idx + 1) & tableMask;
+      table[idx] = oldTable[i];
+   }
+
+   delete[] oldTable;
+}
+
 void SimIdDictionary::insert(SimObject* obj)
 {
    Mutex::lockMutex(mutex);
 
-   S32 idx = obj->getId() & TableBitMask;
-   obj->nextIdObject = table[idx];
-   AssertFatal( obj->nextIdObject != obj, "SimIdDictionary::insert - Creating Infinite Loop linking to self!" );
-   table[idx] = obj;
+   // Keep the table at most half full so probes stay short.
+   if((entryCount + 1) * 2 > tableMask + 1)
+      resize((tableMask + 1) * 2);
+
+   const U32 id = obj->getId();
+   U32 idx = id & tableMask;
+   while(table[idx].object)
+   {
+      AssertFatal( table[idx].object != obj, "SimIdDictionary::insert - Object is already in the dictionary!" );
+      idx = (idx + 1) & tableMask;
+   }
+   table[idx].id = id;
+   table[idx].object = obj;
+   entryCount++;
 
    Mutex::unlockMutex(mutex);
 }
@@ -283,16 +288,16 @@ SimObject* SimIdDictionary::find(S32 id)
 {
    Mutex::lockMutex(mutex);
 
-   S32 idx = id & TableBitMask;
-   SimObject *walk = table[idx];
-   while(walk)
+   U32 idx = U32(id) & tableMask;
+   while(table[idx].object)
    {
-      if(walk->getId() == U32(id))
+      if(table[idx].id == U32(id))
       {
+         SimObject *obj = table[idx].object;
          Mutex::unlockMutex(mutex);
-         return walk;
+         return obj;
       }
-      walk = walk->nextIdObject;
+      idx = (idx + 1) & tableMask;
    }
 
    Mutex::unlockMutex(mutex);
@@ -304,11 +309,29 @@ void SimIdDictionary::remove(SimObject* obj)
 {
    Mutex::lockMutex(mutex);
 
-   SimObject **walk = &table[obj->getId() & TableBitMask];
-   while(*walk && *walk != obj)
-      walk = &((*walk)->nextIdObject);
-   if(*walk)
-      *walk = obj->nextIdObject;
+   U32 idx = obj->getId() & tableMask;
+   while(table[idx].object && table[idx].object != obj)
+      idx = (idx + 1) & tableMask;
+
+   if(table[idx].object)
+   {
+      // Shift later entries of the probe run back into the hole so that
+      // lookups never need to step over deleted slots.
+      U32 hole = idx;
+      U32 next = (idx + 1) & tableMask;
+      while(table[next].object)
+      {
+         const U32 home = table[next].id & tableMask;
+         if(((next - home) & tableMask) >= ((next - hole) & tableMask))
+         {
+            table[hole] = table[next];
+            hole = next;
+         }
+         next = (next + 1) & tableMask;
+      }
+      table[hole].object = NULL;
+      entryCount--;
+   }
 
    Mutex::unlockMutex(mutex);
 }
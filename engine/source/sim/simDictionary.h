@@ -36,52 +36,68 @@
 class SimObject;
 
 //----------------------------------------------------------------------------
-/// Map of names to SimObjects
+/// Chained hash table of SimObjects keyed by name.
 ///
-/// Provides fast lookup for name->object and
-/// for fast removal of an object given object*
-class SimNameDictionary
+/// The chains are linked through a pointer on the objects themselves,
+/// selected by the derived dictionary.  When the table grows, the buckets
+/// of the previous table are migrated a few at a time by later inserts and
+/// removes so that no single insert has to rehash every object.
+class SimObjectNameTable
 {
    enum
    {
-      DefaultTableSize = 29
+      DefaultTableSize = 29,
+      RehashBucketStep = 4
    };
 
+protected:
+   typedef SimObject* SimObject::*NextObjectMember;
+
+private:
+   NextObjectMember nextObject;
+
    SimObject **hashTable;  // hash the pointers of the names...
    S32 hashTableSize;
    S32 hashEntryCount;
 
+   SimObject **oldHashTable;  // table being migrated from, if any
+   S32 oldHashTableSize;
+   S32 rehashIndex;           // next bucket of the old table to migrate
+
    void *mutex;
 
+   void migrateBuckets(S32 count);
+   bool unlink(SimObject **walk, SimObject *obj);
+
+protected:
+   SimObjectNameTable(NextObjectMember next);
+   ~SimObjectNameTable();
+
 public:
    void insert(SimObject* obj);
    void remove(SimObject* obj);
    SimObject* find(StringTableEntry name);
 
-   SimNameDictionary();
-   ~SimNameDictionary();
+   S32 getCount() const { return hashEntryCount; }
+   S32 getTableSize() const { return hashTableSize; }
+   bool isRehashing() const { return oldHashTable != NULL; }
 };
 
-class SimManagerNameDictionary
+//----------------------------------------------------------------------------
+/// Map of names to SimObjects
+///
+/// Provides fast lookup for name->object and
+/// for fast removal of an object given object*
+class SimNameDictionary : public SimObjectNameTable
 {
-   enum
-   {
-      DefaultTableSize = 29
-   };
-
-   SimObject **hashTable;  // hash the pointers of the names...
-   S32 hashTableSize;
-   S32 hashEntryCount;
-
-   void *mutex;
-
 public:
-   void insert(SimObject* obj);
-   void remove(SimObject* obj);
-   SimObject* find(StringTableEntry name);
+   SimNameDictionary();
+};
 
+class SimManagerNameDictionary : public SimObjectNameTable
+{
+public:
    SimManagerNameDictionary();
-   ~SimManagerNameDictionary();
 };
 
 //----------------------------------------------------------------------------
@@ -89,22 +105,41 @@ public:
 ///
 /// Provides fast lookup for ID->object and
 /// for fast removal of an object given object*
+///
+/// The table is open addressed with linear probing and indexed by the id
+/// itself.  Ids are handed out sequentially so the live ids are mostly
+/// dense and each object nearly always sits in the slot its id indexes
+/// directly.  The id is stored beside the object so that probing never
+/// touches the objects.  The table doubles whenever it becomes half full.
 class SimIdDictionary
 {
    enum
    {
-      DefaultTableSize = 4096,
-      TableBitMask = 4095
+      DefaultTableSize = 4096
    };
-   SimObject *table[DefaultTableSize];
+
+   struct Entry
+   {
+      U32 id;
+      SimObject *object;
+   };
+
+   Entry *table;
+   U32 tableMask;
+   U32 entryCount;
 
    void *mutex;
 
+   void resize(U32 newSize);
+
 public:
    void insert(SimObject* obj);
    void remove(SimObject* obj);
    SimObject* find(S32 id);
 
+   U32 getCount() const { return entryCount; }
+   U32 getTableSize() const { return tableMask + 1; }
+
    SimIdDictionary();
    ~SimIdDictionary();
 };
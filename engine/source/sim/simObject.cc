@@ -51,7 +51,6 @@ SimObject::SimObject( const U8 namespaceLinkMask ) : mNSLinkMask( namespaceLinkM
     mInternalName            = NULL;
     nextNameObject           = (SimObject*)-1;
     nextManagerNameObject    = (SimObject*)-1;
-    nextIdObject             = NULL;  
     mId                      = 0;
     mIdString                = StringTable->EmptyString;
     mGroup                   = 0;
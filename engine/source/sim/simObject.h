@@ -233,6 +233,7 @@ class SimObject: public ConsoleObject, public TamlCallbacks
 
     friend class SimManager;
     friend class SimGroup;
+    friend class SimObjectNameTable;
     friend class SimNameDictionary;
     friend class SimManagerNameDictionary;
     friend class SimIdDictionary;
@@ -277,7 +278,6 @@ private:
     StringTableEntry objectName;
     SimObject*       nextNameObject;
     SimObject*       nextManagerNameObject;
-    SimObject*       nextIdObject;
 
     SimGroup*   mGroup;  ///< SimGroup we're contained in, if any.
     BitSet32    mFlags;
@@ -0,0 +1,288 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _ASYNC_READ_QUEUE_H_
+#include "io/resource/asyncReadQueue.h"
+#endif
+
+#ifndef _RESMANAGER_H_
+#include "io/resource/resourceManager.h"
+#endif
+
+#ifndef _FILESTREAM_H_
+#include "io/fileStream.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define ASYNCREADQUEUE_UNITTEST_FILE_COUNT      32
+#define ASYNCREADQUEUE_UNITTEST_FILE_SIZE       65536
+
+//-----------------------------------------------------------------------------
+
+struct AsyncReadTestState
+{
+    U32 mCallCount;
+    AsyncReadRequest* mpLastRequest;
+};
+
+//-----------------------------------------------------------------------------
+
+static void onAsyncReadTest( AsyncReadRequest* pRequest, void* pUserData )
+{
+    AsyncReadTestState* pState = static_cast<AsyncReadTestState*>( pUserData );
+    pState->mCallCount++;
+    pState->mpLastRequest = pRequest;
+}
+
+//-----------------------------------------------------------------------------
+
+static const char* formatTestFilePath( char* pBuffer, const U32 bufferSize, const char* pName, const U32 index )
+{
+    dSprintf( pBuffer, bufferSize, "%s/asyncReadQueueTest/%s%d.bin", Platform::getTemporaryDirectory(), pName, index );
+    return pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool writeTestFile( const char* pFilePath, const U32 size, const U8 seed )
+{
+    Platform::createPath( pFilePath );
+
+    FileStream stream;
+    if ( !stream.open( pFilePath, FileStream::Write ) )
+        return false;
+
+    for ( U32 index = 0; index < size; ++index )
+        stream.write( U8(index * 31 + seed) );
+
+    stream.close();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool checkTestData( const U8* pData, const U32 size, const U8 seed )
+{
+    for ( U32 index = 0; index < size; ++index )
+    {
+        if ( pData[index] != U8(index * 31 + seed) )
+            return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AsyncReadQueueTests, ReadFile )
+{
+    char filePath[1024];
+    formatTestFilePath( filePath, sizeof(filePath), "read", 0 );
+    ASSERT_TRUE( writeTestFile( filePath, ASYNCREADQUEUE_UNITTEST_FILE_SIZE, 7 ) ) << "Failed to write test file.";
+
+    AsyncReadQueue queue;
+    AsyncReadTestState state = { 0, NULL };
+
+    AsyncReadRequest* pRequest = queue.create( StringTable->insert( filePath ), AsyncReadRequest::PriorityNormal, onAsyncReadTest, &state );
+    pRequest->setFileSource( filePath );
+    queue.submit( pRequest );
+    queue.wait( pRequest );
+
+    ASSERT_EQ( pRequest->getStatus(), AsyncReadRequest::Complete ) << "Read did not complete.";
+    ASSERT_EQ( pRequest->getSize(), (U32)ASYNCREADQUEUE_UNITTEST_FILE_SIZE ) << "Read size is wrong.";
+    ASSERT_TRUE( checkTestData( pRequest->getData(), pRequest->getSize(), 7 ) ) << "Read data is wrong.";
+
+    // Callbacks only arrive from process().
+    ASSERT_EQ( state.mCallCount, (U32)0 ) << "Callback arrived before process().";
+    queue.process();
+    ASSERT_EQ( state.mCallCount, (U32)1 ) << "Callback did not arrive.";
+    ASSERT_EQ( state.mpLastRequest, pRequest ) << "Callback was given the wrong request.";
+
+    queue.release( pRequest );
+    queue.shutdown();
+    Platform::fileDelete( filePath );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AsyncReadQueueTests, ReadManyFiles )
+{
+    char filePath[1024];
+    AsyncReadQueue queue;
+    AsyncReadRequest* requests[ASYNCREADQUEUE_UNITTEST_FILE_COUNT];
+
+    for ( U32 index = 0; index < ASYNCREADQUEUE_UNITTEST_FILE_COUNT; ++index )
+    {
+        formatTestFilePath( filePath, sizeof(filePath), "many", index );
+        ASSERT_TRUE( writeTestFile( filePath, ASYNCREADQUEUE_UNITTEST_FILE_SIZE + index, U8(index) ) ) << "Failed to write test file.";
+    }
+
+    // Queue reads at every priority.
+    for ( U32 index = 0; index < ASYNCREADQUEUE_UNITTEST_FILE_COUNT; ++index )
+    {
+        formatTestFilePath( filePath, sizeof(filePath), "many", index );
+        requests[index] = queue.create( StringTable->insert( filePath ), AsyncReadRequest::Priority(index % AsyncReadRequest::PriorityCount) );
+        requests[index]->setFileSource( filePath );
+        queue.submit( requests[index] );
+    }
+
+    for ( U32 index = 0; index < ASYNCREADQUEUE_UNITTEST_FILE_COUNT; ++index )
+    {
+        queue.wait( requests[index] );
+        ASSERT_EQ( requests[index]->getStatus(), AsyncReadRequest::Complete ) << "Read did not complete.";
+        ASSERT_EQ( requests[index]->getSize(), (U32)(ASYNCREADQUEUE_UNITTEST_FILE_SIZE + index) ) << "Read size is wrong.";
+        ASSERT_TRUE( checkTestData( requests[index]->getData(), requests[index]->getSize(), U8(index) ) ) << "Read data is wrong.";
+    }
+
+    queue.process();
+
+    for ( U32 index = 0; index < ASYNCREADQUEUE_UNITTEST_FILE_COUNT; ++index )
+    {
+        queue.release( requests[index] );
+        Platform::fileDelete( formatTestFilePath( filePath, sizeof(filePath), "many", index ) );
+    }
+
+    queue.shutdown();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AsyncReadQueueTests, MissingFile )
+{
+    char filePath[1024];
+    formatTestFilePath( filePath, sizeof(filePath), "missing", 0 );
+
+    AsyncReadQueue queue;
+    AsyncReadTestState state = { 0, NULL };
+
+    AsyncReadRequest* pRequest = queue.create( StringTable->insert( filePath ), AsyncReadRequest::PriorityHigh, onAsyncReadTest, &state );
+    pRequest->setFileSource( filePath );
+    queue.submit( pRequest );
+    queue.wait( pRequest );
+
+    ASSERT_EQ( pRequest->getStatus(), AsyncReadRequest::Failed ) << "Read of a missing file did not fail.";
+    ASSERT_TRUE( pRequest->getData() == NULL ) << "Failed read has data.";
+
+    // Failures are still reported through the callback.
+    queue.process();
+    ASSERT_EQ( state.mCallCount, (U32)1 ) << "Callback did not arrive for a failed read.";
+
+    queue.release( pRequest );
+    queue.shutdown();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AsyncReadQueueTests, DataAndCancel )
+{
+    AsyncReadQueue queue;
+    AsyncReadTestState state = { 0, NULL };
+
+    // Data that has already been read completes immediately.
+    U8* pData = (U8*)dRealMalloc( 16 );
+    dMemset( pData, 0x5A, 16 );
+    AsyncReadRequest* pRequest = queue.create( StringTable->insert( "asyncReadQueueTest/data" ), AsyncReadRequest::PriorityNormal, onAsyncReadTest, &state );
+    pRequest->setData( pData, 16 );
+    queue.submit( pRequest );
+    ASSERT_TRUE( pRequest->isDone() ) << "Request with data is not done.";
+    ASSERT_EQ( pRequest->getSize(), (U32)16 ) << "Request size is wrong.";
+
+    // The caller owns data it takes.
+    U8* pTaken = pRequest->takeData();
+    ASSERT_EQ( pTaken, pData ) << "Took the wrong data.";
+    ASSERT_TRUE( pRequest->getData() == NULL ) << "Data was not taken.";
+    dRealFree( pTaken );
+
+    queue.process();
+    ASSERT_EQ( state.mCallCount, (U32)1 ) << "Callback did not arrive.";
+    queue.release( pRequest );
+
+    // A cancelled request never calls back and its data is dropped.
+    pRequest = queue.create( StringTable->insert( "asyncReadQueueTest/cancel" ), AsyncReadRequest::PriorityNormal, onAsyncReadTest, &state );
+    pRequest->setData( (U8*)dRealMalloc( 16 ), 16 );
+    queue.submit( pRequest );
+    queue.cancel( pRequest );
+    ASSERT_FALSE( queue.cancel( pRequest ) ) << "Request was cancelled twice.";
+    queue.process();
+    ASSERT_EQ( state.mCallCount, (U32)1 ) << "Callback arrived for a cancelled request.";
+    ASSERT_EQ( pRequest->getStatus(), AsyncReadRequest::Cancelled ) << "Request was not cancelled.";
+    ASSERT_TRUE( pRequest->getData() == NULL ) << "Cancelled request kept its data.";
+
+    queue.release( pRequest );
+    queue.shutdown();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AsyncReadQueueTests, Prefetch )
+{
+    char filePaths[3][1024];
+    for ( U32 index = 0; index < 3; ++index )
+    {
+        formatTestFilePath( filePaths[index], sizeof(filePaths[index]), "prefetch", index );
+        ASSERT_TRUE( writeTestFile( filePaths[index], ASYNCREADQUEUE_UNITTEST_FILE_SIZE, U8(index + 100) ) ) << "Failed to write test file.";
+    }
+
+    for ( U32 index = 0; index < 3; ++index )
+        ASSERT_TRUE( ResourceManager->prefetch( filePaths[index] ) ) << "Failed to prefetch file.";
+
+    // Files that don't exist are not queued.
+    char missingPath[1024];
+    ASSERT_FALSE( ResourceManager->prefetch( formatTestFilePath( missingPath, sizeof(missingPath), "missing", 0 ) ) ) << "Prefetched a missing file.";
+    ASSERT_FALSE( ResourceManager->isPrefetchPending( missingPath ) ) << "Missing file is pending.";
+
+    // Take the prefetched files out of order.
+    const U32 order[3] = { 1, 0, 2 };
+    for ( U32 index = 0; index < 3; ++index )
+    {
+        const char* pFilePath = filePaths[order[index]];
+        Stream* pStream = ResourceManager->openPrefetchedStream( pFilePath );
+        ASSERT_TRUE( pStream != NULL ) << "Prefetched file could not be opened.";
+        ASSERT_FALSE( ResourceManager->isPrefetchPending( pFilePath ) ) << "Opened file is still pending.";
+        ASSERT_EQ( pStream->getStreamSize(), (U32)ASYNCREADQUEUE_UNITTEST_FILE_SIZE ) << "Prefetched size is wrong.";
+
+        U8* pBuffer = new U8[ASYNCREADQUEUE_UNITTEST_FILE_SIZE];
+        pStream->read( ASYNCREADQUEUE_UNITTEST_FILE_SIZE, pBuffer );
+        ASSERT_TRUE( checkTestData( pBuffer, ASYNCREADQUEUE_UNITTEST_FILE_SIZE, U8(order[index] + 100) ) ) << "Prefetched data is wrong.";
+        delete [] pBuffer;
+
+        ResourceManager->closeStream( pStream );
+
+        // A prefetched file is only handed out once.
+        ASSERT_TRUE( ResourceManager->openPrefetchedStream( pFilePath ) == NULL ) << "Prefetched file was handed out twice.";
+    }
+
+    ResourceManager->processAsyncReads();
+
+    for ( U32 index = 0; index < 3; ++index )
+        Platform::fileDelete( filePaths[index] );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,276 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _AUDIO_MIXER_H_
+#include "audio/audioMixer.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _MMATHFN_H_
+#include "math/mMathFn.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define AUDIOMIXER_UNITTEST_SAMPLE_RATE         44100
+#define AUDIOMIXER_UNITTEST_SAMPLE_FRAMES       4096
+#define AUDIOMIXER_UNITTEST_BENCHMARK_VOICES    32
+#define AUDIOMIXER_UNITTEST_BENCHMARK_SECONDS   30
+#define AUDIOMIXER_UNITTEST_TOLERANCE           0.001f
+
+//-----------------------------------------------------------------------------
+
+/// Keeps the last block written so the mix can be checked.
+class AudioMixerTestSink : public AudioMixerSink
+{
+public:
+    F32  mLastFrames[AudioMixer::DefaultBlockFrames * AudioMixer::OutputChannels];
+    U32  mLastFrameCount;
+    U32  mFramesWritten;
+
+    AudioMixerTestSink() : mLastFrameCount( 0 ), mFramesWritten( 0 ) {}
+
+    virtual bool open( const U32 sampleRate ) { mFramesWritten = 0; return true; }
+    virtual void write( const F32* pFrames, const U32 frameCount )
+    {
+        dMemcpy( mLastFrames, pFrames, frameCount * AudioMixer::OutputChannels * sizeof(F32) );
+        mLastFrameCount = frameCount;
+        mFramesWritten += frameCount;
+    }
+    virtual void close( void ) {}
+    virtual bool isRealTime( void ) const { return false; }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Create a mono sample holding a constant value.
+static AudioMixerSample* createAudioMixerTestSample( const S16 value, const U32 frameCount )
+{
+    S16* pData = new S16[frameCount];
+    for ( U32 frame = 0; frame < frameCount; ++frame )
+        pData[frame] = value;
+
+    AudioMixerSample* pSample = AudioMixerSample::createFromPCM( pData, frameCount * sizeof(S16), 16, 1, AUDIOMIXER_UNITTEST_SAMPLE_RATE );
+    delete [] pData;
+
+    return pSample;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioMixerTests, MixesAndClampsVoices )
+{
+    AudioMixerSample* pSample = createAudioMixerTestSample( 8192, AUDIOMIXER_UNITTEST_SAMPLE_FRAMES );
+    ASSERT_TRUE( pSample != NULL );
+
+    AudioMixerTestSink sink;
+    AudioMixer mixer( AUDIOMIXER_UNITTEST_SAMPLE_RATE );
+    ASSERT_TRUE( mixer.start( &sink, false ) );
+
+    // Two voices at a quarter of full scale.
+    const AudioMixer::VoiceHandle first = mixer.play( pSample, 1.0f, 1.0f, true );
+    const AudioMixer::VoiceHandle second = mixer.play( pSample, 0.5f, 1.0f, true );
+    ASSERT_NE( 0u, first );
+    ASSERT_NE( 0u, second );
+
+    mixer.render( AudioMixer::DefaultBlockFrames );
+    ASSERT_EQ( (U32)AudioMixer::DefaultBlockFrames, sink.mFramesWritten );
+
+    for ( U32 index = 0; index < sink.mLastFrameCount * AudioMixer::OutputChannels; ++index )
+        ASSERT_NEAR( 0.375f, sink.mLastFrames[index], AUDIOMIXER_UNITTEST_TOLERANCE );
+
+    // Louder voices are clamped to full scale.
+    for ( U32 voice = 0; voice < 4; ++voice )
+        mixer.play( pSample, 1.0f, 1.0f, true );
+
+    mixer.render( AudioMixer::DefaultBlockFrames );
+    for ( U32 index = 0; index < sink.mLastFrameCount * AudioMixer::OutputChannels; ++index )
+        ASSERT_EQ( 1.0f, sink.mLastFrames[index] );
+
+    mixer.stop();
+    ASSERT_EQ( 0u, mixer.getLiveVoiceCount() );
+
+    pSample->release();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioMixerTests, FinishedVoicesAreRetired )
+{
+    AudioMixerSample* pSample = createAudioMixerTestSample( 8192, 100 );
+
+    AudioMixerNullSink sink( false );
+    AudioMixer mixer( AUDIOMIXER_UNITTEST_SAMPLE_RATE );
+    ASSERT_TRUE( mixer.start( &sink, false ) );
+
+    const AudioMixer::VoiceHandle handle = mixer.play( pSample, 1.0f, 1.0f, false );
+    ASSERT_TRUE( mixer.isPlaying( handle ) );
+
+    // The voice ends part way through the first block.
+    mixer.render( AudioMixer::DefaultBlockFrames );
+    mixer.update();
+    ASSERT_FALSE( mixer.isPlaying( handle ) );
+    ASSERT_EQ( 0u, mixer.getLiveVoiceCount() );
+
+    mixer.stop();
+    pSample->release();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioMixerTests, CullsQuietVoices )
+{
+    AudioMixerSample* pSample = createAudioMixerTestSample( 8192, AUDIOMIXER_UNITTEST_SAMPLE_FRAMES );
+
+    AudioMixerNullSink sink( false );
+    AudioMixer mixer( AUDIOMIXER_UNITTEST_SAMPLE_RATE, 2 );
+    ASSERT_TRUE( mixer.start( &sink, false ) );
+
+    const AudioMixer::VoiceHandle quiet = mixer.play( pSample, 0.5f, 1.0f, true );
+    const AudioMixer::VoiceHandle loud = mixer.play( pSample, 0.8f, 1.0f, true );
+    const AudioMixer::VoiceHandle louder = mixer.play( pSample, 0.9f, 1.0f, true );
+    const AudioMixer::VoiceHandle inaudible = mixer.play( pSample, 0.01f, 1.0f, true );
+    const AudioMixer::VoiceHandle quieter = mixer.play( pSample, 0.6f, 1.0f, true );
+
+    mixer.render( AudioMixer::DefaultBlockFrames );
+    mixer.update();
+
+    // The quietest voice makes room, the inaudible one never starts and neither does one quieter than those playing.
+    ASSERT_FALSE( mixer.isPlaying( quiet ) );
+    ASSERT_TRUE( mixer.isPlaying( loud ) );
+    ASSERT_TRUE( mixer.isPlaying( louder ) );
+    ASSERT_FALSE( mixer.isPlaying( inaudible ) );
+    ASSERT_FALSE( mixer.isPlaying( quieter ) );
+
+    // Only the voice that was playing counts as culled.
+    const AudioMixer::Stats stats = mixer.getStats();
+    ASSERT_EQ( 2u, stats.mActiveVoices );
+    ASSERT_EQ( 3u, stats.mVoicesStarted );
+    ASSERT_EQ( 1u, stats.mVoicesCulled );
+    ASSERT_EQ( 2u, stats.mVoicesRejected );
+    ASSERT_EQ( 1u, stats.mBlocksMixed );
+
+    mixer.resetStats();
+    ASSERT_EQ( 0u, mixer.getStats().mBlocksMixed );
+
+    mixer.stop();
+    pSample->release();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioMixerTests, NegativePitchIsClamped )
+{
+    AudioMixerSample* pSample = createAudioMixerTestSample( 8192, 100 );
+
+    AudioMixerNullSink sink( false );
+    AudioMixer mixer( AUDIOMIXER_UNITTEST_SAMPLE_RATE );
+    ASSERT_TRUE( mixer.start( &sink, false ) );
+
+    // Neither voice moves so neither finishes.
+    const AudioMixer::VoiceHandle played = mixer.play( pSample, 1.0f, -1.0f, false );
+    const AudioMixer::VoiceHandle changed = mixer.play( pSample, 1.0f, 1.0f, false );
+    mixer.setPitch( changed, -2.0f );
+
+    mixer.render( AudioMixer::DefaultBlockFrames * 4 );
+    mixer.update();
+    ASSERT_TRUE( mixer.isPlaying( played ) );
+    ASSERT_TRUE( mixer.isPlaying( changed ) );
+
+    mixer.stop();
+    pSample->release();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioMixerTests, ThreadedStats )
+{
+    AudioMixerSample* pSample = createAudioMixerTestSample( 8192, AUDIOMIXER_UNITTEST_SAMPLE_FRAMES );
+
+    AudioMixerNullSink sink( false );
+    AudioMixer mixer( AUDIOMIXER_UNITTEST_SAMPLE_RATE );
+    ASSERT_TRUE( mixer.start( &sink, true ) );
+
+    mixer.play( pSample, 1.0f, 1.0f, true );
+
+    // Stats read whilst mixing are always consistent.
+    U32 blocksMixed = 0;
+    for ( U32 attempt = 0; attempt < 1000 && blocksMixed < 16; ++attempt )
+    {
+        const AudioMixer::Stats stats = mixer.getStats();
+        ASSERT_EQ( (U64)stats.mBlocksMixed * AudioMixer::DefaultBlockFrames, stats.mFramesMixed );
+        blocksMixed = stats.mBlocksMixed;
+        Platform::sleep( 1 );
+    }
+    ASSERT_GE( blocksMixed, 16u );
+
+    // The mixer thread resets its own counters.
+    mixer.resetStats();
+    mixer.stop();
+    ASSERT_LT( mixer.getStats().mBlocksMixed, blocksMixed );
+
+    pSample->release();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( AudioMixerTests, MixBenchmark )
+{
+    AudioMixerSample* pSample = createAudioMixerTestSample( 1024, AUDIOMIXER_UNITTEST_SAMPLE_FRAMES );
+
+    AudioMixerNullSink sink( false );
+    AudioMixer mixer( AUDIOMIXER_UNITTEST_SAMPLE_RATE, AUDIOMIXER_UNITTEST_BENCHMARK_VOICES );
+    ASSERT_TRUE( mixer.start( &sink, false ) );
+
+    // Every voice resamples at a different pitch.
+    for ( U32 voice = 0; voice < AUDIOMIXER_UNITTEST_BENCHMARK_VOICES; ++voice )
+        mixer.play( pSample, 0.5f, 0.5f + (F32(voice) / AUDIOMIXER_UNITTEST_BENCHMARK_VOICES), true );
+
+    const U32 frameCount = AUDIOMIXER_UNITTEST_SAMPLE_RATE * AUDIOMIXER_UNITTEST_BENCHMARK_SECONDS;
+    const U32 startTime = Platform::getRealMilliseconds();
+    mixer.render( frameCount );
+    const U32 elapsedTime = getMax( Platform::getRealMilliseconds() - startTime, (U32)1 );
+
+    ASSERT_EQ( (U64)frameCount, sink.getFramesWritten() );
+    ASSERT_EQ( (U32)AUDIOMIXER_UNITTEST_BENCHMARK_VOICES, mixer.getStats().mActiveVoices );
+
+    Con::printf( ">> AudioMixer mixed %d voices for %d seconds in %dms (%.1fx real time).",
+        AUDIOMIXER_UNITTEST_BENCHMARK_VOICES,
+        AUDIOMIXER_UNITTEST_BENCHMARK_SECONDS,
+        elapsedTime,
+        F32(AUDIOMIXER_UNITTEST_BENCHMARK_SECONDS * 1000) / F32(elapsedTime) );
+
+    mixer.stop();
+    pSample->release();
+}
+
+#endif // TORQUE_SHIPPING
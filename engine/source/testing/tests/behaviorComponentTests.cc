@@ -0,0 +1,172 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _BEHAVIOR_COMPONENT_H_
+#include "component/behaviors/behaviorComponent.h"
+#endif
+
+#ifndef _BEHAVIORTEMPLATE_H_
+#include "component/behaviors/behaviorTemplate.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define BEHAVIORCOMPONENT_UNITTEST_BEHAVIORS    10
+#define BEHAVIORCOMPONENT_UNITTEST_CALLS        100000
+
+//-----------------------------------------------------------------------------
+
+/// A registered component with a set of behaviors, each from its own template.
+class BehaviorComponentTestObject
+{
+public:
+    BehaviorComponent* mpComponent;
+    Vector<BehaviorTemplate*> mTemplates;
+
+    BehaviorComponentTestObject( const U32 behaviorCount )
+    {
+        // Reset the call count.
+        Con::setIntVariable( "$BehaviorComponentTest::Calls", 0 );
+
+        mpComponent = new BehaviorComponent();
+        mpComponent->registerObject();
+
+        for ( U32 n = 0; n < behaviorCount; ++n )
+        {
+            char templateName[64];
+            dSprintf( templateName, sizeof(templateName), "BehaviorComponentTest%d", n );
+
+            BehaviorTemplate* pTemplate = new BehaviorTemplate();
+            pTemplate->registerObject( templateName );
+            mTemplates.push_back( pTemplate );
+
+            mpComponent->addBehavior( pTemplate->createInstance() );
+        }
+    }
+
+    ~BehaviorComponentTestObject()
+    {
+        mpComponent->deleteObject();
+
+        for ( U32 n = 0; n < (U32)mTemplates.size(); ++n )
+            mTemplates[n]->deleteObject();
+    }
+
+    /// Call a method on the component a number of times.
+    /// @return The time taken in microseconds.
+    U64 callMethod( const char* pMethodName, const U32 callCount )
+    {
+        const U64 startTime = Platform::getRealMicroseconds();
+
+        for ( U32 n = 0; n < callCount; ++n )
+            Con::executef( mpComponent, 1, pMethodName );
+
+        return Platform::getRealMicroseconds() - startTime;
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+TEST( BehaviorComponentTests, RoutesMethods )
+{
+    BehaviorComponentTestObject object( 3 );
+    Con::evaluate( "function BehaviorComponentTest0::onRouteTest( %this ) { $BehaviorComponentTest::Calls++; }" );
+    Con::evaluate( "function BehaviorComponentTest2::onRouteTest( %this ) { $BehaviorComponentTest::Calls++; }" );
+
+    // Every behavior handling the method is called.
+    object.callMethod( "onRouteTest", 1 );
+    ASSERT_EQ( Con::getIntVariable( "$BehaviorComponentTest::Calls" ), 2 );
+    ASSERT_EQ( object.mpComponent->getBehaviorRouteCount(), 1 ) << "Method was not routed.";
+
+    // Repeated calls use the same route.
+    object.callMethod( "onRouteTest", 1 );
+    ASSERT_EQ( Con::getIntVariable( "$BehaviorComponentTest::Calls" ), 4 );
+    ASSERT_EQ( object.mpComponent->getBehaviorRouteCount(), 1 ) << "Method was routed again.";
+
+    // Methods no behavior handles are routed too.
+    S32 routingId = 0;
+    ASSERT_FALSE( object.mpComponent->handlesConsoleMethod( "onUnhandledRouteTest", &routingId ) );
+    ASSERT_EQ( object.mpComponent->getBehaviorRouteCount(), 2 ) << "Unhandled method was not routed.";
+
+    // Removing a behavior invalidates the routes.
+    object.mpComponent->removeBehavior( object.mpComponent->getBehavior( (U32)0 ) );
+    ASSERT_EQ( object.mpComponent->getBehaviorRouteCount(), 0 ) << "Routes were not invalidated.";
+    object.callMethod( "onRouteTest", 1 );
+    ASSERT_EQ( Con::getIntVariable( "$BehaviorComponentTest::Calls" ), 5 );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( BehaviorComponentTests, NamespaceChangeInvalidatesRoutes )
+{
+    BehaviorComponentTestObject object( 2 );
+
+    // Nothing handles the method yet.
+    S32 routingId = 0;
+    ASSERT_FALSE( object.mpComponent->handlesConsoleMethod( "onLateRouteTest", &routingId ) );
+
+    // Defining the method afterwards is picked up.
+    Con::evaluate( "function BehaviorComponentTest1::onLateRouteTest( %this ) { $BehaviorComponentTest::Calls++; }" );
+    ASSERT_TRUE( object.mpComponent->handlesConsoleMethod( "onLateRouteTest", &routingId ) ) << "Stale route was used.";
+    object.callMethod( "onLateRouteTest", 1 );
+    ASSERT_EQ( Con::getIntVariable( "$BehaviorComponentTest::Calls" ), 1 );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( BehaviorComponentTests, DispatchBenchmark )
+{
+    BehaviorComponentTestObject plainObject( 0 );
+    BehaviorComponentTestObject behaviorObject( BEHAVIORCOMPONENT_UNITTEST_BEHAVIORS );
+    Con::evaluate( "function BehaviorComponentTest0::onBenchmarkTest( %this ) { }" );
+
+    // Handled by a single behavior.
+    const U64 plainTime = plainObject.callMethod( "onBenchmarkTest", BEHAVIORCOMPONENT_UNITTEST_CALLS );
+    const U64 handledTime = behaviorObject.callMethod( "onBenchmarkTest", BEHAVIORCOMPONENT_UNITTEST_CALLS );
+
+    // Handled by no behavior.
+    const U64 unhandledTime = behaviorObject.callMethod( "onUnhandledBenchmarkTest", BEHAVIORCOMPONENT_UNITTEST_CALLS );
+
+    ASSERT_EQ( behaviorObject.mpComponent->getBehaviorRouteCount(), 2 );
+
+    Con::printf( ">> %d method calls: %.3f us per call on a plain component, %.3f us (handled) and %.3f us (unhandled) per call with %d behaviors.",
+        BEHAVIORCOMPONENT_UNITTEST_CALLS,
+        F64(plainTime) / BEHAVIORCOMPONENT_UNITTEST_CALLS,
+        F64(handledTime) / BEHAVIORCOMPONENT_UNITTEST_CALLS,
+        F64(unhandledTime) / BEHAVIORCOMPONENT_UNITTEST_CALLS,
+        BEHAVIORCOMPONENT_UNITTEST_BEHAVIORS );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _COMPILED_SCRIPT_CACHE_H_
+#include "console/compiledScriptCache.h"
+#endif
+
+#ifndef _CODEBLOCK_H_
+#include "console/codeBlock.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _STRINGTABLE_H_
+#include "string/stringTable.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define COMPILEDSCRIPTCACHE_UNITTEST_FILE   "compiledScriptCacheTest.cs"
+
+//-----------------------------------------------------------------------------
+
+TEST( CompiledScriptCacheTests, StoreAndLoad )
+{
+    // Use a cache in the temporary directory.
+    char cachePath[1024];
+    dSprintf( cachePath, sizeof(cachePath), "%s/compiledScriptCacheTest", Platform::getTemporaryDirectory() );
+    const char* pOldCachePath = StringTable->insert( Con::getVariable( "$Scripts::cachePath" ) );
+    Con::setVariable( "$Scripts::cachePath", cachePath );
+    ASSERT_TRUE( CompiledScriptCache::isEnabled() );
+
+    const char* pScript = "$CompiledScriptCacheTest::Result = \"cached\" @ 42;";
+    const char* pChangedScript = "$CompiledScriptCacheTest::Result = \"changed\";";
+    const StringTableEntry fileName = StringTable->insert( COMPILEDSCRIPTCACHE_UNITTEST_FILE );
+
+    // Nothing is cached for a script that has not been stored.
+    ASSERT_TRUE( CompiledScriptCache::store( fileName, pScript, dStrlen(pScript) ) ) << "Failed to write the cache.";
+    ASSERT_TRUE( CompiledScriptCache::load( fileName, pChangedScript, dStrlen(pChangedScript) ) == NULL ) << "Changed script was found in the cache.";
+
+    // The cached code runs.
+    CodeBlock* pCode = CompiledScriptCache::load( fileName, pScript, dStrlen(pScript) );
+    ASSERT_TRUE( pCode != NULL ) << "Stored script was not found in the cache.";
+    Con::setVariable( "$CompiledScriptCacheTest::Result", "" );
+    pCode->exec( 0, fileName, NULL, 0, NULL, false, NULL, 0 );
+    ASSERT_STREQ( Con::getVariable( "$CompiledScriptCacheTest::Result" ), "cached42" );
+
+    // Syntax errors are not stored.
+    const char* pBadScript = "$CompiledScriptCacheTest::Result = ;";
+    ASSERT_FALSE( CompiledScriptCache::store( fileName, pBadScript, dStrlen(pBadScript) ) );
+
+    Con::setVariable( "$Scripts::cachePath", pOldCachePath );
+}
+
+#endif // TORQUE_SHIPPING
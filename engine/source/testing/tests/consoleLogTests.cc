@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _FILESTREAM_H_
+#include "io/fileStream.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define CONSOLELOG_UNITTEST_FILE        "console.log"
+#define CONSOLELOG_UNITTEST_MARKER      64
+
+//-----------------------------------------------------------------------------
+
+TEST( ConsoleLogTests, ErrorsAreWrittenImmediately )
+{
+    // Log mode 2 holds the file open for writing so we can't read it back.
+    const S32 oldMode = Con::getLogMode();
+    if ( (oldMode & 0x3) == 2 )
+    {
+        Con::printf( ">> Skipping console log test in log mode 2." );
+        return;
+    }
+
+    // Log mode 1 appends to the file and closes it after every write.
+    const bool oldAsyncLog = Con::getBoolVariable( "$Con::asyncLog" );
+    Con::setBoolVariable( "$Con::asyncLog", true );
+    Con::setLogMode( 1 );
+
+    // A queued line followed by an error.
+    const U32 stamp = Platform::getRealMilliseconds();
+    char printMarker[CONSOLELOG_UNITTEST_MARKER];
+    char errorMarker[CONSOLELOG_UNITTEST_MARKER];
+    dSprintf( printMarker, sizeof(printMarker), "ConsoleLogTests printf %u", stamp );
+    dSprintf( errorMarker, sizeof(errorMarker), "ConsoleLogTests errorf %u", stamp );
+    Con::printf( printMarker );
+    Con::errorf( errorMarker );
+
+    // Read the file back before the writer thread gets a chance to run.
+    FileStream stream;
+    const bool opened = stream.open( CONSOLELOG_UNITTEST_FILE, FileStream::Read );
+    const U32 size = opened ? stream.getStreamSize() : 0;
+    char* pContents = new char[size + 1];
+    const bool read = opened && stream.read( size, pContents );
+    pContents[read ? size : 0] = 0;
+    stream.close();
+
+    // Restore the logging before checking so a failure leaves it as it was.
+    Con::setLogMode( oldMode );
+    Con::setBoolVariable( "$Con::asyncLog", oldAsyncLog );
+
+    // Both lines are in the file and in order.
+    const char* pPrintLine = dStrstr( (const char*)pContents, printMarker );
+    const char* pErrorLine = dStrstr( (const char*)pContents, errorMarker );
+    const bool found = pPrintLine != NULL && pErrorLine != NULL && pPrintLine < pErrorLine;
+    delete [] pContents;
+
+    ASSERT_TRUE( opened );
+    ASSERT_TRUE( read );
+    ASSERT_TRUE( found );
+}
+
+#endif // TORQUE_SHIPPING
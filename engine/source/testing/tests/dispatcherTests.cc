@@ -0,0 +1,388 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _DISPATCHER_H_
+#include "messaging/dispatcher.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_ATOMIC_H_
+#include "platform/threads/atomic.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_THREAD_H_
+#include "platform/threads/thread.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define DISPATCHER_UNITTEST_QUEUE       "DispatcherTestQueue"
+#define DISPATCHER_UNITTEST_THREADS     8
+#define DISPATCHER_UNITTEST_MESSAGES    50000
+#define DISPATCHER_UNITTEST_LISTENERS   200
+#define DISPATCHER_UNITTEST_ALIVE       0x600DF00D
+
+//-----------------------------------------------------------------------------
+
+/// Counts the messages it receives from any thread.
+class DispatcherTestListener : public Dispatcher::IMessageListener
+{
+public:
+    volatile S32 mReceived;
+    const char* mpUnregisterQueue;
+
+    DispatcherTestListener() : mReceived( 0 ), mpUnregisterQueue( NULL ) {}
+
+    virtual bool onMessageReceived( StringTableEntry queue, const char* msg, const char* data )
+    {
+        dAtomicIncrement( mReceived );
+
+        // Unregister whilst the listener list is being dispatched.
+        if ( mpUnregisterQueue != NULL )
+            Dispatcher::unregisterMessageListener( mpUnregisterQueue, this );
+
+        return true;
+    }
+
+    virtual bool onMessageObjectReceived( StringTableEntry queue, Message* msg ) { return true; }
+
+    inline S32 getReceived( void ) { return dAtomicAdd( mReceived, 0 ); }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Sends a number of messages to a queue.
+class DispatcherTestThread : public Thread
+{
+public:
+    Dispatcher::QueueHandle mQueue;
+    bool mPost;
+
+    DispatcherTestThread( Dispatcher::QueueHandle queue, bool post ) : Thread( 0, NULL, false ), mQueue( queue ), mPost( post ) {}
+
+    virtual void run( void* arg )
+    {
+        for ( U32 n = 0; n < DISPATCHER_UNITTEST_MESSAGES; ++n )
+        {
+            if ( mPost )
+                Dispatcher::postMessage( mQueue, "onTest", "" );
+            else
+                Dispatcher::dispatchMessage( DISPATCHER_UNITTEST_QUEUE, "onTest", "" );
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Checks it is still alive whenever it receives a message.
+class DispatcherTestCheckedListener : public Dispatcher::IMessageListener
+{
+public:
+    volatile U32 mAlive;
+    bool mReregister;
+    static volatile S32 smDeadCalls;
+
+    DispatcherTestCheckedListener() : mAlive( DISPATCHER_UNITTEST_ALIVE ), mReregister( false ) {}
+
+    virtual ~DispatcherTestCheckedListener()
+    {
+        // Unregister before the object is torn down.
+        Dispatcher::unregisterMessageListener( DISPATCHER_UNITTEST_QUEUE, this );
+        mAlive = 0;
+    }
+
+    virtual bool onMessageReceived( StringTableEntry queue, const char* msg, const char* data )
+    {
+        if ( mAlive != DISPATCHER_UNITTEST_ALIVE )
+            dAtomicIncrement( smDeadCalls );
+
+        // Swap the listener list from within the dispatch.
+        if ( mReregister )
+        {
+            Dispatcher::unregisterMessageListener( DISPATCHER_UNITTEST_QUEUE, this );
+            Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, this );
+        }
+
+        return true;
+    }
+
+    virtual bool onMessageObjectReceived( StringTableEntry queue, Message* msg ) { return true; }
+};
+
+volatile S32 DispatcherTestCheckedListener::smDeadCalls = 0;
+
+//-----------------------------------------------------------------------------
+
+/// Deletes another listener when it receives a message.
+class DispatcherTestDeletingListener : public Dispatcher::IMessageListener
+{
+public:
+    DispatcherTestCheckedListener* mpVictim;
+
+    DispatcherTestDeletingListener() : mpVictim( NULL ) {}
+
+    virtual bool onMessageReceived( StringTableEntry queue, const char* msg, const char* data )
+    {
+        delete mpVictim;
+        mpVictim = NULL;
+        return true;
+    }
+
+    virtual bool onMessageObjectReceived( StringTableEntry queue, Message* msg ) { return true; }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Dispatches to a queue until told to stop.
+class DispatcherTestLoopThread : public Thread
+{
+public:
+    Dispatcher::QueueHandle mQueue;
+    volatile U32 mStop;
+
+    DispatcherTestLoopThread( Dispatcher::QueueHandle queue ) : Thread( 0, NULL, false ), mQueue( queue ), mStop( 0 ) {}
+
+    virtual void run( void* arg )
+    {
+        while ( dAtomicRead( mStop ) == 0 )
+            Dispatcher::dispatchMessage( mQueue, "onTest", "" );
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Send messages from a number of threads, delivering posted messages until they have all been received.
+/// @return The time taken in microseconds.
+static U64 sendFromThreads( Dispatcher::QueueHandle queue, DispatcherTestListener& listener, bool post )
+{
+    const S32 messageCount = DISPATCHER_UNITTEST_THREADS * DISPATCHER_UNITTEST_MESSAGES;
+
+    const U64 startTime = Platform::getRealMicroseconds();
+
+    DispatcherTestThread* threads[DISPATCHER_UNITTEST_THREADS];
+    for ( U32 n = 0; n < DISPATCHER_UNITTEST_THREADS; ++n )
+    {
+        threads[n] = new DispatcherTestThread( queue, post );
+        threads[n]->start();
+    }
+
+    while ( listener.getReceived() < messageCount )
+    {
+        if ( Dispatcher::deliverPostedMessages() == 0 )
+            Platform::sleep( 0 );
+    }
+
+    for ( U32 n = 0; n < DISPATCHER_UNITTEST_THREADS; ++n )
+    {
+        threads[n]->join();
+        delete threads[n];
+    }
+
+    return Platform::getRealMicroseconds() - startTime;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( DispatcherTests, PostedMessagesAreDeferred )
+{
+    DispatcherTestListener listener;
+    ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, &listener ) );
+
+    const Dispatcher::QueueHandle queue = Dispatcher::getQueueHandle( DISPATCHER_UNITTEST_QUEUE );
+    ASSERT_NE( queue, Dispatcher::InvalidQueueHandle );
+
+    // Dispatching by handle is immediate.
+    Dispatcher::dispatchMessage( queue, "onTest", "" );
+    ASSERT_EQ( listener.getReceived(), 1 );
+
+    // Posting waits for delivery.
+    Dispatcher::postMessage( queue, "onTest", "" );
+    Dispatcher::postMessage( queue, "onTest", "" );
+    ASSERT_EQ( listener.getReceived(), 1 ) << "Posted message was delivered early.";
+    ASSERT_EQ( Dispatcher::deliverPostedMessages(), 2 );
+    ASSERT_EQ( listener.getReceived(), 3 );
+
+    // Handles to unregistered queues are ignored.
+    Dispatcher::unregisterMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+    Dispatcher::postMessage( queue, "onTest", "" );
+    ASSERT_EQ( Dispatcher::deliverPostedMessages(), 1 );
+    ASSERT_EQ( listener.getReceived(), 3 ) << "Message was delivered to an unregistered queue.";
+
+    // A new queue with the same name gets a new handle.
+    ASSERT_NE( Dispatcher::registerMessageQueue( DISPATCHER_UNITTEST_QUEUE ), queue );
+    Dispatcher::unregisterMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( DispatcherTests, UnregisterDuringDispatch )
+{
+    DispatcherTestListener firstListener;
+    DispatcherTestListener secondListener;
+    ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, &firstListener ) );
+    ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, &secondListener ) );
+
+    // Both listeners receive the message even though the first to receive it unregisters.
+    firstListener.mpUnregisterQueue = DISPATCHER_UNITTEST_QUEUE;
+    secondListener.mpUnregisterQueue = DISPATCHER_UNITTEST_QUEUE;
+    Dispatcher::dispatchMessage( DISPATCHER_UNITTEST_QUEUE, "onTest", "" );
+    ASSERT_EQ( firstListener.getReceived(), 1 );
+    ASSERT_EQ( secondListener.getReceived(), 1 );
+
+    // Neither listener receives later messages.
+    Dispatcher::dispatchMessage( DISPATCHER_UNITTEST_QUEUE, "onTest", "" );
+    ASSERT_EQ( firstListener.getReceived(), 1 );
+    ASSERT_EQ( secondListener.getReceived(), 1 );
+
+    Dispatcher::unregisterMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( DispatcherTests, DeleteDuringDispatch )
+{
+    DispatcherTestCheckedListener::smDeadCalls = 0;
+
+    // Listeners are added to the front so the victim is dispatched to after the listener that deletes it.
+    DispatcherTestCheckedListener* pVictim = new DispatcherTestCheckedListener();
+    DispatcherTestDeletingListener listener;
+    listener.mpVictim = pVictim;
+    ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, pVictim ) );
+    ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, &listener ) );
+
+    Dispatcher::dispatchMessage( DISPATCHER_UNITTEST_QUEUE, "onTest", "" );
+    ASSERT_TRUE( listener.mpVictim == NULL ) << "The listener was not dispatched to.";
+    ASSERT_EQ( dAtomicAdd( DispatcherTestCheckedListener::smDeadCalls, 0 ), 0 ) << "A listener was called after it was deleted.";
+
+    Dispatcher::unregisterMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( DispatcherTests, UnregisterWaitsForOtherThreads )
+{
+    const Dispatcher::QueueHandle queue = Dispatcher::registerMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+    ASSERT_NE( queue, Dispatcher::InvalidQueueHandle );
+
+    DispatcherTestCheckedListener::smDeadCalls = 0;
+
+    DispatcherTestLoopThread* threads[DISPATCHER_UNITTEST_THREADS];
+    for ( U32 n = 0; n < DISPATCHER_UNITTEST_THREADS; ++n )
+    {
+        threads[n] = new DispatcherTestLoopThread( queue );
+        threads[n]->start();
+    }
+
+    // Free listeners whilst the other threads are dispatching to them.
+    for ( U32 n = 0; n < DISPATCHER_UNITTEST_LISTENERS; ++n )
+    {
+        DispatcherTestCheckedListener* pListener = new DispatcherTestCheckedListener();
+        ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, pListener ) );
+        Platform::sleep( 0 );
+        delete pListener;
+    }
+
+    for ( U32 n = 0; n < DISPATCHER_UNITTEST_THREADS; ++n )
+    {
+        dAtomicWrite( threads[n]->mStop, 1 );
+        threads[n]->join();
+        delete threads[n];
+    }
+
+    ASSERT_EQ( dAtomicAdd( DispatcherTestCheckedListener::smDeadCalls, 0 ), 0 ) << "A listener was called after it was unregistered.";
+    ASSERT_EQ( Dispatcher::getRetiredCount(), (U32)0 ) << "Retired listener lists were not freed.";
+
+    Dispatcher::unregisterMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( DispatcherTests, RetiredListsAreFreedWhilstDispatching )
+{
+    const Dispatcher::QueueHandle queue = Dispatcher::registerMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+
+    // The listener swaps the listener list every time it receives a message.
+    DispatcherTestCheckedListener listener;
+    listener.mReregister = true;
+    ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, &listener ) );
+
+    DispatcherTestLoopThread thread( queue );
+    thread.start();
+
+    // Dispatch never stops so the lists must be freed whilst it is in progress.
+    U32 maxRetired = 0;
+    for ( U32 n = 0; n < DISPATCHER_UNITTEST_LISTENERS; ++n )
+    {
+        Platform::sleep( 1 );
+        Dispatcher::deliverPostedMessages();
+
+        const U32 retired = Dispatcher::getRetiredCount();
+        if ( retired > maxRetired )
+            maxRetired = retired;
+    }
+
+    dAtomicWrite( thread.mStop, 1 );
+    thread.join();
+
+    Dispatcher::deliverPostedMessages();
+    ASSERT_EQ( Dispatcher::getRetiredCount(), (U32)0 ) << "Retired listener lists were not freed.";
+
+    Con::printf( ">> At most %d listener lists were waiting to be freed.", maxRetired );
+
+    Dispatcher::unregisterMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( DispatcherTests, ThreadedPostBenchmark )
+{
+    DispatcherTestListener listener;
+    ASSERT_TRUE( Dispatcher::registerMessageListener( DISPATCHER_UNITTEST_QUEUE, &listener ) );
+    const Dispatcher::QueueHandle queue = Dispatcher::getQueueHandle( DISPATCHER_UNITTEST_QUEUE );
+
+    // Dispatching by name from each thread.
+    const U64 dispatchTime = sendFromThreads( queue, listener, false );
+
+    // Posting from each thread and delivering in batches.
+    listener.mReceived = 0;
+    const U64 postTime = sendFromThreads( queue, listener, true );
+
+    ASSERT_EQ( listener.getReceived(), DISPATCHER_UNITTEST_THREADS * DISPATCHER_UNITTEST_MESSAGES );
+
+    const F64 messageCount = DISPATCHER_UNITTEST_THREADS * DISPATCHER_UNITTEST_MESSAGES;
+    Con::printf( ">> %d threads sending %d messages each: %.0f messages per second dispatching by name, %.0f messages per second posting.",
+        DISPATCHER_UNITTEST_THREADS, DISPATCHER_UNITTEST_MESSAGES,
+        messageCount * 1000000.0 / F64(dispatchTime),
+        messageCount * 1000000.0 / F64(postTime) );
+
+    Dispatcher::unregisterMessageQueue( DISPATCHER_UNITTEST_QUEUE );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,213 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _FRAMEALLOCATOR_H_
+#include "memory/frameAllocator.h"
+#endif
+
+#ifndef _PLATFORM_THREADS_THREAD_H_
+#include "platform/threads/thread.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define FRAMEALLOCATOR_UNITTEST_ALLOCATIONS     64
+#define FRAMEALLOCATOR_UNITTEST_SIZE            5000
+#define FRAMEALLOCATOR_UNITTEST_TAG_SIZE        100
+
+//-----------------------------------------------------------------------------
+
+/// What a test saw on its own thread.
+struct FrameAllocatorTestResult
+{
+    U32 mFrameSize;
+    U32 mFrameSizeAfterGrowth;
+    U32 mPeakWaterMark;
+    U32 mWaterMarkAfterRelease;
+    U32 mWaterMarkAfterScope;
+    U32 mInnerTagPeak;
+    U32 mOuterTagPeak;
+    U32 mUnusedTagPeak;
+    bool mAligned;
+    bool mIntact;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Runs a test on a worker thread so it gets an arena of its own.
+class FrameAllocatorTestThread : public Thread
+{
+public:
+    typedef void (*TestFunction)( FrameAllocatorTestResult& result );
+
+    TestFunction mFunction;
+    FrameAllocatorTestResult mResult;
+
+    FrameAllocatorTestThread( TestFunction function ) : Thread( 0, NULL, false ), mFunction( function )
+    {
+        dMemset( &mResult, 0, sizeof(mResult) );
+    }
+
+    virtual void run( void* arg )
+    {
+        mFunction( mResult );
+        FrameAllocator::releaseThread();
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+static FrameAllocatorTestResult runFrameAllocatorTest( FrameAllocatorTestThread::TestFunction function )
+{
+    FrameAllocatorTestThread thread( function );
+    thread.start();
+    thread.join();
+    return thread.mResult;
+}
+
+//-----------------------------------------------------------------------------
+
+/// Allocate well past the first block and check nothing overlaps.
+static void testFrameAllocatorGrowth( FrameAllocatorTestResult& result )
+{
+    result.mFrameSize = FrameAllocator::getHighWaterMark();
+    result.mAligned = true;
+    result.mIntact = true;
+
+    U8* allocations[FRAMEALLOCATOR_UNITTEST_ALLOCATIONS];
+    for ( U32 pass = 0; pass < 2; ++pass )
+    {
+        for ( U32 index = 0; index < FRAMEALLOCATOR_UNITTEST_ALLOCATIONS; ++index )
+        {
+            allocations[index] = (U8*)FrameAllocator::alloc( FRAMEALLOCATOR_UNITTEST_SIZE );
+            result.mAligned &= ( (dsize_t)allocations[index] & 3 ) == 0;
+            dMemset( allocations[index], U8( index + pass ), FRAMEALLOCATOR_UNITTEST_SIZE );
+        }
+
+        for ( U32 index = 0; index < FRAMEALLOCATOR_UNITTEST_ALLOCATIONS; ++index )
+        {
+            for ( U32 offset = 0; offset < FRAMEALLOCATOR_UNITTEST_SIZE; ++offset )
+                result.mIntact &= allocations[index][offset] == U8( index + pass );
+        }
+
+        // The second pass reuses the blocks the first one linked.
+        FrameAllocator::setWaterMark( 0 );
+    }
+
+    result.mFrameSizeAfterGrowth = FrameAllocator::getHighWaterMark();
+    result.mPeakWaterMark = FrameAllocator::getPeakWaterMark();
+    result.mWaterMarkAfterRelease = FrameAllocator::getWaterMark();
+}
+
+//-----------------------------------------------------------------------------
+
+/// Allocate inside nested tagged markers.
+static void testFrameAllocatorTags( FrameAllocatorTestResult& result )
+{
+    const U32 start = FrameAllocator::getWaterMark();
+
+    {
+        FrameAllocatorMarker outer( "FrameAllocatorTests::outer" );
+        outer.alloc( FRAMEALLOCATOR_UNITTEST_TAG_SIZE );
+
+        // The same tag twice records the larger scope, not the sum.
+        for ( U32 scope = 1; scope <= 2; ++scope )
+        {
+            FrameAllocatorMarker inner( "FrameAllocatorTests::inner" );
+            inner.alloc( FRAMEALLOCATOR_UNITTEST_TAG_SIZE * scope );
+        }
+    }
+
+    result.mWaterMarkAfterScope = FrameAllocator::getWaterMark() - start;
+    result.mInnerTagPeak = FrameAllocator::getTagPeak( "FrameAllocatorTests::inner" );
+    result.mOuterTagPeak = FrameAllocator::getTagPeak( "FrameAllocatorTests::outer" );
+    result.mUnusedTagPeak = FrameAllocator::getTagPeak( "FrameAllocatorTests::unused" );
+
+    FrameAllocator::setWaterMark( 0 );
+}
+
+//-----------------------------------------------------------------------------
+
+static void testFrameAllocatorIdle( FrameAllocatorTestResult& result )
+{
+    FrameAllocator::setWaterMark( FrameAllocator::getWaterMark() );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( FrameAllocatorTests, GrowsAcrossBlocks )
+{
+    const FrameAllocatorTestResult result = runFrameAllocatorTest( testFrameAllocatorGrowth );
+
+    // Worker threads keep the frame size they started with however far they grow.
+    ASSERT_EQ( (U32)FrameAllocator::ThreadBlockSize, result.mFrameSize );
+    ASSERT_EQ( result.mFrameSize, result.mFrameSizeAfterGrowth );
+
+    ASSERT_GE( result.mPeakWaterMark, (U32)( FRAMEALLOCATOR_UNITTEST_ALLOCATIONS * FRAMEALLOCATOR_UNITTEST_SIZE ) );
+    ASSERT_GT( result.mPeakWaterMark, result.mFrameSize );
+    ASSERT_EQ( 0U, result.mWaterMarkAfterRelease );
+    ASSERT_TRUE( result.mAligned );
+    ASSERT_TRUE( result.mIntact );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( FrameAllocatorTests, TaggedMarkers )
+{
+    const FrameAllocatorTestResult result = runFrameAllocatorTest( testFrameAllocatorTags );
+
+    // Markers put the water mark back.
+    ASSERT_EQ( 0U, result.mWaterMarkAfterScope );
+
+    // Debug builds add a guard word to each allocation.
+    ASSERT_GE( result.mInnerTagPeak, (U32)( FRAMEALLOCATOR_UNITTEST_TAG_SIZE * 2 ) );
+    ASSERT_LT( result.mInnerTagPeak, (U32)( FRAMEALLOCATOR_UNITTEST_TAG_SIZE * 3 ) );
+
+    // The outer scope saw its own allocation plus the larger inner one.
+    ASSERT_GE( result.mOuterTagPeak, (U32)( FRAMEALLOCATOR_UNITTEST_TAG_SIZE * 3 ) );
+    ASSERT_LT( result.mOuterTagPeak, (U32)( FRAMEALLOCATOR_UNITTEST_TAG_SIZE * 4 ) );
+
+    ASSERT_EQ( 0U, result.mUnusedTagPeak );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( FrameAllocatorTests, ReleasedArenasAreReused )
+{
+    runFrameAllocatorTest( testFrameAllocatorGrowth );
+    const U32 arenaCount = FrameAllocator::getArenaCount();
+
+    // Threads that release their arena before exiting hand it on.
+    for ( U32 thread = 0; thread < 8; ++thread )
+        runFrameAllocatorTest( testFrameAllocatorIdle );
+
+    ASSERT_EQ( arenaCount, FrameAllocator::getArenaCount() );
+}
+
+#endif // TORQUE_SHIPPING
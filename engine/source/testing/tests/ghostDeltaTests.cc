@@ -0,0 +1,412 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _GHOSTDELTA_H_
+#include "network/ghostDelta.h"
+#endif
+
+#ifndef _BITSTREAM_H_
+#include "io/bitStream.h"
+#endif
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define GHOSTDELTA_UNITTEST_FIELDS          6
+#define GHOSTDELTA_UNITTEST_PACKET_SIZE     1400
+
+//-----------------------------------------------------------------------------
+
+/// Counts the records a receiver decodes.
+class GhostDeltaTestListener : public GhostDeltaListener
+{
+public:
+    GhostDeltaTestListener() : mCreates( 0 ), mUpdates( 0 ), mRemoves( 0 ) {}
+
+    virtual void onDeltaCreate( const U32 slot, StringTableEntry tag, const S32* pFields ) { mCreates++; }
+    virtual void onDeltaUpdate( const U32 slot, const S32* pFields ) { mUpdates++; }
+    virtual void onDeltaRemove( const U32 slot ) { mRemoves++; }
+
+    U32 mCreates;
+    U32 mUpdates;
+    U32 mRemoves;
+};
+
+//-----------------------------------------------------------------------------
+
+/// A packet written by the channel and not yet delivered or dropped.
+struct GhostDeltaTestPacket
+{
+    U8 mBuffer[GHOSTDELTA_UNITTEST_PACKET_SIZE * 2];
+    bool mPending;
+};
+
+//-----------------------------------------------------------------------------
+
+static bool ghostDeltaMatches( const GhostDeltaSource& source, const GhostDeltaReceiver& receiver )
+{
+    for ( U32 slot = 0; slot < source.getSlotCount(); ++slot )
+    {
+        const GhostDeltaSource::Slot& entry = source.getSlot( slot );
+
+        if ( entry.mActive != receiver.isActive( slot ) )
+            return false;
+
+        if ( entry.mActive && dMemcmp( entry.mFields, receiver.getFields( slot ), sizeof(S32) * source.getFieldCount() ) != 0 )
+            return false;
+    }
+
+    // The receiver must not hold anything the source does not.
+    for ( U32 slot = source.getSlotCount(); slot < receiver.getSlotCount(); ++slot )
+    {
+        if ( receiver.isActive( slot ) )
+            return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( GhostDeltaTests, VarIntRoundTrip )
+{
+    static const S32 values[] = { 0, 1, -1, 7, -8, 8, 511, -512, 512, 131071, -131072, 131072, 2147483647, -2147483647 - 1 };
+    const U32 valueCount = sizeof(values) / sizeof(S32);
+
+    U8 buffer[256];
+    BitStream stream( buffer, sizeof(buffer) );
+
+    for ( U32 index = 0; index < valueCount; ++index )
+        stream.writeVarS32( values[index] );
+
+    // Small values must stay small.
+    stream.setCurPos( 0 );
+    stream.writeVarS32( -3 );
+    ASSERT_EQ( stream.getCurPos(), 5 ) << "Small deltas should take five bits.";
+
+    stream.setCurPos( 0 );
+    for ( U32 index = 0; index < valueCount; ++index )
+        stream.writeVarS32( values[index] );
+
+    stream.setCurPos( 0 );
+    for ( U32 index = 0; index < valueCount; ++index )
+        ASSERT_EQ( stream.readVarS32(), values[index] ) << "Variable length integer did not round trip.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( GhostDeltaTests, PacketLossConverges )
+{
+    RandomLCG random( 1971 );
+
+    GhostDeltaSource source( GHOSTDELTA_UNITTEST_FIELDS );
+    GhostDeltaChannel channel( &source );
+    GhostDeltaReceiver receiver( GHOSTDELTA_UNITTEST_FIELDS );
+    GhostDeltaTestListener listener;
+
+    // Keep a few packets in flight so baselines are chosen while updates are outstanding.
+    const U32 latency = 6;
+    GhostDeltaTestPacket packets[latency + 1];
+    U32 packetHead = 0;
+    U32 packetCount = 0;
+
+    StringTableEntry tag = StringTable->insert( "TestObject" );
+    S32 fields[GHOSTDELTA_UNITTEST_FIELDS];
+
+    U32 dropped = 0;
+
+    for ( U32 tick = 0; tick < 3000; ++tick )
+    {
+        // Churn the source, keep losing packets for a while after it stops, then let it settle.
+        const bool churn = tick < 1500;
+        const bool lossy = tick < 2000;
+
+        if ( churn )
+        {
+            // Create and remove slots so generations are reused.
+            if ( source.getActiveSlotCount() < 24 || random.randF() < 0.2f )
+            {
+                for ( U32 field = 0; field < GHOSTDELTA_UNITTEST_FIELDS; ++field )
+                    fields[field] = random.randRangeI( -100000, 100000 );
+
+                source.allocateSlot( tag, fields );
+            }
+
+            if ( random.randF() < 0.2f )
+            {
+                const U32 slot = random.randRangeI( 0, source.getSlotCount() - 1 );
+
+                if ( source.getSlot( slot ).mActive )
+                    source.freeSlot( slot );
+            }
+
+            // Move some of the slots by small and occasionally large amounts.
+            for ( U32 slot = 0; slot < source.getSlotCount(); ++slot )
+            {
+                const GhostDeltaSource::Slot& entry = source.getSlot( slot );
+
+                if ( !entry.mActive || random.randF() < 0.5f )
+                    continue;
+
+                dMemcpy( fields, entry.mFields, sizeof(fields) );
+                fields[random.randRangeI( 0, GHOSTDELTA_UNITTEST_FIELDS - 1 )] += random.randF() < 0.9f ? random.randRangeI( -20, 20 ) : random.randRangeI( -1000000, 1000000 );
+                source.setFields( slot, fields );
+            }
+        }
+
+        // Write a small packet so that not everything fits at once.
+        GhostDeltaTestPacket& packet = packets[(packetHead + packetCount) % (latency + 1)];
+        BitStream writeStream( packet.mBuffer, 200, sizeof(packet.mBuffer) );
+        packet.mPending = channel.writePacket( &writeStream );
+        ASSERT_TRUE( writeStream.isValid() ) << "Packet overflowed its buffer.";
+        packetCount++;
+
+        if ( packetCount <= latency )
+            continue;
+
+        // Deliver or drop the oldest packet, in order, as the connection would.
+        GhostDeltaTestPacket& oldest = packets[packetHead];
+        packetHead = (packetHead + 1) % (latency + 1);
+        packetCount--;
+
+        if ( lossy && random.randF() < 0.3f )
+        {
+            channel.packetNotify( false );
+            dropped++;
+            continue;
+        }
+
+        BitStream readStream( oldest.mBuffer, sizeof(oldest.mBuffer) );
+        ASSERT_TRUE( receiver.readPacket( &readStream, &listener ) ) << "Failed to read packet.";
+        channel.packetNotify( true );
+    }
+
+    ASSERT_GT( dropped, 0 ) << "No packets were dropped.";
+    ASSERT_GT( listener.mRemoves, 0 ) << "No slots were removed.";
+    ASSERT_TRUE( ghostDeltaMatches( source, receiver ) ) << "Receiver did not converge on the source after packet loss.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( GhostDeltaTests, SnapshotIsNotNotified )
+{
+    RandomLCG random( 2036 );
+
+    GhostDeltaSource source( GHOSTDELTA_UNITTEST_FIELDS );
+    GhostDeltaChannel channel( &source );
+    GhostDeltaReceiver receiver( GHOSTDELTA_UNITTEST_FIELDS );
+    GhostDeltaTestListener listener;
+
+    StringTableEntry tag = StringTable->insert( "TestObject" );
+    S32 fields[GHOSTDELTA_UNITTEST_FIELDS];
+
+    for ( U32 slot = 0; slot < 32; ++slot )
+    {
+        for ( U32 field = 0; field < GHOSTDELTA_UNITTEST_FIELDS; ++field )
+            fields[field] = random.randRangeI( -100000, 100000 );
+
+        source.allocateSlot( tag, fields );
+    }
+
+    GhostDeltaTestPacket packets[2];
+    U8 snapshot[GHOSTDELTA_UNITTEST_PACKET_SIZE * 2];
+
+    for ( U32 client = 0; client < 2; ++client )
+    {
+        // Leave packets in flight so the snapshot has to reset past them.
+        for ( U32 index = 0; index < 2; ++index )
+        {
+            BitStream writeStream( packets[index].mBuffer, 200, sizeof(packets[index].mBuffer) );
+            channel.writePacket( &writeStream );
+        }
+
+        // Start a client from a snapshot, as the guaranteed event for a ScopeAlways ghost does.
+        BitStream snapshotStream( snapshot, 200, sizeof(snapshot) );
+        ASSERT_TRUE( channel.writeSnapshot( &snapshotStream ) ) << "The snapshot should not fit in a small packet.";
+        ASSERT_EQ( channel.getPacketsInFlight(), 0 ) << "The snapshot is waiting for a notification.";
+
+        receiver.reset( &listener );
+        BitStream snapshotReadStream( snapshot, sizeof(snapshot) );
+        ASSERT_TRUE( receiver.readPacket( &snapshotReadStream, &listener ) ) << "Failed to read the snapshot.";
+
+        // The packets from before the snapshot were for the previous client.
+        channel.packetNotify( false );
+        channel.packetNotify( true );
+
+        // Move the slots while keeping a packet in flight and dropping every third one.
+        for ( U32 tick = 0; tick < 200; ++tick )
+        {
+            if ( tick < 100 )
+            {
+                for ( U32 slot = 0; slot < source.getSlotCount(); ++slot )
+                {
+                    if ( random.randF() < 0.5f )
+                        continue;
+
+                    dMemcpy( fields, source.getSlot( slot ).mFields, sizeof(fields) );
+                    fields[random.randRangeI( 0, GHOSTDELTA_UNITTEST_FIELDS - 1 )] += random.randRangeI( -20, 20 );
+                    source.setFields( slot, fields );
+                }
+            }
+
+            BitStream writeStream( packets[tick & 1].mBuffer, 200, sizeof(packets[tick & 1].mBuffer) );
+            channel.writePacket( &writeStream );
+
+            if ( tick == 0 )
+                continue;
+
+            if ( tick < 150 && tick % 3 == 0 )
+            {
+                channel.packetNotify( false );
+                continue;
+            }
+
+            BitStream readStream( packets[(tick - 1) & 1].mBuffer, sizeof(packets[(tick - 1) & 1].mBuffer) );
+            ASSERT_TRUE( receiver.readPacket( &readStream, &listener ) ) << "Failed to read packet.";
+            channel.packetNotify( true );
+        }
+
+        BitStream readStream( packets[1].mBuffer, sizeof(packets[1].mBuffer) );
+        ASSERT_TRUE( receiver.readPacket( &readStream, &listener ) ) << "Failed to read packet.";
+        channel.packetNotify( true );
+
+        ASSERT_EQ( channel.getPacketsInFlight(), 0 ) << "Notifications are out of step with the packets.";
+        ASSERT_TRUE( ghostDeltaMatches( source, receiver ) ) << "Receiver did not converge on the source after a snapshot.";
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( GhostDeltaTests, LoopbackBenchmark )
+{
+    const U32 objectCount = 10000;
+    const U32 tickCount = 60;
+    const F32 positionQuantum = 0.01f;
+    const F32 velocityQuantum = 0.01f;
+    const F32 tickTime = 1.0f / 60.0f;
+
+    RandomLCG random( 2013 );
+
+    GhostDeltaSource source( GHOSTDELTA_UNITTEST_FIELDS );
+    GhostDeltaChannel channel( &source );
+    GhostDeltaReceiver receiver( GHOSTDELTA_UNITTEST_FIELDS );
+    GhostDeltaTestListener listener;
+
+    // Objects moving at constant velocity.
+    Vector<F32> state;
+    state.setSize( objectCount * 4 );
+
+    StringTableEntry tag = StringTable->insert( "Sprite" );
+    S32 fields[GHOSTDELTA_UNITTEST_FIELDS];
+    dMemset( fields, 0, sizeof(fields) );
+
+    for ( U32 object = 0; object < objectCount; ++object )
+    {
+        F32* pState = state.address() + object * 4;
+        pState[0] = random.randRangeF( -500.0f, 500.0f );
+        pState[1] = random.randRangeF( -500.0f, 500.0f );
+        pState[2] = random.randRangeF( -10.0f, 10.0f );
+        pState[3] = random.randRangeF( -10.0f, 10.0f );
+
+        fields[0] = GhostDelta::quantize( pState[0], positionQuantum );
+        fields[1] = GhostDelta::quantize( pState[1], positionQuantum );
+        fields[3] = GhostDelta::quantize( pState[2], velocityQuantum );
+        fields[4] = GhostDelta::quantize( pState[3], velocityQuantum );
+        source.allocateSlot( tag, fields );
+    }
+
+    U8 buffer[GHOSTDELTA_UNITTEST_PACKET_SIZE * 2];
+    U32 totalBytes = 0;
+    U32 totalPackets = 0;
+    U64 totalMicroseconds = 0;
+
+    for ( U32 tick = 0; tick <= tickCount; ++tick )
+    {
+        // The first pass only creates the objects.
+        if ( tick > 0 )
+        {
+            for ( U32 object = 0; object < objectCount; ++object )
+            {
+                F32* pState = state.address() + object * 4;
+                pState[0] += pState[2] * tickTime;
+                pState[1] += pState[3] * tickTime;
+
+                dMemcpy( fields, source.getSlot( object ).mFields, sizeof(fields) );
+                fields[0] = GhostDelta::quantize( pState[0], positionQuantum );
+                fields[1] = GhostDelta::quantize( pState[1], positionQuantum );
+                source.setFields( object, fields );
+            }
+        }
+
+        const U64 startTime = Platform::getRealMicroseconds();
+        U32 tickBytes = 0;
+
+        // Send until everything that changed this tick has been written.
+        bool pending = true;
+        while( pending )
+        {
+            BitStream writeStream( buffer, GHOSTDELTA_UNITTEST_PACKET_SIZE, sizeof(buffer) );
+            pending = channel.writePacket( &writeStream );
+            tickBytes += writeStream.getPosition();
+            totalPackets += tick > 0 ? 1 : 0;
+
+            BitStream readStream( buffer, sizeof(buffer) );
+            ASSERT_TRUE( receiver.readPacket( &readStream, &listener ) ) << "Failed to read packet.";
+            channel.packetNotify( true );
+        }
+
+        if ( tick > 0 )
+        {
+            totalMicroseconds += Platform::getRealMicroseconds() - startTime;
+            totalBytes += tickBytes;
+        }
+    }
+
+    ASSERT_EQ( listener.mCreates, objectCount ) << "Not every object was created.";
+    ASSERT_TRUE( ghostDeltaMatches( source, receiver ) ) << "Receiver does not match the source.";
+
+    // Compare against sending every field in full.
+    const U32 fullBytes = objectCount * GHOSTDELTA_UNITTEST_FIELDS * sizeof(S32);
+    const U32 bytesPerTick = totalBytes / tickCount;
+
+    Con::printf( ">> %d objects: %d bytes/tick (%d packets/tick), %.1f%% of uncompressed, %d us/tick encode and decode.",
+        objectCount, bytesPerTick, totalPackets / tickCount, 100.0f * F32(bytesPerTick) / F32(fullBytes), U32(totalMicroseconds / tickCount) );
+
+    ASSERT_LT( bytesPerTick, fullBytes / 3 ) << "Delta compression is not saving enough.";
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,154 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _GUICANVAS_H_
+#include "gui/guiCanvas.h"
+#endif
+
+#ifndef _GUITYPES_H_
+#include "gui/guiTypes.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+/// Enough frames for every dirty region to age out of the update union.
+#define GUICANVAS_UNITTEST_FLUSH_FRAMES     3
+
+//-----------------------------------------------------------------------------
+
+/// Build update unions until nothing is dirty.
+static void flushGuiCanvasTestRegions( GuiCanvas* pCanvas )
+{
+    RectI updateUnion;
+    for ( U32 frame = 0; frame < GUICANVAS_UNITTEST_FLUSH_FRAMES; ++frame )
+        pCanvas->buildUpdateUnion( &updateUnion );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( GuiCanvasTests, UpdateUnionSkipsEmptyRegions )
+{
+    GuiCanvas* pCanvas = new GuiCanvas();
+
+    // A reset repaints everything for every buffer.
+    pCanvas->resetUpdateRegions();
+    RectI updateUnion;
+    for ( U32 frame = 0; frame < GUICANVAS_UNITTEST_FLUSH_FRAMES; ++frame )
+    {
+        pCanvas->buildUpdateUnion( &updateUnion );
+        ASSERT_TRUE( updateUnion == pCanvas->getBounds() );
+    }
+
+    // Nothing is dirty now.
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_FALSE( updateUnion.isValidRect() );
+
+    // A region away from the origin is not stretched to meet it.
+    const RectI dirty( 100, 120, 10, 20 );
+    pCanvas->addUpdateRegion( dirty.point, dirty.extent );
+    for ( U32 frame = 0; frame < GUICANVAS_UNITTEST_FLUSH_FRAMES; ++frame )
+    {
+        pCanvas->buildUpdateUnion( &updateUnion );
+        ASSERT_TRUE( updateUnion == dirty );
+    }
+
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_FALSE( updateUnion.isValidRect() );
+
+    // Empty regions are ignored.
+    pCanvas->addUpdateRegion( Point2I( 50, 50 ), Point2I( 0, 0 ) );
+    pCanvas->addUpdateRegion( Point2I( 50, 50 ), Point2I( 10, 0 ) );
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_FALSE( updateUnion.isValidRect() );
+
+    // Separate regions merge into their bounds.
+    pCanvas->addUpdateRegion( Point2I( 100, 100 ), Point2I( 10, 10 ) );
+    pCanvas->addUpdateRegion( Point2I( 200, 150 ), Point2I( 10, 10 ) );
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_TRUE( updateUnion == RectI( 100, 100, 110, 60 ) );
+
+    delete pCanvas;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( GuiCanvasTests, CursorDirtiesOnlyWhenChanged )
+{
+    GuiCanvas* pCanvas = new GuiCanvas();
+    GuiCursor* pCursor = new GuiCursor();
+    GuiCursor* pOtherCursor = new GuiCursor();
+    pOtherCursor->setDataField( StringTable->insert( "hotSpot" ), NULL, "4 4" );
+
+    pCanvas->resetUpdateRegions();
+    flushGuiCanvasTestRegions( pCanvas );
+
+    // The first cursor draw dirties the area around it.
+    RectI updateUnion;
+    pCanvas->updateCursorRegion( pCursor, true, Point2I( 50, 50 ) );
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_TRUE( updateUnion == RectI( 48, 48, 5, 5 ) );
+    flushGuiCanvasTestRegions( pCanvas );
+
+    // A cursor that stays put leaves the canvas idle.
+    for ( U32 frame = 0; frame < 10; ++frame )
+    {
+        pCanvas->updateCursorRegion( pCursor, true, Point2I( 50, 50 ) );
+        pCanvas->buildUpdateUnion( &updateUnion );
+        ASSERT_FALSE( updateUnion.isValidRect() );
+    }
+
+    // Moving dirties both the old and new areas.
+    pCanvas->updateCursorRegion( pCursor, true, Point2I( 60, 70 ) );
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_TRUE( updateUnion == RectI( 48, 48, 15, 25 ) );
+    flushGuiCanvasTestRegions( pCanvas );
+
+    // Changing the image dirties the area of each.
+    pCanvas->updateCursorRegion( pOtherCursor, true, Point2I( 60, 70 ) );
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_TRUE( updateUnion == RectI( 54, 64, 9, 9 ) );
+    flushGuiCanvasTestRegions( pCanvas );
+
+    // Hiding dirties the area it leaves.
+    pCanvas->updateCursorRegion( pOtherCursor, false, Point2I( 60, 70 ) );
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_TRUE( updateUnion == RectI( 54, 64, 5, 5 ) );
+    flushGuiCanvasTestRegions( pCanvas );
+
+    // A hidden cursor dirties nothing as it moves.
+    pCanvas->updateCursorRegion( pOtherCursor, false, Point2I( 80, 90 ) );
+    pCanvas->buildUpdateUnion( &updateUnion );
+    ASSERT_FALSE( updateUnion.isValidRect() );
+
+    delete pOtherCursor;
+    delete pCursor;
+    delete pCanvas;
+}
+
+#endif // TORQUE_SHIPPING
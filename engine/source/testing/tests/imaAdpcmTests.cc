@@ -0,0 +1,209 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _IMA_ADPCM_H_
+#include "audio/imaAdpcm.h"
+#endif
+
+#ifndef _MMATH_H_
+#include "math/mMath.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define IMAADPCM_UNITTEST_BLOCK_SIZE        256
+#define IMAADPCM_UNITTEST_FRAMES            505
+#define IMAADPCM_UNITTEST_MAX_ERROR         512
+
+//-----------------------------------------------------------------------------
+
+/// Encode a mono block the way a reference IMA ADPCM encoder would.
+static void encodeImaAdpcmTestBlock( const S16* pSamples, U8* pBlock )
+{
+    static const S32 stepTable[89] =
+    {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+        19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+        130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+        876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+        5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+    static const S32 indexTable[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+    // The header holds the first sample.
+    S32 predictor = pSamples[0];
+    S32 stepIndex = 0;
+    pBlock[0] = U8( predictor & 0xFF );
+    pBlock[1] = U8( (predictor >> 8) & 0xFF );
+    pBlock[2] = U8( stepIndex );
+    pBlock[3] = 0;
+
+    U8* pData = pBlock + 4;
+    for ( U32 frame = 1; frame < IMAADPCM_UNITTEST_FRAMES; ++frame )
+    {
+        const S32 step = stepTable[stepIndex];
+        S32 delta = pSamples[frame] - predictor;
+
+        U8 nibble = 0;
+        if ( delta < 0 )
+        {
+            nibble = 8;
+            delta = -delta;
+        }
+
+        S32 difference = step >> 3;
+        if ( delta >= step )        { nibble |= 4; delta -= step;        difference += step; }
+        if ( delta >= step >> 1 )   { nibble |= 2; delta -= step >> 1;   difference += step >> 1; }
+        if ( delta >= step >> 2 )   { nibble |= 1;                       difference += step >> 2; }
+
+        predictor += (nibble & 8) ? -difference : difference;
+        predictor = mClamp( predictor, -32768, 32767 );
+        stepIndex = mClamp( stepIndex + indexTable[nibble & 7], 0, 88 );
+
+        // Samples are packed low nibble first.
+        const U32 dataIndex = (frame - 1) / 2;
+        if ( (frame - 1) & 1 )
+            pData[dataIndex] |= U8( nibble << 4 );
+        else
+            pData[dataIndex] = nibble;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImaAdpcmTests, FramesPerBlock )
+{
+    // One frame in the header plus eight per 4-byte group and channel.
+    ASSERT_EQ( 505u, ImaAdpcm::getFramesPerBlock( 256, 1 ) );
+    ASSERT_EQ( 505u, ImaAdpcm::getFramesPerBlock( 512, 2 ) );
+    ASSERT_EQ( 1017u, ImaAdpcm::getFramesPerBlock( 1024, 2 ) );
+
+    // Trailing partial blocks only count complete groups.
+    ASSERT_EQ( 1u, ImaAdpcm::getFramesPerBlock( 4, 1 ) );
+    ASSERT_EQ( 9u, ImaAdpcm::getFramesPerBlock( 10, 1 ) );
+
+    // Too small for the header.
+    ASSERT_EQ( 0u, ImaAdpcm::getFramesPerBlock( 3, 1 ) );
+    ASSERT_EQ( 0u, ImaAdpcm::getFramesPerBlock( 4, 2 ) );
+    ASSERT_EQ( 0u, ImaAdpcm::getFramesPerBlock( 256, 0 ) );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImaAdpcmTests, DecodeMonoBlock )
+{
+    // Predictor 1000, step index 0.
+    const U8 block[8] = { 0xE8, 0x03, 0x00, 0x00, 0x77, 0x77, 0x9F, 0x00 };
+    const S16 expected[9] = { 1000, 1011, 1041, 1104, 1240, 947, 821, 859, 893 };
+
+    S16 output[9];
+    ASSERT_EQ( 9u, ImaAdpcm::decodeBlock( block, sizeof(block), 1, output ) );
+
+    for ( U32 frame = 0; frame < 9; ++frame )
+        ASSERT_EQ( expected[frame], output[frame] );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImaAdpcmTests, DecodeStereoBlock )
+{
+    // Left starts at 1000 and right at -1000, each followed by one group.
+    const U8 block[16] =
+    {
+        0xE8, 0x03, 0x00, 0x00,
+        0x18, 0xFC, 0x00, 0x00,
+        0x77, 0x77, 0x9F, 0x00,
+        0x00, 0x00, 0x00, 0x00,
+    };
+
+    S16 output[18];
+    ASSERT_EQ( 9u, ImaAdpcm::decodeBlock( block, sizeof(block), 2, output ) );
+
+    // Channels are interleaved.
+    const S16 expectedLeft[9] = { 1000, 1011, 1041, 1104, 1240, 947, 821, 859, 893 };
+    for ( U32 frame = 0; frame < 9; ++frame )
+    {
+        ASSERT_EQ( expectedLeft[frame], output[frame * 2] );
+
+        // A zero nibble at step index zero adds nothing.
+        ASSERT_EQ( -1000, output[(frame * 2) + 1] );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImaAdpcmTests, DecodeClampsToRange )
+{
+    // Predictor 32767 at the largest step.
+    const U8 block[8] = { 0xFF, 0x7F, 0x58, 0x00, 0x77, 0x77, 0xFF, 0xFF };
+
+    S16 output[9];
+    ASSERT_EQ( 9u, ImaAdpcm::decodeBlock( block, sizeof(block), 1, output ) );
+
+    for ( U32 frame = 0; frame < 5; ++frame )
+        ASSERT_EQ( 32767, output[frame] );
+
+    ASSERT_EQ( -32768, output[8] );
+
+    // Out of range step indices are clamped.
+    const U8 badStep[8] = { 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    ASSERT_EQ( 9u, ImaAdpcm::decodeBlock( badStep, sizeof(badStep), 1, output ) );
+    ASSERT_EQ( 32767 >> 3, output[1] );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImaAdpcmTests, DecodeEncodedSignal )
+{
+    // A tone at a quarter of full scale.
+    S16 samples[IMAADPCM_UNITTEST_FRAMES];
+    for ( U32 frame = 0; frame < IMAADPCM_UNITTEST_FRAMES; ++frame )
+        samples[frame] = S16( mSin( F32(frame) * 0.05f ) * 8192.0f );
+
+    U8 block[IMAADPCM_UNITTEST_BLOCK_SIZE];
+    encodeImaAdpcmTestBlock( samples, block );
+
+    S16 output[IMAADPCM_UNITTEST_FRAMES];
+    ASSERT_EQ( (U32)IMAADPCM_UNITTEST_FRAMES, ImaAdpcm::decodeBlock( block, sizeof(block), 1, output ) );
+    ASSERT_EQ( samples[0], output[0] );
+
+    // Once the step size has adapted the decoded signal tracks the original.
+    for ( U32 frame = 32; frame < IMAADPCM_UNITTEST_FRAMES; ++frame )
+        ASSERT_LE( mAbs( S32(output[frame]) - S32(samples[frame]) ), IMAADPCM_UNITTEST_MAX_ERROR );
+
+    // A short trailing block decodes only its complete groups.
+    ASSERT_EQ( 9u, ImaAdpcm::decodeBlock( block, 10, 1, output ) );
+    ASSERT_EQ( samples[0], output[0] );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,259 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _IMAGE_FRAME_PROVIDER_H
+#include "2d/core/ImageFrameProvider.h"
+#endif
+
+#ifndef _IMAGE_FRAME_ANIMATOR_H_
+#include "2d/core/ImageFrameAnimator.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define IMAGEFRAMEANIMATOR_UNITTEST_PROVIDERS   100000
+#define IMAGEFRAMEANIMATOR_UNITTEST_TICKS       60
+#define IMAGEFRAMEANIMATOR_UNITTEST_ANIMATION   "ToyAssets:TD_Knight_MoveWest"
+#define IMAGEFRAMEANIMATOR_UNITTEST_ALIVE       0x600DF00D
+
+//-----------------------------------------------------------------------------
+
+/// A set of providers all playing the same animation from the start.
+class ImageFrameAnimatorTestProviders
+{
+public:
+    Vector<ImageFrameProvider*> mProviders;
+
+    ImageFrameAnimatorTestProviders( const U32 providerCount, ImageFrameAnimator* pAnimator )
+    {
+        for ( U32 n = 0; n < providerCount; ++n )
+        {
+            ImageFrameProvider* pProvider = new ImageFrameProvider();
+            pProvider->setAnimation( IMAGEFRAMEANIMATOR_UNITTEST_ANIMATION );
+            pProvider->setAnimationFrame( 0 );
+            pProvider->setAnimator( pAnimator );
+            mProviders.push_back( pProvider );
+        }
+    }
+
+    ~ImageFrameAnimatorTestProviders()
+    {
+        for ( U32 n = 0; n < (U32)mProviders.size(); ++n )
+            delete mProviders[n];
+    }
+
+    /// Update each provider individually a number of times.
+    /// @return The time taken in microseconds.
+    U64 updateProviders( const U32 tickCount )
+    {
+        const U64 startTime = Platform::getRealMicroseconds();
+
+        for ( U32 tick = 0; tick < tickCount; ++tick )
+        {
+            for ( U32 n = 0; n < (U32)mProviders.size(); ++n )
+                mProviders[n]->updateAnimation( Tickable::smTickSec );
+        }
+
+        return Platform::getRealMicroseconds() - startTime;
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Deletes another provider when its animation ends.
+class ImageFrameAnimatorTestEndingProvider : public ImageFrameProvider
+{
+public:
+    U32 mAlive;
+    U32 mAnimationEnds;
+    ImageFrameProvider* mpVictim;
+    static U32 smDeadCalls;
+    static ImageFrameAnimatorTestEndingProvider* smpDeleted;
+
+    ImageFrameAnimatorTestEndingProvider() : mAlive( IMAGEFRAMEANIMATOR_UNITTEST_ALIVE ), mAnimationEnds( 0 ), mpVictim( NULL ) {}
+    virtual ~ImageFrameAnimatorTestEndingProvider() { mAlive = 0; smpDeleted = this; }
+
+protected:
+    virtual void onAnimationEnd( void )
+    {
+        if ( mAlive != IMAGEFRAMEANIMATOR_UNITTEST_ALIVE )
+            ++smDeadCalls;
+
+        ++mAnimationEnds;
+
+        delete mpVictim;
+        mpVictim = NULL;
+    }
+};
+
+U32 ImageFrameAnimatorTestEndingProvider::smDeadCalls = 0;
+ImageFrameAnimatorTestEndingProvider* ImageFrameAnimatorTestEndingProvider::smpDeleted = NULL;
+
+//-----------------------------------------------------------------------------
+
+/// Update an animator a number of times.
+/// @return The time taken in microseconds.
+static U64 updateAnimator( ImageFrameAnimator& animator, const U32 tickCount )
+{
+    const U64 startTime = Platform::getRealMicroseconds();
+
+    for ( U32 tick = 0; tick < tickCount; ++tick )
+        animator.update( Tickable::smTickSec );
+
+    return Platform::getRealMicroseconds() - startTime;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImageFrameAnimatorTests, MatchesProviderUpdate )
+{
+    ImageFrameAnimator animator( false );
+    ImageFrameAnimatorTestProviders directProviders( 1, NULL );
+    ImageFrameAnimatorTestProviders batchedProviders( 1, &animator );
+
+    ImageFrameProvider* pDirectProvider = directProviders.mProviders[0];
+    ImageFrameProvider* pBatchedProvider = batchedProviders.mProviders[0];
+    ASSERT_TRUE( pDirectProvider->isAnimationValid() ) << "Failed to play animation '" << IMAGEFRAMEANIMATOR_UNITTEST_ANIMATION << "'.";
+    ASSERT_FALSE( pDirectProvider->isAnimatorAttached() ) << "Provider without an animator was attached.";
+    ASSERT_TRUE( pBatchedProvider->isAnimatorAttached() ) << "Provider was not attached to the animator.";
+    ASSERT_EQ( animator.getProviderCount(), 1 );
+    ASSERT_EQ( animator.getGroupCount(), 1 );
+
+    // Both integration paths produce the same frames.
+    for ( U32 tick = 0; tick < IMAGEFRAMEANIMATOR_UNITTEST_TICKS; ++tick )
+    {
+        directProviders.updateProviders( 1 );
+        updateAnimator( animator, 1 );
+
+        ASSERT_EQ( pDirectProvider->getCurrentAnimationFrame(), pBatchedProvider->getCurrentAnimationFrame() ) << "Frames differ at tick " << tick << ".";
+        ASSERT_EQ( pDirectProvider->isAnimationFinished(), pBatchedProvider->isAnimationFinished() ) << "Finished state differs at tick " << tick << ".";
+    }
+
+    // Paused animations are not advanced.
+    pBatchedProvider->pauseAnimation( true );
+    const F32 pausedTime = pBatchedProvider->getCurrentAnimationTime();
+    updateAnimator( animator, 1 );
+    ASSERT_EQ( pBatchedProvider->getCurrentAnimationTime(), pausedTime ) << "Paused animation was advanced.";
+
+    // Removing the animator detaches the provider.
+    pBatchedProvider->setAnimator( NULL );
+    ASSERT_FALSE( pBatchedProvider->isAnimatorAttached() ) << "Provider is still attached to the animator.";
+    ASSERT_EQ( animator.getProviderCount(), 0 );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImageFrameAnimatorTests, RequestTicks )
+{
+    ImageFrameAnimator animator( true );
+    ImageFrameAnimatorTestProviders providers( 2, &animator );
+
+    ImageFrameProvider* pTickedProvider = providers.mProviders[0];
+    ImageFrameProvider* pIdleProvider = providers.mProviders[1];
+    ASSERT_TRUE( pTickedProvider->isAnimationValid() ) << "Failed to play animation '" << IMAGEFRAMEANIMATOR_UNITTEST_ANIMATION << "'.";
+
+    // Only the provider that requested a tick is advanced.
+    pTickedProvider->update( Tickable::smTickSec );
+    updateAnimator( animator, 1 );
+    ASSERT_GT( pTickedProvider->getCurrentAnimationTime(), 0.0f ) << "Ticked provider was not advanced.";
+    ASSERT_EQ( pIdleProvider->getCurrentAnimationTime(), 0.0f ) << "Idle provider was advanced.";
+
+    // The request is consumed by the pass.
+    const F32 tickedTime = pTickedProvider->getCurrentAnimationTime();
+    updateAnimator( animator, 1 );
+    ASSERT_EQ( pTickedProvider->getCurrentAnimationTime(), tickedTime ) << "Tick request was not consumed.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImageFrameAnimatorTests, DeleteDuringAnimationEnd )
+{
+    ImageFrameAnimator animator( false );
+    ImageFrameAnimatorTestEndingProvider::smDeadCalls = 0;
+    ImageFrameAnimatorTestEndingProvider::smpDeleted = NULL;
+
+    // Both providers finish together and the first to be called back deletes the other.
+    ImageFrameAnimatorTestEndingProvider* pProviders[2];
+    for ( U32 n = 0; n < 2; ++n )
+    {
+        pProviders[n] = new ImageFrameAnimatorTestEndingProvider();
+        pProviders[n]->setAnimation( IMAGEFRAMEANIMATOR_UNITTEST_ANIMATION );
+        pProviders[n]->setAnimator( &animator );
+    }
+    ASSERT_TRUE( pProviders[0]->isAnimationValid() ) << "Failed to play animation '" << IMAGEFRAMEANIMATOR_UNITTEST_ANIMATION << "'.";
+    pProviders[0]->mpVictim = pProviders[1];
+    pProviders[1]->mpVictim = pProviders[0];
+
+    // Stop the animation cycling which restarts both providers.
+    AnimationAsset* pAnimationAsset = const_cast<AnimationAsset*>( pProviders[0]->getCurrentAnimation() );
+    pAnimationAsset->setAnimationCycle( false );
+
+    updateAnimator( animator, (U32)(pAnimationAsset->getAnimationTime() / Tickable::smTickSec) + 2 );
+    pAnimationAsset->setAnimationCycle( true );
+
+    // Only one provider is left and it was only called back whilst alive.
+    ASSERT_TRUE( ImageFrameAnimatorTestEndingProvider::smpDeleted != NULL ) << "No provider was deleted.";
+    ImageFrameAnimatorTestEndingProvider* pSurvivor = ImageFrameAnimatorTestEndingProvider::smpDeleted == pProviders[0] ? pProviders[1] : pProviders[0];
+    ASSERT_EQ( pSurvivor->mAnimationEnds, (U32)1 ) << "The surviving provider was not called back.";
+    ASSERT_EQ( ImageFrameAnimatorTestEndingProvider::smDeadCalls, (U32)0 ) << "A deleted provider was called back.";
+    ASSERT_EQ( animator.getProviderCount(), 0 );
+
+    delete pSurvivor;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ImageFrameAnimatorTests, AnimatorBenchmark )
+{
+    ImageFrameAnimator animator( false );
+    ImageFrameAnimatorTestProviders directProviders( IMAGEFRAMEANIMATOR_UNITTEST_PROVIDERS, NULL );
+    ImageFrameAnimatorTestProviders batchedProviders( IMAGEFRAMEANIMATOR_UNITTEST_PROVIDERS, &animator );
+    ASSERT_TRUE( directProviders.mProviders[0]->isAnimationValid() ) << "Failed to play animation '" << IMAGEFRAMEANIMATOR_UNITTEST_ANIMATION << "'.";
+    ASSERT_EQ( animator.getProviderCount(), IMAGEFRAMEANIMATOR_UNITTEST_PROVIDERS );
+
+    // Per-provider updates.
+    const U64 providerTime = directProviders.updateProviders( IMAGEFRAMEANIMATOR_UNITTEST_TICKS );
+
+    // Batched updates.
+    const U64 animatorTime = updateAnimator( animator, IMAGEFRAMEANIMATOR_UNITTEST_TICKS );
+
+    ASSERT_EQ( directProviders.mProviders[0]->getCurrentAnimationFrame(), batchedProviders.mProviders[0]->getCurrentAnimationFrame() ) << "Integration paths disagree.";
+
+    Con::printf( ">> %d animated providers over %d ticks: %.3f ms per tick updating providers, %.3f ms per tick using the animator.",
+        IMAGEFRAMEANIMATOR_UNITTEST_PROVIDERS, IMAGEFRAMEANIMATOR_UNITTEST_TICKS,
+        F64(providerTime) / (1000.0 * IMAGEFRAMEANIMATOR_UNITTEST_TICKS),
+        F64(animatorTime) / (1000.0 * IMAGEFRAMEANIMATOR_UNITTEST_TICKS) );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,268 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _NETRATECONTROL_H_
+#include "network/netRateControl.h"
+#endif
+
+#ifndef _NETSIMULATOR_H_
+#include "network/netSimulator.h"
+#endif
+
+#ifndef _VECTOR_H_
+#include "collection/vector.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define NETRATECONTROL_UNITTEST_UPDATE_DELAY    32
+#define NETRATECONTROL_UNITTEST_PACKET_SIZE     450
+
+//-----------------------------------------------------------------------------
+
+/// Results of streaming packets through a simulated link.
+struct NetRateControlTestResult
+{
+    U32 mSent;
+    U32 mDelivered;
+    U32 mDeliveredBytes;
+    F32 mMeanRateScale;
+};
+
+//-----------------------------------------------------------------------------
+
+static void setNetRateControlTestPacket( PacketReceiveEvent& packet, const U32 sequence, const U32 dataSize )
+{
+    dMemset( packet.data, 0, dataSize );
+    dMemcpy( packet.data, &sequence, sizeof(sequence) );
+    packet.size = U16( PacketReceiveEventHeaderSize + dataSize );
+}
+
+//-----------------------------------------------------------------------------
+
+/// Send at the negotiated rate for the given time.  Acknowledgements come back
+/// over a perfect link after the same latency, and a packet still unacknowledged
+/// when a later one is acknowledged counts as dropped, as it does in NetConnection.
+static NetRateControlTestResult runNetRateControlTest( const NetSimulator::Conditions& conditions, const bool adaptive, const U32 duration )
+{
+    NetSimulator simulator( 2013 );
+    simulator.setConditions( conditions );
+
+    NetRateControl rateControl;
+    rateControl.setAckDelay( 0 );
+
+    Vector<U32> sendTimes;
+    Vector<U32> ackTimes;
+    Vector<U32> ackSequences;
+    U32 nextAck = 0;
+    U32 nextUnacked = 0;
+    U32 nextSendTime = 0;
+    F64 rateScaleTotal = 0.0;
+
+    NetRateControlTestResult result;
+    result.mSent = 0;
+    result.mDelivered = 0;
+    result.mDeliveredBytes = 0;
+
+    PacketReceiveEvent packet;
+
+    for ( U32 time = 0; time < duration; ++time )
+    {
+        if ( time >= nextSendTime )
+        {
+            U32 updateDelay = NETRATECONTROL_UNITTEST_UPDATE_DELAY;
+            U32 packetSize = NETRATECONTROL_UNITTEST_PACKET_SIZE;
+            if ( adaptive )
+                rateControl.adjustSend( updateDelay, packetSize );
+
+            setNetRateControlTestPacket( packet, sendTimes.size(), packetSize );
+            sendTimes.push_back( time );
+            simulator.send( packet, time );
+            nextSendTime = time + updateDelay;
+            result.mSent++;
+        }
+
+        while ( simulator.receive( time, packet ) )
+        {
+            U32 sequence;
+            dMemcpy( &sequence, packet.data, sizeof(sequence) );
+            ackTimes.push_back( time + conditions.latency );
+            ackSequences.push_back( sequence );
+            result.mDelivered++;
+            result.mDeliveredBytes += packet.size - PacketReceiveEventHeaderSize;
+        }
+
+        while ( nextAck < (U32)ackTimes.size() && ackTimes[nextAck] <= time )
+        {
+            const U32 sequence = ackSequences[nextAck++];
+            if ( sequence < nextUnacked )
+                continue;
+
+            for ( ; nextUnacked < sequence; ++nextUnacked )
+                rateControl.packetDropped( sendTimes[nextUnacked], time );
+
+            rateControl.packetDelivered( sendTimes[sequence], time );
+            nextUnacked = sequence + 1;
+        }
+
+        rateScaleTotal += rateControl.getRateScale();
+    }
+
+    result.mMeanRateScale = F32( rateScaleTotal / F64( duration ) );
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetRateControlTests, SimulatorLatency )
+{
+    NetSimulator::Conditions conditions;
+    conditions.latency = 100;
+
+    NetSimulator simulator;
+    simulator.setConditions( conditions );
+    ASSERT_TRUE( simulator.isEnabled() ) << "Simulator should be enabled.";
+
+    PacketReceiveEvent packet;
+    for ( U32 sequence = 0; sequence < 10; ++sequence )
+    {
+        setNetRateControlTestPacket( packet, sequence, 100 );
+        ASSERT_TRUE( simulator.send( packet, sequence * 10 ) ) << "Packet dropped on a lossless link.";
+    }
+
+    ASSERT_FALSE( simulator.receive( 99, packet ) ) << "Packet delivered early.";
+
+    for ( U32 sequence = 0; sequence < 10; ++sequence )
+    {
+        ASSERT_TRUE( simulator.receive( 100 + sequence * 10, packet ) ) << "Packet not delivered on time.";
+
+        U32 received;
+        dMemcpy( &received, packet.data, sizeof(received) );
+        ASSERT_EQ( received, sequence ) << "Packet delivered out of order.";
+        ASSERT_EQ( packet.size, PacketReceiveEventHeaderSize + 100 ) << "Packet size changed.";
+    }
+
+    ASSERT_EQ( simulator.getPendingCount(), 0 ) << "Packets left in flight.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetRateControlTests, SimulatorLoss )
+{
+    NetSimulator::Conditions conditions;
+    conditions.packetLoss = 0.1f;
+
+    NetSimulator simulator;
+    simulator.setConditions( conditions );
+
+    PacketReceiveEvent packet;
+    setNetRateControlTestPacket( packet, 0, 100 );
+
+    const U32 packetCount = 10000;
+    U32 delivered = 0;
+    for ( U32 sequence = 0; sequence < packetCount; ++sequence )
+    {
+        simulator.send( packet, sequence );
+        while ( simulator.receive( sequence, packet ) )
+            delivered++;
+    }
+
+    ASSERT_EQ( delivered + simulator.getLostCount(), packetCount ) << "Packets went missing.";
+    ASSERT_NEAR( F32(simulator.getLostCount()) / F32(packetCount), 0.1f, 0.02f ) << "Loss rate is wrong.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetRateControlTests, AdjustSend )
+{
+    NetRateControl rateControl;
+
+    U32 updateDelay = NETRATECONTROL_UNITTEST_UPDATE_DELAY;
+    U32 packetSize = NETRATECONTROL_UNITTEST_PACKET_SIZE;
+    rateControl.adjustSend( updateDelay, packetSize );
+    ASSERT_EQ( updateDelay, NETRATECONTROL_UNITTEST_UPDATE_DELAY ) << "Full rate changed the delay.";
+    ASSERT_EQ( packetSize, NETRATECONTROL_UNITTEST_PACKET_SIZE ) << "Full rate changed the packet size.";
+
+    // Drop packets from successive round trips until the rate bottoms out.
+    for ( U32 time = 0; time < 10000; time += 100 )
+        rateControl.packetDropped( time, time + 50 );
+
+    ASSERT_FLOAT_EQ( rateControl.getRateScale(), NetRateControl::MinRateScale ) << "Rate did not back off.";
+
+    rateControl.adjustSend( updateDelay, packetSize );
+    ASSERT_EQ( packetSize, NetRateControl::MinPacketSize ) << "Packets were not shrunk first.";
+    ASSERT_GT( updateDelay, NETRATECONTROL_UNITTEST_UPDATE_DELAY ) << "Delay was not stretched.";
+    ASSERT_LE( updateDelay, NetRateControl::MaxUpdateDelay ) << "Delay stretched too far.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetRateControlTests, Bottleneck )
+{
+    // A link with a third of the negotiated bandwidth.
+    NetSimulator::Conditions conditions;
+    conditions.latency = 50;
+    conditions.bandwidth = 5000;
+    conditions.queueLimit = 200;
+
+    const U32 duration = 60000;
+    const NetRateControlTestResult fixed = runNetRateControlTest( conditions, false, duration );
+    const NetRateControlTestResult adaptive = runNetRateControlTest( conditions, true, duration );
+
+    const F32 fixedLoss = 1.0f - F32(fixed.mDelivered) / F32(fixed.mSent);
+    const F32 adaptiveLoss = 1.0f - F32(adaptive.mDelivered) / F32(adaptive.mSent);
+    const F32 adaptiveGoodput = F32(adaptive.mDeliveredBytes) * 1000.0f / F32(duration);
+
+    Con::printf( ">> Bottleneck: fixed %.1f%% loss, adaptive %.1f%% loss, %.0f bytes/s goodput at %.2f mean rate.",
+        fixedLoss * 100.0f, adaptiveLoss * 100.0f, adaptiveGoodput, adaptive.mMeanRateScale );
+
+    ASSERT_LT( adaptiveLoss * 4.0f, fixedLoss ) << "Adaptive rate did not reduce loss.";
+    ASSERT_GT( adaptiveGoodput, F32(conditions.bandwidth) * 0.75f ) << "Adaptive rate left the link idle.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetRateControlTests, RandomLoss )
+{
+    // Random loss on an uncongested link should not throttle the connection.
+    NetSimulator::Conditions conditions;
+    conditions.latency = 50;
+    conditions.packetLoss = 0.05f;
+
+    const NetRateControlTestResult adaptive = runNetRateControlTest( conditions, true, 60000 );
+
+    ASSERT_GT( adaptive.mMeanRateScale, 0.5f ) << "Random loss throttled the connection.";
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,299 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _PLATFORM_NET_THREAD_UNIX_H_
+#include "platform/platformNetThread.unix.h"
+#endif
+
+// The network thread only exists on platforms with epoll or kqueue.
+#ifdef TORQUE_NET_THREAD
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+//-----------------------------------------------------------------------------
+
+#define NETTHREAD_UNITTEST_TIMEOUT          5000
+#define NETTHREAD_UNITTEST_SMALL_SIZE       (256 << 10)
+#define NETTHREAD_UNITTEST_STREAM_SIZE      (4 << 20)
+#define NETTHREAD_UNITTEST_BENCHMARK_SIZE   (64 << 20)
+
+//-----------------------------------------------------------------------------
+
+/// Wait for the next message from the thread.
+static bool popNetThreadTestMessage( NetThread& thread, NetThread::Message& message )
+{
+    const U32 start = Platform::getRealMilliseconds();
+    while ( !thread.popMessage( message ) )
+    {
+        if ( Platform::getRealMilliseconds() - start > NETTHREAD_UNITTEST_TIMEOUT )
+            return false;
+
+        Platform::sleep( 1 );
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+/// Open a non-blocking socket bound to an ephemeral loopback port.
+static NetSocket openNetThreadTestSocket( const S32 type, sockaddr_in& address )
+{
+    socklen_t addressSize = sizeof( address );
+    dMemset( &address, 0, sizeof( address ) );
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+    NetSocket socket = ::socket( AF_INET, type, 0 );
+    if ( socket == InvalidSocket )
+        return InvalidSocket;
+
+    if ( ::bind( socket, (sockaddr*)&address, sizeof( address ) ) != 0 ||
+         ::getsockname( socket, (sockaddr*)&address, &addressSize ) != 0 )
+    {
+        ::close( socket );
+        return InvalidSocket;
+    }
+
+    fcntl( socket, F_SETFL, fcntl( socket, F_GETFL ) | O_NONBLOCK );
+    return socket;
+}
+
+//-----------------------------------------------------------------------------
+
+/// Close a socket owned by the thread and wait until it has been released.
+static bool closeNetThreadTestSocket( NetThread& thread, const NetSocket socket )
+{
+    thread.closeSocket( socket );
+
+    NetThread::Message message;
+    while ( popNetThreadTestMessage( thread, message ) )
+    {
+        if ( message.buffer )
+            thread.releaseBuffer( message.buffer );
+
+        if ( message.type == NetThread::Closed && message.socket == socket )
+            return true;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetThreadTests, StartStop )
+{
+    NetThread thread;
+    ASSERT_FALSE( thread.isRunning() );
+
+    ASSERT_TRUE( thread.startThread() );
+    ASSERT_TRUE( thread.isRunning() );
+
+    // Starting twice is harmless.
+    ASSERT_TRUE( thread.startThread() );
+
+    thread.stopThread();
+    ASSERT_FALSE( thread.isRunning() );
+
+    // The thread can be restarted.
+    ASSERT_TRUE( thread.startThread() );
+    thread.stopThread();
+    ASSERT_FALSE( thread.isRunning() );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetThreadTests, DatagramReceive )
+{
+    NetThread thread;
+    ASSERT_TRUE( thread.startThread() );
+
+    sockaddr_in portAddress;
+    const NetSocket port = openNetThreadTestSocket( SOCK_DGRAM, portAddress );
+    ASSERT_NE( InvalidSocket, port );
+    thread.addSocket( port, NetThread::Datagram );
+
+    sockaddr_in senderAddress;
+    const NetSocket sender = openNetThreadTestSocket( SOCK_DGRAM, senderAddress );
+    ASSERT_NE( InvalidSocket, sender );
+
+    // Each datagram arrives as one message in the order it was sent.
+    for ( U32 packet = 0; packet < 8; packet++ )
+    {
+        U8 data[100];
+        for ( U32 index = 0; index < sizeof( data ); index++ )
+            data[index] = U8( packet * 7 + index );
+
+        ASSERT_EQ( (ssize_t)sizeof( data ), ::sendto( sender, data, sizeof( data ), 0, (sockaddr*)&portAddress, sizeof( portAddress ) ) );
+
+        NetThread::Message message;
+        ASSERT_TRUE( popNetThreadTestMessage( thread, message ) );
+        ASSERT_EQ( (U32)NetThread::PacketReceived, message.type );
+        ASSERT_EQ( port, message.socket );
+        ASSERT_TRUE( message.buffer != NULL );
+        ASSERT_EQ( sizeof( data ), message.buffer->size );
+        ASSERT_EQ( 0, dMemcmp( data, message.buffer->data, sizeof( data ) ) );
+
+        // The source address is the sender.
+        const sockaddr_in* source = (const sockaddr_in*)&message.address;
+        ASSERT_EQ( senderAddress.sin_port, source->sin_port );
+
+        thread.releaseBuffer( message.buffer );
+    }
+
+    ::close( sender );
+    ASSERT_TRUE( closeNetThreadTestSocket( thread, port ) );
+    thread.stopThread();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetThreadTests, ConnectAcceptDisconnect )
+{
+    NetThread thread;
+    ASSERT_TRUE( thread.startThread() );
+
+    sockaddr_in listenAddress;
+    const NetSocket listener = openNetThreadTestSocket( SOCK_STREAM, listenAddress );
+    ASSERT_NE( InvalidSocket, listener );
+    ASSERT_EQ( 0, ::listen( listener, 4 ) );
+    thread.addSocket( listener, NetThread::Listen );
+
+    // Data sent while the connect is pending goes out once it completes.
+    const NetSocket client = ::socket( AF_INET, SOCK_STREAM, 0 );
+    ASSERT_NE( InvalidSocket, client );
+    fcntl( client, F_SETFL, fcntl( client, F_GETFL ) | O_NONBLOCK );
+    const S32 result = ::connect( client, (sockaddr*)&listenAddress, sizeof( listenAddress ) );
+    ASSERT_TRUE( result == 0 || errno == EINPROGRESS );
+    thread.addSocket( client, NetThread::Connecting );
+
+    const char greeting[] = "hello from the network thread";
+    ASSERT_TRUE( thread.send( client, (const U8*)greeting, sizeof( greeting ) ) );
+
+    NetSocket incoming = InvalidSocket;
+    bool connected = false;
+    U32 received = 0;
+    char buffer[sizeof( greeting )];
+
+    // Accepted and Connected may arrive in either order, but the accepted
+    // socket's data always follows its Accepted message.
+    while ( !connected || received < sizeof( greeting ) )
+    {
+        NetThread::Message message;
+        ASSERT_TRUE( popNetThreadTestMessage( thread, message ) );
+
+        switch ( message.type )
+        {
+        case NetThread::Accepted:
+            ASSERT_EQ( listener, message.socket );
+            ASSERT_EQ( InvalidSocket, incoming );
+            incoming = message.incoming;
+            break;
+
+        case NetThread::Connected:
+            ASSERT_EQ( client, message.socket );
+            connected = true;
+            break;
+
+        case NetThread::DataReceived:
+            ASSERT_NE( InvalidSocket, incoming );
+            ASSERT_EQ( incoming, message.socket );
+            ASSERT_LE( received + message.buffer->size, sizeof( greeting ) );
+            dMemcpy( buffer + received, message.buffer->data, message.buffer->size );
+            received += message.buffer->size;
+            break;
+
+        default:
+            FAIL() << "Unexpected message " << message.type;
+        }
+
+        if ( message.buffer )
+            thread.releaseBuffer( message.buffer );
+    }
+
+    ASSERT_STREQ( greeting, buffer );
+
+    // Closing one end disconnects the other.
+    ASSERT_TRUE( closeNetThreadTestSocket( thread, client ) );
+
+    NetThread::Message message;
+    ASSERT_TRUE( popNetThreadTestMessage( thread, message ) );
+    ASSERT_EQ( (U32)NetThread::Disconnected, message.type );
+    ASSERT_EQ( incoming, message.socket );
+
+    ASSERT_TRUE( closeNetThreadTestSocket( thread, incoming ) );
+    ASSERT_TRUE( closeNetThreadTestSocket( thread, listener ) );
+    thread.stopThread();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetThreadTests, StreamLoopback )
+{
+    NetThread thread;
+    ASSERT_TRUE( thread.startThread() );
+
+    // Odd send sizes straddle the pooled buffers.  The data is checked on arrival.
+    ASSERT_GT( thread.loopbackBenchmark( NETTHREAD_UNITTEST_SMALL_SIZE, 7 ), 0.0f );
+    ASSERT_GT( thread.loopbackBenchmark( NETTHREAD_UNITTEST_STREAM_SIZE, 1499 ), 0.0f );
+    ASSERT_GT( thread.loopbackBenchmark( NETTHREAD_UNITTEST_STREAM_SIZE, 65537 ), 0.0f );
+
+    thread.stopThread();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( NetThreadTests, LoopbackBenchmark )
+{
+    NetThread thread;
+    ASSERT_TRUE( thread.startThread() );
+
+    const U32 sendSizes[] = { 256, 4096, 65536 };
+    for ( U32 index = 0; index < sizeof( sendSizes ) / sizeof( sendSizes[0] ); index++ )
+    {
+        const F32 megabytesPerSecond = thread.loopbackBenchmark( NETTHREAD_UNITTEST_BENCHMARK_SIZE, sendSizes[index] );
+        ASSERT_GT( megabytesPerSecond, 0.0f );
+
+        Con::printf( ">> Network thread loopback, %d byte sends: %.1f MB/s", sendSizes[index], megabytesPerSecond );
+    }
+
+    thread.stopThread();
+}
+
+#endif // TORQUE_NET_THREAD
+
+#endif // TORQUE_SHIPPING
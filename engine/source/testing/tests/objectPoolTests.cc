@@ -0,0 +1,280 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _OBJECTPOOL_H_
+#include "memory/objectPool.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "2d/sceneobject/SceneObject.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define OBJECTPOOL_UNITTEST_CAPACITY        100
+#define OBJECTPOOL_UNITTEST_SPAWN_COUNT     2000
+#define OBJECTPOOL_UNITTEST_SPAWN_WAVES     20
+
+//-----------------------------------------------------------------------------
+
+/// Two scene-object types of the same size.
+class ObjectPoolTestObjectA : public SceneObject
+{
+    typedef SceneObject Parent;
+
+public:
+    DECLARE_CONOBJECT( ObjectPoolTestObjectA );
+};
+
+class ObjectPoolTestObjectB : public SceneObject
+{
+    typedef SceneObject Parent;
+
+public:
+    DECLARE_CONOBJECT( ObjectPoolTestObjectB );
+};
+
+IMPLEMENT_CONOBJECT( ObjectPoolTestObjectA );
+IMPLEMENT_CONOBJECT( ObjectPoolTestObjectB );
+
+//-----------------------------------------------------------------------------
+
+/// Find the pool of a scene-object type.
+static const ObjectPool* findSceneObjectPool( const AbstractClassRep* pClassRep )
+{
+    const ObjectPoolAllocator& allocator = SceneObject::getObjectPool();
+
+    for ( U32 index = 0; index < allocator.getPoolCount(); ++index )
+    {
+        if ( allocator.getPoolKey( index ) == pClassRep )
+            return allocator.getPool( index );
+    }
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ObjectPoolTests, PoolCapacity )
+{
+    ObjectPool pool( 40, OBJECTPOOL_UNITTEST_CAPACITY );
+
+    ASSERT_EQ( pool.getSlotSize() % ObjectPool::SlotAlignment, 0 ) << "Slot size is not aligned.";
+    ASSERT_GE( pool.getSlotSize(), 40 ) << "Slot size is too small.";
+
+    void* slots[OBJECTPOOL_UNITTEST_CAPACITY];
+    for ( U32 index = 0; index < OBJECTPOOL_UNITTEST_CAPACITY; ++index )
+    {
+        slots[index] = pool.alloc();
+        ASSERT_NE( (void*)0, slots[index] ) << "Pool ran out before its capacity.";
+        dMemset( slots[index], index, 40 );
+    }
+
+    ASSERT_EQ( (void*)0, pool.alloc() ) << "Pool allocated past its capacity.";
+    ASSERT_EQ( pool.getUsedCount(), OBJECTPOOL_UNITTEST_CAPACITY ) << "Used count is wrong.";
+
+    // Slots must not overlap.
+    for ( U32 index = 0; index < OBJECTPOOL_UNITTEST_CAPACITY; ++index )
+        ASSERT_EQ( *(U8*)slots[index], index ) << "Slots overlap.";
+
+    // The most recently freed slot is reused first.
+    pool.free( slots[10] );
+    pool.free( slots[20] );
+    ASSERT_EQ( pool.alloc(), slots[20] ) << "Freed slot was not reused.";
+    ASSERT_EQ( pool.alloc(), slots[10] ) << "Freed slot was not reused.";
+
+    for ( U32 index = 0; index < OBJECTPOOL_UNITTEST_CAPACITY; ++index )
+        pool.free( slots[index] );
+
+    ASSERT_EQ( pool.getUsedCount(), 0 ) << "Slots still in use.";
+    ASSERT_EQ( pool.getPeakCount(), OBJECTPOOL_UNITTEST_CAPACITY ) << "Peak count is wrong.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ObjectPoolTests, AllocatorSizes )
+{
+    ObjectPoolAllocator allocator( OBJECTPOOL_UNITTEST_CAPACITY );
+
+    // Sizes that differ by less than the alignment share a pool.
+    void* pSmall = allocator.alloc( 100 );
+    void* pSmallToo = allocator.alloc( 104 );
+    void* pLarge = allocator.alloc( 400 );
+
+    ASSERT_EQ( allocator.getPoolCount(), 2 ) << "Sizes were not segregated.";
+    ASSERT_EQ( (dsize_t)pSmall % ObjectPool::SlotAlignment, (dsize_t)pLarge % ObjectPool::SlotAlignment ) << "Alignment differs between pools.";
+
+    allocator.free( pSmall );
+    allocator.free( pSmallToo );
+    allocator.free( pLarge );
+
+    // Once a pool is full the heap is used.
+    Vector<void*> allocations;
+    for ( U32 index = 0; index < OBJECTPOOL_UNITTEST_CAPACITY + 10; ++index )
+        allocations.push_back( allocator.alloc( 100 ) );
+
+    ASSERT_EQ( allocator.getHeapCount(), 10 ) << "Heap was not used once the pool was full.";
+
+    for ( S32 index = 0; index < allocations.size(); ++index )
+        allocator.free( allocations[index] );
+
+    ASSERT_EQ( allocator.getHeapCount(), 0 ) << "Heap allocations were not freed.";
+
+    for ( U32 index = 0; index < allocator.getPoolCount(); ++index )
+        ASSERT_EQ( allocator.getPool( index )->getUsedCount(), 0 ) << "Pool slots were not freed.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ObjectPoolTests, AllocatorKeys )
+{
+    ObjectPoolAllocator allocator( OBJECTPOOL_UNITTEST_CAPACITY );
+    const U32 firstKey = 1;
+    const U32 secondKey = 2;
+
+    // The same size with different keys comes from different pools.
+    void* pFirst = allocator.alloc( 100, &firstKey );
+    void* pSecond = allocator.alloc( 100, &secondKey );
+    void* pFirstToo = allocator.alloc( 100, &firstKey );
+    void* pUnkeyed = allocator.alloc( 100 );
+
+    ASSERT_EQ( allocator.getPoolCount(), 3 ) << "Keys were not segregated.";
+    ASSERT_EQ( allocator.getPool( 0 )->getUsedCount(), 2 ) << "Allocations with the same key did not share a pool.";
+    ASSERT_EQ( allocator.getPool( 1 )->getUsedCount(), 1 );
+    ASSERT_EQ( allocator.getPool( 2 )->getUsedCount(), 1 );
+    ASSERT_TRUE( allocator.getPoolKey( 2 ) == NULL ) << "Allocation without a key used a keyed pool.";
+
+    allocator.free( pFirst );
+    allocator.free( pSecond );
+    allocator.free( pFirstToo );
+    allocator.free( pUnkeyed );
+
+    for ( U32 index = 0; index < allocator.getPoolCount(); ++index )
+        ASSERT_EQ( allocator.getPool( index )->getUsedCount(), 0 ) << "Pool slots were not freed.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ObjectPoolTests, SceneObjectTypes )
+{
+    ASSERT_EQ( sizeof(ObjectPoolTestObjectA), sizeof(ObjectPoolTestObjectB) ) << "The test types should be the same size.";
+
+    const U32 objectPoolCapacity = SceneObject::getObjectPoolCapacity();
+    SceneObject::setObjectPoolCapacity( OBJECTPOOL_UNITTEST_CAPACITY );
+
+    // Types of the same size created by name still get their own slabs.
+    ConsoleObject* pObjectA = ConsoleObject::create( "ObjectPoolTestObjectA" );
+    ConsoleObject* pObjectB = ConsoleObject::create( "ObjectPoolTestObjectB" );
+    ASSERT_TRUE( pObjectA != NULL && pObjectB != NULL ) << "Failed to create the test types.";
+
+    const ObjectPool* pPoolA = findSceneObjectPool( ObjectPoolTestObjectA::getStaticClassRep() );
+    const ObjectPool* pPoolB = findSceneObjectPool( ObjectPoolTestObjectB::getStaticClassRep() );
+    ASSERT_TRUE( pPoolA != NULL && pPoolB != NULL ) << "The test types were not pooled by type.";
+    ASSERT_TRUE( pPoolA != pPoolB ) << "Types of the same size share a pool.";
+    ASSERT_EQ( pPoolA->getUsedCount(), 1 );
+    ASSERT_EQ( pPoolB->getUsedCount(), 1 );
+    ASSERT_EQ( pPoolA->getSlabCount(), 1 );
+    ASSERT_EQ( pPoolB->getSlabCount(), 1 );
+
+    delete pObjectA;
+    delete pObjectB;
+    ASSERT_EQ( pPoolA->getUsedCount(), 0 ) << "The object was not returned to its pool.";
+    ASSERT_EQ( pPoolB->getUsedCount(), 0 ) << "The object was not returned to its pool.";
+
+    SceneObject::setObjectPoolCapacity( objectPoolCapacity );
+}
+
+//-----------------------------------------------------------------------------
+
+/// Spawn waves of physics objects into a scene and delete them again.
+/// @return The time taken in microseconds.
+static U64 spawnSceneObjectWaves( Scene* pScene )
+{
+    const U64 startTime = Platform::getRealMicroseconds();
+
+    Vector<SceneObject*> objects;
+    objects.reserve( OBJECTPOOL_UNITTEST_SPAWN_COUNT );
+
+    for ( U32 wave = 0; wave < OBJECTPOOL_UNITTEST_SPAWN_WAVES; ++wave )
+    {
+        for ( U32 index = 0; index < OBJECTPOOL_UNITTEST_SPAWN_COUNT; ++index )
+        {
+            SceneObject* pSceneObject = pScene->create( "SceneObject" );
+            pSceneObject->setPosition( Vector2( F32(index % 100), F32(index / 100) ) );
+            pSceneObject->setLinearVelocity( Vector2( 1.0f, 0.0f ) );
+            pSceneObject->createPolygonBoxCollisionShape( 0.5f, 0.5f );
+            objects.push_back( pSceneObject );
+        }
+
+        for ( S32 index = 0; index < objects.size(); ++index )
+            objects[index]->deleteObject();
+
+        objects.clear();
+    }
+
+    return Platform::getRealMicroseconds() - startTime;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ObjectPoolTests, SpawnBenchmark )
+{
+    Scene* pScene = new Scene();
+    ASSERT_TRUE( pScene->registerObject() ) << "Failed to register the scene.";
+
+    const U32 objectPoolCapacity = SceneObject::getObjectPoolCapacity();
+    const U32 bodyPoolCapacity = pScene->getBodyPoolCapacity();
+
+    // Allocate everything from the heap.
+    SceneObject::setObjectPoolCapacity( 0 );
+    pScene->setBodyPoolCapacity( 0 );
+    const U64 heapTime = spawnSceneObjectWaves( pScene );
+    ASSERT_EQ( pScene->getBodyPoolCount(), 0 ) << "Bodies were recycled without a pool.";
+
+    // Allocate from the pools.
+    SceneObject::setObjectPoolCapacity( OBJECTPOOL_UNITTEST_SPAWN_COUNT );
+    pScene->setBodyPoolCapacity( OBJECTPOOL_UNITTEST_SPAWN_COUNT );
+    const U64 pooledTime = spawnSceneObjectWaves( pScene );
+    ASSERT_EQ( pScene->getBodyPoolCount(), OBJECTPOOL_UNITTEST_SPAWN_COUNT ) << "Bodies were not recycled.";
+
+    const U32 spawnCount = OBJECTPOOL_UNITTEST_SPAWN_COUNT * OBJECTPOOL_UNITTEST_SPAWN_WAVES;
+    Con::printf( ">> %d spawns and deletes: %.2f us each from the heap, %.2f us each pooled.",
+        spawnCount, F64(heapTime) / F64(spawnCount), F64(pooledTime) / F64(spawnCount) );
+
+    SceneObject::setObjectPoolCapacity( objectPoolCapacity );
+    pScene->setBodyPoolCapacity( bodyPoolCapacity );
+    pScene->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
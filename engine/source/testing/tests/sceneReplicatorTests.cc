@@ -0,0 +1,171 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _SCENE_REPLICATOR_H_
+#include "2d/scene/SceneReplicator.h"
+#endif
+
+#ifndef _SCENE_H_
+#include "2d/scene/Scene.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "2d/sceneobject/SceneObject.h"
+#endif
+
+#ifndef _NETCONNECTION_H_
+#include "network/netConnection.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SCENEREPLICATOR_UNITTEST_OBJECTS            48
+#define SCENEREPLICATOR_UNITTEST_SETTLE_PACKETS     32
+
+//-----------------------------------------------------------------------------
+
+/// Exchange one packet each way over a local connection, optionally losing the server's.
+static void exchangeSceneReplicatorPackets( NetConnection* pServerConnection, NetConnection* pClientConnection, const bool dropServerPacket = false )
+{
+    pServerConnection->setSimulatedNetParams( dropServerPacket ? 1.0f : 0.0f, 0 );
+    pServerConnection->checkPacketSend( true );
+    pServerConnection->setSimulatedNetParams( 0.0f, 0 );
+
+    pClientConnection->checkPacketSend( true );
+}
+
+//-----------------------------------------------------------------------------
+
+/// Does every server object have a client copy at its quantised position?
+static bool sceneReplicatorMatches( Scene* pServerScene, Scene* pClientScene, const F32 tolerance )
+{
+    if ( pServerScene->getSceneObjectCount() != pClientScene->getSceneObjectCount() )
+        return false;
+
+    for ( U32 serverIndex = 0; serverIndex < pServerScene->getSceneObjectCount(); ++serverIndex )
+    {
+        const Vector2 serverPosition = pServerScene->getSceneObject( serverIndex )->getPosition();
+
+        bool found = false;
+        for ( U32 clientIndex = 0; clientIndex < pClientScene->getSceneObjectCount() && !found; ++clientIndex )
+        {
+            const Vector2 clientPosition = pClientScene->getSceneObject( clientIndex )->getPosition();
+            found = mFabs( clientPosition.x - serverPosition.x ) <= tolerance && mFabs( clientPosition.y - serverPosition.y ) <= tolerance;
+        }
+
+        if ( !found )
+            return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneReplicatorTests, ScopeAlwaysPacketLoss )
+{
+    // Server scene with objects spread out so their copies can be told apart by position.
+    Scene* pServerScene = new Scene();
+    ASSERT_TRUE( pServerScene->registerObject() ) << "Failed to register the server scene.";
+
+    for ( U32 index = 0; index < SCENEREPLICATOR_UNITTEST_OBJECTS; ++index )
+    {
+        SceneObject* pSceneObject = new SceneObject();
+        ASSERT_TRUE( pSceneObject->registerObject() );
+        pSceneObject->setPosition( Vector2( F32(index) * 3.0f, F32(index) * 2.0f ) );
+        pServerScene->addToScene( pSceneObject );
+    }
+
+    Scene* pClientScene = new Scene();
+    ASSERT_TRUE( pClientScene->registerObject() ) << "Failed to register the client scene.";
+
+    // The replicator is ScopeAlways so it reaches the client in a guaranteed event.
+    SceneReplicator* pReplicator = new SceneReplicator();
+    pReplicator->setScene( pServerScene );
+    ASSERT_TRUE( pReplicator->registerObject() ) << "Failed to register the replicator.";
+    pReplicator->processTick();
+
+    // Connect a local client and server, as NetConnection::connectLocal does.
+    NetConnection* pClientConnection = new NetConnection();
+    NetConnection* pServerConnection = new NetConnection();
+    ASSERT_TRUE( pClientConnection->registerObject() );
+    ASSERT_TRUE( pServerConnection->registerObject() );
+
+    pClientConnection->setSequence( 0 );
+    pServerConnection->setSequence( 0 );
+    pClientConnection->setRemoteConnectionObject( pServerConnection );
+    pServerConnection->setRemoteConnectionObject( pClientConnection );
+    pClientConnection->setIsConnectionToServer();
+    pClientConnection->setEstablished();
+    pServerConnection->setEstablished();
+    pClientConnection->setConnectSequence( 0 );
+    pServerConnection->setConnectSequence( 0 );
+
+    pClientConnection->setGhostTo( true );
+    pServerConnection->setGhostFrom( true );
+    pServerConnection->activateGhosting();
+
+    // Hand over the ScopeAlways objects, losing one of the packets on the way.
+    for ( U32 packet = 0; packet < SCENEREPLICATOR_UNITTEST_SETTLE_PACKETS; ++packet )
+        exchangeSceneReplicatorPackets( pServerConnection, pClientConnection, packet == 1 );
+
+    ASSERT_TRUE( pServerConnection->isGhosting() ) << "Normal ghosting did not start.";
+
+    SceneReplicator* pGhost = dynamic_cast<SceneReplicator*>( pClientConnection->resolveGhost( pServerConnection->getGhostIndex( pReplicator ) ) );
+    ASSERT_TRUE( pGhost != NULL ) << "The replicator was not ghosted.";
+    pGhost->setScene( pClientScene );
+
+    // Move the objects every packet while dropping some of them.
+    for ( U32 packet = 0; packet < 40; ++packet )
+    {
+        for ( U32 index = 0; index < pServerScene->getSceneObjectCount(); ++index )
+        {
+            SceneObject* pSceneObject = pServerScene->getSceneObject( index );
+            pSceneObject->setPosition( pSceneObject->getPosition() + Vector2( 0.05f * F32(index % 3), -0.03f * F32(index % 5) ) );
+        }
+
+        pReplicator->processTick();
+        exchangeSceneReplicatorPackets( pServerConnection, pClientConnection, packet % 7 == 3 );
+    }
+
+    // Let any resends go through.
+    for ( U32 packet = 0; packet < SCENEREPLICATOR_UNITTEST_SETTLE_PACKETS; ++packet )
+        exchangeSceneReplicatorPackets( pServerConnection, pClientConnection );
+
+    ASSERT_EQ( SCENEREPLICATOR_UNITTEST_OBJECTS, pGhost->getReplicatedObjectCount() ) << "The client did not receive every object.";
+    ASSERT_TRUE( sceneReplicatorMatches( pServerScene, pClientScene, 0.01f ) ) << "The client copies did not converge on the server after packet loss.";
+
+    pClientConnection->deleteObject();
+    pServerConnection->deleteObject();
+    pReplicator->deleteObject();
+    pClientScene->deleteObject();
+    pServerScene->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
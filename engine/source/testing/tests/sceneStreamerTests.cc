@@ -0,0 +1,382 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _SCENE_STREAMER_H_
+#include "2d/scene/SceneStreamer.h"
+#endif
+
+#ifndef _SCENE_H_
+#include "2d/scene/Scene.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "2d/sceneobject/SceneObject.h"
+#endif
+
+#ifndef _SCENE_WINDOW_H_
+#include "2d/gui/SceneWindow.h"
+#endif
+
+#ifndef _RESMANAGER_H_
+#include "io/resource/resourceManager.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SCENESTREAMER_UNITTEST_CELL_SIZE            50.0f
+#define SCENESTREAMER_UNITTEST_WORLD_CELLS          64
+#define SCENESTREAMER_UNITTEST_CELL_OBJECTS         100
+#define SCENESTREAMER_UNITTEST_FLIGHT_SPEED         4.0f
+#define SCENESTREAMER_UNITTEST_HITCH_TIME           16000
+
+//-----------------------------------------------------------------------------
+
+static const char* formatCellPath( char* pBuffer, const U32 bufferSize, const char* pName )
+{
+    dSprintf( pBuffer, bufferSize, "%s/%s", Platform::getTemporaryDirectory(), pName );
+    return pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool writeCellFile( SceneStreamer* pStreamer, const S32 cellX, const S32 cellY, const U32 objectCount )
+{
+    StringTableEntry cellFilePath = pStreamer->getCellFilePath( cellX, cellY );
+    Platform::createPath( cellFilePath );
+
+    FileStream stream;
+    if ( !stream.open( cellFilePath, FileStream::Write ) )
+        return false;
+
+    const F32 cellSize = pStreamer->getCellSize();
+
+    // Scatter static objects over the cell.
+    stream.writeStringBuffer( "<SceneObjectSet>\r\n" );
+    for ( U32 index = 0; index < objectCount; ++index )
+    {
+        const F32 x = (F32(cellX) + F32((index * 7) % objectCount) / F32(objectCount)) * cellSize;
+        const F32 y = (F32(cellY) + F32((index * 13) % objectCount) / F32(objectCount)) * cellSize;
+        stream.writeFormattedBuffer( "    <SceneObject Position=\"%g %g\" Size=\"1 1\" BodyType=\"Static\" />\r\n", x, y );
+    }
+    stream.writeStringBuffer( "</SceneObjectSet>\r\n" );
+    stream.close();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+static void tickUntilRead( SceneStreamer* pStreamer, const S32 cellX, const S32 cellY )
+{
+    // Tick until the cell file has arrived and been read.
+    for ( U32 attempt = 0; attempt < 5000; ++attempt )
+    {
+        ResourceManager->processAsyncReads();
+        pStreamer->processTick();
+
+        if ( pStreamer->getCellState( cellX, cellY ) != SceneStreamer::CellReading )
+            return;
+
+        Platform::sleep( 1 );
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneStreamerTests, WriteAndStreamCells )
+{
+    Scene* pScene = new Scene();
+    ASSERT_TRUE( pScene->registerObject() ) << "Failed to register the scene.";
+
+    char cellPath[1024];
+    SceneStreamer* pStreamer = new SceneStreamer();
+    pStreamer->setCellPath( formatCellPath( cellPath, sizeof(cellPath), "sceneStreamerTest" ) );
+    pStreamer->setCellSize( 10.0f );
+    ASSERT_TRUE( pStreamer->registerObject() ) << "Failed to register the streamer.";
+
+    // Fill two cells with objects.
+    for ( U32 index = 0; index < 20; ++index )
+    {
+        SceneObject* pSceneObject = new SceneObject();
+        ASSERT_TRUE( pSceneObject->registerObject() );
+        pSceneObject->setPosition( Vector2( F32(index % 10) + 0.5f, index < 10 ? 5.0f : 15.0f ) );
+        pScene->addToScene( pSceneObject );
+    }
+
+    // Split the scene into cells.
+    ASSERT_TRUE( pStreamer->writeCells( pScene ) ) << "Failed to write the cells.";
+    ASSERT_EQ( pScene->getSceneObjectCount(), 20 ) << "Writing removed objects from the scene.";
+    pScene->clearScene( true );
+
+    // Stream around the camera.
+    SceneWindow* pSceneWindow = new SceneWindow();
+    ASSERT_TRUE( pSceneWindow->registerObject() );
+    pSceneWindow->setCameraArea( RectF( 2.0f, 2.0f, 2.0f, 2.0f ) );
+    pStreamer->setSceneWindow( pSceneWindow );
+    pStreamer->setScene( pScene );
+    pStreamer->setLoadDistance( 0.0f );
+    pStreamer->setUnloadDistance( 0.0f );
+    pStreamer->flush();
+
+    ASSERT_TRUE( pStreamer->isSettled() );
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellLoaded );
+    ASSERT_EQ( pStreamer->getCellState( 0, 1 ), SceneStreamer::CellEmpty ) << "Cell out of range was loaded.";
+    ASSERT_EQ( pScene->getSceneObjectCount(), 10 );
+
+    // Moving the camera swaps the cells.
+    pSceneWindow->setCameraArea( RectF( 2.0f, 12.0f, 2.0f, 2.0f ) );
+    pStreamer->flush();
+
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellEmpty ) << "Cell out of range was not unloaded.";
+    ASSERT_EQ( pStreamer->getCellState( 0, 1 ), SceneStreamer::CellLoaded );
+    ASSERT_EQ( pScene->getSceneObjectCount(), 10 );
+    ASSERT_EQ( pStreamer->getStreamedObjectCount(), 10 );
+
+    // The unload distance keeps cells near the camera.
+    pStreamer->setUnloadDistance( 5.0f );
+    pSceneWindow->setCameraArea( RectF( 2.0f, 6.0f, 2.0f, 2.0f ) );
+    pStreamer->flush();
+    ASSERT_EQ( pStreamer->getLoadedCellCount(), 2 );
+    ASSERT_EQ( pScene->getSceneObjectCount(), 20 );
+
+    Platform::fileDelete( pStreamer->getCellFilePath( 0, 0 ) );
+    Platform::fileDelete( pStreamer->getCellFilePath( 0, 1 ) );
+
+    // Removing the streamer removes the objects.
+    pStreamer->deleteObject();
+    ASSERT_EQ( pScene->getSceneObjectCount(), 0 ) << "Streamed objects were left in the scene.";
+
+    pSceneWindow->deleteObject();
+    pScene->deleteObject();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneStreamerTests, ObjectBudget )
+{
+    Scene* pScene = new Scene();
+    ASSERT_TRUE( pScene->registerObject() ) << "Failed to register the scene.";
+
+    char cellPath[1024];
+    SceneStreamer* pStreamer = new SceneStreamer();
+    pStreamer->setCellPath( formatCellPath( cellPath, sizeof(cellPath), "sceneStreamerBudgetTest" ) );
+    pStreamer->setCellSize( 10.0f );
+    pStreamer->setLoadDistance( 0.0f );
+    pStreamer->setUnloadDistance( 0.0f );
+    pStreamer->setObjectBudget( 10 );
+    pStreamer->setScene( pScene );
+    pStreamer->setFocusArea( RectF( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    ASSERT_TRUE( pStreamer->registerObject() ) << "Failed to register the streamer.";
+    ASSERT_TRUE( writeCellFile( pStreamer, 0, 0, 25 ) ) << "Failed to write the cell.";
+
+    // Objects are added no faster than the budget.
+    tickUntilRead( pStreamer, 0, 0 );
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellAdding ) << "Cell was not read.";
+    ASSERT_EQ( pScene->getSceneObjectCount(), 10 );
+    pStreamer->processTick();
+    ASSERT_EQ( pScene->getSceneObjectCount(), 20 );
+    pStreamer->processTick();
+    ASSERT_EQ( pScene->getSceneObjectCount(), 25 );
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellLoaded );
+
+    // Objects are removed no faster than the budget.
+    pStreamer->setFocusArea( RectF( 1000.0f, 1000.0f, 1.0f, 1.0f ) );
+    pStreamer->processTick();
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellRemoving );
+    ASSERT_EQ( pScene->getSceneObjectCount(), 15 );
+    pStreamer->processTick();
+    pStreamer->processTick();
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellEmpty );
+    ASSERT_EQ( pScene->getSceneObjectCount(), 0 );
+    ASSERT_EQ( pStreamer->getStreamedObjectCount(), 0 );
+
+    Platform::fileDelete( pStreamer->getCellFilePath( 0, 0 ) );
+    pStreamer->deleteObject();
+    pScene->deleteObject();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneStreamerTests, DistantCells )
+{
+    Scene* pScene = new Scene();
+    ASSERT_TRUE( pScene->registerObject() ) << "Failed to register the scene.";
+
+    char cellPath[1024];
+    SceneStreamer* pStreamer = new SceneStreamer();
+    pStreamer->setCellPath( formatCellPath( cellPath, sizeof(cellPath), "sceneStreamerDistantTest" ) );
+    pStreamer->setCellSize( 10.0f );
+    pStreamer->setLoadDistance( 0.0f );
+    pStreamer->setUnloadDistance( 0.0f );
+    pStreamer->setScene( pScene );
+    ASSERT_TRUE( pStreamer->registerObject() ) << "Failed to register the streamer.";
+
+    // The second cell is a multiple of 65536 cells from the first in both directions.
+    const S32 distantX = 65536;
+    const S32 distantY = -65536;
+    ASSERT_TRUE( writeCellFile( pStreamer, 0, 0, 5 ) ) << "Failed to write the cell.";
+    ASSERT_TRUE( writeCellFile( pStreamer, distantX, distantY, 7 ) ) << "Failed to write the cell.";
+
+    // Each cell is streamed on its own.
+    pStreamer->setFocusArea( RectF( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    pStreamer->flush();
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellLoaded );
+    ASSERT_EQ( pStreamer->getCellState( distantX, distantY ), SceneStreamer::CellEmpty ) << "Distant cell shares a key with the first.";
+    ASSERT_EQ( pScene->getSceneObjectCount(), 5 );
+
+    pStreamer->setFocusArea( RectF( distantX * 10.0f + 1.0f, distantY * 10.0f + 1.0f, 1.0f, 1.0f ) );
+    pStreamer->flush();
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellEmpty );
+    ASSERT_EQ( pStreamer->getCellState( distantX, distantY ), SceneStreamer::CellLoaded );
+    ASSERT_EQ( pScene->getSceneObjectCount(), 7 );
+
+    // A cell that goes out of range whilst its file is being read gives up the read.
+    StringTableEntry cellFilePath = pStreamer->getCellFilePath( 0, 0 );
+    pStreamer->setFocusArea( RectF( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    pStreamer->processTick();
+    const bool reading = pStreamer->getCellState( 0, 0 ) == SceneStreamer::CellReading;
+    pStreamer->setFocusArea( RectF( 1000.0f, 1000.0f, 1.0f, 1.0f ) );
+    pStreamer->processTick();
+    ASSERT_EQ( pStreamer->getCellState( 0, 0 ), SceneStreamer::CellEmpty );
+    if ( reading )
+    {
+        Stream* pStream = ResourceManager->openPrefetchedStream( cellFilePath );
+        const bool prefetched = pStream != NULL;
+        if ( pStream != NULL )
+            ResourceManager->closeStream( pStream );
+
+        ASSERT_FALSE( prefetched ) << "The read of a destroyed cell was left queued.";
+    }
+
+    Platform::fileDelete( pStreamer->getCellFilePath( 0, 0 ) );
+    Platform::fileDelete( pStreamer->getCellFilePath( distantX, distantY ) );
+    pStreamer->deleteObject();
+    pScene->deleteObject();
+}
+
+//-----------------------------------------------------------------------------
+
+static void flyAcrossWorld( SceneStreamer* pStreamer, const bool streaming, U32& tickCount, U64& maxTickTime, U64& totalTickTime, U32& hitchCount, U32& maxObjectCount )
+{
+    const F32 worldSize = SCENESTREAMER_UNITTEST_CELL_SIZE * SCENESTREAMER_UNITTEST_WORLD_CELLS;
+    const Vector2 cameraSize( 100.0f, 75.0f );
+
+    tickCount = 0;
+    maxTickTime = 0;
+    totalTickTime = 0;
+    hitchCount = 0;
+    maxObjectCount = 0;
+
+    // Fly diagonally from corner to corner.
+    for ( F32 distance = 0.0f; distance < worldSize - cameraSize.x; distance += SCENESTREAMER_UNITTEST_FLIGHT_SPEED )
+    {
+        pStreamer->setFocusArea( RectF( distance, distance * 0.75f, cameraSize.x, cameraSize.y ) );
+
+        const U64 startTime = Platform::getRealMicroseconds();
+
+        ResourceManager->processAsyncReads();
+
+        // Either stream or load everything in range before the frame continues.
+        if ( streaming )
+            pStreamer->processTick();
+        else
+            pStreamer->flush();
+
+        const U64 tickTime = Platform::getRealMicroseconds() - startTime;
+
+        tickCount++;
+        totalTickTime += tickTime;
+        if ( tickTime > maxTickTime )
+            maxTickTime = tickTime;
+        maxObjectCount = getMax( maxObjectCount, pStreamer->getStreamedObjectCount() );
+        if ( tickTime > SCENESTREAMER_UNITTEST_HITCH_TIME )
+            hitchCount++;
+
+        // Leave the read threads a frame's worth of time as a game would.
+        Platform::sleep( 1 );
+    }
+
+    pStreamer->unloadAll();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneStreamerTests, FlightBenchmark )
+{
+    Scene* pScene = new Scene();
+    ASSERT_TRUE( pScene->registerObject() ) << "Failed to register the scene.";
+
+    char cellPath[1024];
+    SceneStreamer* pStreamer = new SceneStreamer();
+    pStreamer->setCellPath( formatCellPath( cellPath, sizeof(cellPath), "sceneStreamerBenchmark" ) );
+    pStreamer->setCellSize( SCENESTREAMER_UNITTEST_CELL_SIZE );
+    pStreamer->setLoadDistance( SCENESTREAMER_UNITTEST_CELL_SIZE );
+    pStreamer->setUnloadDistance( SCENESTREAMER_UNITTEST_CELL_SIZE * 2.0f );
+    pStreamer->setObjectBudget( 200 );
+    pStreamer->setScene( pScene );
+    ASSERT_TRUE( pStreamer->registerObject() ) << "Failed to register the streamer.";
+
+    // Generate the world.
+    for ( S32 cellY = 0; cellY < SCENESTREAMER_UNITTEST_WORLD_CELLS; ++cellY )
+    {
+        for ( S32 cellX = 0; cellX < SCENESTREAMER_UNITTEST_WORLD_CELLS; ++cellX )
+            ASSERT_TRUE( writeCellFile( pStreamer, cellX, cellY, SCENESTREAMER_UNITTEST_CELL_OBJECTS ) ) << "Failed to write a cell.";
+    }
+
+    U32 tickCount, hitchCount, maxObjectCount;
+    U64 maxTickTime, totalTickTime;
+
+    // Load synchronously as the camera moves.
+    flyAcrossWorld( pStreamer, false, tickCount, maxTickTime, totalTickTime, hitchCount, maxObjectCount );
+    Con::printf( ">> Synchronous: %d ticks, %.3f ms mean, %.3f ms worst, %d ticks over %d ms, %d objects at most.",
+        tickCount, F64(totalTickTime) / F64(tickCount) / 1000.0, F64(maxTickTime) / 1000.0, hitchCount, SCENESTREAMER_UNITTEST_HITCH_TIME / 1000, maxObjectCount );
+
+    // Stream with the budget.
+    flyAcrossWorld( pStreamer, true, tickCount, maxTickTime, totalTickTime, hitchCount, maxObjectCount );
+    Con::printf( ">> Streamed: %d ticks, %.3f ms mean, %.3f ms worst, %d ticks over %d ms, %d objects at most.",
+        tickCount, F64(totalTickTime) / F64(tickCount) / 1000.0, F64(maxTickTime) / 1000.0, hitchCount, SCENESTREAMER_UNITTEST_HITCH_TIME / 1000, maxObjectCount );
+
+    ASSERT_EQ( pScene->getSceneObjectCount(), 0 ) << "Streamed objects were left in the scene.";
+
+    // Remove the world.
+    for ( S32 cellY = 0; cellY < SCENESTREAMER_UNITTEST_WORLD_CELLS; ++cellY )
+    {
+        for ( S32 cellX = 0; cellX < SCENESTREAMER_UNITTEST_WORLD_CELLS; ++cellX )
+            Platform::fileDelete( pStreamer->getCellFilePath( cellX, cellY ) );
+    }
+
+    pStreamer->deleteObject();
+    pScene->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _SCENE_H_
+#include "2d/scene/Scene.h"
+#endif
+
+#ifndef _SCENE_OBJECT_H_
+#include "2d/sceneobject/SceneObject.h"
+#endif
+
+#ifndef _SCENE_WINDOW_H_
+#include "2d/gui/SceneWindow.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SCENEWINDOW_UNITTEST_WINDOW_SIZE            100
+#define SCENEWINDOW_UNITTEST_OBJECT_SIZE            10.0f
+
+//-----------------------------------------------------------------------------
+
+struct SceneWindowTestEvent
+{
+    SimObjectId         mObjectId;
+    StringTableEntry    mName;
+};
+
+static Vector<SceneWindowTestEvent> sceneWindowTestEvents;
+
+//-----------------------------------------------------------------------------
+
+class SceneWindowTestObject : public SceneObject
+{
+public:
+    virtual void onInputEvent( StringTableEntry name, const GuiEvent& event, const Vector2& worldMousePoint )
+    {
+        SceneWindowTestEvent testEvent;
+        testEvent.mObjectId = getId();
+        testEvent.mName = name;
+        sceneWindowTestEvents.push_back( testEvent );
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+class SceneWindowTestLayout
+{
+public:
+    SceneWindowTestLayout()
+    {
+        mpScene = new Scene();
+        mpScene->registerObject();
+
+        // Map the window one-to-one onto the scene with the scene origin at the bottom-left.
+        mpWindow = new SceneWindow();
+        mpWindow->registerObject();
+        mpWindow->resize( Point2I( 0, 0 ), Point2I( SCENEWINDOW_UNITTEST_WINDOW_SIZE, SCENEWINDOW_UNITTEST_WINDOW_SIZE ) );
+        mpWindow->setCameraArea( RectF( 0.0f, 0.0f, F32(SCENEWINDOW_UNITTEST_WINDOW_SIZE), F32(SCENEWINDOW_UNITTEST_WINDOW_SIZE) ) );
+        mpWindow->setScene( mpScene );
+        mpWindow->setUseWindowInputEvents( false );
+        mpWindow->setUseObjectInputEvents( true );
+
+        sceneWindowTestEvents.clear();
+    }
+
+    ~SceneWindowTestLayout()
+    {
+        mpWindow->deleteObject();
+        mpScene->deleteObject();
+
+        sceneWindowTestEvents.clear();
+    }
+
+    SceneWindowTestObject* createObject( const Point2I& windowPoint, const bool addToScene = true )
+    {
+        SceneWindowTestObject* pSceneObject = new SceneWindowTestObject();
+        pSceneObject->registerObject();
+        pSceneObject->setPosition( Vector2( F32(windowPoint.x), F32(SCENEWINDOW_UNITTEST_WINDOW_SIZE - windowPoint.y) ) );
+        pSceneObject->setSize( Vector2( SCENEWINDOW_UNITTEST_OBJECT_SIZE, SCENEWINDOW_UNITTEST_OBJECT_SIZE ) );
+        pSceneObject->setUseInputEvents( true );
+
+        if ( addToScene )
+            mpScene->addToScene( pSceneObject );
+
+        return pSceneObject;
+    }
+
+    void moveMouse( const Point2I& windowPoint )
+    {
+        GuiEvent event;
+        dMemset( &event, 0, sizeof(event) );
+        event.mousePoint = windowPoint;
+        mpWindow->onMouseMove( event );
+    }
+
+    Scene*          mpScene;
+    SceneWindow*    mpWindow;
+};
+
+//-----------------------------------------------------------------------------
+
+static void expectSceneWindowEvent( const U32 index, const SceneObject* pSceneObject, const char* pName )
+{
+    ASSERT_LT( index, (U32)sceneWindowTestEvents.size() ) << "Missing '" << pName << "' event.";
+    EXPECT_EQ( pSceneObject->getId(), sceneWindowTestEvents[index].mObjectId ) << "Event " << index << " was sent to the wrong object.";
+    EXPECT_STREQ( pName, sceneWindowTestEvents[index].mName ) << "Event " << index << " is out of order.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneWindowTests, EnterLeaveOrdering )
+{
+    SceneWindowTestLayout layout;
+    SceneWindowTestObject* pObjectA = layout.createObject( Point2I( 20, 20 ) );
+    SceneWindowTestObject* pObjectB = layout.createObject( Point2I( 60, 20 ) );
+    SceneWindowTestObject* pObjectC = layout.createObject( Point2I( 60, 20 ) );
+
+    // Entering an object sends the move, then the enter followed by the move again.
+    layout.moveMouse( Point2I( 20, 20 ) );
+    ASSERT_EQ( 3, sceneWindowTestEvents.size() );
+    expectSceneWindowEvent( 0, pObjectA, "onTouchMoved" );
+    expectSceneWindowEvent( 1, pObjectA, "onTouchEnter" );
+    expectSceneWindowEvent( 2, pObjectA, "onTouchMoved" );
+
+    // Moving within an object only sends the move.
+    sceneWindowTestEvents.clear();
+    layout.moveMouse( Point2I( 21, 21 ) );
+    ASSERT_EQ( 1, sceneWindowTestEvents.size() );
+    expectSceneWindowEvent( 0, pObjectA, "onTouchMoved" );
+
+    // Moving across objects sends the moves, then the leaves, then the enters in object Id order.
+    sceneWindowTestEvents.clear();
+    layout.moveMouse( Point2I( 60, 20 ) );
+    ASSERT_EQ( 7, sceneWindowTestEvents.size() );
+    expectSceneWindowEvent( 0, pObjectB, "onTouchMoved" );
+    expectSceneWindowEvent( 1, pObjectC, "onTouchMoved" );
+    expectSceneWindowEvent( 2, pObjectA, "onTouchLeave" );
+    expectSceneWindowEvent( 3, pObjectB, "onTouchEnter" );
+    expectSceneWindowEvent( 4, pObjectB, "onTouchMoved" );
+    expectSceneWindowEvent( 5, pObjectC, "onTouchEnter" );
+    expectSceneWindowEvent( 6, pObjectC, "onTouchMoved" );
+
+    // Moving off every object only sends the leaves.
+    sceneWindowTestEvents.clear();
+    layout.moveMouse( Point2I( 90, 90 ) );
+    ASSERT_EQ( 2, sceneWindowTestEvents.size() );
+    expectSceneWindowEvent( 0, pObjectB, "onTouchLeave" );
+    expectSceneWindowEvent( 1, pObjectC, "onTouchLeave" );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneWindowTests, CameraChangeInvalidatesPick )
+{
+    SceneWindowTestLayout layout;
+    SceneWindowTestObject* pObjectA = layout.createObject( Point2I( 20, 20 ) );
+    SceneWindowTestObject* pObjectB = layout.createObject( Point2I( 60, 20 ) );
+
+    layout.moveMouse( Point2I( 20, 20 ) );
+    ASSERT_EQ( 3, sceneWindowTestEvents.size() );
+    expectSceneWindowEvent( 0, pObjectA, "onTouchMoved" );
+
+    // Pan the camera so the same window point now lies over the other object.
+    sceneWindowTestEvents.clear();
+    layout.mpWindow->setCameraArea( RectF( 40.0f, 0.0f, F32(SCENEWINDOW_UNITTEST_WINDOW_SIZE), F32(SCENEWINDOW_UNITTEST_WINDOW_SIZE) ) );
+    layout.moveMouse( Point2I( 20, 20 ) );
+    ASSERT_EQ( 4, sceneWindowTestEvents.size() ) << "The pick was not refreshed after the camera moved.";
+    expectSceneWindowEvent( 0, pObjectB, "onTouchMoved" );
+    expectSceneWindowEvent( 1, pObjectA, "onTouchLeave" );
+    expectSceneWindowEvent( 2, pObjectB, "onTouchEnter" );
+    expectSceneWindowEvent( 3, pObjectB, "onTouchMoved" );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SceneWindowTests, SceneChangeInvalidatesPick )
+{
+    SceneWindowTestLayout layout;
+    SceneWindowTestObject* pObjectA = layout.createObject( Point2I( 20, 20 ) );
+    SceneWindowTestObject* pObjectB = layout.createObject( Point2I( 20, 20 ), false );
+
+    layout.moveMouse( Point2I( 20, 20 ) );
+    ASSERT_EQ( 3, sceneWindowTestEvents.size() );
+
+    // Adding an object under the mouse must enter it on the next event at the same point.
+    sceneWindowTestEvents.clear();
+    layout.mpScene->addToScene( pObjectB );
+    layout.moveMouse( Point2I( 20, 20 ) );
+    ASSERT_EQ( 4, sceneWindowTestEvents.size() ) << "The pick was not refreshed after an object was added.";
+    expectSceneWindowEvent( 0, pObjectA, "onTouchMoved" );
+    expectSceneWindowEvent( 1, pObjectB, "onTouchMoved" );
+    expectSceneWindowEvent( 2, pObjectB, "onTouchEnter" );
+    expectSceneWindowEvent( 3, pObjectB, "onTouchMoved" );
+
+    // Removing an object under the mouse must stop it being picked.
+    sceneWindowTestEvents.clear();
+    layout.mpScene->removeFromScene( pObjectA );
+    layout.moveMouse( Point2I( 20, 20 ) );
+    ASSERT_EQ( 1, sceneWindowTestEvents.size() ) << "The pick was not refreshed after an object was removed.";
+    expectSceneWindowEvent( 0, pObjectB, "onTouchMoved" );
+
+    pObjectA->deleteObject();
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,143 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SCRIPTBYTECODE_UNITTEST_ITERATIONS  100000
+
+//-----------------------------------------------------------------------------
+
+static const char* evaluateResult( const char* pExpression )
+{
+    Con::setVariable( "$ScriptBytecodeTest::Result", "" );
+    Con::evaluatef( "$ScriptBytecodeTest::Result = %s;", pExpression );
+    return Con::getVariable( "$ScriptBytecodeTest::Result" );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ScriptBytecodeTests, ConstantFolding )
+{
+    // Folded expressions must give exactly what the VM would have computed.
+    ASSERT_STREQ( evaluateResult( "1 + 2 * 3" ), "7" );
+    ASSERT_STREQ( evaluateResult( "10 / 4" ), "2.5" );
+    ASSERT_STREQ( evaluateResult( "-(4 / 2) - 0.5" ), "-2.5" );
+    ASSERT_STREQ( evaluateResult( "(2 > 1) + 0.5" ), "1.5" );
+    ASSERT_STREQ( evaluateResult( "7 % 3" ), "1" );
+    ASSERT_STREQ( evaluateResult( "7 % 0" ), "0" );
+    ASSERT_STREQ( evaluateResult( "3 || 5" ), "3" );
+    ASSERT_STREQ( evaluateResult( "0 && 5" ), "0" );
+    ASSERT_STREQ( evaluateResult( "!(2 < 1)" ), "1" );
+    ASSERT_STREQ( evaluateResult( "~0 & 255" ), "255" );
+    ASSERT_STREQ( evaluateResult( "(1 << 4) | 1" ), "17" );
+    ASSERT_STREQ( evaluateResult( "10 / 4 @ \"x\"" ), "2.5x" );
+
+    // Folded tests still pick the right branch.
+    ASSERT_STREQ( evaluateResult( "2 * 3 == 6 ? \"yes\" : \"no\"" ), "yes" );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ScriptBytecodeTests, FusedVariableOpcodes )
+{
+    Con::evaluate(
+        "function ScriptBytecodeTest::sum( %count )"
+        "{"
+        "   %total = 0;"
+        "   for ( %i = 0; %i < %count; %i++ )"
+        "      %total += %i;"
+        "   %text = \"sum\";"
+        "   %text = %text @ \" \" @ %total;"
+        "   %half = %total / 2;"
+        "   %a = %b = %half;"
+        "   return %text SPC %a SPC %b;"
+        "}" );
+
+    ASSERT_STREQ( evaluateResult( "ScriptBytecodeTest::sum( 10 )" ), "sum 45 22.5 22.5" );
+
+    // Array variables still go through the unfused opcodes.
+    Con::evaluate( "$ScriptBytecodeTest::Array[1] = 4;" );
+    ASSERT_STREQ( evaluateResult( "$ScriptBytecodeTest::Array[1] * 2" ), "8" );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( ScriptBytecodeTests, ExecutionBenchmark )
+{
+    // Representative scripts: numeric loops, string building and script calls.
+    Con::evaluate(
+        "function ScriptBytecodeTest::arithmetic( %count )"
+        "{"
+        "   %value = 0;"
+        "   for ( %i = 0; %i < %count; %i++ )"
+        "      %value = (%value + %i * 2 + 60 * 60 / 2) % 1000;"
+        "   return %value;"
+        "}"
+        "function ScriptBytecodeTest::strings( %count )"
+        "{"
+        "   for ( %i = 0; %i < %count; %i++ )"
+        "      %text = \"item\" @ %i SPC %i * 0.5;"
+        "   return %text;"
+        "}"
+        "function ScriptBytecodeTest::add( %a, %b )"
+        "{"
+        "   return %a + %b;"
+        "}"
+        "function ScriptBytecodeTest::calls( %count )"
+        "{"
+        "   %value = 0;"
+        "   for ( %i = 0; %i < %count; %i++ )"
+        "      %value = ScriptBytecodeTest::add( %value, 1 );"
+        "   return %value;"
+        "}" );
+
+    const char* pScripts[] = { "arithmetic", "strings", "calls" };
+
+    for ( U32 n = 0; n < sizeof(pScripts) / sizeof(pScripts[0]); ++n )
+    {
+        const U64 startTime = Platform::getRealMicroseconds();
+        Con::evaluatef( "ScriptBytecodeTest::%s( %d );", pScripts[n], SCRIPTBYTECODE_UNITTEST_ITERATIONS );
+        const U64 elapsedTime = Platform::getRealMicroseconds() - startTime;
+
+        Con::printf( ">> %s: %d iterations in %.3f ms (%.3f us per iteration).",
+            pScripts[n],
+            SCRIPTBYTECODE_UNITTEST_ITERATIONS,
+            F64(elapsedTime) / 1000.0,
+            F64(elapsedTime) / SCRIPTBYTECODE_UNITTEST_ITERATIONS );
+    }
+
+    ASSERT_STREQ( evaluateResult( "ScriptBytecodeTest::calls( 1000 )" ), "1000" );
+}
+
+#endif // TORQUE_SHIPPING
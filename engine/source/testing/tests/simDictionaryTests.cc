@@ -0,0 +1,204 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _SIMBASE_H_
+#include "sim/simBase.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SIMDICTIONARY_UNITTEST_OBJECT_COUNT     20000
+#define SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT  200000
+#define SIMDICTIONARY_UNITTEST_LOOKUP_COUNT     2000000
+
+//-----------------------------------------------------------------------------
+
+TEST( SimDictionaryTests, IdDictionary )
+{
+    SimIdDictionary dictionary;
+    Vector<SimObject*> objects;
+
+    // Mix dense ids with scattered ones that collide in the table.
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_OBJECT_COUNT; ++index )
+    {
+        SimObject* pObject = new SimObject();
+        pObject->setId( index % 4 == 0 ? 1000000 + index * 4096 : DynamicObjectIdFirst + index );
+        dictionary.insert( pObject );
+        objects.push_back( pObject );
+    }
+
+    ASSERT_EQ( dictionary.getCount(), SIMDICTIONARY_UNITTEST_OBJECT_COUNT ) << "Dictionary count is wrong.";
+    ASSERT_GE( dictionary.getTableSize(), SIMDICTIONARY_UNITTEST_OBJECT_COUNT * 2 ) << "Dictionary did not grow.";
+
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_OBJECT_COUNT; ++index )
+        ASSERT_EQ( dictionary.find( objects[index]->getId() ), objects[index] ) << "Failed to find object.";
+
+    ASSERT_TRUE( dictionary.find( 999 ) == NULL ) << "Found an id that was never inserted.";
+
+    // Removing objects must not lose the objects probed past them.
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_OBJECT_COUNT; index += 3 )
+        dictionary.remove( objects[index] );
+
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_OBJECT_COUNT; ++index )
+    {
+        SimObject* pExpected = index % 3 == 0 ? NULL : objects[index];
+        ASSERT_EQ( dictionary.find( objects[index]->getId() ), pExpected ) << "Object lookup is wrong after removal.";
+    }
+
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_OBJECT_COUNT; ++index )
+    {
+        if ( index % 3 != 0 )
+            dictionary.remove( objects[index] );
+
+        delete objects[index];
+    }
+
+    ASSERT_EQ( dictionary.getCount(), 0 ) << "Dictionary is not empty.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimDictionaryTests, NameDictionary )
+{
+    SimNameDictionary dictionary;
+    Vector<SimObject*> objects;
+
+    char nameBuffer[64];
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_OBJECT_COUNT; ++index )
+    {
+        SimObject* pObject = new SimObject();
+        dSprintf( nameBuffer, sizeof(nameBuffer), "SimDictionaryTest%d", index );
+        pObject->assignName( nameBuffer );
+        dictionary.insert( pObject );
+        objects.push_back( pObject );
+
+        // Objects must be found while the table is being migrated.
+        if ( dictionary.isRehashing() )
+        {
+            for ( U32 findIndex = 0; findIndex <= index; findIndex += 7 )
+                ASSERT_EQ( dictionary.find( objects[findIndex]->getName() ), objects[findIndex] ) << "Failed to find object whilst rehashing.";
+        }
+    }
+
+    ASSERT_EQ( dictionary.getCount(), SIMDICTIONARY_UNITTEST_OBJECT_COUNT ) << "Dictionary count is wrong.";
+    ASSERT_TRUE( dictionary.find( StringTable->insert( "SimDictionaryTestMissing" ) ) == NULL ) << "Found a name that was never inserted.";
+
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_OBJECT_COUNT; ++index )
+    {
+        dictionary.remove( objects[index] );
+        ASSERT_TRUE( dictionary.find( objects[index]->getName() ) == NULL ) << "Found a removed object.";
+        delete objects[index];
+    }
+
+    ASSERT_EQ( dictionary.getCount(), 0 ) << "Dictionary is not empty.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SimDictionaryTests, LookupBenchmark )
+{
+    Vector<SimObject*> objects;
+    objects.reserve( SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT );
+
+    // Register the objects.
+    U64 startTime = Platform::getRealMicroseconds();
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT; ++index )
+    {
+        SimObject* pObject = new SimObject();
+        ASSERT_TRUE( pObject->registerObject() ) << "Failed to register object.";
+        objects.push_back( pObject );
+    }
+    const U64 registerTime = Platform::getRealMicroseconds() - startTime;
+
+    // Look the objects up by id in a scattered order.
+    U32 foundCount = 0;
+    startTime = Platform::getRealMicroseconds();
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_LOOKUP_COUNT; ++index )
+    {
+        const U32 objectIndex = (index * 7919) % SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT;
+        if ( Sim::findObject( objects[objectIndex]->getId() ) == objects[objectIndex] )
+            foundCount++;
+    }
+    const U64 idTime = Platform::getRealMicroseconds() - startTime;
+    ASSERT_EQ( foundCount, SIMDICTIONARY_UNITTEST_LOOKUP_COUNT ) << "Failed to find objects by id.";
+
+    // Look the objects up by id string as script does.
+    foundCount = 0;
+    startTime = Platform::getRealMicroseconds();
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_LOOKUP_COUNT; ++index )
+    {
+        const U32 objectIndex = (index * 7919) % SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT;
+        if ( Sim::findObject( objects[objectIndex]->getIdString() ) == objects[objectIndex] )
+            foundCount++;
+    }
+    const U64 idStringTime = Platform::getRealMicroseconds() - startTime;
+    ASSERT_EQ( foundCount, SIMDICTIONARY_UNITTEST_LOOKUP_COUNT ) << "Failed to find objects by id string.";
+
+    Con::printf( ">> Registered %d objects in %.3f ms.", SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT, F64(registerTime) / 1000.0 );
+    Con::printf( ">> Id lookup: %.1f ns, id string lookup: %.1f ns.",
+        F64(idTime) * 1000.0 / F64(SIMDICTIONARY_UNITTEST_LOOKUP_COUNT),
+        F64(idStringTime) * 1000.0 / F64(SIMDICTIONARY_UNITTEST_LOOKUP_COUNT) );
+
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT; ++index )
+        objects[index]->deleteObject();
+
+    // Time individual inserts into a growing name dictionary.
+    SimNameDictionary dictionary;
+    U64 worstInsertTime = 0;
+    char nameBuffer[64];
+    startTime = Platform::getRealMicroseconds();
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT; ++index )
+    {
+        SimObject* pObject = objects[index] = new SimObject();
+        dSprintf( nameBuffer, sizeof(nameBuffer), "SimDictionaryBenchmark%d", index );
+        pObject->assignName( nameBuffer );
+
+        const U64 insertStartTime = Platform::getRealMicroseconds();
+        dictionary.insert( pObject );
+        const U64 insertTime = Platform::getRealMicroseconds() - insertStartTime;
+        if ( insertTime > worstInsertTime )
+            worstInsertTime = insertTime;
+    }
+    const U64 nameInsertTime = Platform::getRealMicroseconds() - startTime;
+
+    Con::printf( ">> Named %d objects in %.3f ms, worst insert %.3f ms.",
+        SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT, F64(nameInsertTime) / 1000.0, F64(worstInsertTime) / 1000.0 );
+
+    for ( U32 index = 0; index < SIMDICTIONARY_UNITTEST_BENCHMARK_COUNT; ++index )
+    {
+        dictionary.remove( objects[index] );
+        delete objects[index];
+    }
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,280 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _SPRITE_BATCH_H_
+#include "2d/core/SpriteBatch.h"
+#endif
+
+#ifndef _SCENE_RENDER_STATE_H_
+#include "2d/scene/SceneRenderState.h"
+#endif
+
+#ifndef _SCENE_RENDER_QUEUE_H_
+#include "2d/scene/SceneRenderQueue.h"
+#endif
+
+#ifndef _CONSOLE_H_
+#include "console/console.h"
+#endif
+
+#ifndef _ASSET_MANAGER_H_
+#include "assets/assetManager.h"
+#endif
+
+#ifndef _ASSET_PTR_H_
+#include "assets/assetPtr.h"
+#endif
+
+#ifndef _IMAGE_ASSET_H_
+#include "2d/assets/ImageAsset.h"
+#endif
+
+#ifndef _TEXTURE_MANAGER_H_
+#include "graphics/TextureManager.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define SPRITEBATCH_UNITTEST_LAYOUT_SIZE    512
+#define SPRITEBATCH_UNITTEST_CHUNK_SIZE     16
+#define SPRITEBATCH_UNITTEST_VIEW_SIZE      40
+#define SPRITEBATCH_UNITTEST_FRAMES         20
+#define SPRITEBATCH_UNITTEST_IMAGE_FILE     "spriteBatchTestTiles.png"
+#define SPRITEBATCH_UNITTEST_IMAGE_CELLS    4
+#define SPRITEBATCH_UNITTEST_IMAGE_FRAMES   (SPRITEBATCH_UNITTEST_IMAGE_CELLS * SPRITEBATCH_UNITTEST_IMAGE_CELLS)
+#define SPRITEBATCH_UNITTEST_CELL_SIZE      16
+
+//-----------------------------------------------------------------------------
+
+/// A private tiled image backed by a texture made in memory so no module needs loading.
+class SpriteBatchTestImage
+{
+public:
+    TextureHandle           mTexture;
+    StringTableEntry        mAssetId;
+    AssetPtr<ImageAsset>    mImageAsset;
+
+    SpriteBatchTestImage()
+    {
+        // Register the texture under the path the asset will expand its image file to.
+        const U32 imageSize = SPRITEBATCH_UNITTEST_IMAGE_CELLS * SPRITEBATCH_UNITTEST_CELL_SIZE;
+        GBitmap* pBitmap = new GBitmap( imageSize, imageSize, false, GBitmap::RGBA );
+        dMemset( pBitmap->getWritableBits(), 0xFF, pBitmap->byteSize );
+
+        char imagePath[1024];
+        Con::expandPath( imagePath, sizeof(imagePath), SPRITEBATCH_UNITTEST_IMAGE_FILE );
+        mTexture = TextureHandle( imagePath, pBitmap, TextureHandle::BitmapTexture, true );
+
+        ImageAsset* pImageAsset = new ImageAsset();
+        pImageAsset->setImageFile( SPRITEBATCH_UNITTEST_IMAGE_FILE );
+        pImageAsset->setCellCountX( SPRITEBATCH_UNITTEST_IMAGE_CELLS );
+        pImageAsset->setCellCountY( SPRITEBATCH_UNITTEST_IMAGE_CELLS );
+        pImageAsset->setCellWidth( SPRITEBATCH_UNITTEST_CELL_SIZE );
+        pImageAsset->setCellHeight( SPRITEBATCH_UNITTEST_CELL_SIZE );
+        pImageAsset->registerObject();
+
+        // Private assets are unloaded when released so hold on to it until the test ends.
+        mAssetId = AssetDatabase.addPrivateAsset( pImageAsset );
+        mImageAsset = mAssetId;
+    }
+
+    bool isValid( void )
+    {
+        return mImageAsset.notNull() && mImageAsset->isAssetValid() && mImageAsset->getFrameCount() == SPRITEBATCH_UNITTEST_IMAGE_FRAMES;
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/// A rectilinear sprite layout with unit stride.
+class SpriteBatchTestLayout : public SpriteBatch
+{
+public:
+    SpriteBatchTestLayout( const S32 layoutSize, const char* pImageAssetId )
+    {
+        onAdd();
+
+        char buffer[32];
+        for ( S32 y = 0; y < layoutSize; ++y )
+        {
+            for ( S32 x = 0; x < layoutSize; ++x )
+            {
+                dSprintf( buffer, sizeof(buffer), "%d %d", x, y );
+                addSprite( SpriteBatchItem::LogicalPosition( buffer ) );
+                setSpriteImage( pImageAssetId, (x + y) % SPRITEBATCH_UNITTEST_IMAGE_FRAMES );
+            }
+        }
+    }
+
+    virtual ~SpriteBatchTestLayout()
+    {
+        onRemove();
+    }
+
+    SpriteBatchItem* findSprite( const S32 x, const S32 y )
+    {
+        char buffer[32];
+        dSprintf( buffer, sizeof(buffer), "%d %d", x, y );
+        return findSpritePosition( SpriteBatchItem::LogicalPosition( buffer ) );
+    }
+
+    /// Prepare the layout for rendering a view a number of times.
+    /// @return The time taken in microseconds.
+    U64 prepareFrames( const RectF& viewArea, const U32 frameCount, U32& requestCount )
+    {
+        SceneRenderState renderState( viewArea, viewArea.centre(), 0.0f, U32_MAX, U32_MAX, Vector2::getOne(), NULL, NULL );
+        SceneRenderQueue renderQueue;
+
+        const U64 startTime = Platform::getRealMicroseconds();
+
+        for ( U32 frame = 0; frame < frameCount; ++frame )
+        {
+            renderQueue.resetState();
+            prepareRender( NULL, &renderState, &renderQueue );
+            renderQueue.sort();
+        }
+
+        requestCount = (U32)renderQueue.getRenderRequests().size();
+
+        return Platform::getRealMicroseconds() - startTime;
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+TEST( SpriteBatchTests, StaticChunks )
+{
+    SpriteBatchTestImage image;
+    ASSERT_TRUE( image.isValid() ) << "Failed to create the test image.";
+
+    SpriteBatchTestLayout layout( SPRITEBATCH_UNITTEST_CHUNK_SIZE * 4, image.mAssetId );
+    layout.setBatchChunkSize( (F32)SPRITEBATCH_UNITTEST_CHUNK_SIZE );
+    layout.setBatchStatic( true );
+    layout.updateStaticChunks();
+
+    ASSERT_EQ( layout.getStaticChunkCount(), 16 ) << "Sprites were not grouped by cell.";
+
+    SpriteBatchItem* pNearSprite = layout.findSprite( 1, 1 );
+    SpriteBatchItem* pFarSprite = layout.findSprite( SPRITEBATCH_UNITTEST_CHUNK_SIZE * 3, SPRITEBATCH_UNITTEST_CHUNK_SIZE * 3 );
+    ASSERT_TRUE( pNearSprite != NULL && pFarSprite != NULL ) << "Failed to find the sprites.";
+    ASSERT_NE( pNearSprite->getStaticChunk(), pFarSprite->getStaticChunk() ) << "Sprites in different cells share a chunk.";
+    ASSERT_EQ( pNearSprite->getStaticChunk(), layout.findSprite( 2, 2 )->getStaticChunk() ) << "Sprites in the same cell are in different chunks.";
+
+    // Rendering bakes every chunk.
+    U32 requestCount;
+    layout.prepareFrames( RectF( -1.0f, -1.0f, SPRITEBATCH_UNITTEST_CHUNK_SIZE * 4 + 2.0f, SPRITEBATCH_UNITTEST_CHUNK_SIZE * 4 + 2.0f ), 1, requestCount );
+    ASSERT_FALSE( pNearSprite->getStaticChunk()->getDirty() ) << "Chunk was not baked.";
+    ASSERT_FALSE( pFarSprite->getStaticChunk()->getDirty() ) << "Chunk was not baked.";
+
+    // Changing a sprite only dirties its own chunk.
+    pNearSprite->setFlipX( true );
+    ASSERT_TRUE( pNearSprite->getStaticChunk()->getDirty() ) << "Changing a sprite did not dirty its chunk.";
+    ASSERT_FALSE( pFarSprite->getStaticChunk()->getDirty() ) << "Changing a sprite dirtied another chunk.";
+
+    // A view over one chunk only culls in that chunk.
+    layout.prepareFrames( RectF( 1.0f, 1.0f, 2.0f, 2.0f ), 1, requestCount );
+    ASSERT_FALSE( pNearSprite->getStaticChunk()->getDirty() ) << "Chunk was not rebaked.";
+    ASSERT_GT( pNearSprite->getStaticChunk()->getVertexBlocks().size(), 0 ) << "Chunk was baked without any vertex blocks.";
+    ASSERT_GT( requestCount, 0u ) << "The chunk in view was not requested.";
+    ASSERT_LE( requestCount, pNearSprite->getStaticChunk()->getVertexBlocks().size() ) << "Chunks out of view were not culled.";
+
+    // Removing every sprite in a cell removes its chunk.
+    for ( S32 y = 0; y < SPRITEBATCH_UNITTEST_CHUNK_SIZE; ++y )
+    {
+        for ( S32 x = 0; x < SPRITEBATCH_UNITTEST_CHUNK_SIZE; ++x )
+        {
+            ASSERT_TRUE( layout.selectSpriteId( layout.findSprite( x, y )->getBatchId() ) );
+            ASSERT_TRUE( layout.removeSprite() );
+        }
+    }
+    layout.updateStaticChunks();
+    ASSERT_EQ( layout.getStaticChunkCount(), 15 ) << "Empty chunk was not removed.";
+
+    // Turning static chunks off detaches the sprites.
+    layout.setBatchStatic( false );
+    ASSERT_EQ( layout.getStaticChunkCount(), 0 ) << "Chunks were not destroyed.";
+    ASSERT_TRUE( pFarSprite->getStaticChunk() == NULL ) << "Sprite is still attached to a chunk.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( SpriteBatchTests, StaticChunkBenchmark )
+{
+    SpriteBatchTestImage image;
+    ASSERT_TRUE( image.isValid() ) << "Failed to create the test image.";
+
+    SpriteBatchTestLayout layout( SPRITEBATCH_UNITTEST_LAYOUT_SIZE, image.mAssetId );
+    layout.setBatchChunkSize( (F32)SPRITEBATCH_UNITTEST_CHUNK_SIZE );
+
+    const F32 layoutExtent = (F32)SPRITEBATCH_UNITTEST_LAYOUT_SIZE;
+    const RectF fullView( -1.0f, -1.0f, layoutExtent + 2.0f, layoutExtent + 2.0f );
+    const RectF partialView( layoutExtent * 0.5f, layoutExtent * 0.5f, (F32)SPRITEBATCH_UNITTEST_VIEW_SIZE, (F32)SPRITEBATCH_UNITTEST_VIEW_SIZE );
+
+    // Per-sprite render requests.
+    U32 spriteFullRequests, spritePartialRequests;
+    const U64 spriteFullTime = layout.prepareFrames( fullView, SPRITEBATCH_UNITTEST_FRAMES, spriteFullRequests );
+    const U64 spritePartialTime = layout.prepareFrames( partialView, SPRITEBATCH_UNITTEST_FRAMES, spritePartialRequests );
+
+    // Baking the static chunks.
+    layout.setBatchStatic( true );
+    U32 bakeRequests;
+    const U64 bakeTime = layout.prepareFrames( fullView, 1, bakeRequests );
+
+    // Per-chunk render requests.
+    U32 chunkFullRequests, chunkPartialRequests;
+    const U64 chunkFullTime = layout.prepareFrames( fullView, SPRITEBATCH_UNITTEST_FRAMES, chunkFullRequests );
+    const U64 chunkPartialTime = layout.prepareFrames( partialView, SPRITEBATCH_UNITTEST_FRAMES, chunkPartialRequests );
+
+    const U32 chunksPerSide = SPRITEBATCH_UNITTEST_LAYOUT_SIZE / SPRITEBATCH_UNITTEST_CHUNK_SIZE;
+    ASSERT_EQ( layout.getStaticChunkCount(), chunksPerSide * chunksPerSide ) << "Unexpected chunk count.";
+    ASSERT_EQ( spriteFullRequests, layout.getSpriteCount() ) << "Not every sprite was requested.";
+    ASSERT_LT( chunkFullRequests, spriteFullRequests ) << "Chunks did not reduce the render requests.";
+    ASSERT_GT( spritePartialRequests, 0u ) << "No sprites in view were requested.";
+    ASSERT_GT( chunkPartialRequests, 0u ) << "No chunks in view were requested.";
+    ASSERT_LT( chunkPartialRequests, chunkFullRequests ) << "Chunks were not culled.";
+
+    // Rebaking a single chunk.
+    layout.findSprite( 1, 1 )->setFlipY( true );
+    U32 rebakeRequests;
+    const U64 rebakeTime = layout.prepareFrames( fullView, 1, rebakeRequests );
+
+    Con::printf( ">> %dx%d sprites, %d chunks: bake %.2f ms, single chunk rebake %.2f ms.",
+        SPRITEBATCH_UNITTEST_LAYOUT_SIZE, SPRITEBATCH_UNITTEST_LAYOUT_SIZE, layout.getStaticChunkCount(),
+        F64(bakeTime) / 1000.0, F64(rebakeTime) / 1000.0 );
+    Con::printf( ">> Full view: %.2f ms per frame with %d sprite requests, %.2f ms per frame with %d chunk requests.",
+        F64(spriteFullTime) / (1000.0 * SPRITEBATCH_UNITTEST_FRAMES), spriteFullRequests,
+        F64(chunkFullTime) / (1000.0 * SPRITEBATCH_UNITTEST_FRAMES), chunkFullRequests );
+    Con::printf( ">> %dx%d view: %.2f ms per frame with %d sprite requests, %.2f ms per frame with %d chunk requests.",
+        SPRITEBATCH_UNITTEST_VIEW_SIZE, SPRITEBATCH_UNITTEST_VIEW_SIZE,
+        F64(spritePartialTime) / (1000.0 * SPRITEBATCH_UNITTEST_FRAMES), spritePartialRequests,
+        F64(chunkPartialTime) / (1000.0 * SPRITEBATCH_UNITTEST_FRAMES), chunkPartialRequests );
+}
+
+#endif // TORQUE_SHIPPING
@@ -0,0 +1,332 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2013 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// We don't want tests in a shipping version.
+#ifndef TORQUE_SHIPPING
+
+#ifndef _UNIT_TESTING_H_
+#include "testing/unitTesting.h"
+#endif
+
+#ifndef _TAML_H_
+#include "persistence/taml/taml.h"
+#endif
+
+#ifndef _TAML_XMLPARSER_H_
+#include "persistence/taml/tamlXmlParser.h"
+#endif
+
+#ifndef _SCRIPT_OBJECT_H_
+#include "sim/scriptObject.h"
+#endif
+
+#ifndef TINYXML_INCLUDED
+#include "persistence/tinyXML/tinyxml.h"
+#endif
+
+//-----------------------------------------------------------------------------
+
+#define TAMLXMLREADER_UNITTEST_BENCHMARK_SIZE       (100 * 1024 * 1024)
+#define TAMLXMLREADER_UNITTEST_BENCHMARK_LAYER      1000
+#define TAMLXMLREADER_UNITTEST_BENCHMARK_FIELD      "Benchmark value with enough text to look like a typical scene object field"
+
+//-----------------------------------------------------------------------------
+
+static const char* formatTestFilename( char* pBuffer, const U32 bufferSize, const char* pName )
+{
+    dSprintf( pBuffer, bufferSize, "%s/%s", Platform::getTemporaryDirectory(), pName );
+    return pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+
+static bool writeTestFile( const char* pFilename, const char* pText )
+{
+    FileStream stream;
+    if ( !stream.open( pFilename, FileStream::Write ) )
+        return false;
+
+    const bool written = stream.writeStringBuffer( pText );
+    stream.close();
+    return written;
+}
+
+//-----------------------------------------------------------------------------
+
+static void readTestFile( const char* pFilename, char* pBuffer, const U32 bufferSize )
+{
+    FileStream stream;
+    pBuffer[0] = 0;
+    if ( !stream.open( pFilename, FileStream::Read ) )
+        return;
+
+    const U32 size = getMin( stream.getStreamSize(), bufferSize - 1 );
+    stream.read( size, pBuffer );
+    pBuffer[size] = 0;
+    stream.close();
+}
+
+//-----------------------------------------------------------------------------
+
+static SimObject* readTamlText( const char* pName, const char* pText )
+{
+    char filename[1024];
+    formatTestFilename( filename, sizeof(filename), pName );
+    if ( !writeTestFile( filename, pText ) )
+        return NULL;
+
+    Taml taml;
+    taml.setAutoFormat( false );
+    taml.setFormatMode( Taml::XmlFormat );
+    return taml.read( filename );
+}
+
+//-----------------------------------------------------------------------------
+
+class TamlXmlTestVisitor : public TamlXmlVisitor
+{
+protected:
+    virtual bool visit( TamlXmlElement& xmlElement, TamlXmlParser& xmlParser )
+    {
+        mElementCount++;
+        return mElementCount < mElementLimit;
+    }
+
+    virtual bool visit( TamlXmlAttribute& xmlAttribute, TamlXmlParser& xmlParser )
+    {
+        mAttributeCount++;
+
+        // Rename any value requested.
+        if ( mpValueFrom != NULL && dStrcmp( xmlAttribute.getValue(), mpValueFrom ) == 0 )
+            xmlAttribute.setValue( mpValueTo );
+
+        return true;
+    }
+
+public:
+    TamlXmlTestVisitor( const U32 elementLimit = U32_MAX ) :
+        mElementLimit( elementLimit ),
+        mElementCount( 0 ),
+        mAttributeCount( 0 ),
+        mpValueFrom( NULL ),
+        mpValueTo( NULL ) {}
+
+    bool parse( const char* pFilename )
+    {
+        TamlXmlParser parser;
+        return parser.parse( pFilename, *this, mpValueFrom != NULL );
+    }
+
+    U32 mElementLimit;
+    U32 mElementCount;
+    U32 mAttributeCount;
+    const char* mpValueFrom;
+    const char* mpValueTo;
+};
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlXmlReaderTests, ReadDocument )
+{
+    SimObject* pSimObject = readTamlText( "tamlXmlReaderTest.taml",
+        "<?xml version=\"1.0\" ?>\r\n"
+        "<!-- A comment before the root. -->\r\n"
+        "<SimGroup Name=\"TamlXmlReaderTestGroup\">\r\n"
+        "    <SimSet>\r\n"
+        "        <ScriptObject TamlId=\"1\" Title=\"Fish &amp; Chips &lt;&#65;&#x42;&gt;\" Quote='Say \"hi\"' />\r\n"
+        "    </SimSet>\r\n"
+        "    <!-- A comment between children. -->\r\n"
+        "    <SimSet><ScriptObject TamlRefId=\"1\"></ScriptObject></SimSet>\r\n"
+        "</SimGroup>\r\n" );
+
+    SimGroup* pSimGroup = dynamic_cast<SimGroup*>( pSimObject );
+    ASSERT_TRUE( pSimGroup != NULL ) << "Failed to read the document.";
+    ASSERT_STREQ( pSimGroup->getName(), "TamlXmlReaderTestGroup" );
+    ASSERT_EQ( pSimGroup->size(), 2 );
+
+    SimSet* pFirstSet = dynamic_cast<SimSet*>( (*pSimGroup)[0] );
+    SimSet* pSecondSet = dynamic_cast<SimSet*>( (*pSimGroup)[1] );
+    ASSERT_TRUE( pFirstSet != NULL && pSecondSet != NULL ) << "Children were not read.";
+    ASSERT_EQ( pFirstSet->size(), 1 );
+    ASSERT_EQ( pSecondSet->size(), 1 );
+
+    // Attribute values are decoded.
+    SimObject* pScriptObject = (*pFirstSet)[0];
+    ASSERT_STREQ( pScriptObject->getDataField( StringTable->insert( "Title" ), NULL ), "Fish & Chips <AB>" );
+    ASSERT_STREQ( pScriptObject->getDataField( StringTable->insert( "Quote" ), NULL ), "Say \"hi\"" );
+
+    // References resolve to the same object.
+    ASSERT_TRUE( (*pSecondSet)[0] == pScriptObject ) << "Reference did not resolve.";
+
+    pScriptObject->deleteObject();
+    pSimGroup->deleteObject();
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlXmlReaderTests, MalformedDocument )
+{
+    // Mismatched end tag.
+    SimObject* pSimObject = readTamlText( "tamlXmlReaderTest.taml",
+        "<SimSet Name=\"TamlXmlReaderTestBroken\">\r\n"
+        "    <ScriptObject Name=\"TamlXmlReaderTestBrokenChild\" />\r\n"
+        "</SimGroup>\r\n" );
+
+    // Nothing is returned and nothing that was created is left behind.
+    ASSERT_TRUE( pSimObject == NULL ) << "Malformed document was read.";
+    ASSERT_TRUE( Sim::findObject( "TamlXmlReaderTestBroken" ) == NULL ) << "Root was not removed.";
+    ASSERT_TRUE( Sim::findObject( "TamlXmlReaderTestBrokenChild" ) == NULL ) << "Child was not removed.";
+
+    // Unterminated document.
+    pSimObject = readTamlText( "tamlXmlReaderTest.taml", "<SimSet><ScriptObject Title=\"x\"/>" );
+    ASSERT_TRUE( pSimObject == NULL ) << "Unterminated document was read.";
+
+    // No root element.
+    pSimObject = readTamlText( "tamlXmlReaderTest.taml", "<!-- Nothing here. -->" );
+    ASSERT_TRUE( pSimObject == NULL ) << "Document without a root was read.";
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlXmlReaderTests, VisitorStopsEarly )
+{
+    char filename[1024];
+    formatTestFilename( filename, sizeof(filename), "tamlXmlReaderTest.asset.taml" );
+
+    // The document is broken after the root element's start tag.
+    ASSERT_TRUE( writeTestFile( filename,
+        "<ImageAsset AssetName=\"Test\" ImageFile=\"test.png\">\r\n"
+        "    <Broken\r\n" ) );
+
+    // Stopping on the root never reads the rest of the document.
+    TamlXmlTestVisitor rootVisitor( 1 );
+    ASSERT_TRUE( rootVisitor.parse( filename ) );
+    ASSERT_EQ( rootVisitor.mElementCount, 1 );
+    ASSERT_EQ( rootVisitor.mAttributeCount, 0 );
+
+    // Reading on finds the error.
+    TamlXmlTestVisitor fullVisitor;
+    ASSERT_FALSE( fullVisitor.parse( filename ) );
+    ASSERT_EQ( fullVisitor.mAttributeCount, 2 );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlXmlReaderTests, VisitorWritesEdits )
+{
+    char filename[1024];
+    formatTestFilename( filename, sizeof(filename), "tamlXmlReaderTest.taml" );
+
+    ASSERT_TRUE( writeTestFile( filename,
+        "<SimSet   Title=\"from\">\r\n"
+        "    <!-- Kept as written. -->\r\n"
+        "    <ScriptObject Other='other' Title='from'/>\r\n"
+        "</SimSet>\r\n" ) );
+
+    TamlXmlTestVisitor visitor;
+    visitor.mpValueFrom = "from";
+    visitor.mpValueTo = "to & \"more\"";
+    ASSERT_TRUE( visitor.parse( filename ) );
+
+    // Only the edited values change and they are escaped.
+    char buffer[1024];
+    readTestFile( filename, buffer, sizeof(buffer) );
+    ASSERT_STREQ( buffer,
+        "<SimSet   Title=\"to &amp; &quot;more&quot;\">\r\n"
+        "    <!-- Kept as written. -->\r\n"
+        "    <ScriptObject Other='other' Title='to &amp; &quot;more&quot;'/>\r\n"
+        "</SimSet>\r\n" );
+}
+
+//-----------------------------------------------------------------------------
+
+TEST( TamlXmlReaderTests, ReadBenchmark )
+{
+    char filename[1024];
+    formatTestFilename( filename, sizeof(filename), "tamlXmlReaderBenchmark.scene.taml" );
+
+    // Generate a large scene-sized document with the objects split into layers.
+    FileStream stream;
+    ASSERT_TRUE( stream.open( filename, FileStream::Write ) );
+    stream.writeStringBuffer( "<SimGroup Name=\"TamlXmlReaderBenchmark\">\r\n" );
+    U32 layerCount = 0;
+    U32 objectCount = 0;
+    while( stream.getPosition() < TAMLXMLREADER_UNITTEST_BENCHMARK_SIZE )
+    {
+        stream.writeFormattedBuffer( "    <SimGroup Layer=\"%d\">\r\n", layerCount++ );
+        for ( U32 n = 0; n < TAMLXMLREADER_UNITTEST_BENCHMARK_LAYER; ++n )
+        {
+            stream.writeFormattedBuffer( "        <ScriptObject Index=\"%d\" Position=\"%d.5 %d.25\" Size=\"1 1\" Description=\"%s\" Notes=\"%s &amp; %s\" />\r\n",
+                objectCount, n, layerCount,
+                TAMLXMLREADER_UNITTEST_BENCHMARK_FIELD, TAMLXMLREADER_UNITTEST_BENCHMARK_FIELD, TAMLXMLREADER_UNITTEST_BENCHMARK_FIELD );
+            objectCount++;
+        }
+        stream.writeStringBuffer( "    </SimGroup>\r\n" );
+    }
+    stream.writeStringBuffer( "</SimGroup>\r\n" );
+    const U32 documentSize = stream.getPosition();
+    stream.close();
+
+    // Load the DOM alone as the previous reader did before creating any objects.
+    U64 startTime = Platform::getRealMicroseconds();
+    {
+        ASSERT_TRUE( stream.open( filename, FileStream::Read ) );
+        TiXmlDocument xmlDocument;
+        ASSERT_TRUE( xmlDocument.LoadFile( stream ) );
+        stream.close();
+    }
+    const U64 domTime = Platform::getRealMicroseconds() - startTime;
+
+    // Stream the document creating the objects.
+    startTime = Platform::getRealMicroseconds();
+    Taml taml;
+    taml.setAutoFormat( false );
+    taml.setFormatMode( Taml::XmlFormat );
+    SimGroup* pSimGroup = taml.read<SimGroup>( filename );
+    const U64 readTime = Platform::getRealMicroseconds() - startTime;
+    ASSERT_TRUE( pSimGroup != NULL ) << "Failed to read the benchmark document.";
+    ASSERT_EQ( (U32)pSimGroup->size(), layerCount );
+
+    // Visit every attribute.
+    startTime = Platform::getRealMicroseconds();
+    TamlXmlTestVisitor fullVisitor;
+    ASSERT_TRUE( fullVisitor.parse( filename ) );
+    const U64 visitTime = Platform::getRealMicroseconds() - startTime;
+    ASSERT_EQ( fullVisitor.mElementCount, objectCount + layerCount + 1 );
+
+    // Stop on the root as an asset declaration scan does.
+    startTime = Platform::getRealMicroseconds();
+    TamlXmlTestVisitor rootVisitor( 1 );
+    ASSERT_TRUE( rootVisitor.parse( filename ) );
+    const U64 rootTime = Platform::getRealMicroseconds() - startTime;
+
+    Con::printf( ">> %.1f MB with %d objects: %.1f ms DOM load only, %.1f ms streamed read creating objects, %.1f ms full visit, %.3f ms root visit.",
+        F64(documentSize) / (1024.0 * 1024.0), objectCount,
+        F64(domTime) / 1000.0, F64(readTime) / 1000.0, F64(visitTime) / 1000.0, F64(rootTime) / 1000.0 );
+
+    // Remove the objects.
+    pSimGroup->deleteObject();
+
+    Platform::fileDelete( filename );
+}
+
+#endif // TORQUE_SHIPPING
@@ -76,6 +76,10 @@
 /// When defined, Torque will capture performance profiling information that sacrifices
 /// a small performance overhead to gain significant diagnostics information.
 ///
+/// 'TORQUE_DISABLE_TRACE_PROFILER'
+/// When defined, the profiler macros no longer feed the timeline trace profiler.  The
+/// trace profiler only records when enabled from script so this is rarely needed.
+///
 /// 'TORQUE_DEBUG_NET'
 /// When defined, Torque will enabled certain features that enabled diagnostics of
 /// its networking sub-system.